@@ -18,6 +18,8 @@
 #include "ert-driver-st7036-config.h"
 #include "ert-comm-transceiver-config.h"
 #include "ert-comm-protocol-config.h"
+#include "ert-comm-link-adaptation-config.h"
+#include "ert-comm-channel-plan-config.h"
 #include "ert-server-config.h"
 #include "ertgateway-config.h"
 
@@ -28,7 +30,26 @@ int ert_gateway_rfm9xw_config_updated(ert_mapper_entry *entry, void *context)
   ert_log_info("Updating RFM9xW comm device configuration to:");
   ert_mapper_log_entries(entry);
 
-  return ert_comm_transceiver_configure(gateway->comm_transceiver, &gateway->config.rfm9xw_config);
+  for (uint32_t i = 0; i < gateway->comm_channel_count; i++) {
+    ert_gateway_comm_channel *comm_channel = &gateway->comm_channels[i];
+    double transmit_frequency = comm_channel->rfm9xw_config.transmit_config.frequency;
+    double receive_frequency = comm_channel->rfm9xw_config.receive_config.frequency;
+
+    memcpy(&comm_channel->rfm9xw_config, &gateway->config.rfm9xw_config, sizeof(ert_driver_rfm9xw_config));
+
+    // Channel frequencies are defined by the channel plan
+    if (ert_comm_channel_plan_is_enabled(&gateway->config.comm_channel_plan_config)) {
+      comm_channel->rfm9xw_config.transmit_config.frequency = transmit_frequency;
+      comm_channel->rfm9xw_config.receive_config.frequency = receive_frequency;
+    }
+
+    int result = ert_comm_transceiver_configure(comm_channel->comm_transceiver, &comm_channel->rfm9xw_config);
+    if (result < 0) {
+      return result;
+    }
+  }
+
+  return 0;
 }
 
 ert_mapper_entry *ert_gateway_handler_display_create_mappings(ert_gateway_handler_display_config *handler_display_config)
@@ -216,6 +237,11 @@ ert_mapper_entry *ert_gateway_configuration_mapper_create(ert_gateway_config *co
       ert_comm_transceiver_create_mappings(&config->comm_transceiver_config);
   ert_mapper_entry *comm_protocol_children =
       ert_comm_protocol_create_mappings(&config->comm_protocol_config);
+  ert_mapper_entry *comm_link_adaptation_children =
+      ert_comm_link_adaptation_create_mappings(&config->comm_link_adaptation_config);
+
+  ert_mapper_entry *comm_channel_plan_children =
+      ert_comm_channel_plan_create_mappings(&config->comm_channel_plan_config);
 
   ert_mapper_entry comm_devices_children[] = {
       {
@@ -225,6 +251,24 @@ ert_mapper_entry *ert_gateway_configuration_mapper_create(ert_gateway_config *co
           .children_allocated = true,
           .updated = ert_gateway_rfm9xw_config_updated,
       },
+      {
+          .name = "rfm9xw_channel_1",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = ert_driver_rfm9xw_static_config_create_mappings(&config->rfm9xw_channel_static_configs[0]),
+          .children_allocated = true,
+      },
+      {
+          .name = "rfm9xw_channel_2",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = ert_driver_rfm9xw_static_config_create_mappings(&config->rfm9xw_channel_static_configs[1]),
+          .children_allocated = true,
+      },
+      {
+          .name = "rfm9xw_channel_3",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = ert_driver_rfm9xw_static_config_create_mappings(&config->rfm9xw_channel_static_configs[2]),
+          .children_allocated = true,
+      },
       {
           .type = ERT_MAPPER_ENTRY_TYPE_NONE,
       },
@@ -309,6 +353,18 @@ ert_mapper_entry *ert_gateway_configuration_mapper_create(ert_gateway_config *co
           .children = comm_protocol_children,
           .children_allocated = true,
       },
+      {
+          .name = "comm_link_adaptation",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = comm_link_adaptation_children,
+          .children_allocated = true,
+      },
+      {
+          .name = "comm_channel_plan",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = comm_channel_plan_children,
+          .children_allocated = true,
+      },
       {
           .name = "comm_devices",
           .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
@@ -322,7 +378,7 @@ ert_mapper_entry *ert_gateway_configuration_mapper_create(ert_gateway_config *co
   return ert_mapper_allocate(root_children);
 }
 
-int ert_gateway_read_configuration(ert_gateway_config *config, char *config_file_name)
+int ert_gateway_read_configuration(ert_gateway_config *config, char *config_file_name, bool strict)
 {
   FILE *config_file = fopen(config_file_name, "rb");
   if (config_file == NULL) {
@@ -337,7 +393,9 @@ int ert_gateway_read_configuration(ert_gateway_config *config, char *config_file
     return -ENOMEM;
   }
 
-  int result = ert_yaml_parse_file(config_file, config_root_entry);
+  int result = strict
+      ? ert_yaml_parse_file_strict(config_file, config_root_entry)
+      : ert_yaml_parse_file(config_file, config_root_entry);
   if (result == 0) {
     ert_log_info("Using configuration:");
     ert_mapper_log_entries(config_root_entry);
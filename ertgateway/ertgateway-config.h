@@ -14,6 +14,6 @@
 #include "ertgateway.h"
 
 ert_mapper_entry *ert_gateway_configuration_mapper_create(ert_gateway_config *config);
-int ert_gateway_read_configuration(ert_gateway_config *config, char *config_file_name);
+int ert_gateway_read_configuration(ert_gateway_config *config, char *config_file_name, bool strict);
 
 #endif
\ No newline at end of file
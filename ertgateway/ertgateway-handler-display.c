@@ -339,9 +339,9 @@ void ert_gateway_handler_display_update_content(ert_gateway_handler_display_cont
   char text_buffer[text_buffer_size];
 
   ert_gateway *gateway = display_context->gateway;
-  ert_comm_device *comm_device = gateway->comm_device;
-  ert_comm_protocol *comm_protocol = gateway->comm_protocol;
-  ert_comm_transceiver *comm_transceiver = gateway->comm_transceiver;
+  ert_comm_device *comm_device = gateway->comm_channels[0].comm_device;
+  ert_comm_protocol *comm_protocol = gateway->comm_channels[0].comm_protocol;
+  ert_comm_transceiver *comm_transceiver = gateway->comm_channels[0].comm_transceiver;
 
   ert_driver_st7036 *display = display_context->display;
 
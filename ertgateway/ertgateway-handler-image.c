@@ -76,11 +76,169 @@ static int ert_gateway_image_handler_parse_image_metadata(const char *filename,
   return 0;
 }
 
+static int ert_gateway_image_handler_allocate_image_filename(ert_gateway *gateway, const char *image_path,
+    uint32_t *image_index_rcv, struct timespec *image_timestamp, char *image_filename, char *image_full_path_filename)
+{
+  int result = ert_get_current_timestamp(image_timestamp);
+  if (result < 0) {
+    ert_log_error("Error getting current timestamp, result %d", result);
+    return result;
+  }
+
+  // TODO: add mutex
+  uint32_t image_index = gateway->image_index;
+  gateway->image_index++;
+
+  result = ert_image_format_filename(
+      gateway->config.handler_image_config.image_format, image_index, image_timestamp, "-local", image_filename);
+  if (result < 0) {
+    ert_log_error("ert_image_format_filename failed with result %d", result);
+    return result;
+  }
+
+  ert_image_add_path(image_path, image_filename, image_full_path_filename);
+
+  *image_index_rcv = image_index;
+
+  return 0;
+}
+
+static void ert_gateway_image_handler_process_image(ert_gateway *gateway, const char *image_path, uint32_t image_index,
+    struct timespec *image_timestamp, char *image_filename, char *image_full_path_filename)
+{
+  ert_image_metadata image_metadata;
+
+  int result = ert_gateway_image_handler_parse_image_metadata(image_full_path_filename, &image_metadata);
+  if (result < 0) {
+    ert_log_info("Error parsing image metadata for file '%s', result %d, setting fallback values",
+        image_full_path_filename, result);
+
+    image_metadata.id = image_index;
+    image_metadata.timestamp = *image_timestamp;
+    strncpy(image_metadata.filename, image_filename, PATH_MAX);
+    strncpy(image_metadata.format, gateway->config.handler_image_config.image_format, 8);
+  } else {
+    ert_image_add_path(image_path, image_metadata.filename, image_metadata.full_path_filename);
+
+    ssize_t fcopy_result = fcopyn(image_full_path_filename, image_metadata.full_path_filename);
+    if (fcopy_result < 0) {
+      ert_log_error("Error copying image file '%s' to '%s', result %d",
+          image_full_path_filename, image_metadata.full_path_filename, fcopy_result);
+
+      strncpy(image_metadata.filename, image_filename, PATH_MAX);
+    } else {
+      ert_log_info("Copied file '%s' to '%s' (%d bytes) based on image metadata",
+          image_full_path_filename, image_metadata.full_path_filename, (uint32_t) fcopy_result);
+    }
+  }
+
+  ert_event_emitter_emit(gateway->event_emitter, ERT_EVENT_NODE_IMAGE_RECEIVED, &image_metadata);
+}
+
+static void ert_gateway_image_handler_receive_image(ert_gateway *gateway, const char *image_path,
+    ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream)
+{
+  struct timespec image_timestamp;
+  uint32_t image_index;
+  char image_filename[PATH_MAX];
+  char image_full_path_filename[PATH_MAX];
+
+  int result = ert_gateway_image_handler_allocate_image_filename(gateway, image_path,
+      &image_index, &image_timestamp, image_filename, image_full_path_filename);
+  if (result < 0) {
+    ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+    return;
+  }
+
+  uint32_t bytes_received = 0;
+  result = ert_comm_protocol_receive_file(
+      comm_protocol, stream, image_full_path_filename, true, &gateway->running, &bytes_received);
+  if (result < 0) {
+    return;
+  }
+
+  if (bytes_received > 0) {
+    ert_gateway_image_handler_process_image(gateway, image_path, image_index, &image_timestamp,
+        image_filename, image_full_path_filename);
+  }
+}
+
+static ert_comm_transceiver *ert_gateway_image_handler_find_comm_transceiver(ert_gateway *gateway,
+    ert_comm_protocol *comm_protocol)
+{
+  for (uint32_t i = 0; i < gateway->comm_channel_count; i++) {
+    if (gateway->comm_channels[i].comm_protocol == comm_protocol) {
+      return gateway->comm_channels[i].comm_transceiver;
+    }
+  }
+
+  return NULL;
+}
+
+static void ert_gateway_image_handler_transmit_transfer_status(ert_gateway *gateway,
+    ert_comm_protocol *comm_protocol, ert_comm_protocol_file_transfer_info *transfer_info)
+{
+  // The gateway receives continuously, so reception is paused for the status like for acknowledgements
+  ert_comm_transceiver *comm_transceiver = ert_gateway_image_handler_find_comm_transceiver(gateway, comm_protocol);
+  if (comm_transceiver != NULL) {
+    ert_comm_transceiver_set_receive_active(comm_transceiver, false);
+  }
+
+  int result = ert_comm_protocol_transmit_file_transfer_status(comm_protocol,
+      ERT_STREAM_PORT_IMAGE_TRANSFER_STATUS, transfer_info->transfer_id, transfer_info->received_length);
+  if (result < 0) {
+    ert_log_error("ert_comm_protocol_transmit_file_transfer_status failed with result %d", result);
+  }
+
+  if (comm_transceiver != NULL) {
+    ert_comm_transceiver_set_receive_active(comm_transceiver, true);
+  }
+}
+
+static void ert_gateway_image_handler_receive_image_transfer(ert_gateway *gateway, const char *image_path,
+    ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream)
+{
+  ert_comm_protocol_file_transfer_info transfer_info;
+
+  int result = ert_comm_protocol_receive_file_transfer(
+      comm_protocol, stream, image_path, &gateway->running, &transfer_info);
+  if (result == -EINVAL) {
+    // Transfer header not received, the transfer cannot be identified
+    return;
+  }
+
+  // Report the received length so that the node can resume an incomplete transfer from there,
+  // or stop retransmitting a complete transfer in case it did not receive the final acknowledgement
+  ert_gateway_image_handler_transmit_transfer_status(gateway, comm_protocol, &transfer_info);
+
+  if (!transfer_info.complete) {
+    return;
+  }
+
+  struct timespec image_timestamp;
+  uint32_t image_index;
+  char image_filename[PATH_MAX];
+  char image_full_path_filename[PATH_MAX];
+
+  result = ert_gateway_image_handler_allocate_image_filename(gateway, image_path,
+      &image_index, &image_timestamp, image_filename, image_full_path_filename);
+  if (result < 0) {
+    return;
+  }
+
+  if (rename(transfer_info.filename, image_full_path_filename) < 0) {
+    ert_log_error("Error renaming file '%s' to '%s': %s",
+        transfer_info.filename, image_full_path_filename, strerror(errno));
+    return;
+  }
+
+  ert_gateway_image_handler_process_image(gateway, image_path, image_index, &image_timestamp,
+      image_filename, image_full_path_filename);
+}
+
 void *ert_gateway_image_handler(void *context)
 {
   ert_gateway *gateway = (ert_gateway *) context;
-  ert_comm_protocol *comm_protocol = gateway->comm_protocol;
-  int result;
 
   ert_log_info("Image handler thread running");
 
@@ -90,74 +248,23 @@ void *ert_gateway_image_handler(void *context)
     return NULL;
   }
 
-  char image_filename[PATH_MAX];
-  char image_full_path_filename[PATH_MAX];
-
   while (gateway->running) {
-    ert_comm_protocol_stream *stream;
+    ert_gateway_stream_queue_entry entry;
 
-    size_t count = ert_pipe_pop(gateway->image_stream_queue, &stream, 1);
-    if (count == 0) {
+    ssize_t count = ert_queue_pop(gateway->image_stream_queue, &entry, 1, ERT_QUEUE_WAIT_FOREVER);
+    if (count <= 0) {
       break;
     }
 
-    struct timespec image_timestamp;
-
-    result = ert_get_current_timestamp(&image_timestamp);
-    if (result < 0) {
-      ert_log_error("Error getting current timestamp, result %d", result);
-      continue;
-    }
-
-    // TODO: add mutex
-    uint32_t image_index = gateway->image_index;
-    gateway->image_index++;
-
-    result = ert_image_format_filename(
-        gateway->config.handler_image_config.image_format, image_index, &image_timestamp, "-local", image_filename);
-    if (result < 0) {
-      ert_log_error("ert_image_format_filename failed with result %d", result);
-      ert_comm_protocol_receive_stream_close(comm_protocol, stream);
-      continue;
-    }
+    ert_comm_protocol_stream *stream = entry.stream;
 
-    ert_image_add_path(image_path, image_filename, image_full_path_filename);
-
-    uint32_t bytes_received = 0;
-    result = ert_comm_protocol_receive_file(
-        gateway->comm_protocol, stream, image_full_path_filename, true, &gateway->running, &bytes_received);
-    if (result < 0) {
-      continue;
-    }
+    ert_comm_protocol_stream_info stream_info;
+    ert_comm_protocol_stream_get_info(stream, &stream_info);
 
-    if (bytes_received > 0) {
-      ert_image_metadata image_metadata;
-
-      result = ert_gateway_image_handler_parse_image_metadata(image_full_path_filename, &image_metadata);
-      if (result < 0) {
-        ert_log_info("Error parsing image metadata for file '%s', result %d, setting fallback values",
-            image_full_path_filename, result);
-
-        image_metadata.id = image_index;
-        image_metadata.timestamp = image_timestamp;
-        strncpy(image_metadata.filename, image_filename, PATH_MAX);
-        strncpy(image_metadata.format, gateway->config.handler_image_config.image_format, 8);
-      } else {
-        ert_image_add_path(image_path, image_metadata.filename, image_metadata.full_path_filename);
-
-        ssize_t fcopy_result = fcopyn(image_full_path_filename, image_metadata.full_path_filename);
-        if (fcopy_result < 0) {
-          ert_log_error("Error copying image file '%s' to '%s', result %d",
-              image_full_path_filename, image_metadata.full_path_filename, fcopy_result);
-
-          strncpy(image_metadata.filename, image_filename, PATH_MAX);
-        } else {
-          ert_log_info("Copied file '%s' to '%s' (%d bytes) based on image metadata",
-              image_full_path_filename, image_metadata.full_path_filename, (uint32_t) fcopy_result);
-        }
-      }
-
-      ert_event_emitter_emit(gateway->event_emitter, ERT_EVENT_NODE_IMAGE_RECEIVED, &image_metadata);
+    if (stream_info.port == ERT_STREAM_PORT_IMAGE_TRANSFER) {
+      ert_gateway_image_handler_receive_image_transfer(gateway, image_path, entry.comm_protocol, stream);
+    } else {
+      ert_gateway_image_handler_receive_image(gateway, image_path, entry.comm_protocol, stream);
     }
   }
 
@@ -51,20 +51,31 @@ int ert_gateway_handler_telemetry_gateway_collect_and_log(ert_gateway *gateway)
 #ifdef ERTGATEWAY_SUPPORT_GPSD
   if (gateway->config.gps_config.enabled) {
     result = ert_data_logger_collect_entry_params_with_gps(gateway->data_logger_gateway,
-        gateway->comm_transceiver, gateway->comm_protocol, NULL, gateway->gps_listener, &gateway->data_logger_entry_params_gateway);
+        gateway->comm_channels[0].comm_transceiver, gateway->comm_channels[0].comm_protocol, NULL, gateway->gps_listener, &gateway->data_logger_entry_params_gateway);
   } else {
     result = ert_data_logger_collect_entry_params(gateway->data_logger_gateway,
-        gateway->comm_transceiver, gateway->comm_protocol, NULL, &gateway->data_logger_entry_params_gateway);
+        gateway->comm_channels[0].comm_transceiver, gateway->comm_channels[0].comm_protocol, NULL, &gateway->data_logger_entry_params_gateway);
   }
 #else
   result = ert_data_logger_collect_entry_params(gateway->data_logger_gateway,
-      gateway->comm_transceiver, gateway->comm_protocol, NULL, &gateway->data_logger_entry_params_gateway);
+      gateway->comm_channels[0].comm_transceiver, gateway->comm_channels[0].comm_protocol, NULL, &gateway->data_logger_entry_params_gateway);
 #endif
   if (result != 0) {
     ert_log_error("ert_data_logger_collect_entry_params failed with result: %d", result);
     return result;
   }
 
+  for (uint32_t i = 1; i < gateway->comm_channel_count; i++) {
+    result = ert_data_logger_collect_comm_entry_params(gateway->data_logger_gateway, (uint8_t) i,
+        gateway->comm_channels[i].comm_transceiver, gateway->comm_channels[i].comm_protocol,
+        &gateway->data_logger_entry_params_gateway);
+    if (result != 0) {
+      ert_log_error("ert_data_logger_collect_comm_entry_params failed with result: %d", result);
+      return result;
+    }
+  }
+  gateway->data_logger_entry_params_gateway.comm_device_status_count = (uint8_t) gateway->comm_channel_count;
+
   ert_data_logger_entry entry = {0};
   result = ert_data_logger_populate_entry(gateway->data_logger_gateway, &gateway->data_logger_entry_params_gateway, &entry,
       ERT_DATA_LOGGER_ENTRY_TYPE_GATEWAY);
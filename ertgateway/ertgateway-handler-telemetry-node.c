@@ -52,6 +52,11 @@ int ert_gateway_telemetry_parse(ert_gateway *gateway, uint32_t data_length, uint
   return 0;
 }
 
+static int ert_gateway_telemetry_parse_aggregated_message(uint32_t length, uint8_t *data, void *callback_context)
+{
+  return ert_gateway_telemetry_parse((ert_gateway *) callback_context, length, data);
+}
+
 void *ert_gateway_handler_telemetry_node(void *context)
 {
   uint32_t buffer_size = TELEMETRY_DATA_BUFFER_SIZE;
@@ -62,19 +67,40 @@ void *ert_gateway_handler_telemetry_node(void *context)
   ert_log_info("Node telemetry handler thread running");
 
   while (gateway->running) {
-    ert_comm_protocol_stream *stream;
-    size_t count = ert_pipe_pop(gateway->telemetry_stream_queue, &stream, 1);
-    if (count == 0) {
+    ert_gateway_stream_queue_entry entry;
+    ssize_t count = ert_queue_pop(gateway->telemetry_stream_queue, &entry, 1, ERT_QUEUE_WAIT_FOREVER);
+    if (count <= 0) {
       break;
     }
 
+    ert_comm_protocol_stream *stream = entry.stream;
+
+    ert_comm_protocol_stream_info stream_info;
+    result = ert_comm_protocol_stream_get_info(stream, &stream_info);
+    if (result < 0) {
+      ert_log_error("ert_comm_protocol_stream_get_info failed with result %d", result);
+      continue;
+    }
+
     uint32_t total_bytes_read = 0;
-    result = ert_comm_protocol_receive_buffer(gateway->comm_protocol, stream, buffer_size, buffer, &total_bytes_read, &gateway->running);
+    result = ert_comm_protocol_receive_buffer(entry.comm_protocol, stream, buffer_size, buffer, &total_bytes_read, &gateway->running);
     if (result < 0) {
       continue;
     }
 
-    if (total_bytes_read > 0) {
+    if (total_bytes_read == 0) {
+      continue;
+    }
+
+    if (stream_info.port == ERT_STREAM_PORT_TELEMETRY_MSGPACK_AGGREGATED) {
+      result = ert_comm_protocol_aggregator_split(total_bytes_read, buffer,
+          ert_gateway_telemetry_parse_aggregated_message, gateway);
+      if (result < 0) {
+        continue;
+      }
+
+      ert_log_info("Received %d aggregated telemetry messages with size of %d bytes", result, total_bytes_read);
+    } else {
       result = ert_gateway_telemetry_parse(gateway, total_bytes_read, buffer);
       if (result < 0) {
         continue;
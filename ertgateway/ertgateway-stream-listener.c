@@ -27,12 +27,14 @@ void ert_gateway_stream_listener_callback(ert_comm_protocol *comm_protocol,
 
   ert_log_info("New stream ID %d in port %d", stream_info.stream_id, stream_info.port);
 
-  ert_pipe *stream_queue;
+  ert_queue *stream_queue;
   switch (stream_info.port) {
     case ERT_STREAM_PORT_TELEMETRY_MSGPACK:
+    case ERT_STREAM_PORT_TELEMETRY_MSGPACK_AGGREGATED:
       stream_queue = gateway->telemetry_stream_queue;
       break;
     case ERT_STREAM_PORT_IMAGE:
+    case ERT_STREAM_PORT_IMAGE_TRANSFER:
       stream_queue = gateway->image_stream_queue;
       break;
     default:
@@ -44,5 +46,18 @@ void ert_gateway_stream_listener_callback(ert_comm_protocol *comm_protocol,
       return;
   }
 
-  ert_pipe_push(stream_queue, &stream, 1);
+  ert_gateway_stream_queue_entry entry = {
+      .comm_protocol = comm_protocol,
+      .stream = stream,
+  };
+
+  ssize_t push_result = ert_queue_push(stream_queue, &entry, 1, ERT_QUEUE_WAIT_FOREVER);
+  if (push_result < 0) {
+    // The queue is closed when the gateway is shutting down
+    ert_log_warn("Dropping stream, ert_queue_push failed with result %d", push_result);
+    result = ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+    if (result < 0) {
+      ert_log_error("ert_comm_protocol_receive_stream_close failed with result %d", result);
+    }
+  }
 }
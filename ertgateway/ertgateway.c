@@ -69,10 +69,10 @@ void signal_callback(int signum)
     gateway_instance->running = false;
 
     if (gateway_instance->image_stream_queue != NULL) {
-      ert_pipe_close(gateway_instance->image_stream_queue);
+      ert_queue_close(gateway_instance->image_stream_queue);
     }
     if (gateway_instance->telemetry_stream_queue != NULL) {
-      ert_pipe_close(gateway_instance->telemetry_stream_queue);
+      ert_queue_close(gateway_instance->telemetry_stream_queue);
     }
   }
 }
@@ -111,35 +111,93 @@ int ert_gateway_initialize_inputs(ert_gateway *gateway)
   return 0;
 }
 
-int ert_gateway_initialize_comm_device(ert_gateway *gateway)
+int ert_gateway_initialize_comm_devices(ert_gateway *gateway)
 {
+  ert_comm_channel_plan_config *channel_plan_config = &gateway->config.comm_channel_plan_config;
   int result;
 
-  ert_log_info("Initializing comm device ...");
-  result = rfm9xw_open(
-      &gateway->config.rfm9xw_static_config,
-      &gateway->config.rfm9xw_config, &gateway->comm_device);
-  if (result != 0) {
-    ert_log_error("rfm9xw_open failed with result: %d", result);
-    return result;
+  gateway->comm_channel_count = 1;
+  if (ert_comm_channel_plan_is_enabled(channel_plan_config)) {
+    gateway->comm_channel_count = channel_plan_config->channel_count;
+    if (gateway->comm_channel_count > ERT_GATEWAY_MAX_COMM_CHANNEL_COUNT) {
+      ert_log_warn("Channel plan has %d channels, but gateway supports only %d radios, using %d channels",
+          channel_plan_config->channel_count, ERT_GATEWAY_MAX_COMM_CHANNEL_COUNT, ERT_GATEWAY_MAX_COMM_CHANNEL_COUNT);
+      gateway->comm_channel_count = ERT_GATEWAY_MAX_COMM_CHANNEL_COUNT;
+    }
+  }
+
+  for (uint32_t i = 0; i < gateway->comm_channel_count; i++) {
+    ert_gateway_comm_channel *comm_channel = &gateway->comm_channels[i];
+
+    comm_channel->gateway = gateway;
+    comm_channel->index = i;
+
+    memcpy(&comm_channel->rfm9xw_config, &gateway->config.rfm9xw_config, sizeof(ert_driver_rfm9xw_config));
+
+    if (ert_comm_channel_plan_is_enabled(channel_plan_config)) {
+      double frequency;
+      result = ert_comm_channel_plan_get_frequency(channel_plan_config, i, &frequency);
+      if (result != 0) {
+        ert_log_error("ert_comm_channel_plan_get_frequency failed with result: %d", result);
+        return result;
+      }
+
+      comm_channel->rfm9xw_config.transmit_config.frequency = frequency;
+      comm_channel->rfm9xw_config.receive_config.frequency = frequency;
+    }
+
+    ert_driver_rfm9xw_static_config *rfm9xw_static_config = (i == 0)
+        ? &gateway->config.rfm9xw_static_config
+        : &gateway->config.rfm9xw_channel_static_configs[i - 1];
+
+    ert_log_info("Initializing comm device for channel %d at frequency %f ...", i,
+        comm_channel->rfm9xw_config.receive_config.frequency);
+    result = rfm9xw_open(rfm9xw_static_config, &comm_channel->rfm9xw_config, &comm_channel->comm_device);
+    if (result != 0) {
+      ert_log_error("rfm9xw_open failed with result: %d", result);
+      return result;
+    }
   }
 
   return 0;
 }
 
-int ert_gateway_initialize_comm_protocol(ert_gateway *gateway, ert_comm_device *comm_device)
+static void ert_gateway_comm_link_adaptation_data_rate_callback(uint8_t data_rate_index,
+    ert_comm_link_adaptation_data_rate *data_rate, void *callback_context)
+{
+  ert_gateway_comm_channel *comm_channel = (ert_gateway_comm_channel *) callback_context;
+  ert_driver_rfm9xw_config *rfm9xw_config = &comm_channel->comm_link_adaptation_rfm9xw_config;
+
+  memcpy(rfm9xw_config, &comm_channel->rfm9xw_config, sizeof(ert_driver_rfm9xw_config));
+
+  int result = rfm9xw_set_radio_config_data_rate(&rfm9xw_config->transmit_config,
+      data_rate->spreading_factor, data_rate->bandwidth_hz, data_rate->coding_rate);
+  if (result < 0) {
+    return;
+  }
+  rfm9xw_set_radio_config_data_rate(&rfm9xw_config->receive_config,
+      data_rate->spreading_factor, data_rate->bandwidth_hz, data_rate->coding_rate);
+
+  result = ert_comm_transceiver_configure(comm_channel->comm_transceiver, rfm9xw_config);
+  if (result < 0) {
+    ert_log_error("ert_comm_transceiver_configure failed with result: %d", result);
+  }
+}
+
+int ert_gateway_initialize_comm_protocol(ert_gateway *gateway, ert_gateway_comm_channel *comm_channel)
 {
   int result;
 
-  ert_log_info("Initializing comm transceiver routine ...");
-  result = ert_comm_transceiver_start(comm_device, &gateway->config.comm_transceiver_config, &gateway->comm_transceiver);
+  ert_log_info("Initializing comm transceiver routine for channel %d ...", comm_channel->index);
+  result = ert_comm_transceiver_start(comm_channel->comm_device, &gateway->config.comm_transceiver_config,
+      &comm_channel->comm_transceiver);
   if (result != 0) {
     ert_log_error("ert_comm_transceiver_start failed with result: %d", result);
     return result;
   }
 
   ert_log_info("Initializing comm protocol device ...");
-  result = ert_comm_protocol_device_adapter_create(gateway->comm_transceiver, &gateway->comm_protocol_device);
+  result = ert_comm_protocol_device_adapter_create(comm_channel->comm_transceiver, &comm_channel->comm_protocol_device);
   if (result != 0) {
     ert_log_error("ert_comm_protocol_device_adapter_create failed with result: %d", result);
     return result;
@@ -147,12 +205,24 @@ int ert_gateway_initialize_comm_protocol(ert_gateway *gateway, ert_comm_device *
 
   ert_log_info("Initializing comm protocol ...");
   result = ert_comm_protocol_create(&gateway->config.comm_protocol_config, ert_gateway_stream_listener_callback, gateway,
-      gateway->comm_protocol_device, &gateway->comm_protocol);
+      comm_channel->comm_protocol_device, &comm_channel->comm_protocol);
   if (result != 0) {
     ert_log_error("ert_comm_protocol_create failed with result: %d", result);
     return result;
   }
 
+  if (gateway->config.comm_link_adaptation_config.enabled) {
+    ert_log_info("Initializing comm link adaptation ...");
+    result = ert_comm_link_adaptation_create(&gateway->config.comm_link_adaptation_config,
+        ert_gateway_comm_link_adaptation_data_rate_callback, comm_channel, &comm_channel->comm_link_adaptation);
+    if (result != 0) {
+      ert_log_error("ert_comm_link_adaptation_create failed with result: %d", result);
+      return result;
+    }
+
+    ert_comm_protocol_set_link_adaptation(comm_channel->comm_protocol, comm_channel->comm_link_adaptation);
+  }
+
   return 0;
 }
 
@@ -218,15 +288,15 @@ int ert_gateway_initialize_queues(ert_gateway *gateway)
 {
   int result;
 
-  result = ert_pipe_create(sizeof(ert_comm_protocol_stream *), 32, &gateway->telemetry_stream_queue);
+  result = ert_queue_create(sizeof(ert_gateway_stream_queue_entry), 32, &gateway->telemetry_stream_queue);
   if (result != 0) {
-    ert_log_error("ert_pipe_create failed with result: %d", result);
+    ert_log_error("ert_queue_create failed with result: %d", result);
     return result;
   }
 
-  result = ert_pipe_create(sizeof(ert_comm_protocol_stream *), 32, &gateway->image_stream_queue);
+  result = ert_queue_create(sizeof(ert_gateway_stream_queue_entry), 32, &gateway->image_stream_queue);
   if (result != 0) {
-    ert_log_error("ert_pipe_create failed with result: %d", result);
+    ert_log_error("ert_queue_create failed with result: %d", result);
     return result;
   }
 
@@ -237,6 +307,7 @@ static struct option ert_gateway_long_options[] = {
     {"config-file", required_argument, NULL, 'c' },
     {"log-config-file", required_argument, NULL, 'l' },
     {"init-only",  no_argument, NULL, 'i' },
+    {"check-config",  no_argument, NULL, 'k' },
     {"help",  no_argument, NULL, 'h' },
     {0, 0, NULL, 0 }
 };
@@ -253,7 +324,7 @@ void ert_gateway_display_usage(struct option *options)
 }
 
 int ert_gateway_process_options(int argc, char *argv[],
-    char *custom_config_file_name, char *custom_log_config_file_name, bool *init_only)
+    char *custom_config_file_name, char *custom_log_config_file_name, bool *init_only, bool *check_config)
 {
   int c;
 
@@ -262,7 +333,7 @@ int ert_gateway_process_options(int argc, char *argv[],
   while (1) {
     int option_index = 0;
 
-    c = getopt_long(argc, argv, "c:l:ih", ert_gateway_long_options, &option_index);
+    c = getopt_long(argc, argv, "c:l:ikh", ert_gateway_long_options, &option_index);
     if (c == -1) {
       break;
     }
@@ -283,6 +354,9 @@ int ert_gateway_process_options(int argc, char *argv[],
       case 'i':
         *init_only = true;
         break;
+      case 'k':
+        *check_config = true;
+        break;
       case 'h':
         ert_gateway_display_usage(ert_gateway_long_options);
         return -EINVAL;
@@ -304,10 +378,10 @@ int ert_gateway_process_options(int argc, char *argv[],
   return 0;
 }
 
-int ert_gateway_configure(ert_gateway *gateway, char *custom_file_name)
+int ert_gateway_configure(ert_gateway *gateway, char *custom_file_name, bool strict)
 {
   if (custom_file_name != NULL && strlen(custom_file_name) > 0) {
-    int result = ert_gateway_read_configuration(&gateway->config, custom_file_name);
+    int result = ert_gateway_read_configuration(&gateway->config, custom_file_name, strict);
     if (result < 0) {
       ert_log_fatal("Error reading application configuration from file: %s", custom_file_name);
       return -EINVAL;
@@ -325,7 +399,7 @@ int ert_gateway_configure(ert_gateway *gateway, char *custom_file_name)
       continue;
     }
 
-    int result = ert_gateway_read_configuration(&gateway->config, file_name);
+    int result = ert_gateway_read_configuration(&gateway->config, file_name, strict);
     if (result < 0) {
       ert_log_fatal("Error reading application configuration from file: %s", file_name);
       return -EINVAL;
@@ -375,14 +449,16 @@ int ert_gateway_initialize(ert_gateway *gateway)
     return -EIO;
   }
 
-  result = ert_gateway_initialize_comm_device(gateway);
+  result = ert_gateway_initialize_comm_devices(gateway);
   if (result != 0) {
     return -EIO;
   }
 
-  result = ert_gateway_initialize_comm_protocol(gateway, gateway->comm_device);
-  if (result != 0) {
-    return -EIO;
+  for (uint32_t i = 0; i < gateway->comm_channel_count; i++) {
+    result = ert_gateway_initialize_comm_protocol(gateway, &gateway->comm_channels[i]);
+    if (result != 0) {
+      return -EIO;
+    }
   }
 
   result = ert_gateway_initialize_data_logger(gateway);
@@ -405,7 +481,7 @@ int ert_gateway_initialize(ert_gateway *gateway)
 
     gateway->config.server_config.event_emitter = gateway->event_emitter;
     gateway->config.server_config.data_logger_entry_serializer = gateway->jansson_serializer;
-    gateway->config.server_config.app_comm_protocol = gateway->comm_protocol;
+    gateway->config.server_config.app_comm_protocol = gateway->comm_channels[0].comm_protocol;
     gateway->config.server_config.app_config_root_entry = ert_gateway_configuration_mapper_create(&gateway->config);
     gateway->config.server_config.app_config_update_context = gateway;
 
@@ -416,7 +492,9 @@ int ert_gateway_initialize(ert_gateway *gateway)
     }
   }
 
-  ert_comm_transceiver_set_receive_active(gateway->comm_transceiver, true);
+  for (uint32_t i = 0; i < gateway->comm_channel_count; i++) {
+    ert_comm_transceiver_set_receive_active(gateway->comm_channels[i].comm_transceiver, true);
+  }
 
   return 0;
 }
@@ -501,24 +579,30 @@ int ert_gateway_uninitialize(ert_gateway *gateway)
   ert_data_logger_destroy(gateway->data_logger_node);
   pthread_mutex_destroy(&gateway->related_entry_mutex);
 
-  ert_comm_protocol_destroy(gateway->comm_protocol);
-  ert_comm_protocol_device_adapter_destroy(gateway->comm_protocol_device);
-  ert_comm_transceiver_stop(gateway->comm_transceiver);
+  for (uint32_t i = 0; i < gateway->comm_channel_count; i++) {
+    ert_gateway_comm_channel *comm_channel = &gateway->comm_channels[i];
+    ert_comm_protocol_destroy(comm_channel->comm_protocol);
+    ert_comm_link_adaptation_destroy(comm_channel->comm_link_adaptation);
+    ert_comm_protocol_device_adapter_destroy(comm_channel->comm_protocol_device);
+    ert_comm_transceiver_stop(comm_channel->comm_transceiver);
+  }
 #ifdef ERTGATEWAY_SUPPORT_GPSD
   if (gateway->config.gps_config.enabled) {
     ert_gps_listener_stop(gateway->gps_listener);
   }
 #endif
 
-  rfm9xw_close(gateway->comm_device);
+  for (uint32_t i = 0; i < gateway->comm_channel_count; i++) {
+    rfm9xw_close(gateway->comm_channels[i].comm_device);
+  }
 #ifdef ERTGATEWAY_SUPPORT_GPSD
   if (gateway->config.gps_config.enabled) {
     ert_gps_close(gateway->gps);
   }
 #endif
 
-  ert_pipe_destroy(gateway_instance->image_stream_queue);
-  ert_pipe_destroy(gateway_instance->telemetry_stream_queue);
+  ert_queue_destroy(gateway_instance->image_stream_queue);
+  ert_queue_destroy(gateway_instance->telemetry_stream_queue);
 
   ert_log_logger_destroy(gateway->display_logger);
 
@@ -541,13 +625,14 @@ int main(int argc, char *argv[])
   char config_file_name[PATH_MAX];
   char log_config_file_name[PATH_MAX];
   bool init_only = false;
+  bool check_config = false;
 
   config_file_name[0] = '\0';
   log_config_file_name[0] = '\0';
 
   ert_process_register_backtrace_handler();
 
-  result = ert_gateway_process_options(argc, argv, config_file_name, log_config_file_name, &init_only);
+  result = ert_gateway_process_options(argc, argv, config_file_name, log_config_file_name, &init_only, &check_config);
   if (result < 0) {
     return EXIT_FAILURE;
   }
@@ -589,18 +674,47 @@ int main(int argc, char *argv[])
 
   // Set config defaults
   ert_comm_protocol_create_default_config(&gateway->config.comm_protocol_config);
+  ert_comm_link_adaptation_create_default_config(&gateway->config.comm_link_adaptation_config);
   gateway->config.comm_protocol_config.receive_buffer_length_packets = ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT * 2;
+  gateway->config.comm_channel_plan_config.channel_count = 0;
 
   gateway->config.comm_transceiver_config.transmit_buffer_length_packets = 16;
   gateway->config.comm_transceiver_config.receive_buffer_length_packets = 64;
   gateway->config.comm_transceiver_config.transmit_timeout_milliseconds = 30000;
   gateway->config.comm_transceiver_config.poll_interval_milliseconds = 1000;
-
-  result = ert_gateway_configure(gateway, config_file_name);
+  gateway->config.comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_REALTIME_PRIORITY_WEIGHT_DEFAULT;
+  gateway->config.comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_NORMAL_PRIORITY_WEIGHT_DEFAULT;
+  gateway->config.comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_BULK_PRIORITY_WEIGHT_DEFAULT;
+  gateway->config.comm_transceiver_config.transmit_batch_packet_count = ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT;
+  gateway->config.comm_transceiver_config.listen_before_talk = false;
+  gateway->config.comm_transceiver_config.listen_before_talk_max_attempts =
+      ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_MAX_ATTEMPTS_DEFAULT;
+  gateway->config.comm_transceiver_config.listen_before_talk_backoff_min_milliseconds =
+      ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_BACKOFF_MIN_MILLISECONDS_DEFAULT;
+  gateway->config.comm_transceiver_config.listen_before_talk_backoff_max_milliseconds =
+      ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_BACKOFF_MAX_MILLISECONDS_DEFAULT;
+
+  result = ert_gateway_configure(gateway, config_file_name, check_config);
   if (result < 0) {
     return EXIT_FAILURE;
   }
 
+  if (check_config) {
+    // Unknown keys fail the strict parsing above, also verify the values that are used before opening the radios
+    if (gateway->config.rfm9xw_config.transmit_config.frequency <= 0
+        || gateway->config.rfm9xw_config.receive_config.frequency <= 0) {
+      ert_log_fatal("No RFM9xW transmit and receive frequencies configured");
+      return EXIT_FAILURE;
+    }
+
+    ert_log_info("Configuration checked successfully");
+
+    return EXIT_SUCCESS;
+  }
+
   result = ert_gateway_initialize(gateway);
   if (result < 0) {
     return EXIT_FAILURE;
@@ -12,9 +12,10 @@
 #define __ERTGATEWAY_H
 
 #define ERT_GATEWAY_MAX_COMM_THREAD_COUNT 16
+#define ERT_GATEWAY_MAX_COMM_CHANNEL_COUNT 4
 
 #include "ert.h"
-#include "ert-pipe.h"
+#include "ert-queue.h"
 #include "ert-data-logger-serializer-jansson.h"
 #include "ert-data-logger-serializer-msgpack.h"
 #include "ert-data-logger-writer-zlog.h"
@@ -70,6 +71,13 @@ typedef struct _ert_gateway_config {
   ert_driver_rfm9xw_static_config rfm9xw_static_config;
   ert_driver_rfm9xw_config rfm9xw_config;
 
+  /**
+   * Static configs of the additional radios used for receiving on channels 1..n of the channel plan,
+   * the radio config is shared with the first radio.
+   */
+  ert_driver_rfm9xw_static_config rfm9xw_channel_static_configs[ERT_GATEWAY_MAX_COMM_CHANNEL_COUNT - 1];
+  ert_comm_channel_plan_config comm_channel_plan_config;
+
   ert_server_config server_config;
 
   bool st7036_enabled;
@@ -79,8 +87,33 @@ typedef struct _ert_gateway_config {
 
   ert_comm_transceiver_config comm_transceiver_config;
   ert_comm_protocol_config comm_protocol_config;
+  ert_comm_link_adaptation_config comm_link_adaptation_config;
 } ert_gateway_config;
 
+struct _ert_gateway;
+
+/**
+ * A single radio of the gateway with its own comm stack, listening on one channel of the channel plan.
+ */
+typedef struct _ert_gateway_comm_channel {
+  struct _ert_gateway *gateway;
+  uint32_t index;
+
+  ert_driver_rfm9xw_config rfm9xw_config;
+
+  ert_comm_device *comm_device;
+  ert_comm_transceiver *comm_transceiver;
+  ert_comm_protocol_device *comm_protocol_device;
+  ert_comm_protocol *comm_protocol;
+  ert_comm_link_adaptation *comm_link_adaptation;
+  ert_driver_rfm9xw_config comm_link_adaptation_rfm9xw_config;
+} ert_gateway_comm_channel;
+
+typedef struct _ert_gateway_stream_queue_entry {
+  ert_comm_protocol *comm_protocol;
+  ert_comm_protocol_stream *stream;
+} ert_gateway_stream_queue_entry;
+
 typedef struct _ert_gateway {
   volatile bool running;
 
@@ -98,10 +131,8 @@ typedef struct _ert_gateway {
   pthread_t gateway_telemetry_handler_thread;
   pthread_t display_handler_thread;
 
-  ert_comm_device *comm_device;
-  ert_comm_transceiver *comm_transceiver;
-  ert_comm_protocol_device *comm_protocol_device;
-  ert_comm_protocol *comm_protocol;
+  uint32_t comm_channel_count;
+  ert_gateway_comm_channel comm_channels[ERT_GATEWAY_MAX_COMM_CHANNEL_COUNT];
 
   ert_data_logger_serializer *jansson_serializer;
 
@@ -113,8 +144,8 @@ typedef struct _ert_gateway {
   ert_data_logger *data_logger_gateway;
   ert_data_logger_entry_params data_logger_entry_params_gateway;
 
-  ert_pipe *telemetry_stream_queue;
-  ert_pipe *image_stream_queue;
+  ert_queue *telemetry_stream_queue;
+  ert_queue *image_stream_queue;
 
   ert_data_logger_serializer *msgpack_serializer;
 
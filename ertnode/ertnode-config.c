@@ -16,6 +16,8 @@
 #include "ert-driver-gsm-modem-config.h"
 #include "ert-comm-transceiver-config.h"
 #include "ert-comm-protocol-config.h"
+#include "ert-comm-link-adaptation-config.h"
+#include "ert-comm-channel-plan-config.h"
 #include "ert-server-config.h"
 #include "ertnode-config.h"
 
@@ -26,9 +28,38 @@ int ert_node_rfm9xw_config_updated(ert_mapper_entry *entry, void *context)
   ert_log_info("Updating RFM9xW comm device configuration to:");
   ert_mapper_log_entries(entry);
 
+  int result = ert_node_apply_comm_channel_plan(&node->config);
+  if (result < 0) {
+    return result;
+  }
+
   return ert_comm_transceiver_configure(node->comm_transceiver, &node->config.rfm9xw_config);
 }
 
+/**
+ * Overrides the RFM9xW frequencies with the frequency of the channel assigned to the node in the channel plan.
+ */
+int ert_node_apply_comm_channel_plan(ert_node_config *config)
+{
+  if (!ert_comm_channel_plan_is_enabled(&config->comm_channel_plan_config)) {
+    return 0;
+  }
+
+  double frequency;
+  int result = ert_comm_channel_plan_get_frequency(&config->comm_channel_plan_config,
+      config->comm_channel_plan_config.channel_index, &frequency);
+  if (result < 0) {
+    ert_log_error("Invalid channel index %d in channel plan with %d channels",
+        config->comm_channel_plan_config.channel_index, config->comm_channel_plan_config.channel_count);
+    return result;
+  }
+
+  config->rfm9xw_config.transmit_config.frequency = frequency;
+  config->rfm9xw_config.receive_config.frequency = frequency;
+
+  return 0;
+}
+
 ert_mapper_entry *ert_node_sender_image_create_mappings(ert_node_sender_image_config *sender_image_config)
 {
   ert_mapper_entry original_image_children[] = {
@@ -113,6 +144,11 @@ ert_mapper_entry *ert_node_sender_image_create_mappings(ert_node_sender_image_co
           .value = &sender_image_config->image_path,
           .maximum_length = 1024,
       },
+      {
+          .name = "image_transfer_retry_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &sender_image_config->image_transfer_retry_count,
+      },
       {
           .name = "original_image",
           .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
@@ -154,6 +190,21 @@ ert_mapper_entry *ert_node_sender_telemetry_create_mappings(ert_node_sender_tele
           .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
           .value = &sender_telemetry_config->minimal_telemetry_data_send_interval,
       },
+      {
+          .name = "aggregation_enabled",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &sender_telemetry_config->aggregation_enabled,
+      },
+      {
+          .name = "aggregation_max_bytes",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &sender_telemetry_config->aggregation_max_bytes,
+      },
+      {
+          .name = "aggregation_max_delay_millis",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &sender_telemetry_config->aggregation_max_delay_millis,
+      },
       {
           .type = ERT_MAPPER_ENTRY_TYPE_NONE,
       },
@@ -297,6 +348,10 @@ ert_mapper_entry *ert_node_configuration_mapper_create(ert_node_config *config)
       ert_comm_transceiver_create_mappings(&config->comm_transceiver_config);
   ert_mapper_entry *comm_protocol_children =
       ert_comm_protocol_create_mappings(&config->comm_protocol_config);
+  ert_mapper_entry *comm_link_adaptation_children =
+      ert_comm_link_adaptation_create_mappings(&config->comm_link_adaptation_config);
+  ert_mapper_entry *comm_channel_plan_children =
+      ert_comm_channel_plan_create_mappings(&config->comm_channel_plan_config);
 
   ert_mapper_entry comm_devices_children[] = {
       {
@@ -355,6 +410,18 @@ ert_mapper_entry *ert_node_configuration_mapper_create(ert_node_config *config)
           .children = comm_protocol_children,
           .children_allocated = true,
       },
+      {
+          .name = "comm_link_adaptation",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = comm_link_adaptation_children,
+          .children_allocated = true,
+      },
+      {
+          .name = "comm_channel_plan",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = comm_channel_plan_children,
+          .children_allocated = true,
+      },
       {
           .name = "comm_devices",
           .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
@@ -373,7 +440,7 @@ ert_mapper_entry *ert_node_configuration_mapper_create(ert_node_config *config)
   return ert_mapper_allocate(root_children);
 }
 
-int ert_node_read_configuration(ert_node_config *config, char *config_file_name)
+int ert_node_read_configuration(ert_node_config *config, char *config_file_name, bool strict)
 {
   FILE *config_file = fopen(config_file_name, "rb");
   if (config_file == NULL) {
@@ -388,7 +455,9 @@ int ert_node_read_configuration(ert_node_config *config, char *config_file_name)
     return -ENOMEM;
   }
 
-  int result = ert_yaml_parse_file(config_file, config_root_entry);
+  int result = strict
+      ? ert_yaml_parse_file_strict(config_file, config_root_entry)
+      : ert_yaml_parse_file(config_file, config_root_entry);
   if (result == 0) {
     ert_log_info("Using configuration:");
     ert_mapper_log_entries(config_root_entry);
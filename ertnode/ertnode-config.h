@@ -15,6 +15,7 @@
 #include "ert-mapper.h"
 
 ert_mapper_entry *ert_node_configuration_mapper_create(ert_node_config *config);
-int ert_node_read_configuration(ert_node_config *config, char *config_file_name);
+int ert_node_read_configuration(ert_node_config *config, char *config_file_name, bool strict);
+int ert_node_apply_comm_channel_plan(ert_node_config *config);
 
 #endif
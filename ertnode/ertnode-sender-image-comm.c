@@ -9,10 +9,13 @@
  */
 
 #include <memory.h>
+#include <errno.h>
 
 #include "ertnode.h"
 #include "ertnode-sender-image-comm.h"
 
+#define ERT_NODE_IMAGE_TRANSFER_STATUS_EXTRA_WAIT_MILLIS 10000
+
 typedef struct _ert_node_image_sender_comm_context {
   ert_node *node;
 
@@ -34,6 +37,112 @@ static void ert_node_sender_image_comm_image_captured_listener(char *event, void
   pthread_mutex_unlock(&sender_comm_context->current_image_metadata_mutex);
 }
 
+static int ert_node_sender_image_comm_wait_for_transfer_status(ert_node *node, uint32_t transfer_id,
+    uint32_t *received_length_rcv)
+{
+  uint32_t timeout_millis = node->config.comm_protocol_config.stream_inactivity_timeout_millis
+      + ERT_NODE_IMAGE_TRANSFER_STATUS_EXTRA_WAIT_MILLIS;
+  int result = -EINTR;
+
+  // The comm device receives only while waiting for acknowledgements unless reception is enabled
+  ert_comm_transceiver_set_receive_active(node->comm_transceiver, true);
+
+  while (node->running) {
+    ert_comm_protocol_stream *stream;
+
+    ssize_t pop_result = ert_pipe_pop_timed(node->image_transfer_status_stream_queue, &stream, 1, timeout_millis);
+    if (pop_result < 0) {
+      result = -ETIMEDOUT;
+      break;
+    }
+    if (pop_result == 0) {
+      result = -EPIPE;
+      break;
+    }
+
+    uint32_t status_transfer_id;
+    uint32_t received_length;
+    result = ert_comm_protocol_receive_file_transfer_status(node->comm_protocol, stream, &node->running,
+        &status_transfer_id, &received_length);
+    ert_comm_protocol_receive_stream_close(node->comm_protocol, stream);
+    if (result < 0) {
+      ert_log_warn("ert_comm_protocol_receive_file_transfer_status failed with result %d", result);
+      continue;
+    }
+
+    if (status_transfer_id != transfer_id) {
+      ert_log_info("Ignoring status of transfer %d while waiting for transfer %d", status_transfer_id, transfer_id);
+      continue;
+    }
+
+    *received_length_rcv = received_length;
+    result = 0;
+    break;
+  }
+
+  ert_comm_transceiver_set_receive_active(node->comm_transceiver, false);
+
+  return result;
+}
+
+static void ert_node_sender_image_comm_discard_transfer_status(ert_node *node)
+{
+  ert_comm_protocol_stream *stream;
+
+  while (ert_pipe_pop_timed(node->image_transfer_status_stream_queue, &stream, 1, 1) > 0) {
+    ert_comm_protocol_receive_stream_close(node->comm_protocol, stream);
+  }
+}
+
+static int ert_node_sender_image_comm_transmit_image(ert_node *node, ert_image_metadata *image_metadata,
+    uint32_t data_length, uint8_t *data)
+{
+  uint32_t retry_count = node->config.sender_image_config.image_transfer_retry_count;
+  uint32_t offset = 0;
+  uint32_t total_length;
+  int result;
+
+  result = ert_comm_protocol_get_file_transfer_total_length(image_metadata->full_path_filename, data_length,
+      &total_length);
+  if (result < 0) {
+    return result;
+  }
+
+  ert_node_sender_image_comm_discard_transfer_status(node);
+
+  for (uint32_t attempt = 0; node->running; attempt++) {
+    result = ert_comm_protocol_transmit_file_transfer(node->comm_protocol, ERT_STREAM_PORT_IMAGE_TRANSFER,
+        image_metadata->id, offset, image_metadata->full_path_filename, data_length, data, &node->running);
+    if (result == 0) {
+      return 0;
+    }
+    if (result == -EIO || attempt >= retry_count) {
+      break;
+    }
+
+    ert_log_warn("Transfer of image %d failed with result %d, waiting for transfer status ...",
+        image_metadata->id, result);
+
+    // The gateway reports how much of the transfer it received after the stream has timed out
+    uint32_t received_length;
+    result = ert_node_sender_image_comm_wait_for_transfer_status(node, image_metadata->id, &received_length);
+    if (result < 0) {
+      ert_log_warn("No status received for transfer of image %d, result %d, retransmitting from start",
+          image_metadata->id, result);
+      offset = 0;
+    } else if (received_length == total_length) {
+      // The gateway received the whole transfer, only the final acknowledgement was lost
+      ert_log_info("Transfer of image %d was received completely", image_metadata->id);
+      return 0;
+    } else {
+      ert_log_info("Resuming transfer of image %d from offset %d", image_metadata->id, received_length);
+      offset = received_length;
+    }
+  }
+
+  return result;
+}
+
 void *ert_node_sender_image_comm(void *context)
 {
   ert_node *node = (ert_node *) context;
@@ -78,12 +187,11 @@ void *ert_node_sender_image_comm(void *context)
 
     ert_log_info("Transmitting image %d: %s ...", image_metadata.id, image_metadata.full_path_filename);
 
-    result = ert_comm_protocol_transmit_file_and_buffer(node->comm_protocol, ERT_STREAM_PORT_IMAGE,
-        true, image_metadata.full_path_filename, image_metadata_serialized_length, image_metadata_serialized_data,
-        &node->running);
+    result = ert_node_sender_image_comm_transmit_image(node, &image_metadata,
+        image_metadata_serialized_length, image_metadata_serialized_data);
     free(image_metadata_serialized_data);
     if (result < 0) {
-      ert_log_error("ert_comm_protocol_transmit_file_and_buffer failed with result %d", result);
+      ert_log_error("Transmitting image %d failed with result %d", image_metadata.id, result);
       continue;
     }
 
@@ -20,6 +20,8 @@ typedef struct _ert_node_telemetry_sender_comm_context {
   pthread_mutex_t current_entry_mutex;
   volatile bool current_entry_valid;
   ert_data_logger_entry *current_entry;
+
+  ert_comm_protocol_aggregator *aggregator;
 } ert_node_telemetry_sender_comm_context;
 
 static ert_data_logger_serializer_msgpack_settings *msgpack_telemetry_minimal =
@@ -52,6 +54,19 @@ static int ert_node_telemetry_send_comm(ert_node_telemetry_sender_comm_context *
     goto error;
   }
 
+  if (sender_comm_context->aggregator != NULL) {
+    result = ert_comm_protocol_aggregator_add(sender_comm_context->aggregator, data_length, data, data_logger_entry);
+    if (result == 0) {
+      ert_log_info("Aggregating telemetry data with size of %d bytes ...", data_length);
+      free(data);
+      // The entry is passed to the transmitted callback
+      return 0;
+    } else if (result != -EMSGSIZE) {
+      ert_log_error("ert_comm_protocol_aggregator_add failed with result: %d", result);
+      goto error;
+    }
+  }
+
   ert_log_info("Transmitting telemetry data with size of %d bytes ...", data_length);
 
   result = ert_comm_protocol_transmit_buffer(node->comm_protocol, ERT_STREAM_PORT_TELEMETRY_MSGPACK,
@@ -82,6 +97,24 @@ static int ert_node_telemetry_send_comm(ert_node_telemetry_sender_comm_context *
   return result;
 }
 
+static void ert_node_telemetry_sender_comm_aggregated_transmitted(int result, void *message_context,
+    void *callback_context)
+{
+  ert_node_telemetry_sender_comm_context *sender_comm_context = (ert_node_telemetry_sender_comm_context *) callback_context;
+  ert_node *node = sender_comm_context->node;
+  ert_data_logger_entry *data_logger_entry = (ert_data_logger_entry *) message_context;
+
+  if (result < 0) {
+    if (data_logger_entry != NULL) {
+      ert_data_logger_destroy_entry(data_logger_entry);
+    }
+    ert_event_emitter_emit(node->event_emitter, ERT_EVENT_NODE_TELEMETRY_TRANSMISSION_FAILURE, NULL);
+    return;
+  }
+
+  ert_event_emitter_emit(node->event_emitter, ERT_EVENT_NODE_TELEMETRY_TRANSMITTED, data_logger_entry);
+}
+
 static void ert_node_sender_telemetry_comm_telemetry_collected_listener(char *event, void *data, void *context)
 {
   ert_node_telemetry_sender_comm_context *sender_comm_context = (ert_node_telemetry_sender_comm_context *) context;
@@ -120,6 +153,24 @@ void *ert_node_telemetry_sender_comm(void *context)
     return NULL;
   }
 
+  ert_node_sender_telemetry_config *sender_telemetry_config = &node->config.sender_telemetry_config;
+  if (sender_telemetry_config->aggregation_enabled) {
+    ert_comm_protocol_aggregator_config aggregator_config = {
+        .port = ERT_STREAM_PORT_TELEMETRY_MSGPACK_AGGREGATED,
+        .enable_acks = true,
+        .max_length = sender_telemetry_config->aggregation_max_bytes,
+        .max_delay_millis = sender_telemetry_config->aggregation_max_delay_millis,
+    };
+
+    result = ert_comm_protocol_aggregator_create(node->comm_protocol, &aggregator_config,
+        ert_node_telemetry_sender_comm_aggregated_transmitted, &sender_comm_context, &sender_comm_context.aggregator);
+    if (result < 0) {
+      ert_log_error("ert_comm_protocol_aggregator_create failed with result %d, transmitting telemetry without aggregation",
+          result);
+      sender_comm_context.aggregator = NULL;
+    }
+  }
+
   ert_event_emitter_add_listener(node->event_emitter, ERT_EVENT_NODE_TELEMETRY_COLLECTED,
       ert_node_sender_telemetry_comm_telemetry_collected_listener, &sender_comm_context);
 
@@ -148,6 +199,11 @@ void *ert_node_telemetry_sender_comm(void *context)
   ert_event_emitter_remove_listener(node->event_emitter, ERT_EVENT_NODE_TELEMETRY_COLLECTED,
       ert_node_sender_telemetry_comm_telemetry_collected_listener);
 
+  if (sender_comm_context.aggregator != NULL) {
+    ert_comm_protocol_aggregator_destroy(sender_comm_context.aggregator);
+    sender_comm_context.aggregator = NULL;
+  }
+
   pthread_mutex_lock(&sender_comm_context.current_entry_mutex);
   if (sender_comm_context.current_entry != NULL) {
     ert_data_logger_destroy_entry(sender_comm_context.current_entry);
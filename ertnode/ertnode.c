@@ -67,6 +67,7 @@ static void log_mallinfo(void)
 void comm_protocol_stream_listener_callback(ert_comm_protocol *comm_protocol,
     ert_comm_protocol_stream *stream, void *callback_context)
 {
+  ert_node *node = (ert_node *) callback_context;
   ert_comm_protocol_stream_info stream_info;
 
   int result = ert_comm_protocol_stream_get_info(stream, &stream_info);
@@ -76,6 +77,10 @@ void comm_protocol_stream_listener_callback(ert_comm_protocol *comm_protocol,
   }
 
   ert_log_info("New stream ID %d in port %d", stream_info.stream_id, stream_info.port);
+
+  if (stream_info.port == ERT_STREAM_PORT_IMAGE_TRANSFER_STATUS) {
+    ert_pipe_push(node->image_transfer_status_stream_queue, &stream, 1);
+  }
 }
 
 void signal_callback(int signum)
@@ -123,6 +128,11 @@ int ert_node_initialize_comm_device(ert_node *node)
 {
   int result;
 
+  result = ert_node_apply_comm_channel_plan(&node->config);
+  if (result != 0) {
+    return result;
+  }
+
   ert_log_info("Initializing comm device ...");
   result = rfm9xw_open(&node->config.rfm9xw_static_config,
       &node->config.rfm9xw_config, &node->comm_device);
@@ -134,6 +144,28 @@ int ert_node_initialize_comm_device(ert_node *node)
   return 0;
 }
 
+static void ert_node_comm_link_adaptation_data_rate_callback(uint8_t data_rate_index,
+    ert_comm_link_adaptation_data_rate *data_rate, void *callback_context)
+{
+  ert_node *node = (ert_node *) callback_context;
+  ert_driver_rfm9xw_config *rfm9xw_config = &node->comm_link_adaptation_rfm9xw_config;
+
+  memcpy(rfm9xw_config, &node->config.rfm9xw_config, sizeof(ert_driver_rfm9xw_config));
+
+  int result = rfm9xw_set_radio_config_data_rate(&rfm9xw_config->transmit_config,
+      data_rate->spreading_factor, data_rate->bandwidth_hz, data_rate->coding_rate);
+  if (result < 0) {
+    return;
+  }
+  rfm9xw_set_radio_config_data_rate(&rfm9xw_config->receive_config,
+      data_rate->spreading_factor, data_rate->bandwidth_hz, data_rate->coding_rate);
+
+  result = ert_comm_transceiver_configure(node->comm_transceiver, rfm9xw_config);
+  if (result < 0) {
+    ert_log_error("ert_comm_transceiver_configure failed with result: %d", result);
+  }
+}
+
 int ert_node_initialize_comm_protocol(ert_node *node, ert_comm_device *comm_device)
 {
   int result;
@@ -152,6 +184,12 @@ int ert_node_initialize_comm_protocol(ert_node *node, ert_comm_device *comm_devi
     return result;
   }
 
+  result = ert_pipe_create(sizeof(ert_comm_protocol_stream *), 4, &node->image_transfer_status_stream_queue);
+  if (result != 0) {
+    ert_log_error("ert_pipe_create failed with result: %d", result);
+    return result;
+  }
+
   ert_log_info("Initializing comm protocol ...");
   result = ert_comm_protocol_create(&node->config.comm_protocol_config, comm_protocol_stream_listener_callback, node,
       node->comm_protocol_device, &node->comm_protocol);
@@ -160,6 +198,18 @@ int ert_node_initialize_comm_protocol(ert_node *node, ert_comm_device *comm_devi
     return result;
   }
 
+  if (node->config.comm_link_adaptation_config.enabled) {
+    ert_log_info("Initializing comm link adaptation ...");
+    result = ert_comm_link_adaptation_create(&node->config.comm_link_adaptation_config,
+        ert_node_comm_link_adaptation_data_rate_callback, node, &node->comm_link_adaptation);
+    if (result != 0) {
+      ert_log_error("ert_comm_link_adaptation_create failed with result: %d", result);
+      return result;
+    }
+
+    ert_comm_protocol_set_link_adaptation(node->comm_protocol, node->comm_link_adaptation);
+  }
+
   return 0;
 }
 
@@ -269,6 +319,7 @@ static struct option ert_node_long_options[] = {
     {"log-config-file", required_argument, NULL, 'l' },
     {"gps-config",  no_argument, NULL, 'g' },
     {"init-only",  no_argument, NULL, 'i' },
+    {"check-config",  no_argument, NULL, 'k' },
     {"help",  no_argument, NULL, 'h' },
     {NULL, 0, NULL, 0 }
 };
@@ -285,7 +336,8 @@ void ert_node_display_usage(struct option *options)
 }
 
 int ert_node_process_options(int argc, char **argv,
-    char *custom_config_file_name, char *custom_log_config_file_name, bool *init_only, bool *gps_config)
+    char *custom_config_file_name, char *custom_log_config_file_name, bool *init_only, bool *gps_config,
+    bool *check_config)
 {
   int c;
 
@@ -294,7 +346,7 @@ int ert_node_process_options(int argc, char **argv,
   while (1) {
     int option_index = 0;
 
-    c = getopt_long(argc, argv, "c:l:igh", ert_node_long_options, &option_index);
+    c = getopt_long(argc, argv, "c:l:igkh", ert_node_long_options, &option_index);
     if (c == -1) {
       break;
     }
@@ -314,6 +366,9 @@ int ert_node_process_options(int argc, char **argv,
       case 'g':
         *gps_config = true;
         break;
+      case 'k':
+        *check_config = true;
+        break;
       case 'h':
         ert_node_display_usage(ert_node_long_options);
         return -EINVAL;
@@ -335,10 +390,10 @@ int ert_node_process_options(int argc, char **argv,
   return 0;
 }
 
-int ert_node_configure(ert_node *node, char *custom_file_name)
+int ert_node_configure(ert_node *node, char *custom_file_name, bool strict)
 {
   if (custom_file_name != NULL && strlen(custom_file_name) > 0) {
-    int result = ert_node_read_configuration(&node->config, custom_file_name);
+    int result = ert_node_read_configuration(&node->config, custom_file_name, strict);
     if (result < 0) {
       ert_log_fatal("Error reading application configuration from file: %s", custom_file_name);
       return -EINVAL;
@@ -356,7 +411,7 @@ int ert_node_configure(ert_node *node, char *custom_file_name)
       continue;
     }
 
-    int result = ert_node_read_configuration(&node->config, file_name);
+    int result = ert_node_read_configuration(&node->config, file_name, strict);
     if (result < 0) {
       ert_log_fatal("Error reading application configuration from file: %s", file_name);
       return -EINVAL;
@@ -522,6 +577,9 @@ int ert_node_uninitialize(ert_node *node)
   ert_data_logger_destroy(node->data_logger);
 
   ert_comm_protocol_destroy(node->comm_protocol);
+  ert_comm_link_adaptation_destroy(node->comm_link_adaptation);
+  ert_pipe_close(node->image_transfer_status_stream_queue);
+  ert_pipe_destroy(node->image_transfer_status_stream_queue);
   ert_comm_protocol_device_adapter_destroy(node->comm_protocol_device);
   ert_comm_transceiver_stop(node->comm_transceiver);
   if (node->config.gps_config.enabled) {
@@ -553,13 +611,15 @@ int main(int argc, char *argv[])
   char log_config_file_name[PATH_MAX];
   bool init_only = false;
   bool gps_config = false;
+  bool check_config = false;
 
   config_file_name[0] = '\0';
   log_config_file_name[0] = '\0';
 
   ert_process_register_backtrace_handler();
 
-  result = ert_node_process_options(argc, argv, config_file_name, log_config_file_name, &init_only, &gps_config);
+  result = ert_node_process_options(argc, argv, config_file_name, log_config_file_name, &init_only, &gps_config,
+      &check_config);
   if (result < 0) {
     return EXIT_FAILURE;
   }
@@ -595,18 +655,62 @@ int main(int argc, char *argv[])
 
   // Set config defaults
   ert_comm_protocol_create_default_config(&node->config.comm_protocol_config);
+  ert_comm_link_adaptation_create_default_config(&node->config.comm_link_adaptation_config);
+  node->config.comm_channel_plan_config.channel_count = 0;
+  node->config.comm_protocol_config.stream_realtime_priority_ports = ERT_COMM_PROTOCOL_PORT_MASK(ERT_STREAM_PORT_TELEMETRY_MSGPACK)
+      | ERT_COMM_PROTOCOL_PORT_MASK(ERT_STREAM_PORT_TELEMETRY_MSGPACK_AGGREGATED);
+  node->config.comm_protocol_config.stream_bulk_priority_ports =
+      ERT_COMM_PROTOCOL_PORT_MASK(ERT_STREAM_PORT_IMAGE) | ERT_COMM_PROTOCOL_PORT_MASK(ERT_STREAM_PORT_IMAGE_TRANSFER);
+  node->config.comm_protocol_config.stream_compression_ports = ERT_COMM_PROTOCOL_PORT_MASK(ERT_STREAM_PORT_TELEMETRY_MSGPACK)
+      | ERT_COMM_PROTOCOL_PORT_MASK(ERT_STREAM_PORT_TELEMETRY_MSGPACK_AGGREGATED);
+  node->config.sender_telemetry_config.aggregation_enabled = true;
+  node->config.sender_telemetry_config.aggregation_max_bytes = ERT_NODE_TELEMETRY_AGGREGATION_MAX_BYTES_DEFAULT;
+  node->config.sender_telemetry_config.aggregation_max_delay_millis = ERT_COMM_PROTOCOL_AGGREGATOR_MAX_DELAY_MILLIS_DEFAULT;
+  node->config.sender_image_config.image_transfer_retry_count = 3;
   node->config.comm_transceiver_config.transmit_buffer_length_packets = 16;
   node->config.comm_transceiver_config.receive_buffer_length_packets = 16;
   node->config.comm_transceiver_config.transmit_timeout_milliseconds = 30000;
   node->config.comm_transceiver_config.poll_interval_milliseconds = 1000;
   node->config.comm_transceiver_config.maximum_receive_time_milliseconds =
       node->config.comm_protocol_config.stream_acknowledgement_receive_timeout_millis * 5;
-
-  result = ert_node_configure(node, config_file_name);
+  node->config.comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_REALTIME_PRIORITY_WEIGHT_DEFAULT;
+  node->config.comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_NORMAL_PRIORITY_WEIGHT_DEFAULT;
+  node->config.comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_BULK_PRIORITY_WEIGHT_DEFAULT;
+  node->config.comm_transceiver_config.transmit_realtime_maximum_wait_milliseconds = 2000;
+  node->config.comm_transceiver_config.transmit_batch_packet_count = ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT;
+  node->config.comm_transceiver_config.listen_before_talk = false;
+  node->config.comm_transceiver_config.listen_before_talk_max_attempts =
+      ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_MAX_ATTEMPTS_DEFAULT;
+  node->config.comm_transceiver_config.listen_before_talk_backoff_min_milliseconds =
+      ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_BACKOFF_MIN_MILLISECONDS_DEFAULT;
+  node->config.comm_transceiver_config.listen_before_talk_backoff_max_milliseconds =
+      ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_BACKOFF_MAX_MILLISECONDS_DEFAULT;
+
+  result = ert_node_configure(node, config_file_name, check_config);
   if (result < 0) {
     return EXIT_FAILURE;
   }
 
+  if (check_config) {
+    // Unknown keys fail the strict parsing above, also verify the values that are used before opening the radio
+    result = ert_node_apply_comm_channel_plan(&node->config);
+    if (result < 0) {
+      return EXIT_FAILURE;
+    }
+    if (node->config.rfm9xw_config.transmit_config.frequency <= 0
+        || node->config.rfm9xw_config.receive_config.frequency <= 0) {
+      ert_log_fatal("No RFM9xW transmit and receive frequencies configured");
+      return EXIT_FAILURE;
+    }
+
+    ert_log_info("Configuration checked successfully");
+
+    return EXIT_SUCCESS;
+  }
+
   if (gps_config) {
     hal_serial_device_config serial_device_config;
     strncpy(serial_device_config.device, node->config.gps_config.serial_device_file, 256);
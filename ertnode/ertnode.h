@@ -17,17 +17,25 @@
 #include <pthread.h>
 
 #include "ert.h"
+#include "ert-pipe.h"
 #include "ert-driver-gsm-modem.h"
 #include "ert-driver-rfm9xw.h"
 #include "ert-server.h"
 
 #include "ertnode-common.h"
 
+// Aggregated telemetry messages fit in the payload of a single packet
+#define ERT_NODE_TELEMETRY_AGGREGATION_MAX_BYTES_DEFAULT 250
+
 typedef struct _ert_node_sender_telemetry_config {
   bool enabled;
   uint32_t telemetry_collect_interval_seconds;
   uint32_t telemetry_send_interval;
   uint32_t minimal_telemetry_data_send_interval;
+
+  bool aggregation_enabled;
+  uint32_t aggregation_max_bytes;
+  uint32_t aggregation_max_delay_millis;
 } ert_node_sender_telemetry_config;
 
 typedef struct _ert_node_sender_image_config {
@@ -44,6 +52,8 @@ typedef struct _ert_node_sender_image_config {
   char image_path[1024];
   int16_t original_image_quality;
 
+  uint32_t image_transfer_retry_count;
+
   char transmitted_image_format[16];
   int16_t transmitted_image_width;
   int16_t transmitted_image_height;
@@ -76,6 +86,7 @@ typedef struct _ert_node_config {
 
   ert_driver_rfm9xw_static_config rfm9xw_static_config;
   ert_driver_rfm9xw_config rfm9xw_config;
+  ert_comm_channel_plan_config comm_channel_plan_config;
 
   ert_node_gsm_modem_config gsm_modem_config;
 
@@ -85,6 +96,7 @@ typedef struct _ert_node_config {
 
   ert_comm_transceiver_config comm_transceiver_config;
   ert_comm_protocol_config comm_protocol_config;
+  ert_comm_link_adaptation_config comm_link_adaptation_config;
 
   ert_server_config server_config;
 } ert_node_config;
@@ -110,6 +122,9 @@ typedef struct _ert_node {
   ert_comm_transceiver *comm_transceiver;
   ert_comm_protocol_device *comm_protocol_device;
   ert_comm_protocol *comm_protocol;
+  ert_comm_link_adaptation *comm_link_adaptation;
+  ert_driver_rfm9xw_config comm_link_adaptation_rfm9xw_config;
+  ert_pipe *image_transfer_status_stream_queue;
 
   bool gsm_modem_initialized;
   ert_driver_gsm_modem *gsm_modem;
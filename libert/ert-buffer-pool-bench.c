@@ -0,0 +1,161 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+ * Benchmark for buffer pool operations at different pool sizes: a pool that is nearly exhausted, which used to be
+ * the worst case for acquiring a buffer, and several threads acquiring and releasing buffers concurrently.
+ * The cost per operation should not depend on the pool size.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "ert-buffer-pool.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define BENCH_ELEMENT_SIZE 256
+#define BENCH_OPERATION_COUNT_DEFAULT 2000000
+#define BENCH_THREAD_COUNT 4
+#define BENCH_THREAD_HELD_COUNT 4
+
+typedef struct _ert_buffer_pool_bench_context {
+  ert_buffer_pool *buffer_pool;
+  uint64_t operation_count;
+} ert_buffer_pool_bench_context;
+
+static double ert_buffer_pool_bench_elapsed_millis(struct timespec *start_time)
+{
+  struct timespec end_time;
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+  return (double) (end_time.tv_sec - start_time->tv_sec) * 1000.0
+      + (double) (end_time.tv_nsec - start_time->tv_nsec) / 1000000.0;
+}
+
+static int ert_buffer_pool_bench_acquire_release(ert_buffer_pool *buffer_pool, uint64_t operation_count)
+{
+  for (uint64_t i = 0; i < operation_count; i++) {
+    void *pointer;
+    int result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+    if (result < 0) {
+      return result;
+    }
+    ert_buffer_pool_get_used_count(buffer_pool);
+    result = ert_buffer_pool_release(buffer_pool, pointer);
+    if (result < 0) {
+      return result;
+    }
+  }
+
+  return 0;
+}
+
+static void *ert_buffer_pool_bench_thread(void *arg)
+{
+  ert_buffer_pool_bench_context *context = (ert_buffer_pool_bench_context *) arg;
+  void *held[BENCH_THREAD_HELD_COUNT];
+
+  for (uint64_t i = 0; i < context->operation_count; i += BENCH_THREAD_HELD_COUNT) {
+    for (size_t j = 0; j < BENCH_THREAD_HELD_COUNT; j++) {
+      while (ert_buffer_pool_acquire(context->buffer_pool, &held[j]) < 0);
+    }
+    for (size_t j = 0; j < BENCH_THREAD_HELD_COUNT; j++) {
+      ert_buffer_pool_release(context->buffer_pool, held[j]);
+    }
+  }
+
+  return NULL;
+}
+
+static int ert_buffer_pool_bench_run(size_t pool_size, uint64_t operation_count)
+{
+  ert_buffer_pool *buffer_pool;
+  struct timespec start_time;
+  int result;
+
+  result = ert_buffer_pool_create(BENCH_ELEMENT_SIZE, pool_size, &buffer_pool);
+  if (result < 0) {
+    return result;
+  }
+
+  // Leave a single free buffer in the pool
+  for (size_t i = 0; i < pool_size - 1; i++) {
+    void *pointer;
+    ert_buffer_pool_acquire(buffer_pool, &pointer);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  result = ert_buffer_pool_bench_acquire_release(buffer_pool, operation_count);
+  double exhausted_millis = ert_buffer_pool_bench_elapsed_millis(&start_time);
+  if (result < 0) {
+    ert_buffer_pool_destroy(buffer_pool);
+    return result;
+  }
+
+  ert_buffer_pool_clear(buffer_pool);
+
+  ert_buffer_pool_bench_context context = {
+      .buffer_pool = buffer_pool,
+      .operation_count = operation_count / BENCH_THREAD_COUNT,
+  };
+  pthread_t threads[BENCH_THREAD_COUNT];
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  for (size_t i = 0; i < BENCH_THREAD_COUNT; i++) {
+    result = pthread_create(&threads[i], NULL, ert_buffer_pool_bench_thread, &context);
+    if (result != 0) {
+      ert_log_error("Error starting benchmark thread, result %d", result);
+      return -EIO;
+    }
+  }
+  for (size_t i = 0; i < BENCH_THREAD_COUNT; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  double concurrent_millis = ert_buffer_pool_bench_elapsed_millis(&start_time);
+
+  printf("pool_size=%zu operations=%" PRIu64 " exhausted_ms=%.3f exhausted_ns_per_op=%.1f "
+      "concurrent_threads=%d concurrent_ms=%.3f concurrent_ns_per_op=%.1f\n",
+      pool_size, operation_count, exhausted_millis, exhausted_millis * 1000000.0 / (double) operation_count,
+      BENCH_THREAD_COUNT, concurrent_millis, concurrent_millis * 1000000.0 / (double) operation_count);
+  fflush(stdout);
+
+  ert_buffer_pool_destroy(buffer_pool);
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t pool_sizes[] = { 16, 256, 4096, 65536 };
+  uint64_t operation_count = BENCH_OPERATION_COUNT_DEFAULT;
+  int result = 0;
+
+  if (argc > 1) {
+    operation_count = strtoull(argv[1], NULL, 10);
+  }
+
+  ert_test_init();
+
+  for (size_t i = 0; i < sizeof(pool_sizes) / sizeof(size_t); i++) {
+    result = ert_buffer_pool_bench_run(pool_sizes[i], operation_count);
+    if (result < 0) {
+      break;
+    }
+  }
+
+  ert_test_uninit();
+
+  return (result < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "ert-buffer-pool.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define BUFFER_POOL_TEST_ELEMENT_SIZE 64
+#define BUFFER_POOL_TEST_COUNT 100
+#define BUFFER_POOL_TEST_STRESS_COUNT 32
+#define BUFFER_POOL_TEST_STRESS_THREAD_COUNT 8
+#define BUFFER_POOL_TEST_STRESS_ITERATIONS 200000
+#define BUFFER_POOL_TEST_STRESS_MAX_HELD 6
+
+typedef struct _ert_buffer_pool_test_thread_context {
+  ert_buffer_pool *buffer_pool;
+  atomic_int *owners;
+  int thread_id;
+  uint32_t acquire_count;
+  uint32_t failed_acquire_count;
+} ert_buffer_pool_test_thread_context;
+
+void ert_buffer_pool_test_run_test_acquire_release()
+{
+  ert_buffer_pool *buffer_pool;
+  uint8_t *buffers[BUFFER_POOL_TEST_COUNT];
+  void *pointer;
+  int result;
+
+  result = ert_buffer_pool_create(BUFFER_POOL_TEST_ELEMENT_SIZE, BUFFER_POOL_TEST_COUNT, &buffer_pool);
+  assert(result == 0);
+  assert(ert_buffer_pool_get_used_count(buffer_pool) == 0);
+
+  // Buffers are handed out in address order from a fresh pool
+  for (size_t i = 0; i < BUFFER_POOL_TEST_COUNT; i++) {
+    result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+    assert(result == 0);
+    buffers[i] = pointer;
+    if (i > 0) {
+      assert(buffers[i] == buffers[i - 1] + BUFFER_POOL_TEST_ELEMENT_SIZE);
+    }
+    memset(buffers[i], (int) i, BUFFER_POOL_TEST_ELEMENT_SIZE);
+    assert(ert_buffer_pool_get_used_count(buffer_pool) == i + 1);
+  }
+
+  result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+  assert(result == -ENOBUFS);
+
+  // The most recently released buffer is reused first
+  result = ert_buffer_pool_release(buffer_pool, buffers[10]);
+  assert(result == 0);
+  result = ert_buffer_pool_release(buffer_pool, buffers[50]);
+  assert(result == 0);
+  assert(ert_buffer_pool_get_used_count(buffer_pool) == BUFFER_POOL_TEST_COUNT - 2);
+
+  result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+  assert(result == 0);
+  assert(pointer == buffers[50]);
+  result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+  assert(result == 0);
+  assert(pointer == buffers[10]);
+
+  // Releasing a buffer twice or an invalid pointer fails without corrupting the free list
+  result = ert_buffer_pool_release(buffer_pool, buffers[20]);
+  assert(result == 0);
+  result = ert_buffer_pool_release(buffer_pool, buffers[20]);
+  assert(result == -ENOBUFS);
+  result = ert_buffer_pool_release(buffer_pool, buffers[30] + 1);
+  assert(result == -EINVAL);
+  result = ert_buffer_pool_release(buffer_pool, buffers[0] - BUFFER_POOL_TEST_ELEMENT_SIZE);
+  assert(result == -EINVAL);
+  result = ert_buffer_pool_release(buffer_pool, NULL);
+  assert(result == -EINVAL);
+  assert(ert_buffer_pool_get_used_count(buffer_pool) == BUFFER_POOL_TEST_COUNT - 1);
+
+  result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+  assert(result == 0);
+  assert(pointer == buffers[20]);
+  result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+  assert(result == -ENOBUFS);
+
+  for (size_t i = 0; i < BUFFER_POOL_TEST_COUNT; i++) {
+    for (size_t j = 0; j < BUFFER_POOL_TEST_ELEMENT_SIZE; j++) {
+      assert(buffers[i][j] == (uint8_t) i);
+    }
+  }
+
+  result = ert_buffer_pool_clear(buffer_pool);
+  assert(result == 0);
+  assert(ert_buffer_pool_get_used_count(buffer_pool) == 0);
+
+  for (size_t i = 0; i < BUFFER_POOL_TEST_COUNT; i++) {
+    result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+    assert(result == 0);
+    assert(pointer == buffers[i]);
+  }
+
+  ert_buffer_pool_destroy(buffer_pool);
+}
+
+static void *ert_buffer_pool_test_stress_thread(void *context)
+{
+  ert_buffer_pool_test_thread_context *thread_context = (ert_buffer_pool_test_thread_context *) context;
+  ert_buffer_pool *buffer_pool = thread_context->buffer_pool;
+  uint8_t *held[BUFFER_POOL_TEST_STRESS_MAX_HELD];
+  uint32_t held_count = 0;
+  uint32_t random_state = (uint32_t) thread_context->thread_id + 1;
+
+  for (uint32_t i = 0; i < BUFFER_POOL_TEST_STRESS_ITERATIONS; i++) {
+    random_state = random_state * 1103515245 + 12345;
+    bool acquire = (held_count == 0)
+        || (held_count < BUFFER_POOL_TEST_STRESS_MAX_HELD && ((random_state >> 16) & 1));
+
+    if (acquire) {
+      void *pointer;
+      int result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+      if (result == -ENOBUFS) {
+        thread_context->failed_acquire_count++;
+        sched_yield();
+        continue;
+      }
+      assert(result == 0);
+
+      uint8_t *buffer = pointer;
+      size_t index = (size_t) (buffer - buffer_pool->buffer) / BUFFER_POOL_TEST_ELEMENT_SIZE;
+
+      // No other thread may hold the same buffer
+      int previous_owner = atomic_exchange(&thread_context->owners[index], thread_context->thread_id);
+      assert(previous_owner == 0);
+
+      memset(buffer, thread_context->thread_id, BUFFER_POOL_TEST_ELEMENT_SIZE);
+      held[held_count++] = buffer;
+      thread_context->acquire_count++;
+    } else {
+      uint32_t held_index = (random_state >> 8) % held_count;
+      uint8_t *buffer = held[held_index];
+      size_t index = (size_t) (buffer - buffer_pool->buffer) / BUFFER_POOL_TEST_ELEMENT_SIZE;
+
+      for (size_t j = 0; j < BUFFER_POOL_TEST_ELEMENT_SIZE; j++) {
+        assert(buffer[j] == (uint8_t) thread_context->thread_id);
+      }
+
+      int previous_owner = atomic_exchange(&thread_context->owners[index], 0);
+      assert(previous_owner == thread_context->thread_id);
+
+      int result = ert_buffer_pool_release(buffer_pool, buffer);
+      assert(result == 0);
+
+      held[held_index] = held[--held_count];
+    }
+  }
+
+  while (held_count > 0) {
+    uint8_t *buffer = held[--held_count];
+    size_t index = (size_t) (buffer - buffer_pool->buffer) / BUFFER_POOL_TEST_ELEMENT_SIZE;
+    atomic_store(&thread_context->owners[index], 0);
+    int result = ert_buffer_pool_release(buffer_pool, buffer);
+    assert(result == 0);
+  }
+
+  return NULL;
+}
+
+void ert_buffer_pool_test_run_test_stress()
+{
+  ert_buffer_pool_test_thread_context thread_contexts[BUFFER_POOL_TEST_STRESS_THREAD_COUNT];
+  pthread_t threads[BUFFER_POOL_TEST_STRESS_THREAD_COUNT];
+  atomic_int owners[BUFFER_POOL_TEST_STRESS_COUNT];
+  ert_buffer_pool *buffer_pool;
+  int result;
+
+  // The threads may hold more buffers in total than there are in the pool to exercise the exhausted pool path
+  result = ert_buffer_pool_create(BUFFER_POOL_TEST_ELEMENT_SIZE, BUFFER_POOL_TEST_STRESS_COUNT, &buffer_pool);
+  assert(result == 0);
+
+  for (size_t i = 0; i < BUFFER_POOL_TEST_STRESS_COUNT; i++) {
+    atomic_init(&owners[i], 0);
+  }
+
+  for (int i = 0; i < BUFFER_POOL_TEST_STRESS_THREAD_COUNT; i++) {
+    thread_contexts[i] = (ert_buffer_pool_test_thread_context) {
+        .buffer_pool = buffer_pool,
+        .owners = owners,
+        .thread_id = i + 1,
+    };
+    result = pthread_create(&threads[i], NULL, ert_buffer_pool_test_stress_thread, &thread_contexts[i]);
+    assert(result == 0);
+  }
+
+  uint32_t acquire_count = 0;
+  for (int i = 0; i < BUFFER_POOL_TEST_STRESS_THREAD_COUNT; i++) {
+    pthread_join(threads[i], NULL);
+    acquire_count += thread_contexts[i].acquire_count;
+  }
+
+  ert_log_info("Stress test acquired %u buffers", acquire_count);
+  assert(acquire_count > 0);
+  assert(ert_buffer_pool_get_used_count(buffer_pool) == 0);
+
+  // Every buffer is back in the free list exactly once
+  uint8_t *buffers[BUFFER_POOL_TEST_STRESS_COUNT];
+  for (size_t i = 0; i < BUFFER_POOL_TEST_STRESS_COUNT; i++) {
+    void *pointer;
+    result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+    assert(result == 0);
+    buffers[i] = pointer;
+    for (size_t j = 0; j < i; j++) {
+      assert(buffers[j] != buffers[i]);
+    }
+  }
+  void *pointer;
+  result = ert_buffer_pool_acquire(buffer_pool, &pointer);
+  assert(result == -ENOBUFS);
+
+  ert_buffer_pool_destroy(buffer_pool);
+}
+
+int main(void)
+{
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_buffer_pool_test_run_test_acquire_release();
+
+  ert_buffer_pool_test_run_test_stress();
+
+  ert_log_info("Tests finished successfully");
+
+  ert_test_uninit();
+
+  return EXIT_SUCCESS;
+}
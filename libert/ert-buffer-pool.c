@@ -15,6 +15,15 @@
 #include "ert-buffer-pool.h"
 #include "ert-log.h"
 
+static void ert_buffer_pool_reset_free_indices(ert_buffer_pool *buffer_pool)
+{
+  // The lowest index is at the top of the stack, so buffers are initially handed out in address order
+  for (size_t index = 0; index < buffer_pool->count; index++) {
+    buffer_pool->free_indices[index] = buffer_pool->count - 1 - index;
+  }
+  buffer_pool->free_count = buffer_pool->count;
+}
+
 int ert_buffer_pool_create(size_t element_size, size_t count, ert_buffer_pool **buffer_pool_rcv)
 {
   ert_buffer_pool *buffer_pool = calloc(1, sizeof(ert_buffer_pool));
@@ -38,8 +47,18 @@ int ert_buffer_pool_create(size_t element_size, size_t count, ert_buffer_pool **
     return -ENOMEM;
   }
 
+  buffer_pool->free_indices = calloc(count, sizeof(size_t));
+  if (buffer_pool->free_indices == NULL) {
+    free(buffer_pool->used);
+    free(buffer_pool->buffer);
+    free(buffer_pool);
+    ert_log_fatal("Error allocating memory for buffer pool free list: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
   int result = pthread_mutex_init(&buffer_pool->mutex, NULL);
   if (result != 0) {
+    free(buffer_pool->free_indices);
     free(buffer_pool->used);
     free(buffer_pool->buffer);
     free(buffer_pool);
@@ -49,6 +68,7 @@ int ert_buffer_pool_create(size_t element_size, size_t count, ert_buffer_pool **
 
   buffer_pool->count = count;
   buffer_pool->element_size = element_size;
+  ert_buffer_pool_reset_free_indices(buffer_pool);
 
   *buffer_pool_rcv = buffer_pool;
 
@@ -59,9 +79,8 @@ int ert_buffer_pool_clear(ert_buffer_pool *buffer_pool)
 {
   pthread_mutex_lock(&buffer_pool->mutex);
 
-  for (size_t index = 0; index < buffer_pool->count; index++) {
-    buffer_pool->used[index] = false;
-  }
+  memset(buffer_pool->used, 0, buffer_pool->count * sizeof(bool));
+  ert_buffer_pool_reset_free_indices(buffer_pool);
 
   pthread_mutex_unlock(&buffer_pool->mutex);
 
@@ -70,23 +89,15 @@ int ert_buffer_pool_clear(ert_buffer_pool *buffer_pool)
 
 int ert_buffer_pool_acquire(ert_buffer_pool *buffer_pool, void **pointer_rcv)
 {
-  size_t index;
-  bool found = false;
-
   pthread_mutex_lock(&buffer_pool->mutex);
 
-  for (index = 0; index < buffer_pool->count; index++) {
-    if (buffer_pool->used[index] == false) {
-      found = true;
-      break;
-    }
-  }
-
-  if (!found) {
+  if (buffer_pool->free_count == 0) {
     pthread_mutex_unlock(&buffer_pool->mutex);
     return -ENOBUFS;
   }
 
+  buffer_pool->free_count--;
+  size_t index = buffer_pool->free_indices[buffer_pool->free_count];
   buffer_pool->used[index] = true;
 
   pthread_mutex_unlock(&buffer_pool->mutex);
@@ -98,16 +109,8 @@ int ert_buffer_pool_acquire(ert_buffer_pool *buffer_pool, void **pointer_rcv)
 
 size_t ert_buffer_pool_get_used_count(ert_buffer_pool *buffer_pool)
 {
-  size_t count = 0;
-
   pthread_mutex_lock(&buffer_pool->mutex);
-
-  for (size_t index = 0; index < buffer_pool->count; index++) {
-    if (buffer_pool->used[index]) {
-      count++;
-    }
-  }
-
+  size_t count = buffer_pool->count - buffer_pool->free_count;
   pthread_mutex_unlock(&buffer_pool->mutex);
 
   return count;
@@ -146,6 +149,8 @@ int ert_buffer_pool_release(ert_buffer_pool *buffer_pool, void *pointer)
   }
 
   buffer_pool->used[index] = false;
+  buffer_pool->free_indices[buffer_pool->free_count] = index;
+  buffer_pool->free_count++;
 
   pthread_mutex_unlock(&buffer_pool->mutex);
 
@@ -155,6 +160,7 @@ int ert_buffer_pool_release(ert_buffer_pool *buffer_pool, void *pointer)
 int ert_buffer_pool_destroy(ert_buffer_pool *buffer_pool)
 {
   pthread_mutex_destroy(&buffer_pool->mutex);
+  free(buffer_pool->free_indices);
   free(buffer_pool->used);
   free(buffer_pool->buffer);
   free(buffer_pool);
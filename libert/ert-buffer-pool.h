@@ -14,11 +14,18 @@
 #include "ert-common.h"
 #include <pthread.h>
 
+/**
+ * Fixed-size pool of equally sized buffers. Free buffers are kept in a stack of element indices, so acquiring,
+ * releasing and counting used buffers are constant-time operations. The most recently released buffer is handed
+ * out first to keep it warm in the cache.
+ */
 typedef struct _ert_buffer_pool {
   pthread_mutex_t mutex;
   size_t count;
   size_t element_size;
   bool *used;
+  size_t *free_indices;
+  size_t free_count;
   uint8_t *buffer;
 } ert_buffer_pool;
 
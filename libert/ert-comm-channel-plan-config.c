@@ -0,0 +1,42 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ert-comm-channel-plan-config.h"
+
+ert_mapper_entry *ert_comm_channel_plan_create_mappings(ert_comm_channel_plan_config *config)
+{
+  ert_mapper_entry comm_channel_plan_children[] = {
+      {
+          .name = "channel_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->channel_count,
+      },
+      {
+          .name = "first_channel_frequency",
+          .type = ERT_MAPPER_ENTRY_TYPE_DOUBLE,
+          .value = &config->first_channel_frequency,
+      },
+      {
+          .name = "channel_spacing",
+          .type = ERT_MAPPER_ENTRY_TYPE_DOUBLE,
+          .value = &config->channel_spacing,
+      },
+      {
+          .name = "channel_index",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->channel_index,
+      },
+      {
+          .type = ERT_MAPPER_ENTRY_TYPE_NONE,
+      },
+  };
+
+  return ert_mapper_allocate(comm_channel_plan_children);
+}
@@ -0,0 +1,299 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "ert-comm-channel-plan.h"
+#include "ert-comm-device-dummy.h"
+#include "ert-comm-transceiver.h"
+#include "ert-log.h"
+#include "ert-time.h"
+#include "ert-test.h"
+
+#define CHANNEL_PLAN_TEST_NODE_COUNT 6
+#define CHANNEL_PLAN_TEST_PACKET_COUNT 8
+#define CHANNEL_PLAN_TEST_TRANSMIT_TIME_MILLIS 30
+#define CHANNEL_PLAN_TEST_NODE_START_INTERVAL_MILLIS 5
+#define CHANNEL_PLAN_TEST_MAX_PACKET_LENGTH 64
+
+typedef struct _channel_plan_test_gateway_radio {
+  uint32_t channel_index;
+
+  pthread_mutex_t mutex;
+  uint32_t received_packet_count;
+  uint32_t wrong_channel_packet_count;
+
+  ert_comm_device *device;
+  ert_comm_transceiver *comm_transceiver;
+} channel_plan_test_gateway_radio;
+
+typedef struct _channel_plan_test_node {
+  uint32_t node_index;
+  int result;
+
+  ert_comm_device *device;
+  ert_comm_transceiver *comm_transceiver;
+} channel_plan_test_node;
+
+typedef struct _channel_plan_test_result {
+  uint32_t received_packet_count;
+  uint32_t wrong_channel_packet_count;
+  uint64_t collided_packet_count;
+  int32_t elapsed_millis;
+} channel_plan_test_result;
+
+static uint32_t channel_plan_test_channel_count;
+
+static void channel_plan_test_receive_callback(uint32_t length, uint8_t *data, void *callback_context)
+{
+  channel_plan_test_gateway_radio *radio = (channel_plan_test_gateway_radio *) callback_context;
+  uint32_t node_index, packet_index;
+
+  int result = sscanf((char *) data, "Node %u: Packet %u", &node_index, &packet_index);
+
+  pthread_mutex_lock(&radio->mutex);
+  radio->received_packet_count++;
+  if (result != 2 || node_index % channel_plan_test_channel_count != radio->channel_index) {
+    radio->wrong_channel_packet_count++;
+  }
+  pthread_mutex_unlock(&radio->mutex);
+}
+
+static void channel_plan_test_open_device(ert_comm_driver_dummy_channel *channel,
+    ert_comm_channel_plan_config *channel_plan_config, uint32_t channel_index, ert_comm_device **device_rcv)
+{
+  ert_comm_driver_dummy_config comm_driver_dummy_config = {0};
+  comm_driver_dummy_config.transmit_time_millis = CHANNEL_PLAN_TEST_TRANSMIT_TIME_MILLIS;
+  comm_driver_dummy_config.max_packet_length = CHANNEL_PLAN_TEST_MAX_PACKET_LENGTH;
+
+  int result = ert_driver_comm_device_dummy_open(&comm_driver_dummy_config, device_rcv);
+  assert(result == 0);
+  result = ert_driver_comm_device_dummy_channel_add(channel, *device_rcv);
+  assert(result == 0);
+
+  double frequency;
+  result = ert_comm_channel_plan_get_frequency(channel_plan_config, channel_index, &frequency);
+  assert(result == 0);
+
+  ert_comm_device *device = *device_rcv;
+  result = device->driver->set_frequency(device, ERT_COMM_DEVICE_CONFIG_TYPE_TRANSMIT, frequency);
+  assert(result == 0);
+  result = device->driver->set_frequency(device, ERT_COMM_DEVICE_CONFIG_TYPE_RECEIVE, frequency);
+  assert(result == 0);
+}
+
+static void channel_plan_test_start_transceiver(ert_comm_device *device,
+    ert_comm_transceiver_receive_callback receive_callback, void *receive_callback_context,
+    ert_comm_transceiver **comm_transceiver_rcv)
+{
+  ert_comm_transceiver_config comm_transceiver_config = {0};
+  comm_transceiver_config.transmit_buffer_length_packets = 16;
+  comm_transceiver_config.receive_buffer_length_packets = 64;
+  comm_transceiver_config.transmit_timeout_milliseconds = 10000;
+  comm_transceiver_config.poll_interval_milliseconds = 1000;
+  comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_NORMAL_PRIORITY_WEIGHT_DEFAULT;
+  comm_transceiver_config.transmit_batch_packet_count = 1;
+  comm_transceiver_config.listen_before_talk = true;
+  comm_transceiver_config.listen_before_talk_max_attempts = 64;
+  comm_transceiver_config.listen_before_talk_backoff_min_milliseconds = 5;
+  comm_transceiver_config.listen_before_talk_backoff_max_milliseconds = 100;
+  comm_transceiver_config.receive_callback = receive_callback;
+  comm_transceiver_config.receive_callback_context = receive_callback_context;
+
+  int result = ert_comm_transceiver_start(device, &comm_transceiver_config, comm_transceiver_rcv);
+  assert(result == 0);
+}
+
+static void *channel_plan_test_node_transmit_thread(void *arg)
+{
+  channel_plan_test_node *node = (channel_plan_test_node *) arg;
+
+  usleep(node->node_index * CHANNEL_PLAN_TEST_NODE_START_INTERVAL_MILLIS * 1000);
+
+  for (uint32_t i = 0; i < CHANNEL_PLAN_TEST_PACKET_COUNT; i++) {
+    char packet_data[32];
+    snprintf(packet_data, sizeof(packet_data), "Node %d: Packet %d", node->node_index, i);
+
+    uint32_t bytes_transmitted;
+    int result = ert_comm_transceiver_transmit(node->comm_transceiver, i, (uint32_t) strlen(packet_data) + 1,
+        (uint8_t *) packet_data, ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_BLOCK, &bytes_transmitted);
+    if (result < 0) {
+      node->result = result;
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Spreads the nodes across the channels of the plan and lets them all transmit at the same time to a gateway
+ * that services one radio per channel.
+ */
+static void channel_plan_test_run(uint32_t channel_count, channel_plan_test_result *test_result)
+{
+  ert_comm_driver_dummy_channel *channel;
+  channel_plan_test_gateway_radio radios[ERT_COMM_CHANNEL_PLAN_MAX_CHANNEL_COUNT] = {0};
+  channel_plan_test_node nodes[CHANNEL_PLAN_TEST_NODE_COUNT] = {0};
+  pthread_t threads[CHANNEL_PLAN_TEST_NODE_COUNT];
+
+  ert_comm_channel_plan_config channel_plan_config = {
+      .channel_count = channel_count,
+      .first_channel_frequency = 433050000,
+      .channel_spacing = 200000,
+  };
+
+  channel_plan_test_channel_count = channel_count;
+
+  int result = ert_driver_comm_device_dummy_channel_create(&channel);
+  assert(result == 0);
+
+  for (uint32_t i = 0; i < channel_count; i++) {
+    radios[i].channel_index = i;
+    pthread_mutex_init(&radios[i].mutex, NULL);
+
+    channel_plan_test_open_device(channel, &channel_plan_config, i, &radios[i].device);
+    channel_plan_test_start_transceiver(radios[i].device, channel_plan_test_receive_callback, &radios[i],
+        &radios[i].comm_transceiver);
+    ert_comm_transceiver_set_receive_active(radios[i].comm_transceiver, true);
+  }
+
+  for (uint32_t i = 0; i < CHANNEL_PLAN_TEST_NODE_COUNT; i++) {
+    nodes[i].node_index = i;
+
+    channel_plan_config.channel_index = i % channel_count;
+    channel_plan_test_open_device(channel, &channel_plan_config, channel_plan_config.channel_index, &nodes[i].device);
+    channel_plan_test_start_transceiver(nodes[i].device, NULL, NULL, &nodes[i].comm_transceiver);
+  }
+
+  struct timespec start_time;
+  ert_get_current_timestamp(&start_time);
+
+  for (uint32_t i = 0; i < CHANNEL_PLAN_TEST_NODE_COUNT; i++) {
+    result = pthread_create(&threads[i], NULL, channel_plan_test_node_transmit_thread, &nodes[i]);
+    assert(result == 0);
+  }
+
+  for (uint32_t i = 0; i < CHANNEL_PLAN_TEST_NODE_COUNT; i++) {
+    pthread_join(threads[i], NULL);
+    assert(nodes[i].result == 0);
+  }
+
+  int32_t elapsed_millis = ert_timespec_diff_milliseconds_from_current(&start_time);
+
+  // Let the gateway transceivers dispatch the last received packets
+  usleep(100 * 1000);
+
+  for (uint32_t i = 0; i < CHANNEL_PLAN_TEST_NODE_COUNT; i++) {
+    ert_comm_transceiver_stop(nodes[i].comm_transceiver);
+  }
+
+  memset(test_result, 0, sizeof(channel_plan_test_result));
+  test_result->elapsed_millis = elapsed_millis;
+
+  for (uint32_t i = 0; i < channel_count; i++) {
+    ert_comm_transceiver_stop(radios[i].comm_transceiver);
+
+    test_result->received_packet_count += radios[i].received_packet_count;
+    test_result->wrong_channel_packet_count += radios[i].wrong_channel_packet_count;
+
+    pthread_mutex_destroy(&radios[i].mutex);
+  }
+
+  for (uint32_t i = 0; i < CHANNEL_PLAN_TEST_NODE_COUNT; i++) {
+    ert_driver_comm_device_dummy_close(nodes[i].device);
+  }
+  for (uint32_t i = 0; i < channel_count; i++) {
+    ert_driver_comm_device_dummy_close(radios[i].device);
+  }
+
+  ert_comm_driver_dummy_channel_status channel_status;
+  ert_driver_comm_device_dummy_channel_get_status(channel, &channel_status);
+  ert_driver_comm_device_dummy_channel_destroy(channel);
+
+  test_result->collided_packet_count = channel_status.collided_packet_count;
+
+  ert_log_info("Channels %d: received=%d wrong_channel=%d collided=%d elapsed=%d ms",
+      channel_count, test_result->received_packet_count, test_result->wrong_channel_packet_count,
+      (uint32_t) test_result->collided_packet_count, test_result->elapsed_millis);
+}
+
+void channel_plan_test_run_test_frequency(void)
+{
+  ert_comm_channel_plan_config channel_plan_config = {0};
+  double frequency;
+
+  assert(!ert_comm_channel_plan_is_enabled(&channel_plan_config));
+  assert(ert_comm_channel_plan_get_frequency(&channel_plan_config, 0, &frequency) == -EINVAL);
+
+  channel_plan_config.channel_count = 4;
+  channel_plan_config.first_channel_frequency = 868100000;
+  channel_plan_config.channel_spacing = 200000;
+
+  assert(ert_comm_channel_plan_is_enabled(&channel_plan_config));
+  assert(ert_comm_channel_plan_get_frequency(&channel_plan_config, 0, &frequency) == 0);
+  assert(frequency == 868100000);
+  assert(ert_comm_channel_plan_get_frequency(&channel_plan_config, 3, &frequency) == 0);
+  assert(frequency == 868700000);
+  assert(ert_comm_channel_plan_get_frequency(&channel_plan_config, 4, &frequency) == -EINVAL);
+}
+
+void channel_plan_test_run_test_capacity(void)
+{
+  channel_plan_test_result single_channel_result;
+  channel_plan_test_result multi_channel_result;
+  uint32_t expected_packet_count = CHANNEL_PLAN_TEST_NODE_COUNT * CHANNEL_PLAN_TEST_PACKET_COUNT;
+
+  channel_plan_test_run(1, &single_channel_result);
+  channel_plan_test_run(3, &multi_channel_result);
+
+  // Listen-before-talk keeps the staggered nodes from colliding, so that nearly all packets are delivered
+  assert(single_channel_result.received_packet_count >= expected_packet_count * 9 / 10);
+  assert(multi_channel_result.received_packet_count >= expected_packet_count * 9 / 10);
+
+  // Each gateway radio receives only the nodes on its own channel
+  assert(single_channel_result.wrong_channel_packet_count == 0);
+  assert(multi_channel_result.wrong_channel_packet_count == 0);
+
+  // The channels carry traffic in parallel, so three channels deliver the same packets in well under half the time
+  double single_channel_throughput =
+      (double) single_channel_result.received_packet_count / single_channel_result.elapsed_millis;
+  double multi_channel_throughput =
+      (double) multi_channel_result.received_packet_count / multi_channel_result.elapsed_millis;
+
+  ert_log_info("Aggregate throughput: 1 channel %.1f packets/s, 3 channels %.1f packets/s",
+      single_channel_throughput * 1000.0, multi_channel_throughput * 1000.0);
+
+  assert(multi_channel_throughput > 2.0 * single_channel_throughput);
+}
+
+int main(void)
+{
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  channel_plan_test_run_test_frequency();
+  channel_plan_test_run_test_capacity();
+
+  ert_log_info("Tests finished successfully");
+
+  ert_test_uninit();
+
+  return EXIT_SUCCESS;
+}
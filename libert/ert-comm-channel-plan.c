@@ -0,0 +1,32 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <errno.h>
+
+#include "ert-comm-channel-plan.h"
+#include "ert-log.h"
+
+bool ert_comm_channel_plan_is_enabled(ert_comm_channel_plan_config *config)
+{
+  return config->channel_count > 0;
+}
+
+int ert_comm_channel_plan_get_frequency(ert_comm_channel_plan_config *config, uint32_t channel_index,
+    double *frequency_rcv)
+{
+  if (channel_index >= config->channel_count || channel_index >= ERT_COMM_CHANNEL_PLAN_MAX_CHANNEL_COUNT) {
+    ert_log_error("Invalid channel index %d for channel plan with %d channels", channel_index, config->channel_count);
+    return -EINVAL;
+  }
+
+  *frequency_rcv = config->first_channel_frequency + (double) channel_index * config->channel_spacing;
+
+  return 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ERT_COMM_CHANNEL_PLAN_H
+#define __ERT_COMM_CHANNEL_PLAN_H
+
+#include "ert-common.h"
+
+#define ERT_COMM_CHANNEL_PLAN_MAX_CHANNEL_COUNT 16
+
+/**
+ * Channel plan shared by nodes and gateways. Channels are evenly spaced starting from the first channel frequency.
+ * A node with a single radio transmits its streams on the channel given by channel_index, so that nodes can be
+ * spread across the channels. A gateway services one radio per channel, each listening on its own channel,
+ * which makes the aggregate link capacity scale with the channel count.
+ */
+typedef struct _ert_comm_channel_plan_config {
+  // Number of channels, 0 disables the plan and the frequencies configured for the radio are used instead
+  uint32_t channel_count;
+  double first_channel_frequency;
+  double channel_spacing;
+
+  // Channel of a device with a single radio
+  uint32_t channel_index;
+} ert_comm_channel_plan_config;
+
+bool ert_comm_channel_plan_is_enabled(ert_comm_channel_plan_config *config);
+int ert_comm_channel_plan_get_frequency(ert_comm_channel_plan_config *config, uint32_t channel_index,
+    double *frequency_rcv);
+
+#endif
@@ -47,24 +47,77 @@ int ert_comm_driver_dummy_set_frequency(ert_comm_device *device, ert_comm_device
 {
   ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
 
+  switch (type) {
+    case ERT_COMM_DEVICE_CONFIG_TYPE_TRANSMIT:
+      driver->transmit_frequency = frequency;
+      break;
+    case ERT_COMM_DEVICE_CONFIG_TYPE_RECEIVE:
+      driver->receive_frequency = frequency;
+      break;
+    default:
+      return -EINVAL;
+  }
+
   return 0;
 }
 
+static void ert_driver_comm_device_dummy_channel_transmit_done(ert_comm_device *device)
+{
+  ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
+  ert_comm_driver_dummy_channel *channel = driver->channel;
+  ert_comm_device *receivers[ERT_COMM_DRIVER_DUMMY_CHANNEL_MAX_DEVICE_COUNT];
+  uint32_t receiver_count = 0;
+
+  pthread_mutex_lock(&channel->mutex);
+
+  driver->transmit_active = false;
+
+  if (driver->transmit_collided) {
+    channel->status.collided_packet_count++;
+  } else if (!driver->lose_packets) {
+    for (uint32_t i = 0; i < channel->device_count; i++) {
+      ert_comm_device *other_device = channel->devices[i];
+      ert_driver_comm_device_dummy *other_driver = (ert_driver_comm_device_dummy *) other_device->priv;
+      if (other_device == device || other_driver->transmit_active
+          || other_driver->receive_frequency != driver->transmit_frequency) {
+        continue;
+      }
+      receivers[receiver_count++] = other_device;
+    }
+    channel->status.delivered_packet_count += receiver_count;
+  }
+
+  driver->transmit_collided = false;
+
+  pthread_mutex_unlock(&channel->mutex);
+
+  // The receive callbacks lock the device mutexes of the receivers, which must not be done with the channel locked
+  for (uint32_t i = 0; i < receiver_count; i++) {
+    ert_driver_comm_device_dummy *other_driver = (ert_driver_comm_device_dummy *) receivers[i]->priv;
+    other_driver->inject(receivers[i], driver->transmit_data_length, driver->transmit_data);
+  }
+}
+
 static void ert_driver_comm_device_dummy_transmit_callback(union sigval sv)
 {
   ert_comm_device *device = (ert_comm_device *) sv.sival_ptr;
   ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
 
-  ert_driver_comm_device_dummy *other_driver = (ert_driver_comm_device_dummy *) driver->config.other_device->priv;
-
   device->status.device_state = ERT_COMM_DEVICE_STATE_STANDBY;
 
-  if (!driver->lose_packets) {
-    other_driver->inject(driver->config.other_device, driver->transmit_data_length, driver->transmit_data);
+  if (driver->channel != NULL) {
+    ert_driver_comm_device_dummy_channel_transmit_done(device);
+  } else {
+    ert_driver_comm_device_dummy *other_driver = (ert_driver_comm_device_dummy *) driver->config.other_device->priv;
+
+    if (!driver->lose_packets) {
+      other_driver->inject(driver->config.other_device, driver->transmit_data_length, driver->transmit_data);
+    }
+
+    driver->transmit_active = false;
   }
 
   driver->transmit_data_length = 0;
-  driver->transmit_active = false;
 
   if (!driver->no_transmit_callback && driver->config.transmit_callback != NULL) {
     driver->config.transmit_callback(driver->config.callback_context);
@@ -113,7 +166,24 @@ int ert_comm_driver_dummy_transmit(ert_comm_device *device, uint32_t length, uin
 
   device->status.device_state = ERT_COMM_DEVICE_STATE_TRANSMIT;
 
-  driver->transmit_active = true;
+  if (driver->channel != NULL) {
+    ert_comm_driver_dummy_channel *channel = driver->channel;
+
+    pthread_mutex_lock(&channel->mutex);
+    for (uint32_t i = 0; i < channel->device_count; i++) {
+      ert_driver_comm_device_dummy *other_driver = (ert_driver_comm_device_dummy *) channel->devices[i]->priv;
+      if (other_driver != driver && other_driver->transmit_active
+          && other_driver->transmit_frequency == driver->transmit_frequency) {
+        other_driver->transmit_collided = true;
+        driver->transmit_collided = true;
+      }
+    }
+    driver->transmit_active = true;
+    channel->status.transmitted_packet_count++;
+    pthread_mutex_unlock(&channel->mutex);
+  } else {
+    driver->transmit_active = true;
+  }
 
   result = timer_settime(driver->transmit_callback_timer, 0, &ts, NULL);
   if (result < 0) {
@@ -186,6 +256,39 @@ int ert_comm_driver_dummy_start_detection(ert_comm_device *device)
   return 0;
 }
 
+/**
+ * Reports activity if any other device connected to this one is transmitting on the receive frequency.
+ */
+int ert_comm_driver_dummy_detect_channel_activity(ert_comm_device *device, uint32_t milliseconds,
+    bool *activity_detected)
+{
+  ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
+  bool active = false;
+
+  if (driver->channel != NULL) {
+    ert_comm_driver_dummy_channel *channel = driver->channel;
+
+    pthread_mutex_lock(&channel->mutex);
+    for (uint32_t i = 0; i < channel->device_count; i++) {
+      ert_driver_comm_device_dummy *other_driver = (ert_driver_comm_device_dummy *) channel->devices[i]->priv;
+      if (other_driver != driver && other_driver->transmit_active
+          && other_driver->transmit_frequency == driver->receive_frequency) {
+        active = true;
+        break;
+      }
+    }
+    pthread_mutex_unlock(&channel->mutex);
+  } else if (driver->config.other_device != NULL) {
+    ert_driver_comm_device_dummy *other_driver = (ert_driver_comm_device_dummy *) driver->config.other_device->priv;
+    active = other_driver->transmit_active;
+  }
+
+  device->status.device_state = ERT_COMM_DEVICE_STATE_STANDBY;
+  *activity_detected = active;
+
+  return 0;
+}
+
 int ert_comm_driver_dummy_receive(ert_comm_device *device, uint32_t buffer_length, uint8_t *buffer, uint32_t *bytes_received)
 {
   ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
@@ -269,7 +372,12 @@ int ert_comm_driver_dummy_inject(ert_comm_device *device, uint32_t length, uint8
   memcpy(driver->receive_data, data, length);
   driver->receive_data_length = length;
 
-  driver->config.receive_callback(driver->config.callback_context);
+  device->status.last_received_packet_rssi = driver->received_packet_rssi;
+  device->status.last_received_packet_snr = driver->received_packet_snr;
+
+  if (driver->config.receive_callback != NULL) {
+    driver->config.receive_callback(driver->config.callback_context);
+  }
 
   return 0;
 }
@@ -285,6 +393,12 @@ int ert_driver_comm_device_dummy_connect(ert_comm_device *device, ert_comm_devic
   return 0;
 }
 
+void ert_driver_comm_device_dummy_set_transmit_time_millis(ert_comm_device *device, uint32_t transmit_time_millis)
+{
+  ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
+  driver->config.transmit_time_millis = transmit_time_millis;
+}
+
 void ert_driver_comm_device_dummy_set_fail_transmit(ert_comm_device *device, bool fail_transmit)
 {
   ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
@@ -309,6 +423,72 @@ void ert_driver_comm_device_dummy_set_no_transmit_callback(ert_comm_device *devi
   driver->no_transmit_callback = no_transmit_callback;
 }
 
+void ert_driver_comm_device_dummy_set_link_quality(ert_comm_device *device, float rssi, float snr)
+{
+  ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
+  driver->received_packet_rssi = rssi;
+  driver->received_packet_snr = snr;
+}
+
+int ert_driver_comm_device_dummy_channel_create(ert_comm_driver_dummy_channel **channel_rcv)
+{
+  ert_comm_driver_dummy_channel *channel = calloc(1, sizeof(ert_comm_driver_dummy_channel));
+  if (channel == NULL) {
+    ert_log_fatal("Error allocating memory for dummy channel struct: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  int result = pthread_mutex_init(&channel->mutex, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing dummy channel mutex");
+    free(channel);
+    return -EIO;
+  }
+
+  *channel_rcv = channel;
+
+  return 0;
+}
+
+/**
+ * Connects the device to the channel. Devices must be added before they start transmitting
+ * and must be closed before the channel is destroyed.
+ */
+int ert_driver_comm_device_dummy_channel_add(ert_comm_driver_dummy_channel *channel, ert_comm_device *device)
+{
+  ert_driver_comm_device_dummy *driver = (ert_driver_comm_device_dummy *) device->priv;
+
+  pthread_mutex_lock(&channel->mutex);
+
+  if (channel->device_count >= ERT_COMM_DRIVER_DUMMY_CHANNEL_MAX_DEVICE_COUNT) {
+    pthread_mutex_unlock(&channel->mutex);
+    ert_log_error("Dummy channel is full: maximum of %d devices", ERT_COMM_DRIVER_DUMMY_CHANNEL_MAX_DEVICE_COUNT);
+    return -ENOSPC;
+  }
+
+  channel->devices[channel->device_count] = device;
+  channel->device_count++;
+  driver->channel = channel;
+
+  pthread_mutex_unlock(&channel->mutex);
+
+  return 0;
+}
+
+void ert_driver_comm_device_dummy_channel_get_status(ert_comm_driver_dummy_channel *channel,
+    ert_comm_driver_dummy_channel_status *status)
+{
+  pthread_mutex_lock(&channel->mutex);
+  memcpy(status, &channel->status, sizeof(ert_comm_driver_dummy_channel_status));
+  pthread_mutex_unlock(&channel->mutex);
+}
+
+void ert_driver_comm_device_dummy_channel_destroy(ert_comm_driver_dummy_channel *channel)
+{
+  pthread_mutex_destroy(&channel->mutex);
+  free(channel);
+}
+
 int ert_driver_comm_device_dummy_open(ert_comm_driver_dummy_config *config, ert_comm_device **device_rcv)
 {
   int result;
@@ -431,6 +611,7 @@ ert_comm_driver ert_comm_driver_dummy = {
     .wait_for_transmit = ert_comm_driver_dummy_wait_for_transmit,
     .start_detection = ert_comm_driver_dummy_start_detection,
     .wait_for_detection = ert_comm_driver_dummy_wait_for_detection,
+    .detect_channel_activity = ert_comm_driver_dummy_detect_channel_activity,
     .start_receive = ert_comm_driver_dummy_start_receive,
     .wait_for_data = ert_comm_driver_dummy_wait_for_data,
     .receive = ert_comm_driver_dummy_receive,
@@ -15,6 +15,29 @@
 #include "ert-comm.h"
 
 #include <time.h>
+#include <pthread.h>
+
+#define ERT_COMM_DRIVER_DUMMY_CHANNEL_MAX_DEVICE_COUNT 16
+
+typedef struct _ert_comm_driver_dummy_channel_status {
+  uint64_t transmitted_packet_count;
+  uint64_t delivered_packet_count;
+  uint64_t collided_packet_count;
+} ert_comm_driver_dummy_channel_status;
+
+/**
+ * Shared radio channel for connecting more than two dummy devices. A packet transmitted on the channel is delivered
+ * to all other devices that are not transmitting themselves and receive on the transmit frequency. Packets whose
+ * transmissions overlap in time on the same frequency collide and are not delivered to anyone.
+ */
+typedef struct _ert_comm_driver_dummy_channel {
+  pthread_mutex_t mutex;
+
+  ert_comm_device *devices[ERT_COMM_DRIVER_DUMMY_CHANNEL_MAX_DEVICE_COUNT];
+  uint32_t device_count;
+
+  ert_comm_driver_dummy_channel_status status;
+} ert_comm_driver_dummy_channel;
 
 typedef struct _ert_comm_driver_dummy_config {
   uint32_t transmit_time_millis;
@@ -43,17 +66,36 @@ typedef struct _ert_comm_driver_dummy {
   bool lose_packets;
   bool no_transmit_callback;
 
+  // Link quality reported for the packets this device receives
+  float received_packet_rssi;
+  float received_packet_snr;
+
   volatile bool transmit_active;
 
+  ert_comm_driver_dummy_channel *channel;
+  // Set with set_frequency, devices on different frequencies do not hear each other on a channel
+  double transmit_frequency;
+  double receive_frequency;
+  // Set when the transmission overlaps with another one on the channel, protected by the channel mutex
+  bool transmit_collided;
+
   int (*inject)(ert_comm_device *device, uint32_t length, uint8_t *data);
 } ert_driver_comm_device_dummy;
 
 int ert_driver_comm_device_dummy_open(ert_comm_driver_dummy_config *config, ert_comm_device **device_rcv);
 int ert_driver_comm_device_dummy_connect(ert_comm_device *device, ert_comm_device *other_device);
+void ert_driver_comm_device_dummy_set_transmit_time_millis(ert_comm_device *device, uint32_t transmit_time_millis);
 void ert_driver_comm_device_dummy_set_fail_transmit(ert_comm_device *device, bool fail_transmit);
 void ert_driver_comm_device_dummy_set_fail_receive(ert_comm_device *device, bool fail_receive);
 void ert_driver_comm_device_dummy_set_lose_packets(ert_comm_device *device, bool lose_packets);
 void ert_driver_comm_device_dummy_set_no_transmit_callback(ert_comm_device *device, bool no_transmit_callback);
+void ert_driver_comm_device_dummy_set_link_quality(ert_comm_device *device, float rssi, float snr);
 int ert_driver_comm_device_dummy_close(ert_comm_device *device);
 
+int ert_driver_comm_device_dummy_channel_create(ert_comm_driver_dummy_channel **channel_rcv);
+int ert_driver_comm_device_dummy_channel_add(ert_comm_driver_dummy_channel *channel, ert_comm_device *device);
+void ert_driver_comm_device_dummy_channel_get_status(ert_comm_driver_dummy_channel *channel,
+    ert_comm_driver_dummy_channel_status *status);
+void ert_driver_comm_device_dummy_channel_destroy(ert_comm_driver_dummy_channel *channel);
+
 #endif
@@ -0,0 +1,349 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <assert.h>
+
+#include "ert-comm-device-simulator.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define SIMULATOR_TEST_PACKET_COUNT 2000
+
+typedef struct _ert_comm_device_simulator_test_device_context {
+  ert_comm_device *device;
+
+  volatile uint32_t transmitted_packet_count;
+  volatile uint32_t received_packet_count;
+  volatile uint32_t invalid_received_packet_count;
+
+  uint8_t received_data[255];
+  uint32_t received_data_length;
+} ert_comm_device_simulator_test_device_context;
+
+typedef struct _ert_comm_device_simulator_test_context {
+  ert_comm_device_simulator_test_device_context device_context1;
+  ert_comm_device_simulator_test_device_context device_context2;
+} ert_comm_device_simulator_test_context;
+
+static void ert_comm_device_simulator_test_transmit_callback(void *callback_context)
+{
+  ert_comm_device_simulator_test_device_context *device_context =
+      (ert_comm_device_simulator_test_device_context *) callback_context;
+
+  device_context->transmitted_packet_count++;
+}
+
+static void ert_comm_device_simulator_test_receive_callback(void *callback_context)
+{
+  ert_comm_device_simulator_test_device_context *device_context =
+      (ert_comm_device_simulator_test_device_context *) callback_context;
+  ert_comm_device *device = device_context->device;
+
+  uint32_t bytes_received = 0;
+  int result = device->driver->receive(device, sizeof(device_context->received_data),
+      device_context->received_data, &bytes_received);
+  if (result == -EBADMSG) {
+    device_context->invalid_received_packet_count++;
+    return;
+  }
+  assert(result == 0);
+
+  device_context->received_data_length = bytes_received;
+  device_context->received_packet_count++;
+}
+
+void ert_comm_device_simulator_test_initialize(ert_comm_driver_simulator_config *config,
+    ert_comm_device_simulator_test_context *context)
+{
+  memset(context, 0, sizeof(ert_comm_device_simulator_test_context));
+
+  ert_comm_device_simulator_test_device_context *device_contexts[] = {
+      &context->device_context1,
+      &context->device_context2,
+  };
+
+  for (size_t i = 0; i < 2; i++) {
+    ert_comm_device_simulator_test_device_context *device_context = device_contexts[i];
+
+    int result = ert_driver_comm_device_simulator_open(config, &device_context->device);
+    assert(result == 0);
+
+    ert_comm_device *device = device_context->device;
+    device->driver->set_callback_context(device, device_context);
+    device->driver->set_transmit_callback(device, ert_comm_device_simulator_test_transmit_callback);
+    device->driver->set_receive_callback(device, ert_comm_device_simulator_test_receive_callback);
+    device->driver->start_receive(device, true);
+  }
+
+  ert_driver_comm_device_simulator_connect(context->device_context1.device, context->device_context2.device);
+}
+
+void ert_comm_device_simulator_test_uninitialize(ert_comm_device_simulator_test_context *context)
+{
+  ert_driver_comm_device_simulator_close(context->device_context2.device);
+  ert_driver_comm_device_simulator_close(context->device_context1.device);
+}
+
+void ert_comm_device_simulator_test_transmit(ert_comm_device_simulator_test_device_context *device_context,
+    uint32_t length, bool wait)
+{
+  uint8_t data[255];
+  uint32_t bytes_transmitted;
+
+  for (uint32_t i = 0; i < length; i++) {
+    data[i] = (uint8_t) i;
+  }
+
+  uint32_t transmitted_packet_count = device_context->transmitted_packet_count;
+
+  int result = device_context->device->driver->transmit(device_context->device, length, data, &bytes_transmitted);
+  assert(result == 0);
+  assert(bytes_transmitted == length);
+
+  if (!wait) {
+    return;
+  }
+
+  for (int retry_count = 10000; retry_count > 0; retry_count--) {
+    if (device_context->transmitted_packet_count != transmitted_packet_count) {
+      return;
+    }
+    usleep(100);
+  }
+
+  ert_log_error("Transmit callback not called");
+  assert(false);
+}
+
+void ert_comm_device_simulator_test_run_test_airtime()
+{
+  ert_comm_driver_simulator_config config;
+  ert_driver_comm_device_simulator_create_default_config(&config);
+
+  // Reference values from the time on air formula of Semtech AN1200.13
+  double airtime_millis = ert_driver_comm_device_simulator_calculate_airtime_millis(&config.lora, 10);
+  ert_log_info("Airtime for SF7, BW 125 kHz, CR 4/5, 10 bytes: %.3f ms", airtime_millis);
+  assert(fabs(airtime_millis - 41.216) < 0.001);
+
+  config.lora.spreading_factor = 12;
+  airtime_millis = ert_driver_comm_device_simulator_calculate_airtime_millis(&config.lora, 51);
+  ert_log_info("Airtime for SF12, BW 125 kHz, CR 4/5, 51 bytes: %.3f ms", airtime_millis);
+  assert(fabs(airtime_millis - 2465.792) < 0.001);
+}
+
+uint32_t ert_comm_device_simulator_test_transmit_with_burst_loss(uint64_t seed, uint8_t *delivered)
+{
+  ert_comm_device_simulator_test_context context;
+  ert_comm_driver_simulator_config config;
+
+  ert_driver_comm_device_simulator_create_default_config(&config);
+  config.seed = seed;
+  config.time_scale = 0;
+  config.channel.good_to_bad_probability = 0.05;
+  config.channel.bad_to_good_probability = 0.25;
+  config.channel.good_loss_probability = 0.01;
+  config.channel.bad_loss_probability = 0.5;
+
+  ert_comm_device_simulator_test_initialize(&config, &context);
+
+  for (uint32_t i = 0; i < SIMULATOR_TEST_PACKET_COUNT; i++) {
+    uint32_t received_packet_count = context.device_context2.received_packet_count;
+    ert_comm_device_simulator_test_transmit(&context.device_context1, 20, true);
+    delivered[i] = (uint8_t) (context.device_context2.received_packet_count != received_packet_count);
+  }
+
+  ert_comm_driver_simulator_channel_status channel_status;
+  ert_driver_comm_device_simulator_get_channel_status(context.device_context1.device, &channel_status);
+
+  assert(channel_status.transmitted_packet_count == SIMULATOR_TEST_PACKET_COUNT);
+  assert(channel_status.delivered_packet_count == context.device_context2.received_packet_count);
+  assert(channel_status.lost_packet_count + channel_status.delivered_packet_count == SIMULATOR_TEST_PACKET_COUNT);
+  assert(channel_status.half_duplex_lost_packet_count == 0);
+
+  ert_comm_device_simulator_test_uninitialize(&context);
+
+  return (uint32_t) channel_status.lost_packet_count;
+}
+
+void ert_comm_device_simulator_test_run_test_burst_loss()
+{
+  static uint8_t delivered1[SIMULATOR_TEST_PACKET_COUNT];
+  static uint8_t delivered2[SIMULATOR_TEST_PACKET_COUNT];
+  static uint8_t delivered3[SIMULATOR_TEST_PACKET_COUNT];
+
+  uint32_t lost_packet_count1 = ert_comm_device_simulator_test_transmit_with_burst_loss(1234, delivered1);
+  uint32_t lost_packet_count2 = ert_comm_device_simulator_test_transmit_with_burst_loss(1234, delivered2);
+  uint32_t lost_packet_count3 = ert_comm_device_simulator_test_transmit_with_burst_loss(5678, delivered3);
+
+  // Stationary loss rate: bad state probability 0.05 / (0.05 + 0.25) = 1/6
+  double expected_loss_rate = (5.0 / 6.0) * 0.01 + (1.0 / 6.0) * 0.5;
+  double loss_rate = (double) lost_packet_count1 / SIMULATOR_TEST_PACKET_COUNT;
+
+  ert_log_info("Burst loss: lost %d/%d packets, loss rate %.3f, expected %.3f",
+      lost_packet_count1, SIMULATOR_TEST_PACKET_COUNT, loss_rate, expected_loss_rate);
+
+  assert(fabs(loss_rate - expected_loss_rate) < 0.04);
+
+  // The same seed must produce the same loss pattern
+  assert(lost_packet_count1 == lost_packet_count2);
+  assert(memcmp(delivered1, delivered2, SIMULATOR_TEST_PACKET_COUNT) == 0);
+  assert(memcmp(delivered1, delivered3, SIMULATOR_TEST_PACKET_COUNT) != 0);
+  (void) lost_packet_count3;
+}
+
+void ert_comm_device_simulator_test_run_test_corruption()
+{
+  ert_comm_device_simulator_test_context context;
+  ert_comm_driver_simulator_config config;
+
+  ert_driver_comm_device_simulator_create_default_config(&config);
+  config.time_scale = 0;
+  config.channel.bit_error_rate = 0.001;
+
+  ert_comm_device_simulator_test_initialize(&config, &context);
+
+  for (uint32_t i = 0; i < SIMULATOR_TEST_PACKET_COUNT / 4; i++) {
+    ert_comm_device_simulator_test_transmit(&context.device_context1, 100, true);
+  }
+
+  ert_comm_driver_simulator_channel_status channel_status;
+  ert_driver_comm_device_simulator_get_channel_status(context.device_context1.device, &channel_status);
+
+  ert_comm_device_status device_status;
+  int result = context.device_context2.device->driver->get_status(context.device_context2.device, &device_status);
+  assert(result == 0);
+
+  // Probability of corrupting a packet of 800 bits is 1 - (1 - 0.001)^800 = 0.55
+  ert_log_info("Corruption: corrupted %d/%d packets", (int) channel_status.corrupted_packet_count,
+      SIMULATOR_TEST_PACKET_COUNT / 4);
+
+  assert(channel_status.corrupted_packet_count > SIMULATOR_TEST_PACKET_COUNT / 4 * 0.45);
+  assert(channel_status.corrupted_packet_count < SIMULATOR_TEST_PACKET_COUNT / 4 * 0.65);
+  assert(context.device_context2.invalid_received_packet_count == channel_status.corrupted_packet_count);
+  assert(device_status.invalid_received_packet_count == channel_status.corrupted_packet_count);
+  assert(device_status.received_packet_count + channel_status.corrupted_packet_count == SIMULATOR_TEST_PACKET_COUNT / 4);
+
+  ert_comm_device_simulator_test_uninitialize(&context);
+}
+
+void ert_comm_device_simulator_test_run_test_half_duplex()
+{
+  ert_comm_device_simulator_test_context context;
+  ert_comm_driver_simulator_config config;
+
+  // SF12 packets of 255 bytes take about 90 ms and packets of 10 bytes about 10 ms with the time scale
+  ert_driver_comm_device_simulator_create_default_config(&config);
+  config.lora.spreading_factor = 12;
+  config.time_scale = 0.01;
+  config.channel.turnaround_time_millis = 5000;
+
+  ert_comm_device_simulator_test_initialize(&config, &context);
+
+  ert_log_info("Transmitting a packet while the receiver is transmitting...");
+
+  ert_comm_device_simulator_test_transmit(&context.device_context2, 255, false);
+  ert_comm_device_simulator_test_transmit(&context.device_context1, 10, true);
+  assert(context.device_context2.received_packet_count == 0);
+
+  for (int retry_count = 1000; retry_count > 0 && context.device_context2.transmitted_packet_count == 0; retry_count--) {
+    usleep(1000);
+  }
+  assert(context.device_context2.transmitted_packet_count == 1);
+
+  // Both packets are lost, because each device was transmitting while the other one's packet was on air
+  assert(context.device_context1.received_packet_count == 0);
+  assert(context.device_context2.received_packet_count == 0);
+
+  ert_log_info("Transmitting a packet while the receiver is switching to receive mode...");
+
+  ert_comm_device_simulator_test_transmit(&context.device_context1, 10, true);
+  assert(context.device_context2.received_packet_count == 0);
+
+  ert_log_info("Transmitting a packet after the receiver has switched to receive mode...");
+
+  usleep(100000);
+  ert_comm_device_simulator_test_transmit(&context.device_context1, 10, true);
+  assert(context.device_context2.received_packet_count == 1);
+  assert(context.device_context2.received_data_length == 10);
+
+  ert_comm_driver_simulator_channel_status channel_status;
+  ert_driver_comm_device_simulator_get_channel_status(context.device_context1.device, &channel_status);
+  assert(channel_status.half_duplex_lost_packet_count == 2);
+  assert(channel_status.delivered_packet_count == 1);
+
+  ert_driver_comm_device_simulator_get_channel_status(context.device_context2.device, &channel_status);
+  assert(channel_status.half_duplex_lost_packet_count == 1);
+
+  ert_comm_device_simulator_test_uninitialize(&context);
+}
+
+void ert_comm_device_simulator_test_run_test_signal_status()
+{
+  ert_comm_device_simulator_test_context context;
+  ert_comm_driver_simulator_config config;
+
+  ert_driver_comm_device_simulator_create_default_config(&config);
+  config.time_scale = 0;
+  config.channel.rssi = -120.0f;
+  config.channel.snr = -5.0f;
+
+  ert_comm_device_simulator_test_initialize(&config, &context);
+
+  ert_comm_device_simulator_test_transmit(&context.device_context1, 10, true);
+  assert(context.device_context2.received_packet_count == 1);
+
+  ert_comm_device *device = context.device_context2.device;
+  ert_comm_device_status device_status;
+
+  int result = device->driver->read_status(device);
+  assert(result == 0);
+  result = device->driver->get_status(device, &device_status);
+  assert(result == 0);
+
+  ert_log_info("Signal status: last_received_packet_rssi=%.2f last_received_packet_snr=%.2f current_rssi=%.2f",
+      device_status.last_received_packet_rssi, device_status.last_received_packet_snr, device_status.current_rssi);
+
+  assert(fabsf(device_status.last_received_packet_rssi - (-125.0f)) < 0.01f);
+  assert(fabsf(device_status.last_received_packet_snr - (-5.0f)) < 0.01f);
+  assert(fabsf(device_status.current_rssi - (-115.0f)) < 0.01f);
+  assert(device_status.received_packet_count == 1);
+  assert(device_status.received_bytes == 10);
+
+  ert_comm_device_simulator_test_uninitialize(&context);
+}
+
+int main(void)
+{
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_comm_device_simulator_test_run_test_airtime();
+
+  ert_comm_device_simulator_test_run_test_burst_loss();
+
+  ert_comm_device_simulator_test_run_test_corruption();
+
+  ert_comm_device_simulator_test_run_test_half_duplex();
+
+  ert_comm_device_simulator_test_run_test_signal_status();
+
+  ert_log_info("Tests finished successfully");
+
+  ert_test_uninit();
+
+  return EXIT_SUCCESS;
+}
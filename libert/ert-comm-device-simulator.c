@@ -0,0 +1,672 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <math.h>
+#include <inttypes.h>
+
+#include "ert-comm-device-simulator.h"
+#include "ert-time.h"
+#include "ert-log.h"
+
+ert_comm_driver ert_comm_driver_simulator;
+
+typedef enum _ert_comm_driver_simulator_counter_type {
+  ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_TRANSMIT = 1,
+  ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_RECEIVE,
+  ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_RECEIVE_INVALID,
+} ert_comm_driver_simulator_counter_type;
+
+static void ert_comm_driver_simulator_increment_counter(ert_comm_device *device,
+    ert_comm_driver_simulator_counter_type type, uint64_t packet_bytes)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  pthread_mutex_lock(&driver->status_mutex);
+
+  ert_comm_device_status *status = &device->status;
+
+  switch (type) {
+    case ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_TRANSMIT:
+      ert_get_current_timestamp(&status->last_transmitted_packet_timestamp);
+      status->transmitted_packet_count++;
+      status->transmitted_bytes += packet_bytes;
+      break;
+    case ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_RECEIVE:
+      ert_get_current_timestamp(&status->last_received_packet_timestamp);
+      status->received_packet_count++;
+      status->received_bytes += packet_bytes;
+      break;
+    case ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_RECEIVE_INVALID:
+      ert_get_current_timestamp(&status->last_invalid_received_packet_timestamp);
+      status->invalid_received_packet_count++;
+      break;
+    default:
+      ert_log_error("Invalid counter type: %d", type);
+      break;
+  }
+
+  pthread_mutex_unlock(&driver->status_mutex);
+}
+
+static uint64_t ert_comm_driver_simulator_random_seed(uint64_t seed)
+{
+  // SplitMix64 spreads the bits of small seeds so that the generator state is never zero
+  uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+
+  return (z != 0) ? z : 0x9E3779B97F4A7C15ULL;
+}
+
+// Must be called status_mutex locked, returns a uniformly distributed number in range [0, 1)
+static double ert_comm_driver_simulator_random(ert_driver_comm_device_simulator *driver)
+{
+  // xorshift64*
+  uint64_t x = driver->random_state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  driver->random_state = x;
+
+  return (double) ((x * 0x2545F4914F6CDD1DULL) >> 11) / (double) (1ULL << 53);
+}
+
+// Must be called status_mutex locked
+static double ert_comm_driver_simulator_random_normal(ert_driver_comm_device_simulator *driver,
+    double mean, double deviation)
+{
+  // Box-Muller transform, both random numbers are always drawn to keep the sequence deterministic
+  double u1 = 1.0 - ert_comm_driver_simulator_random(driver);
+  double u2 = ert_comm_driver_simulator_random(driver);
+
+  return mean + deviation * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static double ert_comm_driver_simulator_timespec_diff_millis(struct timespec *start, struct timespec *stop)
+{
+  return (double) (stop->tv_sec - start->tv_sec) * 1000.0 + (double) (stop->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static void ert_comm_driver_simulator_millis_to_timespec(double millis, struct timespec *ts)
+{
+  uint64_t nanos = (uint64_t) (millis * 1000000.0);
+
+  // A zero timer value would disarm the timer
+  if (nanos == 0) {
+    nanos = 1;
+  }
+
+  ts->tv_sec = (time_t) (nanos / 1000000000ULL);
+  ts->tv_nsec = (long) (nanos % 1000000000ULL);
+}
+
+double ert_driver_comm_device_simulator_calculate_airtime_millis(ert_comm_driver_simulator_lora_config *lora_config,
+    uint32_t length)
+{
+  // Time on air formula from Semtech application note AN1200.13 "LoRa Modem Designer's Guide"
+  double spreading_factor = lora_config->spreading_factor;
+  double symbol_time_millis = pow(2.0, spreading_factor) / (double) lora_config->bandwidth_hz * 1000.0;
+  bool low_data_rate_optimize = lora_config->low_data_rate_optimize || symbol_time_millis > 16.0;
+
+  double preamble_time_millis = ((double) lora_config->preamble_length + 4.25) * symbol_time_millis;
+
+  double payload_symbols_numerator = 8.0 * length - 4.0 * spreading_factor + 28.0
+      + (lora_config->crc ? 16.0 : 0.0) - (lora_config->implicit_header_mode ? 20.0 : 0.0);
+  double payload_symbols_denominator = 4.0 * (spreading_factor - (low_data_rate_optimize ? 2.0 : 0.0));
+  double payload_symbols = ceil(payload_symbols_numerator / payload_symbols_denominator)
+      * (lora_config->coding_rate + 4.0);
+  if (payload_symbols < 0) {
+    payload_symbols = 0;
+  }
+  payload_symbols += 8.0;
+
+  return preamble_time_millis + payload_symbols * symbol_time_millis;
+}
+
+int ert_comm_driver_simulator_get_frequency_error(ert_comm_device *device, double *frequency_error_hz)
+{
+  *frequency_error_hz = 0.0f;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_configure_generic(ert_comm_device *device, void *config)
+{
+  return 0;
+}
+
+int ert_comm_driver_simulator_set_frequency(ert_comm_device *device, ert_comm_device_config_type type, double frequency)
+{
+  device->status.frequency = frequency;
+
+  return 0;
+}
+
+static bool ert_comm_driver_simulator_is_receiver_transmitting(ert_comm_device *device, ert_comm_device *other_device)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+  ert_driver_comm_device_simulator *other_driver = (ert_driver_comm_device_simulator *) other_device->priv;
+
+  if (other_driver->transmit_active) {
+    return true;
+  }
+
+  if (ert_timespec_is_zero(&other_driver->transmit_finished_timestamp)) {
+    return false;
+  }
+
+  // The receiver has to be back in receive mode before the preamble of the packet begins
+  double turnaround_time_millis = other_driver->config.channel.turnaround_time_millis * other_driver->config.time_scale;
+  double receive_mode_delay_millis = ert_comm_driver_simulator_timespec_diff_millis(
+      &other_driver->transmit_finished_timestamp, &driver->transmit_started_timestamp);
+
+  return receive_mode_delay_millis < turnaround_time_millis;
+}
+
+static void ert_comm_driver_simulator_transfer(ert_comm_device *device)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+  ert_comm_driver_simulator_channel_config *channel = &driver->config.channel;
+  ert_comm_device *other_device = driver->config.other_device;
+  ert_driver_comm_device_simulator *other_driver = (ert_driver_comm_device_simulator *) other_device->priv;
+
+  pthread_mutex_lock(&driver->status_mutex);
+
+  // Draw the same amount of random numbers for every packet, so that the channel behaves the same way
+  // for the same sequence of transmitted packets regardless of thread timing
+  double state_random = ert_comm_driver_simulator_random(driver);
+  double loss_random = ert_comm_driver_simulator_random(driver);
+  double corruption_random = ert_comm_driver_simulator_random(driver);
+  double corrupted_bit_random = ert_comm_driver_simulator_random(driver);
+  float rssi = (float) ert_comm_driver_simulator_random_normal(driver, channel->rssi, channel->rssi_deviation);
+  float snr = (float) ert_comm_driver_simulator_random_normal(driver, channel->snr, channel->snr_deviation);
+
+  ert_comm_driver_simulator_channel_status *channel_status = &driver->channel_status;
+
+  if (channel_status->bad_state) {
+    channel_status->bad_state = !(state_random < channel->bad_to_good_probability);
+  } else {
+    channel_status->bad_state = state_random < channel->good_to_bad_probability;
+  }
+
+  double loss_probability = channel_status->bad_state ? channel->bad_loss_probability : channel->good_loss_probability;
+  bool lost = loss_random < loss_probability;
+
+  uint32_t bit_count = driver->transmit_data_length * 8;
+  double corruption_probability = 1.0 - pow(1.0 - channel->bit_error_rate, bit_count);
+  bool corrupted = !lost && bit_count > 0 && corruption_random < corruption_probability;
+
+  bool half_duplex_lost = !lost && ert_comm_driver_simulator_is_receiver_transmitting(device, other_device);
+
+  channel_status->transmitted_packet_count++;
+  if (lost) {
+    channel_status->lost_packet_count++;
+  } else if (half_duplex_lost) {
+    channel_status->half_duplex_lost_packet_count++;
+  } else {
+    channel_status->delivered_packet_count++;
+    if (corrupted) {
+      channel_status->corrupted_packet_count++;
+    }
+  }
+
+  pthread_mutex_unlock(&driver->status_mutex);
+
+  if (lost || half_duplex_lost) {
+    ert_log_debug("Simulator: packet of %d bytes lost: half_duplex=%d", driver->transmit_data_length, half_duplex_lost);
+    return;
+  }
+
+  memcpy(other_driver->receive_data, driver->transmit_data, driver->transmit_data_length);
+
+  if (corrupted) {
+    uint32_t corrupted_bit = (uint32_t) (corrupted_bit_random * bit_count);
+    other_driver->receive_data[corrupted_bit / 8] ^= (uint8_t) (1 << (corrupted_bit % 8));
+  }
+
+  other_driver->receive_data_length = driver->transmit_data_length;
+  other_driver->receive_crc_error = corrupted && other_driver->config.lora.crc;
+  other_driver->receive_rssi = rssi;
+  other_driver->receive_snr = snr;
+
+  if (other_driver->config.receive_callback != NULL) {
+    other_driver->config.receive_callback(other_driver->config.callback_context);
+  }
+}
+
+static void ert_driver_comm_device_simulator_transmit_callback(union sigval sv)
+{
+  ert_comm_device *device = (ert_comm_device *) sv.sival_ptr;
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  device->status.device_state = ERT_COMM_DEVICE_STATE_STANDBY;
+
+  ert_comm_driver_simulator_transfer(device);
+
+  ert_comm_driver_simulator_increment_counter(device, ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_TRANSMIT,
+      driver->transmit_data_length);
+
+  ert_get_current_timestamp(&driver->transmit_finished_timestamp);
+  driver->transmit_data_length = 0;
+  driver->transmit_active = false;
+
+  if (driver->config.transmit_callback != NULL) {
+    driver->config.transmit_callback(driver->config.callback_context);
+  }
+}
+
+int ert_comm_driver_simulator_transmit(ert_comm_device *device, uint32_t length, uint8_t *payload, uint32_t *bytes_transmitted)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  if (length > driver->config.max_packet_length) {
+    return -EINVAL;
+  }
+  if (driver->transmit_active) {
+    ert_log_error("Simulator device still transmitting");
+    return -EBUSY;
+  }
+
+  *bytes_transmitted = length;
+
+  memcpy(driver->transmit_data, payload, length);
+  driver->transmit_data_length = length;
+
+  double airtime_millis = ert_driver_comm_device_simulator_calculate_airtime_millis(&driver->config.lora, length);
+
+  pthread_mutex_lock(&driver->status_mutex);
+  driver->channel_status.airtime_millis += airtime_millis;
+  pthread_mutex_unlock(&driver->status_mutex);
+
+  struct itimerspec ts = {0};
+  ert_comm_driver_simulator_millis_to_timespec(airtime_millis * driver->config.time_scale, &ts.it_value);
+
+  ert_get_current_timestamp(&driver->transmit_started_timestamp);
+
+  device->status.device_state = ERT_COMM_DEVICE_STATE_TRANSMIT;
+
+  driver->transmit_active = true;
+
+  int result = timer_settime(driver->transmit_callback_timer, 0, &ts, NULL);
+  if (result < 0) {
+    device->status.device_state = ERT_COMM_DEVICE_STATE_STANDBY;
+    driver->transmit_active = false;
+    ert_log_error("Error setting transmit callback timer timeout: %s", strerror(errno));
+    return -EIO;
+  }
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_wait_for_transmit(ert_comm_device *device, uint32_t milliseconds)
+{
+  if (device->status.device_state != ERT_COMM_DEVICE_STATE_TRANSMIT) {
+    return -EIO;
+  }
+
+  device->status.device_state = ERT_COMM_DEVICE_STATE_STANDBY;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_wait_for_data(ert_comm_device *device, uint32_t milliseconds)
+{
+  if (device->status.device_state != ERT_COMM_DEVICE_STATE_RECEIVE_CONTINUOUS &&
+      device->status.device_state != ERT_COMM_DEVICE_STATE_RECEIVE_SINGLE) {
+    return -EIO;
+  }
+
+  device->status.device_state = ERT_COMM_DEVICE_STATE_STANDBY;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_start_receive(ert_comm_device *device, bool continuous)
+{
+  device->status.device_state = continuous ?
+                                ERT_COMM_DEVICE_STATE_RECEIVE_CONTINUOUS :
+                                ERT_COMM_DEVICE_STATE_RECEIVE_SINGLE;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_wait_for_detection(ert_comm_device *device, uint32_t milliseconds)
+{
+  if (device->status.device_state != ERT_COMM_DEVICE_STATE_DETECTION) {
+    return -EIO;
+  }
+
+  device->status.device_state = ERT_COMM_DEVICE_STATE_STANDBY;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_start_detection(ert_comm_device *device)
+{
+  device->status.device_state = ERT_COMM_DEVICE_STATE_DETECTION;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_receive(ert_comm_device *device, uint32_t buffer_length, uint8_t *buffer, uint32_t *bytes_received)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  if (driver->receive_data_length == 0) {
+    *bytes_received = 0;
+    return 0;
+  }
+
+  // Report packet signal strength the same way as SX127x: RSSI is corrected with SNR for packets below noise floor
+  device->status.last_received_packet_rssi = (driver->receive_snr < 0) ?
+      driver->receive_rssi + driver->receive_snr : driver->receive_rssi;
+  device->status.last_received_packet_snr = driver->receive_snr;
+
+  if (driver->receive_crc_error) {
+    driver->receive_data_length = 0;
+    ert_comm_driver_simulator_increment_counter(device, ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_RECEIVE_INVALID, 0);
+    return -EBADMSG;
+  }
+
+  uint32_t bytes_to_transfer =
+      (buffer_length < driver->receive_data_length) ? buffer_length : driver->receive_data_length;
+
+  memcpy(buffer, driver->receive_data, bytes_to_transfer);
+  *bytes_received = bytes_to_transfer;
+
+  driver->receive_data_length = 0;
+
+  ert_comm_driver_simulator_increment_counter(device, ERT_COMM_DRIVER_SIMULATOR_COUNTER_TYPE_RECEIVE, bytes_to_transfer);
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_read_status(ert_comm_device *device)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  int result = ert_get_current_timestamp(&device->status.timestamp);
+  if (result != 0) {
+    return -EIO;
+  }
+
+  // Noise floor of the channel
+  device->status.current_rssi = driver->config.channel.rssi - driver->config.channel.snr;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_get_status(ert_comm_device *device, ert_comm_device_status *status)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  pthread_mutex_lock(&driver->status_mutex);
+  memcpy(status, &device->status, sizeof(ert_comm_device_status));
+  pthread_mutex_unlock(&driver->status_mutex);
+
+  return 0;
+}
+
+uint32_t ert_comm_driver_simulator_get_max_packet_length(ert_comm_device *device)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+  return driver->config.max_packet_length;
+}
+
+int ert_comm_driver_simulator_set_receive_callback(ert_comm_device *device, ert_comm_driver_callback receive_callback)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  driver->config.receive_callback = receive_callback;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_set_transmit_callback(ert_comm_device *device, ert_comm_driver_callback transmit_callback)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  driver->config.transmit_callback = transmit_callback;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_set_detection_callback(ert_comm_device *device, ert_comm_driver_callback detection_callback)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  driver->config.detection_callback = detection_callback;
+
+  return 0;
+}
+
+int ert_comm_driver_simulator_set_callback_context(ert_comm_device *device, void *callback_context)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  driver->config.callback_context = callback_context;
+
+  return 0;
+}
+
+void ert_driver_comm_device_simulator_create_default_config(ert_comm_driver_simulator_config *config)
+{
+  memset(config, 0, sizeof(ert_comm_driver_simulator_config));
+
+  config->max_packet_length = 255;
+
+  config->lora.spreading_factor = ERT_COMM_DEVICE_SIMULATOR_LORA_SPREADING_FACTOR_DEFAULT;
+  config->lora.bandwidth_hz = ERT_COMM_DEVICE_SIMULATOR_LORA_BANDWIDTH_HZ_DEFAULT;
+  config->lora.coding_rate = ERT_COMM_DEVICE_SIMULATOR_LORA_CODING_RATE_DEFAULT;
+  config->lora.preamble_length = ERT_COMM_DEVICE_SIMULATOR_LORA_PREAMBLE_LENGTH_DEFAULT;
+  config->lora.implicit_header_mode = false;
+  config->lora.crc = true;
+  config->lora.low_data_rate_optimize = false;
+
+  config->channel.good_to_bad_probability = 0.0;
+  config->channel.bad_to_good_probability = 1.0;
+  config->channel.good_loss_probability = 0.0;
+  config->channel.bad_loss_probability = 1.0;
+  config->channel.bit_error_rate = 0.0;
+  config->channel.turnaround_time_millis = 0;
+  config->channel.rssi = -90.0f;
+  config->channel.rssi_deviation = 0.0f;
+  config->channel.snr = 10.0f;
+  config->channel.snr_deviation = 0.0f;
+
+  config->seed = 1;
+  config->time_scale = 1.0;
+}
+
+int ert_driver_comm_device_simulator_connect(ert_comm_device *device, ert_comm_device *other_device)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+  driver->config.other_device = other_device;
+
+  ert_driver_comm_device_simulator *other_driver = (ert_driver_comm_device_simulator *) other_device->priv;
+  other_driver->config.other_device = device;
+
+  return 0;
+}
+
+void ert_driver_comm_device_simulator_get_channel_status(ert_comm_device *device,
+    ert_comm_driver_simulator_channel_status *channel_status)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  pthread_mutex_lock(&driver->status_mutex);
+  memcpy(channel_status, &driver->channel_status, sizeof(ert_comm_driver_simulator_channel_status));
+  pthread_mutex_unlock(&driver->status_mutex);
+}
+
+int ert_driver_comm_device_simulator_open(ert_comm_driver_simulator_config *config, ert_comm_device **device_rcv)
+{
+  int result;
+  ert_comm_device *device;
+  ert_driver_comm_device_simulator *driver;
+
+  if (config->lora.spreading_factor < 6 || config->lora.spreading_factor > 12
+      || config->lora.bandwidth_hz == 0 || config->lora.coding_rate < 1 || config->lora.coding_rate > 4) {
+    ert_log_error("Invalid LoRa modulation parameters for simulator: spreading_factor=%d, bandwidth_hz=%d, coding_rate=%d",
+        config->lora.spreading_factor, config->lora.bandwidth_hz, config->lora.coding_rate);
+    return -EINVAL;
+  }
+
+  device = malloc(sizeof(ert_comm_device));
+  if (device == NULL) {
+    ert_log_fatal("Error allocating memory for comm device struct: %s", strerror(errno));
+    result = -ENOMEM;
+    goto error_first;
+  }
+
+  memset(device, 0, sizeof(ert_comm_device));
+
+  driver = malloc(sizeof(ert_driver_comm_device_simulator));
+  if (driver == NULL) {
+    ert_log_fatal("Error allocating memory for driver struct: %s", strerror(errno));
+    result = -ENOMEM;
+    goto error_device_malloc;
+  }
+
+  memset(driver, 0, sizeof(ert_driver_comm_device_simulator));
+
+  driver->transmit_data = malloc(config->max_packet_length);
+  if (driver->transmit_data == NULL) {
+    ert_log_fatal("Error allocating memory for driver transmit data: %s", strerror(errno));
+    result = -ENOMEM;
+    goto error_driver_malloc;
+  }
+
+  driver->receive_data = malloc(config->max_packet_length);
+  if (driver->receive_data == NULL) {
+    ert_log_fatal("Error allocating memory for driver receive data: %s", strerror(errno));
+    result = -ENOMEM;
+    goto error_transmit_data_malloc;
+  }
+
+  result = pthread_mutex_init(&driver->status_mutex, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing status mutex: %s", strerror(result));
+    result = -EIO;
+    goto error_receive_data_malloc;
+  }
+
+  struct sigevent transmit_callback_timer_event;
+
+  transmit_callback_timer_event.sigev_notify = SIGEV_THREAD;
+  transmit_callback_timer_event.sigev_notify_function = ert_driver_comm_device_simulator_transmit_callback;
+  transmit_callback_timer_event.sigev_notify_attributes = NULL;
+  transmit_callback_timer_event.sigev_value.sival_ptr = device;
+
+  result = timer_create(CLOCK_REALTIME, &transmit_callback_timer_event, &driver->transmit_callback_timer);
+  if (result < 0) {
+    ert_log_error("Error creating transmit callback timer: %s", strerror(errno));
+    result = -EIO;
+    goto error_status_mutex;
+  }
+
+  memcpy(&driver->config, config, sizeof(ert_comm_driver_simulator_config));
+  driver->random_state = ert_comm_driver_simulator_random_seed(config->seed);
+  device->driver = &ert_comm_driver_simulator;
+  device->priv = driver;
+
+  device->status.name = "Simulator";
+  device->status.model = "LoRa channel simulator";
+  device->status.manufacturer = "Simulator";
+  device->status.custom = NULL;
+
+  device->status.device_state = ERT_COMM_DEVICE_STATE_SLEEP;
+
+  *device_rcv = device;
+
+  return 0;
+
+  error_status_mutex:
+  pthread_mutex_destroy(&driver->status_mutex);
+
+  error_receive_data_malloc:
+  free(driver->receive_data);
+
+  error_transmit_data_malloc:
+  free(driver->transmit_data);
+
+  error_driver_malloc:
+  free(driver);
+
+  error_device_malloc:
+  free(device);
+
+  error_first:
+
+  return result;
+}
+
+int ert_driver_comm_device_simulator_standby(ert_comm_device *device)
+{
+  device->status.device_state = ERT_COMM_DEVICE_STATE_STANDBY;
+  return 0;
+}
+
+int ert_driver_comm_device_simulator_sleep(ert_comm_device *device)
+{
+  device->status.device_state = ERT_COMM_DEVICE_STATE_SLEEP;
+  return 0;
+}
+
+int ert_driver_comm_device_simulator_close(ert_comm_device *device)
+{
+  ert_driver_comm_device_simulator *driver = (ert_driver_comm_device_simulator *) device->priv;
+
+  device->driver->standby(device);
+  device->driver->sleep(device);
+
+  int result = timer_delete(driver->transmit_callback_timer);
+  if (result < 0) {
+    ert_log_error("Error deleting transmit callback timer: %s", strerror(errno));
+  }
+
+  pthread_mutex_destroy(&driver->status_mutex);
+
+  free(driver->receive_data);
+  free(driver->transmit_data);
+  free(driver);
+  free(device);
+
+  return 0;
+}
+
+ert_comm_driver ert_comm_driver_simulator = {
+    .transmit = ert_comm_driver_simulator_transmit,
+    .wait_for_transmit = ert_comm_driver_simulator_wait_for_transmit,
+    .start_detection = ert_comm_driver_simulator_start_detection,
+    .wait_for_detection = ert_comm_driver_simulator_wait_for_detection,
+    .start_receive = ert_comm_driver_simulator_start_receive,
+    .wait_for_data = ert_comm_driver_simulator_wait_for_data,
+    .receive = ert_comm_driver_simulator_receive,
+    .configure = ert_comm_driver_simulator_configure_generic,
+    .set_frequency = ert_comm_driver_simulator_set_frequency,
+    .get_frequency_error = ert_comm_driver_simulator_get_frequency_error,
+    .standby = ert_driver_comm_device_simulator_standby,
+    .read_status = ert_comm_driver_simulator_read_status,
+    .get_status = ert_comm_driver_simulator_get_status,
+    .get_max_packet_length = ert_comm_driver_simulator_get_max_packet_length,
+    .set_receive_callback = ert_comm_driver_simulator_set_receive_callback,
+    .set_transmit_callback = ert_comm_driver_simulator_set_transmit_callback,
+    .set_detection_callback = ert_comm_driver_simulator_set_detection_callback,
+    .set_callback_context = ert_comm_driver_simulator_set_callback_context,
+    .sleep = ert_driver_comm_device_simulator_sleep,
+    .close = ert_driver_comm_device_simulator_close,
+};
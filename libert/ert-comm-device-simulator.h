@@ -0,0 +1,128 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ERT_COMM_DEVICE_SIMULATOR_H
+#define __ERT_COMM_DEVICE_SIMULATOR_H
+
+#include "ert-common.h"
+#include "ert-comm.h"
+
+#include <pthread.h>
+#include <time.h>
+
+#define ERT_COMM_DEVICE_SIMULATOR_LORA_SPREADING_FACTOR_DEFAULT 7
+#define ERT_COMM_DEVICE_SIMULATOR_LORA_BANDWIDTH_HZ_DEFAULT 125000
+#define ERT_COMM_DEVICE_SIMULATOR_LORA_CODING_RATE_DEFAULT 1
+#define ERT_COMM_DEVICE_SIMULATOR_LORA_PREAMBLE_LENGTH_DEFAULT 8
+
+/*
+ * LoRa modulation parameters used for calculating the time on air of each packet.
+ * Coding rate 1-4 means error coding rate 4/5-4/8.
+ */
+typedef struct _ert_comm_driver_simulator_lora_config {
+  uint8_t spreading_factor;
+  uint32_t bandwidth_hz;
+  uint8_t coding_rate;
+  uint16_t preamble_length;
+  bool implicit_header_mode;
+  bool crc;
+  // Low data rate optimization is always enabled when symbol time exceeds 16 ms
+  bool low_data_rate_optimize;
+} ert_comm_driver_simulator_lora_config;
+
+/*
+ * Packet loss follows the Gilbert-Elliott model: the channel changes state between good and bad
+ * before each packet with the given transition probabilities and loses the packet with the loss
+ * probability of the current state.
+ */
+typedef struct _ert_comm_driver_simulator_channel_config {
+  double good_to_bad_probability;
+  double bad_to_good_probability;
+  double good_loss_probability;
+  double bad_loss_probability;
+
+  // Probability of a single bit being flipped, corrupted packets fail the CRC check if CRC is enabled
+  double bit_error_rate;
+
+  // Packets arriving while the receiving device transmits or switches from transmit to receive mode are lost
+  uint32_t turnaround_time_millis;
+
+  float rssi;
+  float rssi_deviation;
+  float snr;
+  float snr_deviation;
+} ert_comm_driver_simulator_channel_config;
+
+typedef struct _ert_comm_driver_simulator_config {
+  uint32_t max_packet_length;
+
+  ert_comm_driver_simulator_lora_config lora;
+  ert_comm_driver_simulator_channel_config channel;
+
+  // Seed for the random number generator, the same seed produces the same channel behavior
+  uint64_t seed;
+  // Multiplier for simulated time on air and turnaround time, use 0 to transmit packets immediately
+  double time_scale;
+
+  ert_comm_device *other_device;
+
+  ert_comm_driver_callback receive_callback;
+  ert_comm_driver_callback transmit_callback;
+  ert_comm_driver_callback detection_callback;
+  void *callback_context;
+} ert_comm_driver_simulator_config;
+
+typedef struct _ert_comm_driver_simulator_channel_status {
+  uint64_t transmitted_packet_count;
+  uint64_t delivered_packet_count;
+  uint64_t lost_packet_count;
+  uint64_t half_duplex_lost_packet_count;
+  uint64_t corrupted_packet_count;
+
+  // Total simulated time on air of transmitted packets, not scaled by time_scale
+  double airtime_millis;
+
+  bool bad_state;
+} ert_comm_driver_simulator_channel_status;
+
+typedef struct _ert_driver_comm_device_simulator {
+  ert_comm_driver_simulator_config config;
+
+  timer_t transmit_callback_timer;
+
+  uint32_t transmit_data_length;
+  uint8_t *transmit_data;
+  struct timespec transmit_started_timestamp;
+  struct timespec transmit_finished_timestamp;
+
+  uint32_t receive_data_length;
+  uint8_t *receive_data;
+  bool receive_crc_error;
+  float receive_rssi;
+  float receive_snr;
+
+  uint64_t random_state;
+
+  ert_comm_driver_simulator_channel_status channel_status;
+  pthread_mutex_t status_mutex;
+
+  volatile bool transmit_active;
+} ert_driver_comm_device_simulator;
+
+void ert_driver_comm_device_simulator_create_default_config(ert_comm_driver_simulator_config *config);
+double ert_driver_comm_device_simulator_calculate_airtime_millis(ert_comm_driver_simulator_lora_config *lora_config,
+    uint32_t length);
+int ert_driver_comm_device_simulator_open(ert_comm_driver_simulator_config *config, ert_comm_device **device_rcv);
+int ert_driver_comm_device_simulator_connect(ert_comm_device *device, ert_comm_device *other_device);
+void ert_driver_comm_device_simulator_get_channel_status(ert_comm_device *device,
+    ert_comm_driver_simulator_channel_status *channel_status);
+int ert_driver_comm_device_simulator_close(ert_comm_device *device);
+
+#endif
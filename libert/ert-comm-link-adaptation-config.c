@@ -0,0 +1,62 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ert-comm-link-adaptation-config.h"
+
+ert_mapper_entry *ert_comm_link_adaptation_create_mappings(ert_comm_link_adaptation_config *config)
+{
+  ert_mapper_entry comm_link_adaptation_children[] = {
+      {
+          .name = "enabled",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &config->enabled,
+      },
+      {
+          .name = "initial_data_rate_index",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT8,
+          .value = &config->initial_data_rate_index,
+      },
+      {
+          .name = "snr_margin",
+          .type = ERT_MAPPER_ENTRY_TYPE_FLOAT,
+          .value = &config->snr_margin,
+      },
+      {
+          .name = "snr_hysteresis",
+          .type = ERT_MAPPER_ENTRY_TYPE_FLOAT,
+          .value = &config->snr_hysteresis,
+      },
+      {
+          .name = "snr_smoothing_factor",
+          .type = ERT_MAPPER_ENTRY_TYPE_FLOAT,
+          .value = &config->snr_smoothing_factor,
+      },
+      {
+          .name = "increase_min_packet_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->increase_min_packet_count,
+      },
+      {
+          .name = "fallback_report_timeout_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->fallback_report_timeout_count,
+      },
+      {
+          .name = "fallback_receive_timeout_millis",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->fallback_receive_timeout_millis,
+      },
+      {
+          .type = ERT_MAPPER_ENTRY_TYPE_NONE,
+      },
+  };
+
+  return ert_mapper_allocate(comm_link_adaptation_children);
+}
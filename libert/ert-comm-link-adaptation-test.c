@@ -0,0 +1,348 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <assert.h>
+
+#include "ert-comm-link-adaptation.h"
+#include "ert-comm-device-simulator.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define LINK_ADAPTATION_TEST_PACKET_COUNT 1200
+#define LINK_ADAPTATION_TEST_PACKET_LENGTH 64
+#define LINK_ADAPTATION_TEST_ACK_PACKET_LENGTH 12
+#define LINK_ADAPTATION_TEST_ACK_INTERVAL 4
+#define LINK_ADAPTATION_TEST_PACKET_INTERVAL_MILLIS 5000
+
+// SNR at the reference distance of 1 km, decreasing 20 dB per decade of distance
+#define LINK_ADAPTATION_TEST_REFERENCE_SNR 10.0f
+#define LINK_ADAPTATION_TEST_REFERENCE_RSSI -90.0f
+#define LINK_ADAPTATION_TEST_MAX_DISTANCE_KM 25.0f
+
+typedef struct _ert_comm_link_adaptation_test_end {
+  ert_comm_link_adaptation *link_adaptation;
+  int32_t callback_data_rate_index;
+  uint32_t callback_count;
+} ert_comm_link_adaptation_test_end;
+
+typedef struct _ert_comm_link_adaptation_test_result {
+  uint32_t transmitted_packet_count;
+  uint32_t delivered_packet_count;
+  double airtime_millis;
+  uint8_t transmitter_data_rate_index;
+  uint8_t receiver_data_rate_index;
+  ert_comm_link_adaptation_status transmitter_status;
+  ert_comm_link_adaptation_status receiver_status;
+} ert_comm_link_adaptation_test_result;
+
+static void ert_comm_link_adaptation_test_data_rate_callback(uint8_t data_rate_index,
+    ert_comm_link_adaptation_data_rate *data_rate, void *callback_context)
+{
+  ert_comm_link_adaptation_test_end *end = (ert_comm_link_adaptation_test_end *) callback_context;
+
+  assert(data_rate != NULL);
+
+  end->callback_data_rate_index = data_rate_index;
+  end->callback_count++;
+}
+
+static void ert_comm_link_adaptation_test_add_millis(struct timespec *timestamp, double millis)
+{
+  long nanos = timestamp->tv_nsec + (long) (millis * 1000000.0);
+
+  timestamp->tv_sec += nanos / 1000000000L;
+  timestamp->tv_nsec = nanos % 1000000000L;
+}
+
+/*
+ * Distance of a balloon flight: ascent away from the receiver and descent back towards it.
+ */
+static float ert_comm_link_adaptation_test_get_distance_km(uint32_t packet_index)
+{
+  float progress = (float) packet_index / (float) LINK_ADAPTATION_TEST_PACKET_COUNT;
+
+  if (progress < 0.5f) {
+    return 1.0f + (LINK_ADAPTATION_TEST_MAX_DISTANCE_KM - 1.0f) * progress * 2.0f;
+  }
+
+  return 1.0f + (LINK_ADAPTATION_TEST_MAX_DISTANCE_KM - 1.0f) * (1.0f - progress) * 2.0f;
+}
+
+static float ert_comm_link_adaptation_test_get_deviation(uint64_t *random_state)
+{
+  *random_state = *random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+  // Uniform deviation between -1 and 1 dB
+  return (float) ((*random_state >> 33) % 2001) / 1000.0f - 1.0f;
+}
+
+static double ert_comm_link_adaptation_test_get_airtime_millis(ert_comm_link_adaptation_data_rate *data_rate,
+    uint32_t length)
+{
+  ert_comm_driver_simulator_lora_config lora_config = {
+      .spreading_factor = data_rate->spreading_factor,
+      .bandwidth_hz = data_rate->bandwidth_hz,
+      .coding_rate = data_rate->coding_rate,
+      .preamble_length = ERT_COMM_DEVICE_SIMULATOR_LORA_PREAMBLE_LENGTH_DEFAULT,
+      .implicit_header_mode = false,
+      .crc = true,
+  };
+
+  return ert_driver_comm_device_simulator_calculate_airtime_millis(&lora_config, length);
+}
+
+/*
+ * Simulates a transmitter sending packets over the flight and requesting acknowledgements for every few packets.
+ * A packet is delivered when its SNR is above the demodulation limit of the data rate and both ends use
+ * the same data rate. With adaptive set to false, both ends stay at the initial data rate.
+ */
+static void ert_comm_link_adaptation_test_run_flight(bool adaptive, uint8_t initial_data_rate_index,
+    ert_comm_link_adaptation_test_result *result)
+{
+  ert_comm_link_adaptation_config config;
+  ert_comm_link_adaptation_test_end transmitter = {0};
+  ert_comm_link_adaptation_test_end receiver = {0};
+  struct timespec timestamp = { .tv_sec = 1000, .tv_nsec = 0 };
+  uint64_t random_state = 1;
+
+  memset(result, 0, sizeof(ert_comm_link_adaptation_test_result));
+
+  ert_comm_link_adaptation_create_default_config(&config);
+  config.enabled = true;
+  config.initial_data_rate_index = initial_data_rate_index;
+
+  int res = ert_comm_link_adaptation_create(&config, ert_comm_link_adaptation_test_data_rate_callback,
+      &transmitter, &transmitter.link_adaptation);
+  assert(res == 0);
+  res = ert_comm_link_adaptation_create(&config, ert_comm_link_adaptation_test_data_rate_callback,
+      &receiver, &receiver.link_adaptation);
+  assert(res == 0);
+
+  for (uint32_t i = 0; i < LINK_ADAPTATION_TEST_PACKET_COUNT; i++) {
+    float distance_km = ert_comm_link_adaptation_test_get_distance_km(i);
+    float path_loss = 20.0f * log10f(distance_km);
+    float mean_snr = LINK_ADAPTATION_TEST_REFERENCE_SNR - path_loss;
+    float snr = mean_snr + ert_comm_link_adaptation_test_get_deviation(&random_state);
+    float rssi = LINK_ADAPTATION_TEST_REFERENCE_RSSI - path_loss;
+
+    uint8_t transmitter_index = ert_comm_link_adaptation_get_data_rate_index(transmitter.link_adaptation);
+    uint8_t receiver_index = ert_comm_link_adaptation_get_data_rate_index(receiver.link_adaptation);
+    ert_comm_link_adaptation_data_rate *transmitter_data_rate = &config.data_rates[transmitter_index];
+    ert_comm_link_adaptation_data_rate *receiver_data_rate = &config.data_rates[receiver_index];
+
+    double airtime_millis = ert_comm_link_adaptation_test_get_airtime_millis(transmitter_data_rate,
+        LINK_ADAPTATION_TEST_PACKET_LENGTH);
+    result->airtime_millis += airtime_millis;
+    result->transmitted_packet_count++;
+    ert_comm_link_adaptation_test_add_millis(&timestamp, airtime_millis);
+
+    bool request_acks = ((i + 1) % LINK_ADAPTATION_TEST_ACK_INTERVAL) == 0;
+    bool delivered = transmitter_index == receiver_index && snr >= transmitter_data_rate->required_snr;
+
+    if (delivered) {
+      result->delivered_packet_count++;
+      ert_comm_link_adaptation_update_received_packet(receiver.link_adaptation, rssi, snr, &timestamp);
+    }
+
+    if (request_acks) {
+      if (!delivered) {
+        if (adaptive) {
+          ert_comm_link_adaptation_handle_report_timeout(transmitter.link_adaptation);
+        }
+      } else {
+        ert_comm_link_adaptation_report report;
+        res = ert_comm_link_adaptation_create_report(receiver.link_adaptation, &report);
+        assert(res == 0);
+
+        double ack_airtime_millis = ert_comm_link_adaptation_test_get_airtime_millis(receiver_data_rate,
+            LINK_ADAPTATION_TEST_ACK_PACKET_LENGTH);
+        result->airtime_millis += ack_airtime_millis;
+        ert_comm_link_adaptation_test_add_millis(&timestamp, ack_airtime_millis);
+
+        // The link is assumed symmetric, so the acknowledgements see the same mean SNR as the packets
+        float ack_snr = mean_snr + ert_comm_link_adaptation_test_get_deviation(&random_state);
+        bool ack_delivered = ack_snr >= receiver_data_rate->required_snr;
+
+        if (adaptive) {
+          ert_comm_link_adaptation_report_sent(receiver.link_adaptation);
+
+          if (ack_delivered) {
+            ert_comm_link_adaptation_handle_report(transmitter.link_adaptation, &report);
+          } else {
+            ert_comm_link_adaptation_handle_report_timeout(transmitter.link_adaptation);
+          }
+        }
+      }
+    }
+
+    ert_comm_link_adaptation_test_add_millis(&timestamp, LINK_ADAPTATION_TEST_PACKET_INTERVAL_MILLIS);
+
+    if (adaptive) {
+      ert_comm_link_adaptation_check_receive_timeout(receiver.link_adaptation, &timestamp);
+    }
+  }
+
+  result->transmitter_data_rate_index = ert_comm_link_adaptation_get_data_rate_index(transmitter.link_adaptation);
+  result->receiver_data_rate_index = ert_comm_link_adaptation_get_data_rate_index(receiver.link_adaptation);
+  ert_comm_link_adaptation_get_status(transmitter.link_adaptation, &result->transmitter_status);
+  ert_comm_link_adaptation_get_status(receiver.link_adaptation, &result->receiver_status);
+
+  if (adaptive) {
+    assert(transmitter.callback_count == result->transmitter_status.data_rate_increase_count
+        + result->transmitter_status.data_rate_decrease_count);
+    assert(receiver.callback_count == result->receiver_status.data_rate_increase_count
+        + result->receiver_status.data_rate_decrease_count);
+    if (transmitter.callback_count > 0) {
+      assert(transmitter.callback_data_rate_index == result->transmitter_data_rate_index);
+    }
+    if (receiver.callback_count > 0) {
+      assert(receiver.callback_data_rate_index == result->receiver_data_rate_index);
+    }
+  }
+
+  ert_comm_link_adaptation_destroy(receiver.link_adaptation);
+  ert_comm_link_adaptation_destroy(transmitter.link_adaptation);
+}
+
+static double ert_comm_link_adaptation_test_get_goodput(ert_comm_link_adaptation_test_result *result)
+{
+  return (double) result->delivered_packet_count * LINK_ADAPTATION_TEST_PACKET_LENGTH * 8.0
+         / (result->airtime_millis / 1000.0);
+}
+
+static double ert_comm_link_adaptation_test_get_delivery_ratio(ert_comm_link_adaptation_test_result *result)
+{
+  return (double) result->delivered_packet_count / (double) result->transmitted_packet_count;
+}
+
+static void ert_comm_link_adaptation_test_log_result(char *name, ert_comm_link_adaptation_test_result *result)
+{
+  ert_log_info("%s: delivered=%d/%d delivery_ratio=%.3f airtime=%.0f ms goodput=%.1f bit/s "
+      "increases=%d decreases=%d fallbacks=%d", name,
+      result->delivered_packet_count, result->transmitted_packet_count,
+      ert_comm_link_adaptation_test_get_delivery_ratio(result), result->airtime_millis,
+      ert_comm_link_adaptation_test_get_goodput(result),
+      (int) result->transmitter_status.data_rate_increase_count,
+      (int) result->transmitter_status.data_rate_decrease_count,
+      (int) (result->transmitter_status.fallback_count + result->receiver_status.fallback_count));
+}
+
+void ert_comm_link_adaptation_test_run_test_flight_profile()
+{
+  ert_comm_link_adaptation_test_result adaptive_result;
+  ert_comm_link_adaptation_test_result robust_result;
+  ert_comm_link_adaptation_test_result fast_result;
+
+  ert_comm_link_adaptation_test_run_flight(true, 0, &adaptive_result);
+  ert_comm_link_adaptation_test_run_flight(false, 0, &robust_result);
+  ert_comm_link_adaptation_test_run_flight(false, 5, &fast_result);
+
+  ert_comm_link_adaptation_test_log_result("Adaptive", &adaptive_result);
+  ert_comm_link_adaptation_test_log_result("Fixed SF12", &robust_result);
+  ert_comm_link_adaptation_test_log_result("Fixed SF7", &fast_result);
+
+  // Adaptation keeps nearly all packets while using much less airtime than the most robust data rate
+  assert(ert_comm_link_adaptation_test_get_delivery_ratio(&adaptive_result) >= 0.95);
+  assert(ert_comm_link_adaptation_test_get_delivery_ratio(&robust_result) == 1.0);
+  assert(ert_comm_link_adaptation_test_get_goodput(&adaptive_result)
+         > 1.5 * ert_comm_link_adaptation_test_get_goodput(&robust_result));
+  assert(adaptive_result.airtime_millis < robust_result.airtime_millis * 0.7);
+
+  // The fastest data rate loses packets far away from the receiver
+  assert(ert_comm_link_adaptation_test_get_delivery_ratio(&fast_result)
+         < ert_comm_link_adaptation_test_get_delivery_ratio(&adaptive_result));
+
+  assert(adaptive_result.transmitter_status.data_rate_increase_count > 0);
+  assert(adaptive_result.transmitter_status.data_rate_decrease_count > 0);
+
+  // Both ends are back at the fastest data rate at the end of the flight
+  assert(adaptive_result.transmitter_data_rate_index == adaptive_result.receiver_data_rate_index);
+  assert(adaptive_result.transmitter_data_rate_index == 5);
+}
+
+void ert_comm_link_adaptation_test_run_test_fallback()
+{
+  ert_comm_link_adaptation_config config;
+  ert_comm_link_adaptation_test_end end = {0};
+  ert_comm_link_adaptation_report report;
+  struct timespec timestamp = { .tv_sec = 1000, .tv_nsec = 0 };
+
+  ert_comm_link_adaptation_create_default_config(&config);
+  config.initial_data_rate_index = 2;
+
+  int result = ert_comm_link_adaptation_create(&config, ert_comm_link_adaptation_test_data_rate_callback,
+      &end, &end.link_adaptation);
+  assert(result == 0);
+
+  // No report without received packets
+  result = ert_comm_link_adaptation_create_report(end.link_adaptation, &report);
+  assert(result == -EAGAIN);
+
+  // Transmitter falls back after consecutive report timeouts only
+  for (uint32_t i = 0; i < config.fallback_report_timeout_count - 1; i++) {
+    ert_comm_link_adaptation_handle_report_timeout(end.link_adaptation);
+  }
+  report.data_rate_index = 2;
+  report.snr = -5.0f;
+  report.rssi = -110.0f;
+  ert_comm_link_adaptation_handle_report(end.link_adaptation, &report);
+  ert_comm_link_adaptation_handle_report_timeout(end.link_adaptation);
+  assert(ert_comm_link_adaptation_get_data_rate_index(end.link_adaptation) == 2);
+
+  for (uint32_t i = 0; i < config.fallback_report_timeout_count - 1; i++) {
+    ert_comm_link_adaptation_handle_report_timeout(end.link_adaptation);
+  }
+  assert(ert_comm_link_adaptation_get_data_rate_index(end.link_adaptation) == 0);
+  assert(end.callback_data_rate_index == 0);
+
+  // Out of range data rate index is limited to the fastest data rate
+  report.data_rate_index = 100;
+  ert_comm_link_adaptation_handle_report(end.link_adaptation, &report);
+  assert(ert_comm_link_adaptation_get_data_rate_index(end.link_adaptation) == config.data_rate_count - 1);
+
+  // Receiver falls back when no packets have been received
+  ert_comm_link_adaptation_update_received_packet(end.link_adaptation, -100.0f, 5.0f, &timestamp);
+  timestamp.tv_sec += config.fallback_receive_timeout_millis / 1000 - 1;
+  ert_comm_link_adaptation_check_receive_timeout(end.link_adaptation, &timestamp);
+  assert(ert_comm_link_adaptation_get_data_rate_index(end.link_adaptation) == config.data_rate_count - 1);
+
+  timestamp.tv_sec += 1;
+  ert_comm_link_adaptation_check_receive_timeout(end.link_adaptation, &timestamp);
+  assert(ert_comm_link_adaptation_get_data_rate_index(end.link_adaptation) == 0);
+
+  ert_comm_link_adaptation_status status;
+  ert_comm_link_adaptation_get_status(end.link_adaptation, &status);
+  assert(status.fallback_count == 2);
+  assert(status.received_report_count == 2);
+
+  ert_comm_link_adaptation_destroy(end.link_adaptation);
+}
+
+int main(void)
+{
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_comm_link_adaptation_test_run_test_fallback();
+
+  ert_comm_link_adaptation_test_run_test_flight_profile();
+
+  ert_log_info("Tests finished successfully");
+
+  ert_test_uninit();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,299 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include "ert-comm-link-adaptation.h"
+#include "ert-time.h"
+#include "ert-log.h"
+
+/*
+ * The receiver of a stream measures the SNR of received packets and proposes a data rate in each link report
+ * it sends in acknowledgements. The transmitter switches to the proposed data rate when it receives the report
+ * and the receiver switches once the report has been sent. If the report is lost, the ends use different data rates
+ * until both fall back to the most robust data rate: the transmitter after consecutive acknowledgement timeouts
+ * and the receiver after not receiving any packets.
+ */
+
+void ert_comm_link_adaptation_create_default_config(ert_comm_link_adaptation_config *config)
+{
+  memset(config, 0, sizeof(ert_comm_link_adaptation_config));
+
+  // Spreading factors 12 to 7 at 125 kHz bandwidth, demodulation SNR limits are from the SX1276 datasheet
+  for (uint8_t spreading_factor = 12; spreading_factor >= 7; spreading_factor--) {
+    ert_comm_link_adaptation_data_rate *data_rate = &config->data_rates[config->data_rate_count];
+
+    data_rate->spreading_factor = spreading_factor;
+    data_rate->bandwidth_hz = 125000;
+    data_rate->coding_rate = 1;
+    data_rate->required_snr = -2.5f * (spreading_factor - 4);
+
+    config->data_rate_count++;
+  }
+
+  config->enabled = false;
+  config->initial_data_rate_index = 0;
+  config->snr_margin = ERT_COMM_LINK_ADAPTATION_SNR_MARGIN_DEFAULT;
+  config->snr_hysteresis = ERT_COMM_LINK_ADAPTATION_SNR_HYSTERESIS_DEFAULT;
+  config->snr_smoothing_factor = ERT_COMM_LINK_ADAPTATION_SNR_SMOOTHING_FACTOR_DEFAULT;
+  config->increase_min_packet_count = ERT_COMM_LINK_ADAPTATION_INCREASE_MIN_PACKET_COUNT_DEFAULT;
+  config->fallback_report_timeout_count = ERT_COMM_LINK_ADAPTATION_FALLBACK_REPORT_TIMEOUT_COUNT_DEFAULT;
+  config->fallback_receive_timeout_millis = ERT_COMM_LINK_ADAPTATION_FALLBACK_RECEIVE_TIMEOUT_MILLIS_DEFAULT;
+}
+
+int ert_comm_link_adaptation_create(ert_comm_link_adaptation_config *config,
+    ert_comm_link_adaptation_data_rate_callback data_rate_callback, void *data_rate_callback_context,
+    ert_comm_link_adaptation **link_adaptation_rcv)
+{
+  if (config->data_rate_count < 1 || config->data_rate_count > ERT_COMM_LINK_ADAPTATION_DATA_RATE_COUNT_MAX) {
+    ert_log_error("Invalid link adaptation data rate count %d, must be between 1 and %d",
+        config->data_rate_count, ERT_COMM_LINK_ADAPTATION_DATA_RATE_COUNT_MAX);
+    return -EINVAL;
+  }
+  if (config->initial_data_rate_index >= config->data_rate_count) {
+    ert_log_error("Invalid link adaptation initial data rate index %d, must be less than %d",
+        config->initial_data_rate_index, config->data_rate_count);
+    return -EINVAL;
+  }
+  if (config->snr_smoothing_factor <= 0.0f || config->snr_smoothing_factor > 1.0f) {
+    ert_log_error("Invalid link adaptation SNR smoothing factor %f, must be greater than 0 and at most 1",
+        config->snr_smoothing_factor);
+    return -EINVAL;
+  }
+
+  ert_comm_link_adaptation *link_adaptation = calloc(1, sizeof(ert_comm_link_adaptation));
+  if (link_adaptation == NULL) {
+    ert_log_fatal("Error allocating memory for link adaptation struct: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  int result = pthread_mutex_init(&link_adaptation->mutex, NULL);
+  if (result != 0) {
+    free(link_adaptation);
+    ert_log_error("Error initializing link adaptation mutex");
+    return -EIO;
+  }
+
+  memcpy(&link_adaptation->config, config, sizeof(ert_comm_link_adaptation_config));
+  link_adaptation->data_rate_callback = data_rate_callback;
+  link_adaptation->data_rate_callback_context = data_rate_callback_context;
+
+  link_adaptation->status.data_rate_index = config->initial_data_rate_index;
+  link_adaptation->proposed_data_rate_index = config->initial_data_rate_index;
+
+  *link_adaptation_rcv = link_adaptation;
+
+  return 0;
+}
+
+void ert_comm_link_adaptation_destroy(ert_comm_link_adaptation *link_adaptation)
+{
+  if (link_adaptation == NULL) {
+    return;
+  }
+
+  pthread_mutex_destroy(&link_adaptation->mutex);
+  free(link_adaptation);
+}
+
+// Must be called link_adaptation->mutex locked
+static void ert_comm_link_adaptation_set_data_rate(ert_comm_link_adaptation *link_adaptation,
+    uint8_t data_rate_index)
+{
+  ert_comm_link_adaptation_status *status = &link_adaptation->status;
+
+  if (data_rate_index == status->data_rate_index) {
+    return;
+  }
+
+  ert_comm_link_adaptation_data_rate *data_rate = &link_adaptation->config.data_rates[data_rate_index];
+
+  ert_log_info("Link adaptation: changing data rate from index %d to %d: spreading_factor=%d bandwidth_hz=%d "
+      "coding_rate=%d smoothed_snr=%f reported_snr=%f", status->data_rate_index, data_rate_index,
+      data_rate->spreading_factor, data_rate->bandwidth_hz, data_rate->coding_rate,
+      status->smoothed_snr, status->reported_snr);
+
+  if (data_rate_index > status->data_rate_index) {
+    status->data_rate_increase_count++;
+  } else {
+    status->data_rate_decrease_count++;
+  }
+
+  status->data_rate_index = data_rate_index;
+  link_adaptation->proposed_data_rate_index = data_rate_index;
+  link_adaptation->data_rate_packet_count = 0;
+  link_adaptation->consecutive_report_timeout_count = 0;
+
+  if (link_adaptation->data_rate_callback != NULL) {
+    link_adaptation->data_rate_callback(data_rate_index, data_rate, link_adaptation->data_rate_callback_context);
+  }
+}
+
+// Must be called link_adaptation->mutex locked
+static uint8_t ert_comm_link_adaptation_select_data_rate(ert_comm_link_adaptation *link_adaptation)
+{
+  ert_comm_link_adaptation_config *config = &link_adaptation->config;
+  uint8_t current = link_adaptation->status.data_rate_index;
+  float snr = link_adaptation->status.smoothed_snr;
+
+  // Faster data rates are taken one step at a time once the current one has been measured
+  if (current + 1 < config->data_rate_count
+      && link_adaptation->data_rate_packet_count >= config->increase_min_packet_count
+      && snr >= config->data_rates[current + 1].required_snr + config->snr_margin + config->snr_hysteresis) {
+    return (uint8_t) (current + 1);
+  }
+
+  if (snr >= config->data_rates[current].required_snr + config->snr_margin) {
+    return current;
+  }
+
+  // Slower data rates are taken directly, as packets are being lost at the current one
+  for (uint8_t index = current; index > 0; index--) {
+    if (snr >= config->data_rates[index - 1].required_snr + config->snr_margin) {
+      return (uint8_t) (index - 1);
+    }
+  }
+
+  return 0;
+}
+
+void ert_comm_link_adaptation_update_received_packet(ert_comm_link_adaptation *link_adaptation,
+    float rssi, float snr, struct timespec *timestamp)
+{
+  pthread_mutex_lock(&link_adaptation->mutex);
+
+  ert_comm_link_adaptation_status *status = &link_adaptation->status;
+  float alpha = link_adaptation->config.snr_smoothing_factor;
+
+  if (status->received_packet_count == 0) {
+    status->smoothed_snr = snr;
+    status->smoothed_rssi = rssi;
+  } else {
+    status->smoothed_snr += alpha * (snr - status->smoothed_snr);
+    status->smoothed_rssi += alpha * (rssi - status->smoothed_rssi);
+  }
+
+  status->received_packet_count++;
+  status->last_received_packet_timestamp = *timestamp;
+  link_adaptation->data_rate_packet_count++;
+
+  pthread_mutex_unlock(&link_adaptation->mutex);
+}
+
+int ert_comm_link_adaptation_create_report(ert_comm_link_adaptation *link_adaptation,
+    ert_comm_link_adaptation_report *report)
+{
+  pthread_mutex_lock(&link_adaptation->mutex);
+
+  if (link_adaptation->status.received_packet_count == 0) {
+    pthread_mutex_unlock(&link_adaptation->mutex);
+    return -EAGAIN;
+  }
+
+  link_adaptation->proposed_data_rate_index = ert_comm_link_adaptation_select_data_rate(link_adaptation);
+
+  report->data_rate_index = link_adaptation->proposed_data_rate_index;
+  report->snr = link_adaptation->status.smoothed_snr;
+  report->rssi = link_adaptation->status.smoothed_rssi;
+
+  pthread_mutex_unlock(&link_adaptation->mutex);
+
+  return 0;
+}
+
+void ert_comm_link_adaptation_report_sent(ert_comm_link_adaptation *link_adaptation)
+{
+  pthread_mutex_lock(&link_adaptation->mutex);
+
+  link_adaptation->status.sent_report_count++;
+  ert_comm_link_adaptation_set_data_rate(link_adaptation, link_adaptation->proposed_data_rate_index);
+
+  pthread_mutex_unlock(&link_adaptation->mutex);
+}
+
+void ert_comm_link_adaptation_handle_report(ert_comm_link_adaptation *link_adaptation,
+    ert_comm_link_adaptation_report *report)
+{
+  pthread_mutex_lock(&link_adaptation->mutex);
+
+  ert_comm_link_adaptation_status *status = &link_adaptation->status;
+
+  status->received_report_count++;
+  status->reported_snr = report->snr;
+  status->reported_rssi = report->rssi;
+  link_adaptation->consecutive_report_timeout_count = 0;
+
+  uint8_t data_rate_index = report->data_rate_index;
+  if (data_rate_index >= link_adaptation->config.data_rate_count) {
+    ert_log_warn("Link adaptation: reported data rate index %d out of range, using %d",
+        data_rate_index, link_adaptation->config.data_rate_count - 1);
+    data_rate_index = (uint8_t) (link_adaptation->config.data_rate_count - 1);
+  }
+
+  ert_comm_link_adaptation_set_data_rate(link_adaptation, data_rate_index);
+
+  pthread_mutex_unlock(&link_adaptation->mutex);
+}
+
+void ert_comm_link_adaptation_handle_report_timeout(ert_comm_link_adaptation *link_adaptation)
+{
+  pthread_mutex_lock(&link_adaptation->mutex);
+
+  link_adaptation->status.report_timeout_count++;
+  link_adaptation->consecutive_report_timeout_count++;
+
+  if (link_adaptation->status.data_rate_index > 0 && link_adaptation->consecutive_report_timeout_count
+      >= link_adaptation->config.fallback_report_timeout_count) {
+    ert_log_warn("Link adaptation: no link reports received for %d acknowledgement requests, "
+        "falling back to the most robust data rate", link_adaptation->consecutive_report_timeout_count);
+    link_adaptation->status.fallback_count++;
+    ert_comm_link_adaptation_set_data_rate(link_adaptation, 0);
+  }
+
+  pthread_mutex_unlock(&link_adaptation->mutex);
+}
+
+void ert_comm_link_adaptation_check_receive_timeout(ert_comm_link_adaptation *link_adaptation,
+    struct timespec *timestamp)
+{
+  pthread_mutex_lock(&link_adaptation->mutex);
+
+  ert_comm_link_adaptation_status *status = &link_adaptation->status;
+
+  if (status->data_rate_index > 0 && link_adaptation->config.fallback_receive_timeout_millis > 0
+      && ert_timespec_is_nonzero(&status->last_received_packet_timestamp)
+      && ert_timespec_diff_milliseconds(&status->last_received_packet_timestamp, timestamp)
+         >= (int32_t) link_adaptation->config.fallback_receive_timeout_millis) {
+    ert_log_warn("Link adaptation: no packets received for %d ms, falling back to the most robust data rate",
+        link_adaptation->config.fallback_receive_timeout_millis);
+    status->fallback_count++;
+    ert_comm_link_adaptation_set_data_rate(link_adaptation, 0);
+  }
+
+  pthread_mutex_unlock(&link_adaptation->mutex);
+}
+
+uint8_t ert_comm_link_adaptation_get_data_rate_index(ert_comm_link_adaptation *link_adaptation)
+{
+  pthread_mutex_lock(&link_adaptation->mutex);
+  uint8_t data_rate_index = link_adaptation->status.data_rate_index;
+  pthread_mutex_unlock(&link_adaptation->mutex);
+
+  return data_rate_index;
+}
+
+void ert_comm_link_adaptation_get_status(ert_comm_link_adaptation *link_adaptation,
+    ert_comm_link_adaptation_status *status)
+{
+  pthread_mutex_lock(&link_adaptation->mutex);
+  memcpy(status, &link_adaptation->status, sizeof(ert_comm_link_adaptation_status));
+  pthread_mutex_unlock(&link_adaptation->mutex);
+}
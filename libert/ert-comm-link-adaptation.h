@@ -0,0 +1,143 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ERT_COMM_LINK_ADAPTATION_H
+#define __ERT_COMM_LINK_ADAPTATION_H
+
+#include "ert-common.h"
+
+#include <pthread.h>
+#include <time.h>
+
+#define ERT_COMM_LINK_ADAPTATION_DATA_RATE_COUNT_MAX 16
+
+#define ERT_COMM_LINK_ADAPTATION_SNR_MARGIN_DEFAULT 3.0f
+#define ERT_COMM_LINK_ADAPTATION_SNR_HYSTERESIS_DEFAULT 2.0f
+#define ERT_COMM_LINK_ADAPTATION_SNR_SMOOTHING_FACTOR_DEFAULT 0.25f
+#define ERT_COMM_LINK_ADAPTATION_INCREASE_MIN_PACKET_COUNT_DEFAULT 4
+#define ERT_COMM_LINK_ADAPTATION_FALLBACK_REPORT_TIMEOUT_COUNT_DEFAULT 3
+#define ERT_COMM_LINK_ADAPTATION_FALLBACK_RECEIVE_TIMEOUT_MILLIS_DEFAULT 60000
+
+/**
+ * LoRa modulation of a data rate and the lowest SNR the modem demodulates it at.
+ * Coding rate 1-4 means error coding rate 4/5-4/8.
+ */
+typedef struct _ert_comm_link_adaptation_data_rate {
+  uint8_t spreading_factor;
+  uint32_t bandwidth_hz;
+  uint8_t coding_rate;
+  float required_snr;
+} ert_comm_link_adaptation_data_rate;
+
+/**
+ * Data rates are ordered from the most robust one at index 0 to the fastest one. Both ends of the link must use
+ * the same data rate table, as the data rate is agreed by its index.
+ */
+typedef struct _ert_comm_link_adaptation_config {
+  // Checked by the application before creating link adaptation for its comm protocol
+  bool enabled;
+
+  uint8_t data_rate_count;
+  ert_comm_link_adaptation_data_rate data_rates[ERT_COMM_LINK_ADAPTATION_DATA_RATE_COUNT_MAX];
+  uint8_t initial_data_rate_index;
+
+  // Smoothed SNR must exceed the required SNR of a data rate by the margin, and by the hysteresis in addition
+  // for switching to a faster data rate
+  float snr_margin;
+  float snr_hysteresis;
+  // Weight of the latest packet in the exponentially weighted moving average of SNR and RSSI
+  float snr_smoothing_factor;
+  // Number of packets received at the current data rate before switching to a faster one
+  uint32_t increase_min_packet_count;
+
+  // The transmitter falls back to the most robust data rate when this many acknowledgement requests
+  // in a row have timed out
+  uint32_t fallback_report_timeout_count;
+  // The receiver falls back to the most robust data rate when no packets have been received for this long
+  uint32_t fallback_receive_timeout_millis;
+} ert_comm_link_adaptation_config;
+
+/**
+ * Link report sent by the receiver of a stream in acknowledgements: the data rate both ends switch to
+ * and the measured link quality of the packets received from the transmitter.
+ */
+typedef struct _ert_comm_link_adaptation_report {
+  uint8_t data_rate_index;
+  float snr;
+  float rssi;
+} ert_comm_link_adaptation_report;
+
+typedef struct _ert_comm_link_adaptation_status {
+  uint8_t data_rate_index;
+
+  // Link quality of packets received from the other end
+  float smoothed_snr;
+  float smoothed_rssi;
+  uint64_t received_packet_count;
+  struct timespec last_received_packet_timestamp;
+
+  // Link quality the other end has reported for packets received from this end
+  float reported_snr;
+  float reported_rssi;
+
+  uint64_t sent_report_count;
+  uint64_t received_report_count;
+  uint64_t report_timeout_count;
+
+  uint64_t data_rate_increase_count;
+  uint64_t data_rate_decrease_count;
+  uint64_t fallback_count;
+} ert_comm_link_adaptation_status;
+
+/**
+ * Called with the link adaptation mutex locked when the data rate changes, so the callback must not block.
+ * The callback is expected to reconfigure the comm device, for example with ert_comm_transceiver_configure().
+ */
+typedef void (*ert_comm_link_adaptation_data_rate_callback)(uint8_t data_rate_index,
+    ert_comm_link_adaptation_data_rate *data_rate, void *callback_context);
+
+typedef struct _ert_comm_link_adaptation {
+  ert_comm_link_adaptation_config config;
+
+  ert_comm_link_adaptation_data_rate_callback data_rate_callback;
+  void *data_rate_callback_context;
+
+  pthread_mutex_t mutex;
+
+  // Data rate proposed in the latest report, which the receiver switches to once the report has been sent
+  uint8_t proposed_data_rate_index;
+  uint32_t data_rate_packet_count;
+  uint32_t consecutive_report_timeout_count;
+
+  ert_comm_link_adaptation_status status;
+} ert_comm_link_adaptation;
+
+void ert_comm_link_adaptation_create_default_config(ert_comm_link_adaptation_config *config);
+int ert_comm_link_adaptation_create(ert_comm_link_adaptation_config *config,
+    ert_comm_link_adaptation_data_rate_callback data_rate_callback, void *data_rate_callback_context,
+    ert_comm_link_adaptation **link_adaptation_rcv);
+void ert_comm_link_adaptation_destroy(ert_comm_link_adaptation *link_adaptation);
+
+void ert_comm_link_adaptation_update_received_packet(ert_comm_link_adaptation *link_adaptation,
+    float rssi, float snr, struct timespec *timestamp);
+int ert_comm_link_adaptation_create_report(ert_comm_link_adaptation *link_adaptation,
+    ert_comm_link_adaptation_report *report);
+void ert_comm_link_adaptation_report_sent(ert_comm_link_adaptation *link_adaptation);
+void ert_comm_link_adaptation_handle_report(ert_comm_link_adaptation *link_adaptation,
+    ert_comm_link_adaptation_report *report);
+void ert_comm_link_adaptation_handle_report_timeout(ert_comm_link_adaptation *link_adaptation);
+void ert_comm_link_adaptation_check_receive_timeout(ert_comm_link_adaptation *link_adaptation,
+    struct timespec *timestamp);
+
+uint8_t ert_comm_link_adaptation_get_data_rate_index(ert_comm_link_adaptation *link_adaptation);
+void ert_comm_link_adaptation_get_status(ert_comm_link_adaptation *link_adaptation,
+    ert_comm_link_adaptation_status *status);
+
+#endif
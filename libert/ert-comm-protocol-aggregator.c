@@ -0,0 +1,312 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ert-comm-protocol-aggregator.h"
+#include "ert-comm-protocol-helpers.h"
+#include "ert-time.h"
+#include "ert-log.h"
+
+#define ERT_COMM_PROTOCOL_AGGREGATOR_LENGTH_PREFIX_MAX 3
+
+static uint8_t ert_comm_protocol_aggregator_encode_length(uint32_t length, uint8_t *prefix)
+{
+  uint8_t prefix_length = 0;
+
+  do {
+    uint8_t value = (uint8_t) (length & 0x7F);
+    length >>= 7;
+    prefix[prefix_length++] = (length > 0) ? (value | 0x80) : value;
+  } while (length > 0);
+
+  return prefix_length;
+}
+
+static void *ert_comm_protocol_aggregator_run(void *context)
+{
+  ert_comm_protocol_aggregator *aggregator = (ert_comm_protocol_aggregator *) context;
+  void *message_contexts[ERT_COMM_PROTOCOL_AGGREGATOR_MESSAGE_COUNT_MAX];
+  int result;
+
+  ert_log_info("Comm protocol aggregator thread running for port %d", aggregator->config.port);
+
+  pthread_mutex_lock(&aggregator->mutex);
+
+  while (true) {
+    if (aggregator->message_count == 0) {
+      if (!aggregator->running) {
+        break;
+      }
+      pthread_cond_wait(&aggregator->change_cond, &aggregator->mutex);
+      continue;
+    }
+
+    bool transmit_now = aggregator->flush_requested || !aggregator->running
+        || aggregator->message_count >= ERT_COMM_PROTOCOL_AGGREGATOR_MESSAGE_COUNT_MAX;
+    if (!transmit_now) {
+      result = pthread_cond_timedwait(&aggregator->change_cond, &aggregator->mutex, &aggregator->deadline);
+      if (result == 0) {
+        continue;
+      } else if (result != ETIMEDOUT) {
+        ert_log_error("pthread_cond_timedwait failed with result %d", result);
+      }
+    }
+
+    // Swap the buffers so that new messages can be added while the batch is transmitted
+    uint8_t *data = aggregator->buffer;
+    uint32_t data_length = aggregator->length;
+    uint32_t message_count = aggregator->message_count;
+    memcpy(message_contexts, aggregator->message_contexts, message_count * sizeof(void *));
+
+    aggregator->buffer = aggregator->transmit_buffer;
+    aggregator->transmit_buffer = data;
+    aggregator->length = 0;
+    aggregator->message_count = 0;
+    aggregator->flush_requested = false;
+
+    pthread_cond_broadcast(&aggregator->change_cond);
+    pthread_mutex_unlock(&aggregator->mutex);
+
+    ert_log_info("Transmitting %d aggregated messages with size of %d bytes to port %d ...",
+        message_count, data_length, aggregator->config.port);
+
+    result = ert_comm_protocol_transmit_buffer(aggregator->comm_protocol, aggregator->config.port,
+        aggregator->config.enable_acks, data_length, data);
+    if (result < 0) {
+      ert_log_error("ert_comm_protocol_transmit_buffer failed with result: %d", result);
+    }
+
+    if (aggregator->transmitted_callback != NULL) {
+      for (uint32_t i = 0; i < message_count; i++) {
+        aggregator->transmitted_callback((result < 0) ? result : 0, message_contexts[i],
+            aggregator->callback_context);
+      }
+    }
+
+    pthread_mutex_lock(&aggregator->mutex);
+  }
+
+  pthread_mutex_unlock(&aggregator->mutex);
+
+  ert_log_info("Comm protocol aggregator thread stopping for port %d", aggregator->config.port);
+
+  return NULL;
+}
+
+int ert_comm_protocol_aggregator_create(ert_comm_protocol *comm_protocol, ert_comm_protocol_aggregator_config *config,
+    ert_comm_protocol_aggregator_transmitted_callback transmitted_callback, void *callback_context,
+    ert_comm_protocol_aggregator **aggregator_rcv)
+{
+  int result;
+
+  if (config->max_length <= ERT_COMM_PROTOCOL_AGGREGATOR_LENGTH_PREFIX_MAX) {
+    ert_log_error("Invalid aggregator maximum length: %d", config->max_length);
+    return -EINVAL;
+  }
+
+  ert_comm_protocol_aggregator *aggregator = calloc(1, sizeof(ert_comm_protocol_aggregator));
+  if (aggregator == NULL) {
+    ert_log_fatal("Error allocating memory for comm protocol aggregator struct: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  aggregator->comm_protocol = comm_protocol;
+  memcpy(&aggregator->config, config, sizeof(ert_comm_protocol_aggregator_config));
+  aggregator->transmitted_callback = transmitted_callback;
+  aggregator->callback_context = callback_context;
+
+  aggregator->buffer = malloc(config->max_length);
+  aggregator->transmit_buffer = malloc(config->max_length);
+  if (aggregator->buffer == NULL || aggregator->transmit_buffer == NULL) {
+    ert_log_fatal("Error allocating memory for comm protocol aggregator buffers: %s", strerror(errno));
+    result = -ENOMEM;
+    goto error_buffers;
+  }
+
+  result = pthread_mutex_init(&aggregator->mutex, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing aggregator mutex, result %d", result);
+    result = -EIO;
+    goto error_buffers;
+  }
+
+  result = pthread_cond_init(&aggregator->change_cond, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing aggregator change condition, result %d", result);
+    result = -EIO;
+    goto error_mutex;
+  }
+
+  aggregator->running = true;
+
+  result = pthread_create(&aggregator->thread, NULL, ert_comm_protocol_aggregator_run, aggregator);
+  if (result != 0) {
+    ert_log_error("Error starting aggregator thread, result %d", result);
+    result = -EIO;
+    goto error_cond;
+  }
+
+  *aggregator_rcv = aggregator;
+
+  return 0;
+
+  error_cond:
+  pthread_cond_destroy(&aggregator->change_cond);
+
+  error_mutex:
+  pthread_mutex_destroy(&aggregator->mutex);
+
+  error_buffers:
+  if (aggregator->buffer != NULL) {
+    free(aggregator->buffer);
+  }
+  if (aggregator->transmit_buffer != NULL) {
+    free(aggregator->transmit_buffer);
+  }
+  free(aggregator);
+
+  return result;
+}
+
+/**
+ * Adds a message to the current batch, waiting for the previous batch to be taken for transmission
+ * if the message does not fit in the current one. The message context is passed to the transmitted callback.
+ * Returns -EMSGSIZE without logging if the message alone does not fit in the maximum length, so that
+ * the caller may transmit it separately.
+ */
+int ert_comm_protocol_aggregator_add(ert_comm_protocol_aggregator *aggregator, uint32_t length, uint8_t *data,
+    void *message_context)
+{
+  uint8_t prefix[ERT_COMM_PROTOCOL_AGGREGATOR_LENGTH_PREFIX_MAX];
+
+  if (length > ERT_COMM_PROTOCOL_AGGREGATOR_MESSAGE_LENGTH_MAX) {
+    return -EMSGSIZE;
+  }
+
+  uint8_t prefix_length = ert_comm_protocol_aggregator_encode_length(length, prefix);
+  uint32_t framed_length = prefix_length + length;
+
+  if (framed_length > aggregator->config.max_length) {
+    return -EMSGSIZE;
+  }
+
+  pthread_mutex_lock(&aggregator->mutex);
+
+  while (aggregator->running && (aggregator->length + framed_length > aggregator->config.max_length
+      || aggregator->message_count >= ERT_COMM_PROTOCOL_AGGREGATOR_MESSAGE_COUNT_MAX)) {
+    aggregator->flush_requested = true;
+    pthread_cond_broadcast(&aggregator->change_cond);
+    pthread_cond_wait(&aggregator->change_cond, &aggregator->mutex);
+  }
+
+  if (!aggregator->running) {
+    pthread_mutex_unlock(&aggregator->mutex);
+    return -EPIPE;
+  }
+
+  if (aggregator->message_count == 0) {
+    ert_get_current_timestamp_offset(&aggregator->deadline, aggregator->config.max_delay_millis);
+  }
+
+  memcpy(aggregator->buffer + aggregator->length, prefix, prefix_length);
+  memcpy(aggregator->buffer + aggregator->length + prefix_length, data, length);
+  aggregator->length += framed_length;
+  aggregator->message_contexts[aggregator->message_count] = message_context;
+  aggregator->message_count++;
+
+  pthread_cond_broadcast(&aggregator->change_cond);
+  pthread_mutex_unlock(&aggregator->mutex);
+
+  return 0;
+}
+
+/**
+ * Requests transmission of the current batch without waiting for the delay to pass.
+ */
+int ert_comm_protocol_aggregator_flush(ert_comm_protocol_aggregator *aggregator)
+{
+  pthread_mutex_lock(&aggregator->mutex);
+  if (aggregator->message_count > 0) {
+    aggregator->flush_requested = true;
+    pthread_cond_broadcast(&aggregator->change_cond);
+  }
+  pthread_mutex_unlock(&aggregator->mutex);
+
+  return 0;
+}
+
+/**
+ * Transmits the pending batch, if any, and stops the aggregator thread.
+ */
+int ert_comm_protocol_aggregator_destroy(ert_comm_protocol_aggregator *aggregator)
+{
+  pthread_mutex_lock(&aggregator->mutex);
+  aggregator->running = false;
+  pthread_cond_broadcast(&aggregator->change_cond);
+  pthread_mutex_unlock(&aggregator->mutex);
+
+  pthread_join(aggregator->thread, NULL);
+
+  pthread_cond_destroy(&aggregator->change_cond);
+  pthread_mutex_destroy(&aggregator->mutex);
+
+  free(aggregator->buffer);
+  free(aggregator->transmit_buffer);
+  free(aggregator);
+
+  return 0;
+}
+
+/**
+ * Splits received aggregated data into messages and calls the callback for each of them.
+ * Returns the number of messages found or -EINVAL if the data is malformed. Messages before
+ * a malformed length prefix have been passed to the callback already.
+ */
+int ert_comm_protocol_aggregator_split(uint32_t length, uint8_t *data,
+    ert_comm_protocol_aggregator_message_callback message_callback, void *callback_context)
+{
+  uint32_t offset = 0;
+  int message_count = 0;
+
+  while (offset < length) {
+    uint32_t message_length = 0;
+    uint8_t shift = 0;
+    uint8_t value;
+
+    do {
+      if (offset >= length || shift >= ERT_COMM_PROTOCOL_AGGREGATOR_LENGTH_PREFIX_MAX * 7) {
+        ert_log_error("Invalid length prefix in aggregated data at offset %d", offset);
+        return -EINVAL;
+      }
+      value = data[offset++];
+      message_length |= ((uint32_t) (value & 0x7F)) << shift;
+      shift += 7;
+    } while (value & 0x80);
+
+    if (message_length > length - offset) {
+      ert_log_error("Aggregated message at offset %d with size of %d bytes exceeds data length %d",
+          offset, message_length, length);
+      return -EINVAL;
+    }
+
+    int result = message_callback(message_length, data + offset, callback_context);
+    if (result < 0) {
+      ert_log_warn("Aggregated message callback failed with result %d", result);
+    }
+
+    offset += message_length;
+    message_count++;
+  }
+
+  return message_count;
+}
@@ -0,0 +1,89 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ERT_COMM_PROTOCOL_AGGREGATOR_H
+#define __ERT_COMM_PROTOCOL_AGGREGATOR_H
+
+#include <pthread.h>
+
+#include "ert-common.h"
+#include "ert-comm-protocol.h"
+
+#define ERT_COMM_PROTOCOL_AGGREGATOR_MESSAGE_COUNT_MAX 32
+#define ERT_COMM_PROTOCOL_AGGREGATOR_MESSAGE_LENGTH_MAX 0x1FFFFF
+
+#define ERT_COMM_PROTOCOL_AGGREGATOR_MAX_LENGTH_DEFAULT 2048
+#define ERT_COMM_PROTOCOL_AGGREGATOR_MAX_DELAY_MILLIS_DEFAULT 5000
+
+/**
+ * Called once for each aggregated message after the stream containing it has been transmitted,
+ * with the result of the transmission and the context pointer given when the message was added.
+ */
+typedef void (*ert_comm_protocol_aggregator_transmitted_callback)(int result, void *message_context,
+    void *callback_context);
+
+/**
+ * Called once for each message split from received aggregated data.
+ */
+typedef int (*ert_comm_protocol_aggregator_message_callback)(uint32_t length, uint8_t *data,
+    void *callback_context);
+
+typedef struct _ert_comm_protocol_aggregator_config {
+  uint8_t port;
+  bool enable_acks;
+
+  // Maximum length of aggregated data transmitted as a single stream, including message length prefixes
+  uint32_t max_length;
+  // Maximum time the first message of a batch is held before the batch is transmitted
+  uint32_t max_delay_millis;
+} ert_comm_protocol_aggregator_config;
+
+/**
+ * Coalesces small application messages into a single stream. Each message is prefixed with its length
+ * encoded as a variable-length integer of 7 bits per byte, least significant group first, with the high bit
+ * set on all but the last byte. A batch is transmitted when the next message does not fit in it,
+ * when it holds ERT_COMM_PROTOCOL_AGGREGATOR_MESSAGE_COUNT_MAX messages or when its first message
+ * has waited for max_delay_millis.
+ */
+typedef struct _ert_comm_protocol_aggregator {
+  ert_comm_protocol *comm_protocol;
+  ert_comm_protocol_aggregator_config config;
+
+  ert_comm_protocol_aggregator_transmitted_callback transmitted_callback;
+  void *callback_context;
+
+  uint8_t *buffer;
+  uint8_t *transmit_buffer;
+  uint32_t length;
+
+  uint32_t message_count;
+  void *message_contexts[ERT_COMM_PROTOCOL_AGGREGATOR_MESSAGE_COUNT_MAX];
+  struct timespec deadline;
+  bool flush_requested;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t change_cond;
+  pthread_t thread;
+
+  volatile bool running;
+} ert_comm_protocol_aggregator;
+
+int ert_comm_protocol_aggregator_create(ert_comm_protocol *comm_protocol, ert_comm_protocol_aggregator_config *config,
+    ert_comm_protocol_aggregator_transmitted_callback transmitted_callback, void *callback_context,
+    ert_comm_protocol_aggregator **aggregator_rcv);
+int ert_comm_protocol_aggregator_add(ert_comm_protocol_aggregator *aggregator, uint32_t length, uint8_t *data,
+    void *message_context);
+int ert_comm_protocol_aggregator_flush(ert_comm_protocol_aggregator *aggregator);
+int ert_comm_protocol_aggregator_destroy(ert_comm_protocol_aggregator *aggregator);
+
+int ert_comm_protocol_aggregator_split(uint32_t length, uint8_t *data,
+    ert_comm_protocol_aggregator_message_callback message_callback, void *callback_context);
+
+#endif
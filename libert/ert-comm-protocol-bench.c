@@ -0,0 +1,788 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+ * End-to-end benchmark for the comm protocol: transfers buffers and files with the same helpers
+ * the node uses for telemetry and images between two linked simulated LoRa devices and reports
+ * goodput, retransmit ratio, acknowledgement overhead and delivery latency percentiles
+ * as one line of key=value pairs per workload.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#include "ert-comm-protocol.h"
+#include "ert-comm-protocol-helpers.h"
+#include "ert-comm-protocol-device-adapter.h"
+#include "ert-comm-transceiver.h"
+#include "ert-comm-device-simulator.h"
+#include "ert-pipe.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define BENCH_PORT 1
+#define BENCH_ITERATION_COUNT_DEFAULT 20
+#define BENCH_BUFFER_LENGTH_DEFAULT 1024
+#define BENCH_FILE_LENGTH_DEFAULT 8192
+#define BENCH_FILE_BUFFER_LENGTH_DEFAULT 128
+#define BENCH_TIME_SCALE_DEFAULT 0.01
+#define BENCH_TRANSFER_TIMEOUT_MILLIS 120000
+#define BENCH_UNACKNOWLEDGED_TRANSFER_TIMEOUT_MILLIS 10000
+#define BENCH_TRANSFER_TAG_LENGTH sizeof(uint32_t)
+#define BENCH_READER_STOP_TIMEOUT_MILLIS 10000
+
+typedef enum _ert_comm_protocol_bench_workload {
+  ERT_COMM_PROTOCOL_BENCH_WORKLOAD_BUFFER = 0x01,
+  ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE = 0x02,
+} ert_comm_protocol_bench_workload;
+
+typedef struct _ert_comm_protocol_bench_options {
+  uint32_t workloads;
+  uint32_t iteration_count;
+  uint32_t buffer_length;
+  uint32_t file_length;
+  uint32_t file_buffer_length;
+  char file_name[PATH_MAX];
+
+  bool acks_enabled;
+  uint32_t acknowledgement_interval_packet_count;
+  bool adaptive_acknowledgements;
+  bool fec;
+
+  ert_comm_driver_simulator_config simulator_config;
+} ert_comm_protocol_bench_options;
+
+typedef struct _ert_comm_protocol_bench_transfer_result {
+  uint32_t iteration;
+  uint32_t bytes_received;
+  bool data_valid;
+  struct timespec end_timestamp;
+} ert_comm_protocol_bench_transfer_result;
+
+typedef struct _ert_comm_protocol_bench_context {
+  ert_comm_device *device1;
+  ert_comm_device *device2;
+
+  ert_comm_transceiver *comm_transceiver1;
+  ert_comm_transceiver *comm_transceiver2;
+
+  ert_comm_protocol_device *comm_protocol_device1;
+  ert_comm_protocol_device *comm_protocol_device2;
+
+  ert_comm_protocol *comm_protocol1;
+  ert_comm_protocol *comm_protocol2;
+
+  uint32_t expected_data_length;
+  uint8_t *expected_data;
+  uint32_t tag_offset;
+
+  ert_pipe *transfer_done_queue;
+  volatile bool running;
+
+  pthread_mutex_t reader_mutex;
+  uint32_t active_reader_count;
+} ert_comm_protocol_bench_context;
+
+typedef struct _ert_comm_protocol_bench_reader {
+  ert_comm_protocol_bench_context *context;
+  ert_comm_protocol *comm_protocol;
+  ert_comm_protocol_stream *stream;
+} ert_comm_protocol_bench_reader;
+
+static void *ert_comm_protocol_bench_stream_reader(void *reader_context)
+{
+  ert_comm_protocol_bench_reader *reader = (ert_comm_protocol_bench_reader *) reader_context;
+  ert_comm_protocol_bench_context *context = reader->context;
+  ert_comm_protocol_bench_transfer_result transfer_result = {0};
+
+  // One extra byte of space reveals any data received in excess of the expected length
+  uint32_t buffer_size = context->expected_data_length + 1;
+  uint8_t *buffer = malloc(buffer_size);
+  if (buffer == NULL) {
+    ert_log_fatal("Error allocating memory for receive buffer: %s", strerror(errno));
+    abort();
+  }
+
+  int result = ert_comm_protocol_receive_buffer(reader->comm_protocol, reader->stream,
+      buffer_size, buffer, &transfer_result.bytes_received, &context->running);
+  clock_gettime(CLOCK_MONOTONIC, &transfer_result.end_timestamp);
+
+  // Streams lose packets without acknowledgements, so the tag identifies the transfer a result belongs to
+  if (transfer_result.bytes_received >= context->tag_offset + BENCH_TRANSFER_TAG_LENGTH) {
+    memcpy(&transfer_result.iteration, buffer + context->tag_offset, BENCH_TRANSFER_TAG_LENGTH);
+  } else {
+    transfer_result.iteration = UINT32_MAX;
+  }
+
+  transfer_result.data_valid = (result == 0)
+      && (transfer_result.bytes_received == context->expected_data_length)
+      && (memcmp(buffer, context->expected_data, context->expected_data_length) == 0);
+
+  ert_pipe_push(context->transfer_done_queue, &transfer_result, 1);
+
+  free(buffer);
+  free(reader);
+
+  pthread_mutex_lock(&context->reader_mutex);
+  context->active_reader_count--;
+  pthread_mutex_unlock(&context->reader_mutex);
+
+  return NULL;
+}
+
+static void ert_comm_protocol_bench_stream_listener_callback(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, void *callback_context)
+{
+  ert_comm_protocol_bench_context *context = (ert_comm_protocol_bench_context *) callback_context;
+
+  ert_comm_protocol_bench_reader *reader = malloc(sizeof(ert_comm_protocol_bench_reader));
+  if (reader == NULL) {
+    ert_log_fatal("Error allocating memory for stream reader: %s", strerror(errno));
+    abort();
+  }
+
+  reader->context = context;
+  reader->comm_protocol = comm_protocol;
+  reader->stream = stream;
+
+  pthread_mutex_lock(&context->reader_mutex);
+  context->active_reader_count++;
+  pthread_mutex_unlock(&context->reader_mutex);
+
+  pthread_t thread;
+  int result = pthread_create(&thread, NULL, ert_comm_protocol_bench_stream_reader, reader);
+  if (result != 0) {
+    ert_log_error("Error starting stream reader thread: %s", strerror(errno));
+    abort();
+  }
+  pthread_detach(thread);
+}
+
+static int ert_comm_protocol_bench_wait_for_streams_closed(ert_comm_protocol *comm_protocol,
+    uint32_t timeout_millis)
+{
+  for (uint32_t waited_millis = 0; waited_millis < timeout_millis; waited_millis += 1) {
+    size_t stream_info_count;
+    ert_comm_protocol_stream_info *stream_info;
+
+    int result = ert_comm_protocol_get_active_streams(comm_protocol, &stream_info_count, &stream_info);
+    if (result < 0) {
+      return result;
+    }
+    free(stream_info);
+
+    if (stream_info_count == 0) {
+      return 0;
+    }
+
+    usleep(1000);
+  }
+
+  return -ETIMEDOUT;
+}
+
+static int ert_comm_protocol_bench_start_transceiver(ert_comm_device *device,
+    ert_comm_transceiver **comm_transceiver_rcv)
+{
+  ert_comm_transceiver_config comm_transceiver_config = {0};
+  comm_transceiver_config.transmit_buffer_length_packets = 32;
+  comm_transceiver_config.receive_buffer_length_packets = 32;
+  comm_transceiver_config.transmit_timeout_milliseconds = 10000;
+  comm_transceiver_config.poll_interval_milliseconds = 1000;
+
+  return ert_comm_transceiver_start(device, &comm_transceiver_config, comm_transceiver_rcv);
+}
+
+static int ert_comm_protocol_bench_initialize(ert_comm_protocol_bench_options *options,
+    ert_comm_protocol_bench_context *context)
+{
+  int result;
+
+  context->running = true;
+  pthread_mutex_init(&context->reader_mutex, NULL);
+  context->active_reader_count = 0;
+
+  ert_comm_driver_simulator_config simulator_config1 = options->simulator_config;
+  result = ert_driver_comm_device_simulator_open(&simulator_config1, &context->device1);
+  if (result < 0) {
+    ert_log_error("Error opening simulator device 1, result %d", result);
+    return result;
+  }
+
+  // Use a different random sequence for the other direction
+  ert_comm_driver_simulator_config simulator_config2 = options->simulator_config;
+  simulator_config2.seed = options->simulator_config.seed + 1;
+  result = ert_driver_comm_device_simulator_open(&simulator_config2, &context->device2);
+  if (result < 0) {
+    ert_log_error("Error opening simulator device 2, result %d", result);
+    return result;
+  }
+
+  ert_driver_comm_device_simulator_connect(context->device1, context->device2);
+
+  result = ert_comm_protocol_bench_start_transceiver(context->device1, &context->comm_transceiver1);
+  if (result < 0) {
+    ert_log_error("Error starting comm transceiver 1, result %d", result);
+    return result;
+  }
+
+  result = ert_comm_protocol_bench_start_transceiver(context->device2, &context->comm_transceiver2);
+  if (result < 0) {
+    ert_log_error("Error starting comm transceiver 2, result %d", result);
+    return result;
+  }
+
+  result = ert_pipe_create(sizeof(ert_comm_protocol_bench_transfer_result), 16, &context->transfer_done_queue);
+  if (result < 0) {
+    ert_log_error("Error creating pipe for transfer done queue");
+    return -ENOMEM;
+  }
+
+  ert_comm_protocol_config config;
+  ert_comm_protocol_create_default_config(&config);
+  config.stream_acknowledgement_interval_packet_count = options->acknowledgement_interval_packet_count;
+  config.stream_acknowledgement_adaptive = options->adaptive_acknowledgements;
+  if (config.stream_acknowledgement_min_interval_packet_count > options->acknowledgement_interval_packet_count) {
+    config.stream_acknowledgement_min_interval_packet_count = options->acknowledgement_interval_packet_count;
+  }
+  if (config.stream_acknowledgement_max_interval_packet_count < options->acknowledgement_interval_packet_count) {
+    config.stream_acknowledgement_max_interval_packet_count = options->acknowledgement_interval_packet_count;
+  }
+  config.receive_buffer_length_packets = options->acknowledgement_interval_packet_count * 2;
+  config.stream_fec = options->fec;
+
+  result = ert_comm_protocol_device_adapter_create(context->comm_transceiver1, &context->comm_protocol_device1);
+  if (result < 0) {
+    return result;
+  }
+
+  result = ert_comm_protocol_create(&config, ert_comm_protocol_bench_stream_listener_callback, context,
+      context->comm_protocol_device1, &context->comm_protocol1);
+  if (result < 0) {
+    return result;
+  }
+
+  result = ert_comm_protocol_device_adapter_create(context->comm_transceiver2, &context->comm_protocol_device2);
+  if (result < 0) {
+    return result;
+  }
+
+  // Only passive receivers accept streams without acknowledgements
+  config.passive_mode = !options->acks_enabled;
+
+  result = ert_comm_protocol_create(&config, ert_comm_protocol_bench_stream_listener_callback, context,
+      context->comm_protocol_device2, &context->comm_protocol2);
+  if (result < 0) {
+    return result;
+  }
+
+  return 0;
+}
+
+static void ert_comm_protocol_bench_uninitialize(ert_comm_protocol_bench_context *context)
+{
+  context->running = false;
+
+  // Readers of incomplete streams exit after their next read timeout
+  for (uint32_t waited_millis = 0; waited_millis < BENCH_READER_STOP_TIMEOUT_MILLIS; waited_millis += 10) {
+    pthread_mutex_lock(&context->reader_mutex);
+    uint32_t active_reader_count = context->active_reader_count;
+    pthread_mutex_unlock(&context->reader_mutex);
+
+    if (active_reader_count == 0) {
+      break;
+    }
+
+    usleep(10000);
+  }
+
+  if (context->comm_protocol2 != NULL) {
+    ert_comm_protocol_destroy(context->comm_protocol2);
+  }
+  if (context->comm_protocol1 != NULL) {
+    ert_comm_protocol_destroy(context->comm_protocol1);
+  }
+
+  if (context->comm_protocol_device2 != NULL) {
+    ert_comm_protocol_device_adapter_destroy(context->comm_protocol_device2);
+  }
+  if (context->comm_protocol_device1 != NULL) {
+    ert_comm_protocol_device_adapter_destroy(context->comm_protocol_device1);
+  }
+
+  if (context->transfer_done_queue != NULL) {
+    ert_pipe_close(context->transfer_done_queue);
+    ert_pipe_destroy(context->transfer_done_queue);
+  }
+
+  if (context->comm_transceiver2 != NULL) {
+    ert_comm_transceiver_stop(context->comm_transceiver2);
+  }
+  if (context->comm_transceiver1 != NULL) {
+    ert_comm_transceiver_stop(context->comm_transceiver1);
+  }
+
+  if (context->device2 != NULL) {
+    ert_driver_comm_device_simulator_close(context->device2);
+  }
+  if (context->device1 != NULL) {
+    ert_driver_comm_device_simulator_close(context->device1);
+  }
+
+  pthread_mutex_destroy(&context->reader_mutex);
+}
+
+static double ert_comm_protocol_bench_timespec_diff_millis(struct timespec *start, struct timespec *end)
+{
+  return (double) (end->tv_sec - start->tv_sec) * 1000.0
+      + (double) (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static int ert_comm_protocol_bench_compare_double(const void *a, const void *b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+  return (da > db) - (da < db);
+}
+
+static double ert_comm_protocol_bench_percentile(double *sorted_values, uint32_t count, double percentile)
+{
+  if (count == 0) {
+    return 0;
+  }
+
+  // Nearest-rank method
+  uint32_t rank = (uint32_t) ((percentile / 100.0) * count + 0.999999);
+  if (rank < 1) {
+    rank = 1;
+  }
+  if (rank > count) {
+    rank = count;
+  }
+
+  return sorted_values[rank - 1];
+}
+
+static int ert_comm_protocol_bench_create_file(ert_comm_protocol_bench_options *options, uint8_t *data)
+{
+  uint64_t random_state = options->simulator_config.seed;
+  for (uint32_t i = 0; i < options->file_length; i++) {
+    random_state = random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    data[i] = (uint8_t) (random_state >> 56);
+  }
+
+  if (strlen(options->file_name) > 0) {
+    FILE *file = fopen(options->file_name, "rb");
+    if (file == NULL) {
+      ert_log_error("Error opening file '%s' for reading: %s", options->file_name, strerror(errno));
+      return -EIO;
+    }
+    size_t read_length = fread(data, 1, options->file_length, file);
+    fclose(file);
+
+    return (read_length == options->file_length) ? 0 : -EIO;
+  }
+
+  strcpy(options->file_name, "/tmp/ert-comm-protocol-bench-XXXXXX");
+  int fd = mkstemp(options->file_name);
+  if (fd < 0) {
+    ert_log_error("Error creating temporary file: %s", strerror(errno));
+    return -EIO;
+  }
+
+  ssize_t write_result = write(fd, data, options->file_length);
+  close(fd);
+
+  if (write_result != (ssize_t) options->file_length) {
+    ert_log_error("Error writing temporary file '%s': %s", options->file_name, strerror(errno));
+    unlink(options->file_name);
+    return -EIO;
+  }
+
+  return 1;
+}
+
+static int ert_comm_protocol_bench_run(ert_comm_protocol_bench_options *options,
+    ert_comm_protocol_bench_workload workload)
+{
+  ert_comm_protocol_bench_context context = {0};
+  int result;
+  bool remove_file = false;
+
+  uint32_t data_length = (workload == ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE)
+      ? options->file_length + options->file_buffer_length
+      : options->buffer_length;
+
+  uint8_t *data = malloc(data_length);
+  double *latencies_millis = malloc(options->iteration_count * sizeof(double));
+  if (data == NULL || latencies_millis == NULL) {
+    ert_log_fatal("Error allocating memory for benchmark data: %s", strerror(errno));
+    free(data);
+    free(latencies_millis);
+    return -ENOMEM;
+  }
+
+  uint8_t *buffer_data = data;
+  uint32_t buffer_length = options->buffer_length;
+
+  if (workload == ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE) {
+    result = ert_comm_protocol_bench_create_file(options, data);
+    if (result < 0) {
+      goto free_data;
+    }
+    remove_file = (result > 0);
+
+    buffer_data = data + options->file_length;
+    buffer_length = options->file_buffer_length;
+  }
+
+  for (uint32_t i = 0; i < buffer_length; i++) {
+    buffer_data[i] = (uint8_t) i;
+  }
+
+  context.expected_data_length = data_length;
+  context.expected_data = data;
+  context.tag_offset = (uint32_t) (buffer_data - data);
+
+  result = ert_comm_protocol_bench_initialize(options, &context);
+  if (result < 0) {
+    ert_log_error("Error initializing benchmark, result %d", result);
+    goto uninitialize;
+  }
+
+  uint32_t completed_transfer_count = 0;
+  uint32_t failed_transfer_count = 0;
+  uint64_t delivered_bytes = 0;
+
+  struct timespec start_time, end_time;
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+  for (uint32_t iteration = 0; iteration < options->iteration_count; iteration++) {
+    struct timespec transfer_start_time;
+    clock_gettime(CLOCK_MONOTONIC, &transfer_start_time);
+
+    memcpy(buffer_data, &iteration, BENCH_TRANSFER_TAG_LENGTH);
+
+    if (workload == ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE) {
+      result = ert_comm_protocol_transmit_file_and_buffer(context.comm_protocol1, BENCH_PORT,
+          options->acks_enabled, options->file_name, buffer_length, buffer_data, &context.running);
+    } else {
+      result = ert_comm_protocol_transmit_buffer(context.comm_protocol1, BENCH_PORT,
+          options->acks_enabled, buffer_length, buffer_data);
+    }
+    if (result < 0) {
+      ert_log_error("Transfer %d failed with result %d", iteration, result);
+      failed_transfer_count++;
+      continue;
+    }
+
+    ert_comm_protocol_bench_transfer_result transfer_result;
+    ssize_t pop_result;
+    do {
+      pop_result = ert_pipe_pop_timed(context.transfer_done_queue, &transfer_result, 1,
+          options->acks_enabled ? BENCH_TRANSFER_TIMEOUT_MILLIS : BENCH_UNACKNOWLEDGED_TRANSFER_TIMEOUT_MILLIS);
+      // Skip results of earlier unacknowledged transfers that were counted as failed already
+    } while (pop_result == 1 && !options->acks_enabled && transfer_result.iteration != iteration);
+
+    if (pop_result < 1) {
+      if (options->acks_enabled) {
+        ert_log_error("Timed out waiting for transfer %d to be received", iteration);
+        result = -ETIMEDOUT;
+        goto uninitialize;
+      }
+
+      // The first packet of the stream may be lost without acknowledgements
+      failed_transfer_count++;
+      continue;
+    }
+
+    // Transmit stream is closed when the end of stream has been acknowledged
+    result = ert_comm_protocol_bench_wait_for_streams_closed(context.comm_protocol1,
+        BENCH_TRANSFER_TIMEOUT_MILLIS);
+    if (result < 0) {
+      ert_log_error("Timed out waiting for transmit stream of transfer %d to be closed", iteration);
+      goto uninitialize;
+    }
+
+    if (!transfer_result.data_valid) {
+      ert_log_error("Transfer %d received %d bytes, expected %d bytes of matching data",
+          iteration, transfer_result.bytes_received, data_length);
+      failed_transfer_count++;
+      continue;
+    }
+
+    latencies_millis[completed_transfer_count] =
+        ert_comm_protocol_bench_timespec_diff_millis(&transfer_start_time, &transfer_result.end_timestamp);
+    completed_transfer_count++;
+    delivered_bytes += transfer_result.bytes_received;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+  ert_comm_protocol_status status1, status2;
+  ert_comm_protocol_get_status(context.comm_protocol1, &status1);
+  ert_comm_protocol_get_status(context.comm_protocol2, &status2);
+
+  ert_comm_driver_simulator_channel_status channel_status1, channel_status2;
+  ert_driver_comm_device_simulator_get_channel_status(context.device1, &channel_status1);
+  ert_driver_comm_device_simulator_get_channel_status(context.device2, &channel_status2);
+
+  qsort(latencies_millis, completed_transfer_count, sizeof(double), ert_comm_protocol_bench_compare_double);
+
+  double elapsed_millis = ert_comm_protocol_bench_timespec_diff_millis(&start_time, &end_time);
+  double airtime_millis = channel_status1.airtime_millis + channel_status2.airtime_millis;
+
+  // All packets transmitted by the receiving side are acknowledgements
+  printf("workload=%s iterations=%u transfer_bytes=%u completed_transfers=%u failed_transfers=%u "
+      "acks=%d fec=%d ack_interval=%u adaptive_acks=%d spreading_factor=%u time_scale=%.4f "
+      "delivered_bytes=%" PRIu64 " elapsed_ms=%.3f goodput_bps=%.1f airtime_ms=%.1f airtime_goodput_bps=%.1f "
+      "transmitted_packets=%" PRIu64 " retransmitted_packets=%" PRIu64 " retransmit_ratio=%.4f "
+      "fec_repair_packets=%" PRIu64 " fec_recovered_packets=%" PRIu64 " "
+      "ack_packets=%" PRIu64 " ack_bytes=%" PRIu64 " ack_overhead=%.4f "
+      "channel_lost_packets=%" PRIu64 " channel_corrupted_packets=%" PRIu64 " "
+      "adapted_ack_interval=%u adapted_ack_timeout_ms=%u round_trip_time_ms=%u packet_loss_ratio=%.4f "
+      "latency_p50_ms=%.3f latency_p99_ms=%.3f latency_max_ms=%.3f\n",
+      (workload == ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE) ? "file" : "buffer",
+      options->iteration_count, data_length, completed_transfer_count, failed_transfer_count,
+      options->acks_enabled, options->fec, options->acknowledgement_interval_packet_count,
+      options->adaptive_acknowledgements,
+      options->simulator_config.lora.spreading_factor, options->simulator_config.time_scale,
+      delivered_bytes, elapsed_millis,
+      (elapsed_millis > 0) ? (double) delivered_bytes * 8000.0 / elapsed_millis : 0.0,
+      airtime_millis,
+      (airtime_millis > 0) ? (double) delivered_bytes * 8000.0 / airtime_millis : 0.0,
+      status1.transmitted_packet_count, status1.retransmitted_packet_count,
+      (status1.transmitted_packet_count > 0)
+      ? (double) status1.retransmitted_packet_count / (double) status1.transmitted_packet_count : 0.0,
+      status1.transmitted_fec_repair_packet_count, status2.fec_recovered_packet_count,
+      status2.transmitted_packet_count, status2.transmitted_data_bytes,
+      (status1.transmitted_data_bytes > 0)
+      ? (double) status2.transmitted_data_bytes / (double) status1.transmitted_data_bytes : 0.0,
+      channel_status1.lost_packet_count + channel_status1.half_duplex_lost_packet_count
+      + channel_status2.lost_packet_count + channel_status2.half_duplex_lost_packet_count,
+      channel_status1.corrupted_packet_count + channel_status2.corrupted_packet_count,
+      status1.acknowledgement_interval_packet_count, status1.acknowledgement_receive_timeout_millis,
+      status1.round_trip_time_millis, status1.packet_loss_ratio,
+      ert_comm_protocol_bench_percentile(latencies_millis, completed_transfer_count, 50),
+      ert_comm_protocol_bench_percentile(latencies_millis, completed_transfer_count, 99),
+      ert_comm_protocol_bench_percentile(latencies_millis, completed_transfer_count, 100));
+  fflush(stdout);
+
+  result = (failed_transfer_count == 0) ? 0 : -EIO;
+
+  uninitialize:
+  ert_comm_protocol_bench_uninitialize(&context);
+
+  free_data:
+  if (remove_file) {
+    unlink(options->file_name);
+    options->file_name[0] = '\0';
+  }
+  free(latencies_millis);
+  free(data);
+
+  return result;
+}
+
+static struct option ert_comm_protocol_bench_long_options[] = {
+    {"workload", required_argument, NULL, 'w' },
+    {"iterations", required_argument, NULL, 'n' },
+    {"buffer-length", required_argument, NULL, 'b' },
+    {"file", required_argument, NULL, 'f' },
+    {"file-length", required_argument, NULL, 'F' },
+    {"file-buffer-length", required_argument, NULL, 'B' },
+    {"no-acks", no_argument, NULL, 'A' },
+    {"ack-interval", required_argument, NULL, 'a' },
+    {"fixed-ack-interval", no_argument, NULL, 'N' },
+    {"fec", no_argument, NULL, 'e' },
+    {"spreading-factor", required_argument, NULL, 's' },
+    {"loss", required_argument, NULL, 'l' },
+    {"good-to-bad", required_argument, NULL, 'g' },
+    {"bad-to-good", required_argument, NULL, 'G' },
+    {"bit-error-rate", required_argument, NULL, 'r' },
+    {"turnaround", required_argument, NULL, 'T' },
+    {"time-scale", required_argument, NULL, 't' },
+    {"seed", required_argument, NULL, 'x' },
+    {"help", no_argument, NULL, 'h' },
+    {0, 0, NULL, 0 }
+};
+
+static void ert_comm_protocol_bench_display_usage(struct option *options)
+{
+  fprintf(stderr, "Usage:\n");
+  for (size_t i = 0; options[i].name != NULL; i++) {
+    fprintf(stderr, "  -%c --%s %s\n", options[i].val, options[i].name,
+        (options[i].has_arg == required_argument)
+        ? "arg"
+        : ((options[i].has_arg == optional_argument) ? "[arg]" : ""));
+  }
+  fprintf(stderr, "Workloads: buffer, file, all\n");
+}
+
+static int ert_comm_protocol_bench_process_options(int argc, char *argv[], ert_comm_protocol_bench_options *options)
+{
+  int c;
+
+  opterr = 0;
+
+  while (1) {
+    int option_index = 0;
+
+    c = getopt_long(argc, argv, "w:n:b:f:F:B:Aa:Nes:l:g:G:r:T:t:x:h",
+        ert_comm_protocol_bench_long_options, &option_index);
+    if (c == -1) {
+      break;
+    }
+
+    switch (c) {
+      case 'w':
+        if (strcmp(optarg, "buffer") == 0) {
+          options->workloads = ERT_COMM_PROTOCOL_BENCH_WORKLOAD_BUFFER;
+        } else if (strcmp(optarg, "file") == 0) {
+          options->workloads = ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE;
+        } else if (strcmp(optarg, "all") == 0) {
+          options->workloads = ERT_COMM_PROTOCOL_BENCH_WORKLOAD_BUFFER | ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE;
+        } else {
+          fprintf(stderr, "Invalid workload: %s\n", optarg);
+          ert_comm_protocol_bench_display_usage(ert_comm_protocol_bench_long_options);
+          return -EINVAL;
+        }
+        break;
+      case 'n':
+        options->iteration_count = (uint32_t) strtoul(optarg, NULL, 10);
+        break;
+      case 'b':
+        options->buffer_length = (uint32_t) strtoul(optarg, NULL, 10);
+        break;
+      case 'f':
+        strncpy(options->file_name, optarg, PATH_MAX - 1);
+        break;
+      case 'F':
+        options->file_length = (uint32_t) strtoul(optarg, NULL, 10);
+        break;
+      case 'B':
+        options->file_buffer_length = (uint32_t) strtoul(optarg, NULL, 10);
+        break;
+      case 'A':
+        options->acks_enabled = false;
+        break;
+      case 'a':
+        options->acknowledgement_interval_packet_count = (uint32_t) strtoul(optarg, NULL, 10);
+        break;
+      case 'N':
+        options->adaptive_acknowledgements = false;
+        break;
+      case 'e':
+        options->fec = true;
+        break;
+      case 's':
+        options->simulator_config.lora.spreading_factor = (uint8_t) strtoul(optarg, NULL, 10);
+        break;
+      case 'l':
+        options->simulator_config.channel.good_loss_probability = strtod(optarg, NULL);
+        break;
+      case 'g':
+        options->simulator_config.channel.good_to_bad_probability = strtod(optarg, NULL);
+        break;
+      case 'G':
+        options->simulator_config.channel.bad_to_good_probability = strtod(optarg, NULL);
+        break;
+      case 'r':
+        options->simulator_config.channel.bit_error_rate = strtod(optarg, NULL);
+        break;
+      case 'T':
+        options->simulator_config.channel.turnaround_time_millis = (uint32_t) strtoul(optarg, NULL, 10);
+        break;
+      case 't':
+        options->simulator_config.time_scale = strtod(optarg, NULL);
+        break;
+      case 'x':
+        options->simulator_config.seed = strtoull(optarg, NULL, 10);
+        break;
+      case 'h':
+        ert_comm_protocol_bench_display_usage(ert_comm_protocol_bench_long_options);
+        return -EINVAL;
+      default:
+        fprintf(stderr, "Invalid command-line option: %c\n", optopt);
+        ert_comm_protocol_bench_display_usage(ert_comm_protocol_bench_long_options);
+        return -EINVAL;
+    }
+  }
+
+  if (options->iteration_count == 0 || options->acknowledgement_interval_packet_count == 0) {
+    fprintf(stderr, "Iteration count and acknowledgement interval must be greater than zero\n");
+    return -EINVAL;
+  }
+
+  if (options->buffer_length < BENCH_TRANSFER_TAG_LENGTH || options->file_buffer_length < BENCH_TRANSFER_TAG_LENGTH) {
+    fprintf(stderr, "Buffer lengths must be at least %d bytes\n", (int) BENCH_TRANSFER_TAG_LENGTH);
+    return -EINVAL;
+  }
+
+  if (strlen(options->file_name) > 0) {
+    struct stat st;
+    if (stat(options->file_name, &st) < 0) {
+      fprintf(stderr, "Error checking file '%s' status: %s\n", options->file_name, strerror(errno));
+      return -EINVAL;
+    }
+    options->file_length = (uint32_t) st.st_size;
+  }
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  ert_comm_protocol_bench_options options = {0};
+  int result = 0;
+
+  options.workloads = ERT_COMM_PROTOCOL_BENCH_WORKLOAD_BUFFER | ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE;
+  options.iteration_count = BENCH_ITERATION_COUNT_DEFAULT;
+  options.buffer_length = BENCH_BUFFER_LENGTH_DEFAULT;
+  options.file_length = BENCH_FILE_LENGTH_DEFAULT;
+  options.file_buffer_length = BENCH_FILE_BUFFER_LENGTH_DEFAULT;
+  options.acks_enabled = true;
+  options.acknowledgement_interval_packet_count = ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT;
+  options.adaptive_acknowledgements = true;
+  options.fec = false;
+
+  ert_driver_comm_device_simulator_create_default_config(&options.simulator_config);
+  options.simulator_config.time_scale = BENCH_TIME_SCALE_DEFAULT;
+
+  result = ert_comm_protocol_bench_process_options(argc, argv, &options);
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_test_init();
+
+  // Failed transfers are reported, but do not prevent running the other workloads
+  if (options.workloads & ERT_COMM_PROTOCOL_BENCH_WORKLOAD_BUFFER) {
+    int run_result = ert_comm_protocol_bench_run(&options, ERT_COMM_PROTOCOL_BENCH_WORKLOAD_BUFFER);
+    result = (run_result < 0) ? run_result : result;
+  }
+
+  if (options.workloads & ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE) {
+    int run_result = ert_comm_protocol_bench_run(&options, ERT_COMM_PROTOCOL_BENCH_WORKLOAD_FILE);
+    result = (run_result < 0) ? run_result : result;
+  }
+
+  ert_test_uninit();
+
+  return (result < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,330 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ert-comm-protocol-compression.h"
+#include "ert-log.h"
+
+#define ERT_COMM_PROTOCOL_COMPRESSION_TOKEN_MATCH 0x80
+#define ERT_COMM_PROTOCOL_COMPRESSION_HASH_NONE -1
+
+/*
+ * Dictionary preloaded to the window of both compressor and decompressor. It consists of msgpack-encoded map keys
+ * and value type markers of ERTnode telemetry and sensor labels and units. Changing it breaks compatibility
+ * with existing receivers.
+ */
+static const uint8_t ert_comm_protocol_compression_dictionary[] =
+    "TemperatureRelative humidityBarometric pressurehPaAltitudeSystem uptimeMemory usedLoad average (1 minute)"
+    "CPU temperatureAccelerometerGyroscopeMagnetometerOrientationm/s^2deg/suTdegC"
+    "\xa1m\x03\xa2sv\x0c\xa2su\x0a\xa1t\xcb\xa2tu\xca\xa2la\xca\xa3lau\xca\xa2lo\xca\xa3lou\xca"
+    "\xa2" "al\xca\xa3" "alu\xca\xa2tr\xca\xa3tru\xca\xa2sp\xca\xa3spu\xca\xa1" "c\xca\xa2" "cu\xca"
+    "\x84\xa1s\x00\xa2" "a1\xca\xa2" "a2\xca\xa1" "c\xca"
+    "\x89\xa1n\xa2st\x01\xa1s\xd1\xa2ps\xd1\xa2tp\xce\xa2rp\xce\xa2ip\xce\xa1" "f\xca\xa1" "e\xca"
+    "\x83\xa1o\xa1s\xd1\xa1r\x01"
+    "\x85\xa1i\xce\x00\x00\xa1t\xcd\x00\xa1l\xa1u\xa1x\xca\xa1y\xca\xa1z\xca"
+    "\x85\xa1i\xce\x00\x00\xa1t\xcd\x00\xa1l\xa1u\xa1v\xca"
+    "\x84\xa1i\xce\xa1" "e\x01\xa1t\xcf\x00\x00\x01\xa1n";
+
+static const uint32_t ert_comm_protocol_compression_dictionary_length =
+    sizeof(ert_comm_protocol_compression_dictionary) - 1;
+
+static inline uint32_t ert_comm_protocol_compression_hash(uint8_t *data)
+{
+  uint32_t value = (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16)
+      | ((uint32_t) data[3] << 24);
+  return (value * 2654435761U) >> 20;
+}
+
+int ert_comm_protocol_compressor_create(ert_comm_protocol_compressor **compressor_rcv)
+{
+  ert_comm_protocol_compressor *compressor = malloc(sizeof(ert_comm_protocol_compressor));
+  if (compressor == NULL) {
+    ert_log_fatal("Error allocating memory for comm protocol compressor struct: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  ert_comm_protocol_compressor_reset(compressor);
+
+  *compressor_rcv = compressor;
+
+  return 0;
+}
+
+void ert_comm_protocol_compressor_reset(ert_comm_protocol_compressor *compressor)
+{
+  for (uint32_t i = 0; i < ERT_COMM_PROTOCOL_COMPRESSION_HASH_TABLE_LENGTH; i++) {
+    compressor->hash_table[i] = ERT_COMM_PROTOCOL_COMPRESSION_HASH_NONE;
+  }
+
+  memcpy(compressor->window, ert_comm_protocol_compression_dictionary,
+      ert_comm_protocol_compression_dictionary_length);
+  compressor->window_length = ert_comm_protocol_compression_dictionary_length;
+
+  for (uint32_t position = 0; position + ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MIN <= compressor->window_length;
+      position++) {
+    compressor->hash_table[ert_comm_protocol_compression_hash(compressor->window + position)] = (int16_t) position;
+  }
+}
+
+static uint32_t ert_comm_protocol_compressor_write_literals(uint32_t length, uint8_t *data, uint8_t *output)
+{
+  uint32_t output_length = 0;
+
+  while (length > 0) {
+    uint32_t run_length = (length > ERT_COMM_PROTOCOL_COMPRESSION_LITERAL_RUN_MAX)
+        ? ERT_COMM_PROTOCOL_COMPRESSION_LITERAL_RUN_MAX : length;
+
+    output[output_length++] = (uint8_t) (run_length - 1);
+    memcpy(output + output_length, data, run_length);
+    output_length += run_length;
+
+    data += run_length;
+    length -= run_length;
+  }
+
+  return output_length;
+}
+
+static uint32_t ert_comm_protocol_compressor_compress_chunk(ert_comm_protocol_compressor *compressor,
+    uint32_t length, uint8_t *data, uint8_t *output)
+{
+  uint8_t *window = compressor->window;
+  uint32_t output_length = 0;
+
+  memcpy(window + compressor->window_length, data, length);
+
+  uint32_t end = compressor->window_length + length;
+  uint32_t position = compressor->window_length;
+  uint32_t literal_start = position;
+
+  while (position < end) {
+    uint32_t match_length = 0;
+    uint32_t distance = 0;
+
+    if (position + ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MIN <= end) {
+      uint32_t hash = ert_comm_protocol_compression_hash(window + position);
+      int32_t candidate = compressor->hash_table[hash];
+      compressor->hash_table[hash] = (int16_t) position;
+
+      if (candidate != ERT_COMM_PROTOCOL_COMPRESSION_HASH_NONE
+          && position - (uint32_t) candidate <= ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH) {
+        uint32_t max_length = end - position;
+        if (max_length > ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MAX) {
+          max_length = ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MAX;
+        }
+
+        // Matches may overlap the data being compressed, the decompressor copies them byte by byte
+        while (match_length < max_length && window[candidate + match_length] == window[position + match_length]) {
+          match_length++;
+        }
+        distance = position - (uint32_t) candidate;
+      }
+    }
+
+    if (match_length < ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MIN) {
+      position++;
+      continue;
+    }
+
+    output_length += ert_comm_protocol_compressor_write_literals(position - literal_start,
+        window + literal_start, output + output_length);
+
+    output[output_length++] = (uint8_t) (ERT_COMM_PROTOCOL_COMPRESSION_TOKEN_MATCH
+        | (match_length - ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MIN));
+    output[output_length++] = (uint8_t) ((distance - 1) & 0xFF);
+    output[output_length++] = (uint8_t) (((distance - 1) >> 8) & 0xFF);
+
+    for (uint32_t i = 1; i < match_length
+        && position + i + ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MIN <= end; i++) {
+      compressor->hash_table[ert_comm_protocol_compression_hash(window + position + i)] = (int16_t) (position + i);
+    }
+
+    position += match_length;
+    literal_start = position;
+  }
+
+  output_length += ert_comm_protocol_compressor_write_literals(end - literal_start,
+      window + literal_start, output + output_length);
+
+  // Keep only the window of data for the next chunk
+  if (end > ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH) {
+    uint32_t shift = end - ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH;
+
+    memmove(window, window + shift, ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH);
+    end = ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH;
+
+    for (uint32_t i = 0; i < ERT_COMM_PROTOCOL_COMPRESSION_HASH_TABLE_LENGTH; i++) {
+      int32_t value = compressor->hash_table[i] - (int32_t) shift;
+      compressor->hash_table[i] = (int16_t) ((value < 0) ? ERT_COMM_PROTOCOL_COMPRESSION_HASH_NONE : value);
+    }
+  }
+
+  compressor->window_length = end;
+
+  return output_length;
+}
+
+/**
+ * Compresses the data to the output buffer, which must have room for at least
+ * ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_OUTPUT_LENGTH_MAX bytes for each started chunk of input data.
+ */
+int ert_comm_protocol_compressor_compress(ert_comm_protocol_compressor *compressor,
+    uint32_t length, uint8_t *data, uint8_t *output, uint32_t *output_length)
+{
+  uint32_t total_output_length = 0;
+
+  while (length > 0) {
+    uint32_t chunk_length = (length > ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_LENGTH)
+        ? ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_LENGTH : length;
+
+    total_output_length += ert_comm_protocol_compressor_compress_chunk(compressor, chunk_length, data,
+        output + total_output_length);
+
+    data += chunk_length;
+    length -= chunk_length;
+  }
+
+  *output_length = total_output_length;
+
+  return 0;
+}
+
+void ert_comm_protocol_compressor_destroy(ert_comm_protocol_compressor *compressor)
+{
+  free(compressor);
+}
+
+int ert_comm_protocol_decompressor_create(ert_comm_protocol_decompressor **decompressor_rcv)
+{
+  ert_comm_protocol_decompressor *decompressor = malloc(sizeof(ert_comm_protocol_decompressor));
+  if (decompressor == NULL) {
+    ert_log_fatal("Error allocating memory for comm protocol decompressor struct: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  ert_comm_protocol_decompressor_reset(decompressor);
+
+  *decompressor_rcv = decompressor;
+
+  return 0;
+}
+
+void ert_comm_protocol_decompressor_reset(ert_comm_protocol_decompressor *decompressor)
+{
+  memset(decompressor->window, 0, ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH);
+  memcpy(decompressor->window, ert_comm_protocol_compression_dictionary,
+      ert_comm_protocol_compression_dictionary_length);
+  decompressor->window_position = ert_comm_protocol_compression_dictionary_length;
+
+  decompressor->state = ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_TOKEN;
+  decompressor->remaining_length = 0;
+  decompressor->distance = 0;
+
+  decompressor->input_offset = 0;
+  decompressor->input_length = 0;
+}
+
+/**
+ * Returns true if the decompressor can produce data without more input.
+ */
+bool ert_comm_protocol_decompressor_has_pending_data(ert_comm_protocol_decompressor *decompressor)
+{
+  return decompressor->input_offset < decompressor->input_length
+      || decompressor->state == ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_MATCH;
+}
+
+static inline void ert_comm_protocol_decompressor_output(ert_comm_protocol_decompressor *decompressor,
+    uint8_t value, uint8_t *data)
+{
+  decompressor->window[decompressor->window_position] = value;
+  decompressor->window_position = (decompressor->window_position + 1) % ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH;
+  *data = value;
+}
+
+/**
+ * Decompresses data from the input buffer of the decompressor until the buffer is empty or length bytes
+ * have been decompressed. The caller refills the input buffer once it is empty.
+ */
+int ert_comm_protocol_decompressor_decompress(ert_comm_protocol_decompressor *decompressor,
+    uint32_t length, uint8_t *data, uint32_t *output_length)
+{
+  uint32_t produced = 0;
+
+  while (produced < length) {
+    if (decompressor->state == ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_MATCH) {
+      uint32_t source_position = (decompressor->window_position + ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH
+          - decompressor->distance) % ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH;
+      ert_comm_protocol_decompressor_output(decompressor, decompressor->window[source_position], data + produced);
+      produced++;
+
+      decompressor->remaining_length--;
+      if (decompressor->remaining_length == 0) {
+        decompressor->state = ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_TOKEN;
+      }
+      continue;
+    }
+
+    if (decompressor->input_offset >= decompressor->input_length) {
+      break;
+    }
+
+    uint8_t value = decompressor->input[decompressor->input_offset++];
+
+    switch (decompressor->state) {
+      case ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_TOKEN:
+        if (value & ERT_COMM_PROTOCOL_COMPRESSION_TOKEN_MATCH) {
+          decompressor->remaining_length = (uint32_t) (value & ~ERT_COMM_PROTOCOL_COMPRESSION_TOKEN_MATCH)
+              + ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MIN;
+          decompressor->state = ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_DISTANCE_LOW;
+        } else {
+          decompressor->remaining_length = (uint32_t) value + 1;
+          decompressor->state = ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_LITERAL;
+        }
+        break;
+      case ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_LITERAL:
+        ert_comm_protocol_decompressor_output(decompressor, value, data + produced);
+        produced++;
+
+        decompressor->remaining_length--;
+        if (decompressor->remaining_length == 0) {
+          decompressor->state = ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_TOKEN;
+        }
+        break;
+      case ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_DISTANCE_LOW:
+        decompressor->distance = value;
+        decompressor->state = ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_DISTANCE_HIGH;
+        break;
+      case ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_DISTANCE_HIGH:
+        decompressor->distance = (decompressor->distance | ((uint32_t) value << 8)) + 1;
+        if (decompressor->distance > ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH) {
+          ert_log_error("Invalid match distance in compressed data: %d", decompressor->distance);
+          decompressor->state = ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_TOKEN;
+          *output_length = produced;
+          return -EINVAL;
+        }
+        decompressor->state = ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_MATCH;
+        break;
+      default:
+        break;
+    }
+  }
+
+  *output_length = produced;
+
+  return 0;
+}
+
+void ert_comm_protocol_decompressor_destroy(ert_comm_protocol_decompressor *decompressor)
+{
+  free(decompressor);
+}
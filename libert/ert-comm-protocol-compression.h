@@ -0,0 +1,86 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ERT_COMM_PROTOCOL_COMPRESSION_H
+#define __ERT_COMM_PROTOCOL_COMPRESSION_H
+
+#include "ert-common.h"
+
+#define ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH 4096
+#define ERT_COMM_PROTOCOL_COMPRESSION_HASH_TABLE_LENGTH 4096
+
+#define ERT_COMM_PROTOCOL_COMPRESSION_LITERAL_RUN_MAX 128
+#define ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MIN 4
+#define ERT_COMM_PROTOCOL_COMPRESSION_MATCH_LENGTH_MAX 131
+
+// Input is compressed in chunks of at most this length
+#define ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_LENGTH 1024
+// Maximum length of compressed data for a chunk: literal runs add one byte per 128 bytes of input
+#define ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_OUTPUT_LENGTH_MAX (ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_LENGTH \
+    + ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_LENGTH / ERT_COMM_PROTOCOL_COMPRESSION_LITERAL_RUN_MAX)
+
+#define ERT_COMM_PROTOCOL_DECOMPRESSOR_INPUT_LENGTH 256
+
+/**
+ * LZ77 compressor for stream payload data. Compressed data consists of tokens:
+ * - 0x00-0x7F: a run of (token + 1) literal bytes follows
+ * - 0x80-0xFF: match of ((token & 0x7F) + 4) bytes copied from the distance given by the two bytes that follow
+ *   as (distance - 1), least significant byte first
+ *
+ * The window of previous data is shared by all data written to a stream and it is preloaded with a dictionary
+ * of typical msgpack-encoded telemetry keys, so that short messages compress as well.
+ */
+typedef struct _ert_comm_protocol_compressor {
+  // Previous data in the window followed by the chunk being compressed
+  uint8_t window[ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH + ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_LENGTH];
+  uint32_t window_length;
+  // Latest position in the window for each hash of 4 bytes, -1 if none
+  int16_t hash_table[ERT_COMM_PROTOCOL_COMPRESSION_HASH_TABLE_LENGTH];
+} ert_comm_protocol_compressor;
+
+typedef enum _ert_comm_protocol_decompressor_state {
+  ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_TOKEN = 0,
+  ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_LITERAL,
+  ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_DISTANCE_LOW,
+  ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_DISTANCE_HIGH,
+  ERT_COMM_PROTOCOL_DECOMPRESSOR_STATE_MATCH,
+} ert_comm_protocol_decompressor_state;
+
+/**
+ * Decompresses data incrementally, so that tokens may be split across packets and reads.
+ */
+typedef struct _ert_comm_protocol_decompressor {
+  uint8_t window[ERT_COMM_PROTOCOL_COMPRESSION_WINDOW_LENGTH];
+  uint32_t window_position;
+
+  ert_comm_protocol_decompressor_state state;
+  uint32_t remaining_length;
+  uint32_t distance;
+
+  // Compressed data read from the stream but not decompressed yet
+  uint8_t input[ERT_COMM_PROTOCOL_DECOMPRESSOR_INPUT_LENGTH];
+  uint32_t input_offset;
+  uint32_t input_length;
+} ert_comm_protocol_decompressor;
+
+int ert_comm_protocol_compressor_create(ert_comm_protocol_compressor **compressor_rcv);
+void ert_comm_protocol_compressor_reset(ert_comm_protocol_compressor *compressor);
+int ert_comm_protocol_compressor_compress(ert_comm_protocol_compressor *compressor,
+    uint32_t length, uint8_t *data, uint8_t *output, uint32_t *output_length);
+void ert_comm_protocol_compressor_destroy(ert_comm_protocol_compressor *compressor);
+
+int ert_comm_protocol_decompressor_create(ert_comm_protocol_decompressor **decompressor_rcv);
+void ert_comm_protocol_decompressor_reset(ert_comm_protocol_decompressor *decompressor);
+bool ert_comm_protocol_decompressor_has_pending_data(ert_comm_protocol_decompressor *decompressor);
+int ert_comm_protocol_decompressor_decompress(ert_comm_protocol_decompressor *decompressor,
+    uint32_t length, uint8_t *data, uint32_t *output_length);
+void ert_comm_protocol_decompressor_destroy(ert_comm_protocol_decompressor *decompressor);
+
+#endif
@@ -43,11 +43,41 @@ ert_mapper_entry *ert_comm_protocol_create_mappings(ert_comm_protocol_config *co
           .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
           .value = &config->stream_acknowledgement_interval_packet_count,
       },
+      {
+          .name = "stream_acknowledgement_bitmap",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &config->stream_acknowledgement_bitmap,
+      },
       {
           .name = "stream_acknowledgement_receive_timeout_millis",
           .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
           .value = &config->stream_acknowledgement_receive_timeout_millis,
       },
+      {
+          .name = "stream_acknowledgement_adaptive",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &config->stream_acknowledgement_adaptive,
+      },
+      {
+          .name = "stream_acknowledgement_min_interval_packet_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->stream_acknowledgement_min_interval_packet_count,
+      },
+      {
+          .name = "stream_acknowledgement_max_interval_packet_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->stream_acknowledgement_max_interval_packet_count,
+      },
+      {
+          .name = "stream_acknowledgement_min_receive_timeout_millis",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->stream_acknowledgement_min_receive_timeout_millis,
+      },
+      {
+          .name = "stream_acknowledgement_max_receive_timeout_millis",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->stream_acknowledgement_max_receive_timeout_millis,
+      },
       {
           .name = "stream_acknowledgement_guard_interval_millis",
           .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
@@ -63,6 +93,46 @@ ert_mapper_entry *ert_comm_protocol_create_mappings(ert_comm_protocol_config *co
           .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
           .value = &config->stream_end_of_stream_acknowledgement_max_rerequest_count,
       },
+      {
+          .name = "stream_fec",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &config->stream_fec,
+      },
+      {
+          .name = "stream_fec_group_packet_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->stream_fec_group_packet_count,
+      },
+      {
+          .name = "stream_extended_sequence_numbers",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &config->stream_extended_sequence_numbers,
+      },
+      {
+          .name = "stream_window_packet_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->stream_window_packet_count,
+      },
+      {
+          .name = "stream_compression",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &config->stream_compression,
+      },
+      {
+          .name = "stream_compression_ports",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT16,
+          .value = &config->stream_compression_ports,
+      },
+      {
+          .name = "stream_realtime_priority_ports",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT16,
+          .value = &config->stream_realtime_priority_ports,
+      },
+      {
+          .name = "stream_bulk_priority_ports",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT16,
+          .value = &config->stream_bulk_priority_ports,
+      },
       {
           .name = "transmit_stream_count",
           .type = ERT_MAPPER_ENTRY_TYPE_UINT16,
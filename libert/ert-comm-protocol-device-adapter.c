@@ -61,11 +61,21 @@ static int ert_comm_protocol_device_adapter_write_packet(ert_comm_protocol_devic
   uint32_t id = adapter->transmit_packet_id++;
 
   uint32_t transmit_flags = (uint32_t) ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_BLOCK
-                            | ((flags & ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_SET_RECEIVE_ACTIVE) ? ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_SET_RECEIVE_ACTIVE : 0);
+                            | ((flags & ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_SET_RECEIVE_ACTIVE) ? ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_SET_RECEIVE_ACTIVE : 0)
+                            | ((flags & ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_PRIORITY_REALTIME) ? ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_REALTIME : 0)
+                            | ((flags & ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_PRIORITY_BULK) ? ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_BULK : 0);
 
   return ert_comm_transceiver_transmit(adapter->comm_transceiver, id, length, data, transmit_flags, bytes_written);
 }
 
+static int ert_comm_protocol_device_adapter_get_received_packet_link_quality(
+    ert_comm_protocol_device *comm_protocol_device, float *rssi, float *snr)
+{
+  ert_comm_protocol_device_adapter *adapter = (ert_comm_protocol_device_adapter *) comm_protocol_device->priv;
+
+  return ert_comm_transceiver_get_received_packet_link_quality(adapter->comm_transceiver, rssi, snr);
+}
+
 int ert_comm_protocol_device_adapter_create(ert_comm_transceiver *comm_transceiver,
     ert_comm_protocol_device **comm_protocol_device_rcv)
 {
@@ -92,6 +102,8 @@ int ert_comm_protocol_device_adapter_create(ert_comm_transceiver *comm_transceiv
   comm_protocol_device->set_receive_callback = ert_comm_protocol_device_adapter_set_receive_callback;
   comm_protocol_device->set_receive_active = ert_comm_protocol_device_adapter_set_receive_active;
   comm_protocol_device->write_packet = ert_comm_protocol_device_adapter_write_packet;
+  comm_protocol_device->get_received_packet_link_quality =
+      ert_comm_protocol_device_adapter_get_received_packet_link_quality;
   comm_protocol_device->close = ert_comm_protocol_device_adapter_destroy;
 
   ert_comm_transceiver_set_receive_callback(comm_transceiver,
@@ -13,6 +13,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <glob.h>
 #include <sys/stat.h>
 
 #include "ert-comm-protocol-helpers.h"
@@ -46,10 +47,29 @@ static int ert_comm_protocol_write_buffer(ert_comm_protocol *comm_protocol, ert_
   return 0;
 }
 
+static int ert_comm_protocol_close_transmit_stream(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream)
+{
+  uint16_t retry_count = 0;
+  int result;
+
+  retry_close:
+  result = ert_comm_protocol_transmit_stream_close(comm_protocol, stream, false);
+  if (result == -EAGAIN && retry_count < TRANSMIT_RETRY_COUNT) {
+    retry_count++;
+    ert_log_info("Retrying close: %d of %d", retry_count, TRANSMIT_RETRY_COUNT);
+    usleep(TRANSMIT_RETRY_DELAY_MILLIS * 1000);
+    goto retry_close;
+  } else if (result < 0) {
+    ert_log_error("ert_comm_protocol_transmit_stream_close failed with result: %d", result);
+    return result;
+  }
+
+  return 0;
+}
+
 int ert_comm_protocol_transmit_buffer(ert_comm_protocol *comm_protocol, uint8_t port, bool enable_acks, uint32_t data_length, uint8_t *data)
 {
   int result, close_result;
-  uint16_t retry_count;
   ert_comm_protocol_stream *stream;
 
   result = ert_comm_protocol_transmit_stream_open(comm_protocol, port, &stream,
@@ -65,17 +85,8 @@ int ert_comm_protocol_transmit_buffer(ert_comm_protocol *comm_protocol, uint8_t
     goto error_close_stream;
   }
 
-  retry_count = 0;
-
-  retry_close:
-  result = ert_comm_protocol_transmit_stream_close(comm_protocol, stream, false);
-  if (result == -EAGAIN && retry_count < TRANSMIT_RETRY_COUNT) {
-    retry_count++;
-    ert_log_info("Retrying close: %d of %d", retry_count, TRANSMIT_RETRY_COUNT);
-    usleep(TRANSMIT_RETRY_DELAY_MILLIS * 1000);
-    goto retry_close;
-  } else if (result < 0) {
-    ert_log_error("ert_comm_protocol_transmit_stream_close failed with result: %d", result);
+  result = ert_comm_protocol_close_transmit_stream(comm_protocol, stream);
+  if (result < 0) {
     goto error_close_stream;
   }
 
@@ -91,19 +102,84 @@ int ert_comm_protocol_transmit_buffer(ert_comm_protocol *comm_protocol, uint8_t
   return result;
 }
 
-int ert_comm_protocol_transmit_file_and_buffer(ert_comm_protocol *comm_protocol, uint8_t port,
-    bool enable_acks, const char *filename, uint32_t data_length, uint8_t *data, volatile bool *running)
+/**
+ * Writes the contents of the file followed by the buffer to the stream, starting from the given offset
+ * of the combined data.
+ */
+static int ert_comm_protocol_write_file_and_buffer(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    const char *filename, uint32_t filesize, uint32_t offset, uint32_t data_length, uint8_t *data,
+    volatile bool *running)
 {
   size_t buffer_length = FILE_TRANSMIT_BUFFER_LENGTH;
   uint8_t buffer[buffer_length];
-  uint16_t retry_count;
+  int result;
+
+  if (offset < filesize) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+      ert_log_error("Error opening file '%s' for reading: %s", filename, strerror(errno));
+      return -EIO;
+    }
+
+    if (offset > 0 && lseek(fd, (off_t) offset, SEEK_SET) < 0) {
+      ert_log_error("Error seeking to offset %d of file '%s': %s", offset, filename, strerror(errno));
+      close(fd);
+      return -EIO;
+    }
+
+    ssize_t read_result;
+    do {
+      ert_log_debug("Reading at %d/%d of file '%s' ...", offset, filesize, filename);
+
+      read_result = read(fd, buffer, buffer_length);
+      if (read_result < 0) {
+        ert_log_error("Error reading file '%s': %s", filename, strerror(errno));
+        close(fd);
+        return -EIO;
+      }
+
+      uint32_t read_bytes = (uint32_t) read_result;
+
+      ert_log_debug("Transmitting %d bytes at %d/%d of file '%s' ...", read_bytes, offset, filesize, filename);
+
+      uint32_t bytes_written = 0;
+      result = ert_comm_protocol_write_buffer(comm_protocol, stream, read_bytes, buffer, &bytes_written);
+      if (result < 0) {
+        close(fd);
+        return result;
+      }
+
+      offset += read_bytes;
+    } while (*running && read_result > 0);
+
+    close(fd);
+  }
+
+  if (data_length > 0 && data != NULL) {
+    uint32_t data_offset = (offset > filesize) ? offset - filesize : 0;
+    if (data_offset < data_length) {
+      uint32_t buffer_bytes_written = 0;
+      result = ert_comm_protocol_write_buffer(comm_protocol, stream,
+          data_length - data_offset, data + data_offset, &buffer_bytes_written);
+      if (result < 0) {
+        return result;
+      }
+    }
+  }
+
+  return 0;
+}
+
+int ert_comm_protocol_transmit_file_and_buffer(ert_comm_protocol *comm_protocol, uint8_t port,
+    bool enable_acks, const char *filename, uint32_t data_length, uint8_t *data, volatile bool *running)
+{
   int result, close_result;
 
   struct stat st;
   result = stat(filename, &st);
   if (result < 0) {
-    ert_log_error("Error checking file '%s' status: %s", strerror(errno));
-    return result;
+    ert_log_error("Error checking file '%s' status: %s", filename, strerror(errno));
+    return -EIO;
   }
   uint32_t filesize = (uint32_t) st.st_size;
 
@@ -117,79 +193,124 @@ int ert_comm_protocol_transmit_file_and_buffer(ert_comm_protocol *comm_protocol,
 
   ert_log_info("Transmitting file '%s' with size of %d bytes ...", filename, filesize);
 
-  int fd = open(filename, O_RDONLY);
-  if (fd < 0) {
-    ert_log_error("Error opening file '%s' for reading: %s", filename, strerror(errno));
+  result = ert_comm_protocol_write_file_and_buffer(comm_protocol, stream, filename, filesize, 0,
+      data_length, data, running);
+  if (result < 0) {
     goto error_close_stream;
   }
 
-  ssize_t read_result;
-  uint32_t offset = 0;
-  do {
-    ert_log_debug("Reading at %d/%d of file '%s' ...", offset, filesize, filename);
+  ert_log_debug("Closing stream after file '%s' ...", filename);
 
-    read_result = read(fd, buffer, buffer_length);
-    if (read_result < 0) {
-      ert_log_error("Error reading file '%s': %s", filename, strerror(errno));
-      goto error_close_file;
-    }
+  result = ert_comm_protocol_close_transmit_stream(comm_protocol, stream);
+  if (result < 0) {
+    goto error_close_stream;
+  }
 
-    uint32_t read_bytes = (uint32_t) read_result;
+  ert_log_info("Transmitted %d bytes of file '%s' and %d bytes of buffer successfully",
+      filesize, filename, data_length);
 
-    ert_log_debug("Transmitting %d bytes at %d/%d of file '%s' ...", read_bytes, offset, filesize, filename);
+  return 0;
 
-    uint32_t bytes_written = 0;
-    retry_count = 0;
+  error_close_stream:
+  close_result = ert_comm_protocol_transmit_stream_close(comm_protocol, stream, true);
+  if (close_result < 0) {
+    ert_log_error("ert_comm_protocol_transmit_stream_close failed with result: %d", close_result);
+    return close_result;
+  }
 
-    retry_write:
-    result = ert_comm_protocol_transmit_stream_write(comm_protocol, stream,
-        read_bytes, buffer, &bytes_written);
-    if (result == -EAGAIN && retry_count < TRANSMIT_RETRY_COUNT) {
-      retry_count++;
-      ert_log_info("Retrying write: %d of %d", retry_count, TRANSMIT_RETRY_COUNT);
-      usleep(TRANSMIT_RETRY_DELAY_MILLIS * 1000);
-      goto retry_write;
-    } else if (result < 0) {
-      ert_log_error("ert_comm_protocol_transmit_stream_write failed with result: %d", result);
-      goto error_close_file;
-    }
+  return result;
+}
+
+int ert_comm_protocol_transmit_file(ert_comm_protocol *comm_protocol, uint8_t port,
+    bool enable_acks, const char *filename, volatile bool *running)
+{
+  return ert_comm_protocol_transmit_file_and_buffer(comm_protocol, port, enable_acks, filename, 0, NULL, running);
+}
 
-    offset += read_bytes;
-  } while (*running && read_result > 0);
+static void ert_comm_protocol_file_transfer_put_uint32(uint8_t *data, uint32_t value)
+{
+  data[0] = (uint8_t) (value & 0xFF);
+  data[1] = (uint8_t) ((value >> 8) & 0xFF);
+  data[2] = (uint8_t) ((value >> 16) & 0xFF);
+  data[3] = (uint8_t) ((value >> 24) & 0xFF);
+}
 
-  close(fd);
+static uint32_t ert_comm_protocol_file_transfer_get_uint32(uint8_t *data)
+{
+  return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
 
-  uint32_t buffer_bytes_written = 0;
-  if (data_length > 0 && data != NULL) {
-    result = ert_comm_protocol_write_buffer(comm_protocol, stream, data_length, data, &buffer_bytes_written);
-    if (result < 0) {
-      goto error_close_stream;
-    }
+int ert_comm_protocol_get_file_transfer_total_length(const char *filename, uint32_t data_length,
+    uint32_t *total_length_rcv)
+{
+  struct stat st;
+  int result = stat(filename, &st);
+  if (result < 0) {
+    ert_log_error("Error checking file '%s' status: %s", filename, strerror(errno));
+    return -EIO;
   }
 
-  ert_log_debug("Closing stream at %d/%d of file '%s' ...", offset, filesize, filename);
+  *total_length_rcv = (uint32_t) st.st_size + data_length;
 
-  retry_count = 0;
+  return 0;
+}
 
-  retry_close:
-  result = ert_comm_protocol_transmit_stream_close(comm_protocol, stream, false);
-  if (result == -EAGAIN && retry_count < TRANSMIT_RETRY_COUNT) {
-    retry_count++;
-    ert_log_info("Retrying close: %d of %d", retry_count, TRANSMIT_RETRY_COUNT);
-    usleep(TRANSMIT_RETRY_DELAY_MILLIS * 1000);
-    goto retry_close;
-  } else if (result < 0) {
-    ert_log_error("ert_comm_protocol_transmit_stream_close failed with result: %d", result);
+int ert_comm_protocol_transmit_file_transfer(ert_comm_protocol *comm_protocol, uint8_t port,
+    uint32_t transfer_id, uint32_t offset, const char *filename, uint32_t data_length, uint8_t *data,
+    volatile bool *running)
+{
+  int result, close_result;
+
+  uint32_t total_length;
+  result = ert_comm_protocol_get_file_transfer_total_length(filename, data_length, &total_length);
+  if (result < 0) {
+    return result;
+  }
+  uint32_t filesize = total_length - data_length;
+
+  if (offset > total_length) {
+    ert_log_warn("Transfer %d offset %d exceeds total length %d of file '%s', transmitting from start",
+        transfer_id, offset, total_length, filename);
+    offset = 0;
+  }
+
+  uint8_t header[ERT_COMM_PROTOCOL_FILE_TRANSFER_HEADER_LENGTH];
+  memcpy(header, ERT_COMM_PROTOCOL_FILE_TRANSFER_HEADER_ID, 4);
+  ert_comm_protocol_file_transfer_put_uint32(header + 4, transfer_id);
+  ert_comm_protocol_file_transfer_put_uint32(header + 8, offset);
+  ert_comm_protocol_file_transfer_put_uint32(header + 12, total_length);
+
+  ert_comm_protocol_stream *stream;
+  result = ert_comm_protocol_transmit_stream_open(comm_protocol, port, &stream, ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED);
+  if (result < 0) {
+    ert_log_error("ert_comm_protocol_transmit_stream_open failed with result: %d", result);
+    return result;
+  }
+
+  ert_log_info("Transmitting transfer %d of file '%s' from offset %d of %d bytes ...",
+      transfer_id, filename, offset, total_length);
+
+  uint32_t bytes_written = 0;
+  result = ert_comm_protocol_write_buffer(comm_protocol, stream, sizeof(header), header, &bytes_written);
+  if (result < 0) {
     goto error_close_stream;
   }
 
-  ert_log_info("Transmitted %d/%d bytes of file '%s' and %d/%d bytes of buffer successfully",
-      offset, filesize, filename, buffer_bytes_written, data_length);
+  result = ert_comm_protocol_write_file_and_buffer(comm_protocol, stream, filename, filesize, offset,
+      data_length, data, running);
+  if (result < 0) {
+    goto error_close_stream;
+  }
 
-  return 0;
+  result = ert_comm_protocol_close_transmit_stream(comm_protocol, stream);
+  if (result < 0) {
+    goto error_close_stream;
+  }
 
-  error_close_file:
-  close(fd);
+  ert_log_info("Transmitted transfer %d of file '%s' from offset %d of %d bytes successfully",
+      transfer_id, filename, offset, total_length);
+
+  return 0;
 
   error_close_stream:
   close_result = ert_comm_protocol_transmit_stream_close(comm_protocol, stream, true);
@@ -201,10 +322,215 @@ int ert_comm_protocol_transmit_file_and_buffer(ert_comm_protocol *comm_protocol,
   return result;
 }
 
-int ert_comm_protocol_transmit_file(ert_comm_protocol *comm_protocol, uint8_t port,
-    bool enable_acks, const char *filename, volatile bool *running)
+int ert_comm_protocol_transmit_file_transfer_status(ert_comm_protocol *comm_protocol, uint8_t port,
+    uint32_t transfer_id, uint32_t received_length)
 {
-  return ert_comm_protocol_transmit_file_and_buffer(comm_protocol, port, enable_acks, filename, 0, NULL, running);
+  uint8_t status[ERT_COMM_PROTOCOL_FILE_TRANSFER_STATUS_LENGTH];
+  memcpy(status, ERT_COMM_PROTOCOL_FILE_TRANSFER_STATUS_ID, 4);
+  ert_comm_protocol_file_transfer_put_uint32(status + 4, transfer_id);
+  ert_comm_protocol_file_transfer_put_uint32(status + 8, received_length);
+
+  ert_log_info("Transmitting status of transfer %d: received %d bytes", transfer_id, received_length);
+
+  int result = ert_comm_protocol_transmit_buffer(comm_protocol, port, true, sizeof(status), status);
+  if (result < 0) {
+    return result;
+  }
+
+  return 0;
+}
+
+int ert_comm_protocol_receive_file_transfer_status(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    volatile bool *running, uint32_t *transfer_id_rcv, uint32_t *received_length_rcv)
+{
+  uint8_t status[ERT_COMM_PROTOCOL_FILE_TRANSFER_STATUS_LENGTH];
+  uint32_t bytes_received = 0;
+
+  int result = ert_comm_protocol_receive_buffer(comm_protocol, stream, sizeof(status), status, &bytes_received, running);
+  if (result < 0) {
+    return result;
+  }
+
+  if (bytes_received != sizeof(status) || memcmp(status, ERT_COMM_PROTOCOL_FILE_TRANSFER_STATUS_ID, 4) != 0) {
+    ert_log_error("Invalid file transfer status received: %d bytes", bytes_received);
+    return -EINVAL;
+  }
+
+  *transfer_id_rcv = ert_comm_protocol_file_transfer_get_uint32(status + 4);
+  *received_length_rcv = ert_comm_protocol_file_transfer_get_uint32(status + 8);
+
+  return 0;
+}
+
+static int ert_comm_protocol_receive_file_transfer_header(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    volatile bool *running, ert_comm_protocol_file_transfer_info *info)
+{
+  uint8_t header[ERT_COMM_PROTOCOL_FILE_TRANSFER_HEADER_LENGTH];
+  uint32_t total_bytes_read = 0;
+  uint32_t bytes_read = 0;
+  int result;
+
+  do {
+    result = ert_comm_protocol_receive_stream_read(comm_protocol, stream, STREAM_READ_TIMEOUT_MILLIS,
+        sizeof(header) - total_bytes_read, header + total_bytes_read, &bytes_read);
+    if (result == -ETIMEDOUT) {
+      continue;
+    } else if (result < 0) {
+      ert_log_error("ert_comm_protocol_receive_stream_read failed with result: %d", result);
+      return result;
+    }
+
+    total_bytes_read += bytes_read;
+  } while (*running && bytes_read > 0 && total_bytes_read < sizeof(header));
+
+  if (total_bytes_read < sizeof(header) || memcmp(header, ERT_COMM_PROTOCOL_FILE_TRANSFER_HEADER_ID, 4) != 0) {
+    ert_log_error("Invalid file transfer header received: %d bytes", total_bytes_read);
+    return -EINVAL;
+  }
+
+  info->transfer_id = ert_comm_protocol_file_transfer_get_uint32(header + 4);
+  info->offset = ert_comm_protocol_file_transfer_get_uint32(header + 8);
+  info->total_length = ert_comm_protocol_file_transfer_get_uint32(header + 12);
+
+  return 0;
+}
+
+/**
+ * Removes partial files of the transfer ID that were received with a different total length, so that their data
+ * is never resumed as part of this transfer.
+ */
+static void ert_comm_protocol_remove_stale_file_transfer_partials(const char *path,
+    ert_comm_protocol_file_transfer_info *info)
+{
+  char pattern[PATH_MAX];
+  snprintf(pattern, PATH_MAX, "%s/transfer-%u-*.partial", path, info->transfer_id);
+
+  glob_t glob_result;
+  if (glob(pattern, 0, NULL, &glob_result) != 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < glob_result.gl_pathc; i++) {
+    if (strcmp(glob_result.gl_pathv[i], info->filename) == 0) {
+      continue;
+    }
+
+    ert_log_warn("Discarding partial file '%s' of transfer %d with total length other than %d",
+        glob_result.gl_pathv[i], info->transfer_id, info->total_length);
+    if (unlink(glob_result.gl_pathv[i]) < 0) {
+      ert_log_error("Error removing file '%s': %s", glob_result.gl_pathv[i], strerror(errno));
+    }
+  }
+
+  globfree(&glob_result);
+}
+
+int ert_comm_protocol_receive_file_transfer(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    const char *path, volatile bool *running, ert_comm_protocol_file_transfer_info *info)
+{
+  ert_comm_protocol_stream_info stream_info;
+  int result;
+
+  memset(info, 0, sizeof(ert_comm_protocol_file_transfer_info));
+
+  ert_comm_protocol_stream_get_info(stream, &stream_info);
+
+  result = ert_comm_protocol_receive_file_transfer_header(comm_protocol, stream, running, info);
+  if (result < 0) {
+    // The transfer cannot be identified without a valid header
+    ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+    return -EINVAL;
+  }
+
+  // The total length is part of the name, data received for a transfer of another length is never resumed
+  snprintf(info->filename, PATH_MAX, "%s/transfer-%u-%u.partial", path, info->transfer_id, info->total_length);
+  ert_comm_protocol_remove_stale_file_transfer_partials(path, info);
+
+  int fd = open(info->filename, O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd < 0) {
+    ert_log_error("Error opening file '%s' for writing: %s", info->filename, strerror(errno));
+    ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+    return -EIO;
+  }
+
+  off_t received_length = lseek(fd, 0, SEEK_END);
+  if (received_length < 0) {
+    ert_log_error("Error seeking to end of file '%s': %s", info->filename, strerror(errno));
+    close(fd);
+    ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+    return -EIO;
+  }
+
+  if ((uint32_t) received_length < info->offset) {
+    // Data between the received length and the offset is missing, the sender has to resume from the received length
+    ert_log_warn("Transfer %d offset %d exceeds received length %d of file '%s', discarding stream",
+        info->transfer_id, info->offset, (uint32_t) received_length, info->filename);
+    close(fd);
+    info->received_length = (uint32_t) received_length;
+    ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+    return -ERANGE;
+  }
+
+  if ((uint32_t) received_length > info->offset) {
+    if (ftruncate(fd, (off_t) info->offset) < 0 || lseek(fd, (off_t) info->offset, SEEK_SET) < 0) {
+      ert_log_error("Error truncating file '%s' to offset %d: %s", info->filename, info->offset, strerror(errno));
+      close(fd);
+      ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+      return -EIO;
+    }
+  }
+
+  ert_log_info("Receiving transfer %d in stream ID %d port %d to file %s from offset %d of %d bytes ...",
+      info->transfer_id, stream_info.stream_id, stream_info.port, info->filename, info->offset, info->total_length);
+
+  uint32_t buffer_size = STREAM_FILE_DATA_BUFFER_LENGTH;
+  uint8_t data[buffer_size];
+  uint32_t bytes_read = 0;
+
+  info->received_length = info->offset;
+
+  do {
+    result = ert_comm_protocol_receive_stream_read(comm_protocol, stream, STREAM_READ_TIMEOUT_MILLIS,
+        buffer_size, data, &bytes_read);
+    if (result == -ETIMEDOUT) {
+      ert_log_debug("Read timed out, retrying read ...");
+      continue;
+    } else if (result < 0) {
+      ert_log_error("ert_comm_protocol_receive_stream_read failed with result: %d", result);
+      break;
+    }
+
+    if (bytes_read > 0) {
+      ssize_t write_result = write(fd, data, bytes_read);
+      if (write_result < 0) {
+        ert_log_error("Error writing file '%s': %s", info->filename, strerror(errno));
+        result = -EIO;
+        break;
+      }
+      info->received_length += bytes_read;
+    }
+  } while (*running && bytes_read > 0);
+
+  close(fd);
+
+  info->complete = (result >= 0 && info->received_length == info->total_length);
+
+  ert_log_info("Received %d/%d bytes of transfer %d in stream ID %d port %d to file %s",
+      info->received_length, info->total_length, info->transfer_id, stream_info.stream_id, stream_info.port,
+      info->filename);
+
+  if (result < 0) {
+    ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+    return result;
+  }
+
+  result = ert_comm_protocol_receive_stream_close(comm_protocol, stream);
+  if (result < 0) {
+    ert_log_error("ert_comm_protocol_receive_stream_close failed with result: %d", result);
+    return result;
+  }
+
+  return 0;
 }
 
 int ert_comm_protocol_receive_buffer(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
@@ -283,13 +609,20 @@ int ert_comm_protocol_receive_file(ert_comm_protocol *comm_protocol, ert_comm_pr
   do {
     ert_log_debug("Reading data in stream ID %d port %d to file %s ...",
         stream_info.stream_id, stream_info.port, filename);
-    result = ert_comm_protocol_receive_stream_read(comm_protocol, stream, STREAM_READ_TIMEOUT_MILLIS,
-        buffer_size, data, &bytes_read);
+    // Write uncompressed data to the file directly from the stream buffer
+    uint8_t *read_data = data;
+    if (stream_info.compressed) {
+      result = ert_comm_protocol_receive_stream_read(comm_protocol, stream, STREAM_READ_TIMEOUT_MILLIS,
+          buffer_size, data, &bytes_read);
+    } else {
+      result = ert_comm_protocol_receive_stream_peek(comm_protocol, stream, STREAM_READ_TIMEOUT_MILLIS,
+          &read_data, &bytes_read);
+    }
     if (result == -ETIMEDOUT) {
       ert_log_debug("Read timed out, retrying read ...");
       continue;
     } else if (result < 0) {
-      ert_log_error("ert_comm_protocol_receive_stream_read failed with result: %d", result);
+      ert_log_error("Reading stream failed with result: %d", result);
       break;
     }
 
@@ -299,12 +632,16 @@ int ert_comm_protocol_receive_file(ert_comm_protocol *comm_protocol, ert_comm_pr
         bytes_read, stream_info.stream_id, stream_info.port, filename);
 
     if (bytes_read > 0) {
-      ssize_t write_result = write(fd, data, bytes_read);
+      ssize_t write_result = write(fd, read_data, bytes_read);
       if (write_result < 0) {
         ert_log_error("Error writing file '%s': %s", filename, strerror(errno));
         result = -EIO;
         break;
       }
+
+      if (!stream_info.compressed) {
+        ert_comm_protocol_receive_stream_consume(comm_protocol, stream, bytes_read);
+      }
     }
   } while (*running && bytes_read > 0);
 
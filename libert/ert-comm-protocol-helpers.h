@@ -12,6 +12,29 @@
 #define __ERT_COMM_PROTOCOL_HELPERS_H
 
 #include "ert-comm-protocol.h"
+#include <limits.h>
+
+#define ERT_COMM_PROTOCOL_FILE_TRANSFER_HEADER_ID "EFT1"
+#define ERT_COMM_PROTOCOL_FILE_TRANSFER_HEADER_LENGTH 16
+#define ERT_COMM_PROTOCOL_FILE_TRANSFER_STATUS_ID "EFS1"
+#define ERT_COMM_PROTOCOL_FILE_TRANSFER_STATUS_LENGTH 12
+
+/**
+ * A resumable file transfer stream starts with a header containing the transfer ID, the offset of the data
+ * in the stream and the total length of the transferred data. The receiver keeps the received data
+ * in a partial file named by the transfer ID and the total length and reports the received length
+ * of the transfer with a status message, so that the sender can resume an incomplete transfer from that offset.
+ * A status reporting the total length tells the sender that the transfer is complete even if the final
+ * acknowledgement was lost.
+ */
+typedef struct _ert_comm_protocol_file_transfer_info {
+  uint32_t transfer_id;
+  uint32_t offset;
+  uint32_t total_length;
+  uint32_t received_length;
+  bool complete;
+  char filename[PATH_MAX];
+} ert_comm_protocol_file_transfer_info;
 
 int ert_comm_protocol_transmit_buffer(ert_comm_protocol *comm_protocol, uint8_t port,
     bool enable_acks, uint32_t data_length, uint8_t *data);
@@ -20,9 +43,21 @@ int ert_comm_protocol_transmit_file_and_buffer(ert_comm_protocol *comm_protocol,
 int ert_comm_protocol_transmit_file(ert_comm_protocol *comm_protocol, uint8_t port,
     bool enable_acks, const char *filename, volatile bool *running);
 
+int ert_comm_protocol_get_file_transfer_total_length(const char *filename, uint32_t data_length,
+    uint32_t *total_length_rcv);
+int ert_comm_protocol_transmit_file_transfer(ert_comm_protocol *comm_protocol, uint8_t port,
+    uint32_t transfer_id, uint32_t offset, const char *filename, uint32_t data_length, uint8_t *data,
+    volatile bool *running);
+int ert_comm_protocol_transmit_file_transfer_status(ert_comm_protocol *comm_protocol, uint8_t port,
+    uint32_t transfer_id, uint32_t received_length);
+
 int ert_comm_protocol_receive_buffer(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
     uint32_t buffer_size, uint8_t *buffer, uint32_t *bytes_received, volatile bool *running);
 int ert_comm_protocol_receive_file(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream, const char *filename,
     bool delete_empty, volatile bool *running, uint32_t *bytes_received_rcv);
+int ert_comm_protocol_receive_file_transfer(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    const char *path, volatile bool *running, ert_comm_protocol_file_transfer_info *info);
+int ert_comm_protocol_receive_file_transfer_status(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    volatile bool *running, uint32_t *transfer_id_rcv, uint32_t *received_length_rcv);
 
 #endif
@@ -0,0 +1,334 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+ * Microbenchmark for stream packet history handling: streams a fixed number of packets between two
+ * dummy devices using different acknowledgement intervals (= packet history depths). Every acknowledgement
+ * pops packets from the transmit stream packet history and packets transmitted while waiting for
+ * the acknowledgement get retransmitted from history.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+
+#include "ert-comm-protocol-test.h"
+#include "ert-log.h"
+#include "ert-time.h"
+#include "ert-test.h"
+
+#define BENCH_PORT 1
+#define BENCH_PACKET_COUNT_DEFAULT 512
+#define BENCH_PAYLOAD_LENGTH 200
+#define BENCH_TRANSMIT_TIME_MILLIS 1
+#define BENCH_STREAM_READ_TIMEOUT_MILLIS 5000
+#define BENCH_STREAM_DONE_TIMEOUT_MILLIS 60000
+
+typedef struct _ert_comm_protocol_history_bench_context {
+  ert_comm_transceiver_test_context *comm_transceiver_test_context;
+
+  ert_comm_protocol_device *comm_protocol_device1;
+  ert_comm_protocol_device *comm_protocol_device2;
+
+  ert_comm_protocol *comm_protocol1;
+  ert_comm_protocol *comm_protocol2;
+
+  ert_pipe *stream_done_queue;
+} ert_comm_protocol_history_bench_context;
+
+typedef struct _ert_comm_protocol_history_bench_reader {
+  ert_comm_protocol *comm_protocol;
+  ert_comm_protocol_stream *stream;
+  ert_pipe *stream_done_queue;
+} ert_comm_protocol_history_bench_reader;
+
+static void *ert_comm_protocol_history_bench_stream_reader(void *context)
+{
+  ert_comm_protocol_history_bench_reader *reader = (ert_comm_protocol_history_bench_reader *) context;
+  uint8_t buffer[1024];
+  uint32_t bytes_read = 0;
+  uint64_t total_bytes_read = 0;
+  int result;
+
+  do {
+    result = ert_comm_protocol_receive_stream_read(reader->comm_protocol, reader->stream,
+        BENCH_STREAM_READ_TIMEOUT_MILLIS, sizeof(buffer), buffer, &bytes_read);
+    if (result == -ETIMEDOUT) {
+      continue;
+    } else if (result < 0) {
+      ert_log_error("ert_comm_protocol_receive_stream_read failed with result: %d", result);
+      break;
+    }
+
+    total_bytes_read += bytes_read;
+  } while (bytes_read > 0);
+
+  ert_comm_protocol_receive_stream_close(reader->comm_protocol, reader->stream);
+
+  ert_pipe_push(reader->stream_done_queue, &total_bytes_read, 1);
+
+  free(reader);
+
+  return NULL;
+}
+
+static void ert_comm_protocol_history_bench_stream_listener_callback(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, void *callback_context)
+{
+  ert_comm_protocol_history_bench_context *context = (ert_comm_protocol_history_bench_context *) callback_context;
+
+  ert_comm_protocol_history_bench_reader *reader = malloc(sizeof(ert_comm_protocol_history_bench_reader));
+  if (reader == NULL) {
+    ert_log_fatal("Error allocating memory for stream reader: %s", strerror(errno));
+    abort();
+  }
+
+  reader->comm_protocol = comm_protocol;
+  reader->stream = stream;
+  reader->stream_done_queue = context->stream_done_queue;
+
+  pthread_t thread;
+  int result = pthread_create(&thread, NULL, ert_comm_protocol_history_bench_stream_reader, reader);
+  if (result != 0) {
+    ert_log_error("Error starting stream reader thread: %s", strerror(errno));
+    abort();
+  }
+  pthread_detach(thread);
+}
+
+static int ert_comm_protocol_history_bench_wait_for_streams_closed(ert_comm_protocol *comm_protocol,
+    uint32_t timeout_millis)
+{
+  for (uint32_t waited_millis = 0; waited_millis < timeout_millis; waited_millis += 10) {
+    size_t stream_info_count;
+    ert_comm_protocol_stream_info *stream_info;
+
+    int result = ert_comm_protocol_get_active_streams(comm_protocol, &stream_info_count, &stream_info);
+    if (result < 0) {
+      return result;
+    }
+    free(stream_info);
+
+    if (stream_info_count == 0) {
+      return 0;
+    }
+
+    usleep(10000);
+  }
+
+  return -ETIMEDOUT;
+}
+
+static int ert_comm_protocol_history_bench_initialize(uint32_t acknowledgement_interval_packet_count,
+    ert_comm_protocol_history_bench_context *context)
+{
+  int result = ert_comm_transceiver_test_initialize(&context->comm_transceiver_test_context);
+  if (result < 0) {
+    return result;
+  }
+
+  ert_driver_comm_device_dummy_set_transmit_time_millis(context->comm_transceiver_test_context->device1,
+      BENCH_TRANSMIT_TIME_MILLIS);
+  ert_driver_comm_device_dummy_set_transmit_time_millis(context->comm_transceiver_test_context->device2,
+      BENCH_TRANSMIT_TIME_MILLIS);
+
+  result = ert_pipe_create(sizeof(uint64_t), 16, &context->stream_done_queue);
+  if (result < 0) {
+    ert_log_error("Error creating pipe for stream done queue");
+    return -ENOMEM;
+  }
+
+  ert_comm_protocol_config config;
+  ert_comm_protocol_create_default_config(&config);
+  config.stream_acknowledgement_interval_packet_count = acknowledgement_interval_packet_count;
+  config.stream_acknowledgement_adaptive = false;
+  config.receive_buffer_length_packets = acknowledgement_interval_packet_count * 2;
+
+  result = ert_comm_protocol_device_adapter_create(context->comm_transceiver_test_context->comm_transceiver1,
+      &context->comm_protocol_device1);
+  if (result < 0) {
+    return result;
+  }
+
+  result = ert_comm_protocol_create(&config, ert_comm_protocol_history_bench_stream_listener_callback, context,
+      context->comm_protocol_device1, &context->comm_protocol1);
+  if (result < 0) {
+    return result;
+  }
+
+  result = ert_comm_protocol_device_adapter_create(context->comm_transceiver_test_context->comm_transceiver2,
+      &context->comm_protocol_device2);
+  if (result < 0) {
+    return result;
+  }
+
+  result = ert_comm_protocol_create(&config, ert_comm_protocol_history_bench_stream_listener_callback, context,
+      context->comm_protocol_device2, &context->comm_protocol2);
+  if (result < 0) {
+    return result;
+  }
+
+  return 0;
+}
+
+static void ert_comm_protocol_history_bench_uninitialize(ert_comm_protocol_history_bench_context *context)
+{
+  ert_comm_protocol_destroy(context->comm_protocol2);
+  ert_comm_protocol_destroy(context->comm_protocol1);
+
+  ert_comm_protocol_device_adapter_destroy(context->comm_protocol_device2);
+  ert_comm_protocol_device_adapter_destroy(context->comm_protocol_device1);
+
+  ert_pipe_close(context->stream_done_queue);
+  ert_pipe_destroy(context->stream_done_queue);
+
+  ert_comm_transceiver_test_uninitialize(context->comm_transceiver_test_context);
+}
+
+static int ert_comm_protocol_history_bench_run(uint32_t acknowledgement_interval_packet_count,
+    uint32_t packet_count)
+{
+  ert_comm_protocol_history_bench_context context = {0};
+  ert_comm_protocol_stream *stream;
+  int result;
+
+  result = ert_comm_protocol_history_bench_initialize(acknowledgement_interval_packet_count, &context);
+  if (result < 0) {
+    ert_log_error("Error initializing benchmark, result %d", result);
+    return result;
+  }
+
+  uint32_t payload_length = BENCH_PAYLOAD_LENGTH;
+  uint8_t payload[BENCH_PAYLOAD_LENGTH];
+  memset(payload, 0x55, payload_length);
+
+  struct timespec start_time, end_time;
+  struct timespec start_cpu_time, end_cpu_time;
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start_cpu_time);
+
+  result = ert_comm_protocol_transmit_stream_open(context.comm_protocol1, BENCH_PORT, &stream,
+      ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED);
+  if (result < 0) {
+    ert_log_error("ert_comm_protocol_transmit_stream_open failed with result %d", result);
+    goto uninitialize;
+  }
+
+  for (uint32_t i = 0; i < packet_count; i++) {
+    uint32_t bytes_written;
+
+    result = ert_comm_protocol_transmit_stream_write(context.comm_protocol1, stream,
+        payload_length, payload, &bytes_written);
+    if (result < 0) {
+      ert_log_error("ert_comm_protocol_transmit_stream_write failed with result %d", result);
+      goto uninitialize;
+    }
+
+    do {
+      result = ert_comm_protocol_transmit_stream_flush(context.comm_protocol1, stream, false, NULL);
+      if (result == -EAGAIN) {
+        // Packet history is full, wait for acknowledgements
+        usleep(1000);
+      }
+    } while (result == -EAGAIN);
+
+    if (result < 0) {
+      ert_log_error("ert_comm_protocol_transmit_stream_flush failed with result %d", result);
+      goto uninitialize;
+    }
+  }
+
+  do {
+    result = ert_comm_protocol_transmit_stream_close(context.comm_protocol1, stream, false);
+    if (result == -EAGAIN) {
+      usleep(1000);
+    }
+  } while (result == -EAGAIN);
+
+  if (result < 0) {
+    ert_log_error("ert_comm_protocol_transmit_stream_close failed with result %d", result);
+    goto uninitialize;
+  }
+
+  uint64_t total_bytes_read = 0;
+  ssize_t pop_result = ert_pipe_pop_timed(context.stream_done_queue, &total_bytes_read, 1,
+      BENCH_STREAM_DONE_TIMEOUT_MILLIS);
+  if (pop_result < 1) {
+    ert_log_error("Timed out waiting for stream to be received");
+    result = -ETIMEDOUT;
+    goto uninitialize;
+  }
+
+  // Transmit stream is closed when the end of stream has been acknowledged
+  result = ert_comm_protocol_history_bench_wait_for_streams_closed(context.comm_protocol1,
+      BENCH_STREAM_DONE_TIMEOUT_MILLIS);
+  if (result < 0) {
+    ert_log_error("Timed out waiting for transmit stream to be closed");
+    goto uninitialize;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &end_cpu_time);
+
+  ert_comm_protocol_status status;
+  ert_comm_protocol_get_status(context.comm_protocol1, &status);
+
+  double elapsed_millis = (double) (end_time.tv_sec - start_time.tv_sec) * 1000.0
+      + (double) (end_time.tv_nsec - start_time.tv_nsec) / 1000000.0;
+  double cpu_millis = (double) (end_cpu_time.tv_sec - start_cpu_time.tv_sec) * 1000.0
+      + (double) (end_cpu_time.tv_nsec - start_cpu_time.tv_nsec) / 1000000.0;
+
+  printf("ack_interval=%u packets=%u received_bytes=%" PRIu64 " "
+      "transmitted_packets=%" PRIu64 " retransmitted_packets=%" PRIu64 " "
+      "elapsed_ms=%.3f cpu_ms=%.3f cpu_us_per_packet=%.3f\n",
+      acknowledgement_interval_packet_count, packet_count, total_bytes_read,
+      status.transmitted_packet_count, status.retransmitted_packet_count,
+      elapsed_millis, cpu_millis, (cpu_millis * 1000.0) / (double) status.transmitted_packet_count);
+  fflush(stdout);
+
+  result = (total_bytes_read == (uint64_t) packet_count * payload_length) ? 0 : -EIO;
+  if (result < 0) {
+    ert_log_error("Received %" PRIu64 " bytes, expected %" PRIu64 " bytes",
+        total_bytes_read, (uint64_t) packet_count * payload_length);
+  }
+
+  uninitialize:
+  ert_comm_protocol_history_bench_uninitialize(&context);
+
+  return result;
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t acknowledgement_intervals[] = { 16, 32, 64, 96 };
+  uint32_t packet_count = BENCH_PACKET_COUNT_DEFAULT;
+  int result = 0;
+
+  if (argc > 1) {
+    packet_count = (uint32_t) strtoul(argv[1], NULL, 10);
+  }
+
+  ert_test_init();
+
+  for (size_t i = 0; i < sizeof(acknowledgement_intervals) / sizeof(uint32_t); i++) {
+    result = ert_comm_protocol_history_bench_run(acknowledgement_intervals[i], packet_count);
+    if (result < 0) {
+      break;
+    }
+  }
+
+  ert_test_uninit();
+
+  return (result < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
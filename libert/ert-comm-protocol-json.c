@@ -31,6 +31,9 @@ static int ert_comm_protocol_stream_info_json_serialize_single(ert_comm_protocol
 
   jansson_check_result(json_object_set_new(info_obj, "acks_enabled", json_boolean(info->acks_enabled)));
   jansson_check_result(json_object_set_new(info_obj, "acks", json_boolean(info->acks)));
+  jansson_check_result(json_object_set_new(info_obj, "acks_bitmap", json_boolean(info->acks_bitmap)));
+  jansson_check_result(json_object_set_new(info_obj, "fec", json_boolean(info->fec)));
+  jansson_check_result(json_object_set_new(info_obj, "compressed", json_boolean(info->compressed)));
   jansson_check_result(json_object_set_new(info_obj, "ack_request_pending", json_boolean(info->ack_request_pending)));
 
   jansson_check_result(json_object_set_new(info_obj, "start_of_stream", json_boolean(info->start_of_stream)));
@@ -55,11 +58,24 @@ static int ert_comm_protocol_stream_info_json_serialize_single(ert_comm_protocol
   jansson_check_result(json_object_set_new(info_obj, "ack_rerequest_count", json_integer(info->ack_rerequest_count)));
   jansson_check_result(json_object_set_new(info_obj, "end_of_stream_ack_rerequest_count", json_integer(info->end_of_stream_ack_rerequest_count)));
 
+  jansson_check_result(json_object_set_new(info_obj, "ack_interval_packet_count", json_integer(info->ack_interval_packet_count)));
+  jansson_check_result(json_object_set_new(info_obj, "ack_receive_timeout_millis", json_integer(info->ack_receive_timeout_millis)));
+  jansson_check_result(json_object_set_new(info_obj, "round_trip_time_millis", json_integer(info->round_trip_time_millis)));
+  jansson_check_result(json_object_set_new(info_obj, "round_trip_time_deviation_millis", json_integer(info->round_trip_time_deviation_millis)));
+  jansson_check_result(json_object_set_new(info_obj, "packet_loss_ratio", json_real(info->packet_loss_ratio)));
+
   jansson_check_result(json_object_set_new(info_obj, "retransmitted_packet_count", json_real(info->retransmitted_packet_count)));
   jansson_check_result(json_object_set_new(info_obj, "retransmitted_data_bytes", json_real(info->retransmitted_data_bytes)));
   jansson_check_result(json_object_set_new(info_obj, "retransmitted_payload_data_bytes", json_real(info->retransmitted_payload_data_bytes)));
 
   jansson_check_result(json_object_set_new(info_obj, "received_packet_sequence_number_error_count", json_real(info->received_packet_sequence_number_error_count)));
+  jansson_check_result(json_object_set_new(info_obj, "fec_repair_packet_count", json_real(info->fec_repair_packet_count)));
+  jansson_check_result(json_object_set_new(info_obj, "fec_recovered_packet_count", json_real(info->fec_recovered_packet_count)));
+
+  jansson_check_result(json_object_set_new(info_obj, "uncompressed_data_bytes", json_real(info->uncompressed_data_bytes)));
+  jansson_check_result(json_object_set_new(info_obj, "compressed_data_bytes", json_real(info->compressed_data_bytes)));
+  jansson_check_result(json_object_set_new(info_obj, "compression_ratio", json_real(info->compression_ratio)));
+  jansson_check_result(json_object_set_new(info_obj, "compression_cpu_time_nanos", json_real(info->compression_cpu_time_nanos)));
 
   return 0;
 }
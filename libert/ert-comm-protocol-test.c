@@ -8,12 +8,18 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <assert.h>
+#include <sys/stat.h>
 
 #include "ert-comm-protocol-test.h"
+#include "ert-comm-protocol-helpers.h"
+#include "ert-comm-protocol-aggregator.h"
+#include "ert-comm-protocol-compression.h"
 #include "ert-log.h"
 #include "ert-test.h"
 
@@ -24,6 +30,8 @@ typedef struct _ert_comm_protocol_test_protocol_context {
 
   ert_comm_protocol *comm_protocol;
   ert_pipe *stream_queue;
+  // Streams of file transfers and their status, read by the test itself
+  ert_pipe *file_transfer_stream_queue;
 
   ert_comm_protocol_test_context *comm_protocol_test_context;
 } ert_comm_protocol_test_protocol_context;
@@ -43,6 +51,9 @@ struct _ert_comm_protocol_test_context {
 
 #define STREAM_READ_TIMEOUT_MILLIS 5000
 
+#define ERT_COMM_PROTOCOL_TEST_PORT_FILE_TRANSFER 3
+#define ERT_COMM_PROTOCOL_TEST_PORT_FILE_TRANSFER_STATUS 4
+
 int ert_comm_protocol_test_read_stream(ert_comm_protocol_test_protocol_context *context, ert_comm_protocol_stream *stream)
 {
   ert_comm_protocol *comm_protocol = context->comm_protocol;
@@ -61,13 +72,27 @@ int ert_comm_protocol_test_read_stream(ert_comm_protocol_test_protocol_context *
 
   do {
     ert_log_debug("Reading data in stream ID %d port %d ...", stream_info.stream_id, stream_info.port);
-    result = ert_comm_protocol_receive_stream_read(comm_protocol, stream, STREAM_READ_TIMEOUT_MILLIS,
-        buffer_size, buffer, &bytes_read);
+    if (stream_info.port == 2) {
+      // Read streams in port 2 in place to test zero-copy access to the stream buffer
+      uint8_t *data;
+      result = ert_comm_protocol_receive_stream_peek(comm_protocol, stream, STREAM_READ_TIMEOUT_MILLIS,
+          &data, &bytes_read);
+      if (result == 0 && bytes_read > 0) {
+        uint32_t bytes_to_copy = (bytes_read < buffer_size) ? bytes_read : buffer_size;
+        memcpy(buffer, data, bytes_to_copy);
+        result = ert_comm_protocol_receive_stream_consume(comm_protocol, stream, bytes_to_copy);
+        assert(result == 0);
+        bytes_read = bytes_to_copy;
+      }
+    } else {
+      result = ert_comm_protocol_receive_stream_read(comm_protocol, stream, STREAM_READ_TIMEOUT_MILLIS,
+          buffer_size, buffer, &bytes_read);
+    }
     if (result == -ETIMEDOUT) {
       ert_log_debug("Read timed out, retrying read for stream ID %d port %d ...", stream_info.stream_id, stream_info.port);
       continue;
     } else if (result < 0) {
-      ert_log_error("ert_comm_protocol_receive_stream_read failed with result: %d", result);
+      ert_log_error("Reading stream failed with result: %d", result);
       break;
     }
 
@@ -133,6 +158,10 @@ void ert_comm_protocol_test_stream_listener_callback(ert_comm_protocol *comm_pro
     case 2:
       ert_pipe_push(test_protocol_context->stream_queue, &stream, 1);
       break;
+    case ERT_COMM_PROTOCOL_TEST_PORT_FILE_TRANSFER:
+    case ERT_COMM_PROTOCOL_TEST_PORT_FILE_TRANSFER_STATUS:
+      ert_pipe_push(test_protocol_context->file_transfer_stream_queue, &stream, 1);
+      return;
     default:
       ert_log_error("Unknown port in stream: %d", stream_info.port);
       result = ert_comm_protocol_receive_stream_close(comm_protocol, stream);
@@ -171,6 +200,14 @@ int ert_comm_protocol_test_protocol_context_create(ert_comm_protocol_test_contex
     return -ENOMEM;
   }
 
+  result = ert_pipe_create(sizeof(ert_comm_protocol_stream *), 16, &protocol_context->file_transfer_stream_queue);
+  if (result != 0) {
+    ert_pipe_destroy(protocol_context->stream_queue);
+    free(protocol_context);
+    ert_log_fatal("Error creating pipe for test protocol context file transfer stream queue");
+    return -ENOMEM;
+  }
+
   *protocol_context_rcv = protocol_context;
 
   return 0;
@@ -180,11 +217,14 @@ int ert_comm_protocol_test_protocol_context_destroy(ert_comm_protocol_test_proto
 {
   ert_pipe_close(protocol_context->stream_queue);
   ert_pipe_destroy(protocol_context->stream_queue);
+  ert_pipe_close(protocol_context->file_transfer_stream_queue);
+  ert_pipe_destroy(protocol_context->file_transfer_stream_queue);
   free(protocol_context);
   return 0;
 }
 
-int ert_comm_protocol_test_initialize(ert_comm_protocol_test_context **context_rcv)
+int ert_comm_protocol_test_initialize(ert_comm_protocol_config *config1, ert_comm_protocol_config *config2,
+    ert_comm_protocol_test_context **context_rcv)
 {
   ert_comm_protocol_test_context *context = malloc(sizeof(ert_comm_protocol_test_context));
   if (context == NULL) {
@@ -207,9 +247,6 @@ int ert_comm_protocol_test_initialize(ert_comm_protocol_test_context **context_r
     return result;
   }
 
-  ert_comm_protocol_config config;
-  ert_comm_protocol_create_default_config(&config);
-
   result = ert_comm_protocol_device_adapter_create(context->comm_transceiver_test_context->comm_transceiver1,
       &context->comm_protocol_device1);
   if (result != 0) {
@@ -219,7 +256,7 @@ int ert_comm_protocol_test_initialize(ert_comm_protocol_test_context **context_r
 
   context->comm_protocol1_test_protocol_context->comm_protocol = context->comm_protocol1;
 
-  result = ert_comm_protocol_create(&config, ert_comm_protocol_test_stream_listener_callback,
+  result = ert_comm_protocol_create(config1, ert_comm_protocol_test_stream_listener_callback,
       context->comm_protocol1_test_protocol_context,
       context->comm_protocol_device1, &context->comm_protocol1);
   if (result != 0) {
@@ -235,7 +272,7 @@ int ert_comm_protocol_test_initialize(ert_comm_protocol_test_context **context_r
     return result;
   }
 
-  result = ert_comm_protocol_create(&config, ert_comm_protocol_test_stream_listener_callback,
+  result = ert_comm_protocol_create(config2, ert_comm_protocol_test_stream_listener_callback,
       context->comm_protocol2_test_protocol_context,
       context->comm_protocol_device2, &context->comm_protocol2);
   if (result != 0) {
@@ -551,32 +588,1214 @@ void ert_comm_protocol_test_run_test_multiple_streams_over_one_more_than_ack_int
   assert(result == 0);
 }
 
-int main(void)
+void ert_comm_protocol_test_wait_for_transmit_streams_closed(ert_comm_protocol *comm_protocol)
 {
-  int result = ert_test_init();
+  for (int retry_count = 30; retry_count > 0; retry_count--) {
+    size_t stream_info_count;
+    ert_comm_protocol_stream_info *stream_info;
+    bool transmit_streams_active = false;
+
+    int result = ert_comm_protocol_get_active_streams(comm_protocol, &stream_info_count, &stream_info);
+    assert(result == 0);
+
+    for (size_t i = 0; i < stream_info_count; i++) {
+      if (stream_info[i].type == ERT_COMM_PROTOCOL_STREAM_TYPE_TRANSMIT) {
+        transmit_streams_active = true;
+      }
+    }
+    free(stream_info);
+
+    if (!transmit_streams_active) {
+      return;
+    }
+
+    sleep(1);
+  }
+
+  ert_log_error("Transmit streams still active");
+  assert(false);
+}
+
+/*
+ * Transfers a stream between two protocol instances with the given acknowledgement bitmap settings
+ * and returns the number of bytes the receiver transmitted, which consists of acknowledgement packets only.
+ */
+uint64_t ert_comm_protocol_test_run_test_acknowledgement_encoding(bool transmitter_acks_bitmap, bool receiver_acks_bitmap)
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config1;
+  ert_comm_protocol_config config2;
+  ert_comm_protocol_stream *stream1;
+  ert_comm_protocol_stream_info stream_info;
+  ert_comm_protocol_status status;
+  int result;
+
+  ert_comm_protocol_create_default_config(&config1);
+  config1.stream_acknowledgement_bitmap = transmitter_acks_bitmap;
+  ert_comm_protocol_create_default_config(&config2);
+  config2.stream_acknowledgement_bitmap = receiver_acks_bitmap;
+
+  result = ert_comm_protocol_test_initialize(&config1, &config2, &context);
+  assert(result == 0);
+
+  result = ert_comm_protocol_transmit_stream_open(context->comm_protocol1, 1, &stream1,
+      ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED);
   if (result < 0) {
-    return EXIT_FAILURE;
+    ert_log_error("ert_comm_protocol_transmit_stream_open failed with result %d", result);
+  }
+  assert(result == 0);
+
+  int loop_count = ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT * 3 +
+      ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT / 2;
+
+  ert_log_info("Transmitting %d packets with acks: transmitter_acks_bitmap=%d receiver_acks_bitmap=%d",
+      loop_count, transmitter_acks_bitmap, receiver_acks_bitmap);
+
+  for (int i = 0; i < loop_count; i++) {
+    char data[255];
+
+    snprintf(data, 255, "Packet %d", i);
+    result = ert_comm_protocol_test_transmit_stream_write(context->comm_protocol1, stream1, data);
+    assert(result == 0);
+
+    result = ert_comm_protocol_test_transmit_stream_flush(context->comm_protocol1, stream1);
+    assert(result == 0);
+  }
+
+  ert_comm_protocol_test_assert_stream_info_no_errors(stream1);
+
+  result = ert_comm_protocol_stream_get_info(stream1, &stream_info);
+  assert(result == 0);
+  assert(stream_info.acks_bitmap == transmitter_acks_bitmap);
+
+  result = ert_comm_protocol_transmit_stream_close(context->comm_protocol1, stream1, false);
+  if (result < 0) {
+    ert_log_error("ert_comm_protocol_transmit_stream_close failed with result %d", result);
   }
+  assert(result == 0);
+
+  ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+
+  result = ert_comm_protocol_get_status(context->comm_protocol1, &status);
+  assert(result == 0);
+  assert(status.retransmitted_packet_count == 0);
+
+  result = ert_comm_protocol_get_status(context->comm_protocol2, &status);
+  assert(result == 0);
+  assert(status.duplicate_received_packet_count == 0);
+  assert(status.received_packet_sequence_number_error_count == 0);
+
+  ert_log_info("Acknowledgement data transmitted by receiver: %" PRIu64 " bytes", status.transmitted_data_bytes);
+
+  sleep(1);
+
+  ert_comm_protocol_test_uninitialize(context);
+
+  return status.transmitted_data_bytes;
+}
 
+void ert_comm_protocol_test_run_test_acknowledgement_encoding_interoperability()
+{
+  uint64_t bitmap_ack_data_bytes = ert_comm_protocol_test_run_test_acknowledgement_encoding(true, true);
+  uint64_t legacy_transmitter_ack_data_bytes = ert_comm_protocol_test_run_test_acknowledgement_encoding(false, true);
+  uint64_t legacy_receiver_ack_data_bytes = ert_comm_protocol_test_run_test_acknowledgement_encoding(true, false);
+
+  assert(bitmap_ack_data_bytes > 0);
+  assert(legacy_transmitter_ack_data_bytes == legacy_receiver_ack_data_bytes);
+  assert(bitmap_ack_data_bytes < legacy_transmitter_ack_data_bytes);
+}
+
+/*
+ * Transfers a stream that is opened before and another one opened after the receiver has sent acknowledgements,
+ * so that the latter uses extended sequence numbers if the receiver supports them, and wraps the 8-bit sequence space.
+ */
+void ert_comm_protocol_test_run_test_extended_sequence_numbers(bool receiver_extended_sequence_numbers)
+{
   ert_comm_protocol_test_context *context;
-  result = ert_comm_protocol_test_initialize(&context);
+  ert_comm_protocol_config config1;
+  ert_comm_protocol_config config2;
+  ert_comm_protocol_stream *stream1;
+  ert_comm_protocol_stream_info stream_info;
+  ert_comm_protocol_status status;
+  int result;
+
+  ert_comm_protocol_create_default_config(&config1);
+  ert_comm_protocol_create_default_config(&config2);
+  config2.stream_extended_sequence_numbers = receiver_extended_sequence_numbers;
+
+  result = ert_comm_protocol_test_initialize(&config1, &config2, &context);
+  assert(result == 0);
+
+  for (int stream_index = 0; stream_index < 2; stream_index++) {
+    bool negotiated = (stream_index > 0) && receiver_extended_sequence_numbers;
+
+    result = ert_comm_protocol_transmit_stream_open(context->comm_protocol1, 1, &stream1,
+        ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED);
+    assert(result == 0);
+
+    result = ert_comm_protocol_stream_get_info(stream1, &stream_info);
+    assert(result == 0);
+    assert(stream_info.extended_sequence_numbers == negotiated);
+
+    int loop_count = (stream_index > 0) ? ERT_COMM_PROTOCOL_STREAM_WINDOW_MAX_PACKET_COUNT + 44
+        : ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT;
+
+    ert_log_info("Transmitting %d packets with acks: receiver_extended_sequence_numbers=%d extended_sequence_numbers=%d",
+        loop_count, receiver_extended_sequence_numbers, negotiated);
+
+    for (int i = 0; i < loop_count; i++) {
+      char data[255];
+
+      snprintf(data, 255, "Packet %d", i);
+      result = ert_comm_protocol_test_transmit_stream_write(context->comm_protocol1, stream1, data);
+      assert(result == 0);
+
+      result = ert_comm_protocol_test_transmit_stream_flush(context->comm_protocol1, stream1);
+      assert(result == 0);
+    }
+
+    ert_comm_protocol_test_assert_stream_info_no_errors(stream1);
+
+    result = ert_comm_protocol_stream_get_info(stream1, &stream_info);
+    assert(result == 0);
+    assert(stream_info.extended_sequence_numbers == negotiated);
+    if (negotiated) {
+      assert(stream_info.current_sequence_number > ERT_COMM_PROTOCOL_STREAM_WINDOW_MAX_PACKET_COUNT);
+    }
+
+    result = ert_comm_protocol_transmit_stream_close(context->comm_protocol1, stream1, false);
+    assert(result == 0);
+
+    ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+  }
+
+  result = ert_comm_protocol_get_status(context->comm_protocol1, &status);
+  assert(result == 0);
+  assert(status.retransmitted_packet_count == 0);
+
+  result = ert_comm_protocol_get_status(context->comm_protocol2, &status);
+  assert(result == 0);
+  assert(status.duplicate_received_packet_count == 0);
+  assert(status.received_packet_sequence_number_error_count == 0);
+  assert(status.invalid_received_packet_count == 0);
+
+  sleep(1);
+
+  ert_comm_protocol_test_uninitialize(context);
+}
+
+int ert_comm_protocol_test_get_retransmitted_packet_count(ert_comm_protocol_stream *stream, uint64_t *count_rcv)
+{
+  ert_comm_protocol_stream_info stream_info;
+
+  int result = ert_comm_protocol_stream_get_info(stream, &stream_info);
   if (result < 0) {
-    return EXIT_FAILURE;
+    return result;
   }
 
-  ert_comm_protocol_test_run_test_full_packets_less_than_ack_interval(context);
+  *count_rcv = stream_info.retransmitted_packet_count;
 
-  ert_comm_protocol_test_run_test_short_packets_more_than_ack_interval(context);
+  return 0;
+}
 
-  ert_comm_protocol_test_run_test_two_streams_more_than_ack_interval(context);
+/*
+ * Injects a single acknowledgement packet that references two streams waiting for acks
+ * and verifies that the missing packets of both streams are retransmitted in one pass.
+ */
+void ert_comm_protocol_test_run_test_acknowledgement_for_multiple_streams()
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config;
+  ert_comm_protocol_stream *stream1;
+  ert_comm_protocol_stream *stream2;
+  ert_comm_protocol_stream_info stream_info1;
+  ert_comm_protocol_stream_info stream_info2;
+  int result;
 
-  ert_comm_protocol_test_run_test_multiple_streams_over_one_more_than_ack_interval(context);
+  ert_comm_protocol_create_default_config(&config);
 
-  ert_log_info("Tests finished successfully");
+  result = ert_comm_protocol_test_initialize(&config, &config, &context);
+  assert(result == 0);
 
-  sleep(5);
+  ert_comm_device *device1 = context->comm_transceiver_test_context->device1;
+  ert_driver_comm_device_dummy *driver1 = (ert_driver_comm_device_dummy *) device1->priv;
+
+  // Keep the receiver from seeing any packets so that only the injected acks are handled
+  ert_driver_comm_device_dummy_set_lose_packets(device1, true);
+
+  result = ert_comm_protocol_transmit_stream_open(context->comm_protocol1, 1, &stream1,
+      ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED);
+  assert(result == 0);
+  result = ert_comm_protocol_transmit_stream_open(context->comm_protocol1, 2, &stream2,
+      ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED);
+  assert(result == 0);
+
+  ert_log_info("Transmitting 3 packets in two streams and injecting acks for both streams in one packet...");
+
+  for (int i = 0; i < 3; i++) {
+    char data[255];
+
+    snprintf(data, 255, "Packet %d", i);
+    result = ert_comm_protocol_test_transmit_stream_write(context->comm_protocol1, stream1, data);
+    assert(result == 0);
+    result = ert_comm_protocol_test_transmit_stream_flush(context->comm_protocol1, stream1);
+    assert(result == 0);
+
+    result = ert_comm_protocol_test_transmit_stream_write(context->comm_protocol1, stream2, data);
+    assert(result == 0);
+    result = ert_comm_protocol_test_transmit_stream_flush(context->comm_protocol1, stream2);
+    assert(result == 0);
+  }
+
+  // Closing transmits end of stream packets with sequence number 4 and requests acks for both streams
+  result = ert_comm_protocol_transmit_stream_close(context->comm_protocol1, stream1, false);
+  assert(result == 0);
+
+  // End the receive window of the first ack request immediately, as if no acks were received,
+  // so that the ack request of the second stream is transmitted before the acknowledgement timeout
+  result = ert_comm_transceiver_set_receive_active(context->comm_transceiver_test_context->comm_transceiver1, false);
+  assert(result == 0);
+
+  result = ert_comm_protocol_transmit_stream_close(context->comm_protocol1, stream2, false);
+  assert(result == 0);
+
+  result = ert_comm_protocol_stream_get_info(stream1, &stream_info1);
+  assert(result == 0);
+  assert(stream_info1.ack_request_pending);
+  result = ert_comm_protocol_stream_get_info(stream2, &stream_info2);
+  assert(result == 0);
+  assert(stream_info2.ack_request_pending);
+
+  uint8_t port_stream_id1 = (uint8_t) ((stream_info1.port << 4) | stream_info1.stream_id);
+  uint8_t port_stream_id2 = (uint8_t) ((stream_info2.port << 4) | stream_info2.stream_id);
+
+  // Packets 1-3 of stream 1 and packets 1-2 of stream 2 acknowledged, leaving 1 + 2 packets for retransmission
+  uint8_t ack_packet[] = {
+      0x95, (15 << 4), 1,
+      ERT_COMM_PROTOCOL_PACKET_FLAG_START_OF_STREAM | ERT_COMM_PROTOCOL_PACKET_FLAG_END_OF_STREAM
+      | ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS,
+      port_stream_id1, 1, port_stream_id2, 1, port_stream_id1, 2, port_stream_id2, 2, port_stream_id1, 3,
+  };
+
+  result = driver1->inject(device1, sizeof(ack_packet), ack_packet);
+  assert(result == 0);
+
+  uint64_t retransmitted_packet_count1 = 0;
+  uint64_t retransmitted_packet_count2 = 0;
+
+  // Retransmissions must happen well before the acknowledgement timeout would re-request acks
+  for (int retry_count = 50; retry_count > 0; retry_count--) {
+    result = ert_comm_protocol_test_get_retransmitted_packet_count(stream1, &retransmitted_packet_count1);
+    assert(result == 0);
+    result = ert_comm_protocol_test_get_retransmitted_packet_count(stream2, &retransmitted_packet_count2);
+    assert(result == 0);
+
+    if (retransmitted_packet_count1 == 1 && retransmitted_packet_count2 == 2) {
+      break;
+    }
+
+    usleep(10000);
+  }
+
+  ert_log_info("Retransmitted packets after acks: stream1=%" PRIu64 " stream2=%" PRIu64,
+      retransmitted_packet_count1, retransmitted_packet_count2);
+
+  assert(retransmitted_packet_count1 == 1);
+  assert(retransmitted_packet_count2 == 2);
+
+  result = ert_comm_protocol_stream_get_info(stream1, &stream_info1);
+  assert(result == 0);
+  result = ert_comm_protocol_stream_get_info(stream2, &stream_info2);
+  assert(result == 0);
+  assert(stream_info1.last_acknowledged_sequence_number == 3);
+  assert(stream_info2.last_acknowledged_sequence_number == 2);
+  assert(stream_info1.ack_rerequest_count == 0 && stream_info1.end_of_stream_ack_rerequest_count == 0);
+  assert(stream_info2.ack_rerequest_count == 0 && stream_info2.end_of_stream_ack_rerequest_count == 0);
+
+  // Both streams wait for acks, although acks are requested only with the last retransmitted packet
+  assert(stream_info1.ack_request_pending);
+  assert(stream_info2.ack_request_pending);
+
+  // Streams are closed after the end of stream acknowledgement re-requests fail
+  ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
 
   ert_comm_protocol_test_uninitialize(context);
+}
+
+void ert_comm_protocol_test_wait_for_packets_transmitted(ert_comm_protocol_test_context *context)
+{
+  ert_comm_protocol_status protocol_status;
+  ert_comm_transceiver_status transceiver_status;
+
+  int result = ert_comm_protocol_get_status(context->comm_protocol1, &protocol_status);
+  assert(result == 0);
+
+  uint64_t packet_count = protocol_status.transmitted_packet_count + protocol_status.transmitted_fec_repair_packet_count;
+
+  for (int retry_count = 500; retry_count > 0; retry_count--) {
+    result = ert_comm_transceiver_get_status(context->comm_transceiver_test_context->comm_transceiver1,
+        &transceiver_status);
+    assert(result == 0);
+
+    if (transceiver_status.transmitted_packet_count >= packet_count) {
+      return;
+    }
+
+    usleep(10000);
+  }
+
+  ert_log_error("Packets still waiting for transmission");
+  assert(false);
+}
+
+/*
+ * Loses one packet of each FEC packet group and verifies that the receiver recovers
+ * the lost packets from the repair packets without retransmissions.
+ */
+void ert_comm_protocol_test_run_test_fec_recovery()
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config;
+  ert_comm_protocol_stream *stream1;
+  ert_comm_protocol_stream_info stream_info;
+  ert_comm_protocol_status status;
+  int result;
+
+  ert_comm_protocol_create_default_config(&config);
+
+  result = ert_comm_protocol_test_initialize(&config, &config, &context);
+  assert(result == 0);
+
+  ert_comm_device *device1 = context->comm_transceiver_test_context->device1;
+
+  result = ert_comm_protocol_transmit_stream_open(context->comm_protocol1, 1, &stream1,
+      ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED | ERT_COMM_PROTOCOL_STREAM_FLAG_FEC);
+  assert(result == 0);
+
+  result = ert_comm_protocol_stream_get_info(stream1, &stream_info);
+  assert(result == 0);
+  assert(stream_info.fec);
+
+  int packet_count = ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT;
+
+  ert_log_info("Transmitting %d packets to receive acks signaling FEC support...", packet_count);
+
+  for (int i = 0; i < packet_count; i++) {
+    char data[255];
+
+    snprintf(data, 255, "Packet %d", i);
+    result = ert_comm_protocol_test_transmit_stream_write(context->comm_protocol1, stream1, data);
+    assert(result == 0);
+    result = ert_comm_protocol_test_transmit_stream_flush(context->comm_protocol1, stream1);
+    assert(result == 0);
+  }
+
+  for (int retry_count = 100; retry_count > 0; retry_count--) {
+    result = ert_comm_protocol_stream_get_info(stream1, &stream_info);
+    assert(result == 0);
+
+    if (!stream_info.ack_request_pending) {
+      break;
+    }
+
+    usleep(10000);
+  }
+  assert(!stream_info.ack_request_pending);
+
+  // Let the transmitter finish handling the acks before transmitting new packets
+  sleep(1);
+
+  // The last packet group is left incomplete, so that its repair packet is transmitted before end of stream
+  int lossy_packet_count = packet_count - ERT_COMM_PROTOCOL_STREAM_FEC_GROUP_PACKET_COUNT_DEFAULT / 2;
+  int lost_packet_count = 0;
+
+  ert_log_info("Transmitting %d packets losing one packet of each FEC packet group...", lossy_packet_count);
+
+  for (int i = 0; i < lossy_packet_count; i++) {
+    char data[255];
+    bool lose_packet = (i % ERT_COMM_PROTOCOL_STREAM_FEC_GROUP_PACKET_COUNT_DEFAULT) == 2;
+
+    snprintf(data, 255, "Packet %d", packet_count + i);
+    result = ert_comm_protocol_test_transmit_stream_write(context->comm_protocol1, stream1, data);
+    assert(result == 0);
+
+    if (lose_packet) {
+      ert_comm_protocol_test_wait_for_packets_transmitted(context);
+      ert_driver_comm_device_dummy_set_lose_packets(device1, true);
+    }
+
+    result = ert_comm_protocol_test_transmit_stream_flush(context->comm_protocol1, stream1);
+    assert(result == 0);
+
+    if (lose_packet) {
+      ert_comm_protocol_test_wait_for_packets_transmitted(context);
+      ert_driver_comm_device_dummy_set_lose_packets(device1, false);
+      lost_packet_count++;
+    }
+  }
+
+  result = ert_comm_protocol_transmit_stream_close(context->comm_protocol1, stream1, false);
+  assert(result == 0);
+
+  ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+
+  result = ert_comm_protocol_get_status(context->comm_protocol1, &status);
+  assert(result == 0);
+  ert_log_info("FEC repair packets transmitted: %" PRIu64 ", retransmitted packets: %" PRIu64,
+      status.transmitted_fec_repair_packet_count, status.retransmitted_packet_count);
+  assert(status.transmitted_fec_repair_packet_count >= lost_packet_count);
+  assert(status.retransmitted_packet_count == 0);
+
+  result = ert_comm_protocol_get_status(context->comm_protocol2, &status);
+  assert(result == 0);
+  ert_log_info("FEC recovered packets: %" PRIu64, status.fec_recovered_packet_count);
+  assert(status.fec_recovered_packet_count == lost_packet_count);
+
+  ert_comm_protocol_test_uninitialize(context);
+}
+
+size_t ert_comm_protocol_test_get_active_stream_count(ert_comm_protocol *comm_protocol)
+{
+  size_t stream_info_count;
+  ert_comm_protocol_stream_info *stream_info;
+
+  int result = ert_comm_protocol_get_active_streams(comm_protocol, &stream_info_count, &stream_info);
+  assert(result == 0);
+  free(stream_info);
+
+  return stream_info_count;
+}
+
+/*
+ * Requests acks in one stream and verifies that a packet of another stream is received
+ * while the acks are waiting for the guard interval.
+ */
+void ert_comm_protocol_test_run_test_acknowledgement_guard_interval_does_not_block_receive()
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config;
+  ert_comm_protocol_status status;
+  int result;
+
+  ert_comm_protocol_create_default_config(&config);
+  config.stream_acknowledgement_guard_interval_millis = 1000;
+
+  result = ert_comm_protocol_test_initialize(&config, &config, &context);
+  assert(result == 0);
+
+  ert_comm_device *device2 = context->comm_transceiver_test_context->device2;
+  ert_driver_comm_device_dummy *driver2 = (ert_driver_comm_device_dummy *) device2->priv;
+
+  uint8_t acks_requested_packet[] = {
+      0x95, (1 << 4), 1,
+      ERT_COMM_PROTOCOL_PACKET_FLAG_START_OF_STREAM | ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_ENABLED
+      | ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS,
+      'A', '\0',
+  };
+  uint8_t other_stream_packet[] = {
+      0x95, (2 << 4), 1,
+      ERT_COMM_PROTOCOL_PACKET_FLAG_START_OF_STREAM | ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_ENABLED,
+      'B', '\0',
+  };
+
+  ert_log_info("Injecting a packet requesting acks followed by a packet of another stream...");
+
+  result = driver2->inject(device2, sizeof(acks_requested_packet), acks_requested_packet);
+  assert(result == 0);
+  result = driver2->inject(device2, sizeof(other_stream_packet), other_stream_packet);
+  assert(result == 0);
+
+  for (int retry_count = 50; retry_count > 0; retry_count--) {
+    if (ert_comm_protocol_test_get_active_stream_count(context->comm_protocol2) == 2) {
+      break;
+    }
+
+    usleep(10000);
+  }
+  assert(ert_comm_protocol_test_get_active_stream_count(context->comm_protocol2) == 2);
+
+  // Acks are still waiting for the guard interval
+  result = ert_comm_protocol_get_status(context->comm_protocol2, &status);
+  assert(result == 0);
+  assert(status.transmitted_packet_count == 0);
+
+  uint8_t end_of_stream_packet1[] = {
+      0x95, (1 << 4), 2,
+      ERT_COMM_PROTOCOL_PACKET_FLAG_END_OF_STREAM | ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_ENABLED
+      | ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS,
+  };
+  uint8_t end_of_stream_packet2[] = {
+      0x95, (2 << 4), 2,
+      ERT_COMM_PROTOCOL_PACKET_FLAG_END_OF_STREAM | ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_ENABLED
+      | ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS,
+  };
+
+  result = driver2->inject(device2, sizeof(end_of_stream_packet1), end_of_stream_packet1);
+  assert(result == 0);
+  result = driver2->inject(device2, sizeof(end_of_stream_packet2), end_of_stream_packet2);
+  assert(result == 0);
+
+  // Receive streams are closed by the readers only after the end of stream acks have been sent
+  for (int retry_count = 50; retry_count > 0; retry_count--) {
+    if (ert_comm_protocol_test_get_active_stream_count(context->comm_protocol2) == 0) {
+      break;
+    }
+
+    usleep(100000);
+  }
+  assert(ert_comm_protocol_test_get_active_stream_count(context->comm_protocol2) == 0);
+
+  result = ert_comm_protocol_get_status(context->comm_protocol2, &status);
+  assert(result == 0);
+  ert_log_info("Acknowledgement packets transmitted: %" PRIu64, status.transmitted_packet_count);
+  assert(status.transmitted_packet_count >= 2);
+
+  ert_comm_protocol_test_uninitialize(context);
+}
+
+#define AGGREGATOR_TEST_MESSAGE_COUNT 10
+
+static void ert_comm_protocol_test_aggregator_transmitted(int result, void *message_context, void *callback_context)
+{
+  ert_pipe *transmitted_queue = (ert_pipe *) callback_context;
+
+  assert(result == 0);
+  ert_pipe_push(transmitted_queue, &message_context, 1);
+}
+
+static int ert_comm_protocol_test_aggregator_message(uint32_t length, uint8_t *data, void *callback_context)
+{
+  uint32_t *message_lengths = (uint32_t *) callback_context;
+
+  for (uint32_t i = 0; i < length; i++) {
+    assert(data[i] == (uint8_t) length);
+  }
+
+  message_lengths[message_lengths[0] + 1] = length;
+  message_lengths[0]++;
+
+  return 0;
+}
+
+void ert_comm_protocol_test_run_test_aggregator()
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config;
+  ert_comm_protocol_status status;
+  ert_pipe *transmitted_queue;
+  int result;
+
+  uint8_t aggregated_data[] = {
+      0x02, 0x02, 0x02,
+      0x00,
+      0x81, 0x01,
+  };
+  uint8_t long_message[129];
+  memset(long_message, 129, sizeof(long_message));
+  uint8_t aggregated_data_with_long_message[sizeof(aggregated_data) + sizeof(long_message)];
+  memcpy(aggregated_data_with_long_message, aggregated_data, sizeof(aggregated_data));
+  memcpy(aggregated_data_with_long_message + sizeof(aggregated_data), long_message, sizeof(long_message));
+
+  uint32_t message_lengths[4] = {0};
+  result = ert_comm_protocol_aggregator_split(sizeof(aggregated_data_with_long_message),
+      aggregated_data_with_long_message, ert_comm_protocol_test_aggregator_message, message_lengths);
+  assert(result == 3);
+  assert(message_lengths[0] == 3);
+  assert(message_lengths[1] == 2 && message_lengths[2] == 0 && message_lengths[3] == 129);
+
+  // Truncated message
+  message_lengths[0] = 0;
+  result = ert_comm_protocol_aggregator_split(sizeof(aggregated_data), aggregated_data,
+      ert_comm_protocol_test_aggregator_message, message_lengths);
+  assert(result == -EINVAL);
+
+  ert_comm_protocol_create_default_config(&config);
+
+  result = ert_comm_protocol_test_initialize(&config, &config, &context);
+  assert(result == 0);
+
+  result = ert_pipe_create(sizeof(void *), AGGREGATOR_TEST_MESSAGE_COUNT, &transmitted_queue);
+  assert(result == 0);
+
+  ert_comm_protocol_aggregator_config aggregator_config = {
+      .port = 2,
+      .enable_acks = true,
+      .max_length = ERT_COMM_PROTOCOL_AGGREGATOR_MAX_LENGTH_DEFAULT,
+      .max_delay_millis = 500,
+  };
+
+  ert_comm_protocol_aggregator *aggregator;
+  result = ert_comm_protocol_aggregator_create(context->comm_protocol1, &aggregator_config,
+      ert_comm_protocol_test_aggregator_transmitted, transmitted_queue, &aggregator);
+  assert(result == 0);
+
+  uint8_t too_long_message[ERT_COMM_PROTOCOL_AGGREGATOR_MAX_LENGTH_DEFAULT] = {0};
+  result = ert_comm_protocol_aggregator_add(aggregator, sizeof(too_long_message), too_long_message, NULL);
+  assert(result == -EMSGSIZE);
+
+  ert_log_info("Aggregating %d messages ...", AGGREGATOR_TEST_MESSAGE_COUNT);
+
+  for (uintptr_t i = 0; i < AGGREGATOR_TEST_MESSAGE_COUNT; i++) {
+    char data[32];
+    snprintf(data, sizeof(data), "Message %d", (int) i);
+
+    result = ert_comm_protocol_aggregator_add(aggregator, (uint32_t) strlen(data) + 1, (uint8_t *) data, (void *) i);
+    assert(result == 0);
+  }
+
+  for (uintptr_t i = 0; i < AGGREGATOR_TEST_MESSAGE_COUNT; i++) {
+    void *message_context;
+    ssize_t pop_result = ert_pipe_pop_timed(transmitted_queue, &message_context, 1, 30000);
+    assert(pop_result == 1);
+    assert((uintptr_t) message_context == i);
+  }
+
+  ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+
+  result = ert_comm_protocol_get_status(context->comm_protocol1, &status);
+  assert(result == 0);
+  ert_log_info("Packets transmitted for %d aggregated messages: %" PRIu64,
+      AGGREGATOR_TEST_MESSAGE_COUNT, status.transmitted_packet_count);
+  assert(status.transmitted_packet_count == 1);
+  assert(status.retransmitted_packet_count == 0);
+
+  ert_comm_protocol_aggregator_destroy(aggregator);
+
+  ert_pipe_close(transmitted_queue);
+  ert_pipe_destroy(transmitted_queue);
+
+  ert_comm_protocol_test_uninitialize(context);
+}
+
+#define COMPRESSION_TEST_MESSAGE_COUNT 40
+
+static uint32_t ert_comm_protocol_test_create_telemetry_message(uint32_t index, uint8_t *data)
+{
+  // Sensor data entry serialized with msgpack like in ERTnode telemetry
+  uint8_t message[] = "\x85\xa1i\xce\x00\x01\x00\x00\xa1t\xcd\x00\x05\xa1l\xabTemperature\xa1u\xa4" "degC"
+      "\xa1v\xca\x41\xa0\x00\x00";
+  uint32_t length = sizeof(message) - 1;
+
+  memcpy(data, message, length);
+  data[7] = (uint8_t) index;
+  data[length - 2] = (uint8_t) (index * 7);
+
+  return length;
+}
+
+/*
+ * Compresses telemetry messages and transfers them in a stream opened before and another one opened after
+ * the receiver has signaled support for compression, so that only the latter is compressed.
+ */
+void ert_comm_protocol_test_run_test_compression()
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config1;
+  ert_comm_protocol_config config2;
+  ert_comm_protocol_stream *stream1;
+  ert_comm_protocol_stream_info stream_info;
+  ert_comm_protocol_status status;
+  ert_comm_protocol_compressor *compressor;
+  ert_comm_protocol_decompressor *decompressor;
+  uint8_t data[COMPRESSION_TEST_MESSAGE_COUNT * 64];
+  uint8_t compressed_data[2 * ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_OUTPUT_LENGTH_MAX];
+  uint8_t decompressed_data[sizeof(data)];
+  uint32_t data_length = 0;
+  uint32_t compressed_length = 0;
+  int result;
+
+  result = ert_comm_protocol_compressor_create(&compressor);
+  assert(result == 0);
+  result = ert_comm_protocol_decompressor_create(&decompressor);
+  assert(result == 0);
+
+  for (uint32_t i = 0; i < COMPRESSION_TEST_MESSAGE_COUNT; i++) {
+    uint32_t message_length = ert_comm_protocol_test_create_telemetry_message(i, data + data_length);
+    uint32_t output_length;
+
+    result = ert_comm_protocol_compressor_compress(compressor, message_length, data + data_length,
+        compressed_data + compressed_length, &output_length);
+    assert(result == 0);
+
+    data_length += message_length;
+    compressed_length += output_length;
+  }
+
+  ert_log_info("Compressed %d bytes of telemetry messages to %d bytes", data_length, compressed_length);
+  assert(compressed_length < data_length / 2);
+
+  // Decompress with compressed data and output split in small parts
+  uint32_t input_offset = 0;
+  uint32_t decompressed_length = 0;
+  while (decompressed_length < data_length) {
+    uint32_t output_length;
+    result = ert_comm_protocol_decompressor_decompress(decompressor, 7, decompressed_data + decompressed_length,
+        &output_length);
+    assert(result == 0);
+    decompressed_length += output_length;
+
+    if (decompressed_length < data_length && !ert_comm_protocol_decompressor_has_pending_data(decompressor)) {
+      uint32_t input_length = (compressed_length - input_offset > 5) ? 5 : compressed_length - input_offset;
+      assert(input_length > 0);
+      memcpy(decompressor->input, compressed_data + input_offset, input_length);
+      decompressor->input_offset = 0;
+      decompressor->input_length = input_length;
+      input_offset += input_length;
+    }
+  }
+  assert(input_offset == compressed_length);
+  assert(memcmp(data, decompressed_data, data_length) == 0);
+
+  ert_comm_protocol_compressor_destroy(compressor);
+  ert_comm_protocol_decompressor_destroy(decompressor);
+
+  ert_comm_protocol_create_default_config(&config1);
+  ert_comm_protocol_create_default_config(&config2);
+  config1.stream_compression_ports = ERT_COMM_PROTOCOL_PORT_MASK(1);
+
+  result = ert_comm_protocol_test_initialize(&config1, &config2, &context);
+  assert(result == 0);
+
+  for (int stream_index = 0; stream_index < 2; stream_index++) {
+    bool negotiated = (stream_index > 0);
+
+    result = ert_comm_protocol_transmit_stream_open(context->comm_protocol1, 1, &stream1,
+        ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED);
+    assert(result == 0);
+
+    result = ert_comm_protocol_stream_get_info(stream1, &stream_info);
+    assert(result == 0);
+    assert(stream_info.compressed == negotiated);
+
+    ert_log_info("Transmitting %d telemetry messages with acks: compressed=%d",
+        COMPRESSION_TEST_MESSAGE_COUNT, negotiated);
+
+    for (uint32_t i = 0; i < COMPRESSION_TEST_MESSAGE_COUNT; i++) {
+      uint8_t message[64];
+      uint32_t message_length = ert_comm_protocol_test_create_telemetry_message(i, message);
+      uint32_t bytes_written;
+
+      result = ert_comm_protocol_transmit_stream_write(context->comm_protocol1, stream1, message_length, message,
+          &bytes_written);
+      assert(result == 0);
+      assert(bytes_written == message_length);
+    }
+
+    ert_comm_protocol_test_assert_stream_info_no_errors(stream1);
+
+    result = ert_comm_protocol_stream_get_info(stream1, &stream_info);
+    assert(result == 0);
+    if (negotiated) {
+      assert(stream_info.uncompressed_data_bytes == data_length);
+      assert(stream_info.compressed_data_bytes == compressed_length);
+      assert(stream_info.transferred_payload_data_bytes < data_length / 2);
+    }
+
+    result = ert_comm_protocol_transmit_stream_close(context->comm_protocol1, stream1, false);
+    assert(result == 0);
+
+    ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+  }
+
+  result = ert_comm_protocol_get_status(context->comm_protocol1, &status);
+  assert(result == 0);
+  ert_log_info("Compression ratio %f, CPU time %" PRIu64 " ns", status.compression_ratio,
+      status.compression_cpu_time_nanos);
+  assert(status.compression_uncompressed_data_bytes == data_length);
+  assert(status.compression_compressed_data_bytes == compressed_length);
+  assert(status.compression_ratio > 0 && status.compression_ratio < 0.5);
+  assert(status.retransmitted_packet_count == 0);
+
+  // The receiver decompresses the data when the stream is read
+  for (int i = 0; i < 50; i++) {
+    result = ert_comm_protocol_get_status(context->comm_protocol2, &status);
+    assert(result == 0);
+    if (status.decompression_uncompressed_data_bytes == data_length) {
+      break;
+    }
+    usleep(100000);
+  }
+
+  assert(status.decompression_uncompressed_data_bytes == data_length);
+  assert(status.decompression_compressed_data_bytes == compressed_length);
+  assert(status.duplicate_received_packet_count == 0);
+  assert(status.received_packet_sequence_number_error_count == 0);
+  assert(status.invalid_received_packet_count == 0);
+
+  ert_comm_protocol_test_uninitialize(context);
+}
+
+#define LINK_ADAPTATION_TEST_WRITE_COUNT_MAX 4000
+
+/*
+ * Writes packets until the data rates of both ends match the expected one. The data rate only changes
+ * when link reports are exchanged in acknowledgements, so it is checked between writes.
+ */
+static void ert_comm_protocol_test_wait_for_data_rate(ert_comm_protocol_test_context *context,
+    ert_comm_protocol_stream *stream, ert_comm_link_adaptation *link_adaptation1,
+    ert_comm_link_adaptation *link_adaptation2, uint8_t expected_data_rate_index)
+{
+  for (int i = 0; i < LINK_ADAPTATION_TEST_WRITE_COUNT_MAX; i++) {
+    if (ert_comm_link_adaptation_get_data_rate_index(link_adaptation1) == expected_data_rate_index
+        && ert_comm_link_adaptation_get_data_rate_index(link_adaptation2) == expected_data_rate_index) {
+      return;
+    }
+
+    char data[255];
+    snprintf(data, 255, "Write %d:data1data2data3data4data5data6data7data8data9data10data11data12:", i);
+
+    int result = ert_comm_protocol_test_transmit_stream_write(context->comm_protocol1, stream, data);
+    assert(result == 0);
+  }
+
+  ert_log_error("Data rates did not converge: data_rate_index1=%d data_rate_index2=%d expected=%d",
+      ert_comm_link_adaptation_get_data_rate_index(link_adaptation1),
+      ert_comm_link_adaptation_get_data_rate_index(link_adaptation2), expected_data_rate_index);
+  assert(false);
+}
+
+void ert_comm_protocol_test_run_test_link_adaptation()
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config;
+  ert_comm_link_adaptation_config link_adaptation_config;
+  ert_comm_link_adaptation *link_adaptation1;
+  ert_comm_link_adaptation *link_adaptation2;
+  ert_comm_link_adaptation_status status;
+  ert_comm_protocol_stream *stream1;
+
+  ert_comm_protocol_create_default_config(&config);
+  ert_comm_link_adaptation_create_default_config(&link_adaptation_config);
+  link_adaptation_config.enabled = true;
+
+  int result = ert_comm_protocol_test_initialize(&config, &config, &context);
+  assert(result == 0);
+
+  result = ert_comm_link_adaptation_create(&link_adaptation_config, NULL, NULL, &link_adaptation1);
+  assert(result == 0);
+  result = ert_comm_link_adaptation_create(&link_adaptation_config, NULL, NULL, &link_adaptation2);
+  assert(result == 0);
+
+  ert_comm_protocol_set_link_adaptation(context->comm_protocol1, link_adaptation1);
+  ert_comm_protocol_set_link_adaptation(context->comm_protocol2, link_adaptation2);
+
+  ert_comm_device *device1 = context->comm_transceiver_test_context->device1;
+  ert_comm_device *device2 = context->comm_transceiver_test_context->device2;
+
+  result = ert_comm_protocol_transmit_stream_open(context->comm_protocol1, 1, &stream1,
+      ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED);
+  assert(result == 0);
+
+  ert_log_info("Good link, expecting both ends to switch to the fastest data rate");
+  ert_driver_comm_device_dummy_set_link_quality(device1, -90.0f, 8.0f);
+  ert_driver_comm_device_dummy_set_link_quality(device2, -90.0f, 8.0f);
+
+  ert_comm_protocol_test_wait_for_data_rate(context, stream1, link_adaptation1, link_adaptation2,
+      (uint8_t) (link_adaptation_config.data_rate_count - 1));
+
+  ert_log_info("Weak link, expecting both ends to switch to a more robust data rate");
+  ert_driver_comm_device_dummy_set_link_quality(device1, -125.0f, -12.0f);
+  ert_driver_comm_device_dummy_set_link_quality(device2, -125.0f, -12.0f);
+
+  // SF10 is the fastest data rate with its required SNR of -15 dB within the margin
+  ert_comm_protocol_test_wait_for_data_rate(context, stream1, link_adaptation1, link_adaptation2, 2);
+
+  result = ert_comm_protocol_test_transmit_stream_flush(context->comm_protocol1, stream1);
+  assert(result == 0);
+
+  ert_comm_protocol_test_assert_stream_info_no_errors(stream1);
+
+  result = ert_comm_protocol_transmit_stream_close(context->comm_protocol1, stream1, false);
+  assert(result == 0);
+
+  ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+
+  ert_comm_link_adaptation_get_status(link_adaptation1, &status);
+  assert(status.received_report_count > 0);
+  assert(status.data_rate_decrease_count > 0);
+  // Reported link quality is smoothed, so it approaches the weak link values gradually
+  assert(status.reported_snr < -5.0f && status.reported_snr > -12.5f);
+  assert(status.reported_rssi < -100.0f && status.reported_rssi > -125.5f);
+
+  ert_comm_link_adaptation_get_status(link_adaptation2, &status);
+  assert(status.sent_report_count > 0);
+  assert(status.received_packet_count > 0);
+
+  ert_comm_protocol_test_uninitialize(context);
+
+  ert_comm_link_adaptation_destroy(link_adaptation2);
+  ert_comm_link_adaptation_destroy(link_adaptation1);
+}
+
+static void ert_comm_protocol_test_write_file(const char *filename, size_t length, uint8_t *data)
+{
+  FILE *file = fopen(filename, "w");
+  assert(file != NULL);
+  size_t file_result = fwrite(data, 1, length, file);
+  assert(file_result == length);
+  fclose(file);
+}
+
+static void ert_comm_protocol_test_assert_file_contents(const char *filename, size_t length, uint8_t *data)
+{
+  uint8_t file_data[length + 1];
+
+  FILE *file = fopen(filename, "r");
+  assert(file != NULL);
+  size_t file_result = fread(file_data, 1, length + 1, file);
+  assert(file_result == length);
+  fclose(file);
+  assert(memcmp(file_data, data, length) == 0);
+}
+
+/*
+ * Transfers a file while all acknowledgements of the receiver, including the final one, are lost.
+ * The receiver reports the complete transfer with its status, so the file is neither transmitted again
+ * nor received twice.
+ */
+void ert_comm_protocol_test_run_test_file_transfer_final_acknowledgement_lost()
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config;
+  ert_comm_protocol_file_transfer_info transfer_info;
+  ert_comm_protocol_stream *stream;
+  volatile bool running = true;
+  uint32_t transfer_id = 7;
+  int result;
+
+  ert_comm_protocol_create_default_config(&config);
+
+  result = ert_comm_protocol_test_initialize(&config, &config, &context);
+  assert(result == 0);
+
+  ert_comm_device *device2 = context->comm_transceiver_test_context->device2;
+
+  char path[] = "/tmp/ert-comm-protocol-test-XXXXXX";
+  char *path_result = mkdtemp(path);
+  assert(path_result != NULL);
+
+  char filename[PATH_MAX];
+  snprintf(filename, sizeof(filename), "%s/image.jpg", path);
+
+  uint8_t file_data[4000];
+  for (size_t i = 0; i < sizeof(file_data); i++) {
+    file_data[i] = (uint8_t) (i * 7);
+  }
+
+  ert_comm_protocol_test_write_file(filename, sizeof(file_data), file_data);
+
+  uint32_t total_length;
+  result = ert_comm_protocol_get_file_transfer_total_length(filename, 0, &total_length);
+  assert(result == 0);
+  assert(total_length == sizeof(file_data));
+
+  ert_log_info("Transferring file losing all acknowledgements of the receiver ...");
+
+  ert_driver_comm_device_dummy_set_lose_packets(device2, true);
+
+  result = ert_comm_protocol_transmit_file_transfer(context->comm_protocol1, ERT_COMM_PROTOCOL_TEST_PORT_FILE_TRANSFER,
+      transfer_id, 0, filename, 0, NULL, &running);
+  assert(result == 0);
+
+  // Without the final acknowledgement the transmit stream is closed after the acknowledgement re-requests
+  ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+  ert_driver_comm_device_dummy_set_lose_packets(device2, false);
+
+  ert_comm_protocol_status status;
+  ert_comm_protocol_get_status(context->comm_protocol1, &status);
+  assert(status.received_packet_count == 0);
+  assert(status.retransmitted_packet_count > 0);
+
+  ssize_t pop_result = ert_pipe_pop_timed(context->comm_protocol2_test_protocol_context->file_transfer_stream_queue,
+      &stream, 1, 1000);
+  assert(pop_result == 1);
+  result = ert_comm_protocol_receive_file_transfer(context->comm_protocol2, stream, path, &running, &transfer_info);
+  assert(result == 0);
+  assert(transfer_info.complete);
+  assert(transfer_info.transfer_id == transfer_id);
+  assert(transfer_info.received_length == total_length);
+
+  // Like the node waiting for the status and the gateway transmitting it while receiving continuously
+  ert_comm_transceiver *comm_transceiver1 = context->comm_transceiver_test_context->comm_transceiver1;
+  ert_comm_transceiver *comm_transceiver2 = context->comm_transceiver_test_context->comm_transceiver2;
+  ert_comm_transceiver_set_receive_active(comm_transceiver1, true);
+  ert_comm_transceiver_set_receive_active(comm_transceiver2, false);
+
+  result = ert_comm_protocol_transmit_file_transfer_status(context->comm_protocol2,
+      ERT_COMM_PROTOCOL_TEST_PORT_FILE_TRANSFER_STATUS, transfer_info.transfer_id, transfer_info.received_length);
+  assert(result == 0);
+
+  ert_comm_transceiver_set_receive_active(comm_transceiver2, true);
+
+  char received_filename[PATH_MAX];
+  snprintf(received_filename, sizeof(received_filename), "%s/received.jpg", path);
+  result = rename(transfer_info.filename, received_filename);
+  assert(result == 0);
+
+  // The status reporting the total length keeps the node from retransmitting the transfer
+  uint32_t status_transfer_id;
+  uint32_t received_length;
+  pop_result = ert_pipe_pop_timed(context->comm_protocol1_test_protocol_context->file_transfer_stream_queue,
+      &stream, 1, 5000);
+  assert(pop_result == 1);
+  result = ert_comm_protocol_receive_file_transfer_status(context->comm_protocol1, stream, &running,
+      &status_transfer_id, &received_length);
+  ert_comm_protocol_receive_stream_close(context->comm_protocol1, stream);
+  assert(result == 0);
+  assert(status_transfer_id == transfer_id);
+  assert(received_length == total_length);
+
+  ert_comm_transceiver_set_receive_active(comm_transceiver1, false);
+
+  // No further transfer streams are received
+  pop_result = ert_pipe_pop_timed(context->comm_protocol2_test_protocol_context->file_transfer_stream_queue,
+      &stream, 1, 2000);
+  assert(pop_result < 1);
+
+  ert_comm_protocol_test_assert_file_contents(received_filename, sizeof(file_data), file_data);
+
+  unlink(received_filename);
+  unlink(filename);
+  rmdir(path);
+
+  ert_comm_protocol_test_uninitialize(context);
+}
+
+/*
+ * Resumes a transfer whose partial file at the receiver was left behind by a transfer with the same ID
+ * but a different total length. The stale data is discarded and the transfer is restarted from the beginning.
+ */
+void ert_comm_protocol_test_run_test_file_transfer_total_length_mismatch()
+{
+  ert_comm_protocol_test_context *context;
+  ert_comm_protocol_config config;
+  ert_comm_protocol_file_transfer_info transfer_info;
+  ert_comm_protocol_stream *stream;
+  volatile bool running = true;
+  uint32_t transfer_id = 8;
+  int result;
+
+  ert_comm_protocol_create_default_config(&config);
+
+  result = ert_comm_protocol_test_initialize(&config, &config, &context);
+  assert(result == 0);
+
+  char path[] = "/tmp/ert-comm-protocol-test-XXXXXX";
+  char *path_result = mkdtemp(path);
+  assert(path_result != NULL);
+
+  uint8_t file_data[2000];
+  for (size_t i = 0; i < sizeof(file_data); i++) {
+    file_data[i] = (uint8_t) (i * 3);
+  }
+
+  char filename[PATH_MAX];
+  snprintf(filename, sizeof(filename), "%s/image.jpg", path);
+  ert_comm_protocol_test_write_file(filename, sizeof(file_data), file_data);
+
+  uint8_t stale_data[1000];
+  memset(stale_data, 0xAA, sizeof(stale_data));
+
+  char stale_filename[PATH_MAX];
+  snprintf(stale_filename, sizeof(stale_filename), "%s/transfer-%u-%u.partial", path, transfer_id, 3000);
+  ert_comm_protocol_test_write_file(stale_filename, sizeof(stale_data), stale_data);
+
+  ert_log_info("Resuming file transfer with a stale partial file of another total length ...");
+
+  result = ert_comm_protocol_transmit_file_transfer(context->comm_protocol1, ERT_COMM_PROTOCOL_TEST_PORT_FILE_TRANSFER,
+      transfer_id, 500, filename, 0, NULL, &running);
+  assert(result == 0);
+
+  ssize_t pop_result = ert_pipe_pop_timed(context->comm_protocol2_test_protocol_context->file_transfer_stream_queue,
+      &stream, 1, 5000);
+  assert(pop_result == 1);
+  result = ert_comm_protocol_receive_file_transfer(context->comm_protocol2, stream, path, &running, &transfer_info);
+  assert(result == -ERANGE);
+  assert(!transfer_info.complete);
+  assert(transfer_info.total_length == sizeof(file_data));
+  assert(transfer_info.received_length == 0);
+
+  struct stat st;
+  result = stat(stale_filename, &st);
+  assert(result < 0);
+
+  ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+
+  // The received length of 0 makes the sender restart the transfer
+  result = ert_comm_protocol_transmit_file_transfer(context->comm_protocol1, ERT_COMM_PROTOCOL_TEST_PORT_FILE_TRANSFER,
+      transfer_id, 0, filename, 0, NULL, &running);
+  assert(result == 0);
+
+  pop_result = ert_pipe_pop_timed(context->comm_protocol2_test_protocol_context->file_transfer_stream_queue,
+      &stream, 1, 5000);
+  assert(pop_result == 1);
+  result = ert_comm_protocol_receive_file_transfer(context->comm_protocol2, stream, path, &running, &transfer_info);
+  assert(result == 0);
+  assert(transfer_info.complete);
+  assert(transfer_info.received_length == sizeof(file_data));
+
+  ert_comm_protocol_test_assert_file_contents(transfer_info.filename, sizeof(file_data), file_data);
+
+  ert_comm_protocol_test_wait_for_transmit_streams_closed(context->comm_protocol1);
+
+  unlink(transfer_info.filename);
+  unlink(filename);
+  rmdir(path);
+
+  ert_comm_protocol_test_uninitialize(context);
+}
+
+int main(void)
+{
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_comm_protocol_config config;
+  ert_comm_protocol_create_default_config(&config);
+
+  ert_comm_protocol_test_context *context;
+  result = ert_comm_protocol_test_initialize(&config, &config, &context);
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_comm_protocol_test_run_test_full_packets_less_than_ack_interval(context);
+
+  ert_comm_protocol_test_run_test_short_packets_more_than_ack_interval(context);
+
+  ert_comm_protocol_test_run_test_two_streams_more_than_ack_interval(context);
+
+  ert_comm_protocol_test_run_test_multiple_streams_over_one_more_than_ack_interval(context);
+
+  sleep(5);
+
+  ert_comm_protocol_test_uninitialize(context);
+
+  ert_comm_protocol_test_run_test_acknowledgement_encoding_interoperability();
+
+  ert_comm_protocol_test_run_test_extended_sequence_numbers(true);
+
+  ert_comm_protocol_test_run_test_extended_sequence_numbers(false);
+
+  ert_comm_protocol_test_run_test_acknowledgement_for_multiple_streams();
+
+  ert_comm_protocol_test_run_test_fec_recovery();
+
+  ert_comm_protocol_test_run_test_acknowledgement_guard_interval_does_not_block_receive();
+
+  ert_comm_protocol_test_run_test_file_transfer_final_acknowledgement_lost();
+
+  ert_comm_protocol_test_run_test_file_transfer_total_length_mismatch();
+
+  ert_comm_protocol_test_run_test_aggregator();
+
+  ert_comm_protocol_test_run_test_compression();
+
+  ert_comm_protocol_test_run_test_link_adaptation();
+
+  ert_log_info("Tests finished successfully");
 
   ert_test_uninit();
 
@@ -21,8 +21,13 @@
 #include "ert-log.h"
 #include "ert-time.h"
 #include "ert-comm-protocol.h"
+#include "ert-comm-protocol-compression.h"
+#include "ert-spsc-ring-buffer.h"
 
 #define ERT_COMM_PROTOCOL_PACKET_IDENTIFIER 0x95
+#define ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_EXTENDED 0x96
+#define ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED 0x97
+#define ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED_EXTENDED 0x98
 
 #define ERT_COMM_PROTOCOL_STREAM_PORT_ACKNOWLEDGEMENTS 15
 
@@ -33,7 +38,29 @@
 #define ert_comm_protocol_packet_set_stream_id(stream_id) (stream_id & 0x0F)
 
 #define ERT_COMM_PROTOCOL_SEQUENCE_NUMBER_COUNT 0x100
-#define ert_comm_protocol_get_next_sequence_number(current_sequence_number) ((current_sequence_number + 1) % ERT_COMM_PROTOCOL_SEQUENCE_NUMBER_COUNT)
+#define ERT_COMM_PROTOCOL_EXTENDED_SEQUENCE_NUMBER_COUNT 0x10000
+
+// Packet history and acknowledgements are indexed by the low byte of the sequence number,
+// which limits the number of unacknowledged packets in a stream
+#define ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT 0x100
+
+/*
+ * Acknowledgement packets do not use the flag enabling acks, so a receiver sets it in acknowledgement packets
+ * to signal support for extended sequence numbers.
+ */
+#define ERT_COMM_PROTOCOL_PACKET_FLAG_EXTENDED_SEQUENCE_NUMBERS_SUPPORTED ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_ENABLED
+
+/*
+ * Acknowledgement packets are never retransmitted, so a receiver sets the retransmit flag in acknowledgement packets
+ * to signal support for compressed streams.
+ */
+#define ERT_COMM_PROTOCOL_PACKET_FLAG_COMPRESSION_SUPPORTED ERT_COMM_PROTOCOL_PACKET_FLAG_RETRANSMIT
+
+/*
+ * Acknowledgement packets never request acks, so a receiver using link adaptation sets the flag requesting acks
+ * in acknowledgement packets that end with a link report.
+ */
+#define ERT_COMM_PROTOCOL_PACKET_FLAG_LINK_REPORT ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS
 
 typedef struct _ert_comm_protocol_packet_header {
   uint8_t identifier;
@@ -42,15 +69,79 @@ typedef struct _ert_comm_protocol_packet_header {
   uint8_t flags;
 } __attribute__((packed, aligned(1))) ert_comm_protocol_packet_header;
 
+/*
+ * Packets of streams using extended sequence numbers are identified by a different packet identifier
+ * and the header is followed by the high byte of the 16-bit sequence number. Packets of compressed streams
+ * are identified by the compressed variants of both identifiers, as all packet flags are in use.
+ */
+typedef struct _ert_comm_protocol_packet_header_extended {
+  ert_comm_protocol_packet_header header;
+  uint8_t sequence_number_high;
+} __attribute__((packed, aligned(1))) ert_comm_protocol_packet_header_extended;
+
 typedef struct _ert_comm_protocol_packet_acknowledgement {
   uint8_t port_stream_id;
   uint8_t sequence_number;
 } __attribute__((packed, aligned(1))) ert_comm_protocol_packet_acknowledgement;
 
+/*
+ * Bitmap-encoded acknowledgements: bit n of the bitmap (LSB first) that follows the header
+ * acknowledges the packet with sequence number sequence_number + n.
+ */
+typedef struct _ert_comm_protocol_packet_acknowledgement_bitmap {
+  uint8_t port_stream_id;
+  uint8_t sequence_number;
+  uint8_t bitmap_length;
+} __attribute__((packed, aligned(1))) ert_comm_protocol_packet_acknowledgement_bitmap;
+
+#define ERT_COMM_PROTOCOL_ACKNOWLEDGEMENT_BITMAP_LENGTH (ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT / 8)
+
+/*
+ * Acknowledgements of streams using extended sequence numbers are sent in packets with the extended header.
+ * All packets up to and including cumulative_sequence_number have been received and the bitmap that follows
+ * acknowledges packets received after it like in the bitmap encoding. An acknowledgement packet lost on the way
+ * is thus covered by the next one.
+ */
+typedef struct _ert_comm_protocol_packet_acknowledgement_extended {
+  uint8_t port_stream_id;
+  uint8_t cumulative_sequence_number_low;
+  uint8_t cumulative_sequence_number_high;
+  uint8_t sequence_number_low;
+  uint8_t sequence_number_high;
+  uint8_t bitmap_length;
+} __attribute__((packed, aligned(1))) ert_comm_protocol_packet_acknowledgement_extended;
+
+/*
+ * FEC repair packet payload: the repair data that follows is the XOR of the payloads of all packets
+ * in the packet group, each padded with zeroes to the length of the longest payload. The sequence number
+ * in the header of the repair packet is the sequence number of the first packet in the group.
+ */
+typedef struct _ert_comm_protocol_packet_fec_repair {
+  uint8_t packet_count;
+  uint8_t flags;
+  uint8_t payload_length;
+} __attribute__((packed, aligned(1))) ert_comm_protocol_packet_fec_repair;
+
+/*
+ * Link report at the end of an acknowledgement packet: the index of the data rate in the link adaptation
+ * data rate table that both ends switch to, the smoothed SNR in quarter dB and the smoothed RSSI negated in dBm.
+ */
+typedef struct _ert_comm_protocol_packet_link_report {
+  uint8_t data_rate_index;
+  int8_t snr_quarter_db;
+  uint8_t rssi_negated;
+} __attribute__((packed, aligned(1))) ert_comm_protocol_packet_link_report;
+
+#define ERT_COMM_PROTOCOL_FEC_MAX_PACKET_LENGTH (sizeof(ert_comm_protocol_packet_header) \
+    + sizeof(ert_comm_protocol_packet_fec_repair) + UINT8_MAX)
+#define ERT_COMM_PROTOCOL_FEC_PACKET_SEQUENCE_NUMBER_NONE -1
+
 typedef struct _ert_comm_protocol_packet_info {
   uint16_t stream_id;
   uint16_t port;
   uint32_t sequence_number;
+  bool extended_sequence_numbers;
+  bool compressed;
 
   bool start_of_stream;
   bool end_of_stream;
@@ -58,14 +149,30 @@ typedef struct _ert_comm_protocol_packet_info {
   bool request_acks;
   bool retransmit;
   bool acks;
+  bool acks_bitmap;
+  bool fec;
 
   uint32_t raw_packet_length;
   uint8_t *raw_packet_data;
 
+  uint32_t header_length;
   uint32_t payload_length;
   uint8_t *payload;
 } ert_comm_protocol_packet_info;
 
+#define ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE -1
+
+/*
+ * Packet history is indexed directly by sequence number: the slot of a packet is its sequence number
+ * and the slots in use are linked in the order the packets were pushed.
+ */
+typedef struct _ert_comm_protocol_packet_history_entry {
+  uint32_t data_length;
+  uint8_t *data;
+  int32_t previous_slot;
+  int32_t next_slot;
+} ert_comm_protocol_packet_history_entry;
+
 struct _ert_comm_protocol_stream {
   ert_comm_protocol_stream_info info;
 
@@ -76,14 +183,61 @@ struct _ert_comm_protocol_stream {
   pthread_mutex_t mutex;
   pthread_cond_t change_cond;
 
+  // Packet assembly buffer of a transmit stream
   ert_ring_buffer *ring_buffer;
+  // Received data of a receive stream, written by the receive callback with the stream mutex locked
+  // and read without locking it
+  ert_spsc_ring_buffer *receive_buffer;
 
   ert_buffer_pool *packet_history_buffer_pool;
-  uint32_t acknowledgement_interval_packet_count;
-  uint32_t *packet_history_data_length;
-  uint8_t **packet_history_pointers;
-
-  ert_comm_protocol_packet_acknowledgement *acknowledgements;
+  // Maximum number of packets between acknowledgements or in the window of streams using extended sequence numbers,
+  // which is the capacity of packet history and acknowledgements
+  uint32_t acknowledgement_window_packet_count;
+  uint32_t packet_history_count;
+  int32_t packet_history_first_slot;
+  int32_t packet_history_last_slot;
+  ert_comm_protocol_packet_history_entry *packet_history;
+
+  uint32_t acknowledgement_count;
+  uint8_t acknowledgement_bitmap[ERT_COMM_PROTOCOL_ACKNOWLEDGEMENT_BITMAP_LENGTH];
+  // Set when the latest packet of a receive stream was a retransmission, i.e. the transmitter is recovering the stream
+  bool retransmission_received;
+
+  // Set on a receive stream when the transmitter has requested acks that are sent after the guard interval
+  bool acknowledgement_send_pending;
+  // Set on a transmit stream when acks have been received and the stream is processed after the guard interval,
+  // retransmitting packet history if the stream had requested acks
+  bool acknowledgement_processing_pending;
+  bool acknowledgement_retransmit_pending;
+
+  // Maximum number of unacknowledged packets in a transmit stream
+  uint32_t transmit_window_packet_count;
+
+  // Round-trip time and packet loss of a transmit stream are measured for the latest acknowledgement request
+  struct timespec acknowledgement_request_timestamp;
+  uint32_t acknowledgement_request_sequence_number;
+  bool acknowledgement_request_repeated;
+  uint64_t acknowledgement_request_transferred_packet_count;
+  uint32_t acknowledgement_request_packet_count;
+  uint32_t acknowledged_packet_count;
+  // Smoothed packet counts weight the packet loss ratio by the number of packets of each ack request
+  float smoothed_request_packet_count;
+  float smoothed_lost_packet_count;
+
+  // A transmit stream builds the FEC repair packet of the current packet group in the buffer, a receive stream
+  // keeps the latest packets in it indexed by sequence number for recovering a lost packet of a group
+  uint8_t *fec_packet_buffer;
+  uint32_t fec_group_packet_count;
+  uint32_t fec_group_max_payload_length;
+  uint32_t fec_packet_lengths[ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT];
+  int32_t fec_packet_sequence_numbers[ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT];
+
+  // Allocated only when compression is enabled: the ring buffer of a compressed receive stream holds compressed data
+  ert_comm_protocol_compressor *compressor;
+  ert_comm_protocol_decompressor *decompressor;
+
+  // Set on an acknowledgement stream when its single packet ends with a link report
+  bool link_report;
 };
 
 struct _ert_comm_protocol {
@@ -109,7 +263,18 @@ struct _ert_comm_protocol {
   ert_comm_protocol_stream_listener_callback stream_listener_callback;
   void *stream_listener_callback_context;
 
+  // Set when the receiver has signaled support for FEC repair packets in acknowledgements
+  volatile bool fec_peer_supported;
+  // Set when the receiver has signaled support for extended sequence numbers in acknowledgements
+  volatile bool extended_sequence_numbers_peer_supported;
+  // Set when the receiver has signaled support for compressed streams in acknowledgements
+  volatile bool compression_peer_supported;
+
+  // Data rate selection based on link reports in acknowledgements, NULL if not in use
+  ert_comm_link_adaptation *link_adaptation;
+
   timer_t acknowledgement_timeout_timer;
+  timer_t acknowledgement_guard_timer;
   timer_t stream_inactivity_check_timer;
 };
 
@@ -121,45 +286,127 @@ typedef enum _ert_comm_protocol_counter_type {
   ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_DUPLICATE,
   ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_SEQUENCE_NUMBER_ERROR,
   ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_INVALID,
+  ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT_FEC_REPAIR,
+  ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_FEC_REPAIR,
+  ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_FEC_RECOVERED,
 } ert_comm_protocol_counter_type;
 
 static const uint8_t ert_comm_protocol_packet_header_length = sizeof(ert_comm_protocol_packet_header);
+static const uint8_t ert_comm_protocol_packet_header_extended_length = sizeof(ert_comm_protocol_packet_header_extended);
 
-static void ert_comm_protocol_log_packet_info_do(ert_log_level level, ert_comm_protocol_packet_info *info, char *format, va_list argp)
+static inline bool ert_comm_protocol_packet_is_valid_identifier(uint8_t identifier)
 {
-  char formatted_message[1024];
+  return identifier >= ERT_COMM_PROTOCOL_PACKET_IDENTIFIER
+      && identifier <= ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED_EXTENDED;
+}
 
-  vsnprintf(formatted_message, 1024, format, argp);
+static inline bool ert_comm_protocol_packet_is_extended(uint8_t *data)
+{
+  uint8_t identifier = ((ert_comm_protocol_packet_header *) data)->identifier;
+  return identifier == ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_EXTENDED
+      || identifier == ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED_EXTENDED;
+}
 
-  ert_log_with_level(level, "%s - packet: stream_id=%d port=%d sequence_number=%d start_of_stream=%d end_of_stream=%d "
-      "acks_enabled=%d request_acks=%d retransmit=%d acks=%d raw_packet_length=%d payload_length=%d",
-      formatted_message, info->stream_id, info->port, info->sequence_number, info->start_of_stream, info->end_of_stream,
-      info->acks_enabled, info->request_acks, info->retransmit, info->acks, info->raw_packet_length,
-      info->payload_length);
+static inline bool ert_comm_protocol_packet_is_compressed(uint8_t *data)
+{
+  uint8_t identifier = ((ert_comm_protocol_packet_header *) data)->identifier;
+  return identifier == ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED
+      || identifier == ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED_EXTENDED;
+}
+
+static inline uint32_t ert_comm_protocol_packet_get_header_length(uint8_t *data)
+{
+  return ert_comm_protocol_packet_is_extended(data)
+      ? ert_comm_protocol_packet_header_extended_length : ert_comm_protocol_packet_header_length;
 }
 
-static void ert_comm_protocol_log_packet_info(ert_log_level level, ert_comm_protocol_packet_info *info, char *format, ...)
+static inline uint32_t ert_comm_protocol_packet_get_sequence_number(uint8_t *data)
 {
-  if (level == ERT_LOG_LEVEL_DEBUG) {
-#ifdef ERTLIB_ENABLE_LOG_DEBUG
-    va_list argp;
-    va_start(argp, format);
-    ert_comm_protocol_log_packet_info_do(level, info, format, argp);
-    va_end(argp);
-#endif
+  ert_comm_protocol_packet_header_extended *header = (ert_comm_protocol_packet_header_extended *) data;
+
+  if (ert_comm_protocol_packet_is_extended(data)) {
+    return (uint32_t) header->header.sequence_number | ((uint32_t) header->sequence_number_high << 8);
+  }
+
+  return header->header.sequence_number;
+}
+
+static inline void ert_comm_protocol_packet_set_header(uint8_t *data, bool extended_sequence_numbers, bool compressed,
+    uint8_t port_stream_id, uint32_t sequence_number, uint8_t flags)
+{
+  ert_comm_protocol_packet_header_extended *header = (ert_comm_protocol_packet_header_extended *) data;
+
+  if (compressed) {
+    header->header.identifier = extended_sequence_numbers
+        ? ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED_EXTENDED : ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED;
   } else {
-    va_list argp;
-    va_start(argp, format);
-    ert_comm_protocol_log_packet_info_do(level, info, format, argp);
-    va_end(argp);
+    header->header.identifier = extended_sequence_numbers
+        ? ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_EXTENDED : ERT_COMM_PROTOCOL_PACKET_IDENTIFIER;
+  }
+  header->header.port_stream_id = port_stream_id;
+  header->header.sequence_number = (uint8_t) (sequence_number & 0xFF);
+  header->header.flags = flags;
+
+  if (extended_sequence_numbers) {
+    header->sequence_number_high = (uint8_t) ((sequence_number >> 8) & 0xFF);
   }
 }
 
-static void ert_comm_protocol_log_stream_info_do(ert_log_level level, ert_comm_protocol_stream_info *info, char *format, va_list argp)
+static inline uint32_t ert_comm_protocol_stream_get_header_length(ert_comm_protocol_stream *stream)
+{
+  return stream->info.extended_sequence_numbers
+      ? ert_comm_protocol_packet_header_extended_length : ert_comm_protocol_packet_header_length;
+}
+
+static inline uint32_t ert_comm_protocol_stream_get_sequence_number_count(ert_comm_protocol_stream *stream)
+{
+  return stream->info.extended_sequence_numbers
+      ? ERT_COMM_PROTOCOL_EXTENDED_SEQUENCE_NUMBER_COUNT : ERT_COMM_PROTOCOL_SEQUENCE_NUMBER_COUNT;
+}
+
+static inline uint32_t ert_comm_protocol_stream_get_next_sequence_number(ert_comm_protocol_stream *stream,
+    uint32_t sequence_number)
+{
+  return (sequence_number + 1) % ert_comm_protocol_stream_get_sequence_number_count(stream);
+}
+
+/**
+ * Logs the message followed by the packet info. Called through ert_comm_protocol_log_packet_info,
+ * which skips formatting when the log level is disabled.
+ */
+static void ert_comm_protocol_log_packet_info_do(ert_log_level level, ert_comm_protocol_packet_info *info,
+    const char *format, ...)
+{
+  char formatted_message[1024];
+  va_list argp;
+
+  va_start(argp, format);
+  vsnprintf(formatted_message, sizeof(formatted_message), format, argp);
+  va_end(argp);
+
+  ert_log_with_level(level, "%s - packet: stream_id=%d port=%d sequence_number=%d start_of_stream=%d end_of_stream=%d "
+      "acks_enabled=%d request_acks=%d retransmit=%d acks=%d acks_bitmap=%d fec=%d raw_packet_length=%d payload_length=%d",
+      formatted_message, info->stream_id, info->port, info->sequence_number, info->start_of_stream, info->end_of_stream,
+      info->acks_enabled, info->request_acks, info->retransmit, info->acks, info->acks_bitmap, info->fec,
+      info->raw_packet_length, info->payload_length);
+}
+
+#define ert_comm_protocol_log_packet_info(level, info, ...) \
+  (ert_log_is_enabled(level) ? ert_comm_protocol_log_packet_info_do(level, info, __VA_ARGS__) : (void) 0)
+
+/**
+ * Logs the message followed by the stream info. Called through ert_comm_protocol_log_stream_info,
+ * which skips formatting when the log level is disabled.
+ */
+static void ert_comm_protocol_log_stream_info_do(ert_log_level level, ert_comm_protocol_stream_info *info,
+    const char *format, ...)
 {
   char formatted_message[1024];
+  va_list argp;
 
-  vsnprintf(formatted_message, 1024, format, argp);
+  va_start(argp, format);
+  vsnprintf(formatted_message, sizeof(formatted_message), format, argp);
+  va_end(argp);
 
   ert_log_with_level(level, "%s - stream: stream_id=%d port=%d current_sequence_number=%d last_acknowledged_sequence_number=%d "
       "last_transferred_sequence_number=%d received_packet_sequence_number_error_count=%" PRIu64 " "
@@ -178,25 +425,17 @@ static void ert_comm_protocol_log_stream_info_do(ert_log_level level, ert_comm_p
       info->ack_rerequest_count, info->end_of_stream_ack_rerequest_count);
 }
 
-static void ert_comm_protocol_log_stream_info(ert_log_level level, ert_comm_protocol_stream_info *info, char *format, ...)
+#define ert_comm_protocol_log_stream_info(level, info, ...) \
+  (ert_log_is_enabled(level) ? ert_comm_protocol_log_stream_info_do(level, info, __VA_ARGS__) : (void) 0)
+
+static inline int32_t ert_comm_protocol_stream_calculate_sequence_number_distance(ert_comm_protocol_stream *stream,
+    uint32_t sn1, uint32_t sn2)
 {
-  if (level == ERT_LOG_LEVEL_DEBUG) {
-#ifdef ERTLIB_ENABLE_LOG_DEBUG
-    va_list argp;
-    va_start(argp, format);
-    ert_comm_protocol_log_stream_info_do(level, info, format, argp);
-    va_end(argp);
-#endif
-  } else {
-    va_list argp;
-    va_start(argp, format);
-    ert_comm_protocol_log_stream_info_do(level, info, format, argp);
-    va_end(argp);
+  if (stream->info.extended_sequence_numbers) {
+    uint16_t unsigned_distance = (uint16_t) sn1 - (uint16_t) sn2;
+    return (int16_t) unsigned_distance;
   }
-}
 
-static inline int8_t ert_comm_protocol_stream_calculate_sequence_number_distance(uint32_t sn1, uint32_t sn2)
-{
   uint8_t unsigned_distance = (uint8_t) sn1 - (uint8_t) sn2;
   return (int8_t) unsigned_distance;
 }
@@ -206,10 +445,35 @@ static inline bool ert_comm_protocol_is_acknowledgement_packet(ert_comm_protocol
   return info->port == ERT_COMM_PROTOCOL_STREAM_PORT_ACKNOWLEDGEMENTS && info->acks;
 }
 
+static inline bool ert_comm_protocol_is_fec_repair_packet(ert_comm_protocol_packet_info *info)
+{
+  return info->fec && info->retransmit && !info->acks;
+}
+
+static inline bool ert_comm_protocol_transmit_stream_is_fec_enabled(ert_comm_protocol_stream *stream)
+{
+  return stream->info.fec && stream->info.acks_enabled;
+}
+
 static inline bool ert_comm_protocol_transmit_stream_is_request_acks(ert_comm_protocol_stream *stream)
 {
   return stream->info.acks_enabled && !stream->info.start_of_stream
-         && ((((stream->info.transferred_packet_count + 1) % stream->acknowledgement_interval_packet_count) == 0) ? true : false);
+         && ((stream->info.transferred_packet_count + 1 - stream->acknowledgement_request_transferred_packet_count)
+             >= stream->info.ack_interval_packet_count);
+}
+
+static inline uint32_t ert_comm_protocol_transmit_stream_get_window_packet_count(ert_comm_protocol_stream *stream)
+{
+  return stream->info.extended_sequence_numbers
+      ? stream->transmit_window_packet_count : stream->info.ack_interval_packet_count;
+}
+
+// Acks are requested with the packet filling the window, so that the transmitter is not left waiting for acks
+// that were never requested
+static inline bool ert_comm_protocol_transmit_stream_is_window_filled(ert_comm_protocol_stream *stream)
+{
+  return stream->info.acks_enabled && stream->info.extended_sequence_numbers
+         && stream->packet_history_count + 1 >= stream->transmit_window_packet_count;
 }
 
 static int ert_comm_protocol_increment_counter(
@@ -289,6 +553,21 @@ static int ert_comm_protocol_increment_counter(
       ert_get_current_timestamp(&status->last_invalid_received_packet_timestamp);
       status->invalid_received_packet_count++;
       break;
+    case ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT_FEC_REPAIR:
+      status->transmitted_fec_repair_packet_count++;
+
+      stream->info.fec_repair_packet_count++;
+      break;
+    case ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_FEC_REPAIR:
+      status->received_fec_repair_packet_count++;
+
+      stream->info.fec_repair_packet_count++;
+      break;
+    case ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_FEC_RECOVERED:
+      status->fec_recovered_packet_count++;
+
+      stream->info.fec_recovered_packet_count++;
+      break;
     default:
       ert_log_error("Invalid counter type: %d", type);
       result = -EINVAL;
@@ -300,6 +579,50 @@ static int ert_comm_protocol_increment_counter(
   return result;
 }
 
+static inline uint64_t ert_comm_protocol_get_thread_cpu_time_nanos()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void ert_comm_protocol_update_compression_counters(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, uint64_t uncompressed_data_bytes, uint64_t compressed_data_bytes,
+    uint64_t cpu_time_nanos)
+{
+  pthread_mutex_lock(&comm_protocol->status_mutex);
+
+  ert_comm_protocol_status *status = &comm_protocol->status;
+
+  if (stream->info.type == ERT_COMM_PROTOCOL_STREAM_TYPE_TRANSMIT) {
+    status->compression_uncompressed_data_bytes += uncompressed_data_bytes;
+    status->compression_compressed_data_bytes += compressed_data_bytes;
+    status->compression_cpu_time_nanos += cpu_time_nanos;
+    if (status->compression_uncompressed_data_bytes > 0) {
+      status->compression_ratio = (float) status->compression_compressed_data_bytes
+          / (float) status->compression_uncompressed_data_bytes;
+    }
+  } else {
+    status->decompression_uncompressed_data_bytes += uncompressed_data_bytes;
+    status->decompression_compressed_data_bytes += compressed_data_bytes;
+    status->decompression_cpu_time_nanos += cpu_time_nanos;
+    if (status->decompression_uncompressed_data_bytes > 0) {
+      status->decompression_ratio = (float) status->decompression_compressed_data_bytes
+          / (float) status->decompression_uncompressed_data_bytes;
+    }
+  }
+
+  stream->info.uncompressed_data_bytes += uncompressed_data_bytes;
+  stream->info.compressed_data_bytes += compressed_data_bytes;
+  stream->info.compression_cpu_time_nanos += cpu_time_nanos;
+  if (stream->info.uncompressed_data_bytes > 0) {
+    stream->info.compression_ratio = (float) stream->info.compressed_data_bytes
+        / (float) stream->info.uncompressed_data_bytes;
+  }
+
+  pthread_mutex_unlock(&comm_protocol->status_mutex);
+}
+
 static void ert_comm_protocol_log_packet_data(uint32_t length, uint8_t *data)
 {
   size_t bytes_per_line = 32;
@@ -338,20 +661,31 @@ static int ert_comm_protocol_get_packet_info(uint32_t length, uint8_t *data, ert
 
   ert_comm_protocol_packet_header *header = (ert_comm_protocol_packet_header *) data;
 
-  if (header->identifier != ERT_COMM_PROTOCOL_PACKET_IDENTIFIER) {
-    ert_log_error("Unknown comm protocol packet identifier: expected 0x%02X, received 0x%02X, packet length %d bytes",
-        ERT_COMM_PROTOCOL_PACKET_IDENTIFIER, header->identifier, length);
+  if (!ert_comm_protocol_packet_is_valid_identifier(header->identifier)) {
+    ert_log_error("Unknown comm protocol packet identifier: expected 0x%02X-0x%02X, received 0x%02X, packet length %d bytes",
+        ERT_COMM_PROTOCOL_PACKET_IDENTIFIER, ERT_COMM_PROTOCOL_PACKET_IDENTIFIER_COMPRESSED_EXTENDED,
+        header->identifier, length);
+    ert_comm_protocol_log_packet_data(length, data);
+    return -EINVAL;
+  }
+
+  uint32_t header_length = ert_comm_protocol_packet_get_header_length(data);
+  if (length < header_length) {
+    ert_log_error("Invalid packet length, no room for extended packet header in %d bytes", length);
     ert_comm_protocol_log_packet_data(length, data);
     return -EINVAL;
   }
 
-  uint32_t payload_length = length - ert_comm_protocol_packet_header_length;
+  uint32_t payload_length = length - header_length;
 
   info->stream_id = (uint16_t) ert_comm_protocol_packet_get_stream_id(header->port_stream_id);
   info->port = (uint16_t) ert_comm_protocol_packet_get_port(header->port_stream_id);
-  info->sequence_number = header->sequence_number;
+  info->sequence_number = ert_comm_protocol_packet_get_sequence_number(data);
+  info->extended_sequence_numbers = ert_comm_protocol_packet_is_extended(data);
+  info->compressed = ert_comm_protocol_packet_is_compressed(data);
+  info->header_length = header_length;
   info->payload_length = payload_length;
-  info->payload = data + ert_comm_protocol_packet_header_length;
+  info->payload = data + header_length;
   info->raw_packet_length = length;
   info->raw_packet_data = data;
 
@@ -361,17 +695,34 @@ static int ert_comm_protocol_get_packet_info(uint32_t length, uint8_t *data, ert
   info->request_acks = (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS) ? true : false;
   info->retransmit = (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_RETRANSMIT) ? true : false;
   info->acks = (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS) ? true : false;
+  info->acks_bitmap = (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_BITMAP) ? true : false;
+  info->fec = (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_FEC) ? true : false;
 
   return 0;
 }
 
+static inline uint32_t ert_comm_protocol_stream_packet_history_get_slot(uint32_t sequence_number)
+{
+  return sequence_number % ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT;
+}
+
 static int ert_comm_protocol_stream_packet_history_clear(ert_comm_protocol_stream *stream)
 {
-  for (size_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
-    stream->packet_history_data_length[i] = 0;
-    stream->packet_history_pointers[i] = NULL;
+  int32_t slot = stream->packet_history_first_slot;
+  while (slot != ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE) {
+    ert_comm_protocol_packet_history_entry *entry = &stream->packet_history[slot];
+    slot = entry->next_slot;
+
+    entry->data_length = 0;
+    entry->data = NULL;
+    entry->previous_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+    entry->next_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
   }
 
+  stream->packet_history_first_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+  stream->packet_history_last_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+  stream->packet_history_count = 0;
+
   ert_buffer_pool_clear(stream->packet_history_buffer_pool);
 
   return 0;
@@ -384,6 +735,16 @@ static int ert_comm_protocol_stream_packet_history_push(ert_comm_protocol_stream
     return -EINVAL;
   }
 
+  uint32_t sequence_number = ert_comm_protocol_packet_get_sequence_number(data);
+  int32_t slot = (int32_t) ert_comm_protocol_stream_packet_history_get_slot(sequence_number);
+  ert_comm_protocol_packet_history_entry *entry = &stream->packet_history[slot];
+
+  if (entry->data != NULL) {
+    ert_log_error("Packet history already contains packet: stream_id=%d, port=%d, sequence_number=%d",
+        stream->info.stream_id, stream->info.port, sequence_number);
+    return -EEXIST;
+  }
+
   uint8_t *buffer_pool_pointer;
 
   int result = ert_buffer_pool_acquire(stream->packet_history_buffer_pool, (void **) &buffer_pool_pointer);
@@ -391,21 +752,46 @@ static int ert_comm_protocol_stream_packet_history_push(ert_comm_protocol_stream
     return -ENOBUFS;
   }
 
-  for (size_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
-    ert_log_debug("Finding free slot in packet history: index=%d", i);
+  ert_log_trace("Pushing to packet history: slot=%d", slot);
 
-    if (stream->packet_history_pointers[i] == NULL) {
-      ert_log_debug("Pushing to packet history: index=%d", i);
-      memcpy(buffer_pool_pointer, data, length);
-      stream->packet_history_pointers[i] = buffer_pool_pointer;
-      stream->packet_history_data_length[i] = length;
-      return 0;
-    }
+  memcpy(buffer_pool_pointer, data, length);
+  entry->data = buffer_pool_pointer;
+  entry->data_length = length;
+
+  // Keep packets in the order they were pushed, retransmissions are done oldest first
+  entry->previous_slot = stream->packet_history_last_slot;
+  entry->next_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+
+  if (stream->packet_history_last_slot != ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE) {
+    stream->packet_history[stream->packet_history_last_slot].next_slot = slot;
+  } else {
+    stream->packet_history_first_slot = slot;
+  }
+  stream->packet_history_last_slot = slot;
+  stream->packet_history_count++;
+
+  return 0;
+}
+
+static ert_comm_protocol_packet_history_entry *ert_comm_protocol_stream_packet_history_find(ert_comm_protocol_stream *stream,
+    uint16_t port, uint16_t stream_id, uint32_t sequence_number)
+{
+  ert_comm_protocol_packet_history_entry *entry =
+      &stream->packet_history[ert_comm_protocol_stream_packet_history_get_slot(sequence_number)];
+
+  if (entry->data == NULL) {
+    return NULL;
   }
 
-  ert_buffer_pool_release(stream->packet_history_buffer_pool, (void *) buffer_pool_pointer);
+  ert_comm_protocol_packet_header *header = (ert_comm_protocol_packet_header *) entry->data;
+
+  if (ert_comm_protocol_packet_get_port(header->port_stream_id) != port
+      || ert_comm_protocol_packet_get_stream_id(header->port_stream_id) != stream_id
+      || ert_comm_protocol_packet_get_sequence_number(entry->data) != sequence_number) {
+    return NULL;
+  }
 
-  return -ENOBUFS;
+  return entry;
 }
 
 static bool ert_comm_protocol_stream_packet_history_get(ert_comm_protocol_stream *stream,
@@ -415,25 +801,20 @@ static bool ert_comm_protocol_stream_packet_history_get(ert_comm_protocol_stream
     return false;
   }
 
-  for (ssize_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
-    if (stream->packet_history_pointers[i] != NULL) {
-      ert_comm_protocol_packet_header *header = (ert_comm_protocol_packet_header *) stream->packet_history_pointers[i];
+  ert_comm_protocol_packet_history_entry *entry =
+      ert_comm_protocol_stream_packet_history_find(stream, port, stream_id, sequence_number);
+  if (entry == NULL) {
+    return false;
+  }
 
-      if (ert_comm_protocol_packet_get_port(header->port_stream_id) == port
-          && ert_comm_protocol_packet_get_stream_id(header->port_stream_id) == stream_id
-          && header->sequence_number == sequence_number) {
-        if (length_rcv != NULL) {
-          *length_rcv = stream->packet_history_data_length[i];
-        }
-        if (data_rcv != NULL) {
-          *data_rcv = stream->packet_history_pointers[i];
-        }
-        return true;
-      }
-    }
+  if (length_rcv != NULL) {
+    *length_rcv = entry->data_length;
+  }
+  if (data_rcv != NULL) {
+    *data_rcv = entry->data;
   }
 
-  return false;
+  return true;
 }
 
 static size_t ert_comm_protocol_stream_packet_history_get_count(ert_comm_protocol_stream *stream)
@@ -442,48 +823,37 @@ static size_t ert_comm_protocol_stream_packet_history_get_count(ert_comm_protoco
     return 0;
   }
 
-  size_t count = 0;
+  return stream->packet_history_count;
+}
 
-  for (size_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
-    if (stream->packet_history_pointers[i] != NULL) {
-      count++;
-    }
+static bool ert_comm_protocol_stream_packet_history_get_slot_entry(ert_comm_protocol_stream *stream,
+    int32_t slot, uint32_t *length_rcv, uint8_t **data_rcv)
+{
+  if (!stream->used || slot == ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE) {
+    return false;
   }
 
-  return count;
-}
+  ert_comm_protocol_packet_history_entry *entry = &stream->packet_history[slot];
 
-static bool ert_comm_protocol_stream_packet_history_get_index(ert_comm_protocol_stream *stream,
-    size_t index, uint32_t *length_rcv, uint8_t **data_rcv)
-{
-  if (!stream->used || index >= stream->acknowledgement_interval_packet_count) {
+  if (entry->data == NULL) {
     return false;
   }
 
-  if (stream->packet_history_pointers[index] != NULL) {
-    if (length_rcv != NULL) {
-      *length_rcv = stream->packet_history_data_length[index];
-    }
-    if (data_rcv != NULL) {
-      *data_rcv = stream->packet_history_pointers[index];
-    }
-    return true;
+  if (length_rcv != NULL) {
+    *length_rcv = entry->data_length;
+  }
+  if (data_rcv != NULL) {
+    *data_rcv = entry->data;
   }
 
-  return false;
+  return true;
 }
 
 static bool ert_comm_protocol_stream_packet_history_get_last(ert_comm_protocol_stream *stream,
     uint32_t *length_rcv, uint8_t **data_rcv)
 {
-  for (size_t i = stream->acknowledgement_interval_packet_count - 1; i >= 0; i--) {
-    bool packet_found = ert_comm_protocol_stream_packet_history_get_index(stream, i, length_rcv, data_rcv);
-    if (packet_found) {
-      return true;
-    }
-  }
-
-  return false;
+  return ert_comm_protocol_stream_packet_history_get_slot_entry(stream, stream->packet_history_last_slot,
+      length_rcv, data_rcv);
 }
 
 static bool ert_comm_protocol_stream_packet_history_pop(ert_comm_protocol_stream *stream,
@@ -493,42 +863,44 @@ static bool ert_comm_protocol_stream_packet_history_pop(ert_comm_protocol_stream
     return false;
   }
 
-  ssize_t index = -1;
+  ert_comm_protocol_packet_history_entry *entry =
+      ert_comm_protocol_stream_packet_history_find(stream, port, stream_id, sequence_number);
+  if (entry == NULL) {
+    return false;
+  }
 
-  for (ssize_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
-    if (index < 0 && stream->packet_history_pointers[i] != NULL) {
-      ert_comm_protocol_packet_header *header = (ert_comm_protocol_packet_header *) stream->packet_history_pointers[i];
+  ert_log_trace("Popping packet in history: stream_id=%d, port=%d, sequence_number=%d",
+      stream_id, port, sequence_number);
 
-      ert_log_debug("Packet in history: stream_id=%d, port=%d, sequence_number=%d",
-          ert_comm_protocol_packet_get_stream_id(header->port_stream_id),
-          ert_comm_protocol_packet_get_port(header->port_stream_id),
-          header->sequence_number);
+  if (entry->previous_slot != ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE) {
+    stream->packet_history[entry->previous_slot].next_slot = entry->next_slot;
+  } else {
+    stream->packet_history_first_slot = entry->next_slot;
+  }
 
-      if (ert_comm_protocol_packet_get_port(header->port_stream_id) == port
-          && ert_comm_protocol_packet_get_stream_id(header->port_stream_id) == stream_id
-          && header->sequence_number == sequence_number) {
+  if (entry->next_slot != ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE) {
+    stream->packet_history[entry->next_slot].previous_slot = entry->previous_slot;
+  } else {
+    stream->packet_history_last_slot = entry->previous_slot;
+  }
 
-        ert_log_debug("Popping packet in history: stream_id=%d, port=%d, sequence_number=%d",
-            ert_comm_protocol_packet_get_stream_id(header->port_stream_id),
-            ert_comm_protocol_packet_get_port(header->port_stream_id),
-            header->sequence_number);
-        index = i;
-        ert_buffer_pool_release(stream->packet_history_buffer_pool, stream->packet_history_pointers[i]);
-      }
-    }
+  ert_buffer_pool_release(stream->packet_history_buffer_pool, entry->data);
 
-    if (index >= 0) {
-      if (i < (stream->acknowledgement_interval_packet_count - 1)) {
-        stream->packet_history_data_length[i] = stream->packet_history_data_length[i + 1];
-        stream->packet_history_pointers[i] = stream->packet_history_pointers[i + 1];
-      } else {
-        stream->packet_history_data_length[i] = 0;
-        stream->packet_history_pointers[i] = NULL;
-      }
-    }
-  }
+  entry->data_length = 0;
+  entry->data = NULL;
+  entry->previous_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+  entry->next_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
 
-  return (index >= 0) ? true : false;
+  stream->packet_history_count--;
+
+  return true;
+}
+
+static inline bool ert_comm_protocol_stream_acknowledgements_is_set(ert_comm_protocol_stream *stream,
+    uint32_t sequence_number)
+{
+  uint8_t slot = (uint8_t) (sequence_number % ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT);
+  return (stream->acknowledgement_bitmap[slot / 8] & (1 << (slot % 8))) ? true : false;
 }
 
 static int ert_comm_protocol_stream_acknowledgements_push(ert_comm_protocol_stream *stream,
@@ -537,121 +909,398 @@ static int ert_comm_protocol_stream_acknowledgements_push(ert_comm_protocol_stre
   if (!stream->used) {
     return -EINVAL;
   }
-
-  for (size_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
-    if (stream->acknowledgements[i].port_stream_id != 0) {
-      continue;
-    }
-
-    stream->acknowledgements[i].port_stream_id = (uint8_t) (ert_comm_protocol_packet_set_port(port)
-        | ert_comm_protocol_packet_set_stream_id(stream_id));
-    stream->acknowledgements[i].sequence_number = (uint8_t) sequence_number;
-    return 0;
-  }
-
-  return -ENOBUFS;
-}
-
-static int ert_comm_protocol_stream_acknowledgements_create_payload_and_clear(ert_comm_protocol_stream *stream,
-    uint32_t *payload_length_rcv, uint8_t *payload)
-{
-  if (!stream->used) {
+  if (port != stream->info.port || stream_id != stream->info.stream_id) {
     return -EINVAL;
   }
 
-  uint32_t index = 0;
-
-  for (size_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
-    if (stream->acknowledgements[i].port_stream_id == 0) {
-      continue;
-    }
-
-    uint32_t offset = index * sizeof(ert_comm_protocol_packet_acknowledgement);
-    uint8_t *pointer = payload + offset;
-
-    memcpy(pointer, &stream->acknowledgements[i], sizeof(ert_comm_protocol_packet_acknowledgement));
-
-    index++;
-
-    stream->acknowledgements[i].port_stream_id = 0;
-    stream->acknowledgements[i].sequence_number = 0;
+  if (ert_comm_protocol_stream_acknowledgements_is_set(stream, sequence_number)) {
+    return 0;
+  }
+  if (stream->acknowledgement_count >= stream->acknowledgement_window_packet_count) {
+    return -ENOBUFS;
   }
 
-  *payload_length_rcv = index * sizeof(ert_comm_protocol_packet_acknowledgement);
+  uint8_t slot = (uint8_t) (sequence_number % ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT);
+  stream->acknowledgement_bitmap[slot / 8] |= (uint8_t) (1 << (slot % 8));
+  stream->acknowledgement_count++;
 
   return 0;
 }
 
 static int ert_comm_protocol_stream_acknowledgements_clear(ert_comm_protocol_stream *stream)
 {
-  for (size_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
-    stream->acknowledgements[i].port_stream_id = 0;
-    stream->acknowledgements[i].sequence_number = 0;
-  }
+  memset(stream->acknowledgement_bitmap, 0, ERT_COMM_PROTOCOL_ACKNOWLEDGEMENT_BITMAP_LENGTH);
+  stream->acknowledgement_count = 0;
+  stream->retransmission_received = false;
 
   return 0;
 }
 
-static inline bool ert_comm_protocol_receive_stream_is_end_of_stream(ert_comm_protocol_stream *stream)
+static void ert_comm_protocol_stream_acknowledgements_get_range(ert_comm_protocol_stream *stream,
+    uint32_t *first_sequence_number_rcv, uint32_t *sequence_number_count_rcv)
 {
-  return stream->info.end_of_stream_pending
-         && (stream->info.current_sequence_number == stream->info.last_acknowledged_sequence_number)
-         && (ert_comm_protocol_stream_packet_history_get_count(stream) == 0);
-}
+  // Sequence numbers of pending acknowledgements never exceed the last transferred sequence number
+  // and are within the acknowledgement bitmap before it, so the first set bit is the oldest pending acknowledgement
+  uint32_t sequence_number_count = ert_comm_protocol_stream_get_sequence_number_count(stream);
+  uint32_t first_sequence_number = 0;
+  uint32_t last_sequence_number = 0;
+  bool first_found = false;
+
+  for (uint32_t i = 1; i <= ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT; i++) {
+    uint32_t sequence_number = (stream->info.last_transferred_sequence_number + sequence_number_count
+        + i - ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT) % sequence_number_count;
+    if (!ert_comm_protocol_stream_acknowledgements_is_set(stream, sequence_number)) {
+      continue;
+    }
+    if (!first_found) {
+      first_sequence_number = sequence_number;
+      first_found = true;
+    }
+    last_sequence_number = sequence_number;
+  }
 
-static inline bool ert_comm_protocol_transmit_stream_is_end_of_stream(ert_comm_protocol_stream *stream)
-{
-  return stream->info.end_of_stream_pending
-         && (stream->info.last_transferred_sequence_number == stream->info.last_acknowledged_sequence_number)
-         && (ert_comm_protocol_stream_packet_history_get_count(stream) == 0);
+  *first_sequence_number_rcv = first_sequence_number;
+  *sequence_number_count_rcv = first_found
+      ? ((last_sequence_number + sequence_number_count - first_sequence_number) % sequence_number_count) + 1 : 0;
 }
 
-static inline int ert_comm_protocol_stream_update_transferred_packet_timestamp(ert_comm_protocol_stream *stream)
+static uint32_t ert_comm_protocol_stream_acknowledgements_get_payload_length(ert_comm_protocol_stream *stream,
+    bool acks_bitmap)
 {
-  int result = ert_get_current_timestamp(&stream->info.last_transferred_packet_timestamp);
-  if (result < 0) {
-    ert_log_error("ert_get_current_timestamp failed with result %d: %s", result, strerror(errno));
-    return -EIO;
+  if (!acks_bitmap && !stream->info.extended_sequence_numbers) {
+    return stream->acknowledgement_count * sizeof(ert_comm_protocol_packet_acknowledgement);
   }
 
-  return 0;
+  uint32_t first_sequence_number;
+  uint32_t sequence_number_count;
+  ert_comm_protocol_stream_acknowledgements_get_range(stream, &first_sequence_number, &sequence_number_count);
+
+  if (stream->info.extended_sequence_numbers) {
+    return sizeof(ert_comm_protocol_packet_acknowledgement_extended) + (sequence_number_count + 7) / 8;
+  }
+
+  return sizeof(ert_comm_protocol_packet_acknowledgement_bitmap) + (sequence_number_count + 7) / 8;
 }
 
-void ert_comm_protocol_create_default_config(ert_comm_protocol_config *config)
+/*
+ * The bitmap encoding is used if the transmitter of the stream supports it
+ * and if it is shorter than the plain list of acknowledgements.
+ */
+static bool ert_comm_protocol_stream_acknowledgements_use_bitmap(ert_comm_protocol_stream *stream,
+    bool acks_bitmap_allowed)
 {
-  config->passive_mode = false;
-  config->transmit_all_data = false;
-  config->ignore_errors = false;
-  config->receive_buffer_length_packets = ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT * 2;
-  config->stream_inactivity_timeout_millis = ERT_COMM_PROTOCOL_STREAM_INACTIVITY_TIMEOUT_MILLIS_DEFAULT;
-
-  config->stream_acknowledgement_interval_packet_count = ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT;
-  config->stream_acknowledgement_receive_timeout_millis = ERT_COMM_PROTOCOL_STREAM_ACK_RECEIVE_TIMEOUT_MILLIS_DEFAULT;
-  config->stream_acknowledgement_guard_interval_millis = ERT_COMM_PROTOCOL_STREAM_ACK_GUARD_INTERVAL_MILLIS_DEFAULT;
-  config->stream_acknowledgement_max_rerequest_count = ERT_COMM_PROTOCOL_STREAM_ACK_REREQUEST_COUNT_MAX_DEFAULT;
-  config->stream_end_of_stream_acknowledgement_max_rerequest_count = ERT_COMM_PROTOCOL_STREAM_END_OF_STREAM_ACK_REREQUEST_COUNT_MAX_DEFAULT;
+  if (!acks_bitmap_allowed || stream->acknowledgement_count == 0 || stream->info.extended_sequence_numbers) {
+    return false;
+  }
 
-  config->transmit_stream_count = ERT_COMM_PROTOCOL_MAX_TRANSMIT_STREAM_COUNT_DEFAULT;
-  config->receive_stream_count = ERT_COMM_PROTOCOL_MAX_RECEIVE_STREAM_COUNT_DEFAULT;
+  return ert_comm_protocol_stream_acknowledgements_get_payload_length(stream, true)
+         < ert_comm_protocol_stream_acknowledgements_get_payload_length(stream, false);
 }
 
-int ert_comm_protocol_stream_get_info(ert_comm_protocol_stream *stream, ert_comm_protocol_stream_info *stream_info)
+static int ert_comm_protocol_stream_acknowledgements_create_payload_and_clear(ert_comm_protocol_stream *stream,
+    bool acks_bitmap, uint32_t max_payload_length, uint32_t *payload_length_rcv, uint8_t *payload)
 {
   if (!stream->used) {
     return -EINVAL;
   }
 
-  memcpy(stream_info, &stream->info, sizeof(ert_comm_protocol_stream_info));
+  uint8_t port_stream_id = (uint8_t) (ert_comm_protocol_packet_set_port(stream->info.port)
+      | ert_comm_protocol_packet_set_stream_id(stream->info.stream_id));
 
-  return 0;
-}
+  // Acknowledgements of extended streams always carry the cumulative sequence number
+  if (stream->acknowledgement_count == 0 && !stream->info.extended_sequence_numbers) {
+    *payload_length_rcv = 0;
+    return 0;
+  }
 
-static int ert_comm_protocol_stream_reset(ert_comm_protocol_stream *stream, uint16_t stream_id) {
-  if (stream->used) {
-    return -EINVAL;
+  uint32_t payload_length = ert_comm_protocol_stream_acknowledgements_get_payload_length(stream, acks_bitmap);
+  if (payload_length > max_payload_length) {
+    return -ENOBUFS;
   }
 
-  stream->info.stream_id = stream_id;
+  uint32_t first_sequence_number;
+  uint32_t sequence_number_count;
+  ert_comm_protocol_stream_acknowledgements_get_range(stream, &first_sequence_number, &sequence_number_count);
+
+  if (stream->info.extended_sequence_numbers) {
+    ert_comm_protocol_packet_acknowledgement_extended *ack_extended =
+        (ert_comm_protocol_packet_acknowledgement_extended *) payload;
+    uint8_t *bitmap = payload + sizeof(ert_comm_protocol_packet_acknowledgement_extended);
+    uint32_t bitmap_length = (sequence_number_count + 7) / 8;
+    uint32_t cumulative_sequence_number = stream->info.last_acknowledged_sequence_number;
+
+    ack_extended->port_stream_id = port_stream_id;
+    ack_extended->cumulative_sequence_number_low = (uint8_t) (cumulative_sequence_number & 0xFF);
+    ack_extended->cumulative_sequence_number_high = (uint8_t) ((cumulative_sequence_number >> 8) & 0xFF);
+    ack_extended->sequence_number_low = (uint8_t) (first_sequence_number & 0xFF);
+    ack_extended->sequence_number_high = (uint8_t) ((first_sequence_number >> 8) & 0xFF);
+    ack_extended->bitmap_length = (uint8_t) bitmap_length;
+    memset(bitmap, 0, bitmap_length);
+
+    for (uint32_t bit = 0; bit < sequence_number_count; bit++) {
+      if (ert_comm_protocol_stream_acknowledgements_is_set(stream, first_sequence_number + bit)) {
+        bitmap[bit / 8] |= (uint8_t) (1 << (bit % 8));
+      }
+    }
+  } else if (acks_bitmap) {
+    ert_comm_protocol_packet_acknowledgement_bitmap *ack_bitmap = (ert_comm_protocol_packet_acknowledgement_bitmap *) payload;
+    uint8_t *bitmap = payload + sizeof(ert_comm_protocol_packet_acknowledgement_bitmap);
+    uint32_t bitmap_length = (sequence_number_count + 7) / 8;
+
+    ack_bitmap->port_stream_id = port_stream_id;
+    ack_bitmap->sequence_number = (uint8_t) first_sequence_number;
+    ack_bitmap->bitmap_length = (uint8_t) bitmap_length;
+    memset(bitmap, 0, bitmap_length);
+
+    for (uint32_t bit = 0; bit < sequence_number_count; bit++) {
+      if (ert_comm_protocol_stream_acknowledgements_is_set(stream, first_sequence_number + bit)) {
+        bitmap[bit / 8] |= (uint8_t) (1 << (bit % 8));
+      }
+    }
+  } else {
+    uint32_t index = 0;
+
+    for (uint32_t bit = 0; bit < sequence_number_count; bit++) {
+      uint32_t sequence_number = (first_sequence_number + bit) % ERT_COMM_PROTOCOL_SEQUENCE_NUMBER_COUNT;
+      if (!ert_comm_protocol_stream_acknowledgements_is_set(stream, sequence_number)) {
+        continue;
+      }
+
+      ert_comm_protocol_packet_acknowledgement *ack = (ert_comm_protocol_packet_acknowledgement *)
+          (payload + index * sizeof(ert_comm_protocol_packet_acknowledgement));
+      ack->port_stream_id = port_stream_id;
+      ack->sequence_number = (uint8_t) sequence_number;
+      index++;
+    }
+  }
+
+  *payload_length_rcv = payload_length;
+
+  return ert_comm_protocol_stream_acknowledgements_clear(stream);
+}
+
+static void ert_comm_protocol_stream_fec_clear(ert_comm_protocol_stream *stream)
+{
+  stream->fec_group_packet_count = 0;
+  stream->fec_group_max_payload_length = 0;
+
+  for (size_t slot = 0; slot < ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT; slot++) {
+    stream->fec_packet_lengths[slot] = 0;
+    stream->fec_packet_sequence_numbers[slot] = ERT_COMM_PROTOCOL_FEC_PACKET_SEQUENCE_NUMBER_NONE;
+  }
+}
+
+static inline uint32_t ert_comm_protocol_transmit_stream_get_max_packet_length(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream)
+{
+  // Leave room for the repair header so that FEC repair packets fit in the maximum packet length
+  return ert_comm_protocol_transmit_stream_is_fec_enabled(stream)
+      ? comm_protocol->max_packet_size - (uint32_t) sizeof(ert_comm_protocol_packet_fec_repair)
+      : comm_protocol->max_packet_size;
+}
+
+// Must be called stream->mutex locked
+static void ert_comm_protocol_transmit_stream_fec_add_packet(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, uint32_t packet_length, uint8_t *packet_data)
+{
+  ert_comm_protocol_packet_header *header = (ert_comm_protocol_packet_header *) packet_data;
+  uint32_t header_length = ert_comm_protocol_stream_get_header_length(stream);
+  ert_comm_protocol_packet_fec_repair *repair =
+      (ert_comm_protocol_packet_fec_repair *) (stream->fec_packet_buffer + header_length);
+  uint8_t *repair_data = stream->fec_packet_buffer + header_length + sizeof(ert_comm_protocol_packet_fec_repair);
+
+  uint32_t payload_length = packet_length - header_length;
+  uint8_t *payload = packet_data + header_length;
+
+  if (stream->fec_group_packet_count == 0) {
+    memset(stream->fec_packet_buffer, 0, comm_protocol->max_packet_size);
+    ert_comm_protocol_packet_set_header(stream->fec_packet_buffer, stream->info.extended_sequence_numbers,
+        stream->info.compressed, 0,
+        ert_comm_protocol_packet_get_sequence_number(packet_data), 0);
+    stream->fec_group_max_payload_length = 0;
+  }
+
+  repair->flags ^= header->flags;
+  repair->payload_length ^= (uint8_t) payload_length;
+
+  for (uint32_t i = 0; i < payload_length; i++) {
+    repair_data[i] ^= payload[i];
+  }
+
+  if (payload_length > stream->fec_group_max_payload_length) {
+    stream->fec_group_max_payload_length = payload_length;
+  }
+
+  stream->fec_group_packet_count++;
+}
+
+// Must be called stream->mutex locked, returns the length of the repair packet and starts a new packet group
+static uint32_t ert_comm_protocol_transmit_stream_fec_create_repair_packet(ert_comm_protocol_stream *stream,
+    bool request_acks)
+{
+  uint32_t header_length = ert_comm_protocol_stream_get_header_length(stream);
+  ert_comm_protocol_packet_fec_repair *repair =
+      (ert_comm_protocol_packet_fec_repair *) (stream->fec_packet_buffer + header_length);
+
+  uint8_t flags = ERT_COMM_PROTOCOL_PACKET_FLAG_FEC | ERT_COMM_PROTOCOL_PACKET_FLAG_RETRANSMIT
+      | ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_ENABLED;
+
+  if (stream->info.acks_bitmap) {
+    flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_BITMAP;
+  }
+  if (request_acks) {
+    flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS;
+  }
+
+  ert_comm_protocol_packet_set_header(stream->fec_packet_buffer, stream->info.extended_sequence_numbers,
+      stream->info.compressed, (uint8_t) (ert_comm_protocol_packet_set_port(stream->info.port)
+          | ert_comm_protocol_packet_set_stream_id(stream->info.stream_id)),
+      ert_comm_protocol_packet_get_sequence_number(stream->fec_packet_buffer), flags);
+
+  repair->packet_count = (uint8_t) stream->fec_group_packet_count;
+
+  stream->fec_group_packet_count = 0;
+
+  return header_length + (uint32_t) sizeof(ert_comm_protocol_packet_fec_repair)
+         + stream->fec_group_max_payload_length;
+}
+
+static uint32_t ert_comm_protocol_get_priority_write_packet_flags(ert_comm_protocol *comm_protocol, uint16_t port)
+{
+  uint16_t port_mask = ERT_COMM_PROTOCOL_PORT_MASK(port);
+
+  if (port == ERT_COMM_PROTOCOL_STREAM_PORT_ACKNOWLEDGEMENTS
+      || (comm_protocol->config.stream_realtime_priority_ports & port_mask)) {
+    return ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_PRIORITY_REALTIME;
+  }
+  if (comm_protocol->config.stream_bulk_priority_ports & port_mask) {
+    return ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_PRIORITY_BULK;
+  }
+
+  return 0;
+}
+
+static void ert_comm_protocol_transmit_stream_fec_write_repair_packet(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, uint32_t packet_length, bool request_acks)
+{
+  uint32_t write_packet_flags =
+      (request_acks ? ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_SET_RECEIVE_ACTIVE : 0)
+      | ert_comm_protocol_get_priority_write_packet_flags(comm_protocol, stream->info.port);
+
+  ert_log_trace("Transmitting FEC repair packet: stream_id=%d, port=%d, packet_length=%d, write_packet_flags=%02X",
+      stream->info.stream_id, stream->info.port, packet_length, write_packet_flags);
+
+  uint32_t bytes_written = 0;
+  int result = comm_protocol->protocol_device->write_packet(comm_protocol->protocol_device,
+      packet_length, stream->fec_packet_buffer, write_packet_flags, &bytes_written);
+  if (result < 0) {
+    // Lost packets of the group are still recovered with retransmissions
+    ert_log_error("Protocol device write_packet failed for FEC repair packet with result %d", result);
+    return;
+  }
+
+  ert_comm_protocol_increment_counter(comm_protocol, stream,
+      ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT_FEC_REPAIR, bytes_written,
+      bytes_written - ert_comm_protocol_stream_get_header_length(stream));
+}
+
+static inline uint8_t *ert_comm_protocol_receive_stream_fec_get_packet(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, uint32_t sequence_number)
+{
+  return stream->fec_packet_buffer
+         + (sequence_number % ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT) * comm_protocol->max_packet_size;
+}
+
+// Must be called stream->mutex locked
+static void ert_comm_protocol_receive_stream_fec_cache_packet(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, ert_comm_protocol_packet_info *info)
+{
+  uint32_t slot = info->sequence_number % ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT;
+
+  memcpy(ert_comm_protocol_receive_stream_fec_get_packet(comm_protocol, stream, info->sequence_number),
+      info->raw_packet_data, info->raw_packet_length);
+  stream->fec_packet_lengths[slot] = info->raw_packet_length;
+  stream->fec_packet_sequence_numbers[slot] = (int32_t) info->sequence_number;
+}
+
+static inline bool ert_comm_protocol_receive_stream_is_end_of_stream(ert_comm_protocol_stream *stream)
+{
+  return stream->info.end_of_stream_pending
+         && (stream->info.current_sequence_number == stream->info.last_acknowledged_sequence_number)
+         && (ert_comm_protocol_stream_packet_history_get_count(stream) == 0);
+}
+
+static inline bool ert_comm_protocol_transmit_stream_is_end_of_stream(ert_comm_protocol_stream *stream)
+{
+  return stream->info.end_of_stream_pending
+         && (stream->info.last_transferred_sequence_number == stream->info.last_acknowledged_sequence_number)
+         && (ert_comm_protocol_stream_packet_history_get_count(stream) == 0);
+}
+
+static inline int ert_comm_protocol_stream_update_transferred_packet_timestamp(ert_comm_protocol_stream *stream)
+{
+  int result = ert_get_current_timestamp(&stream->info.last_transferred_packet_timestamp);
+  if (result < 0) {
+    ert_log_error("ert_get_current_timestamp failed with result %d: %s", result, strerror(errno));
+    return -EIO;
+  }
+
+  return 0;
+}
+
+void ert_comm_protocol_create_default_config(ert_comm_protocol_config *config)
+{
+  config->passive_mode = false;
+  config->transmit_all_data = false;
+  config->ignore_errors = false;
+  config->receive_buffer_length_packets = ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT * 2;
+  config->stream_inactivity_timeout_millis = ERT_COMM_PROTOCOL_STREAM_INACTIVITY_TIMEOUT_MILLIS_DEFAULT;
+
+  config->stream_acknowledgement_interval_packet_count = ERT_COMM_PROTOCOL_STREAM_ACK_INTERVAL_PACKET_COUNT_DEFAULT;
+  config->stream_acknowledgement_bitmap = true;
+  config->stream_acknowledgement_receive_timeout_millis = ERT_COMM_PROTOCOL_STREAM_ACK_RECEIVE_TIMEOUT_MILLIS_DEFAULT;
+  config->stream_acknowledgement_adaptive = true;
+  config->stream_acknowledgement_min_interval_packet_count = ERT_COMM_PROTOCOL_STREAM_ACK_MIN_INTERVAL_PACKET_COUNT_DEFAULT;
+  config->stream_acknowledgement_max_interval_packet_count = ERT_COMM_PROTOCOL_STREAM_ACK_MAX_INTERVAL_PACKET_COUNT_DEFAULT;
+  config->stream_acknowledgement_min_receive_timeout_millis = ERT_COMM_PROTOCOL_STREAM_ACK_MIN_RECEIVE_TIMEOUT_MILLIS_DEFAULT;
+  config->stream_acknowledgement_max_receive_timeout_millis = ERT_COMM_PROTOCOL_STREAM_ACK_MAX_RECEIVE_TIMEOUT_MILLIS_DEFAULT;
+  config->stream_acknowledgement_guard_interval_millis = ERT_COMM_PROTOCOL_STREAM_ACK_GUARD_INTERVAL_MILLIS_DEFAULT;
+  config->stream_acknowledgement_max_rerequest_count = ERT_COMM_PROTOCOL_STREAM_ACK_REREQUEST_COUNT_MAX_DEFAULT;
+  config->stream_end_of_stream_acknowledgement_max_rerequest_count = ERT_COMM_PROTOCOL_STREAM_END_OF_STREAM_ACK_REREQUEST_COUNT_MAX_DEFAULT;
+
+  config->stream_fec = false;
+  config->stream_fec_group_packet_count = ERT_COMM_PROTOCOL_STREAM_FEC_GROUP_PACKET_COUNT_DEFAULT;
+
+  config->stream_extended_sequence_numbers = true;
+  config->stream_window_packet_count = ERT_COMM_PROTOCOL_STREAM_WINDOW_PACKET_COUNT_DEFAULT;
+
+  config->stream_compression = true;
+  config->stream_compression_ports = 0;
+
+  config->stream_realtime_priority_ports = 0;
+  config->stream_bulk_priority_ports = 0;
+
+  config->transmit_stream_count = ERT_COMM_PROTOCOL_MAX_TRANSMIT_STREAM_COUNT_DEFAULT;
+  config->receive_stream_count = ERT_COMM_PROTOCOL_MAX_RECEIVE_STREAM_COUNT_DEFAULT;
+}
+
+int ert_comm_protocol_stream_get_info(ert_comm_protocol_stream *stream, ert_comm_protocol_stream_info *stream_info)
+{
+  if (!stream->used) {
+    return -EINVAL;
+  }
+
+  memcpy(stream_info, &stream->info, sizeof(ert_comm_protocol_stream_info));
+
+  return 0;
+}
+
+static int ert_comm_protocol_stream_reset(ert_comm_protocol_stream *stream, uint16_t stream_id) {
+  if (stream->used) {
+    return -EINVAL;
+  }
+
+  stream->info.stream_id = stream_id;
   stream->used = false;
   stream->info.port = 0;
   stream->info.start_of_stream = false;
@@ -660,6 +1309,10 @@ static int ert_comm_protocol_stream_reset(ert_comm_protocol_stream *stream, uint
   stream->info.close_pending = false;
   stream->info.acks_enabled = false;
   stream->info.acks = false;
+  stream->info.acks_bitmap = false;
+  stream->info.fec = false;
+  stream->info.extended_sequence_numbers = false;
+  stream->info.compressed = false;
   stream->info.ack_request_pending = false;
   stream->info.failed = false;
   stream->info.ack_rerequest_count = 0;
@@ -675,8 +1328,43 @@ static int ert_comm_protocol_stream_reset(ert_comm_protocol_stream *stream, uint
   stream->info.retransmitted_data_bytes = 0;
   stream->info.retransmitted_payload_data_bytes = 0;
   stream->info.received_packet_sequence_number_error_count = 0;
-
-  int result = ert_ring_buffer_clear(stream->ring_buffer);
+  stream->info.fec_repair_packet_count = 0;
+  stream->info.fec_recovered_packet_count = 0;
+  stream->info.uncompressed_data_bytes = 0;
+  stream->info.compressed_data_bytes = 0;
+  stream->info.compression_ratio = 0;
+  stream->info.compression_cpu_time_nanos = 0;
+
+  stream->acknowledgement_send_pending = false;
+  stream->acknowledgement_processing_pending = false;
+  stream->acknowledgement_retransmit_pending = false;
+  stream->link_report = false;
+
+  stream->info.ack_interval_packet_count = 0;
+  stream->info.ack_receive_timeout_millis = 0;
+  stream->info.round_trip_time_millis = 0;
+  stream->info.round_trip_time_deviation_millis = 0;
+  stream->info.packet_loss_ratio = 0;
+  stream->transmit_window_packet_count = 0;
+  stream->acknowledgement_request_sequence_number = 0;
+  stream->acknowledgement_request_repeated = false;
+  stream->acknowledgement_request_transferred_packet_count = 0;
+  stream->acknowledgement_request_packet_count = 0;
+  stream->acknowledged_packet_count = 0;
+  stream->smoothed_request_packet_count = 0;
+  stream->smoothed_lost_packet_count = 0;
+
+  ert_comm_protocol_stream_fec_clear(stream);
+
+  if (stream->compressor != NULL) {
+    ert_comm_protocol_compressor_reset(stream->compressor);
+  }
+  if (stream->decompressor != NULL) {
+    ert_comm_protocol_decompressor_reset(stream->decompressor);
+  }
+
+  int result = (stream->ring_buffer != NULL)
+               ? ert_ring_buffer_clear(stream->ring_buffer) : ert_spsc_ring_buffer_clear(stream->receive_buffer);
   if (result < 0) {
     return result;
   }
@@ -696,27 +1384,196 @@ static int ert_comm_protocol_stream_reset(ert_comm_protocol_stream *stream, uint
   return 0;
 }
 
+static inline uint32_t ert_comm_protocol_limit_value(uint32_t value, uint32_t min, uint32_t max)
+{
+  if (value < min) {
+    return min;
+  }
+  if (value > max) {
+    return max;
+  }
+  return value;
+}
+
+static void ert_comm_protocol_update_acknowledgement_status(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream)
+{
+  pthread_mutex_lock(&comm_protocol->status_mutex);
+
+  ert_comm_protocol_status *status = &comm_protocol->status;
+
+  status->acknowledgement_interval_packet_count = stream->info.ack_interval_packet_count;
+  status->acknowledgement_receive_timeout_millis = stream->info.ack_receive_timeout_millis;
+  status->round_trip_time_millis = stream->info.round_trip_time_millis;
+  status->round_trip_time_deviation_millis = stream->info.round_trip_time_deviation_millis;
+  status->packet_loss_ratio = stream->info.packet_loss_ratio;
+
+  pthread_mutex_unlock(&comm_protocol->status_mutex);
+}
+
+/*
+ * Returns the number of packets in packet history covered by the latest ack request. Streams using extended
+ * sequence numbers keep transmitting after requesting acks, so the packets after the request are still in flight.
+ */
+static uint32_t ert_comm_protocol_transmit_stream_get_requested_packet_count(ert_comm_protocol_stream *stream)
+{
+  if (!stream->info.extended_sequence_numbers) {
+    return (uint32_t) ert_comm_protocol_stream_packet_history_get_count(stream);
+  }
+
+  uint32_t packet_count = 0;
+
+  for (int32_t slot = stream->packet_history_first_slot; slot != ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+      slot = stream->packet_history[slot].next_slot) {
+    uint32_t sequence_number = ert_comm_protocol_packet_get_sequence_number(stream->packet_history[slot].data);
+    if (ert_comm_protocol_stream_calculate_sequence_number_distance(stream,
+        sequence_number, stream->acknowledgement_request_sequence_number) > 0) {
+      break;
+    }
+    packet_count++;
+  }
+
+  return packet_count;
+}
+
+// Must be called stream->mutex locked after transmitting the packet requesting acks
+static void ert_comm_protocol_transmit_stream_set_acknowledgement_requested(ert_comm_protocol_stream *stream,
+    bool repeated, uint32_t sequence_number)
+{
+  stream->info.ack_request_pending = true;
+
+  ert_get_current_timestamp(&stream->acknowledgement_request_timestamp);
+  stream->acknowledgement_request_sequence_number = sequence_number;
+  stream->acknowledgement_request_repeated = repeated;
+  stream->acknowledgement_request_transferred_packet_count = stream->info.transferred_packet_count;
+  stream->acknowledgement_request_packet_count = ert_comm_protocol_transmit_stream_get_requested_packet_count(stream);
+  stream->acknowledged_packet_count = 0;
+}
+
+/*
+ * Adapts the acknowledgement interval and receive timeout of a transmit stream after receiving the acks it requested.
+ * The receive timeout follows the smoothed round-trip time and its deviation like the TCP retransmission timeout.
+ * Round-trip time is not measured for re-requested acks, because the acks may respond to any of the requests.
+ * The interval is limited so that about one packet is expected to be lost between ack requests: it shrinks
+ * immediately when packet loss increases and grows by a quarter after each ack request without lost packets.
+ * Must be called stream->mutex locked.
+ */
+static void ert_comm_protocol_transmit_stream_adapt_acknowledgements(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream)
+{
+  ert_comm_protocol_config *config = &comm_protocol->config;
+  ert_comm_protocol_stream_info *info = &stream->info;
+
+  if (!stream->acknowledgement_request_repeated) {
+    int32_t milliseconds = ert_timespec_diff_milliseconds_from_current(&stream->acknowledgement_request_timestamp);
+    uint32_t round_trip_time = (milliseconds > 0) ? (uint32_t) milliseconds : 0;
+
+    if (info->round_trip_time_millis == 0 && info->round_trip_time_deviation_millis == 0) {
+      info->round_trip_time_millis = round_trip_time;
+      info->round_trip_time_deviation_millis = round_trip_time / 2;
+    } else {
+      uint32_t deviation = (round_trip_time > info->round_trip_time_millis)
+          ? round_trip_time - info->round_trip_time_millis
+          : info->round_trip_time_millis - round_trip_time;
+      info->round_trip_time_deviation_millis = (3 * info->round_trip_time_deviation_millis + deviation) / 4;
+      info->round_trip_time_millis = (7 * info->round_trip_time_millis + round_trip_time) / 8;
+    }
+  }
+
+  uint32_t lost_packet_count = 0;
+  if (stream->acknowledgement_request_packet_count > 0) {
+    if (stream->acknowledgement_request_packet_count > stream->acknowledged_packet_count) {
+      lost_packet_count = stream->acknowledgement_request_packet_count - stream->acknowledged_packet_count;
+    }
+
+    stream->smoothed_request_packet_count +=
+        ((float) stream->acknowledgement_request_packet_count - stream->smoothed_request_packet_count) / 4;
+    stream->smoothed_lost_packet_count += ((float) lost_packet_count - stream->smoothed_lost_packet_count) / 4;
+    info->packet_loss_ratio = stream->smoothed_lost_packet_count / stream->smoothed_request_packet_count;
+  }
+
+  if (config->stream_acknowledgement_adaptive) {
+    uint32_t variation_millis = 4 * info->round_trip_time_deviation_millis;
+    if (variation_millis < config->stream_acknowledgement_guard_interval_millis) {
+      variation_millis = config->stream_acknowledgement_guard_interval_millis;
+    }
+
+    info->ack_receive_timeout_millis = ert_comm_protocol_limit_value(info->round_trip_time_millis + variation_millis,
+        config->stream_acknowledgement_min_receive_timeout_millis, config->stream_acknowledgement_max_receive_timeout_millis);
+
+    uint32_t max_interval_packet_count = config->stream_acknowledgement_max_interval_packet_count;
+    if (info->packet_loss_ratio * (float) max_interval_packet_count > 1.0f) {
+      max_interval_packet_count = ert_comm_protocol_limit_value((uint32_t) (1.0f / info->packet_loss_ratio),
+          config->stream_acknowledgement_min_interval_packet_count, max_interval_packet_count);
+    }
+
+    if (info->ack_interval_packet_count > max_interval_packet_count) {
+      info->ack_interval_packet_count = max_interval_packet_count;
+    } else if (lost_packet_count == 0) {
+      uint32_t increment = info->ack_interval_packet_count / 4;
+      info->ack_interval_packet_count += (increment > 0) ? increment : 1;
+      if (info->ack_interval_packet_count > max_interval_packet_count) {
+        info->ack_interval_packet_count = max_interval_packet_count;
+      }
+    }
+  }
+
+  ert_log_debug("Adapted acknowledgements for stream_id=%d port=%d: interval_packet_count=%d receive_timeout_millis=%d "
+      "round_trip_time_millis=%d round_trip_time_deviation_millis=%d packet_loss_ratio=%.3f",
+      info->stream_id, info->port, info->ack_interval_packet_count, info->ack_receive_timeout_millis,
+      info->round_trip_time_millis, info->round_trip_time_deviation_millis, info->packet_loss_ratio);
+
+  ert_comm_protocol_update_acknowledgement_status(comm_protocol, stream);
+}
+
+// Backs off when requested acks are not received: the link is either congested by other transmitters or too poor
+// for the current interval. Must be called stream->mutex locked.
+static void ert_comm_protocol_transmit_stream_back_off_acknowledgements(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream)
+{
+  ert_comm_protocol_config *config = &comm_protocol->config;
+
+  if (!config->stream_acknowledgement_adaptive) {
+    return;
+  }
+
+  stream->info.ack_receive_timeout_millis = ert_comm_protocol_limit_value(stream->info.ack_receive_timeout_millis * 2,
+      config->stream_acknowledgement_min_receive_timeout_millis, config->stream_acknowledgement_max_receive_timeout_millis);
+  stream->info.ack_interval_packet_count = ert_comm_protocol_limit_value(stream->info.ack_interval_packet_count / 2,
+      config->stream_acknowledgement_min_interval_packet_count, config->stream_acknowledgement_max_interval_packet_count);
+
+  ert_comm_protocol_update_acknowledgement_status(comm_protocol, stream);
+}
+
+static bool ert_comm_protocol_stream_is_retransmit_request_acks(ert_comm_protocol_stream *stream,
+    bool use_acks, bool force_request_acks, bool force_request_acks_if_end_of_stream_pending)
+{
+  if (!use_acks) {
+    return false;
+  }
+
+  if (force_request_acks) {
+    return true;
+  } else if (stream->info.end_of_stream_pending && force_request_acks_if_end_of_stream_pending) {
+    return true;
+  }
+
+  return ert_comm_protocol_transmit_stream_is_request_acks(stream);
+}
+
 static int ert_comm_protocol_stream_retransmit_packet(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
     uint32_t packet_length, uint8_t *packet_data, bool use_acks, bool force_request_acks, bool force_request_acks_if_end_of_stream_pending)
 {
   ert_comm_protocol_packet_header *header = (ert_comm_protocol_packet_header *) packet_data;
-  uint16_t stream_id = (uint16_t) ert_comm_protocol_packet_get_stream_id(header->port_stream_id);
   uint16_t port = (uint16_t) ert_comm_protocol_packet_get_port(header->port_stream_id);
-  uint32_t sequence_number = header->sequence_number;
+  uint32_t sequence_number = ert_comm_protocol_packet_get_sequence_number(packet_data);
 
+  // Retransmitted packets of streams using FEC must not be mistaken for repair packets
   header->flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_RETRANSMIT;
+  header->flags &= ~ERT_COMM_PROTOCOL_PACKET_FLAG_FEC;
 
-  bool request_acks = false;
-
-  if (use_acks) {
-    if (force_request_acks) {
-      request_acks = true;
-    } else if (stream->info.end_of_stream_pending && force_request_acks_if_end_of_stream_pending) {
-      request_acks = true;
-    } else {
-      request_acks = ert_comm_protocol_transmit_stream_is_request_acks(stream);
-    }
-  }
+  bool request_acks = ert_comm_protocol_stream_is_retransmit_request_acks(stream,
+      use_acks, force_request_acks, force_request_acks_if_end_of_stream_pending);
 
   if (request_acks) {
     header->flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS;
@@ -726,10 +1583,11 @@ static int ert_comm_protocol_stream_retransmit_packet(ert_comm_protocol *comm_pr
   }
 
   uint32_t write_packet_flags =
-      request_acks ? ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_SET_RECEIVE_ACTIVE : 0;
+      (request_acks ? ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_SET_RECEIVE_ACTIVE : 0)
+      | ert_comm_protocol_get_priority_write_packet_flags(comm_protocol, port);
 
-  ert_log_info("Retransmitting packet: stream_id=%d, port=%d, sequence_number=%d, header_flags=%02X, write_packet_flags=%02X",
-      stream_id, port, sequence_number, header->flags, write_packet_flags);
+  ert_log_trace("Retransmitting packet: stream_id=%d, port=%d, sequence_number=%d, header_flags=%02X, write_packet_flags=%02X",
+      stream->info.stream_id, port, sequence_number, header->flags, write_packet_flags);
 
   uint32_t bytes_written = 0;
   int result = comm_protocol->protocol_device->write_packet(comm_protocol->protocol_device,
@@ -745,22 +1603,33 @@ static int ert_comm_protocol_stream_retransmit_packet(ert_comm_protocol *comm_pr
     return -EIO;
   }
 
-  ert_log_debug("retransmit: Wrote %d bytes", bytes_written);
+  ert_log_trace("retransmit: Wrote %d bytes", bytes_written);
 
-  uint32_t payload_bytes_written = bytes_written - ert_comm_protocol_packet_header_length;
+  uint32_t payload_bytes_written = bytes_written - ert_comm_protocol_packet_get_header_length(packet_data);
 
   ert_comm_protocol_increment_counter(comm_protocol, stream,
       ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT, bytes_written, payload_bytes_written);
   ert_comm_protocol_increment_counter(comm_protocol, stream,
       ERT_COMM_PROTOCOL_COUNTER_TYPE_RETRANSMIT, bytes_written, payload_bytes_written);
 
+  if (request_acks) {
+    // Acks are only forced when re-requesting them
+    ert_comm_protocol_transmit_stream_set_acknowledgement_requested(stream, force_request_acks, sequence_number);
+  }
+
   return request_acks ? 1 : 0;
 }
 
+/*
+ * With defer_ack_request set, no acks are requested, but the stream is marked as waiting for acks
+ * if they would have been requested. This allows retransmitting the history of multiple streams
+ * before switching to receive mode for the acks.
+ */
 static int ert_comm_protocol_stream_retransmit_packet_history(
-    ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream, bool use_acks)
+    ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream, bool use_acks, bool defer_ack_request)
 {
-  size_t total_packet_count = ert_comm_protocol_stream_packet_history_get_count(stream);
+  // Packets transmitted after the ack request are still in flight and are not retransmitted
+  size_t total_packet_count = ert_comm_protocol_transmit_stream_get_requested_packet_count(stream);
 
   if (total_packet_count == 0) {
     return 0;
@@ -768,23 +1637,36 @@ static int ert_comm_protocol_stream_retransmit_packet_history(
 
   bool acks_requested = false;
   size_t remaining_packet_count = total_packet_count;
-  for (size_t i = 0; i < stream->acknowledgement_interval_packet_count; i++) {
+  for (int32_t slot = stream->packet_history_first_slot;
+      slot != ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE && remaining_packet_count > 0;
+      slot = stream->packet_history[slot].next_slot) {
     uint32_t packet_length;
     uint8_t *packet_data;
 
-    bool packet_found = ert_comm_protocol_stream_packet_history_get_index(stream, i, &packet_length, &packet_data);
+    bool packet_found = ert_comm_protocol_stream_packet_history_get_slot_entry(stream, slot, &packet_length, &packet_data);
     if (!packet_found) {
       continue;
     }
 
     bool request_acks_for_last_packet_if_end_of_stream_pending = (remaining_packet_count == 1);
 
-    int result = ert_comm_protocol_stream_retransmit_packet(comm_protocol, stream, packet_length, packet_data,
+    bool deferred_request_acks = defer_ack_request && ert_comm_protocol_stream_is_retransmit_request_acks(stream,
         use_acks, false, request_acks_for_last_packet_if_end_of_stream_pending);
+    if (deferred_request_acks) {
+      stream->info.ack_request_pending = true;
+    }
+
+    int result = ert_comm_protocol_stream_retransmit_packet(comm_protocol, stream, packet_length, packet_data,
+        use_acks && !defer_ack_request, false, request_acks_for_last_packet_if_end_of_stream_pending);
     if (result < 0) {
       return result;
     }
 
+    if (deferred_request_acks) {
+      ert_comm_protocol_transmit_stream_set_acknowledgement_requested(stream, false,
+          ert_comm_protocol_packet_get_sequence_number(packet_data));
+    }
+
     remaining_packet_count--;
 
     // NOTE: Leave packet to history list until it is acknowledged
@@ -867,6 +1749,10 @@ static void ert_comm_protocol_packet_acknowledgement_timeout_callback(union sigv
 
   ert_log_info("Packet acknowledgement timeout reached, disabling reception for comm device");
 
+  if (comm_protocol->link_adaptation != NULL) {
+    ert_comm_link_adaptation_handle_report_timeout(comm_protocol->link_adaptation);
+  }
+
   result = comm_protocol->protocol_device->set_receive_active(comm_protocol->protocol_device, false);
   if (result < 0) {
     ert_log_error("Error disabling reception for comm protocol device, result %d", result);
@@ -906,7 +1792,7 @@ static void ert_comm_protocol_packet_acknowledgement_timeout_callback(union sigv
 
           pthread_mutex_lock(&stream->mutex);
 
-          result = ert_comm_protocol_stream_retransmit_packet_history(comm_protocol, stream, false);
+          result = ert_comm_protocol_stream_retransmit_packet_history(comm_protocol, stream, false, false);
           if (result < 0) {
             ert_log_error("Error retransmitting packet history for stream_id=%d port=%d",
                 stream->info.stream_id, stream->info.port);
@@ -927,7 +1813,7 @@ static void ert_comm_protocol_packet_acknowledgement_timeout_callback(union sigv
 
         pthread_mutex_lock(&stream->mutex);
 
-        result = ert_comm_protocol_stream_retransmit_packet_history(comm_protocol, stream, false);
+        result = ert_comm_protocol_stream_retransmit_packet_history(comm_protocol, stream, false, false);
         if (result < 0) {
           ert_log_error("Error retransmitting packet history for stream_id=%d port=%d",
               stream->info.stream_id, stream->info.port);
@@ -939,10 +1825,14 @@ static void ert_comm_protocol_packet_acknowledgement_timeout_callback(union sigv
         stream->info.ack_rerequest_count = 0;
         stream->info.end_of_stream_ack_rerequest_count = 0;
 
+        pthread_cond_broadcast(&stream->change_cond);
         pthread_mutex_unlock(&stream->mutex);
       } else {
         ert_log_warn("Maximum acknowledgement re-request count reached for stream_id=%d port=%d: stream failed", stream->info.stream_id, stream->info.port);
+        pthread_mutex_lock(&stream->mutex);
         stream->info.failed = true;
+        pthread_cond_broadcast(&stream->change_cond);
+        pthread_mutex_unlock(&stream->mutex);
       }
 
       return;
@@ -954,6 +1844,11 @@ static void ert_comm_protocol_packet_acknowledgement_timeout_callback(union sigv
       stream->info.ack_rerequest_count++;
     }
 
+    pthread_mutex_lock(&stream->mutex);
+    ert_comm_protocol_transmit_stream_back_off_acknowledgements(comm_protocol, stream);
+    uint32_t acknowledgement_timeout_millis = stream->info.ack_receive_timeout_millis;
+    pthread_mutex_unlock(&stream->mutex);
+
     pthread_mutex_unlock(&comm_protocol->transmit_streams_mutex);
 
     // Re-request acks for streams with pending end-of-stream so that we can have packet acknowledged and the stream closed
@@ -965,8 +1860,7 @@ static void ert_comm_protocol_packet_acknowledgement_timeout_callback(union sigv
       return;
     }
 
-    result = ert_comm_protocol_set_packet_acknowledgement_timeout(comm_protocol,
-        comm_protocol->config.stream_acknowledgement_receive_timeout_millis);
+    result = ert_comm_protocol_set_packet_acknowledgement_timeout(comm_protocol, acknowledgement_timeout_millis);
     if (result < 0) {
       ert_log_error("Error setting packet acknowledgement timeout, result %d", result);
       return;
@@ -1050,6 +1944,13 @@ static int ert_comm_protocol_receive_stream_find_or_create(ert_comm_protocol *co
   bool new_stream = false;
 
   if (stream == NULL) {
+    if (ert_comm_protocol_is_fec_repair_packet(info)) {
+      pthread_mutex_unlock(&comm_protocol->receive_streams_mutex);
+
+      // Repair packet for a stream that has not been seen or that has already ended
+      return -ENOENT;
+    }
+
     if (!comm_protocol->config.passive_mode && !comm_protocol->config.ignore_errors && !info->acks_enabled) {
       pthread_mutex_unlock(&comm_protocol->receive_streams_mutex);
 
@@ -1059,6 +1960,14 @@ static int ert_comm_protocol_receive_stream_find_or_create(ert_comm_protocol *co
       return -EPROTO;
     }
 
+    if (info->compressed && !comm_protocol->config.stream_compression) {
+      pthread_mutex_unlock(&comm_protocol->receive_streams_mutex);
+
+      ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_WARN, info,
+          "Invalid packet for new stream: compression not enabled");
+      return -EPROTO;
+    }
+
     if (!comm_protocol->config.ignore_errors && info->retransmit) {
       pthread_mutex_unlock(&comm_protocol->receive_streams_mutex);
 
@@ -1089,6 +1998,9 @@ static int ert_comm_protocol_receive_stream_find_or_create(ert_comm_protocol *co
     stream->used = true;
     stream->info.port = info->port;
     stream->info.acks_enabled = info->acks_enabled;
+    stream->info.acks_bitmap = info->acks_bitmap;
+    stream->info.extended_sequence_numbers = info->extended_sequence_numbers;
+    stream->info.compressed = info->compressed;
 
     pthread_mutex_unlock(&stream->mutex);
 
@@ -1097,6 +2009,12 @@ static int ert_comm_protocol_receive_stream_find_or_create(ert_comm_protocol *co
 
   if (info->acks_enabled) {
     stream->info.acks_enabled = true;
+    stream->info.acks_bitmap = info->acks_bitmap;
+  }
+
+  // Retransmitted packets do not have the FEC flag set
+  if (info->fec) {
+    stream->info.fec = true;
   }
 
   pthread_mutex_unlock(&comm_protocol->receive_streams_mutex);
@@ -1112,7 +2030,8 @@ static int ert_comm_protocol_receive_stream_put_data_from_packet_history(ert_com
   bool new_data = false;
 
   // Check if there are packets (in history list) that can be written to ring buffer
-  uint32_t next_acknowledged_sequence_number = ert_comm_protocol_get_next_sequence_number(stream->info.last_acknowledged_sequence_number);
+  uint32_t next_acknowledged_sequence_number = ert_comm_protocol_stream_get_next_sequence_number(stream,
+      stream->info.last_acknowledged_sequence_number);
   while (true) {
     uint32_t history_packet_length;
     uint8_t *history_packet_data;
@@ -1121,10 +2040,11 @@ static int ert_comm_protocol_receive_stream_put_data_from_packet_history(ert_com
         next_acknowledged_sequence_number, &history_packet_length, &history_packet_data);
 
     if (found) {
-      uint32_t payload_length = history_packet_length - ert_comm_protocol_packet_header_length;
-      uint8_t *payload_data = history_packet_data + ert_comm_protocol_packet_header_length;
+      uint32_t header_length = ert_comm_protocol_packet_get_header_length(history_packet_data);
+      uint32_t payload_length = history_packet_length - header_length;
+      uint8_t *payload_data = history_packet_data + header_length;
 
-      int result = ert_ring_buffer_write(stream->ring_buffer, payload_length, payload_data);
+      int result = ert_spsc_ring_buffer_write(stream->receive_buffer, payload_length, payload_data);
       if (result < 0) {
         ert_log_error("Error writing %d bytes to ring buffer", payload_length);
         return -EIO;
@@ -1140,15 +2060,15 @@ static int ert_comm_protocol_receive_stream_put_data_from_packet_history(ert_com
           ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE, history_packet_length, payload_length);
     } else {
       if (flush_until_last_transferred_packet) {
-        int8_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
-            next_acknowledged_sequence_number, stream->info.last_transferred_sequence_number);
+        int32_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
+            stream, next_acknowledged_sequence_number, stream->info.last_transferred_sequence_number);
         if (signed_distance_latest > 0) {
           break;
         }
 
         // Write zeroes to ring buffer, do not increment transferred data
         uint32_t packet_length = comm_protocol->max_packet_size;
-        int result = ert_ring_buffer_write_value(stream->ring_buffer, packet_length, 0);
+        int result = ert_spsc_ring_buffer_write_value(stream->receive_buffer, packet_length, 0);
         if (result < 0) {
           ert_log_error("Error writing %d bytes to ring buffer", packet_length);
           return -EIO;
@@ -1162,7 +2082,8 @@ static int ert_comm_protocol_receive_stream_put_data_from_packet_history(ert_com
 
     stream->info.last_acknowledged_sequence_number = next_acknowledged_sequence_number;
 
-    next_acknowledged_sequence_number = ert_comm_protocol_get_next_sequence_number(stream->info.last_acknowledged_sequence_number);
+    next_acknowledged_sequence_number = ert_comm_protocol_stream_get_next_sequence_number(stream,
+        stream->info.last_acknowledged_sequence_number);
   }
 
   return new_data ? 1 : 0;
@@ -1173,7 +2094,7 @@ static int ert_comm_protocol_receive_stream_put_data_for_expected_packet(ert_com
 {
   bool new_data = false;
 
-  int result = ert_ring_buffer_write(stream->ring_buffer, info->payload_length, info->payload);
+  int result = ert_spsc_ring_buffer_write(stream->receive_buffer, info->payload_length, info->payload);
   if (result < 0) {
     ert_log_error("Error writing %d bytes to ring buffer", info->payload_length);
     return -EIO;
@@ -1203,8 +2124,8 @@ static int ert_comm_protocol_receive_stream_put_data_for_retransmitted_packet(er
     ert_comm_protocol_stream *stream, ert_comm_protocol_packet_info *info)
 {
   int result;
-  int8_t signed_distance_after_last_accepted = ert_comm_protocol_stream_calculate_sequence_number_distance(
-      info->sequence_number, stream->info.last_acknowledged_sequence_number);
+  int32_t signed_distance_after_last_accepted = ert_comm_protocol_stream_calculate_sequence_number_distance(
+      stream, info->sequence_number, stream->info.last_acknowledged_sequence_number);
 
   if (signed_distance_after_last_accepted > 0) {
     // Packet sequence number is *after* stream->info.last_acknowledged_sequence_number
@@ -1214,7 +2135,7 @@ static int ert_comm_protocol_receive_stream_put_data_for_retransmitted_packet(er
       ert_comm_protocol_increment_counter(comm_protocol, stream,
           ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_DUPLICATE, info->raw_packet_length, info->payload_length);
 
-      ert_log_debug("Duplicate retransmitted packet");
+      ert_log_trace("Duplicate retransmitted packet");
     } else {
       if (comm_protocol->config.passive_mode) {
         result = ert_comm_protocol_stream_packet_history_push(stream, info->raw_packet_length, info->raw_packet_data);
@@ -1249,14 +2170,14 @@ static int ert_comm_protocol_receive_stream_put_data_for_retransmitted_packet(er
         }
       }
 
-      ert_log_debug("Added retransmitted packet to history list");
+      ert_log_trace("Added retransmitted packet to history list");
     }
   } else {
     // Packet already accepted
     ert_comm_protocol_increment_counter(comm_protocol, stream,
         ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_DUPLICATE, info->raw_packet_length, info->payload_length);
 
-    ert_log_debug("Duplicate packet that had already been acknowledged");
+    ert_log_trace("Duplicate packet that had already been acknowledged");
   }
 
   return 0;
@@ -1268,10 +2189,10 @@ static int ert_comm_protocol_receive_stream_put_data_for_out_of_order_packet(ert
   int result;
 
   // Error in transmission, out of order packet received
-  int8_t signed_distance = ert_comm_protocol_stream_calculate_sequence_number_distance(
-      info->sequence_number, expected_sequence_number);
-  int8_t signed_distance_after_last_accepted = ert_comm_protocol_stream_calculate_sequence_number_distance(
-      info->sequence_number, stream->info.last_acknowledged_sequence_number);
+  int32_t signed_distance = ert_comm_protocol_stream_calculate_sequence_number_distance(
+      stream, info->sequence_number, expected_sequence_number);
+  int32_t signed_distance_after_last_accepted = ert_comm_protocol_stream_calculate_sequence_number_distance(
+      stream, info->sequence_number, stream->info.last_acknowledged_sequence_number);
 
   if (signed_distance < 0) {
     // Packet from history, consider this as a duplicate packet
@@ -1289,9 +2210,9 @@ static int ert_comm_protocol_receive_stream_put_data_for_out_of_order_packet(ert
           ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_DUPLICATE, info->raw_packet_length, info->payload_length);
 
       if (signed_distance_after_last_accepted > 0) {
-        ert_log_debug("Duplicate future packet that had not been acknowledged");
+        ert_log_trace("Duplicate future packet that had not been acknowledged");
       } else {
-        ert_log_debug("Duplicate future packet that had already been acknowledged");
+        ert_log_trace("Duplicate future packet that had already been acknowledged");
       }
     } else {
       if (comm_protocol->config.passive_mode) {
@@ -1327,11 +2248,11 @@ static int ert_comm_protocol_receive_stream_put_data_for_out_of_order_packet(ert
         }
       }
 
-      ert_log_debug("Added future packet to list buffer");
+      ert_log_trace("Added future packet to list buffer");
 
       // Advanced sequence number to have it point to the larger sequence number received
-      int8_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
-          info->sequence_number, stream->info.current_sequence_number);
+      int32_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
+          stream, info->sequence_number, stream->info.current_sequence_number);
 
       if (signed_distance_latest > 0) {
         stream->info.current_sequence_number = info->sequence_number;
@@ -1353,20 +2274,22 @@ static int ert_comm_protocol_receive_stream_put_data(ert_comm_protocol *comm_pro
     return -EINVAL;
   }
 
-  if (!ert_ring_buffer_has_space_for(stream->ring_buffer, info->payload_length)) {
+  if (!ert_spsc_ring_buffer_has_space_for(stream->receive_buffer, info->payload_length)) {
     ert_log_error("Receive buffer overflow for stream_id=%d port=%d: used %d + received %d",
-        stream->info.stream_id, stream->info.port, ert_ring_buffer_get_used_bytes(stream->ring_buffer), info->payload_length);
+        stream->info.stream_id, stream->info.port, ert_spsc_ring_buffer_get_used_bytes(stream->receive_buffer),
+        info->payload_length);
     return -ENOBUFS;
   }
 
-  int8_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
-      info->sequence_number, stream->info.last_transferred_sequence_number);
+  int32_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
+      stream, info->sequence_number, stream->info.last_transferred_sequence_number);
 
   if (signed_distance_latest > 0) {
     stream->info.last_transferred_sequence_number = info->sequence_number;
   }
 
-  uint32_t expected_sequence_number = ert_comm_protocol_get_next_sequence_number(stream->info.current_sequence_number);
+  uint32_t expected_sequence_number = ert_comm_protocol_stream_get_next_sequence_number(stream,
+      stream->info.current_sequence_number);
   int result;
   bool new_data = info->end_of_stream;
 
@@ -1383,11 +2306,11 @@ static int ert_comm_protocol_receive_stream_put_data(ert_comm_protocol *comm_pro
     ert_comm_protocol_increment_counter(comm_protocol, stream,
         ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_SEQUENCE_NUMBER_ERROR, info->raw_packet_length, info->payload_length);
 
-    int8_t signed_distance = ert_comm_protocol_stream_calculate_sequence_number_distance(info->sequence_number, expected_sequence_number);
+    int32_t signed_distance = ert_comm_protocol_stream_calculate_sequence_number_distance(stream, info->sequence_number, expected_sequence_number);
 
     ert_log_warn("Sequence number incorrect for stream_id=%d port=%d: expected %d, received %d, last acknowledged %d",
         stream->info.stream_id, stream->info.port, expected_sequence_number, info->sequence_number, stream->info.last_acknowledged_sequence_number);
-    ert_log_debug("current=%d, expected=%d, last_acknowledged=%d, signed_distance=%d",
+    ert_log_trace("current=%d, expected=%d, last_acknowledged=%d, signed_distance=%d",
         info->sequence_number, expected_sequence_number, stream->info.last_acknowledged_sequence_number, signed_distance);
 
     if (info->acks_enabled) {
@@ -1413,7 +2336,7 @@ static int ert_comm_protocol_receive_stream_put_data(ert_comm_protocol *comm_pro
         return -EPROTO;
       }
 
-      result = ert_ring_buffer_write(stream->ring_buffer, info->payload_length, info->payload);
+      result = ert_spsc_ring_buffer_write(stream->receive_buffer, info->payload_length, info->payload);
       if (result < 0) {
         ert_log_error("Error writing %d bytes to ring buffer", info->payload_length);
         return -EIO;
@@ -1457,6 +2380,7 @@ static int ert_comm_protocol_receive_stream_put_data(ert_comm_protocol *comm_pro
 
   if (is_end_of_stream) {
     stream->info.end_of_stream = true;
+    ert_spsc_ring_buffer_wake(stream->receive_buffer);
   }
 
   ert_log_debug("End of stream state for port=%d, stream_id=%d: end_of_stream=%d", info->port, info->stream_id, stream->info.end_of_stream);
@@ -1464,30 +2388,269 @@ static int ert_comm_protocol_receive_stream_put_data(ert_comm_protocol *comm_pro
   return new_data ? 1 : 0;
 }
 
-static int ert_comm_protocol_stream_send_acknowledgements(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream)
-{
+/*
+ * Recovers a single lost packet of a packet group by combining the FEC repair packet with the other packets
+ * of the group using XOR. Must be called stream->mutex locked.
+ */
+static int ert_comm_protocol_receive_stream_put_data_from_fec_repair(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, ert_comm_protocol_packet_info *info)
+{
+  ert_comm_protocol_increment_counter(comm_protocol, stream,
+      ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_FEC_REPAIR, info->raw_packet_length, info->payload_length);
+
+  ert_comm_protocol_packet_fec_repair *repair = (ert_comm_protocol_packet_fec_repair *) info->payload;
+
+  if (info->payload_length < sizeof(ert_comm_protocol_packet_fec_repair)
+      || repair->packet_count == 0 || repair->packet_count > ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT) {
+    ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_WARN, info, "Invalid FEC repair packet");
+    return 0;
+  }
+
+  uint32_t repair_data_length = info->payload_length - (uint32_t) sizeof(ert_comm_protocol_packet_fec_repair);
+  uint8_t *repair_data = info->payload + sizeof(ert_comm_protocol_packet_fec_repair);
+
+  uint32_t header_length = info->header_length;
+  uint32_t sequence_number_count = ert_comm_protocol_stream_get_sequence_number_count(stream);
+  uint32_t missing_packet_count = 0;
+  uint32_t missing_sequence_number = 0;
+
+  for (uint32_t i = 0; i < repair->packet_count; i++) {
+    uint32_t sequence_number = (info->sequence_number + i) % sequence_number_count;
+    uint32_t slot = sequence_number % ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT;
+
+    if (stream->fec_packet_sequence_numbers[slot] != (int32_t) sequence_number) {
+      missing_packet_count++;
+      missing_sequence_number = sequence_number;
+    }
+  }
+
+  if (missing_packet_count != 1) {
+    if (missing_packet_count > 1) {
+      ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_INFO, info,
+          "Cannot recover %d lost packets using FEC repair packet", missing_packet_count);
+    }
+    return 0;
+  }
+
+  // The lost packet may have been accepted already
+  int32_t signed_distance_after_last_accepted = ert_comm_protocol_stream_calculate_sequence_number_distance(
+      stream, missing_sequence_number, stream->info.last_acknowledged_sequence_number);
+  if (signed_distance_after_last_accepted <= 0 || ert_comm_protocol_stream_packet_history_get(stream,
+      info->port, info->stream_id, missing_sequence_number, NULL, NULL)) {
+    return 0;
+  }
+
+  if (repair_data_length > comm_protocol->max_packet_size - header_length) {
+    ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_WARN, info, "Invalid FEC repair packet length");
+    return 0;
+  }
+
+  uint32_t slot = missing_sequence_number % ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT;
+  uint8_t *packet_data = ert_comm_protocol_receive_stream_fec_get_packet(comm_protocol, stream, missing_sequence_number);
+  uint8_t *payload = packet_data + header_length;
+  uint8_t flags = repair->flags;
+  uint8_t payload_length = repair->payload_length;
+
+  // The slot is reused for the recovered packet
+  stream->fec_packet_sequence_numbers[slot] = ERT_COMM_PROTOCOL_FEC_PACKET_SEQUENCE_NUMBER_NONE;
+
+  memcpy(payload, repair_data, repair_data_length);
+
+  for (uint32_t i = 0; i < repair->packet_count; i++) {
+    uint32_t sequence_number = (info->sequence_number + i) % sequence_number_count;
+    if (sequence_number == missing_sequence_number) {
+      continue;
+    }
+
+    uint8_t *group_packet_data = ert_comm_protocol_receive_stream_fec_get_packet(comm_protocol, stream, sequence_number);
+    uint32_t group_payload_length = stream->fec_packet_lengths[sequence_number % ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT]
+        - header_length;
+
+    if (group_payload_length > repair_data_length) {
+      ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_WARN, info, "FEC repair packet does not match packet group");
+      return 0;
+    }
+
+    flags ^= ((ert_comm_protocol_packet_header *) group_packet_data)->flags;
+    payload_length ^= (uint8_t) group_payload_length;
+
+    for (uint32_t j = 0; j < group_payload_length; j++) {
+      payload[j] ^= group_packet_data[header_length + j];
+    }
+  }
+
+  if (payload_length > repair_data_length) {
+    ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_WARN, info, "FEC repair packet does not match packet group");
+    return 0;
+  }
+
+  // Retransmitted packets of the group carry different flags, so restore the ones of the original packet
+  ert_comm_protocol_packet_set_header(packet_data, info->extended_sequence_numbers, info->compressed,
+      ((ert_comm_protocol_packet_header *) info->raw_packet_data)->port_stream_id, missing_sequence_number,
+      (uint8_t) ((flags & ~(ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS
+          | ERT_COMM_PROTOCOL_PACKET_FLAG_RETRANSMIT | ERT_COMM_PROTOCOL_PACKET_FLAG_FEC))
+          | ERT_COMM_PROTOCOL_PACKET_FLAG_FEC));
+
+  uint32_t packet_length = header_length + payload_length;
+
+  ert_comm_protocol_packet_info recovered_info;
+  int result = ert_comm_protocol_get_packet_info(packet_length, packet_data, &recovered_info);
+  if (result < 0) {
+    return 0;
+  }
+
+  stream->fec_packet_lengths[slot] = packet_length;
+  stream->fec_packet_sequence_numbers[slot] = (int32_t) missing_sequence_number;
+
+  // Packets following the lost one have usually been received already, so handle it like a retransmitted packet
+  recovered_info.retransmit = true;
+
+  ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_INFO, &recovered_info, "Recovered lost packet using FEC repair packet");
+
+  result = ert_comm_protocol_receive_stream_put_data(comm_protocol, stream, &recovered_info);
+  if (result < 0) {
+    return result;
+  }
+
+  ert_comm_protocol_increment_counter(comm_protocol, stream,
+      ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_FEC_RECOVERED, recovered_info.raw_packet_length, recovered_info.payload_length);
+
+  return result;
+}
+
+/*
+ * Appends pending acknowledgements of other receive streams that are being recovered by the transmitter
+ * with retransmissions, as the transmitter retransmits all affected streams in one pass, but requests acks
+ * only for the last one. Acknowledgements of streams receiving new data are not sent early, because the transmitter
+ * would otherwise retransmit packets that are still in flight.
+ */
+static void ert_comm_protocol_receive_streams_append_retransmission_acknowledgements(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *requesting_stream, bool acks_bitmap, uint32_t payload_buffer_length,
+    uint32_t *payload_length, uint8_t *payload)
+{
+  uint32_t max_payload_length = comm_protocol->max_packet_size - ert_comm_protocol_stream_get_header_length(requesting_stream);
+  if (max_payload_length > payload_buffer_length) {
+    max_payload_length = payload_buffer_length;
+  }
+
+  for (uint16_t i = 0; i < comm_protocol->config.receive_stream_count; i++) {
+    ert_comm_protocol_stream *stream = &comm_protocol->receive_streams[i];
+
+    if (stream == requesting_stream || *payload_length >= max_payload_length) {
+      continue;
+    }
+
+    pthread_mutex_lock(&stream->mutex);
+
+    if (!stream->used || !stream->info.acks_enabled || !stream->retransmission_received
+        || stream->acknowledgement_count == 0 || (acks_bitmap && !stream->info.acks_bitmap)
+        || stream->info.extended_sequence_numbers != requesting_stream->info.extended_sequence_numbers) {
+      pthread_mutex_unlock(&stream->mutex);
+      continue;
+    }
+
+    uint32_t stream_payload_length;
+    int result = ert_comm_protocol_stream_acknowledgements_create_payload_and_clear(stream, acks_bitmap,
+        max_payload_length - *payload_length, &stream_payload_length, payload + *payload_length);
+    pthread_mutex_unlock(&stream->mutex);
+    if (result < 0) {
+      // Acknowledgements that do not fit in the packet are sent when requested for the stream
+      continue;
+    }
+
+    ert_log_debug("Appended acks for stream being retransmitted: stream_id=%d, port=%d",
+        stream->info.stream_id, stream->info.port);
+
+    *payload_length += stream_payload_length;
+  }
+}
+
+/**
+ * Appends a link report to the acknowledgements if link adaptation is in use and the report fits in the same packet,
+ * as only the last packet of the acknowledgement stream would carry it. Returns true if the report was appended.
+ */
+static bool ert_comm_protocol_append_link_report(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *requesting_stream, uint32_t payload_buffer_length, uint32_t *payload_length,
+    uint8_t *payload)
+{
+  ert_comm_link_adaptation_report report;
+
+  if (comm_protocol->link_adaptation == NULL) {
+    return false;
+  }
+
+  uint32_t max_payload_length = comm_protocol->max_packet_size
+      - ert_comm_protocol_stream_get_header_length(requesting_stream);
+  if (max_payload_length > payload_buffer_length) {
+    max_payload_length = payload_buffer_length;
+  }
+  if (*payload_length + sizeof(ert_comm_protocol_packet_link_report) > max_payload_length) {
+    return false;
+  }
+
+  int result = ert_comm_link_adaptation_create_report(comm_protocol->link_adaptation, &report);
+  if (result < 0) {
+    return false;
+  }
+
+  float snr_quarter_db = report.snr * 4.0f;
+  float rssi_negated = -report.rssi;
+
+  ert_comm_protocol_packet_link_report *link_report =
+      (ert_comm_protocol_packet_link_report *) (payload + *payload_length);
+  link_report->data_rate_index = report.data_rate_index;
+  link_report->snr_quarter_db = (int8_t) (snr_quarter_db < INT8_MIN ? INT8_MIN
+      : (snr_quarter_db > INT8_MAX ? INT8_MAX : snr_quarter_db));
+  link_report->rssi_negated = (uint8_t) (rssi_negated < 0 ? 0 : (rssi_negated > UINT8_MAX ? UINT8_MAX : rssi_negated));
+
+  *payload_length += (uint32_t) sizeof(ert_comm_protocol_packet_link_report);
+
+  ert_log_debug("Appended link report: data_rate_index=%d snr=%f rssi=%f",
+      report.data_rate_index, report.snr, report.rssi);
+
+  return true;
+}
+
+static int ert_comm_protocol_stream_send_acknowledgements(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream)
+{
   int result;
   uint32_t payload_length;
-  uint8_t payload[comm_protocol->max_packet_size];
+  uint8_t payload[ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT * sizeof(ert_comm_protocol_packet_acknowledgement)];
+  bool acks_bitmap_allowed = comm_protocol->config.stream_acknowledgement_bitmap;
 
   ert_comm_protocol_log_stream_info(ERT_LOG_LEVEL_INFO, &stream->info, "Sending acks for stream");
 
   pthread_mutex_lock(&stream->mutex);
-  result = ert_comm_protocol_stream_acknowledgements_create_payload_and_clear(stream, &payload_length, payload);
+  bool acks_bitmap = ert_comm_protocol_stream_acknowledgements_use_bitmap(stream,
+      acks_bitmap_allowed && stream->info.acks_bitmap);
+  result = ert_comm_protocol_stream_acknowledgements_create_payload_and_clear(stream, acks_bitmap,
+      sizeof(payload), &payload_length, payload);
   pthread_mutex_unlock(&stream->mutex);
   if (result < 0) {
     ert_log_error("ert_comm_protocol_stream_acknowledgements_create_payload_and_clear failed with result %d", result);
     return result;
   }
 
+  ert_comm_protocol_receive_streams_append_retransmission_acknowledgements(comm_protocol, stream, acks_bitmap,
+      sizeof(payload), &payload_length, payload);
+
+  bool link_report = ert_comm_protocol_append_link_report(comm_protocol, stream, sizeof(payload),
+      &payload_length, payload);
+
   ert_comm_protocol_stream *ack_stream;
   result = ert_comm_protocol_transmit_stream_open(comm_protocol, ERT_COMM_PROTOCOL_STREAM_PORT_ACKNOWLEDGEMENTS,
-      &ack_stream, ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS);
+      &ack_stream, ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS | (acks_bitmap ? ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_BITMAP : 0)
+      | (stream->info.fec ? ERT_COMM_PROTOCOL_STREAM_FLAG_FEC : 0)
+      | (stream->info.extended_sequence_numbers ? ERT_COMM_PROTOCOL_STREAM_FLAG_EXTENDED_SEQUENCE_NUMBERS : 0));
   if (result < 0) {
     ert_log_error("Error opening transmit stream for acknowledgements, result %d", result);
     return result;
   }
 
+  pthread_mutex_lock(&ack_stream->mutex);
+  ack_stream->link_report = link_report;
+  pthread_mutex_unlock(&ack_stream->mutex);
+
   result = comm_protocol->protocol_device->set_receive_active(comm_protocol->protocol_device, false);
   if (result < 0) {
     ert_comm_protocol_transmit_stream_close(comm_protocol, ack_stream, true);
@@ -1498,6 +2661,7 @@ static int ert_comm_protocol_stream_send_acknowledgements(ert_comm_protocol *com
   uint32_t bytes_written;
   result = ert_comm_protocol_transmit_stream_write(comm_protocol, ack_stream, payload_length, payload, &bytes_written);
   if (result < 0) {
+    link_report = false;
     ert_log_error("Error writing acknowledgements packet to stream, result %d", result);
   }
 
@@ -1508,205 +2672,623 @@ static int ert_comm_protocol_stream_send_acknowledgements(ert_comm_protocol *com
     return -EIO;
   }
 
-  return 0;
+  // The transmitter switches data rate when it receives the report, so the receiver switches once it has been sent
+  if (link_report) {
+    ert_comm_link_adaptation_report_sent(comm_protocol->link_adaptation);
+  }
+
+  return 0;
+}
+
+typedef struct _ert_comm_protocol_acknowledgement_count {
+  bool used;
+  uint16_t stream_id;
+  uint16_t port;
+  uint32_t count;
+} ert_comm_protocol_acknowledgement_stats;
+
+static void ert_comm_protocol_count_acknowledgement_stats(size_t ack_stats_size,
+    ert_comm_protocol_acknowledgement_stats *ack_stats_array,
+    ert_comm_protocol_packet_acknowledgement *ack)
+{
+  uint16_t stream_id = (uint16_t) ert_comm_protocol_packet_get_stream_id(ack->port_stream_id);
+  uint16_t port = (uint16_t) ert_comm_protocol_packet_get_port(ack->port_stream_id);
+  ert_comm_protocol_acknowledgement_stats *ack_stats_unused = NULL;
+
+  for (size_t i = 0; i < ack_stats_size; i++) {
+    ert_comm_protocol_acknowledgement_stats *ack_stats = &ack_stats_array[i];
+
+    if (ack_stats->used) {
+      if (ack_stats->stream_id == stream_id && ack_stats->port == port) {
+        ack_stats->count++;
+        return;
+      }
+    } else {
+      if (ack_stats_unused == NULL) {
+        ack_stats_unused = ack_stats;
+      }
+    }
+  }
+
+  if (ack_stats_unused == NULL) {
+    ert_log_warn("Acknowledgement count statistics data full");
+  } else {
+    ack_stats_unused->used = true;
+    ack_stats_unused->stream_id = stream_id;
+    ack_stats_unused->port = port;
+    ack_stats_unused->count = 1;
+  }
+}
+
+static void ert_comm_protocol_log_acknowledgement_stats(size_t ack_stats_size,
+    ert_comm_protocol_acknowledgement_stats *ack_stats_array,
+    ert_comm_protocol_packet_info *ack_packet_info)
+{
+  if (!ert_log_is_enabled(ERT_LOG_LEVEL_INFO)) {
+    return;
+  }
+
+  size_t stats_message_length_remaining = 1024;
+  size_t stats_message_length = 0;
+  char stats_message[stats_message_length_remaining];
+
+  for (size_t i = 0; i < ack_stats_size; i++) {
+    ert_comm_protocol_acknowledgement_stats *ack_stats = &ack_stats_array[i];
+
+    if (!ack_stats->used) {
+      continue;
+    }
+
+    int len = snprintf(stats_message + stats_message_length, stats_message_length_remaining, "stream_id=%d port=%d count=%d | ",
+      ack_stats->stream_id, ack_stats->port, ack_stats->count);
+
+    stats_message_length_remaining -= len;
+    stats_message_length += len;
+  }
+
+
+  ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_INFO, ack_packet_info,
+      "Received acknowledgement packet for streams: %s", stats_message);
+}
+
+// Returns the longest acknowledgement receive timeout of streams with pending ack requests or zero if there are none
+static uint32_t ert_comm_protocol_transmit_streams_get_pending_acknowledgement_timeout(ert_comm_protocol *comm_protocol)
+{
+  uint32_t acknowledgement_timeout_millis = 0;
+
+  pthread_mutex_lock(&comm_protocol->transmit_streams_mutex);
+
+  for (uint16_t i = 0; i < comm_protocol->config.transmit_stream_count; i++) {
+    ert_comm_protocol_stream *stream = &comm_protocol->transmit_streams[i];
+
+    if (stream->used && !stream->info.end_of_stream && stream->info.acks_enabled && stream->info.ack_request_pending
+        && stream->info.ack_receive_timeout_millis > acknowledgement_timeout_millis) {
+      acknowledgement_timeout_millis = stream->info.ack_receive_timeout_millis;
+    }
+  }
+
+  pthread_mutex_unlock(&comm_protocol->transmit_streams_mutex);
+
+  return acknowledgement_timeout_millis;
+}
+
+// Resolves the transmit stream for an acknowledgement, looking up streams already referenced by the same
+// acknowledgement packet first to avoid taking the transmit streams mutex for every acknowledgement.
+// Returns the stream with stream->mutex locked.
+static ert_comm_protocol_stream *ert_comm_protocol_resolve_acknowledgement_stream(ert_comm_protocol *comm_protocol,
+    uint8_t port_stream_id, ert_comm_protocol_stream **ack_streams, bool *ack_streams_request_pending,
+    size_t *ack_streams_count)
+{
+  uint16_t stream_id = (uint16_t) ert_comm_protocol_packet_get_stream_id(port_stream_id);
+  uint16_t port = (uint16_t) ert_comm_protocol_packet_get_port(port_stream_id);
+
+  for (size_t i = 0; i < *ack_streams_count; i++) {
+    if (ack_streams[i]->info.stream_id == stream_id && ack_streams[i]->info.port == port) {
+      pthread_mutex_lock(&ack_streams[i]->mutex);
+      return ack_streams[i];
+    }
+  }
+
+  pthread_mutex_lock(&comm_protocol->transmit_streams_mutex);
+  ert_comm_protocol_stream *stream = ert_comm_protocol_transmit_stream_find(comm_protocol, stream_id, port);
+  pthread_mutex_unlock(&comm_protocol->transmit_streams_mutex);
+  if (stream == NULL) {
+    ert_log_error("Skipping ack: no transmit stream for stream_id=%d, port=%d", stream_id, port);
+    return NULL;
+  }
+
+  pthread_mutex_lock(&stream->mutex);
+
+  // The acknowledgement timeout and writers change the pending request under the stream mutex
+  ack_streams[*ack_streams_count] = stream;
+  ack_streams_request_pending[*ack_streams_count] = stream->info.ack_request_pending;
+  (*ack_streams_count)++;
+
+  return stream;
+}
+
+// Must be called stream->mutex locked
+static void ert_comm_protocol_handle_acknowledgement(ert_comm_protocol_stream *stream, uint32_t sequence_number)
+{
+  ert_log_trace("Handling acknowledgement for: stream_id=%d, port=%d, sequence_number=%d",
+    stream->info.stream_id, stream->info.port, sequence_number);
+
+  // Acknowledgements of streams using extended sequence numbers may respond to an earlier request
+  // while a later one is still pending, see ert_comm_protocol_handle_extended_acknowledgement()
+  if (!stream->info.extended_sequence_numbers) {
+    stream->info.ack_request_pending = false;
+  }
+
+  bool packet_found = ert_comm_protocol_stream_packet_history_pop(stream, stream->info.port, stream->info.stream_id,
+      sequence_number);
+  if (packet_found) {
+    stream->acknowledged_packet_count++;
+  } else {
+    ert_log_warn("Packet history does not contain packet for acknowledgement: stream_id=%d, port=%d, sequence_number=%d",
+      stream->info.stream_id, stream->info.port, sequence_number);
+  }
+
+  // Advanced last acknowledged sequence number to the latest sequence number
+  int32_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
+      stream, sequence_number, stream->info.last_acknowledged_sequence_number);
+
+  if (signed_distance_latest > 0) {
+    stream->info.last_acknowledged_sequence_number = sequence_number;
+  }
+}
+
+/*
+ * Handles an acknowledgement of a stream using extended sequence numbers: all packets up to the cumulative
+ * sequence number are removed from packet history, oldest first, followed by the packets acknowledged in the bitmap.
+ * The ack request is complete once the acknowledgement covers the sequence number of the latest request.
+ * Must be called stream->mutex locked.
+ */
+static void ert_comm_protocol_handle_extended_acknowledgement(ert_comm_protocol_stream *stream,
+    uint32_t cumulative_sequence_number, uint32_t sequence_number, uint32_t bitmap_length, uint8_t *bitmap)
+{
+  uint32_t sequence_number_count = ert_comm_protocol_stream_get_sequence_number_count(stream);
+  uint32_t latest_sequence_number = cumulative_sequence_number;
+
+  // Cumulative sequence number of an earlier stream using the same ID cannot be ahead of the transmitted packets
+  bool cumulative_valid = ert_comm_protocol_stream_calculate_sequence_number_distance(stream,
+      cumulative_sequence_number, stream->info.last_transferred_sequence_number) <= 0;
+  if (!cumulative_valid) {
+    ert_log_warn("Invalid cumulative acknowledgement for: stream_id=%d, port=%d, sequence_number=%d, "
+        "last_transferred_sequence_number=%d", stream->info.stream_id, stream->info.port,
+        cumulative_sequence_number, stream->info.last_transferred_sequence_number);
+    latest_sequence_number = stream->info.last_acknowledged_sequence_number;
+  } else {
+    uint32_t packet_length;
+    uint8_t *packet_data;
+
+    while (ert_comm_protocol_stream_packet_history_get_slot_entry(stream, stream->packet_history_first_slot,
+        &packet_length, &packet_data)) {
+      uint32_t history_sequence_number = ert_comm_protocol_packet_get_sequence_number(packet_data);
+      if (ert_comm_protocol_stream_calculate_sequence_number_distance(stream,
+          history_sequence_number, cumulative_sequence_number) > 0) {
+        break;
+      }
+      ert_comm_protocol_handle_acknowledgement(stream, history_sequence_number);
+    }
+  }
+
+  for (uint32_t bit = 0; bit < bitmap_length * 8; bit++) {
+    if (!(bitmap[bit / 8] & (1 << (bit % 8)))) {
+      continue;
+    }
+
+    uint32_t acknowledged_sequence_number = (sequence_number + bit) % sequence_number_count;
+    if (cumulative_valid && ert_comm_protocol_stream_calculate_sequence_number_distance(stream,
+        acknowledged_sequence_number, cumulative_sequence_number) <= 0) {
+      continue;
+    }
+
+    ert_comm_protocol_handle_acknowledgement(stream, acknowledged_sequence_number);
+
+    if (ert_comm_protocol_stream_calculate_sequence_number_distance(stream,
+        acknowledged_sequence_number, latest_sequence_number) > 0) {
+      latest_sequence_number = acknowledged_sequence_number;
+    }
+  }
+
+  if (ert_comm_protocol_stream_calculate_sequence_number_distance(stream,
+      latest_sequence_number, stream->acknowledgement_request_sequence_number) >= 0) {
+    stream->info.ack_request_pending = false;
+  }
+}
+
+// Processes transmit streams that have received acks after the guard interval has passed
+static int ert_comm_protocol_process_acknowledged_transmit_streams(ert_comm_protocol *comm_protocol)
+{
+  int result;
+
+  ert_comm_protocol_stream *ack_streams[comm_protocol->config.transmit_stream_count];
+  bool ack_streams_request_pending[comm_protocol->config.transmit_stream_count];
+  size_t ack_streams_count = 0;
+
+  pthread_mutex_lock(&comm_protocol->transmit_streams_mutex);
+
+  for (uint16_t i = 0; i < comm_protocol->config.transmit_stream_count; i++) {
+    ert_comm_protocol_stream *stream = &comm_protocol->transmit_streams[i];
+
+    pthread_mutex_lock(&stream->mutex);
+    if (stream->used && stream->acknowledgement_processing_pending) {
+      ack_streams[ack_streams_count] = stream;
+      ack_streams_request_pending[ack_streams_count] = stream->acknowledgement_retransmit_pending;
+      ack_streams_count++;
+    }
+    stream->acknowledgement_processing_pending = false;
+    stream->acknowledgement_retransmit_pending = false;
+    pthread_mutex_unlock(&stream->mutex);
+  }
+
+  pthread_mutex_unlock(&comm_protocol->transmit_streams_mutex);
+
+  if (ack_streams_count == 0) {
+    return 0;
+  }
+
+  // Switch mode back to transmit *after* updating streams with acknowledgement data
+  result = comm_protocol->protocol_device->set_receive_active(comm_protocol->protocol_device, false);
+  if (result < 0) {
+    ert_log_error("Error disabling reception for comm protocol device, result %d", result);
+  }
+
+  ert_log_debug("Acknowledgement packet handled, back to transmit mode");
+
+  ert_comm_protocol_stream *retransmit_streams[comm_protocol->config.transmit_stream_count];
+  size_t retransmit_streams_count = 0;
+
+  for (size_t i = 0; i < ack_streams_count; i++) {
+    ert_comm_protocol_stream *stream = ack_streams[i];
+
+    pthread_mutex_lock(&stream->mutex);
+
+    if (ert_comm_protocol_transmit_stream_is_end_of_stream(stream)) {
+      stream->info.end_of_stream = true;
+      pthread_mutex_unlock(&stream->mutex);
+
+      ert_log_debug("Ack handler detected end of stream for: stream_id=%d, port=%d",
+          stream->info.stream_id, stream->info.port);
+
+      if (stream->info.close_pending) {
+        ert_log_debug("Ack handler closing stream: stream_id=%d, port=%d",
+            stream->info.stream_id, stream->info.port);
+
+        ert_comm_protocol_transmit_stream_do_close(comm_protocol, stream);
+      }
+      continue;
+    }
+
+    // Streams that did not request acks may still have packets in flight
+    if (ack_streams_request_pending[i] && ert_comm_protocol_stream_packet_history_get_count(stream) > 0) {
+      retransmit_streams[retransmit_streams_count] = stream;
+      retransmit_streams_count++;
+    }
+
+    pthread_mutex_unlock(&stream->mutex);
+  }
+
+  // Retransmit packet history of all affected streams in one pass and request acks only for the last stream,
+  // so that the receiver can acknowledge all streams in a single acknowledgement packet
+  bool acks_requested = false;
+  uint32_t acknowledgement_timeout_millis = 0;
+  int retransmit_result = 0;
+
+  for (size_t i = 0; i < retransmit_streams_count; i++) {
+    ert_comm_protocol_stream *stream = retransmit_streams[i];
+    bool last_stream = (i == retransmit_streams_count - 1);
+
+    ert_log_debug("Ack handler retransmitting packet history for stream: stream_id=%d, port=%d",
+        stream->info.stream_id, stream->info.port);
+
+    pthread_mutex_lock(&stream->mutex);
+    result = ert_comm_protocol_stream_retransmit_packet_history(comm_protocol, stream, true, !last_stream);
+    pthread_mutex_unlock(&stream->mutex);
+    if (result < 0) {
+      ert_log_error("ert_comm_protocol_stream_retransmit_packet_history failed with result %d", result);
+      retransmit_result = -EIO;
+      continue;
+    }
+
+    if (result > 0) {
+      acks_requested = true;
+      acknowledgement_timeout_millis = stream->info.ack_receive_timeout_millis;
+    }
+  }
+
+  // Notify writers waiting for room in packet history
+  for (size_t i = 0; i < ack_streams_count; i++) {
+    ert_comm_protocol_stream *stream = ack_streams[i];
+
+    pthread_mutex_lock(&stream->mutex);
+    pthread_cond_broadcast(&stream->change_cond);
+    pthread_mutex_unlock(&stream->mutex);
+  }
+
+  if (acks_requested) {
+    result = ert_comm_protocol_set_packet_acknowledgement_timeout(comm_protocol, acknowledgement_timeout_millis);
+    if (result < 0) {
+      ert_log_error("Error setting packet acknowledgement timeout, result %d", result);
+      return -EIO;
+    }
+
+    ert_log_info("Packet history retransmitted and waiting for acks for %d streams", (int) retransmit_streams_count);
+  } else if ((acknowledgement_timeout_millis = ert_comm_protocol_transmit_streams_get_pending_acknowledgement_timeout(comm_protocol)) > 0) {
+    // Streams retransmitted without requesting acks were not acknowledged by the receiver:
+    // let the acknowledgement timeout re-request acks for them
+    result = ert_comm_protocol_set_packet_acknowledgement_timeout(comm_protocol, acknowledgement_timeout_millis);
+    if (result < 0) {
+      ert_log_error("Error setting packet acknowledgement timeout, result %d", result);
+      return -EIO;
+    }
+  }
+
+  return retransmit_result;
 }
 
-typedef struct _ert_comm_protocol_acknowledgement_count {
-  bool used;
-  uint16_t stream_id;
-  uint16_t port;
-  uint32_t count;
-} ert_comm_protocol_acknowledgement_stats;
 
-static void ert_comm_protocol_count_acknowledgement_stats(size_t ack_stats_size,
-    ert_comm_protocol_acknowledgement_stats *ack_stats_array,
-    ert_comm_protocol_packet_acknowledgement *ack)
+// Sends acks requested for receive streams after the guard interval has passed
+static void ert_comm_protocol_send_pending_acknowledgements(ert_comm_protocol *comm_protocol)
 {
-  uint16_t stream_id = (uint16_t) ert_comm_protocol_packet_get_stream_id(ack->port_stream_id);
-  uint16_t port = (uint16_t) ert_comm_protocol_packet_get_port(ack->port_stream_id);
-  ert_comm_protocol_acknowledgement_stats *ack_stats_unused = NULL;
+  for (uint16_t i = 0; i < comm_protocol->config.receive_stream_count; i++) {
+    ert_comm_protocol_stream *stream = &comm_protocol->receive_streams[i];
 
-  for (size_t i = 0; i < ack_stats_size; i++) {
-    ert_comm_protocol_acknowledgement_stats *ack_stats = &ack_stats_array[i];
+    pthread_mutex_lock(&stream->operation_mutex);
 
-    if (ack_stats->used) {
-      if (ack_stats->stream_id == stream_id && ack_stats->port == port) {
-        ack_stats->count++;
-        return;
-      }
-    } else {
-      if (ack_stats_unused == NULL) {
-        ack_stats_unused = ack_stats;
+    pthread_mutex_lock(&stream->mutex);
+    bool send_acks = stream->used && stream->acknowledgement_send_pending;
+    pthread_mutex_unlock(&stream->mutex);
+
+    if (send_acks) {
+      int result = ert_comm_protocol_stream_send_acknowledgements(comm_protocol, stream);
+      if (result < 0) {
+        ert_log_error("Error sending acknowledgements for stream_id=%d port=%d", stream->info.stream_id, stream->info.port);
       }
+
+      // Closing the stream waits for pending acks to be sent
+      pthread_mutex_lock(&stream->mutex);
+      stream->acknowledgement_send_pending = false;
+      pthread_cond_broadcast(&stream->change_cond);
+      pthread_mutex_unlock(&stream->mutex);
     }
+
+    pthread_mutex_unlock(&stream->operation_mutex);
   }
+}
 
-  if (ack_stats_unused == NULL) {
-    ert_log_warn("Acknowledgement count statistics data full");
-  } else {
-    ack_stats_unused->used = true;
-    ack_stats_unused->stream_id = stream_id;
-    ack_stats_unused->port = port;
-    ack_stats_unused->count = 1;
+static void ert_comm_protocol_process_acknowledgement_guard(ert_comm_protocol *comm_protocol)
+{
+  ert_comm_protocol_send_pending_acknowledgements(comm_protocol);
+
+  int result = ert_comm_protocol_process_acknowledged_transmit_streams(comm_protocol);
+  if (result < 0) {
+    ert_log_error("Error processing acknowledged transmit streams, result %d", result);
   }
 }
 
-static void ert_comm_protocol_log_acknowledgement_stats(size_t ack_stats_size,
-    ert_comm_protocol_acknowledgement_stats *ack_stats_array,
-    ert_comm_protocol_packet_info *ack_packet_info)
+static void ert_comm_protocol_acknowledgement_guard_callback(union sigval sv)
 {
-  size_t stats_message_length_remaining = 1024;
-  size_t stats_message_length = 0;
-  char stats_message[stats_message_length_remaining];
+  ert_comm_protocol *comm_protocol = (ert_comm_protocol *) sv.sival_ptr;
 
-  for (size_t i = 0; i < ack_stats_size; i++) {
-    ert_comm_protocol_acknowledgement_stats *ack_stats = &ack_stats_array[i];
+  ert_log_debug("Acknowledgement guard interval passed");
 
-    if (!ack_stats->used) {
-      continue;
-    }
+  ert_comm_protocol_process_acknowledgement_guard(comm_protocol);
+}
 
-    int len = snprintf(stats_message + stats_message_length, stats_message_length_remaining, "stream_id=%d port=%d count=%d | ",
-      ack_stats->stream_id, ack_stats->port, ack_stats->count);
+/*
+ * Acks are sent and received acks processed only after the guard interval has passed to let the other side
+ * finish switching mode. The guard interval timer is restarted for every new event, so that the guard interval
+ * is counted from the latest packet, and the thread delivering packets does not have to wait for it.
+ */
+static int ert_comm_protocol_schedule_acknowledgement_guard(ert_comm_protocol *comm_protocol)
+{
+  uint32_t milliseconds = comm_protocol->config.stream_acknowledgement_guard_interval_millis;
 
-    stats_message_length_remaining -= len;
-    stats_message_length += len;
+  if (milliseconds == 0) {
+    ert_comm_protocol_process_acknowledgement_guard(comm_protocol);
+    return 0;
   }
 
+  struct itimerspec ts = {0};
 
-  ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_INFO, ack_packet_info,
-      "Received acknowledgement packet for streams: %s", stats_message);
+  ts.it_value.tv_sec = ((long) milliseconds / 1000L);
+  ts.it_value.tv_nsec = ((long) milliseconds % 1000L) * 1000000L;
+
+  int result = timer_settime(comm_protocol->acknowledgement_guard_timer, 0, &ts, NULL);
+  if (result < 0) {
+    ert_log_error("Error setting acknowledgement guard timer: %s", strerror(errno));
+    ert_comm_protocol_process_acknowledgement_guard(comm_protocol);
+    return -EIO;
+  }
+
+  return 0;
 }
 
 static int ert_comm_protocol_handle_acknowledgement_packet(ert_comm_protocol *comm_protocol, ert_comm_protocol_packet_info *info)
 {
-  int result;
   size_t ack_stats_size = 16;
   ert_comm_protocol_acknowledgement_stats ack_stats[ack_stats_size];
-  size_t ack_size = sizeof(ert_comm_protocol_packet_acknowledgement);
-  size_t ack_count = info->payload_length / ack_size;
 
   memset(ack_stats, 0, ack_stats_size * sizeof(ert_comm_protocol_acknowledgement_stats));
 
   ert_comm_protocol_stream *ack_streams[comm_protocol->config.transmit_stream_count];
+  bool ack_streams_request_pending[comm_protocol->config.transmit_stream_count];
   size_t ack_streams_count = 0;
 
   ert_comm_protocol_clear_packet_acknowledgement_timeout(comm_protocol);
 
-  for (size_t i = 0; i < ack_count; i++) {
-    ert_comm_protocol_packet_acknowledgement *ack = (ert_comm_protocol_packet_acknowledgement *) (info->payload + (i * ack_size));
-    uint16_t stream_id = (uint16_t) ert_comm_protocol_packet_get_stream_id(ack->port_stream_id);
-    uint16_t port = (uint16_t) ert_comm_protocol_packet_get_port(ack->port_stream_id);
+  if (info->fec && !comm_protocol->fec_peer_supported) {
+    ert_log_info("Receiver supports FEC repair packets");
+    comm_protocol->fec_peer_supported = true;
+  }
 
-    ert_comm_protocol_count_acknowledgement_stats(ack_stats_size, ack_stats, ack);
+  // The flag enabling acks signals support for extended sequence numbers in acknowledgement packets
+  if ((info->acks_enabled || info->extended_sequence_numbers)
+      && !comm_protocol->extended_sequence_numbers_peer_supported) {
+    ert_log_info("Receiver supports extended sequence numbers");
+    comm_protocol->extended_sequence_numbers_peer_supported = true;
+  }
 
-    ert_log_debug("Handling acknowledgement for: stream_id=%d, port=%d, sequence_number=%d",
-      stream_id, port, ack->sequence_number);
+  // The retransmit flag signals support for compressed streams in acknowledgement packets
+  if (info->retransmit && !comm_protocol->compression_peer_supported) {
+    ert_log_info("Receiver supports compressed streams");
+    comm_protocol->compression_peer_supported = true;
+  }
 
-    pthread_mutex_lock(&comm_protocol->transmit_streams_mutex);
-    ert_comm_protocol_stream *stream = ert_comm_protocol_transmit_stream_find(comm_protocol, stream_id, port);
-    pthread_mutex_unlock(&comm_protocol->transmit_streams_mutex);
-    if (stream == NULL) {
-      ert_log_error("Skipping ack: no transmit stream for stream_id=%d, port=%d", stream_id, port);
-      continue;
-    }
+  // The link report follows the acknowledgements, so it is removed from the payload before parsing them
+  if (info->request_acks && info->payload_length >= sizeof(ert_comm_protocol_packet_link_report)) {
+    info->payload_length -= (uint32_t) sizeof(ert_comm_protocol_packet_link_report);
 
-    pthread_mutex_lock(&stream->mutex);
+    ert_comm_protocol_packet_link_report *link_report =
+        (ert_comm_protocol_packet_link_report *) (info->payload + info->payload_length);
 
-    stream->info.ack_request_pending = false;
+    if (comm_protocol->link_adaptation != NULL) {
+      ert_comm_link_adaptation_report report = {
+          .data_rate_index = link_report->data_rate_index,
+          .snr = (float) link_report->snr_quarter_db / 4.0f,
+          .rssi = -(float) link_report->rssi_negated,
+      };
 
-    bool packet_found = ert_comm_protocol_stream_packet_history_pop(stream, port, stream_id, ack->sequence_number);
-    if (!packet_found) {
-      ert_log_warn("Packet history does not contain packet for acknowledgement: stream_id=%d, port=%d, sequence_number=%d",
-        stream_id, port, ack->sequence_number);
+      ert_comm_link_adaptation_handle_report(comm_protocol->link_adaptation, &report);
     }
+  }
 
-    // Advanced last acknowledged sequence number to the latest sequence number
-    int8_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
-        ack->sequence_number, stream->info.last_acknowledged_sequence_number);
-
-    if (signed_distance_latest > 0) {
-      stream->info.last_acknowledged_sequence_number = ack->sequence_number;
-    }
+  if (info->extended_sequence_numbers) {
+    size_t offset = 0;
 
-    pthread_mutex_unlock(&stream->mutex);
+    while (offset + sizeof(ert_comm_protocol_packet_acknowledgement_extended) <= info->payload_length) {
+      ert_comm_protocol_packet_acknowledgement_extended *ack_extended =
+          (ert_comm_protocol_packet_acknowledgement_extended *) (info->payload + offset);
+      uint8_t *bitmap = info->payload + offset + sizeof(ert_comm_protocol_packet_acknowledgement_extended);
 
-    bool ack_stream_not_added = true;
-    for (size_t j = 0; j < ack_streams_count; j++) {
-      if (ack_streams[j] == stream) {
-        ack_stream_not_added = false;
+      offset += sizeof(ert_comm_protocol_packet_acknowledgement_extended) + ack_extended->bitmap_length;
+      if (offset > info->payload_length || ack_extended->bitmap_length > ERT_COMM_PROTOCOL_ACKNOWLEDGEMENT_BITMAP_LENGTH) {
+        ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_WARN, info,
+            "Invalid acknowledgement bitmap length %d", ack_extended->bitmap_length);
         break;
       }
-    }
 
-    if (ack_stream_not_added) {
-      ack_streams[ack_streams_count] = stream;
-      ack_streams_count++;
-    }
-  }
+      ert_comm_protocol_packet_acknowledgement ack = {
+          .port_stream_id = ack_extended->port_stream_id,
+          .sequence_number = ack_extended->cumulative_sequence_number_low,
+      };
 
-  ert_comm_protocol_log_acknowledgement_stats(ack_stats_size, ack_stats, info);
+      ert_comm_protocol_count_acknowledgement_stats(ack_stats_size, ack_stats, &ack);
 
-  usleep(comm_protocol->config.stream_acknowledgement_guard_interval_millis * 1000);
+      ert_comm_protocol_stream *stream = ert_comm_protocol_resolve_acknowledgement_stream(comm_protocol,
+          ack_extended->port_stream_id, ack_streams, ack_streams_request_pending, &ack_streams_count);
+      if (stream == NULL) {
+        continue;
+      }
 
-  // Switch mode back to transmit *after* updating streams with acknowledgement data
-  result = comm_protocol->protocol_device->set_receive_active(comm_protocol->protocol_device, false);
-  if (result < 0) {
-    ert_log_error("Error disabling reception for comm protocol device, result %d", result);
-  }
+      if (stream->info.extended_sequence_numbers) {
+        ert_comm_protocol_handle_extended_acknowledgement(stream,
+            (uint32_t) ack_extended->cumulative_sequence_number_low
+                | ((uint32_t) ack_extended->cumulative_sequence_number_high << 8),
+            (uint32_t) ack_extended->sequence_number_low | ((uint32_t) ack_extended->sequence_number_high << 8),
+            ack_extended->bitmap_length, bitmap);
+      } else {
+        ert_log_warn("Skipping extended ack for stream without extended sequence numbers: stream_id=%d, port=%d",
+            stream->info.stream_id, stream->info.port);
+      }
+      pthread_mutex_unlock(&stream->mutex);
+    }
+  } else if (info->acks_bitmap) {
+    size_t offset = 0;
+
+    while (offset + sizeof(ert_comm_protocol_packet_acknowledgement_bitmap) <= info->payload_length) {
+      ert_comm_protocol_packet_acknowledgement_bitmap *ack_bitmap =
+          (ert_comm_protocol_packet_acknowledgement_bitmap *) (info->payload + offset);
+      uint8_t *bitmap = info->payload + offset + sizeof(ert_comm_protocol_packet_acknowledgement_bitmap);
+
+      offset += sizeof(ert_comm_protocol_packet_acknowledgement_bitmap) + ack_bitmap->bitmap_length;
+      if (offset > info->payload_length || ack_bitmap->bitmap_length > ERT_COMM_PROTOCOL_ACKNOWLEDGEMENT_BITMAP_LENGTH) {
+        ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_WARN, info,
+            "Invalid acknowledgement bitmap length %d", ack_bitmap->bitmap_length);
+        break;
+      }
 
-  ert_log_debug("Acknowledgement packet handled, back to transmit mode");
+      ert_comm_protocol_stream *stream = ert_comm_protocol_resolve_acknowledgement_stream(comm_protocol,
+          ack_bitmap->port_stream_id, ack_streams, ack_streams_request_pending, &ack_streams_count);
 
-  // TODO: FIXME: The current implementation retransmits packets for one stream only
+      for (uint32_t bit = 0; bit < ack_bitmap->bitmap_length * 8; bit++) {
+        if (!(bitmap[bit / 8] & (1 << (bit % 8)))) {
+          continue;
+        }
 
-  for (size_t i = 0; i < ack_streams_count; i++) {
-    ert_comm_protocol_stream *stream = ack_streams[i];
+        ert_comm_protocol_packet_acknowledgement ack = {
+            .port_stream_id = ack_bitmap->port_stream_id,
+            .sequence_number = (uint8_t) (ack_bitmap->sequence_number + bit),
+        };
 
-    pthread_mutex_lock(&stream->mutex);
+        ert_comm_protocol_count_acknowledgement_stats(ack_stats_size, ack_stats, &ack);
 
-    if (ert_comm_protocol_transmit_stream_is_end_of_stream(stream)) {
-      stream->info.end_of_stream = true;
-      pthread_mutex_unlock(&stream->mutex);
+        if (stream != NULL) {
+          ert_comm_protocol_handle_acknowledgement(stream, ack.sequence_number);
+        }
+      }
 
-      ert_log_debug("Ack handler detected end of stream for: stream_id=%d, port=%d",
-          stream->info.stream_id, stream->info.port);
+      if (stream != NULL) {
+        pthread_mutex_unlock(&stream->mutex);
+      }
+    }
+  } else {
+    size_t ack_size = sizeof(ert_comm_protocol_packet_acknowledgement);
+    size_t ack_count = info->payload_length / ack_size;
 
-      if (stream->info.close_pending) {
-        ert_log_debug("Ack handler closing stream: stream_id=%d, port=%d",
-            stream->info.stream_id, stream->info.port);
+    for (size_t i = 0; i < ack_count; i++) {
+      ert_comm_protocol_packet_acknowledgement *ack = (ert_comm_protocol_packet_acknowledgement *) (info->payload + (i * ack_size));
 
-        ert_comm_protocol_transmit_stream_do_close(comm_protocol, stream);
+      ert_comm_protocol_count_acknowledgement_stats(ack_stats_size, ack_stats, ack);
+
+      ert_comm_protocol_stream *stream = ert_comm_protocol_resolve_acknowledgement_stream(comm_protocol,
+          ack->port_stream_id, ack_streams, ack_streams_request_pending, &ack_streams_count);
+      if (stream == NULL) {
+        continue;
       }
-      continue;
+
+      ert_comm_protocol_handle_acknowledgement(stream, ack->sequence_number);
+      pthread_mutex_unlock(&stream->mutex);
     }
+  }
 
-    ert_log_debug("Ack handler retransmitting packet history for stream: stream_id=%d, port=%d",
-        stream->info.stream_id, stream->info.port);
+  ert_comm_protocol_log_acknowledgement_stats(ack_stats_size, ack_stats, info);
 
-    result = ert_comm_protocol_stream_retransmit_packet_history(comm_protocol, stream, true);
-    pthread_mutex_unlock(&stream->mutex);
-    if (result < 0) {
-      ert_log_error("ert_comm_protocol_stream_retransmit_packet_history failed with result %d", result);
-      return -EIO;
+  for (size_t i = 0; i < ack_streams_count; i++) {
+    ert_comm_protocol_stream *stream = ack_streams[i];
+
+    pthread_mutex_lock(&stream->mutex);
+    // The ack request remains pending if the acks did not cover it
+    bool request_acknowledged = ack_streams_request_pending[i] && !stream->info.ack_request_pending;
+    if (request_acknowledged) {
+      ert_comm_protocol_transmit_stream_adapt_acknowledgements(comm_protocol, stream);
     }
+    stream->acknowledgement_processing_pending = true;
+    stream->acknowledgement_retransmit_pending = stream->acknowledgement_retransmit_pending || request_acknowledged;
+    pthread_mutex_unlock(&stream->mutex);
+  }
 
-    if (result > 0) {
-      // Acks requested
-      result = ert_comm_protocol_set_packet_acknowledgement_timeout(comm_protocol,
-          comm_protocol->config.stream_acknowledgement_receive_timeout_millis);
-      if (result < 0) {
-        ert_log_error("Error setting packet acknowledgement timeout, result %d", result);
-        return -EIO;
-      }
+  return ert_comm_protocol_schedule_acknowledgement_guard(comm_protocol);
+}
 
-      ert_log_info("Packet history retransmitted and waiting for acks for stream: stream_id=%d, port=%d",
-          stream->info.stream_id, stream->info.port);
+static void ert_comm_protocol_update_link_adaptation(ert_comm_protocol *comm_protocol)
+{
+  ert_comm_protocol_device *protocol_device = comm_protocol->protocol_device;
+  struct timespec timestamp;
+  float rssi, snr;
 
-      return 0;
-    }
+  if (comm_protocol->link_adaptation == NULL || protocol_device->get_received_packet_link_quality == NULL) {
+    return;
   }
 
-  return 0;
+  int result = protocol_device->get_received_packet_link_quality(protocol_device, &rssi, &snr);
+  if (result < 0) {
+    return;
+  }
+
+  ert_get_current_timestamp(&timestamp);
+  ert_comm_link_adaptation_update_received_packet(comm_protocol->link_adaptation, rssi, snr, &timestamp);
 }
 
 static void ert_comm_protocol_stream_receive_callback(uint32_t length, uint8_t *data, void *callback_context)
@@ -1721,11 +3303,9 @@ static void ert_comm_protocol_stream_receive_callback(uint32_t length, uint8_t *
     return;
   }
 
-  ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_DEBUG, &info, "Received packet");
+  ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_TRACE, &info, "Received packet");
 
-  if (info.request_acks) {
-    ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_INFO, &info, "Acknowledgements request received for");
-  }
+  ert_comm_protocol_update_link_adaptation(comm_protocol);
 
   if (ert_comm_protocol_is_acknowledgement_packet(&info)) {
     if (comm_protocol->config.passive_mode) {
@@ -1740,9 +3320,18 @@ static void ert_comm_protocol_stream_receive_callback(uint32_t length, uint8_t *
     return;
   }
 
+  if (info.request_acks) {
+    ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_INFO, &info, "Acknowledgements request received for");
+  }
+
+  bool fec_repair = ert_comm_protocol_is_fec_repair_packet(&info);
+
   ert_comm_protocol_stream *stream;
   result = ert_comm_protocol_receive_stream_find_or_create(comm_protocol, &info, &stream);
-  if (result < 0) {
+  if (result == -ENOENT) {
+    ert_comm_protocol_log_packet_info(ERT_LOG_LEVEL_DEBUG, &info, "Ignoring FEC repair packet for unknown stream");
+    return;
+  } else if (result < 0) {
     ert_comm_protocol_increment_counter(comm_protocol, stream,
         ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE_INVALID, info.raw_packet_length, info.payload_length);
 
@@ -1779,8 +3368,23 @@ static void ert_comm_protocol_stream_receive_callback(uint32_t length, uint8_t *
     return;
   }
 
+  bool send_acks = info.request_acks && !comm_protocol->config.passive_mode;
+
   pthread_mutex_lock(&stream->mutex);
-  result = ert_comm_protocol_receive_stream_put_data(comm_protocol, stream, &info);
+  if (fec_repair) {
+    result = ert_comm_protocol_receive_stream_put_data_from_fec_repair(comm_protocol, stream, &info);
+  } else {
+    if (stream->info.fec) {
+      ert_comm_protocol_receive_stream_fec_cache_packet(comm_protocol, stream, &info);
+    }
+    result = ert_comm_protocol_receive_stream_put_data(comm_protocol, stream, &info);
+  }
+  stream->retransmission_received = info.retransmit && !fec_repair;
+  // The reader may see the end of stream as soon as the mutex is unlocked, so the pending acks must be marked
+  // in the same critical section for closing the stream to wait for them
+  if (send_acks && (result >= 0 || result == -EAGAIN)) {
+    stream->acknowledgement_send_pending = true;
+  }
   pthread_mutex_unlock(&stream->mutex);
   if (result == -EAGAIN) {
     // Stream buffers are full, send acks if requested to get retransmissions
@@ -1791,29 +3395,15 @@ static void ert_comm_protocol_stream_receive_callback(uint32_t length, uint8_t *
     return;
   }
 
-  bool new_data = (result > 0);
-
-  if (info.request_acks && !comm_protocol->config.passive_mode) {
-    usleep(comm_protocol->config.stream_acknowledgement_guard_interval_millis * 1000);
+  pthread_mutex_unlock(&stream->operation_mutex);
 
-    result = ert_comm_protocol_stream_send_acknowledgements(comm_protocol, stream);
+  // The reader waiting for new data is woken up by the receive buffer, without locking the stream mutex
+  if (send_acks) {
+    result = ert_comm_protocol_schedule_acknowledgement_guard(comm_protocol);
     if (result < 0) {
-      ert_log_error("Error sending acknowledgements for stream_id=%d port=%d", info.stream_id, info.port);
+      ert_log_error("Error scheduling acknowledgements for stream_id=%d port=%d", info.stream_id, info.port);
     }
   }
-
-  pthread_mutex_unlock(&stream->operation_mutex);
-
-  ert_log_debug("Notify: stream_id=%d port=%d new_data=%d", info.stream_id, info.port, new_data);
-
-  if (new_data) {
-    // Notify stream about new data
-    pthread_mutex_lock(&stream->mutex);
-    pthread_cond_signal(&stream->change_cond);
-    pthread_mutex_unlock(&stream->mutex);
-
-    ert_log_debug("Notified: stream_id=%d port=%d new_data=%d", info.stream_id, info.port, new_data);
-  }
 }
 
 static void ert_comm_protocol_stream_fail_if_inactive(ert_comm_protocol *comm_protocol,
@@ -1868,6 +3458,11 @@ static void ert_comm_protocol_stream_fail_if_inactive(ert_comm_protocol *comm_pr
         stream_type, stream->info.stream_id, stream->info.port, inactivity_millis);
 
     stream->info.failed = true;
+    pthread_cond_broadcast(&stream->change_cond);
+  }
+
+  if (stream->receive_buffer != NULL) {
+    ert_spsc_ring_buffer_wake(stream->receive_buffer);
   }
 
   pthread_mutex_unlock(&stream->mutex);
@@ -1888,6 +3483,12 @@ static void ert_comm_protocol_stream_inactivity_check_callback(union sigval sv)
 
   ert_log_debug("Stream inactivity check started");
 
+  if (comm_protocol->link_adaptation != NULL) {
+    struct timespec timestamp;
+    ert_get_current_timestamp(&timestamp);
+    ert_comm_link_adaptation_check_receive_timeout(comm_protocol->link_adaptation, &timestamp);
+  }
+
   for (int i = 0; i < comm_protocol->config.receive_stream_count; i++) {
     ert_comm_protocol_stream *stream = &comm_protocol->receive_streams[i];
     ert_comm_protocol_stream_fail_if_inactive(comm_protocol, stream);
@@ -1933,6 +3534,12 @@ static int ert_comm_protocol_stream_inactivity_check_stop(ert_comm_protocol *com
   return 0;
 }
 
+void ert_comm_protocol_set_link_adaptation(ert_comm_protocol *comm_protocol,
+    ert_comm_link_adaptation *link_adaptation)
+{
+  comm_protocol->link_adaptation = link_adaptation;
+}
+
 int ert_comm_protocol_get_status(ert_comm_protocol *comm_protocol, ert_comm_protocol_status *status)
 {
   pthread_mutex_lock(&comm_protocol->status_mutex);
@@ -1955,6 +3562,42 @@ int ert_comm_protocol_create(
     ert_log_error("Stream listener callback must be specified");
     return -EINVAL;
   }
+  if (config->stream_fec_group_packet_count < 1
+      || config->stream_fec_group_packet_count > ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT) {
+    ert_log_error("Invalid FEC group packet count %d, must be between 1 and %d",
+        config->stream_fec_group_packet_count, ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT);
+    return -EINVAL;
+  }
+  if (config->stream_extended_sequence_numbers && (config->stream_window_packet_count < 1
+      || config->stream_window_packet_count > ERT_COMM_PROTOCOL_STREAM_WINDOW_MAX_PACKET_COUNT)) {
+    ert_log_error("Invalid stream window packet count %d, must be between 1 and %d",
+        config->stream_window_packet_count, ERT_COMM_PROTOCOL_STREAM_WINDOW_MAX_PACKET_COUNT);
+    return -EINVAL;
+  }
+  if (config->stream_acknowledgement_interval_packet_count < 1) {
+    ert_log_error("Invalid acknowledgement interval packet count %d, must be at least 1",
+        config->stream_acknowledgement_interval_packet_count);
+    return -EINVAL;
+  }
+  if (config->stream_acknowledgement_adaptive) {
+    if (config->stream_acknowledgement_min_interval_packet_count < 1
+        || config->stream_acknowledgement_min_interval_packet_count > config->stream_acknowledgement_interval_packet_count
+        || config->stream_acknowledgement_max_interval_packet_count < config->stream_acknowledgement_interval_packet_count
+        || config->stream_acknowledgement_max_interval_packet_count > ERT_COMM_PROTOCOL_SEQUENCE_NUMBER_COUNT / 2) {
+      ert_log_error("Invalid adaptive acknowledgement interval packet count %d, must be between minimum %d and maximum %d "
+          "that must not exceed %d", config->stream_acknowledgement_interval_packet_count,
+          config->stream_acknowledgement_min_interval_packet_count, config->stream_acknowledgement_max_interval_packet_count,
+          ERT_COMM_PROTOCOL_SEQUENCE_NUMBER_COUNT / 2);
+      return -EINVAL;
+    }
+    if (config->stream_acknowledgement_min_receive_timeout_millis > config->stream_acknowledgement_receive_timeout_millis
+        || config->stream_acknowledgement_max_receive_timeout_millis < config->stream_acknowledgement_receive_timeout_millis) {
+      ert_log_error("Invalid adaptive acknowledgement receive timeout %d ms, must be between minimum %d ms and maximum %d ms",
+          config->stream_acknowledgement_receive_timeout_millis, config->stream_acknowledgement_min_receive_timeout_millis,
+          config->stream_acknowledgement_max_receive_timeout_millis);
+      return -EINVAL;
+    }
+  }
 
   ert_comm_protocol *comm_protocol = calloc(1, sizeof(ert_comm_protocol));
   if (comm_protocol == NULL) {
@@ -1996,6 +3639,17 @@ int ert_comm_protocol_create(
   comm_protocol->next_transmit_stream_id = 0;
   comm_protocol->next_receive_stream_id = 0;
 
+  comm_protocol->status.acknowledgement_interval_packet_count = comm_protocol->config.stream_acknowledgement_interval_packet_count;
+  comm_protocol->status.acknowledgement_receive_timeout_millis = comm_protocol->config.stream_acknowledgement_receive_timeout_millis;
+
+  uint32_t acknowledgement_window_packet_count = comm_protocol->config.stream_acknowledgement_adaptive
+      ? comm_protocol->config.stream_acknowledgement_max_interval_packet_count
+      : comm_protocol->config.stream_acknowledgement_interval_packet_count;
+  if (comm_protocol->config.stream_extended_sequence_numbers
+      && comm_protocol->config.stream_window_packet_count > acknowledgement_window_packet_count) {
+    acknowledgement_window_packet_count = comm_protocol->config.stream_window_packet_count;
+  }
+
   comm_protocol->transmit_streams = calloc(comm_protocol->config.transmit_stream_count, sizeof(ert_comm_protocol_stream));
   if (comm_protocol->transmit_streams == NULL) {
     ert_log_fatal("Error allocating memory for comm protocol transmit streams: %s", strerror(errno));
@@ -2006,7 +3660,7 @@ int ert_comm_protocol_create(
   for (uint16_t stream_id = 0; stream_id < comm_protocol->config.transmit_stream_count; stream_id++) {
     ert_comm_protocol_stream *stream = &comm_protocol->transmit_streams[stream_id];
     stream->info.type = ERT_COMM_PROTOCOL_STREAM_TYPE_TRANSMIT;
-    stream->acknowledgement_interval_packet_count = comm_protocol->config.stream_acknowledgement_interval_packet_count;
+    stream->acknowledgement_window_packet_count = acknowledgement_window_packet_count;
 
     result = ert_ring_buffer_create(comm_protocol->max_packet_size, &stream->ring_buffer);
     if (result < 0) {
@@ -2014,36 +3668,41 @@ int ert_comm_protocol_create(
       goto error_transmit_streams;
     }
 
-    result = ert_buffer_pool_create(comm_protocol->max_packet_size, stream->acknowledgement_interval_packet_count,
+    result = ert_buffer_pool_create(comm_protocol->max_packet_size, stream->acknowledgement_window_packet_count,
         &stream->packet_history_buffer_pool);
     if (result < 0) {
       ert_log_error("Error initializing transmit stream packet history list pool");
       goto error_transmit_streams;
     }
 
-    stream->packet_history_data_length = calloc(
-        comm_protocol->config.stream_acknowledgement_interval_packet_count, sizeof(uint32_t));
-    if (stream->packet_history_data_length == NULL) {
+    stream->packet_history = calloc(ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT, sizeof(ert_comm_protocol_packet_history_entry));
+    if (stream->packet_history == NULL) {
       ert_log_error("Error allocating memory for comm protocol transmit stream packet history");
       result = -ENOMEM;
       goto error_transmit_streams;
     }
 
-    stream->packet_history_pointers = calloc(
-        comm_protocol->config.stream_acknowledgement_interval_packet_count, sizeof(uint8_t *));
-    if (stream->packet_history_pointers == NULL) {
-      ert_log_error("Error allocating memory for comm protocol transmit stream packet history data pointers");
-      result = -ENOMEM;
-      goto error_transmit_streams;
+    for (size_t slot = 0; slot < ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT; slot++) {
+      stream->packet_history[slot].previous_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+      stream->packet_history[slot].next_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
     }
+    stream->packet_history_first_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+    stream->packet_history_last_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
 
-    stream->acknowledgements = calloc(comm_protocol->config.stream_acknowledgement_interval_packet_count,
-        sizeof(ert_comm_protocol_packet_acknowledgement));
-    if (stream->acknowledgements == NULL) {
-      ert_log_error("Error allocating memory for comm protocol transmit stream acknowledgements");
+    stream->fec_packet_buffer = malloc(comm_protocol->max_packet_size);
+    if (stream->fec_packet_buffer == NULL) {
+      ert_log_error("Error allocating memory for comm protocol transmit stream FEC buffer");
       result = -ENOMEM;
       goto error_transmit_streams;
     }
+    ert_comm_protocol_stream_fec_clear(stream);
+
+    if (comm_protocol->config.stream_compression && comm_protocol->config.stream_compression_ports != 0) {
+      result = ert_comm_protocol_compressor_create(&stream->compressor);
+      if (result < 0) {
+        goto error_transmit_streams;
+      }
+    }
   }
 
   comm_protocol->receive_streams = calloc(comm_protocol->config.receive_stream_count, sizeof(ert_comm_protocol_stream));
@@ -2056,9 +3715,9 @@ int ert_comm_protocol_create(
   for (uint16_t i = 0; i < comm_protocol->config.receive_stream_count; i++) {
     ert_comm_protocol_stream *stream = &comm_protocol->receive_streams[i];
     stream->info.type = ERT_COMM_PROTOCOL_STREAM_TYPE_RECEIVE;
-    stream->acknowledgement_interval_packet_count = comm_protocol->config.stream_acknowledgement_interval_packet_count;
+    stream->acknowledgement_window_packet_count = acknowledgement_window_packet_count;
 
-    result = ert_ring_buffer_create(comm_protocol->receive_buffer_length_bytes, &stream->ring_buffer);
+    result = ert_spsc_ring_buffer_create(comm_protocol->receive_buffer_length_bytes, &stream->receive_buffer);
     if (result < 0) {
       ert_log_error("Error allocating memory for comm protocol receive stream buffer");
       goto error_receive_streams;
@@ -2082,36 +3741,41 @@ int ert_comm_protocol_create(
       goto error_receive_streams;
     }
 
-    result = ert_buffer_pool_create(comm_protocol->max_packet_size, stream->acknowledgement_interval_packet_count,
+    result = ert_buffer_pool_create(comm_protocol->max_packet_size, stream->acknowledgement_window_packet_count,
         &stream->packet_history_buffer_pool);
     if (result < 0) {
       ert_log_error("Error initializing receive stream packet history list pool");
       goto error_receive_streams;
     }
 
-    stream->packet_history_data_length = calloc(
-        comm_protocol->config.stream_acknowledgement_interval_packet_count, sizeof(uint32_t));
-    if (stream->packet_history_data_length == NULL) {
+    stream->packet_history = calloc(ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT, sizeof(ert_comm_protocol_packet_history_entry));
+    if (stream->packet_history == NULL) {
       ert_log_error("Error allocating memory for comm protocol receive stream packet history");
       result = -ENOMEM;
       goto error_receive_streams;
     }
 
-    stream->packet_history_pointers = calloc(
-        comm_protocol->config.stream_acknowledgement_interval_packet_count, sizeof(uint8_t *));
-    if (stream->packet_history_pointers == NULL) {
-      ert_log_error("Error allocating memory for comm protocol receive stream packet history data pointers");
-      result = -ENOMEM;
-      goto error_receive_streams;
+    for (size_t slot = 0; slot < ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_COUNT; slot++) {
+      stream->packet_history[slot].previous_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+      stream->packet_history[slot].next_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
     }
+    stream->packet_history_first_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
+    stream->packet_history_last_slot = ERT_COMM_PROTOCOL_PACKET_HISTORY_SLOT_NONE;
 
-    stream->acknowledgements = calloc(comm_protocol->config.stream_acknowledgement_interval_packet_count,
-        sizeof(ert_comm_protocol_packet_acknowledgement));
-    if (stream->acknowledgements == NULL) {
-      ert_log_error("Error allocating memory for comm protocol receive stream acknowledgements");
+    stream->fec_packet_buffer = malloc(ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT * comm_protocol->max_packet_size);
+    if (stream->fec_packet_buffer == NULL) {
+      ert_log_error("Error allocating memory for comm protocol receive stream FEC buffer");
       result = -ENOMEM;
       goto error_receive_streams;
     }
+    ert_comm_protocol_stream_fec_clear(stream);
+
+    if (comm_protocol->config.stream_compression) {
+      result = ert_comm_protocol_decompressor_create(&stream->decompressor);
+      if (result < 0) {
+        goto error_receive_streams;
+      }
+    }
   }
 
   protocol_device->set_receive_callback(protocol_device, ert_comm_protocol_stream_receive_callback, comm_protocol);
@@ -2129,6 +3793,19 @@ int ert_comm_protocol_create(
     goto error_receive_streams;
   }
 
+  struct sigevent acknowledgement_guard_sigev;
+
+  acknowledgement_guard_sigev.sigev_notify = SIGEV_THREAD;
+  acknowledgement_guard_sigev.sigev_notify_function = ert_comm_protocol_acknowledgement_guard_callback;
+  acknowledgement_guard_sigev.sigev_notify_attributes = NULL;
+  acknowledgement_guard_sigev.sigev_value.sival_ptr = comm_protocol;
+
+  result = timer_create(CLOCK_REALTIME, &acknowledgement_guard_sigev, &comm_protocol->acknowledgement_guard_timer);
+  if (result < 0) {
+    ert_log_error("Error creating acknowledgement guard timer: %s", strerror(errno));
+    goto error_acknowledgement_timeout_timer;
+  }
+
   struct sigevent stream_inactivity_check_sigev;
 
   stream_inactivity_check_sigev.sigev_notify = SIGEV_THREAD;
@@ -2139,7 +3816,7 @@ int ert_comm_protocol_create(
   result = timer_create(CLOCK_REALTIME, &stream_inactivity_check_sigev, &comm_protocol->stream_inactivity_check_timer);
   if (result < 0) {
     ert_log_error("Error creating stream inactivity check timer: %s", strerror(errno));
-    goto error_acknowledgement_timeout_timer;
+    goto error_acknowledgement_guard_timer;
   }
 
   result = ert_comm_protocol_stream_inactivity_check_start(comm_protocol);
@@ -2154,38 +3831,47 @@ int ert_comm_protocol_create(
 
   int error_result;
 
-  error_acknowledgement_timeout_timer:
-  error_result = timer_delete(comm_protocol->acknowledgement_timeout_timer);
-  if (error_result < 0) {
-    ert_log_error("Error deleting acknowledgement timeout timer: %s", strerror(errno));
-  }
-
   error_inactivity_check_timer:
   error_result = timer_delete(comm_protocol->stream_inactivity_check_timer);
   if (error_result < 0) {
     ert_log_error("Error deleting stream inactivity check timer: %s", strerror(errno));
   }
 
+  error_acknowledgement_guard_timer:
+  error_result = timer_delete(comm_protocol->acknowledgement_guard_timer);
+  if (error_result < 0) {
+    ert_log_error("Error deleting acknowledgement guard timer: %s", strerror(errno));
+  }
+
+  error_acknowledgement_timeout_timer:
+  error_result = timer_delete(comm_protocol->acknowledgement_timeout_timer);
+  if (error_result < 0) {
+    ert_log_error("Error deleting acknowledgement timeout timer: %s", strerror(errno));
+  }
+
   error_receive_streams:
   for (uint16_t i = 0; i < comm_protocol->config.receive_stream_count; i++) {
     ert_comm_protocol_stream *stream = &comm_protocol->receive_streams[i];
     pthread_cond_destroy(&stream->change_cond);
     pthread_mutex_destroy(&stream->mutex);
     pthread_mutex_destroy(&stream->operation_mutex);
-    if (stream->acknowledgements != NULL) {
-      free(stream->acknowledgements);
+    if (stream->fec_packet_buffer != NULL) {
+      free(stream->fec_packet_buffer);
+    }
+    if (stream->compressor != NULL) {
+      ert_comm_protocol_compressor_destroy(stream->compressor);
     }
-    if (stream->packet_history_pointers != NULL) {
-      free(stream->packet_history_pointers);
+    if (stream->decompressor != NULL) {
+      ert_comm_protocol_decompressor_destroy(stream->decompressor);
     }
-    if (stream->packet_history_data_length != NULL) {
-      free(stream->packet_history_data_length);
+    if (stream->packet_history != NULL) {
+      free(stream->packet_history);
     }
     if (stream->packet_history_buffer_pool != NULL) {
       ert_buffer_pool_destroy(stream->packet_history_buffer_pool);
     }
-    if (stream->ring_buffer != NULL) {
-      ert_ring_buffer_destroy(stream->ring_buffer);
+    if (stream->receive_buffer != NULL) {
+      ert_spsc_ring_buffer_destroy(stream->receive_buffer);
     }
   }
 
@@ -2194,14 +3880,17 @@ int ert_comm_protocol_create(
   error_transmit_streams:
   for (uint16_t i = 0; i < comm_protocol->config.transmit_stream_count; i++) {
     ert_comm_protocol_stream *stream = &comm_protocol->transmit_streams[i];
-    if (stream->acknowledgements != NULL) {
-      free(stream->acknowledgements);
+    if (stream->fec_packet_buffer != NULL) {
+      free(stream->fec_packet_buffer);
     }
-    if (stream->packet_history_pointers != NULL) {
-      free(stream->packet_history_pointers);
+    if (stream->compressor != NULL) {
+      ert_comm_protocol_compressor_destroy(stream->compressor);
     }
-    if (stream->packet_history_data_length != NULL) {
-      free(stream->packet_history_data_length);
+    if (stream->decompressor != NULL) {
+      ert_comm_protocol_decompressor_destroy(stream->decompressor);
+    }
+    if (stream->packet_history != NULL) {
+      free(stream->packet_history);
     }
     if (stream->packet_history_buffer_pool != NULL) {
       ert_buffer_pool_destroy(stream->packet_history_buffer_pool);
@@ -2239,6 +3928,11 @@ int ert_comm_protocol_destroy(ert_comm_protocol *comm_protocol)
     ert_log_error("Error deleting acknowledgement timeout timer: %s", strerror(errno));
   }
 
+  result = timer_delete(comm_protocol->acknowledgement_guard_timer);
+  if (result < 0) {
+    ert_log_error("Error deleting acknowledgement guard timer: %s", strerror(errno));
+  }
+
   result = timer_delete(comm_protocol->stream_inactivity_check_timer);
   if (result < 0) {
     ert_log_error("Error deleting stream inactivity check timer: %s", strerror(errno));
@@ -2246,22 +3940,24 @@ int ert_comm_protocol_destroy(ert_comm_protocol *comm_protocol)
 
   for (uint16_t i = 0; i < comm_protocol->config.receive_stream_count; i++) {
     ert_comm_protocol_stream *stream = &comm_protocol->receive_streams[i];
-    free(stream->acknowledgements);
-    free(stream->packet_history_pointers);
-    free(stream->packet_history_data_length);
+    free(stream->fec_packet_buffer);
+    ert_comm_protocol_compressor_destroy(stream->compressor);
+    ert_comm_protocol_decompressor_destroy(stream->decompressor);
+    free(stream->packet_history);
     ert_buffer_pool_destroy(stream->packet_history_buffer_pool);
     pthread_cond_destroy(&stream->change_cond);
     pthread_mutex_destroy(&stream->mutex);
     pthread_mutex_destroy(&stream->operation_mutex);
-    ert_ring_buffer_destroy(stream->ring_buffer);
+    ert_spsc_ring_buffer_destroy(stream->receive_buffer);
   }
   free(comm_protocol->receive_streams);
 
   for (uint16_t i = 0; i < comm_protocol->config.transmit_stream_count; i++) {
     ert_comm_protocol_stream *stream = &comm_protocol->transmit_streams[i];
-    free(stream->acknowledgements);
-    free(stream->packet_history_pointers);
-    free(stream->packet_history_data_length);
+    free(stream->fec_packet_buffer);
+    ert_comm_protocol_compressor_destroy(stream->compressor);
+    ert_comm_protocol_decompressor_destroy(stream->decompressor);
+    free(stream->packet_history);
     ert_buffer_pool_destroy(stream->packet_history_buffer_pool);
     ert_ring_buffer_destroy(stream->ring_buffer);
   }
@@ -2291,15 +3987,14 @@ static int ert_comm_protocol_stream_init_packet_buffer(ert_comm_protocol_stream
     return -EINVAL;
   }
 
-  ert_comm_protocol_packet_header packet_header;
+  uint8_t packet_header[sizeof(ert_comm_protocol_packet_header_extended)];
 
-  packet_header.identifier = ERT_COMM_PROTOCOL_PACKET_IDENTIFIER;
-  packet_header.sequence_number = (uint8_t) (stream->info.current_sequence_number & 0xFF);
-  packet_header.port_stream_id = (uint8_t) (ert_comm_protocol_packet_set_port(stream->info.port)
-                                 | ert_comm_protocol_packet_set_stream_id(stream->info.stream_id));
-  packet_header.flags = 0;
+  ert_comm_protocol_packet_set_header(packet_header, stream->info.extended_sequence_numbers,
+      stream->info.compressed, (uint8_t) (ert_comm_protocol_packet_set_port(stream->info.port)
+          | ert_comm_protocol_packet_set_stream_id(stream->info.stream_id)),
+      stream->info.current_sequence_number, 0);
 
-  ert_ring_buffer_write(stream->ring_buffer, ert_comm_protocol_packet_header_length, (uint8_t *) &packet_header);
+  ert_ring_buffer_write(stream->ring_buffer, ert_comm_protocol_stream_get_header_length(stream), packet_header);
 
   return 0;
 }
@@ -2347,9 +4042,39 @@ int ert_comm_protocol_transmit_stream_open(ert_comm_protocol *comm_protocol, uin
   stream->used = true;
   stream->info.acks_enabled = (stream_flags & ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED) ? true : false;
   stream->info.acks = (stream_flags & ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS) ? true : false;
+  stream->info.acks_bitmap = (stream_flags & ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_BITMAP)
+      || (stream->info.acks_enabled && comm_protocol->config.stream_acknowledgement_bitmap);
+  // Extended sequence numbers are used only after the receiver has signaled support for them
+  stream->info.extended_sequence_numbers = (stream_flags & ERT_COMM_PROTOCOL_STREAM_FLAG_EXTENDED_SEQUENCE_NUMBERS)
+      || (stream->info.acks_enabled && comm_protocol->config.stream_extended_sequence_numbers
+          && comm_protocol->extended_sequence_numbers_peer_supported);
+  stream->transmit_window_packet_count = stream->info.extended_sequence_numbers
+      ? ert_comm_protocol_limit_value(comm_protocol->config.stream_window_packet_count, 1,
+          stream->acknowledgement_window_packet_count) : 0;
+  // FEC is negotiated using acknowledgements, acknowledgement streams only signal support for it
+  stream->info.fec = ((stream_flags & ERT_COMM_PROTOCOL_STREAM_FLAG_FEC)
+      || (stream->info.acks_enabled && comm_protocol->config.stream_fec))
+      && (stream->info.acks_enabled || stream->info.acks)
+      && comm_protocol->max_packet_size <= ERT_COMM_PROTOCOL_FEC_MAX_PACKET_LENGTH;
   stream->info.start_of_stream = true;
   stream->info.current_sequence_number = 1;
   stream->info.port = (uint8_t) (port & 0x0F);
+  // Compression is used for the configured ports only after the receiver has signaled support for it
+  stream->info.compressed = stream->compressor != NULL
+      && ((stream_flags & ERT_COMM_PROTOCOL_STREAM_FLAG_COMPRESSION)
+          || (stream->info.acks_enabled && comm_protocol->compression_peer_supported
+              && (comm_protocol->config.stream_compression_ports & ERT_COMM_PROTOCOL_PORT_MASK(stream->info.port))));
+
+  // New streams start from the acknowledgement interval and timeout adapted to the link so far
+  pthread_mutex_lock(&comm_protocol->status_mutex);
+  stream->info.ack_interval_packet_count = comm_protocol->status.acknowledgement_interval_packet_count;
+  stream->info.ack_receive_timeout_millis = comm_protocol->status.acknowledgement_receive_timeout_millis;
+  stream->info.round_trip_time_millis = comm_protocol->status.round_trip_time_millis;
+  stream->info.round_trip_time_deviation_millis = comm_protocol->status.round_trip_time_deviation_millis;
+  stream->info.packet_loss_ratio = comm_protocol->status.packet_loss_ratio;
+  pthread_mutex_unlock(&comm_protocol->status_mutex);
+  stream->smoothed_request_packet_count = (float) stream->info.ack_interval_packet_count;
+  stream->smoothed_lost_packet_count = stream->info.packet_loss_ratio * stream->smoothed_request_packet_count;
 
   ert_ring_buffer_clear(stream->ring_buffer);
   ert_buffer_pool_clear(stream->packet_history_buffer_pool);
@@ -2393,7 +4118,7 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
 
   int result;
 
-  ert_log_debug("Stream flush: stream_id=%d, port=%d, buffer_used=%d",
+  ert_log_trace("Stream flush: stream_id=%d, port=%d, buffer_used=%d",
       stream->info.stream_id, stream->info.port, ert_ring_buffer_get_used_bytes(stream->ring_buffer));
 
   if (!end_of_stream && ert_ring_buffer_get_used_bytes(stream->ring_buffer) == 0) {
@@ -2417,12 +4142,45 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
     packet_flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_ENABLED;
   }
 
+  if (stream->info.acks_bitmap) {
+    packet_flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_BITMAP;
+  }
+
+  if (stream->info.fec) {
+    packet_flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_FEC;
+  }
+
+  bool fec_group_complete = false;
+  bool fec_repair = false;
+
   if (stream->info.acks) {
     packet_flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS;
+
+    if (comm_protocol->config.stream_extended_sequence_numbers) {
+      packet_flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_EXTENDED_SEQUENCE_NUMBERS_SUPPORTED;
+    }
+    if (comm_protocol->config.stream_compression) {
+      packet_flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_COMPRESSION_SUPPORTED;
+    }
+    if (stream->link_report) {
+      packet_flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_LINK_REPORT;
+    }
   } else {
     request_acks = (stream->info.acks_enabled && end_of_stream)
-        || ert_comm_protocol_transmit_stream_is_request_acks(stream);
-    if (request_acks) {
+        || ert_comm_protocol_transmit_stream_is_request_acks(stream)
+        || ert_comm_protocol_transmit_stream_is_window_filled(stream);
+
+    // The end-of-stream packet is not part of a packet group: the receive stream ends once it is received,
+    // so the repair packet for the packets before it is transmitted first
+    if (ert_comm_protocol_transmit_stream_is_fec_enabled(stream)) {
+      fec_group_complete = end_of_stream || request_acks
+          || (stream->fec_group_packet_count + 1 >= comm_protocol->config.stream_fec_group_packet_count);
+      fec_repair = fec_group_complete && comm_protocol->fec_peer_supported
+          && (!end_of_stream || stream->fec_group_packet_count > 0);
+    }
+
+    // Acks are requested with the repair packet, so that the receiver can recover a lost packet of the group first
+    if (request_acks && !(fec_repair && !end_of_stream)) {
       packet_flags |= ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS;
     }
   }
@@ -2440,10 +4198,10 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
   ert_comm_protocol_packet_header *header =
       (ert_comm_protocol_packet_header *) ert_ring_buffer_get_address(stream->ring_buffer);
 
-  ert_log_debug("Stream flush: Packet header: stream_id=%d, port=%d, sequence_number=%d, buffer_used=%d " \
+  ert_log_trace("Stream flush: Packet header: stream_id=%d, port=%d, sequence_number=%d, buffer_used=%d " \
       "start_of_stream=%d, end_of_stream=%d, acks_enabled=%d, request_acks=%d, acks=%d, retransmit=%d",
       ert_comm_protocol_packet_get_stream_id(header->port_stream_id), ert_comm_protocol_packet_get_port(header->port_stream_id),
-      header->sequence_number, ert_ring_buffer_get_used_bytes(stream->ring_buffer),
+      ert_comm_protocol_packet_get_sequence_number(buffer), ert_ring_buffer_get_used_bytes(stream->ring_buffer),
       (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_START_OF_STREAM) ? true : false,
       (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_END_OF_STREAM) ? true : false,
       (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_ENABLED) ? true : false,
@@ -2451,7 +4209,8 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
       (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS) ? true : false,
       (header->flags & ERT_COMM_PROTOCOL_PACKET_FLAG_RETRANSMIT) ? true : false);
 
-  uint32_t sequence_number = header->sequence_number;
+  uint32_t sequence_number = ert_comm_protocol_packet_get_sequence_number(buffer);
+  uint32_t header_length = ert_comm_protocol_stream_get_header_length(stream);
 
   if (stream->info.acks_enabled) {
     uint16_t port = (uint16_t) ert_comm_protocol_packet_get_port(header->port_stream_id);
@@ -2461,11 +4220,19 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
       // Duplicate packet
       ert_comm_protocol_increment_counter(comm_protocol, stream,
           ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT_DUPLICATE,
-          bytes_to_write, bytes_to_write - ert_comm_protocol_packet_header_length);
+          bytes_to_write, bytes_to_write - header_length);
 
       ert_log_warn("Transmitting packet that is already in packet history list");
     } else {
-      result = ert_comm_protocol_stream_packet_history_push(stream, bytes_to_write, buffer);
+      // Packet history is limited to the current acknowledgement interval, so that packets are not transmitted
+      // while waiting for acks and only the packets covered by the acks are retransmitted. Streams using
+      // extended sequence numbers keep transmitting until the window of unacknowledged packets is full.
+      if (ert_comm_protocol_stream_packet_history_get_count(stream)
+          >= ert_comm_protocol_transmit_stream_get_window_packet_count(stream)) {
+        result = -ENOBUFS;
+      } else {
+        result = ert_comm_protocol_stream_packet_history_push(stream, bytes_to_write, buffer);
+      }
       if (result < 0) {
         pthread_mutex_unlock(&stream->mutex);
         ert_log_info("Packet history list full, requesting acks again");
@@ -2473,15 +4240,33 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
         return -EAGAIN;
       }
 
-      ert_log_debug("Added transmitted packet to packet history list");
+      ert_log_trace("Added transmitted packet to packet history list");
     }
   }
 
+  uint32_t fec_repair_packet_length = 0;
+  bool request_acks_with_fec_repair = fec_repair && !end_of_stream && request_acks;
+
+  if (ert_comm_protocol_transmit_stream_is_fec_enabled(stream) && !end_of_stream) {
+    ert_comm_protocol_transmit_stream_fec_add_packet(comm_protocol, stream, bytes_to_write, buffer);
+  }
+  if (fec_repair) {
+    fec_repair_packet_length = ert_comm_protocol_transmit_stream_fec_create_repair_packet(stream,
+        request_acks_with_fec_repair);
+  } else if (fec_group_complete) {
+    stream->fec_group_packet_count = 0;
+  }
+
   uint32_t write_packet_flags =
-      request_acks ? ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_SET_RECEIVE_ACTIVE : 0;
+      ((request_acks && !request_acks_with_fec_repair) ? ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_SET_RECEIVE_ACTIVE : 0)
+      | ert_comm_protocol_get_priority_write_packet_flags(comm_protocol, stream->info.port);
 
   pthread_mutex_unlock(&stream->mutex);
 
+  if (fec_repair && end_of_stream) {
+    ert_comm_protocol_transmit_stream_fec_write_repair_packet(comm_protocol, stream, fec_repair_packet_length, false);
+  }
+
   uint32_t bytes_written = 0;
   result = comm_protocol->protocol_device->write_packet(comm_protocol->protocol_device,
       bytes_to_write, buffer, write_packet_flags, &bytes_written);
@@ -2490,6 +4275,11 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
     return -EIO;
   }
 
+  if (fec_repair && !end_of_stream) {
+    ert_comm_protocol_transmit_stream_fec_write_repair_packet(comm_protocol, stream, fec_repair_packet_length,
+        request_acks_with_fec_repair);
+  }
+
   pthread_mutex_lock(&stream->mutex);
 
   result = ert_comm_protocol_stream_update_transferred_packet_timestamp(stream);
@@ -2503,23 +4293,22 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
     stream->info.start_of_stream = false;
   }
 
-  int8_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
-      sequence_number, stream->info.last_transferred_sequence_number);
+  int32_t signed_distance_latest = ert_comm_protocol_stream_calculate_sequence_number_distance(
+      stream, sequence_number, stream->info.last_transferred_sequence_number);
 
   if (signed_distance_latest > 0) {
     stream->info.last_transferred_sequence_number = sequence_number;
   }
 
   ert_comm_protocol_increment_counter(comm_protocol, stream,
-      ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT, bytes_written,
-      bytes_written - ert_comm_protocol_packet_header_length);
+      ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT, bytes_written, bytes_written - header_length);
 
   if (end_of_stream) {
     ert_log_debug("flush: set end of stream pending");
     stream->info.end_of_stream_pending = true;
   }
 
-  ert_log_debug("flush: last_acknowledged_sequence_number=%d last_transferred_sequence_number=%d history_count=%d",
+  ert_log_trace("flush: last_acknowledged_sequence_number=%d last_transferred_sequence_number=%d history_count=%d",
     stream->info.last_acknowledged_sequence_number, stream->info.last_transferred_sequence_number,
       ert_comm_protocol_stream_packet_history_get_count(stream));
 
@@ -2529,7 +4318,7 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
   }
   ert_ring_buffer_clear(stream->ring_buffer);
 
-  stream->info.current_sequence_number = ert_comm_protocol_get_next_sequence_number(stream->info.current_sequence_number);
+  stream->info.current_sequence_number = ert_comm_protocol_stream_get_next_sequence_number(stream, stream->info.current_sequence_number);
 
   if (!stream->info.end_of_stream) {
     result = ert_comm_protocol_stream_init_packet_buffer(stream);
@@ -2541,12 +4330,11 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
   }
 
   if (request_acks) {
-    stream->info.ack_request_pending = true;
+    ert_comm_protocol_transmit_stream_set_acknowledgement_requested(stream, false, sequence_number);
 
     ert_comm_protocol_log_stream_info(ERT_LOG_LEVEL_INFO, &stream->info, "Acknowledgements request sent for stream");
 
-    result = ert_comm_protocol_set_packet_acknowledgement_timeout(comm_protocol,
-        comm_protocol->config.stream_acknowledgement_receive_timeout_millis);
+    result = ert_comm_protocol_set_packet_acknowledgement_timeout(comm_protocol, stream->info.ack_receive_timeout_millis);
     if (result < 0) {
       pthread_mutex_unlock(&stream->mutex);
       ert_log_error("Error setting packet acknowledgement timeout, result %d", result);
@@ -2563,35 +4351,46 @@ int ert_comm_protocol_transmit_stream_flush(ert_comm_protocol *comm_protocol, er
   return 0;
 }
 
-int ert_comm_protocol_transmit_stream_write(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
-    uint32_t length, uint8_t *data, uint32_t *bytes_written_rcv)
+/*
+ * Waits until acknowledgements have made room in packet history for a new packet, the stream has failed
+ * or the timeout has passed. Must be called stream->mutex locked.
+ */
+static int ert_comm_protocol_transmit_stream_wait_for_window(ert_comm_protocol_stream *stream, uint32_t milliseconds)
 {
-  pthread_mutex_lock(&stream->mutex);
-  if (!stream->used) {
-    pthread_mutex_unlock(&stream->mutex);
-    return -EINVAL;
-  }
-  if (stream->info.end_of_stream) {
-    pthread_mutex_unlock(&stream->mutex);
-    return -EINVAL;
+  struct timespec to;
+
+  int result = ert_get_current_timestamp_offset(&to, milliseconds);
+  if (result < 0) {
+    return -EIO;
   }
-  if (stream->info.failed) {
-    pthread_mutex_unlock(&stream->mutex);
-    ert_log_error("Stream write: stream_id=%d, port=%d, sequence_number=%d, length=%d: stream failed",
-        stream->info.stream_id, stream->info.port, stream->info.current_sequence_number, length);
-    return -EPROTO;
+
+  while (stream->used && !stream->info.failed
+      && stream->packet_history_count >= ert_comm_protocol_transmit_stream_get_window_packet_count(stream)) {
+    result = pthread_cond_timedwait(&stream->change_cond, &stream->mutex, &to);
+    if (result == ETIMEDOUT) {
+      break;
+    } else if (result != 0) {
+      ert_log_error("pthread_cond_timedwait failed with result %d", result);
+      return -EIO;
+    }
   }
 
+  return 0;
+}
+
+/*
+ * Writes data to the packet buffer of the stream, flushing full packets. Must be called stream->mutex locked,
+ * the mutex is released while flushing.
+ */
+static int ert_comm_protocol_transmit_stream_write_packets(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, uint32_t length, uint8_t *data)
+{
   int result;
-  uint32_t bytes_written = 0;
   uint32_t read_offset = 0;
   uint32_t remaining_bytes = length;
 
-  ert_log_debug("Stream write: stream_id=%d, port=%d, sequence_number=%d, length=%d",
-    stream->info.stream_id, stream->info.port, stream->info.current_sequence_number, length);
-
   while (remaining_bytes > 0) {
-    uint32_t remaining_bytes_in_packet = comm_protocol->max_packet_size -
+    uint32_t remaining_bytes_in_packet = ert_comm_protocol_transmit_stream_get_max_packet_length(comm_protocol, stream) -
         ert_ring_buffer_get_used_bytes(stream->ring_buffer);
 
     if (remaining_bytes_in_packet == 0) {
@@ -2610,12 +4409,12 @@ int ert_comm_protocol_transmit_stream_write(ert_comm_protocol *comm_protocol, er
         ert_log_info("Stream write: stream_id=%d, port=%d, sequence_number=%d, length=%d: " \
             "Retrying stream flush, waiting for acknowledgements ...",
             stream->info.stream_id, stream->info.port, stream->info.current_sequence_number, length);
-        pthread_mutex_unlock(&stream->mutex);
-        usleep(comm_protocol->config.stream_acknowledgement_receive_timeout_millis * 1000 * 2);
-        pthread_mutex_lock(&stream->mutex);
+        result = ert_comm_protocol_transmit_stream_wait_for_window(stream, stream->info.ack_receive_timeout_millis * 2);
+        if (result < 0) {
+          return result;
+        }
         goto retry_flush;
       } else if (result < 0) {
-        pthread_mutex_unlock(&stream->mutex);
         ert_log_error("Stream write: stream_id=%d, port=%d, sequence_number=%d, length=%d: " \
             "ert_comm_protocol_transmit_stream_flush failed with result %d",
             stream->info.stream_id, stream->info.port, stream->info.current_sequence_number, length, result);
@@ -2630,22 +4429,100 @@ int ert_comm_protocol_transmit_stream_write(ert_comm_protocol *comm_protocol, er
 
     result = ert_ring_buffer_write(stream->ring_buffer, bytes_to_write, data + read_offset);
     if (result < 0) {
-      pthread_mutex_unlock(&stream->mutex);
       ert_log_error("Error writing %d bytes to ring buffer", bytes_to_write);
       return -EIO;
     }
 
     read_offset += bytes_to_write;
     remaining_bytes -= bytes_to_write;
-    bytes_written += bytes_to_write;
   }
 
-  if (bytes_written_rcv != NULL) {
-    *bytes_written_rcv = bytes_written;
+  return 0;
+}
+
+/*
+ * Compresses data in chunks and writes the compressed data to the packet buffer of the stream.
+ * Must be called stream->mutex locked.
+ */
+static int ert_comm_protocol_transmit_stream_write_compressed(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, uint32_t length, uint8_t *data, uint32_t *bytes_written_rcv)
+{
+  uint8_t compressed_data[ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_OUTPUT_LENGTH_MAX];
+  uint32_t bytes_written = 0;
+  int result = 0;
+
+  while (bytes_written < length) {
+    uint32_t chunk_length = length - bytes_written;
+    if (chunk_length > ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_LENGTH) {
+      chunk_length = ERT_COMM_PROTOCOL_COMPRESSION_CHUNK_LENGTH;
+    }
+
+    uint32_t compressed_length;
+    uint64_t cpu_time_start = ert_comm_protocol_get_thread_cpu_time_nanos();
+
+    ert_comm_protocol_compressor_compress(stream->compressor, chunk_length, data + bytes_written,
+        compressed_data, &compressed_length);
+
+    ert_comm_protocol_update_compression_counters(comm_protocol, stream, chunk_length, compressed_length,
+        ert_comm_protocol_get_thread_cpu_time_nanos() - cpu_time_start);
+
+    result = ert_comm_protocol_transmit_stream_write_packets(comm_protocol, stream, compressed_length, compressed_data);
+    if (result < 0) {
+      break;
+    }
+
+    bytes_written += chunk_length;
+  }
+
+  *bytes_written_rcv = bytes_written;
+
+  return result;
+}
+
+int ert_comm_protocol_transmit_stream_write(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    uint32_t length, uint8_t *data, uint32_t *bytes_written_rcv)
+{
+  pthread_mutex_lock(&stream->mutex);
+  if (!stream->used) {
+    pthread_mutex_unlock(&stream->mutex);
+    return -EINVAL;
+  }
+  if (stream->info.end_of_stream) {
+    pthread_mutex_unlock(&stream->mutex);
+    return -EINVAL;
+  }
+  if (stream->info.failed) {
+    pthread_mutex_unlock(&stream->mutex);
+    ert_log_error("Stream write: stream_id=%d, port=%d, sequence_number=%d, length=%d: stream failed",
+        stream->info.stream_id, stream->info.port, stream->info.current_sequence_number, length);
+    return -EPROTO;
+  }
+
+  int result;
+  uint32_t bytes_written = 0;
+
+  ert_log_trace("Stream write: stream_id=%d, port=%d, sequence_number=%d, length=%d",
+    stream->info.stream_id, stream->info.port, stream->info.current_sequence_number, length);
+
+  if (stream->info.compressed) {
+    result = ert_comm_protocol_transmit_stream_write_compressed(comm_protocol, stream, length, data, &bytes_written);
+  } else {
+    result = ert_comm_protocol_transmit_stream_write_packets(comm_protocol, stream, length, data);
+    if (result == 0) {
+      bytes_written = length;
+    }
   }
 
   pthread_mutex_unlock(&stream->mutex);
 
+  if (result < 0) {
+    return result;
+  }
+
+  if (bytes_written_rcv != NULL) {
+    *bytes_written_rcv = bytes_written;
+  }
+
   return 0;
 }
 
@@ -2662,7 +4539,19 @@ int ert_comm_protocol_transmit_stream_close(ert_comm_protocol *comm_protocol, er
   if (force) {
     ert_comm_protocol_log_stream_info(ERT_LOG_LEVEL_INFO, &stream->info, "Closing transmit stream - force=%d", force);
   } else {
+    int retries = 3;
+
     result = ert_comm_protocol_transmit_stream_flush(comm_protocol, stream, true, NULL);
+    while (result == -EAGAIN && stream->info.acks_enabled && --retries > 0) {
+      pthread_mutex_lock(&stream->mutex);
+      result = ert_comm_protocol_transmit_stream_wait_for_window(stream, stream->info.ack_receive_timeout_millis * 2);
+      pthread_mutex_unlock(&stream->mutex);
+      if (result < 0) {
+        break;
+      }
+
+      result = ert_comm_protocol_transmit_stream_flush(comm_protocol, stream, true, NULL);
+    }
 
     ert_comm_protocol_log_stream_info(ERT_LOG_LEVEL_INFO, &stream->info, "Closing transmit stream - force=%d, waiting for acks...", force);
 
@@ -2679,68 +4568,223 @@ int ert_comm_protocol_transmit_stream_close(ert_comm_protocol *comm_protocol, er
   return result;
 }
 
-int ert_comm_protocol_receive_stream_read(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
-  uint32_t wait_for_milliseconds, uint32_t length, uint8_t *data, uint32_t *bytes_received)
+static inline bool ert_comm_protocol_receive_stream_has_data(ert_comm_protocol_stream *stream)
+{
+  return ert_spsc_ring_buffer_get_used_bytes(stream->receive_buffer) > 0
+      || (stream->info.compressed && ert_comm_protocol_decompressor_has_pending_data(stream->decompressor));
+}
+
+/*
+ * Checks for data written before the end of stream was set. The receive callback sets it with the stream mutex
+ * locked, so locking the mutex guarantees that all data written before it is visible.
+ */
+static bool ert_comm_protocol_receive_stream_has_data_after_end_of_stream(ert_comm_protocol_stream *stream)
 {
   pthread_mutex_lock(&stream->mutex);
+  bool has_data = ert_spsc_ring_buffer_get_used_bytes(stream->receive_buffer) > 0;
+  pthread_mutex_unlock(&stream->mutex);
 
-  if (!stream->used) {
+  return has_data;
+}
+
+/*
+ * Decompresses data from the receive buffer of a compressed stream. May return no data if the receive buffer
+ * contains only part of a compressed token. The decompressor is used only by the reader of the stream,
+ * so the stream mutex does not need to be locked.
+ */
+static int ert_comm_protocol_receive_stream_read_compressed(ert_comm_protocol *comm_protocol,
+    ert_comm_protocol_stream *stream, uint32_t length, uint8_t *data, uint32_t *read_bytes_rcv)
+{
+  ert_comm_protocol_decompressor *decompressor = stream->decompressor;
+  uint32_t read_bytes = 0;
+  uint32_t compressed_bytes = 0;
+  int result = 0;
+
+  uint64_t cpu_time_start = ert_comm_protocol_get_thread_cpu_time_nanos();
+
+  while (true) {
+    uint32_t output_length;
+    result = ert_comm_protocol_decompressor_decompress(decompressor, length - read_bytes, data + read_bytes,
+        &output_length);
+    read_bytes += output_length;
+    if (result < 0 || read_bytes >= length) {
+      break;
+    }
+
+    ert_spsc_ring_buffer_read(stream->receive_buffer, ERT_COMM_PROTOCOL_DECOMPRESSOR_INPUT_LENGTH,
+        decompressor->input, &decompressor->input_length);
+    decompressor->input_offset = 0;
+    if (decompressor->input_length == 0) {
+      break;
+    }
+
+    compressed_bytes += decompressor->input_length;
+  }
+
+  ert_comm_protocol_update_compression_counters(comm_protocol, stream, read_bytes, compressed_bytes,
+      ert_comm_protocol_get_thread_cpu_time_nanos() - cpu_time_start);
+
+  if (result < 0) {
+    ert_comm_protocol_log_stream_info(ERT_LOG_LEVEL_ERROR, &stream->info, "Invalid compressed data in stream");
+    pthread_mutex_lock(&stream->mutex);
+    stream->info.failed = true;
     pthread_mutex_unlock(&stream->mutex);
+    return -EPROTO;
+  }
+
+  *read_bytes_rcv = read_bytes;
+
+  return 0;
+}
+
+/**
+ * Reads received data from the stream, waiting for data for the given time if there is none.
+ * Returns zero bytes at the end of stream. The stream mutex is locked only at the end of stream,
+ * so reading does not contend with the receive callback for the mutex.
+ */
+int ert_comm_protocol_receive_stream_read(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+  uint32_t wait_for_milliseconds, uint32_t length, uint8_t *data, uint32_t *bytes_received)
+{
+  if (!stream->used) {
     return -EINVAL;
   }
 
   if (stream->info.failed) {
-    pthread_mutex_unlock(&stream->mutex);
     return -EPROTO;
   }
 
-  if (ert_ring_buffer_get_used_bytes(stream->ring_buffer) == 0) {
+  uint32_t read_bytes = 0;
+  bool waited = false;
+
+  while (true) {
+    // The wake count is read before checking for end of stream, so that the wake-up for it is not missed
+    uint32_t wake_count = ert_spsc_ring_buffer_get_wake_count(stream->receive_buffer);
+
+    if (ert_comm_protocol_receive_stream_has_data(stream)) {
+      if (stream->info.compressed) {
+        int result = ert_comm_protocol_receive_stream_read_compressed(comm_protocol, stream, length, data, &read_bytes);
+        if (result < 0) {
+          return result;
+        }
+      } else {
+        ert_spsc_ring_buffer_read(stream->receive_buffer, length, data, &read_bytes);
+      }
+
+      // Compressed data may end in the middle of a token, so wait for the rest of it
+      if (read_bytes > 0 || length == 0) {
+        break;
+      }
+    }
+
     ert_log_debug("port=%d, stream_id=%d, end_of_stream=%d", stream->info.port, stream->info.stream_id, stream->info.end_of_stream);
     if (stream->info.end_of_stream) {
-      pthread_mutex_unlock(&stream->mutex);
-      *bytes_received = 0;
-      return 0;
+      if (ert_comm_protocol_receive_stream_has_data_after_end_of_stream(stream)) {
+        continue;
+      }
+      break;
     }
 
-    struct timespec to;
+    if (waited) {
+      return -ETIMEDOUT;
+    }
 
-    int result = ert_get_current_timestamp_offset(&to, wait_for_milliseconds);
-    if (result < 0) {
-      pthread_mutex_unlock(&stream->mutex);
+    int result = ert_spsc_ring_buffer_wait(stream->receive_buffer, wake_count, wait_for_milliseconds);
+    waited = true;
+
+    if (result == -ETIMEDOUT) {
+      if (!stream->info.end_of_stream) {
+        return -ETIMEDOUT;
+      }
+    } else if (result < 0) {
       return -EIO;
     }
+  }
 
-    result = pthread_cond_timedwait(&stream->change_cond, &stream->mutex, &to);
+  *bytes_received = read_bytes;
 
-    if (result == ETIMEDOUT || ert_ring_buffer_get_used_bytes(stream->ring_buffer) == 0) {
-      pthread_mutex_unlock(&stream->mutex);
+  return 0;
+}
+
+/**
+ * Returns the address and length of received data in the stream buffer without copying it, waiting for data
+ * like ert_comm_protocol_receive_stream_read. The data stays valid until it is released with
+ * ert_comm_protocol_receive_stream_consume or the stream is closed. Not supported for compressed streams,
+ * which have to be decompressed with ert_comm_protocol_receive_stream_read.
+ */
+int ert_comm_protocol_receive_stream_peek(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    uint32_t wait_for_milliseconds, uint8_t **data_rcv, uint32_t *length_rcv)
+{
+  if (!stream->used) {
+    return -EINVAL;
+  }
+
+  if (stream->info.failed) {
+    return -EPROTO;
+  }
+
+  if (stream->info.compressed) {
+    return -EOPNOTSUPP;
+  }
+
+  bool waited = false;
+
+  while (true) {
+    uint32_t wake_count = ert_spsc_ring_buffer_get_wake_count(stream->receive_buffer);
 
-      if (stream->info.end_of_stream) {
-        *bytes_received = 0;
-        return 0;
+    if (ert_spsc_ring_buffer_get_used_bytes(stream->receive_buffer) > 0) {
+      break;
+    }
+
+    if (stream->info.end_of_stream) {
+      if (ert_comm_protocol_receive_stream_has_data_after_end_of_stream(stream)) {
+        continue;
       }
+      break;
+    }
 
+    if (waited) {
       return -ETIMEDOUT;
-    } else if (result != 0) {
-      pthread_mutex_unlock(&stream->mutex);
-      ert_log_error("pthread_cond_timedwait failed with result %d", result);
+    }
+
+    int result = ert_spsc_ring_buffer_wait(stream->receive_buffer, wake_count, wait_for_milliseconds);
+    waited = true;
+
+    if (result == -ETIMEDOUT) {
+      if (!stream->info.end_of_stream) {
+        return -ETIMEDOUT;
+      }
+    } else if (result < 0) {
       return -EIO;
     }
   }
 
-  uint32_t read_bytes;
-
-  ert_ring_buffer_read(stream->ring_buffer, length, data, &read_bytes);
+  ert_spsc_ring_buffer_peek(stream->receive_buffer, data_rcv, length_rcv);
 
-  pthread_mutex_unlock(&stream->mutex);
+  return 0;
+}
 
-  *bytes_received = read_bytes;
+/**
+ * Releases data returned by ert_comm_protocol_receive_stream_peek, making room for more received data.
+ */
+int ert_comm_protocol_receive_stream_consume(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    uint32_t length)
+{
+  if (!stream->used) {
+    return -EINVAL;
+  }
 
-  return 0;
+  return ert_spsc_ring_buffer_consume(stream->receive_buffer, length);
 }
 
 int ert_comm_protocol_receive_stream_close(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream)
 {
+  // Acks requested by the transmitter, such as the end of stream ack, must be sent before the stream is closed
+  pthread_mutex_lock(&stream->mutex);
+  while (stream->used && stream->acknowledgement_send_pending) {
+    pthread_cond_wait(&stream->change_cond, &stream->mutex);
+  }
+  pthread_mutex_unlock(&stream->mutex);
+
   pthread_mutex_lock(&comm_protocol->receive_streams_mutex);
   pthread_mutex_lock(&stream->operation_mutex);
   pthread_mutex_lock(&stream->mutex);
@@ -14,6 +14,7 @@
 #include "ert-common.h"
 #include "ert-ring-buffer.h"
 #include "ert-buffer-pool.h"
+#include "ert-comm-link-adaptation.h"
 #include <pthread.h>
 #include <time.h>
 
@@ -26,11 +27,26 @@
 #define ERT_COMM_PROTOCOL_STREAM_ACK_RECEIVE_TIMEOUT_MILLIS_DEFAULT 1000
 #define ERT_COMM_PROTOCOL_STREAM_ACK_GUARD_INTERVAL_MILLIS_DEFAULT 50
 
+#define ERT_COMM_PROTOCOL_STREAM_ACK_MIN_INTERVAL_PACKET_COUNT_DEFAULT 8
+#define ERT_COMM_PROTOCOL_STREAM_ACK_MAX_INTERVAL_PACKET_COUNT_DEFAULT 64
+#define ERT_COMM_PROTOCOL_STREAM_ACK_MIN_RECEIVE_TIMEOUT_MILLIS_DEFAULT 200
+#define ERT_COMM_PROTOCOL_STREAM_ACK_MAX_RECEIVE_TIMEOUT_MILLIS_DEFAULT 5000
+
 #define ERT_COMM_PROTOCOL_STREAM_ACK_REREQUEST_COUNT_MAX_DEFAULT 5
 #define ERT_COMM_PROTOCOL_STREAM_END_OF_STREAM_ACK_REREQUEST_COUNT_MAX_DEFAULT 2
 
+#define ERT_COMM_PROTOCOL_STREAM_FEC_GROUP_PACKET_COUNT_DEFAULT 8
+#define ERT_COMM_PROTOCOL_FEC_MAX_GROUP_PACKET_COUNT 16
+
+#define ERT_COMM_PROTOCOL_STREAM_WINDOW_PACKET_COUNT_DEFAULT 128
+#define ERT_COMM_PROTOCOL_STREAM_WINDOW_MAX_PACKET_COUNT 256
+
 #define ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_ENABLED 0x01
 #define ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS 0x02
+#define ERT_COMM_PROTOCOL_STREAM_FLAG_ACKS_BITMAP 0x04
+#define ERT_COMM_PROTOCOL_STREAM_FLAG_FEC 0x08
+#define ERT_COMM_PROTOCOL_STREAM_FLAG_EXTENDED_SEQUENCE_NUMBERS 0x10
+#define ERT_COMM_PROTOCOL_STREAM_FLAG_COMPRESSION 0x20
 
 struct _ert_comm_protocol_stream;
 struct _ert_comm_protocol;
@@ -45,6 +61,10 @@ typedef void (*ert_comm_protocol_device_receive_callback)(
     uint32_t length, uint8_t *data, void *callback_context);
 
 #define ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_SET_RECEIVE_ACTIVE 0x01
+#define ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_PRIORITY_REALTIME 0x02
+#define ERT_COMM_PROTOCOL_DEVICE_WRITE_PACKET_FLAG_PRIORITY_BULK 0x04
+
+#define ERT_COMM_PROTOCOL_PORT_MASK(port) ((uint16_t) (1 << (port)))
 
 typedef struct _ert_comm_protocol_device {
   void *priv;
@@ -55,6 +75,8 @@ typedef struct _ert_comm_protocol_device {
   int (*set_receive_active)(struct _ert_comm_protocol_device *protocol_device, bool receive_active);
   int (*write_packet)(struct _ert_comm_protocol_device *protocol_device, uint32_t length, uint8_t *data,
       uint32_t flags, uint32_t *bytes_written);
+  // Link quality of the packet being passed to the receive callback, optional
+  int (*get_received_packet_link_quality)(struct _ert_comm_protocol_device *protocol_device, float *rssi, float *snr);
   int (*close)(struct _ert_comm_protocol_device *protocol_device);
 } ert_comm_protocol_device;
 
@@ -65,6 +87,8 @@ typedef enum _ert_comm_protocol_packet_flags {
   ERT_COMM_PROTOCOL_PACKET_FLAG_REQUEST_ACKS = 0x08,
   ERT_COMM_PROTOCOL_PACKET_FLAG_RETRANSMIT = 0x10,
   ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS = 0x20,
+  ERT_COMM_PROTOCOL_PACKET_FLAG_ACKS_BITMAP = 0x40,
+  ERT_COMM_PROTOCOL_PACKET_FLAG_FEC = 0x80,
 } ert_comm_protocol_packet_flags;
 
 typedef enum _ert_comm_protocol_stream_type {
@@ -81,6 +105,13 @@ typedef struct _ert_comm_protocol_stream_info {
 
   bool acks_enabled;
   bool acks;
+  bool acks_bitmap;
+  bool fec;
+  // Extended streams use 16-bit sequence numbers, a transmit window independent of the acknowledgement interval
+  // and cumulative acknowledgements
+  bool extended_sequence_numbers;
+  // Payload data of compressed streams is compressed by the transmitter and decompressed when read by the receiver
+  bool compressed;
   volatile bool ack_request_pending;
 
   volatile bool start_of_stream;
@@ -104,11 +135,29 @@ typedef struct _ert_comm_protocol_stream_info {
   volatile uint16_t ack_rerequest_count;
   volatile uint16_t end_of_stream_ack_rerequest_count;
 
+  // Acknowledgement interval and timeout of a transmit stream, adapted to observed packet loss and round-trip time
+  volatile uint32_t ack_interval_packet_count;
+  volatile uint32_t ack_receive_timeout_millis;
+  volatile uint32_t round_trip_time_millis;
+  volatile uint32_t round_trip_time_deviation_millis;
+  volatile float packet_loss_ratio;
+
   volatile uint64_t retransmitted_packet_count;
   volatile uint64_t retransmitted_data_bytes;
   volatile uint64_t retransmitted_payload_data_bytes;
 
   volatile uint64_t received_packet_sequence_number_error_count;
+
+  volatile uint64_t fec_repair_packet_count;
+  volatile uint64_t fec_recovered_packet_count;
+
+  // Data written to a compressed transmit stream or read from a compressed receive stream
+  volatile uint64_t uncompressed_data_bytes;
+  volatile uint64_t compressed_data_bytes;
+  // Ratio of compressed to uncompressed data length
+  volatile float compression_ratio;
+  // Thread CPU time spent compressing or decompressing the data
+  volatile uint64_t compression_cpu_time_nanos;
 } ert_comm_protocol_stream_info;
 
 typedef struct _ert_comm_protocol_status {
@@ -134,6 +183,28 @@ typedef struct _ert_comm_protocol_status {
 
   struct timespec last_received_packet_timestamp;
   struct timespec last_invalid_received_packet_timestamp;
+
+  uint64_t transmitted_fec_repair_packet_count;
+  uint64_t received_fec_repair_packet_count;
+  uint64_t fec_recovered_packet_count;
+
+  // Totals for compressed transmit streams
+  uint64_t compression_uncompressed_data_bytes;
+  uint64_t compression_compressed_data_bytes;
+  float compression_ratio;
+  uint64_t compression_cpu_time_nanos;
+  // Totals for compressed receive streams
+  uint64_t decompression_compressed_data_bytes;
+  uint64_t decompression_uncompressed_data_bytes;
+  float decompression_ratio;
+  uint64_t decompression_cpu_time_nanos;
+
+  // Acknowledgement interval and timeout chosen for the most recently acknowledged transmit stream
+  uint32_t acknowledgement_interval_packet_count;
+  uint32_t acknowledgement_receive_timeout_millis;
+  uint32_t round_trip_time_millis;
+  uint32_t round_trip_time_deviation_millis;
+  float packet_loss_ratio;
 } ert_comm_protocol_status;
 
 typedef struct _ert_comm_protocol_config {
@@ -146,11 +217,37 @@ typedef struct _ert_comm_protocol_config {
   uint32_t stream_inactivity_timeout_millis;
 
   uint32_t stream_acknowledgement_interval_packet_count;
+  bool stream_acknowledgement_bitmap;
   uint32_t stream_acknowledgement_receive_timeout_millis;
+  // With adaptive acknowledgements the interval and receive timeout above are initial values for each stream
+  bool stream_acknowledgement_adaptive;
+  uint32_t stream_acknowledgement_min_interval_packet_count;
+  uint32_t stream_acknowledgement_max_interval_packet_count;
+  uint32_t stream_acknowledgement_min_receive_timeout_millis;
+  uint32_t stream_acknowledgement_max_receive_timeout_millis;
   uint32_t stream_acknowledgement_guard_interval_millis;
   uint32_t stream_acknowledgement_max_rerequest_count;
   uint32_t stream_end_of_stream_acknowledgement_max_rerequest_count;
 
+  bool stream_fec;
+  uint32_t stream_fec_group_packet_count;
+
+  // Extended sequence numbers are used for streams with acknowledgements once the receiver has signaled support
+  // for them. The window limits the number of unacknowledged packets of these streams.
+  bool stream_extended_sequence_numbers;
+  uint32_t stream_window_packet_count;
+
+  // Compression is supported for receive streams and signaled to the transmitter in acknowledgements.
+  // Transmit streams with acknowledgements to the ports in the bit mask are compressed once the receiver
+  // has signaled support for it.
+  bool stream_compression;
+  uint16_t stream_compression_ports;
+
+  // Port bit masks selecting the transmit priority class of streams, other ports use normal priority.
+  // Acknowledgements are always transmitted with realtime priority.
+  uint16_t stream_realtime_priority_ports;
+  uint16_t stream_bulk_priority_ports;
+
   uint16_t transmit_stream_count;
   uint16_t receive_stream_count;
 } ert_comm_protocol_config;
@@ -164,6 +261,8 @@ int ert_comm_protocol_create(
     ert_comm_protocol **comm_protocol_rcv);
 int ert_comm_protocol_destroy(ert_comm_protocol *comm_protocol);
 int ert_comm_protocol_get_status(ert_comm_protocol *comm_protocol, ert_comm_protocol_status *status);
+void ert_comm_protocol_set_link_adaptation(ert_comm_protocol *comm_protocol,
+    ert_comm_link_adaptation *link_adaptation);
 int ert_comm_protocol_stream_get_info(ert_comm_protocol_stream *stream, ert_comm_protocol_stream_info *stream_info);
 int ert_comm_protocol_transmit_stream_open(ert_comm_protocol *comm_protocol, uint8_t port,
     ert_comm_protocol_stream **stream_rcv, uint32_t stream_flags);
@@ -174,6 +273,10 @@ int ert_comm_protocol_transmit_stream_write(ert_comm_protocol *comm_protocol, er
 int ert_comm_protocol_transmit_stream_close(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream, bool force);
 int ert_comm_protocol_receive_stream_read(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
     uint32_t wait_for_milliseconds, uint32_t length, uint8_t *data, uint32_t *bytes_received);
+int ert_comm_protocol_receive_stream_peek(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    uint32_t wait_for_milliseconds, uint8_t **data_rcv, uint32_t *length_rcv);
+int ert_comm_protocol_receive_stream_consume(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream,
+    uint32_t length);
 int ert_comm_protocol_receive_stream_close(ert_comm_protocol *comm_protocol, ert_comm_protocol_stream *stream);
 int ert_comm_protocol_get_active_streams(ert_comm_protocol *comm_protocol,
     size_t *stream_info_count, ert_comm_protocol_stream_info **stream_info_rcv);
@@ -38,6 +38,51 @@ ert_mapper_entry *ert_comm_transceiver_create_mappings(ert_comm_transceiver_conf
           .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
           .value = &config->maximum_receive_time_milliseconds,
       },
+      {
+          .name = "transmit_realtime_priority_weight",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME],
+      },
+      {
+          .name = "transmit_normal_priority_weight",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL],
+      },
+      {
+          .name = "transmit_bulk_priority_weight",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK],
+      },
+      {
+          .name = "transmit_realtime_maximum_wait_milliseconds",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->transmit_realtime_maximum_wait_milliseconds,
+      },
+      {
+          .name = "transmit_batch_packet_count",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->transmit_batch_packet_count,
+      },
+      {
+          .name = "listen_before_talk",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &config->listen_before_talk,
+      },
+      {
+          .name = "listen_before_talk_max_attempts",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->listen_before_talk_max_attempts,
+      },
+      {
+          .name = "listen_before_talk_backoff_min_milliseconds",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->listen_before_talk_backoff_min_milliseconds,
+      },
+      {
+          .name = "listen_before_talk_backoff_max_milliseconds",
+          .type = ERT_MAPPER_ENTRY_TYPE_UINT32,
+          .value = &config->listen_before_talk_backoff_max_milliseconds,
+      },
       {
           .type = ERT_MAPPER_ENTRY_TYPE_NONE,
       },
@@ -188,6 +188,13 @@ int ert_comm_transceiver_test_initialize(ert_comm_transceiver_test_context **con
   comm_transceiver_config1.receive_buffer_length_packets = 32;
   comm_transceiver_config1.transmit_timeout_milliseconds = 10000;
   comm_transceiver_config1.poll_interval_milliseconds = 1000;
+  comm_transceiver_config1.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_REALTIME_PRIORITY_WEIGHT_DEFAULT;
+  comm_transceiver_config1.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_NORMAL_PRIORITY_WEIGHT_DEFAULT;
+  comm_transceiver_config1.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_BULK_PRIORITY_WEIGHT_DEFAULT;
+  comm_transceiver_config1.transmit_batch_packet_count = ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT;
   comm_transceiver_config1.receive_callback = comm_transceiver_receive_callback;
   comm_transceiver_config1.receive_callback_context = context->device_context1;
 
@@ -202,6 +209,12 @@ int ert_comm_transceiver_test_initialize(ert_comm_transceiver_test_context **con
   comm_transceiver_config2.receive_buffer_length_packets = 32;
   comm_transceiver_config2.transmit_timeout_milliseconds = 10000;
   comm_transceiver_config2.poll_interval_milliseconds = 1000;
+  comm_transceiver_config2.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_REALTIME_PRIORITY_WEIGHT_DEFAULT;
+  comm_transceiver_config2.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_NORMAL_PRIORITY_WEIGHT_DEFAULT;
+  comm_transceiver_config2.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK] =
+      ERT_COMM_TRANSCEIVER_TRANSMIT_BULK_PRIORITY_WEIGHT_DEFAULT;
   comm_transceiver_config2.receive_callback = comm_transceiver_receive_callback;
   comm_transceiver_config2.receive_callback_context = context->device_context2;
 
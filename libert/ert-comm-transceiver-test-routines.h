@@ -12,6 +12,7 @@
 #define __ERT_COMM_TRANSCEIVER_TEST_ROUTINES_H
 
 #include "ert-common.h"
+#include "ert-pipe.h"
 #include "ert-comm-transceiver.h"
 #include "ert-comm-device-dummy.h"
 
@@ -8,16 +8,34 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
 #include <assert.h>
+#include <pthread.h>
+#include <inttypes.h>
 
 #include "ert-comm-transceiver-test.h"
 #include "ert-log.h"
+#include "ert-time.h"
 #include "ert-test.h"
 
+#define ERT_TRANSCEIVER_TEST_CONCURRENT_THREAD_COUNT 4
+#define ERT_TRANSCEIVER_TEST_CONCURRENT_PACKET_COUNT 16
+
+#define ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT 3
+#define ERT_TRANSCEIVER_TEST_CHANNEL_PACKET_COUNT 12
+#define ERT_TRANSCEIVER_TEST_CHANNEL_TRANSMIT_TIME_MILLIS 30
+
+typedef struct _ert_comm_transceiver_test_thread_context {
+  ert_comm_transceiver *comm_transceiver;
+  uint32_t thread_index;
+  int result;
+  int32_t max_transmit_time_millis;
+} ert_comm_transceiver_test_thread_context;
+
 int ert_comm_transceiver_test_run_test_basic(ert_comm_transceiver_test_context *context)
 {
   char *expected_packet_data_device1[] = {
@@ -78,6 +96,517 @@ int ert_comm_transceiver_test_run_test_basic(ert_comm_transceiver_test_context *
   return 0;
 }
 
+static int ert_comm_transceiver_test_transmit_with_flags(ert_comm_transceiver *comm_transceiver, uint32_t id,
+    char *string_data, uint32_t flags)
+{
+  uint32_t data_length = (uint32_t) (strlen(string_data) + 1);
+  uint32_t bytes_transmitted;
+
+  return ert_comm_transceiver_transmit(comm_transceiver, id, data_length, (uint8_t *) string_data,
+      flags, &bytes_transmitted);
+}
+
+int ert_comm_transceiver_test_run_test_priority(ert_comm_transceiver_test_context *context)
+{
+  char *expected_packet_data_device2[] = {
+      "Device 1: Normal 1",
+      "Device 1: Realtime 1",
+      "Device 1: Normal 2",
+      "Device 1: Normal 3",
+      "Device 1: Bulk 1",
+      "Device 1: Normal 4",
+      "Device 1: Normal 5",
+      "Device 1: Normal 6",
+      "Device 1: Normal 7",
+      "Device 1: Bulk 2",
+      NULL,
+  };
+
+  ert_log_info("Queue packets while in receive mode");
+  int result = ert_comm_transceiver_set_receive_active(context->comm_transceiver1, true);
+  assert(result == 0);
+
+  // The transmit dispatch routine holds the first packet until receive mode ends
+  result = ert_comm_transceiver_test_transmit_with_flags(context->comm_transceiver1, 31, "Device 1: Normal 1", 0);
+  assert(result == 0);
+  usleep(100000);
+
+  result = ert_comm_transceiver_test_transmit_with_flags(context->comm_transceiver1, 32, "Device 1: Bulk 1",
+      ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_BULK);
+  assert(result == 0);
+  result = ert_comm_transceiver_test_transmit_with_flags(context->comm_transceiver1, 33, "Device 1: Bulk 2",
+      ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_BULK);
+  assert(result == 0);
+
+  char normal_packet_data[6][32];
+  for (int i = 0; i < 6; i++) {
+    snprintf(normal_packet_data[i], sizeof(normal_packet_data[i]), "Device 1: Normal %d", i + 2);
+    result = ert_comm_transceiver_test_transmit_with_flags(context->comm_transceiver1, (uint32_t) (34 + i),
+        normal_packet_data[i], 0);
+    assert(result == 0);
+  }
+
+  result = ert_comm_transceiver_test_transmit_with_flags(context->comm_transceiver1, 40, "Device 1: Realtime 1",
+      ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_REALTIME);
+  assert(result == 0);
+
+  ert_comm_transceiver_status status;
+  result = ert_comm_transceiver_get_status(context->comm_transceiver1, &status);
+  assert(result == 0);
+  assert(status.priority_classes[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME].queued_packet_count == 1);
+  assert(status.priority_classes[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL].queued_packet_count == 6);
+  assert(status.priority_classes[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK].queued_packet_count == 2);
+
+  // Keep the packets queued long enough for the wait times to be measurable in milliseconds
+  usleep(20000);
+
+  result = ert_comm_transceiver_set_receive_active(context->comm_transceiver1, false);
+  assert(result == 0);
+
+  sleep(2);
+
+  result = ert_comm_transceiver_test_verify_received_packets(context->device_context2, expected_packet_data_device2);
+  assert(result == 0);
+
+  result = ert_comm_transceiver_get_status(context->comm_transceiver1, &status);
+  assert(result == 0);
+  for (int priority_class = 0; priority_class < ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT; priority_class++) {
+    assert(status.priority_classes[priority_class].queued_packet_count == 0);
+  }
+  assert(status.priority_classes[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME].transmitted_packet_count == 1);
+  assert(status.priority_classes[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK].transmitted_packet_count == 2);
+  assert(status.priority_classes[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK].max_queued_packet_count == 2);
+  assert(status.priority_classes[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK].max_wait_time_millis > 0);
+
+  ert_log_info("Interrupt receive mode to transmit a realtime packet");
+  context->comm_transceiver1->config.transmit_realtime_maximum_wait_milliseconds = 300;
+
+  result = ert_comm_transceiver_set_receive_active(context->comm_transceiver1, true);
+  assert(result == 0);
+
+  struct timespec start_time;
+  ert_get_current_timestamp(&start_time);
+  result = ert_comm_transceiver_test_transmit_with_flags(context->comm_transceiver1, 41, "Device 1: Realtime 2",
+      ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_BLOCK | ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_REALTIME);
+  assert(result == 0);
+  int32_t wait_millis = ert_timespec_diff_milliseconds_from_current(&start_time);
+  assert(wait_millis >= 300 && wait_millis < 1000);
+
+  result = ert_comm_transceiver_set_receive_active(context->comm_transceiver1, false);
+  assert(result == 0);
+  context->comm_transceiver1->config.transmit_realtime_maximum_wait_milliseconds = 0;
+
+  char *expected_realtime_packet_data_device2[] = {
+      "Device 1: Realtime 2",
+      NULL,
+  };
+
+  sleep(1);
+
+  result = ert_comm_transceiver_test_verify_received_packets(context->device_context2, expected_realtime_packet_data_device2);
+  assert(result == 0);
+
+  return 0;
+}
+
+int ert_comm_transceiver_test_run_test_batch(ert_comm_transceiver_test_context *context)
+{
+  char packet_data[ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT][32];
+  char *expected_packet_data_device2[ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT + 1];
+  ert_comm_transceiver_status initial_status;
+  ert_comm_transceiver_status status;
+
+  int result = ert_comm_transceiver_get_status(context->comm_transceiver1, &initial_status);
+  assert(result == 0);
+
+  ert_log_info("Queue packets while in receive mode to transmit them in a single batch");
+  result = ert_comm_transceiver_set_receive_active(context->comm_transceiver1, true);
+  assert(result == 0);
+
+  for (int i = 0; i < ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT; i++) {
+    snprintf(packet_data[i], sizeof(packet_data[i]), "Device 1: Batch %d", i + 1);
+    expected_packet_data_device2[i] = packet_data[i];
+    result = ert_comm_transceiver_test_transmit_with_flags(context->comm_transceiver1, (uint32_t) (51 + i),
+        packet_data[i], 0);
+    assert(result == 0);
+  }
+  expected_packet_data_device2[ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT] = NULL;
+
+  result = ert_comm_transceiver_set_receive_active(context->comm_transceiver1, false);
+  assert(result == 0);
+
+  sleep(1);
+
+  result = ert_comm_transceiver_test_verify_received_packets(context->device_context2, expected_packet_data_device2);
+  assert(result == 0);
+
+  result = ert_comm_transceiver_get_status(context->comm_transceiver1, &status);
+  assert(result == 0);
+  assert(status.transmitted_packet_count
+      == initial_status.transmitted_packet_count + ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT);
+  assert(status.transmit_batch_count == initial_status.transmit_batch_count + 1);
+  assert(status.max_transmit_batch_packet_count == ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT);
+  // The packets following the first one of the batch are started by the device transmit callback
+  assert(status.transmit_gap_count
+      == initial_status.transmit_gap_count + ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT - 1);
+  assert(status.max_transmit_gap_micros < 500000);
+
+  ert_log_info("Transmit one packet per dispatch");
+  result = ert_comm_transceiver_get_status(context->comm_transceiver2, &initial_status);
+  assert(result == 0);
+
+  result = ert_comm_transceiver_test_transmit(context->comm_transceiver2, 61, "Device 2: Single 1");
+  assert(result == 0);
+
+  result = ert_comm_transceiver_get_status(context->comm_transceiver2, &status);
+  assert(result == 0);
+  assert(status.transmit_batch_count == initial_status.transmit_batch_count + 1);
+  assert(status.max_transmit_batch_packet_count == 1);
+  assert(status.transmit_gap_count == 0);
+
+  char *expected_packet_data_device1[] = {
+      "Device 2: Single 1",
+      NULL,
+  };
+
+  sleep(1);
+
+  result = ert_comm_transceiver_test_verify_received_packets(context->device_context1, expected_packet_data_device1);
+  assert(result == 0);
+
+  return 0;
+}
+
+static void *ert_comm_transceiver_test_transmit_thread(void *arg)
+{
+  ert_comm_transceiver_test_thread_context *thread_context = (ert_comm_transceiver_test_thread_context *) arg;
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CONCURRENT_PACKET_COUNT; i++) {
+    char packet_data[32];
+    snprintf(packet_data, sizeof(packet_data), "Thread %d: Packet %d", thread_context->thread_index, i);
+
+    struct timespec start_time;
+    ert_get_current_timestamp(&start_time);
+
+    int result = ert_comm_transceiver_test_transmit(thread_context->comm_transceiver,
+        100 + thread_context->thread_index * ERT_TRANSCEIVER_TEST_CONCURRENT_PACKET_COUNT + i, packet_data);
+    if (result < 0) {
+      thread_context->result = result;
+      return NULL;
+    }
+
+    int32_t transmit_time_millis = ert_timespec_diff_milliseconds_from_current(&start_time);
+    if (transmit_time_millis > thread_context->max_transmit_time_millis) {
+      thread_context->max_transmit_time_millis = transmit_time_millis;
+    }
+  }
+
+  return NULL;
+}
+
+int ert_comm_transceiver_test_run_test_blocking_concurrent(ert_comm_transceiver_test_context *context)
+{
+  ert_comm_transceiver_test_thread_context thread_contexts[ERT_TRANSCEIVER_TEST_CONCURRENT_THREAD_COUNT] = {0};
+  pthread_t threads[ERT_TRANSCEIVER_TEST_CONCURRENT_THREAD_COUNT];
+  uint32_t next_packet_index[ERT_TRANSCEIVER_TEST_CONCURRENT_THREAD_COUNT] = {0};
+  int result;
+
+  ert_log_info("Transmit blocking packets from multiple threads concurrently");
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CONCURRENT_THREAD_COUNT; i++) {
+    thread_contexts[i].comm_transceiver = context->comm_transceiver1;
+    thread_contexts[i].thread_index = i;
+    result = pthread_create(&threads[i], NULL, ert_comm_transceiver_test_transmit_thread, &thread_contexts[i]);
+    assert(result == 0);
+  }
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CONCURRENT_THREAD_COUNT; i++) {
+    pthread_join(threads[i], NULL);
+    assert(thread_contexts[i].result == 0);
+    // Completion of a blocking transmit must never stall, the packets take milliseconds to transmit
+    assert(thread_contexts[i].max_transmit_time_millis < 500);
+  }
+
+  // The packets of the threads are interleaved, but the packets of each thread must arrive in order
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CONCURRENT_THREAD_COUNT * ERT_TRANSCEIVER_TEST_CONCURRENT_PACKET_COUNT; i++) {
+    ert_comm_transceiver_test_packet packet;
+    ssize_t pop_result = ert_pipe_pop_timed(context->device_context2->received_packets_queue, &packet, 1, 1000);
+    assert(pop_result == 1);
+
+    uint32_t thread_index, packet_index;
+    result = sscanf((char *) packet.data, "Thread %u: Packet %u", &thread_index, &packet_index);
+    assert(result == 2);
+    assert(thread_index < ERT_TRANSCEIVER_TEST_CONCURRENT_THREAD_COUNT);
+    assert(packet_index == next_packet_index[thread_index]);
+    next_packet_index[thread_index]++;
+  }
+
+  char *expected_packet_data_device2[] = {
+      NULL,
+  };
+  result = ert_comm_transceiver_test_verify_received_packets(context->device_context2, expected_packet_data_device2);
+  assert(result == 0);
+
+  return 0;
+}
+
+static void *ert_comm_transceiver_test_channel_transmit_thread(void *arg)
+{
+  ert_comm_transceiver_test_thread_context *thread_context = (ert_comm_transceiver_test_thread_context *) arg;
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CHANNEL_PACKET_COUNT; i++) {
+    char packet_data[32];
+    snprintf(packet_data, sizeof(packet_data), "Node %d: Packet %d", thread_context->thread_index, i);
+
+    int result = ert_comm_transceiver_test_transmit(thread_context->comm_transceiver,
+        thread_context->thread_index * ERT_TRANSCEIVER_TEST_CHANNEL_PACKET_COUNT + i, packet_data);
+    if (result < 0) {
+      thread_context->result = result;
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Transmits packets from all nodes sharing a dummy channel at the same time and sums up
+ * the listen-before-talk status of the transceivers.
+ */
+static void ert_comm_transceiver_test_run_channel(bool listen_before_talk,
+    ert_comm_driver_dummy_channel_status *channel_status, ert_comm_transceiver_status *total_status)
+{
+  ert_comm_driver_dummy_channel *channel;
+  ert_comm_device *devices[ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT];
+  ert_comm_transceiver *comm_transceivers[ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT];
+  ert_comm_transceiver_test_thread_context thread_contexts[ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT] = {0};
+  pthread_t threads[ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT];
+
+  int result = ert_driver_comm_device_dummy_channel_create(&channel);
+  assert(result == 0);
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT; i++) {
+    ert_comm_driver_dummy_config comm_driver_dummy_config = {0};
+    comm_driver_dummy_config.transmit_time_millis = ERT_TRANSCEIVER_TEST_CHANNEL_TRANSMIT_TIME_MILLIS;
+    comm_driver_dummy_config.max_packet_length = ERT_TRANSCEIVER_TEST_MAX_PACKET_LENGTH;
+
+    result = ert_driver_comm_device_dummy_open(&comm_driver_dummy_config, &devices[i]);
+    assert(result == 0);
+    result = ert_driver_comm_device_dummy_channel_add(channel, devices[i]);
+    assert(result == 0);
+
+    ert_comm_transceiver_config comm_transceiver_config = {0};
+    comm_transceiver_config.transmit_buffer_length_packets = 32;
+    comm_transceiver_config.receive_buffer_length_packets = 64;
+    comm_transceiver_config.transmit_timeout_milliseconds = 10000;
+    comm_transceiver_config.poll_interval_milliseconds = 1000;
+    comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL] =
+        ERT_COMM_TRANSCEIVER_TRANSMIT_NORMAL_PRIORITY_WEIGHT_DEFAULT;
+    comm_transceiver_config.transmit_batch_packet_count = 1;
+    comm_transceiver_config.listen_before_talk = listen_before_talk;
+    comm_transceiver_config.listen_before_talk_max_attempts = 16;
+    comm_transceiver_config.listen_before_talk_backoff_min_milliseconds = 10;
+    comm_transceiver_config.listen_before_talk_backoff_max_milliseconds = 200;
+
+    result = ert_comm_transceiver_start(devices[i], &comm_transceiver_config, &comm_transceivers[i]);
+    assert(result == 0);
+  }
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT; i++) {
+    thread_contexts[i].comm_transceiver = comm_transceivers[i];
+    thread_contexts[i].thread_index = i;
+    result = pthread_create(&threads[i], NULL, ert_comm_transceiver_test_channel_transmit_thread, &thread_contexts[i]);
+    assert(result == 0);
+  }
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT; i++) {
+    pthread_join(threads[i], NULL);
+    assert(thread_contexts[i].result == 0);
+  }
+
+  memset(total_status, 0, sizeof(ert_comm_transceiver_status));
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT; i++) {
+    ert_comm_transceiver_status status;
+    ert_comm_transceiver_get_status(comm_transceivers[i], &status);
+
+    total_status->channel_activity_detection_count += status.channel_activity_detection_count;
+    total_status->channel_busy_count += status.channel_busy_count;
+    total_status->channel_access_failure_count += status.channel_access_failure_count;
+    total_status->backoff_count += status.backoff_count;
+    total_status->total_backoff_millis += status.total_backoff_millis;
+
+    ert_comm_transceiver_stop(comm_transceivers[i]);
+  }
+
+  for (uint32_t i = 0; i < ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT; i++) {
+    ert_driver_comm_device_dummy_close(devices[i]);
+  }
+
+  ert_driver_comm_device_dummy_channel_get_status(channel, channel_status);
+  ert_driver_comm_device_dummy_channel_destroy(channel);
+
+  ert_log_info("Channel with listen_before_talk=%d: transmitted=%" PRIu64 " delivered=%" PRIu64 " collided=%" PRIu64
+      " detections=%" PRIu64 " busy=%" PRIu64 " backoffs=%" PRIu64 " backoff_millis=%" PRIu64,
+      listen_before_talk, channel_status->transmitted_packet_count, channel_status->delivered_packet_count,
+      channel_status->collided_packet_count, total_status->channel_activity_detection_count,
+      total_status->channel_busy_count, total_status->backoff_count, total_status->total_backoff_millis);
+}
+
+int ert_comm_transceiver_test_run_test_listen_before_talk(void)
+{
+  ert_comm_driver_dummy_channel_status channel_status;
+  ert_comm_transceiver_status total_status;
+
+  ert_log_info("Transmit from multiple nodes sharing a channel without listen-before-talk");
+
+  ert_comm_transceiver_test_run_channel(false, &channel_status, &total_status);
+
+  uint64_t collided_packet_count = channel_status.collided_packet_count;
+
+  assert(channel_status.transmitted_packet_count
+      == ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT * ERT_TRANSCEIVER_TEST_CHANNEL_PACKET_COUNT);
+  assert(collided_packet_count > channel_status.transmitted_packet_count / 2);
+  assert(total_status.channel_activity_detection_count == 0);
+
+  ert_log_info("Transmit from multiple nodes sharing a channel with listen-before-talk");
+
+  ert_comm_transceiver_test_run_channel(true, &channel_status, &total_status);
+
+  assert(channel_status.transmitted_packet_count
+      == ERT_TRANSCEIVER_TEST_CHANNEL_NODE_COUNT * ERT_TRANSCEIVER_TEST_CHANNEL_PACKET_COUNT);
+  // Only transmissions starting at the same instant can collide, like the first packets of the nodes
+  assert(channel_status.collided_packet_count < collided_packet_count / 2);
+  assert(total_status.channel_activity_detection_count >= channel_status.transmitted_packet_count);
+  assert(total_status.channel_busy_count > 0);
+  assert(total_status.backoff_count > 0);
+  assert(total_status.total_backoff_millis >= total_status.backoff_count * 10);
+  assert(total_status.channel_access_failure_count == 0);
+
+  return 0;
+}
+
+typedef struct _ert_comm_transceiver_test_backoff_context {
+  ert_comm_transceiver *comm_transceiver;
+  int result;
+  volatile bool frequency_changed;
+  struct timespec frequency_changed_timestamp;
+} ert_comm_transceiver_test_backoff_context;
+
+static void *ert_comm_transceiver_test_backoff_transmit_thread(void *arg)
+{
+  ert_comm_transceiver_test_backoff_context *backoff_context = (ert_comm_transceiver_test_backoff_context *) arg;
+
+  backoff_context->result = ert_comm_transceiver_test_transmit(backoff_context->comm_transceiver, 1, "Busy channel");
+
+  return NULL;
+}
+
+static void ert_comm_transceiver_test_backoff_event_callback(ert_comm_transceiver_event_type type, int result,
+    void *callback_context)
+{
+  ert_comm_transceiver_test_backoff_context *backoff_context =
+      (ert_comm_transceiver_test_backoff_context *) callback_context;
+
+  if (type == ERT_COMM_TRANSCEIVER_EVENT_FREQUENCY_CHANGED && result == 0) {
+    ert_get_current_timestamp(&backoff_context->frequency_changed_timestamp);
+    backoff_context->frequency_changed = true;
+  }
+}
+
+/**
+ * Changes the frequency of a transceiver while it is backing off from a busy channel. The change must be applied
+ * without waiting for the backoff to end.
+ */
+int ert_comm_transceiver_test_run_test_listen_before_talk_frequency_change(void)
+{
+  ert_comm_driver_dummy_channel *channel;
+  ert_comm_device *devices[2];
+  ert_comm_transceiver *comm_transceivers[2];
+  ert_comm_transceiver_test_backoff_context busy_context = {0};
+  ert_comm_transceiver_test_backoff_context backoff_context = {0};
+  pthread_t busy_thread;
+  struct timespec start_timestamp;
+
+  ert_log_info("Change frequency during listen-before-talk backoff");
+
+  int result = ert_driver_comm_device_dummy_channel_create(&channel);
+  assert(result == 0);
+
+  for (uint32_t i = 0; i < 2; i++) {
+    ert_comm_driver_dummy_config comm_driver_dummy_config = {0};
+    comm_driver_dummy_config.transmit_time_millis = (i == 0) ? 3000 : ERT_TRANSCEIVER_TEST_CHANNEL_TRANSMIT_TIME_MILLIS;
+    comm_driver_dummy_config.max_packet_length = ERT_TRANSCEIVER_TEST_MAX_PACKET_LENGTH;
+
+    result = ert_driver_comm_device_dummy_open(&comm_driver_dummy_config, &devices[i]);
+    assert(result == 0);
+    result = ert_driver_comm_device_dummy_channel_add(channel, devices[i]);
+    assert(result == 0);
+
+    ert_comm_transceiver_config comm_transceiver_config = {0};
+    comm_transceiver_config.transmit_buffer_length_packets = 4;
+    comm_transceiver_config.receive_buffer_length_packets = 4;
+    comm_transceiver_config.transmit_timeout_milliseconds = 10000;
+    comm_transceiver_config.poll_interval_milliseconds = 1000;
+    comm_transceiver_config.transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL] =
+        ERT_COMM_TRANSCEIVER_TRANSMIT_NORMAL_PRIORITY_WEIGHT_DEFAULT;
+    comm_transceiver_config.transmit_batch_packet_count = 1;
+    comm_transceiver_config.listen_before_talk = (i == 1);
+    comm_transceiver_config.listen_before_talk_max_attempts = 2;
+    comm_transceiver_config.listen_before_talk_backoff_min_milliseconds = 2000;
+    comm_transceiver_config.listen_before_talk_backoff_max_milliseconds = 2000;
+    comm_transceiver_config.event_callback = ert_comm_transceiver_test_backoff_event_callback;
+    comm_transceiver_config.event_callback_context = (i == 0) ? &busy_context : &backoff_context;
+
+    result = ert_comm_transceiver_start(devices[i], &comm_transceiver_config, &comm_transceivers[i]);
+    assert(result == 0);
+  }
+
+  busy_context.comm_transceiver = comm_transceivers[0];
+  result = pthread_create(&busy_thread, NULL, ert_comm_transceiver_test_backoff_transmit_thread, &busy_context);
+  assert(result == 0);
+
+  usleep(200 * 1000);
+
+  // The channel stays busy for the 2000 ms backoff, so the packet is transmitted only after the second attempt
+  result = ert_comm_transceiver_transmit(comm_transceivers[1], 2, 12, (uint8_t *) "Backoff test", 0, NULL);
+  assert(result == 0);
+
+  usleep(200 * 1000);
+
+  ert_get_current_timestamp(&start_timestamp);
+  result = ert_comm_transceiver_set_frequency(comm_transceivers[1], ERT_COMM_DEVICE_CONFIG_TYPE_TRANSMIT, 434.0);
+  assert(result == 0);
+
+  for (uint32_t i = 0; i < 100 && !backoff_context.frequency_changed; i++) {
+    usleep(10 * 1000);
+  }
+  assert(backoff_context.frequency_changed);
+
+  int32_t frequency_change_millis =
+      ert_timespec_diff_milliseconds(&start_timestamp, &backoff_context.frequency_changed_timestamp);
+  ert_log_info("Frequency changed during backoff in %d ms", frequency_change_millis);
+  assert(frequency_change_millis < 500);
+
+  pthread_join(busy_thread, NULL);
+  assert(busy_context.result == 0);
+
+  // The backoff ended before the busy transmission, which makes the second attempt fail
+  ert_comm_transceiver_status status;
+  ert_comm_transceiver_get_status(comm_transceivers[1], &status);
+  assert(status.backoff_count == 1);
+  assert(status.channel_access_failure_count == 1);
+
+  for (uint32_t i = 0; i < 2; i++) {
+    ert_comm_transceiver_stop(comm_transceivers[i]);
+    ert_driver_comm_device_dummy_close(devices[i]);
+  }
+
+  ert_driver_comm_device_dummy_channel_destroy(channel);
+
+  return 0;
+}
+
 int main(void)
 {
   int result = ert_test_init();
@@ -92,6 +621,11 @@ int main(void)
   }
 
   ert_comm_transceiver_test_run_test_basic(context);
+  ert_comm_transceiver_test_run_test_priority(context);
+  ert_comm_transceiver_test_run_test_batch(context);
+  ert_comm_transceiver_test_run_test_blocking_concurrent(context);
+  ert_comm_transceiver_test_run_test_listen_before_talk();
+  ert_comm_transceiver_test_run_test_listen_before_talk_frequency_change();
 
   ert_log_info("Tests finished successfully");
 
@@ -17,18 +17,29 @@
 #include "ert-time.h"
 #include "ert-comm-transceiver.h"
 
+#define ERT_COMM_TRANSCEIVER_RECEIVE_DISPATCH_BATCH_PACKET_COUNT 16
+
 typedef struct _ert_comm_transceiver_packet_receive_buffer_metadata_queue_entry {
   uint32_t length;
   uint8_t *buffer;
+  float rssi;
+  float snr;
 } ert_comm_transceiver_packet_receive_buffer_metadata_queue_entry;
 
+typedef enum _ert_comm_transceiver_transmit_completion_state {
+  ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_PENDING = 0,
+  ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_COMPLETED,
+  ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_ABANDONED,
+} ert_comm_transceiver_transmit_completion_state;
+
+/**
+ * Completion slot of a blocking transmit, protected by the transmit completion mutex of the transceiver.
+ * The thread that sees the other side finished releases the packet buffers: the transmitting thread after completion
+ * and the transmit dispatch routine if the transmitting thread has abandoned the packet because of a timeout.
+ */
 typedef struct _ert_comm_transceiver_packet_transmit_buffer_metadata {
-  bool transmitted_signal;
+  ert_comm_transceiver_transmit_completion_state completion_state;
   uint32_t bytes_transmitted;
-  pthread_mutex_t transmitted_mutex;
-  pthread_cond_t transmitted_cond;
-  bool destroy_signal;
-  bool timeout;
   int result;
 } ert_comm_transceiver_packet_transmit_buffer_metadata;
 
@@ -39,16 +50,16 @@ typedef struct _ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry
 
   bool set_receive_active;
 
+  ert_comm_transceiver_priority_class priority_class;
+  struct timespec queued_timestamp;
+
   bool blocking_enabled;
-  bool *transmitted_signal;
-  uint32_t *bytes_transmitted;
-  pthread_mutex_t *transmitted_mutex;
-  pthread_cond_t *transmitted_cond;
-  bool *destroy_signal;
-  bool *timeout;
-  int *result;
 
   ert_comm_transceiver_packet_transmit_buffer_metadata *metadata;
+
+  // Outcome of the transmission, set before the packet is pushed to the transmit result queue
+  int transmit_result;
+  uint32_t transmitted_bytes;
 } ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry;
 
 typedef bool (*cond_func)(ert_comm_transceiver *);
@@ -60,7 +71,7 @@ typedef enum _ert_comm_transceiver_counter_type {
 } ert_comm_transceiver_counter_type;
 
 static int ert_comm_transceiver_increment_counter(ert_comm_transceiver *comm_transceiver,
-    ert_comm_transceiver_counter_type type, uint64_t packet_bytes)
+    ert_comm_transceiver_counter_type type, uint32_t packet_count, uint64_t packet_bytes)
 {
   int result = 0;
 
@@ -71,17 +82,17 @@ static int ert_comm_transceiver_increment_counter(ert_comm_transceiver *comm_tra
   switch (type) {
     case ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT:
       ert_get_current_timestamp(&status->last_transmitted_packet_timestamp);
-      status->transmitted_packet_count++;
+      status->transmitted_packet_count += packet_count;
       status->transmitted_bytes += packet_bytes;
       break;
     case ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE:
       ert_get_current_timestamp(&status->last_received_packet_timestamp);
-      status->received_packet_count++;
+      status->received_packet_count += packet_count;
       status->received_bytes += packet_bytes;
       break;
     case ERT_COMM_TRANSCEIVER_COUNTER_TYPE_RECEIVE_INVALID:
       ert_get_current_timestamp(&status->last_invalid_received_packet_timestamp);
-      status->invalid_received_packet_count++;
+      status->invalid_received_packet_count += packet_count;
       break;
     default:
       ert_log_error("Invalid counter type: %d", type);
@@ -143,16 +154,274 @@ static bool ert_comm_transceiver_is_event_signal_active(ert_comm_transceiver *tr
   return transceiver->event_signal;
 }
 
-static int ert_comm_transceiver_wait_for_event(ert_comm_transceiver *transceiver)
+static int ert_comm_transceiver_wait_for_event(ert_comm_transceiver *transceiver, uint32_t milliseconds)
 {
   int result = ert_comm_transceiver_cond_timedwait(transceiver,
-      &transceiver->event_cond, &transceiver->event_mutex, transceiver->config.poll_interval_milliseconds,
+      &transceiver->event_cond, &transceiver->event_mutex, milliseconds,
       ert_comm_transceiver_is_event_signal_active);
   transceiver->event_signal = false;
 
   return result;
 }
 
+static int ert_comm_transceiver_transmit_queue_push(ert_comm_transceiver *transceiver,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entry)
+{
+  uint32_t capacity = transceiver->config.transmit_buffer_length_packets;
+
+  pthread_mutex_lock(&transceiver->transmit_queue_mutex);
+
+  ert_comm_transceiver_transmit_priority_queue *queue = &transceiver->transmit_queues[entry->priority_class];
+  if (queue->count >= capacity) {
+    pthread_mutex_unlock(&transceiver->transmit_queue_mutex);
+    return -ENOBUFS;
+  }
+
+  memcpy(&queue->entries[(queue->head + queue->count) % capacity], entry,
+      sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry));
+  queue->count++;
+
+  pthread_mutex_lock(&transceiver->status_mutex);
+  ert_comm_transceiver_priority_class_status *class_status = &transceiver->status.priority_classes[entry->priority_class];
+  class_status->queued_packet_count = queue->count;
+  if (queue->count > class_status->max_queued_packet_count) {
+    class_status->max_queued_packet_count = queue->count;
+  }
+  pthread_mutex_unlock(&transceiver->status_mutex);
+
+  pthread_cond_signal(&transceiver->transmit_queue_cond);
+  pthread_mutex_unlock(&transceiver->transmit_queue_mutex);
+
+  return 0;
+}
+
+/**
+ * Classes with weight 0 are served first in class order. The remaining classes are served using
+ * smooth weighted round robin, which interleaves the classes in proportion to their weights.
+ */
+static int ert_comm_transceiver_transmit_queue_select(ert_comm_transceiver *transceiver)
+{
+  uint32_t *weights = transceiver->config.transmit_priority_weights;
+
+  for (int priority_class = 0; priority_class < ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT; priority_class++) {
+    if (weights[priority_class] == 0 && transceiver->transmit_queues[priority_class].count > 0) {
+      return priority_class;
+    }
+  }
+
+  int selected_priority_class = -1;
+  int32_t total_weight = 0;
+
+  for (int priority_class = 0; priority_class < ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT; priority_class++) {
+    ert_comm_transceiver_transmit_priority_queue *queue = &transceiver->transmit_queues[priority_class];
+    if (queue->count == 0) {
+      queue->current_weight = 0;
+      continue;
+    }
+
+    queue->current_weight += (int32_t) weights[priority_class];
+    total_weight += (int32_t) weights[priority_class];
+
+    if (selected_priority_class < 0
+        || queue->current_weight > transceiver->transmit_queues[selected_priority_class].current_weight) {
+      selected_priority_class = priority_class;
+    }
+  }
+
+  if (selected_priority_class >= 0) {
+    transceiver->transmit_queues[selected_priority_class].current_weight -= total_weight;
+  }
+
+  return selected_priority_class;
+}
+
+static void ert_comm_transceiver_transmit_queue_pop_class(ert_comm_transceiver *transceiver, int priority_class,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entry)
+{
+  uint32_t capacity = transceiver->config.transmit_buffer_length_packets;
+
+  ert_comm_transceiver_transmit_priority_queue *queue = &transceiver->transmit_queues[priority_class];
+  memcpy(entry, &queue->entries[queue->head], sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry));
+  queue->head = (queue->head + 1) % capacity;
+  queue->count--;
+}
+
+static void ert_comm_transceiver_transmit_queue_update_status(ert_comm_transceiver *transceiver)
+{
+  pthread_mutex_lock(&transceiver->status_mutex);
+  for (int priority_class = 0; priority_class < ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT; priority_class++) {
+    transceiver->status.priority_classes[priority_class].queued_packet_count =
+        transceiver->transmit_queues[priority_class].count;
+  }
+  pthread_mutex_unlock(&transceiver->status_mutex);
+}
+
+/**
+ * Returns 1 when a packet was popped and 0 when the queue has been closed.
+ */
+static int ert_comm_transceiver_transmit_queue_pop(ert_comm_transceiver *transceiver,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entry)
+{
+  int priority_class;
+
+  pthread_mutex_lock(&transceiver->transmit_queue_mutex);
+
+  while ((priority_class = ert_comm_transceiver_transmit_queue_select(transceiver)) < 0) {
+    if (transceiver->transmit_queue_closed) {
+      pthread_mutex_unlock(&transceiver->transmit_queue_mutex);
+      return 0;
+    }
+    pthread_cond_wait(&transceiver->transmit_queue_cond, &transceiver->transmit_queue_mutex);
+  }
+
+  ert_comm_transceiver_transmit_queue_pop_class(transceiver, priority_class, entry);
+  ert_comm_transceiver_transmit_queue_update_status(transceiver);
+
+  pthread_mutex_unlock(&transceiver->transmit_queue_mutex);
+
+  return 1;
+}
+
+/**
+ * Pops up to max_count packets in priority order without waiting and returns the number of packets popped.
+ * A packet that activates receive mode ends the batch, as the packets after it have to wait for the receive mode to end.
+ */
+static uint32_t ert_comm_transceiver_transmit_queue_pop_available(ert_comm_transceiver *transceiver,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entries, uint32_t max_count)
+{
+  uint32_t count = 0;
+  int priority_class;
+
+  pthread_mutex_lock(&transceiver->transmit_queue_mutex);
+
+  while (count < max_count && (priority_class = ert_comm_transceiver_transmit_queue_select(transceiver)) >= 0) {
+    ert_comm_transceiver_transmit_queue_pop_class(transceiver, priority_class, &entries[count]);
+    count++;
+
+    if (entries[count - 1].set_receive_active) {
+      break;
+    }
+  }
+
+  if (count > 0) {
+    ert_comm_transceiver_transmit_queue_update_status(transceiver);
+  }
+
+  pthread_mutex_unlock(&transceiver->transmit_queue_mutex);
+
+  return count;
+}
+
+static void ert_comm_transceiver_transmit_queue_close(ert_comm_transceiver *transceiver)
+{
+  pthread_mutex_lock(&transceiver->transmit_queue_mutex);
+  transceiver->transmit_queue_closed = true;
+  pthread_cond_broadcast(&transceiver->transmit_queue_cond);
+  pthread_mutex_unlock(&transceiver->transmit_queue_mutex);
+}
+
+/**
+ * Returns the time the oldest realtime class packet may still wait for receive mode to end,
+ * limited to the poll interval. The packet already popped for transmission is given as pending_entry.
+ */
+static uint32_t ert_comm_transceiver_get_realtime_remaining_wait_milliseconds(ert_comm_transceiver *transceiver,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *pending_entry)
+{
+  uint32_t poll_interval_millis = transceiver->config.poll_interval_milliseconds;
+  uint32_t maximum_wait_millis = transceiver->config.transmit_realtime_maximum_wait_milliseconds;
+
+  if (maximum_wait_millis == 0) {
+    return poll_interval_millis;
+  }
+
+  struct timespec current_time;
+  int result = ert_get_current_timestamp(&current_time);
+  if (result != 0) {
+    return poll_interval_millis;
+  }
+
+  uint32_t remaining_wait_millis = poll_interval_millis;
+  struct timespec *queued_timestamp = NULL;
+
+  pthread_mutex_lock(&transceiver->transmit_queue_mutex);
+  ert_comm_transceiver_transmit_priority_queue *queue =
+      &transceiver->transmit_queues[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME];
+  if (pending_entry != NULL && pending_entry->priority_class == ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME) {
+    queued_timestamp = &pending_entry->queued_timestamp;
+  } else if (queue->count > 0) {
+    queued_timestamp = &queue->entries[queue->head].queued_timestamp;
+  }
+  if (queued_timestamp != NULL) {
+    int32_t wait_millis = ert_timespec_diff_milliseconds(queued_timestamp, &current_time);
+    if (wait_millis >= (int32_t) maximum_wait_millis) {
+      remaining_wait_millis = 0;
+    } else if (maximum_wait_millis - wait_millis < remaining_wait_millis) {
+      remaining_wait_millis = maximum_wait_millis - wait_millis;
+    }
+  }
+  pthread_mutex_unlock(&transceiver->transmit_queue_mutex);
+
+  return remaining_wait_millis;
+}
+
+static void ert_comm_transceiver_update_transmit_wait_time(ert_comm_transceiver *transceiver,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entry)
+{
+  struct timespec current_time;
+  int result = ert_get_current_timestamp(&current_time);
+  if (result != 0) {
+    return;
+  }
+
+  int32_t wait_millis = ert_timespec_diff_milliseconds(&entry->queued_timestamp, &current_time);
+  if (wait_millis < 0) {
+    wait_millis = 0;
+  }
+
+  pthread_mutex_lock(&transceiver->status_mutex);
+  ert_comm_transceiver_priority_class_status *class_status = &transceiver->status.priority_classes[entry->priority_class];
+  class_status->transmitted_packet_count++;
+  class_status->last_wait_time_millis = (uint32_t) wait_millis;
+  class_status->total_wait_time_millis += (uint64_t) wait_millis;
+  if ((uint32_t) wait_millis > class_status->max_wait_time_millis) {
+    class_status->max_wait_time_millis = (uint32_t) wait_millis;
+  }
+  pthread_mutex_unlock(&transceiver->status_mutex);
+}
+
+static void ert_comm_transceiver_update_transmit_batch_status(ert_comm_transceiver *transceiver, uint32_t packet_count)
+{
+  pthread_mutex_lock(&transceiver->status_mutex);
+  ert_comm_transceiver_status *status = &transceiver->status;
+  status->transmit_batch_count++;
+  status->transmit_batch_packet_count += packet_count;
+  if (packet_count > status->max_transmit_batch_packet_count) {
+    status->max_transmit_batch_packet_count = packet_count;
+  }
+  pthread_mutex_unlock(&transceiver->status_mutex);
+}
+
+static void ert_comm_transceiver_update_transmit_gap(ert_comm_transceiver *transceiver,
+    struct timespec *done_timestamp, struct timespec *started_timestamp)
+{
+  int64_t gap_micros = ert_timespec_diff_microseconds(done_timestamp, started_timestamp);
+  if (gap_micros < 0) {
+    gap_micros = 0;
+  } else if (gap_micros > UINT32_MAX) {
+    gap_micros = UINT32_MAX;
+  }
+
+  pthread_mutex_lock(&transceiver->status_mutex);
+  ert_comm_transceiver_status *status = &transceiver->status;
+  status->last_transmit_gap_micros = (uint32_t) gap_micros;
+  status->total_transmit_gap_micros += (uint64_t) gap_micros;
+  status->transmit_gap_count++;
+  if ((uint32_t) gap_micros > status->max_transmit_gap_micros) {
+    status->max_transmit_gap_micros = (uint32_t) gap_micros;
+  }
+  pthread_mutex_unlock(&transceiver->status_mutex);
+}
+
 static int ert_comm_transceiver_start_receive(ert_comm_transceiver *transceiver)
 {
   pthread_mutex_lock(&transceiver->device_mutex);
@@ -168,6 +437,130 @@ static int ert_comm_transceiver_start_receive(ert_comm_transceiver *transceiver)
   return result;
 }
 
+static void ert_comm_transceiver_update_listen_before_talk_status(ert_comm_transceiver *transceiver,
+    uint32_t detection_count, uint32_t busy_count, uint32_t backoff_count, uint32_t backoff_millis,
+    bool access_failed)
+{
+  pthread_mutex_lock(&transceiver->status_mutex);
+  ert_comm_transceiver_status *status = &transceiver->status;
+  status->channel_activity_detection_count += detection_count;
+  status->channel_busy_count += busy_count;
+  status->backoff_count += backoff_count;
+  status->total_backoff_millis += backoff_millis;
+  if (access_failed) {
+    status->channel_access_failure_count++;
+  }
+  pthread_mutex_unlock(&transceiver->status_mutex);
+}
+
+static uint32_t ert_comm_transceiver_get_listen_before_talk_backoff_milliseconds(ert_comm_transceiver *transceiver,
+    uint32_t attempt)
+{
+  uint64_t min = transceiver->config.listen_before_talk_backoff_min_milliseconds;
+  uint64_t max = transceiver->config.listen_before_talk_backoff_max_milliseconds;
+
+  uint64_t window = min << (attempt < 16 ? attempt : 16);
+  if (window > max) {
+    window = max;
+  }
+  if (window <= min) {
+    return (uint32_t) min;
+  }
+
+  return (uint32_t) (min + (uint64_t) rand_r(&transceiver->listen_before_talk_random_seed) % (window - min + 1));
+}
+
+/**
+ * Waits for a listen-before-talk backoff with transmit_mutex released, so that configuration and frequency changes
+ * made by the maintenance routine are not blocked by the backoff. Stopping the transceiver interrupts the wait.
+ * Must be called with transmit_mutex locked.
+ */
+static void ert_comm_transceiver_wait_for_listen_before_talk_backoff(ert_comm_transceiver *transceiver,
+    uint32_t milliseconds)
+{
+  struct timespec to;
+
+  int result = ert_get_current_timestamp_offset(&to, milliseconds);
+  if (result < 0) {
+    return;
+  }
+
+  pthread_mutex_unlock(&transceiver->transmit_mutex);
+
+  // The event condition is broadcast on configuration changes and when stopping, the wait ends only on timeout
+  pthread_mutex_lock(&transceiver->event_mutex);
+  while (transceiver->running) {
+    result = pthread_cond_timedwait(&transceiver->event_cond, &transceiver->event_mutex, &to);
+    if (result != 0) {
+      break;
+    }
+  }
+  pthread_mutex_unlock(&transceiver->event_mutex);
+
+  pthread_mutex_lock(&transceiver->transmit_mutex);
+}
+
+/**
+ * Waits until channel activity detection finds the channel idle, backing off for a random and exponentially growing
+ * time after each detected activity. The device receives during the backoff, so that the packet occupying
+ * the channel is not lost. After the maximum number of attempts the batch is transmitted anyway.
+ * Must be called with transmit_mutex locked.
+ */
+static void ert_comm_transceiver_listen_before_talk(ert_comm_transceiver *transceiver)
+{
+  ert_comm_device *device = transceiver->device;
+  ert_comm_driver *driver = transceiver->device->driver;
+
+  if (!transceiver->config.listen_before_talk || driver->detect_channel_activity == NULL) {
+    return;
+  }
+
+  uint32_t max_attempts = transceiver->config.listen_before_talk_max_attempts;
+  uint32_t detection_count = 0;
+  uint32_t busy_count = 0;
+  uint32_t backoff_count = 0;
+  uint32_t backoff_millis = 0;
+  bool access_failed = false;
+
+  for (uint32_t attempt = 0; attempt < max_attempts && transceiver->running; attempt++) {
+    bool activity_detected = false;
+
+    pthread_mutex_lock(&transceiver->device_mutex);
+    int result = driver->detect_channel_activity(device,
+        ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_DETECTION_TIMEOUT_MILLISECONDS, &activity_detected);
+    pthread_mutex_unlock(&transceiver->device_mutex);
+    if (result < 0) {
+      ert_log_error("Error detecting channel activity, result %d", result);
+      break;
+    }
+
+    detection_count++;
+
+    if (!activity_detected) {
+      break;
+    }
+
+    busy_count++;
+
+    if (attempt + 1 >= max_attempts) {
+      ert_log_warn("Channel busy after %d attempts, transmitting anyway", max_attempts);
+      access_failed = true;
+      break;
+    }
+
+    uint32_t millis = ert_comm_transceiver_get_listen_before_talk_backoff_milliseconds(transceiver, attempt);
+    ert_log_debug("Channel busy, backing off for %d ms", millis);
+
+    ert_comm_transceiver_start_receive(transceiver);
+    ert_comm_transceiver_wait_for_listen_before_talk_backoff(transceiver, millis);
+    backoff_count++;
+    backoff_millis += millis;
+  }
+
+  ert_comm_transceiver_update_listen_before_talk_status(transceiver, detection_count, busy_count, backoff_count,
+      backoff_millis, access_failed);
+}
+
 static int ert_comm_transceiver_sleep(ert_comm_transceiver *transceiver)
 {
   pthread_mutex_lock(&transceiver->device_mutex);
@@ -187,7 +580,7 @@ static void ert_comm_transceiver_device_receive_callback(void *context)
   ert_comm_device *device = transceiver->device;
   ert_comm_driver *driver = transceiver->device->driver;
 
-  ert_log_debug("Storing packet");
+  ert_log_trace("Storing packet");
 
   ert_comm_transceiver_packet_receive_buffer_metadata_queue_entry packet_buffer = {0};
 
@@ -201,43 +594,124 @@ static void ert_comm_transceiver_device_receive_callback(void *context)
   uint32_t bytes_received = 0;
   pthread_mutex_lock(&transceiver->device_mutex);
   result = driver->receive(device, transceiver->max_packet_length, packet_buffer.buffer, &bytes_received);
+  packet_buffer.rssi = device->status.last_received_packet_rssi;
+  packet_buffer.snr = device->status.last_received_packet_snr;
   pthread_mutex_unlock(&transceiver->device_mutex);
 
   if (result < 0) {
     ert_buffer_pool_release(transceiver->receive_buffer_pool, packet_buffer.buffer);
-    ert_comm_transceiver_increment_counter(transceiver, ERT_COMM_TRANSCEIVER_COUNTER_TYPE_RECEIVE_INVALID, 0);
+    ert_comm_transceiver_increment_counter(transceiver, ERT_COMM_TRANSCEIVER_COUNTER_TYPE_RECEIVE_INVALID, 1, 0);
     ert_log_error("Error receiving data from comm device, result %d", result);
     return;
   }
 
-  ert_log_debug("Stored %d bytes to packet buffer", bytes_received);
+  ert_log_trace("Stored %d bytes to packet buffer", bytes_received);
 
   packet_buffer.length = bytes_received;
 
-  ert_pipe_push(transceiver->receive_buffer_queue, &packet_buffer, 1);
+  ert_queue_push(transceiver->receive_buffer_queue, &packet_buffer, 1, ERT_QUEUE_WAIT_FOREVER);
+}
+
+/**
+ * Starts transmitting the next packet of the current batch and pushes the packets completed since the previous call
+ * to the transmit result queue in a single push. Packets the device fails to transmit are completed immediately
+ * with an error. Must be called with device_mutex locked.
+ */
+static void ert_comm_transceiver_transmit_batch_continue(ert_comm_transceiver *transceiver)
+{
+  ert_comm_device *device = transceiver->device;
+  ert_comm_driver *driver = transceiver->device->driver;
+  int result;
+
+  while (!transceiver->transmit_batch_packet_on_air
+      && transceiver->transmit_batch_started_count < transceiver->transmit_batch_count) {
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entry =
+        &transceiver->transmit_batch_entries[transceiver->transmit_batch_started_count];
+    transceiver->transmit_batch_started_count++;
+
+    ert_log_trace("Transmit batch: op=%s packet_id=%d set_receive_active=%d", "transmit",
+        entry->id, entry->set_receive_active);
+
+    uint32_t bytes_transmitted = 0;
+    result = driver->transmit(device, entry->length, entry->buffer, &bytes_transmitted);
+    if (result < 0) {
+      ert_log_error("Error transmitting data using comm device, transmit result %d", result);
+      entry->transmit_result = -EIO;
+      entry->transmitted_bytes = 0;
+      continue;
+    }
+
+    entry->transmit_result = 0;
+    entry->transmitted_bytes = bytes_transmitted;
+    transceiver->transmit_batch_packet_on_air = true;
+
+    if (ert_timespec_is_nonzero(&transceiver->transmit_batch_packet_done_timestamp)) {
+      struct timespec started_timestamp;
+      ert_get_current_timestamp(&started_timestamp);
+      ert_comm_transceiver_update_transmit_gap(transceiver,
+          &transceiver->transmit_batch_packet_done_timestamp, &started_timestamp);
+    }
+  }
+
+  uint32_t completed_count = transceiver->transmit_batch_started_count
+      - (transceiver->transmit_batch_packet_on_air ? 1 : 0);
+  if (completed_count > transceiver->transmit_batch_result_count) {
+    ert_queue_push(transceiver->transmit_result_queue,
+        &transceiver->transmit_batch_entries[transceiver->transmit_batch_result_count],
+        completed_count - transceiver->transmit_batch_result_count, ERT_QUEUE_WAIT_FOREVER);
+    transceiver->transmit_batch_result_count = completed_count;
+  }
 }
 
 static void ert_comm_transceiver_device_transmit_callback(void *context)
 {
   ert_comm_transceiver *transceiver = (ert_comm_transceiver *) context;
 
-  ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry packet_buffer_metadata_queue_entry;
+  struct timespec done_timestamp;
+  ert_get_current_timestamp(&done_timestamp);
 
-  ssize_t result = ert_pipe_pop_timed(transceiver->transmit_wait_queue, &packet_buffer_metadata_queue_entry, 1, 1);
-  if (result < 0) {
-    ert_log_error("BUG: ert_pipe_pop_timed timed out for transmit_wait_queue -- no packets in queue, but received transmit callback call");
-    return;
-  }
-  if (result == 0) {
-    ert_log_warn("Pipe closed for ert_pipe_pop_timed for transmit_wait_queue");
+  pthread_mutex_lock(&transceiver->device_mutex);
+
+  if (!transceiver->transmit_batch_packet_on_air) {
+    pthread_mutex_unlock(&transceiver->device_mutex);
+    ert_log_warn("Received transmit callback call, but no packet is being transmitted -- transmission may have timed out");
     return;
   }
 
-  ert_log_debug("Transmit callback: pushing packet to transmit result queue: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-      packet_buffer_metadata_queue_entry.id, *packet_buffer_metadata_queue_entry.transmitted_signal,
-      *packet_buffer_metadata_queue_entry.bytes_transmitted);
+  ert_log_trace("Transmit callback: packet transmitted: id=%d",
+      transceiver->transmit_batch_entries[transceiver->transmit_batch_started_count - 1].id);
+
+  transceiver->transmit_batch_packet_on_air = false;
+  transceiver->transmit_batch_packet_done_timestamp = done_timestamp;
 
-  ert_pipe_push(transceiver->transmit_result_queue, &packet_buffer_metadata_queue_entry, 1);
+  ert_comm_transceiver_transmit_batch_continue(transceiver);
+
+  pthread_mutex_unlock(&transceiver->device_mutex);
+}
+
+/**
+ * Ends the current batch after a transmit timeout, so that no further packets of the batch are transmitted.
+ * The packets without a result are copied to entries_rcv and the number of them is returned.
+ * The number of packets already pushed to the transmit result queue is stored in result_count_rcv.
+ */
+static uint32_t ert_comm_transceiver_transmit_batch_abort(ert_comm_transceiver *transceiver,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entries_rcv, uint32_t *result_count_rcv)
+{
+  pthread_mutex_lock(&transceiver->device_mutex);
+
+  uint32_t count = transceiver->transmit_batch_count - transceiver->transmit_batch_result_count;
+  memcpy(entries_rcv, &transceiver->transmit_batch_entries[transceiver->transmit_batch_result_count],
+      count * sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry));
+
+  *result_count_rcv = transceiver->transmit_batch_result_count;
+
+  transceiver->transmit_batch_packet_on_air = false;
+  transceiver->transmit_batch_count = transceiver->transmit_batch_result_count;
+  transceiver->transmit_batch_started_count = transceiver->transmit_batch_result_count;
+
+  pthread_mutex_unlock(&transceiver->device_mutex);
+
+  return count;
 }
 
 static void ert_comm_transceiver_handle_mode_change(ert_comm_transceiver *transceiver)
@@ -354,7 +828,7 @@ static void *ert_comm_transceiver_maintenance_routine(void *context)
   while (transceiver->running) {
     ert_comm_transceiver_handle_mode_change(transceiver);
 
-    ert_comm_transceiver_wait_for_event(transceiver);
+    ert_comm_transceiver_wait_for_event(transceiver, transceiver->config.poll_interval_milliseconds);
     ert_log_debug("Maintenance: wait for event woke up");
 
     ert_comm_transceiver_handle_config_change(transceiver);
@@ -391,12 +865,20 @@ static bool ert_comm_transceiver_has_maximum_receive_time_been_reached(ert_comm_
   return maximum_receive_time_reached;
 }
 
-static void ert_comm_transceiver_receive_while_receive_active(ert_comm_transceiver *transceiver)
+static void ert_comm_transceiver_receive_while_receive_active(ert_comm_transceiver *transceiver,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *pending_entry)
 {
   ert_comm_device *device = transceiver->device;
   int result;
 
   while (transceiver->running && transceiver->receive_active) {
+    uint32_t wait_millis = ert_comm_transceiver_get_realtime_remaining_wait_milliseconds(transceiver, pending_entry);
+    if (wait_millis == 0) {
+      ert_log_info("Maximum realtime packet wait time of %d ms has been reached, interrupting receive mode",
+          transceiver->config.transmit_realtime_maximum_wait_milliseconds);
+      return;
+    }
+
     ert_log_debug("Mode: receive");
     if (device->status.device_state != ERT_COMM_DEVICE_STATE_RECEIVE_CONTINUOUS) {
       result = ert_comm_transceiver_start_receive(transceiver);
@@ -405,7 +887,7 @@ static void ert_comm_transceiver_receive_while_receive_active(ert_comm_transceiv
       }
     }
 
-    ert_comm_transceiver_wait_for_event(transceiver);
+    ert_comm_transceiver_wait_for_event(transceiver, wait_millis);
     ert_log_debug("Transmit: wait for event woke up");
 
     if (!transceiver->receive_active) {
@@ -426,216 +908,203 @@ static void ert_comm_transceiver_receive_while_receive_active(ert_comm_transceiv
 static void ert_comm_transceiver_release_transmit_buffer(ert_comm_transceiver *transceiver,
     ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *packet_buffer_metadata_queue_entry)
 {
-  if (packet_buffer_metadata_queue_entry->blocking_enabled) {
-    pthread_cond_destroy(packet_buffer_metadata_queue_entry->transmitted_cond);
-    pthread_mutex_destroy(packet_buffer_metadata_queue_entry->transmitted_mutex);
-  }
-
   ert_buffer_pool_release(transceiver->transmit_buffer_pool, packet_buffer_metadata_queue_entry->buffer);
   ert_buffer_pool_release(transceiver->transmit_buffer_metadata_pool, packet_buffer_metadata_queue_entry->metadata);
 }
 
-static void ert_comm_transceiver_signal_transmit_and_release_buffer(ert_comm_transceiver *transceiver,
+static void ert_comm_transceiver_complete_transmit(ert_comm_transceiver *transceiver,
     ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *packet_buffer_metadata_queue_entry,
-    int transmit_result, uint32_t bytes_transmitted, bool timed_out)
+    int transmit_result, uint32_t bytes_transmitted)
 {
-  int result;
-
-  timeout:
-  if (timed_out || *packet_buffer_metadata_queue_entry->timeout) {
-    ert_log_warn("Timeout detected for packet id=%d, releasing buffer", packet_buffer_metadata_queue_entry->id);
-    pthread_mutex_unlock(packet_buffer_metadata_queue_entry->transmitted_mutex);
-
+  if (!packet_buffer_metadata_queue_entry->blocking_enabled) {
     ert_comm_transceiver_release_transmit_buffer(transceiver, packet_buffer_metadata_queue_entry);
     return;
   }
 
-  if (!packet_buffer_metadata_queue_entry->blocking_enabled) {
-    ert_buffer_pool_release(transceiver->transmit_buffer_pool, packet_buffer_metadata_queue_entry->buffer);
-    ert_buffer_pool_release(transceiver->transmit_buffer_metadata_pool, packet_buffer_metadata_queue_entry->metadata);
-    return;
-  }
+  ert_comm_transceiver_packet_transmit_buffer_metadata *metadata = packet_buffer_metadata_queue_entry->metadata;
 
-  size_t retries = 3;
-  retry_lock:
-  result = pthread_mutex_trylock(packet_buffer_metadata_queue_entry->transmitted_mutex);
-  if (result == EBUSY) {
-    ert_log_warn("Packet buffer mutex locked for packet id=%d, waiting retrying %d times...",
-        packet_buffer_metadata_queue_entry->id, retries);
+  pthread_mutex_lock(&transceiver->transmit_completion_mutex);
 
-    sleep(1);
+  bool abandoned = (metadata->completion_state == ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_ABANDONED);
+  if (!abandoned) {
+    metadata->result = transmit_result;
+    metadata->bytes_transmitted = bytes_transmitted;
+    metadata->completion_state = ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_COMPLETED;
 
-    retries--;
-    if (retries < 1) {
-      ert_log_error("Packet buffer mutex timeout for packet id=%d, releasing buffer",
-          packet_buffer_metadata_queue_entry->id);
-      timed_out = true;
-      goto timeout;
+    if (transceiver->transmit_completion_waiter_count > 0) {
+      pthread_cond_broadcast(&transceiver->transmit_completion_cond);
     }
-
-    goto retry_lock;
-  } else if (result != 0) {
-    ert_log_error("pthread_mutex_trylock failed for packet buffer mutex id=%d, result %d, releasing buffer",
-        packet_buffer_metadata_queue_entry->id, result);
-    timed_out = true;
-    goto timeout;
   }
 
-  *packet_buffer_metadata_queue_entry->result = transmit_result;
-  *packet_buffer_metadata_queue_entry->bytes_transmitted = bytes_transmitted;
-  *packet_buffer_metadata_queue_entry->transmitted_signal = true;
-  pthread_cond_signal(packet_buffer_metadata_queue_entry->transmitted_cond);
-  pthread_mutex_unlock(packet_buffer_metadata_queue_entry->transmitted_mutex);
+  pthread_mutex_unlock(&transceiver->transmit_completion_mutex);
 
-  struct timespec to;
-  result = ert_get_current_timestamp_offset(&to, transceiver->config.transmit_timeout_milliseconds);
-  if (result < 0) {
+  if (abandoned) {
+    ert_log_warn("Transmit timed out for packet id=%d, releasing buffer", packet_buffer_metadata_queue_entry->id);
     ert_comm_transceiver_release_transmit_buffer(transceiver, packet_buffer_metadata_queue_entry);
-    return;
   }
+}
 
-  ert_log_debug("Preparing to wait for packet destruction: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-      packet_buffer_metadata_queue_entry->id, *packet_buffer_metadata_queue_entry->transmitted_signal,
-      *packet_buffer_metadata_queue_entry->bytes_transmitted);
+static void ert_comm_transceiver_handle_transmit_results(ert_comm_transceiver *transceiver,
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *results, uint32_t count)
+{
+  uint32_t transmitted_packet_count = 0;
+  uint64_t transmitted_bytes = 0;
 
-  pthread_mutex_lock(packet_buffer_metadata_queue_entry->transmitted_mutex);
+  for (uint32_t i = 0; i < count; i++) {
+    if (results[i].transmit_result == 0) {
+      transmitted_packet_count++;
+      transmitted_bytes += results[i].transmitted_bytes;
+    }
+  }
 
-  while (!*packet_buffer_metadata_queue_entry->destroy_signal) {
-    ert_log_debug("Waiting for packet destruction: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-        packet_buffer_metadata_queue_entry->id, *packet_buffer_metadata_queue_entry->transmitted_signal,
-        *packet_buffer_metadata_queue_entry->bytes_transmitted);
-    result = pthread_cond_timedwait(packet_buffer_metadata_queue_entry->transmitted_cond,
-        packet_buffer_metadata_queue_entry->transmitted_mutex, &to);
+  if (transmitted_packet_count > 0) {
+    ert_comm_transceiver_increment_counter(transceiver, ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT,
+        transmitted_packet_count, transmitted_bytes);
+  }
 
-    if (result == ETIMEDOUT) {
-      ert_log_error("Timeout waiting for packet destruction: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-          packet_buffer_metadata_queue_entry->id, *packet_buffer_metadata_queue_entry->transmitted_signal,
-          *packet_buffer_metadata_queue_entry->bytes_transmitted);
-      break;
-    } else if (result != 0) {
-      ert_log_error("Error waiting for destruction for packet id=%d, result %d", result);
-      break;
+  for (uint32_t i = 0; i < count; i++) {
+    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *result = &results[i];
+
+    ert_log_trace("Transmit dispatch routine: queue=%s op=%s packet_id=%d set_receive_active=%d transmit_result=%d",
+        "transmit_result", "pop", result->id, result->set_receive_active, result->transmit_result);
+
+    if (result->transmit_result < 0) {
+      if (transceiver->config.transmit_callback != NULL) {
+        // TODO: indicate transmission failure explicitly for transmit_callback
+        transceiver->config.transmit_callback(result->id, 0, transceiver->config.transmit_callback_context);
+      }
+
+      ert_comm_transceiver_complete_transmit(transceiver, result, result->transmit_result, 0);
+      continue;
     }
-  }
 
-  pthread_mutex_unlock(packet_buffer_metadata_queue_entry->transmitted_mutex);
+    if (transceiver->config.transmit_callback != NULL) {
+      transceiver->config.transmit_callback(result->id, result->length, transceiver->config.transmit_callback_context);
+    }
 
-  ert_comm_transceiver_release_transmit_buffer(transceiver, packet_buffer_metadata_queue_entry);
+    if (result->set_receive_active) {
+      ert_comm_transceiver_set_receive_active(transceiver, true);
+    }
+
+    ert_log_trace("Transmit dispatch routine: op=%s packet_id=%d set_receive_active=%d",
+        "notify", result->id, result->set_receive_active);
+
+    ert_comm_transceiver_complete_transmit(transceiver, result, 0, result->transmitted_bytes);
+  }
 }
 
+/**
+ * Pops a batch of queued packets for each wake-up. The first packet of the batch is transmitted by this routine
+ * and the rest by the device transmit callback as soon as the previous packet has been transmitted, so that
+ * the radio stays busy without waiting for this routine to be scheduled. The completed packets are handled
+ * in bulk while the rest of the batch is still being transmitted.
+ */
 static void *ert_comm_transceiver_transmit_dispatch_routine(void *context)
 {
   ert_comm_transceiver *transceiver = (ert_comm_transceiver *) context;
-  ert_comm_device *device = transceiver->device;
-  ert_comm_driver *driver = transceiver->device->driver;
-  int result;
+  ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entries = transceiver->transmit_batch_entries;
+
+  ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *results =
+      calloc(transceiver->transmit_batch_length, sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry));
+  if (results == NULL) {
+    ert_log_fatal("Error allocating memory for transmit results: %s", strerror(errno));
+    return NULL;
+  }
 
   while (transceiver->running) {
-    ert_comm_transceiver_receive_while_receive_active(transceiver);
+    ert_comm_transceiver_receive_while_receive_active(transceiver, NULL);
     if (!transceiver->running) {
       break;
     }
 
-    ert_log_debug("Transmit dispatch routine: queue=%s op=%s", "transmit_buffer", "pop_wait");
+    ert_log_trace("Transmit dispatch routine: queue=%s op=%s", "transmit_buffer", "pop_wait");
 
-    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry packet_buffer_metadata_queue_entry_incoming;
-    ssize_t pop_result = ert_pipe_pop(transceiver->transmit_buffer_queue, &packet_buffer_metadata_queue_entry_incoming, 1);
+    int pop_result = ert_comm_transceiver_transmit_queue_pop(transceiver, &entries[0]);
     if (pop_result == 0) {
       break;
     }
 
-    ert_comm_transceiver_receive_while_receive_active(transceiver);
+    ert_comm_transceiver_receive_while_receive_active(transceiver, &entries[0]);
     if (!transceiver->running) {
       break;
     }
 
-    ert_log_debug("Transmit dispatch routine: queue=%s op=%s packet_id=%d set_receive_active=%d",
-        "transmit_buffer", "pop", packet_buffer_metadata_queue_entry_incoming.id, packet_buffer_metadata_queue_entry_incoming.set_receive_active);
-
-    transceiver->transmit_active = true;
-    pthread_mutex_lock(&transceiver->transmit_mutex);
-
-    uint32_t bytes_transmitted = 0;
-    pthread_mutex_lock(&transceiver->device_mutex);
-    result = driver->transmit(device, packet_buffer_metadata_queue_entry_incoming.length,
-        packet_buffer_metadata_queue_entry_incoming.buffer, &bytes_transmitted);
-    pthread_mutex_unlock(&transceiver->device_mutex);
-
-    if (result < 0) {
-      transceiver->transmit_active = false;
-      pthread_mutex_unlock(&transceiver->transmit_mutex);
+    uint32_t count = 1;
+    if (!entries[0].set_receive_active) {
+      count += ert_comm_transceiver_transmit_queue_pop_available(transceiver, &entries[1],
+          transceiver->transmit_batch_length - 1);
+    }
 
-      ert_log_error("Error transmitting data using comm device, transmit result %d", result);
+    for (uint32_t i = 0; i < count; i++) {
+      ert_log_trace("Transmit dispatch routine: queue=%s op=%s packet_id=%d set_receive_active=%d priority_class=%d",
+          "transmit_buffer", "pop", entries[i].id, entries[i].set_receive_active, entries[i].priority_class);
 
-      if (transceiver->config.transmit_callback != NULL) {
-        // TODO: indicate transmission failure explicitly for transmit_callback
-        transceiver->config.transmit_callback(packet_buffer_metadata_queue_entry_incoming.id, 0, transceiver->config.transmit_callback_context);
-      }
-
-      ert_comm_transceiver_signal_transmit_and_release_buffer(
-          transceiver, &packet_buffer_metadata_queue_entry_incoming, -EIO, 0, false);
-      continue;
+      ert_comm_transceiver_update_transmit_wait_time(transceiver, &entries[i]);
     }
 
-    ert_log_debug("Transmit dispatch routine: queue=%s op=%s packet_id=%d set_receive_active=%d",
-        "transmit_wait", "push", packet_buffer_metadata_queue_entry_incoming.id, packet_buffer_metadata_queue_entry_incoming.set_receive_active);
-
-    ert_pipe_push(transceiver->transmit_wait_queue, &packet_buffer_metadata_queue_entry_incoming, 1);
+    ert_comm_transceiver_update_transmit_batch_status(transceiver, count);
 
-    ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry packet_buffer_metadata_queue_entry_result;
+    transceiver->transmit_active = true;
+    pthread_mutex_lock(&transceiver->transmit_mutex);
 
-    pop_result = ert_pipe_pop_timed(transceiver->transmit_result_queue, &packet_buffer_metadata_queue_entry_result, 1,
-        transceiver->config.transmit_timeout_milliseconds);
-    transceiver->transmit_active = false;
-    pthread_mutex_unlock(&transceiver->transmit_mutex);
-    if (pop_result < 0) {
-      ert_log_error("ert_pipe_pop_timed failed or timed out for transmit_result_queue, result %d", pop_result);
-
-      // Pop timed out entry from queue
-      ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry extra_queue_entry;
-      pop_result = ert_pipe_pop_timed(transceiver->transmit_wait_queue, &extra_queue_entry, 1, 1);
-      if (pop_result > 0) {
-        ert_log_warn("ert_pipe_pop_timed timed out for transmit_result_queue, removed %d packets from transmit_wait_queue", pop_result);
-      } else if (pop_result < 0) {
-        ert_log_error("ert_pipe_pop_timed timed out for transmit_result_queue, attempted to empty transmit_wait_queue, but no packets found");
-      }
+    ert_comm_transceiver_listen_before_talk(transceiver);
 
-      ert_comm_transceiver_signal_transmit_and_release_buffer(
-          transceiver, &packet_buffer_metadata_queue_entry_incoming, -ETIMEDOUT, 0, true);
+    pthread_mutex_lock(&transceiver->device_mutex);
+    transceiver->transmit_batch_count = count;
+    transceiver->transmit_batch_started_count = 0;
+    transceiver->transmit_batch_result_count = 0;
+    memset(&transceiver->transmit_batch_packet_done_timestamp, 0, sizeof(struct timespec));
+    ert_comm_transceiver_transmit_batch_continue(transceiver);
+    pthread_mutex_unlock(&transceiver->device_mutex);
 
-      if (pop_result == 0) {
+    uint32_t expected_result_count = count;
+    uint32_t result_count = 0;
+    bool transmit_mutex_locked = true;
+    bool closed = false;
+
+    while (result_count < expected_result_count) {
+      ssize_t result_pop_count = ert_queue_pop(transceiver->transmit_result_queue, results,
+          expected_result_count - result_count, transceiver->config.transmit_timeout_milliseconds);
+      if (result_pop_count < 0) {
+        ert_log_error("ert_queue_pop failed or timed out for transmit_result_queue, result %d",
+            result_pop_count);
+
+        uint32_t aborted_count = ert_comm_transceiver_transmit_batch_abort(transceiver, results,
+            &expected_result_count);
+
+        for (uint32_t i = 0; i < aborted_count; i++) {
+          ert_comm_transceiver_complete_transmit(transceiver, &results[i], -ETIMEDOUT, 0);
+        }
+        continue;
+      }
+      if (result_pop_count == 0) {
+        closed = true;
         break;
       }
 
-      continue;
-    }
-    if (pop_result == 0) {
-      break;
-    }
-
-    ert_comm_transceiver_increment_counter(transceiver, ERT_COMM_PROTOCOL_COUNTER_TYPE_TRANSMIT, bytes_transmitted);
+      result_count += (uint32_t) result_pop_count;
 
-    ert_log_debug("Transmit dispatch routine: queue=%s op=%s packet_id=%d set_receive_active=%d",
-        "transmit_result", "pop", packet_buffer_metadata_queue_entry_result.id, packet_buffer_metadata_queue_entry_result.set_receive_active);
+      if (result_count == expected_result_count) {
+        transceiver->transmit_active = false;
+        pthread_mutex_unlock(&transceiver->transmit_mutex);
+        transmit_mutex_locked = false;
+      }
 
-    if (transceiver->config.transmit_callback != NULL) {
-      transceiver->config.transmit_callback(packet_buffer_metadata_queue_entry_result.id, packet_buffer_metadata_queue_entry_result.length,
-          transceiver->config.transmit_callback_context);
+      ert_comm_transceiver_handle_transmit_results(transceiver, results, (uint32_t) result_pop_count);
     }
 
-    if (packet_buffer_metadata_queue_entry_result.set_receive_active) {
-      ert_comm_transceiver_set_receive_active(transceiver, true);
+    if (transmit_mutex_locked) {
+      transceiver->transmit_active = false;
+      pthread_mutex_unlock(&transceiver->transmit_mutex);
     }
 
-    if (packet_buffer_metadata_queue_entry_result.blocking_enabled) {
-      ert_log_debug("Transmit dispatch routine: op=%s packet_id=%d set_receive_active=%d",
-          "notify", packet_buffer_metadata_queue_entry_result.id, packet_buffer_metadata_queue_entry_result.set_receive_active);
-
-      ert_comm_transceiver_signal_transmit_and_release_buffer(
-          transceiver, &packet_buffer_metadata_queue_entry_result, 0, bytes_transmitted, false);
+    if (closed) {
+      break;
     }
   }
 
+  free(results);
+
   return NULL;
 }
 
@@ -644,21 +1113,34 @@ static void *ert_comm_transceiver_receive_dispatch_routine(void *context)
   ert_comm_transceiver *transceiver = (ert_comm_transceiver *) context;
 
   while (transceiver->running) {
-    ert_comm_transceiver_packet_receive_buffer_metadata_queue_entry packet_buffer;
+    ert_comm_transceiver_packet_receive_buffer_metadata_queue_entry packet_buffers[ERT_COMM_TRANSCEIVER_RECEIVE_DISPATCH_BATCH_PACKET_COUNT];
 
-    size_t pop_result = ert_pipe_pop(transceiver->receive_buffer_queue, &packet_buffer, 1);
-    if (pop_result == 0) {
+    ssize_t pop_count = ert_queue_pop(transceiver->receive_buffer_queue, packet_buffers,
+        ERT_COMM_TRANSCEIVER_RECEIVE_DISPATCH_BATCH_PACKET_COUNT, ERT_QUEUE_WAIT_FOREVER);
+    if (pop_count <= 0) {
       break;
     }
 
-    ert_comm_transceiver_increment_counter(transceiver, ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE, packet_buffer.length);
-
-    if (transceiver->config.receive_callback != NULL) {
-      transceiver->config.receive_callback(packet_buffer.length, packet_buffer.buffer,
-          transceiver->config.receive_callback_context);
+    uint32_t total_length = 0;
+    for (ssize_t i = 0; i < pop_count; i++) {
+      total_length += packet_buffers[i].length;
     }
+    ert_comm_transceiver_increment_counter(transceiver, ERT_COMM_PROTOCOL_COUNTER_TYPE_RECEIVE,
+        (uint32_t) pop_count, total_length);
+
+    for (ssize_t i = 0; i < pop_count; i++) {
+      pthread_mutex_lock(&transceiver->status_mutex);
+      transceiver->status.last_received_packet_rssi = packet_buffers[i].rssi;
+      transceiver->status.last_received_packet_snr = packet_buffers[i].snr;
+      pthread_mutex_unlock(&transceiver->status_mutex);
+
+      if (transceiver->config.receive_callback != NULL) {
+        transceiver->config.receive_callback(packet_buffers[i].length, packet_buffers[i].buffer,
+            transceiver->config.receive_callback_context);
+      }
 
-    ert_buffer_pool_release(transceiver->receive_buffer_pool, packet_buffer.buffer);
+      ert_buffer_pool_release(transceiver->receive_buffer_pool, packet_buffers[i].buffer);
+    }
   }
 
   return NULL;
@@ -686,6 +1168,11 @@ int ert_comm_transceiver_start(ert_comm_device *device,
 
   transceiver->max_packet_length = device->driver->get_max_packet_length(device);
 
+  struct timespec seed_timestamp;
+  ert_get_current_timestamp(&seed_timestamp);
+  transceiver->listen_before_talk_random_seed =
+      (unsigned int) (seed_timestamp.tv_nsec ^ seed_timestamp.tv_sec ^ (uintptr_t) transceiver);
+
   result = pthread_mutex_init(&transceiver->transmit_mutex, NULL);
   if (result != 0) {
     ert_log_error("Error initializing transmit mutex");
@@ -713,14 +1200,36 @@ int ert_comm_transceiver_start(ert_comm_device *device,
     goto error_event_mutex;
   }
 
+  result = pthread_mutex_init(&transceiver->transmit_queue_mutex, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing transmit queue mutex");
+    goto error_event_cond;
+  }
+  result = pthread_cond_init(&transceiver->transmit_queue_cond, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing transmit queue condition");
+    goto error_transmit_queue_mutex;
+  }
+
+  result = pthread_mutex_init(&transceiver->transmit_completion_mutex, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing transmit completion mutex");
+    goto error_transmit_queue_cond;
+  }
+  result = pthread_cond_init(&transceiver->transmit_completion_cond, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing transmit completion condition");
+    goto error_transmit_completion_mutex;
+  }
+
   result = ert_buffer_pool_create(transceiver->max_packet_length, transceiver->config.receive_buffer_length_packets,
       &transceiver->receive_buffer_pool);
   if (result != 0) {
     ert_log_error("Error initializing receive buffer pool");
-    goto error_event_cond;
+    goto error_transmit_completion_cond;
   }
 
-  result = ert_pipe_create(sizeof(ert_comm_transceiver_packet_receive_buffer_metadata_queue_entry), transceiver->config.receive_buffer_length_packets,
+  result = ert_queue_create(sizeof(ert_comm_transceiver_packet_receive_buffer_metadata_queue_entry), transceiver->config.receive_buffer_length_packets,
       &transceiver->receive_buffer_queue);
   if (result != 0) {
     ert_log_error("Error initializing receive queue");
@@ -741,25 +1250,36 @@ int ert_comm_transceiver_start(ert_comm_device *device,
     goto error_transmit_buffer_metadata_pool;
   }
 
-  result = ert_pipe_create(sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry), transceiver->config.transmit_buffer_length_packets,
-      &transceiver->transmit_buffer_queue);
-  if (result != 0) {
-    ert_log_error("Error initializing transmit queue");
-    goto error_transmit_buffer_pool;
+  for (int priority_class = 0; priority_class < ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT; priority_class++) {
+    transceiver->transmit_queues[priority_class].entries =
+        calloc(transceiver->config.transmit_buffer_length_packets, sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry));
+    if (transceiver->transmit_queues[priority_class].entries == NULL) {
+      ert_log_error("Error allocating memory for transmit queue: %s", strerror(errno));
+      result = -ENOMEM;
+      goto error_transmit_buffer_queue;
+    }
   }
 
-  result = ert_pipe_create(sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry), transceiver->config.transmit_buffer_length_packets,
-      &transceiver->transmit_wait_queue);
-  if (result != 0) {
-    ert_log_error("Error initializing transmit queue");
+  transceiver->transmit_batch_length = transceiver->config.transmit_batch_packet_count;
+  if (transceiver->transmit_batch_length < 1) {
+    transceiver->transmit_batch_length = 1;
+  } else if (transceiver->transmit_batch_length > transceiver->config.transmit_buffer_length_packets) {
+    transceiver->transmit_batch_length = transceiver->config.transmit_buffer_length_packets;
+  }
+
+  transceiver->transmit_batch_entries =
+      calloc(transceiver->transmit_batch_length, sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry));
+  if (transceiver->transmit_batch_entries == NULL) {
+    ert_log_error("Error allocating memory for transmit batch: %s", strerror(errno));
+    result = -ENOMEM;
     goto error_transmit_buffer_queue;
   }
 
-  result = ert_pipe_create(sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry), transceiver->config.transmit_buffer_length_packets,
+  result = ert_queue_create(sizeof(ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry), transceiver->config.transmit_buffer_length_packets,
       &transceiver->transmit_result_queue);
   if (result != 0) {
     ert_log_error("Error initializing transmit queue");
-    goto error_transmit_wait_queue;
+    goto error_transmit_batch_entries;
   }
 
   device->driver->set_callback_context(device, transceiver);
@@ -795,26 +1315,39 @@ int ert_comm_transceiver_start(ert_comm_device *device,
   transceiver->running = false;
 
   error_transmit_result_queue:
-  ert_pipe_destroy(transceiver->transmit_result_queue);
+  ert_queue_destroy(transceiver->transmit_result_queue);
 
-  error_transmit_wait_queue:
-  ert_pipe_destroy(transceiver->transmit_wait_queue);
+  error_transmit_batch_entries:
+  free(transceiver->transmit_batch_entries);
 
   error_transmit_buffer_queue:
-  ert_pipe_destroy(transceiver->transmit_buffer_queue);
+  for (int priority_class = 0; priority_class < ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT; priority_class++) {
+    free(transceiver->transmit_queues[priority_class].entries);
+  }
 
-  error_transmit_buffer_pool:
   ert_buffer_pool_destroy(transceiver->transmit_buffer_pool);
 
   error_transmit_buffer_metadata_pool:
   ert_buffer_pool_destroy(transceiver->transmit_buffer_metadata_pool);
 
   error_receive_buffer_queue:
-  ert_pipe_destroy(transceiver->receive_buffer_queue);
+  ert_queue_destroy(transceiver->receive_buffer_queue);
 
   error_receive_buffer_pool:
   ert_buffer_pool_destroy(transceiver->receive_buffer_pool);
 
+  error_transmit_completion_cond:
+  pthread_cond_destroy(&transceiver->transmit_completion_cond);
+
+  error_transmit_completion_mutex:
+  pthread_mutex_destroy(&transceiver->transmit_completion_mutex);
+
+  error_transmit_queue_cond:
+  pthread_cond_destroy(&transceiver->transmit_queue_cond);
+
+  error_transmit_queue_mutex:
+  pthread_mutex_destroy(&transceiver->transmit_queue_mutex);
+
   error_event_cond:
   pthread_cond_destroy(&transceiver->event_cond);
 
@@ -902,109 +1435,91 @@ int ert_comm_transceiver_transmit(ert_comm_transceiver *transceiver,
   packet_buffer_metadata_queue_entry.set_receive_active = (flags & ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_SET_RECEIVE_ACTIVE) ? true : false;
   packet_buffer_metadata_queue_entry.metadata = packet_buffer_metadata;
 
-  ert_log_debug("Transmitting packet: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-      packet_buffer_metadata_queue_entry.id, packet_buffer_metadata->transmitted_signal, packet_buffer_metadata->bytes_transmitted);
-
-  if (packet_buffer_metadata_queue_entry.blocking_enabled) {
-    packet_buffer_metadata->bytes_transmitted = 0;
-    packet_buffer_metadata->transmitted_signal = false;
-    result = pthread_mutex_init(&packet_buffer_metadata->transmitted_mutex, NULL);
-    if (result != 0) {
-      ert_log_error("Error initializing transmitted_mutex, result %d", result);
-      ert_buffer_pool_release(transceiver->transmit_buffer_pool, packet_buffer_metadata_queue_entry.buffer);
-      ert_buffer_pool_release(transceiver->transmit_buffer_metadata_pool, packet_buffer_metadata);
-      return -EIO;
-    }
-    result = pthread_cond_init(&packet_buffer_metadata->transmitted_cond, NULL);
-    if (result != 0) {
-      ert_log_error("Error initializing transmitted_cond, result %d", result);
-      pthread_mutex_destroy(&packet_buffer_metadata->transmitted_mutex);
-      ert_buffer_pool_release(transceiver->transmit_buffer_pool, packet_buffer_metadata_queue_entry.buffer);
-      ert_buffer_pool_release(transceiver->transmit_buffer_metadata_pool, packet_buffer_metadata);
-      return -EIO;
-    }
-    packet_buffer_metadata->destroy_signal = false;
-    packet_buffer_metadata->timeout = false;
-    packet_buffer_metadata->result = -EINVAL;
-
-    packet_buffer_metadata_queue_entry.bytes_transmitted = &packet_buffer_metadata->bytes_transmitted;
-    packet_buffer_metadata_queue_entry.transmitted_signal = &packet_buffer_metadata->transmitted_signal;
-    packet_buffer_metadata_queue_entry.transmitted_mutex = &packet_buffer_metadata->transmitted_mutex;
-    packet_buffer_metadata_queue_entry.transmitted_cond = &packet_buffer_metadata->transmitted_cond;
-    packet_buffer_metadata_queue_entry.destroy_signal = &packet_buffer_metadata->destroy_signal;
-    packet_buffer_metadata_queue_entry.timeout = &packet_buffer_metadata->timeout;
-    packet_buffer_metadata_queue_entry.result = &packet_buffer_metadata->result;
+  if (flags & ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_REALTIME) {
+    packet_buffer_metadata_queue_entry.priority_class = ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME;
+  } else if (flags & ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_BULK) {
+    packet_buffer_metadata_queue_entry.priority_class = ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK;
+  } else {
+    packet_buffer_metadata_queue_entry.priority_class = ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL;
   }
 
+  packet_buffer_metadata->completion_state = ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_PENDING;
+  packet_buffer_metadata->bytes_transmitted = 0;
+  packet_buffer_metadata->result = -EINVAL;
+
   memcpy(packet_buffer_metadata_queue_entry.buffer, data, length);
 
-  ert_log_debug("Pushing packet: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-      packet_buffer_metadata_queue_entry.id, packet_buffer_metadata->transmitted_signal, packet_buffer_metadata->bytes_transmitted);
+  ert_log_trace("Pushing packet: id=%d, blocking_enabled=%d", packet_buffer_metadata_queue_entry.id,
+      packet_buffer_metadata_queue_entry.blocking_enabled);
 
   struct timespec to;
   if (packet_buffer_metadata_queue_entry.blocking_enabled) {
     result = ert_get_current_timestamp_offset(&to, transceiver->config.transmit_timeout_milliseconds);
     if (result < 0) {
-      pthread_cond_destroy(&packet_buffer_metadata->transmitted_cond);
-      pthread_mutex_destroy(&packet_buffer_metadata->transmitted_mutex);
-      ert_buffer_pool_release(transceiver->transmit_buffer_pool, packet_buffer_metadata_queue_entry.buffer);
-      ert_buffer_pool_release(transceiver->transmit_buffer_metadata_pool, packet_buffer_metadata);
+      ert_comm_transceiver_release_transmit_buffer(transceiver, &packet_buffer_metadata_queue_entry);
       return -EIO;
     }
   }
 
-  ert_pipe_push(transceiver->transmit_buffer_queue, &packet_buffer_metadata_queue_entry, 1);
+  ert_get_current_timestamp(&packet_buffer_metadata_queue_entry.queued_timestamp);
 
-  if (packet_buffer_metadata_queue_entry.blocking_enabled) {
-    ert_log_debug("Locking packet: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-        packet_buffer_metadata_queue_entry.id, packet_buffer_metadata->transmitted_signal, packet_buffer_metadata->bytes_transmitted);
+  result = ert_comm_transceiver_transmit_queue_push(transceiver, &packet_buffer_metadata_queue_entry);
+  if (result < 0) {
+    ert_log_error("Transmit queue full for packet id=%d", packet_buffer_metadata_queue_entry.id);
+    ert_comm_transceiver_release_transmit_buffer(transceiver, &packet_buffer_metadata_queue_entry);
+    return result;
+  }
 
-    pthread_mutex_lock(packet_buffer_metadata_queue_entry.transmitted_mutex);
-    while (!*packet_buffer_metadata_queue_entry.transmitted_signal) {
-      ert_log_debug("Waiting for packet: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-          packet_buffer_metadata_queue_entry.id, packet_buffer_metadata->transmitted_signal, packet_buffer_metadata->bytes_transmitted);
-      result = pthread_cond_timedwait(packet_buffer_metadata_queue_entry.transmitted_cond,
-          packet_buffer_metadata_queue_entry.transmitted_mutex, &to);
+  if (packet_buffer_metadata_queue_entry.priority_class == ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME
+      && transceiver->receive_active) {
+    // Wakes up the transmit dispatch routine waiting in receive mode to track the realtime packet wait time
+    ert_comm_transceiver_signal_event(transceiver);
+  }
+
+  if (!packet_buffer_metadata_queue_entry.blocking_enabled) {
+    return 0;
+  }
+
+  pthread_mutex_lock(&transceiver->transmit_completion_mutex);
+  transceiver->transmit_completion_waiter_count++;
+
+  while (packet_buffer_metadata->completion_state == ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_PENDING) {
+    ert_log_trace("Waiting for packet: id=%d", packet_buffer_metadata_queue_entry.id);
+    result = pthread_cond_timedwait(&transceiver->transmit_completion_cond, &transceiver->transmit_completion_mutex, &to);
+    if (result != 0 && packet_buffer_metadata->completion_state == ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_PENDING) {
+      // The transmit dispatch routine releases the buffers of an abandoned packet when it completes
+      packet_buffer_metadata->completion_state = ERT_COMM_TRANSCEIVER_TRANSMIT_COMPLETION_STATE_ABANDONED;
+      transceiver->transmit_completion_waiter_count--;
+      pthread_mutex_unlock(&transceiver->transmit_completion_mutex);
 
       if (result == ETIMEDOUT) {
-        packet_buffer_metadata->timeout = true;
-        ert_log_error("Timeout for packet: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-            packet_buffer_metadata_queue_entry.id, packet_buffer_metadata->transmitted_signal, packet_buffer_metadata->bytes_transmitted);
+        ert_log_error("Timeout for packet: id=%d", packet_buffer_metadata_queue_entry.id);
         return -ETIMEDOUT;
-      } else if (result != 0) {
-        packet_buffer_metadata->timeout = true;
-        ert_log_error("Error waiting for packet id=%d, pthread_cond_timedwait failed with result %d",
-            packet_buffer_metadata_queue_entry.id, result);
-        return -EIO;
       }
-    }
-
-    ert_log_debug("Done packet: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-        packet_buffer_metadata_queue_entry.id, packet_buffer_metadata->transmitted_signal, packet_buffer_metadata->bytes_transmitted);
 
-    uint32_t bytes_transmitted = packet_buffer_metadata->bytes_transmitted;
-    int transmit_result = packet_buffer_metadata->result;
-
-    pthread_mutex_unlock(packet_buffer_metadata_queue_entry.transmitted_mutex);
+      ert_log_error("Error waiting for packet id=%d, pthread_cond_timedwait failed with result %d",
+          packet_buffer_metadata_queue_entry.id, result);
+      return -EIO;
+    }
+  }
 
-    ert_log_debug("Unlocked packet: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-        packet_buffer_metadata_queue_entry.id, packet_buffer_metadata->transmitted_signal, packet_buffer_metadata->bytes_transmitted);
+  transceiver->transmit_completion_waiter_count--;
+  pthread_mutex_unlock(&transceiver->transmit_completion_mutex);
 
-    ert_log_debug("Signal destruction for packet: id=%d, transmitted_signal=%d, bytes_transmitted=%d",
-        packet_buffer_metadata_queue_entry.id, packet_buffer_metadata->transmitted_signal, packet_buffer_metadata->bytes_transmitted);
+  uint32_t bytes_transmitted = packet_buffer_metadata->bytes_transmitted;
+  int transmit_result = packet_buffer_metadata->result;
 
-    pthread_mutex_lock(packet_buffer_metadata_queue_entry.transmitted_mutex);
-    packet_buffer_metadata->destroy_signal = true;
-    pthread_cond_signal(packet_buffer_metadata_queue_entry.transmitted_cond);
-    pthread_mutex_unlock(packet_buffer_metadata_queue_entry.transmitted_mutex);
+  ert_log_trace("Done packet: id=%d, result=%d, bytes_transmitted=%d", packet_buffer_metadata_queue_entry.id,
+      transmit_result, bytes_transmitted);
 
-    if (transmit_result < 0) {
-      return transmit_result;
-    }
+  ert_comm_transceiver_release_transmit_buffer(transceiver, &packet_buffer_metadata_queue_entry);
 
-    *bytes_transmitted_rcv = bytes_transmitted;
+  if (transmit_result < 0) {
+    return transmit_result;
   }
 
+  *bytes_transmitted_rcv = bytes_transmitted;
+
   return 0;
 }
 
@@ -1029,6 +1544,17 @@ int ert_comm_transceiver_get_status(ert_comm_transceiver *transceiver, ert_comm_
   return 0;
 }
 
+int ert_comm_transceiver_get_received_packet_link_quality(ert_comm_transceiver *transceiver,
+    float *rssi, float *snr)
+{
+  pthread_mutex_lock(&transceiver->status_mutex);
+  *rssi = transceiver->status.last_received_packet_rssi;
+  *snr = transceiver->status.last_received_packet_snr;
+  pthread_mutex_unlock(&transceiver->status_mutex);
+
+  return 0;
+}
+
 int ert_comm_transceiver_get_device_status(ert_comm_transceiver *transceiver, ert_comm_device_status *status)
 {
   pthread_mutex_lock(&transceiver->status_mutex);
@@ -1048,23 +1574,31 @@ int ert_comm_transceiver_stop(ert_comm_transceiver *transceiver)
   ert_comm_transceiver_signal_event(transceiver);
   pthread_join(transceiver->maintenance_thread, NULL);
 
-  ert_pipe_close(transceiver->transmit_buffer_queue);
-  ert_pipe_close(transceiver->transmit_wait_queue);
-  ert_pipe_close(transceiver->transmit_result_queue);
+  ert_comm_transceiver_transmit_queue_close(transceiver);
+  ert_queue_close(transceiver->transmit_result_queue);
   pthread_join(transceiver->transmit_dispatch_thread, NULL);
 
-  ert_pipe_close(transceiver->receive_buffer_queue);
+  ert_queue_close(transceiver->receive_buffer_queue);
   pthread_join(transceiver->receive_dispatch_thread, NULL);
 
-  ert_pipe_destroy(transceiver->transmit_buffer_queue);
-  ert_pipe_destroy(transceiver->transmit_wait_queue);
-  ert_pipe_destroy(transceiver->transmit_result_queue);
-  ert_pipe_destroy(transceiver->receive_buffer_queue);
+  ert_queue_destroy(transceiver->transmit_result_queue);
+  ert_queue_destroy(transceiver->receive_buffer_queue);
 
   ert_buffer_pool_destroy(transceiver->transmit_buffer_pool);
   ert_buffer_pool_destroy(transceiver->transmit_buffer_metadata_pool);
   ert_buffer_pool_destroy(transceiver->receive_buffer_pool);
 
+  for (int priority_class = 0; priority_class < ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT; priority_class++) {
+    free(transceiver->transmit_queues[priority_class].entries);
+  }
+  free(transceiver->transmit_batch_entries);
+
+  pthread_cond_destroy(&transceiver->transmit_completion_cond);
+  pthread_mutex_destroy(&transceiver->transmit_completion_mutex);
+
+  pthread_cond_destroy(&transceiver->transmit_queue_cond);
+  pthread_mutex_destroy(&transceiver->transmit_queue_mutex);
+
   pthread_cond_destroy(&transceiver->event_cond);
   pthread_mutex_destroy(&transceiver->event_mutex);
 
@@ -14,12 +14,36 @@
 #include "ert-common.h"
 #include "ert-comm.h"
 #include "ert-buffer-pool.h"
-#include "ert-pipe.h"
+#include "ert-queue.h"
 #include <pthread.h>
 #include <time.h>
 
 #define ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_BLOCK 0x01
 #define ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_SET_RECEIVE_ACTIVE 0x02
+#define ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_REALTIME 0x04
+#define ERT_COMM_TRANSCEIVER_TRANSMIT_FLAG_PRIORITY_BULK 0x08
+
+#define ERT_COMM_TRANSCEIVER_TRANSMIT_REALTIME_PRIORITY_WEIGHT_DEFAULT 0
+#define ERT_COMM_TRANSCEIVER_TRANSMIT_NORMAL_PRIORITY_WEIGHT_DEFAULT 4
+#define ERT_COMM_TRANSCEIVER_TRANSMIT_BULK_PRIORITY_WEIGHT_DEFAULT 1
+
+#define ERT_COMM_TRANSCEIVER_TRANSMIT_BATCH_PACKET_COUNT_DEFAULT 8
+
+#define ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_MAX_ATTEMPTS_DEFAULT 8
+#define ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_BACKOFF_MIN_MILLISECONDS_DEFAULT 50
+#define ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_BACKOFF_MAX_MILLISECONDS_DEFAULT 2000
+#define ERT_COMM_TRANSCEIVER_LISTEN_BEFORE_TALK_DETECTION_TIMEOUT_MILLISECONDS 100
+
+/**
+ * Transmitted packets are queued by priority class. Packets without a priority flag use the normal class.
+ */
+typedef enum _ert_comm_transceiver_priority_class {
+  ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME = 0,
+  ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL = 1,
+  ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK = 2,
+} ert_comm_transceiver_priority_class;
+
+#define ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT 3
 
 typedef enum _ert_comm_transceiver_event_type {
   ERT_COMM_TRANSCEIVER_EVENT_CONFIGURATION_CHANGED = 0x01,
@@ -32,6 +56,17 @@ typedef void (*ert_comm_transceiver_receive_callback)(uint32_t length, uint8_t *
 typedef void (*ert_comm_transceiver_event_callback)(ert_comm_transceiver_event_type type, int result,
     void *callback_context);
 
+typedef struct _ert_comm_transceiver_priority_class_status {
+  uint32_t queued_packet_count;
+  uint32_t max_queued_packet_count;
+
+  uint64_t transmitted_packet_count;
+
+  uint32_t last_wait_time_millis;
+  uint32_t max_wait_time_millis;
+  uint64_t total_wait_time_millis;
+} ert_comm_transceiver_priority_class_status;
+
 typedef struct _ert_comm_transceiver_status {
   uint64_t transmitted_packet_count;
   uint64_t received_packet_count;
@@ -44,7 +79,31 @@ typedef struct _ert_comm_transceiver_status {
   struct timespec last_received_packet_timestamp;
   struct timespec last_invalid_received_packet_timestamp;
 
+  // Link quality of the packet being passed to the receive callback, or of the latest one after it returns
+  float last_received_packet_rssi;
+  float last_received_packet_snr;
+
   struct timespec comm_device_receive_mode_started_timestamp;
+
+  ert_comm_transceiver_priority_class_status priority_classes[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT];
+
+  uint64_t transmit_batch_count;
+  uint64_t transmit_batch_packet_count;
+  uint32_t max_transmit_batch_packet_count;
+
+  // Time from the end of a transmission to the start of the next packet in the same batch
+  uint32_t last_transmit_gap_micros;
+  uint32_t max_transmit_gap_micros;
+  uint64_t total_transmit_gap_micros;
+  uint64_t transmit_gap_count;
+
+  // Listen-before-talk: a busy channel avoids a collision and causes a backoff, a channel access failure
+  // means the batch was transmitted anyway after the maximum number of attempts
+  uint64_t channel_activity_detection_count;
+  uint64_t channel_busy_count;
+  uint64_t channel_access_failure_count;
+  uint64_t backoff_count;
+  uint64_t total_backoff_millis;
 } ert_comm_transceiver_status;
 
 typedef struct _ert_comm_transceiver_config {
@@ -56,6 +115,22 @@ typedef struct _ert_comm_transceiver_config {
 
   uint32_t maximum_receive_time_milliseconds;
 
+  // Classes with weight 0 have strict priority in class order, other classes share airtime by weight
+  uint32_t transmit_priority_weights[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT];
+  // Maximum time a realtime class packet waits for an active receive mode to end, 0 waits until it ends
+  uint32_t transmit_realtime_maximum_wait_milliseconds;
+  // Maximum number of queued packets transmitted back to back per dispatch, 0 and 1 transmit one packet at a time
+  uint32_t transmit_batch_packet_count;
+
+  // Detect channel activity before each batch and back off for a random time while the channel is busy,
+  // ignored if the device does not support channel activity detection
+  bool listen_before_talk;
+  uint32_t listen_before_talk_max_attempts;
+  // The backoff time is drawn from [min, min * 2^attempt], limited to max. Configuration and frequency changes
+  // are applied during the backoff, the batch waits for all backoffs in the worst case (over 10 s by default).
+  uint32_t listen_before_talk_backoff_min_milliseconds;
+  uint32_t listen_before_talk_backoff_max_milliseconds;
+
   ert_comm_transceiver_transmit_callback transmit_callback;
   void *transmit_callback_context;
 
@@ -66,6 +141,15 @@ typedef struct _ert_comm_transceiver_config {
   void *event_callback_context;
 } ert_comm_transceiver_config;
 
+struct _ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry;
+
+typedef struct _ert_comm_transceiver_transmit_priority_queue {
+  struct _ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *entries;
+  uint32_t head;
+  uint32_t count;
+  int32_t current_weight;
+} ert_comm_transceiver_transmit_priority_queue;
+
 typedef struct _ert_comm_transceiver {
   ert_comm_transceiver_config config;
 
@@ -93,12 +177,31 @@ typedef struct _ert_comm_transceiver {
 
   ert_buffer_pool *transmit_buffer_metadata_pool;
   ert_buffer_pool *transmit_buffer_pool;
-  ert_pipe *transmit_buffer_queue;
-  ert_pipe *transmit_wait_queue;
-  ert_pipe *transmit_result_queue;
+  pthread_mutex_t transmit_queue_mutex;
+  pthread_cond_t transmit_queue_cond;
+  volatile bool transmit_queue_closed;
+  ert_comm_transceiver_transmit_priority_queue transmit_queues[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT];
+  ert_queue *transmit_result_queue;
+
+  // Shared by all blocking transmits, which wait for the completion state of their own packet
+  pthread_mutex_t transmit_completion_mutex;
+  pthread_cond_t transmit_completion_cond;
+  uint32_t transmit_completion_waiter_count;
+
+  // The packets of the batch being transmitted, protected by device_mutex. The device transmit callback
+  // starts the next packet of the batch and pushes the completed ones to transmit_result_queue.
+  struct _ert_comm_transceiver_packet_transmit_buffer_metadata_queue_entry *transmit_batch_entries;
+  uint32_t transmit_batch_length;
+  uint32_t transmit_batch_count;
+  uint32_t transmit_batch_started_count;
+  uint32_t transmit_batch_result_count;
+  bool transmit_batch_packet_on_air;
+  struct timespec transmit_batch_packet_done_timestamp;
+
+  unsigned int listen_before_talk_random_seed;
 
   ert_buffer_pool *receive_buffer_pool;
-  ert_pipe *receive_buffer_queue;
+  ert_queue *receive_buffer_queue;
 
   ert_comm_device_status device_status;
 
@@ -122,6 +225,8 @@ int ert_comm_transceiver_transmit(ert_comm_transceiver *transceiver,
     uint32_t id, uint32_t length, uint8_t *data, uint32_t flags, uint32_t *bytes_transmitted_rcv);
 int ert_comm_transceiver_set_frequency(ert_comm_transceiver *transceiver, ert_comm_device_config_type config_type, double frequency);
 int ert_comm_transceiver_get_status(ert_comm_transceiver *transceiver, ert_comm_transceiver_status *status);
+int ert_comm_transceiver_get_received_packet_link_quality(ert_comm_transceiver *transceiver,
+    float *rssi, float *snr);
 int ert_comm_transceiver_get_device_status(ert_comm_transceiver *transceiver, ert_comm_device_status *status);
 int ert_comm_transceiver_stop(ert_comm_transceiver *transceiver);
 
@@ -52,6 +52,7 @@ typedef struct _ert_comm_device_status {
   struct timespec last_invalid_received_packet_timestamp;
 
   float last_received_packet_rssi;
+  float last_received_packet_snr;
   float current_rssi;
 
   double frequency_error;
@@ -88,6 +89,8 @@ typedef struct _ert_comm_driver {
 
   int (*start_detection)(ert_comm_device *device);
   int (*wait_for_detection)(ert_comm_device *device, uint32_t milliseconds);
+  // Runs a single channel activity detection and waits for it to finish, NULL if not supported by the device
+  int (*detect_channel_activity)(ert_comm_device *device, uint32_t milliseconds, bool *activity_detected);
 
   int (*start_receive)(ert_comm_device *device, bool continuous);
   int (*wait_for_data)(ert_comm_device *device, uint32_t milliseconds);
@@ -132,6 +132,7 @@ static int serialize_comm_device_status(ert_comm_device_status *status, json_t *
   jansson_check_result(json_object_set_new(comm_device_obj, "manufacturer", serialize_string(status->manufacturer)));
   jansson_check_result(json_object_set_new(comm_device_obj, "current_rssi", serialize_json_real(status->current_rssi)));
   jansson_check_result(json_object_set_new(comm_device_obj, "last_received_packet_rssi", serialize_json_real(status->last_received_packet_rssi)));
+  jansson_check_result(json_object_set_new(comm_device_obj, "last_received_packet_snr", serialize_json_real(status->last_received_packet_snr)));
 
   jansson_check_result(json_object_set_new(comm_device_obj, "transmitted_packet_count", json_integer(status->transmitted_packet_count)));
   jansson_check_result(json_object_set_new(comm_device_obj, "transmitted_bytes", json_integer(status->transmitted_bytes)));
@@ -150,6 +151,64 @@ static int serialize_comm_device_status(ert_comm_device_status *status, json_t *
   return 0;
 }
 
+static int serialize_comm_transceiver_status(ert_comm_transceiver_status *status, json_t *priority_classes_array)
+{
+  static const char *priority_class_names[ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT] = {
+      [ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_REALTIME] = "realtime",
+      [ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_NORMAL] = "normal",
+      [ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_BULK] = "bulk",
+  };
+
+  for (int priority_class = 0; priority_class < ERT_COMM_TRANSCEIVER_PRIORITY_CLASS_COUNT; priority_class++) {
+    ert_comm_transceiver_priority_class_status *class_status = &status->priority_classes[priority_class];
+    struct json_t *priority_class_obj = json_object();
+
+    uint64_t average_wait_time_millis = (class_status->transmitted_packet_count > 0)
+        ? class_status->total_wait_time_millis / class_status->transmitted_packet_count : 0;
+
+    jansson_check_result(json_object_set_new(priority_class_obj, "priority_class", serialize_string(priority_class_names[priority_class])));
+    jansson_check_result(json_object_set_new(priority_class_obj, "queued_packet_count", json_integer(class_status->queued_packet_count)));
+    jansson_check_result(json_object_set_new(priority_class_obj, "max_queued_packet_count", json_integer(class_status->max_queued_packet_count)));
+    jansson_check_result(json_object_set_new(priority_class_obj, "transmitted_packet_count", json_integer(class_status->transmitted_packet_count)));
+    jansson_check_result(json_object_set_new(priority_class_obj, "last_wait_time_millis", json_integer(class_status->last_wait_time_millis)));
+    jansson_check_result(json_object_set_new(priority_class_obj, "max_wait_time_millis", json_integer(class_status->max_wait_time_millis)));
+    jansson_check_result(json_object_set_new(priority_class_obj, "average_wait_time_millis", json_integer(average_wait_time_millis)));
+
+    jansson_check_result(json_array_append_new(priority_classes_array, priority_class_obj));
+  }
+
+  return 0;
+}
+
+static int serialize_comm_transceiver_batch_status(ert_comm_transceiver_status *status, json_t *transmit_batch_obj)
+{
+  uint64_t average_packet_count = (status->transmit_batch_count > 0)
+      ? status->transmit_batch_packet_count / status->transmit_batch_count : 0;
+  uint64_t average_gap_micros = (status->transmit_gap_count > 0)
+      ? status->total_transmit_gap_micros / status->transmit_gap_count : 0;
+
+  jansson_check_result(json_object_set_new(transmit_batch_obj, "batch_count", json_integer(status->transmit_batch_count)));
+  jansson_check_result(json_object_set_new(transmit_batch_obj, "max_packet_count", json_integer(status->max_transmit_batch_packet_count)));
+  jansson_check_result(json_object_set_new(transmit_batch_obj, "average_packet_count", json_integer(average_packet_count)));
+  jansson_check_result(json_object_set_new(transmit_batch_obj, "last_gap_micros", json_integer(status->last_transmit_gap_micros)));
+  jansson_check_result(json_object_set_new(transmit_batch_obj, "max_gap_micros", json_integer(status->max_transmit_gap_micros)));
+  jansson_check_result(json_object_set_new(transmit_batch_obj, "average_gap_micros", json_integer(average_gap_micros)));
+
+  return 0;
+}
+
+static int serialize_comm_transceiver_channel_access_status(ert_comm_transceiver_status *status,
+    json_t *channel_access_obj)
+{
+  jansson_check_result(json_object_set_new(channel_access_obj, "detection_count", json_integer(status->channel_activity_detection_count)));
+  jansson_check_result(json_object_set_new(channel_access_obj, "busy_count", json_integer(status->channel_busy_count)));
+  jansson_check_result(json_object_set_new(channel_access_obj, "failure_count", json_integer(status->channel_access_failure_count)));
+  jansson_check_result(json_object_set_new(channel_access_obj, "backoff_count", json_integer(status->backoff_count)));
+  jansson_check_result(json_object_set_new(channel_access_obj, "total_backoff_millis", json_integer(status->total_backoff_millis)));
+
+  return 0;
+}
+
 static int serialize_comm_protocol_status(ert_comm_protocol_status *status, json_t *comm_protocol_obj)
 {
   jansson_check_result(json_object_set_new(comm_protocol_obj, "transmitted_packet_count", json_integer(status->transmitted_packet_count)));
@@ -174,6 +233,25 @@ static int serialize_comm_protocol_status(ert_comm_protocol_status *status, json
   jansson_check_result(json_object_set_new(comm_protocol_obj, "invalid_received_packet_count", json_integer(status->invalid_received_packet_count)));
   jansson_check_result(ert_jansson_serialize_timestamp_iso8601(comm_protocol_obj, "last_invalid_received_packet_timestamp", &status->last_invalid_received_packet_timestamp));
 
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "transmitted_fec_repair_packet_count", json_integer(status->transmitted_fec_repair_packet_count)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "received_fec_repair_packet_count", json_integer(status->received_fec_repair_packet_count)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "fec_recovered_packet_count", json_integer(status->fec_recovered_packet_count)));
+
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "compression_uncompressed_data_bytes", json_integer(status->compression_uncompressed_data_bytes)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "compression_compressed_data_bytes", json_integer(status->compression_compressed_data_bytes)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "compression_ratio", json_real(status->compression_ratio)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "compression_cpu_time_nanos", json_integer(status->compression_cpu_time_nanos)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "decompression_compressed_data_bytes", json_integer(status->decompression_compressed_data_bytes)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "decompression_uncompressed_data_bytes", json_integer(status->decompression_uncompressed_data_bytes)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "decompression_ratio", json_real(status->decompression_ratio)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "decompression_cpu_time_nanos", json_integer(status->decompression_cpu_time_nanos)));
+
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "acknowledgement_interval_packet_count", json_integer(status->acknowledgement_interval_packet_count)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "acknowledgement_receive_timeout_millis", json_integer(status->acknowledgement_receive_timeout_millis)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "round_trip_time_millis", json_integer(status->round_trip_time_millis)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "round_trip_time_deviation_millis", json_integer(status->round_trip_time_deviation_millis)));
+  jansson_check_result(json_object_set_new(comm_protocol_obj, "packet_loss_ratio", json_real(status->packet_loss_ratio)));
+
   return 0;
 }
 
@@ -192,6 +270,38 @@ static int serialize_comm_devices(ert_data_logger_entry *entry, json_t *comm_dev
         return result;
       }
 
+      if (entry->params->comm_transceiver_status_present) {
+        struct json_t *priority_classes_array = json_array();
+        ert_comm_transceiver_status *comm_transceiver_status = &entry->params->comm_transceiver_status[i];
+
+        result = serialize_comm_transceiver_status(comm_transceiver_status, priority_classes_array);
+        if (result < 0) {
+          ert_log_error("Error serializing comm transceiver status to JSON");
+          return result;
+        }
+
+        jansson_check_result(json_object_set_new(comm_device_obj, "transmit_priority_classes", priority_classes_array));
+
+        struct json_t *transmit_batch_obj = json_object();
+
+        result = serialize_comm_transceiver_batch_status(comm_transceiver_status, transmit_batch_obj);
+        if (result < 0) {
+          ert_log_error("Error serializing comm transceiver batch status to JSON");
+          return result;
+        }
+
+        jansson_check_result(json_object_set_new(comm_device_obj, "transmit_batch", transmit_batch_obj));
+
+        struct json_t *channel_access_obj = json_object();
+
+        result = serialize_comm_transceiver_channel_access_status(comm_transceiver_status, channel_access_obj);
+        if (result < 0) {
+          ert_log_error("Error serializing comm transceiver channel access status to JSON");
+          return result;
+        }
+
+        jansson_check_result(json_object_set_new(comm_device_obj, "channel_access", channel_access_obj));
+      }
 
       if (entry->params->comm_protocol_status_present) {
         struct json_t *comm_protocol_obj = json_object();
@@ -46,6 +46,7 @@ void ert_data_logger_log_comm_device_status(ert_log_logger *logger, ert_comm_dev
   ert_logl_info(logger, "  Device state: %d", status->device_state);
   ert_logl_info(logger, "  Frequency: %08.3f", status->frequency);
   ert_logl_info(logger, "  Last received packet RSSI: %07.2f dBm", status->last_received_packet_rssi);
+  ert_logl_info(logger, "  Last received packet SNR: %06.2f dB", status->last_received_packet_snr);
   ert_logl_info(logger, "  Current RSSI: %07.2f dBm", status->current_rssi);
 
   ert_logl_info(logger, "  TX packet count: %" PRIu64, status->transmitted_packet_count);
@@ -106,32 +106,59 @@ int ert_data_logger_init_entry_params(ert_data_logger *data_logger,
   return 0;
 }
 
-int ert_data_logger_collect_entry_params(ert_data_logger *data_logger,
+/**
+ * Collects the status of an additional comm device, such as the radio of another channel of a gateway.
+ * The status of the first comm device is collected by ert_data_logger_collect_entry_params().
+ */
+int ert_data_logger_collect_comm_entry_params(ert_data_logger *data_logger, uint8_t comm_device_index,
     ert_comm_transceiver *comm_transceiver,
     ert_comm_protocol *comm_protocol,
-    ert_driver_gsm_modem *gsm_modem,
     ert_data_logger_entry_params *params)
 {
   int result;
 
-  params->comm_device_status_present = false;
+  if (comm_device_index >= ERT_DATA_LOGGER_COMM_DEVICE_COUNT) {
+    return -EINVAL;
+  }
+
   if (comm_transceiver != NULL) {
-    result = ert_comm_transceiver_get_device_status(comm_transceiver, &params->comm_device_status[0]);
+    result = ert_comm_transceiver_get_device_status(comm_transceiver, &params->comm_device_status[comm_device_index]);
+    if (result < 0) {
+      return result;
+    }
+    result = ert_comm_transceiver_get_status(comm_transceiver, &params->comm_transceiver_status[comm_device_index]);
     if (result < 0) {
       return result;
     }
-    params->comm_device_status_present = true;
   }
 
-  params->comm_protocol_status_present = false;
   if (comm_protocol != NULL) {
-    result = ert_comm_protocol_get_status(comm_protocol, &params->comm_protocol_status[0]);
+    result = ert_comm_protocol_get_status(comm_protocol, &params->comm_protocol_status[comm_device_index]);
     if (result < 0) {
       return result;
     }
-    params->comm_protocol_status_present = true;
   }
 
+  return 0;
+}
+
+int ert_data_logger_collect_entry_params(ert_data_logger *data_logger,
+    ert_comm_transceiver *comm_transceiver,
+    ert_comm_protocol *comm_protocol,
+    ert_driver_gsm_modem *gsm_modem,
+    ert_data_logger_entry_params *params)
+{
+  int result;
+
+  result = ert_data_logger_collect_comm_entry_params(data_logger, 0, comm_transceiver, comm_protocol, params);
+  if (result < 0) {
+    return result;
+  }
+
+  params->comm_device_status_present = (comm_transceiver != NULL);
+  params->comm_transceiver_status_present = (comm_transceiver != NULL);
+  params->comm_protocol_status_present = (comm_protocol != NULL);
+
   result = ert_sensor_registry_read_module_all(params->sensor_module_data_count, params->sensor_module_data);
   if (result < 0) {
     return result;
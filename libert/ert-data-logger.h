@@ -60,6 +60,8 @@ typedef struct _ert_data_logger_entry_params {
   uint8_t comm_device_status_count;
   bool comm_device_status_present;
   ert_comm_device_status comm_device_status[ERT_DATA_LOGGER_COMM_DEVICE_COUNT];
+  bool comm_transceiver_status_present;
+  ert_comm_transceiver_status comm_transceiver_status[ERT_DATA_LOGGER_COMM_DEVICE_COUNT];
   bool comm_protocol_status_present;
   ert_comm_protocol_status comm_protocol_status[ERT_DATA_LOGGER_COMM_DEVICE_COUNT];
 
@@ -113,6 +115,10 @@ int ert_data_logger_collect_entry_params(ert_data_logger *data_logger,
     ert_comm_protocol *comm_protocol,
     ert_driver_gsm_modem *gsm_modem,
     ert_data_logger_entry_params *params);
+int ert_data_logger_collect_comm_entry_params(ert_data_logger *data_logger, uint8_t comm_device_index,
+    ert_comm_transceiver *comm_transceiver,
+    ert_comm_protocol *comm_protocol,
+    ert_data_logger_entry_params *params);
 #ifdef ERTLIB_SUPPORT_GPSD
 int ert_data_logger_collect_entry_params_with_gps(ert_data_logger *data_logger,
     ert_comm_transceiver *comm_transceiver,
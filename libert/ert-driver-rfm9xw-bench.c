@@ -0,0 +1,237 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+ * Benchmark for the RFM9xW driver running against the emulated SX127x chip: measures SPI messages per transmitted
+ * and received packet, transmit turnaround time and the latency from raising DIO0 to the driver receive callback and
+ * to the thread waiting for data. Usage: ert_driver_rfm9xw_bench [packet count] [SPI message delay in microseconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "ert-hal-spi.h"
+#include "ert-hal-gpio.h"
+#include "ert-hal-sx127x-mock.h"
+#include "ert-driver-rfm9xw.h"
+#include "ert-time.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define BENCH_PACKET_COUNT_DEFAULT 1000
+#define BENCH_PAYLOAD_LENGTH 200
+#define BENCH_TIMEOUT_MILLIS 1000
+
+static struct timespec receive_callback_timestamp;
+
+static void ert_driver_rfm9xw_bench_receive_callback(void *callback_context)
+{
+  clock_gettime(CLOCK_REALTIME, &receive_callback_timestamp);
+}
+
+static void ert_driver_rfm9xw_bench_create_radio_config(ert_driver_rfm9xw_radio_config *radio_config)
+{
+  memset(radio_config, 0, sizeof(ert_driver_rfm9xw_radio_config));
+
+  radio_config->pa_boost = true;
+  radio_config->pa_max_power = PA_CONFIG_MAX_POWER_MAX;
+  radio_config->pa_output_power = PA_CONFIG_OUTPUT_POWER_MAX;
+  radio_config->frequency = 434.25;
+  radio_config->error_coding_rate = ERROR_CODING_4_5;
+  radio_config->bandwidth = BANDWIDTH_125K;
+  radio_config->spreading_factor = SPREADING_7;
+  radio_config->crc = true;
+  radio_config->preamble_length = 8;
+}
+
+static void ert_driver_rfm9xw_bench_print_spi(const char *operation, hal_sx127x_mock_status *status,
+    uint32_t packet_count, double elapsed_micros)
+{
+  printf("operation=%s packets=%" PRIu32 " spi_messages_per_packet=%.2f spi_segments_per_packet=%.2f "
+      "spi_bytes_per_packet=%.1f dio0_interrupts=%" PRIu64 " us_per_packet=%.1f\n",
+      operation, packet_count,
+      (double) status->spi_message_count / packet_count, (double) status->spi_segment_count / packet_count,
+      (double) status->spi_byte_count / packet_count, status->dio0_interrupt_count, elapsed_micros / packet_count);
+}
+
+static int ert_driver_rfm9xw_bench_transmit(ert_comm_device *device, uint32_t packet_count)
+{
+  hal_sx127x_mock_status status;
+  uint8_t payload[BENCH_PAYLOAD_LENGTH] = {0};
+  struct timespec start_time, end_time;
+  uint32_t bytes_transmitted;
+  int result;
+
+  // Switch the radio to the transmit configuration outside the measurement
+  result = device->driver->transmit(device, sizeof(payload), payload, &bytes_transmitted);
+  if (result < 0) {
+    return result;
+  }
+  device->driver->wait_for_transmit(device, BENCH_TIMEOUT_MILLIS);
+
+  hal_sx127x_mock_reset_status();
+  clock_gettime(CLOCK_REALTIME, &start_time);
+
+  for (uint32_t i = 0; i < packet_count; i++) {
+    payload[0] = (uint8_t) i;
+
+    result = device->driver->transmit(device, sizeof(payload), payload, &bytes_transmitted);
+    if (result < 0) {
+      ert_log_error("Error transmitting packet, result %d", result);
+      return result;
+    }
+    result = device->driver->wait_for_transmit(device, BENCH_TIMEOUT_MILLIS);
+    if (result < 0) {
+      ert_log_error("Error waiting for transmit, result %d", result);
+      return result;
+    }
+  }
+
+  clock_gettime(CLOCK_REALTIME, &end_time);
+  hal_sx127x_mock_get_status(&status);
+
+  ert_driver_rfm9xw_bench_print_spi("transmit", &status, packet_count,
+      (double) ert_timespec_diff_microseconds(&start_time, &end_time));
+
+  return 0;
+}
+
+static int ert_driver_rfm9xw_bench_receive(ert_comm_device *device, uint32_t packet_count)
+{
+  hal_sx127x_mock_status status;
+  uint8_t payload[BENCH_PAYLOAD_LENGTH] = {0};
+  uint8_t buffer[RFM9XW_LORA_PACKET_LENGTH_MAX];
+  struct timespec start_time, end_time, wakeup_time;
+  uint32_t bytes_received;
+  int64_t callback_latency_sum = 0, callback_latency_max = 0;
+  int64_t wakeup_latency_sum = 0, wakeup_latency_max = 0;
+  int result;
+
+  result = device->driver->start_receive(device, true);
+  if (result < 0) {
+    return result;
+  }
+
+  hal_sx127x_mock_reset_status();
+  clock_gettime(CLOCK_REALTIME, &start_time);
+
+  for (uint32_t i = 0; i < packet_count; i++) {
+    payload[0] = (uint8_t) i;
+
+    result = hal_sx127x_mock_receive_packet(sizeof(payload), payload, -80.0f, 5.0f, false);
+    if (result < 0) {
+      ert_log_error("Error injecting received packet, result %d", result);
+      return result;
+    }
+    result = device->driver->wait_for_data(device, BENCH_TIMEOUT_MILLIS);
+    if (result < 0) {
+      ert_log_error("Error waiting for data, result %d", result);
+      return result;
+    }
+    clock_gettime(CLOCK_REALTIME, &wakeup_time);
+
+    result = device->driver->receive(device, sizeof(buffer), buffer, &bytes_received);
+    if (result < 0) {
+      ert_log_error("Error receiving packet, result %d", result);
+      return result;
+    }
+
+    hal_sx127x_mock_get_status(&status);
+
+    int64_t callback_latency = ert_timespec_diff_microseconds(&status.last_dio0_interrupt_timestamp,
+        &receive_callback_timestamp);
+    int64_t wakeup_latency = ert_timespec_diff_microseconds(&status.last_dio0_interrupt_timestamp, &wakeup_time);
+
+    callback_latency_sum += callback_latency;
+    wakeup_latency_sum += wakeup_latency;
+    if (callback_latency > callback_latency_max) {
+      callback_latency_max = callback_latency;
+    }
+    if (wakeup_latency > wakeup_latency_max) {
+      wakeup_latency_max = wakeup_latency;
+    }
+  }
+
+  clock_gettime(CLOCK_REALTIME, &end_time);
+  hal_sx127x_mock_get_status(&status);
+
+  ert_driver_rfm9xw_bench_print_spi("receive", &status, packet_count,
+      (double) ert_timespec_diff_microseconds(&start_time, &end_time));
+
+  printf("operation=receive_latency dio0_to_callback_us_mean=%.1f dio0_to_callback_us_max=%" PRId64
+      " dio0_to_wakeup_us_mean=%.1f dio0_to_wakeup_us_max=%" PRId64 "\n",
+      (double) callback_latency_sum / packet_count, callback_latency_max,
+      (double) wakeup_latency_sum / packet_count, wakeup_latency_max);
+  fflush(stdout);
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  hal_sx127x_mock_config mock_config;
+  ert_driver_rfm9xw_static_config static_config = {0};
+  ert_driver_rfm9xw_config config;
+  ert_comm_device *device;
+  uint32_t packet_count = BENCH_PACKET_COUNT_DEFAULT;
+  int result;
+
+  hal_sx127x_mock_create_default_config(&mock_config);
+  mock_config.time_scale = 0;
+  mock_config.mode_change_delay_micros = 0;
+
+  if (argc > 1) {
+    packet_count = (uint32_t) strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    mock_config.spi_message_delay_micros = (uint32_t) strtoul(argv[2], NULL, 10);
+  }
+
+  ert_test_init();
+
+  result = hal_sx127x_mock_init(&mock_config);
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  hal_spi_set_driver(&hal_spi_driver_sx127x_mock);
+  hal_gpio_set_driver(&hal_gpio_driver_sx127x_mock);
+
+  static_config.spi_clock_speed = 10000000;
+  static_config.pin_dio0 = (uint8_t) mock_config.pin_dio0;
+  static_config.pin_dio5 = (uint8_t) mock_config.pin_dio5;
+  static_config.receive_callback = ert_driver_rfm9xw_bench_receive_callback;
+
+  ert_driver_rfm9xw_bench_create_radio_config(&config.transmit_config);
+  ert_driver_rfm9xw_bench_create_radio_config(&config.receive_config);
+
+  result = rfm9xw_open(&static_config, &config, &device);
+  if (result < 0) {
+    ert_log_error("Error opening RFM9xW device, result %d", result);
+    goto error_mock;
+  }
+
+  result = ert_driver_rfm9xw_bench_transmit(device, packet_count);
+  if (result == 0) {
+    result = ert_driver_rfm9xw_bench_receive(device, packet_count);
+  }
+
+  rfm9xw_close(device);
+
+  error_mock:
+  hal_sx127x_mock_uninit();
+
+  ert_test_uninit();
+
+  return (result < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -188,8 +188,7 @@ ert_mapper_entry *ert_driver_rfm9xw_radio_config_create_mappings(ert_driver_rfm9
   return ert_mapper_allocate(rfm9xw_radio_config_children);
 }
 
-ert_mapper_entry *ert_driver_rfm9xw_create_mappings(ert_driver_rfm9xw_static_config *static_config,
-    ert_driver_rfm9xw_config *config)
+static ert_mapper_entry *ert_driver_rfm9xw_spi_create_mappings(ert_driver_rfm9xw_static_config *static_config)
 {
   ert_mapper_entry rfm9xw_spi_children[] = {
       {
@@ -212,6 +211,11 @@ ert_mapper_entry *ert_driver_rfm9xw_create_mappings(ert_driver_rfm9xw_static_con
       },
   };
 
+  return ert_mapper_allocate(rfm9xw_spi_children);
+}
+
+static ert_mapper_entry *ert_driver_rfm9xw_pins_create_mappings(ert_driver_rfm9xw_static_config *static_config)
+{
   ert_mapper_entry rfm9xw_pins_children[] = {
       {
           .name = "dio0",
@@ -228,6 +232,45 @@ ert_mapper_entry *ert_driver_rfm9xw_create_mappings(ert_driver_rfm9xw_static_con
       },
   };
 
+  return ert_mapper_allocate(rfm9xw_pins_children);
+}
+
+/**
+ * Maps only the static config, for additional radios that share the radio config of another one.
+ */
+ert_mapper_entry *ert_driver_rfm9xw_static_config_create_mappings(ert_driver_rfm9xw_static_config *static_config)
+{
+  ert_mapper_entry rfm9xw_children[] = {
+      {
+          .name = "spi",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = ert_driver_rfm9xw_spi_create_mappings(static_config),
+          .children_allocated = true,
+      },
+      {
+          .name = "pins",
+          .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
+          .children = ert_driver_rfm9xw_pins_create_mappings(static_config),
+          .children_allocated = true,
+      },
+      {
+          .name = "receive_single_after_detection",
+          .type = ERT_MAPPER_ENTRY_TYPE_BOOLEAN,
+          .value = &static_config->receive_single_after_detection,
+      },
+      {
+          .type = ERT_MAPPER_ENTRY_TYPE_NONE,
+      },
+  };
+
+  return ert_mapper_allocate(rfm9xw_children);
+}
+
+ert_mapper_entry *ert_driver_rfm9xw_create_mappings(ert_driver_rfm9xw_static_config *static_config,
+    ert_driver_rfm9xw_config *config)
+{
+  ert_mapper_entry *rfm9xw_spi_children = ert_driver_rfm9xw_spi_create_mappings(static_config);
+  ert_mapper_entry *rfm9xw_pins_children = ert_driver_rfm9xw_pins_create_mappings(static_config);
   ert_mapper_entry *rfm9xw_transmit_children =
       ert_driver_rfm9xw_radio_config_create_mappings(&config->transmit_config);
   ert_mapper_entry *rfm9xw_receive_children =
@@ -238,11 +281,13 @@ ert_mapper_entry *ert_driver_rfm9xw_create_mappings(ert_driver_rfm9xw_static_con
           .name = "spi",
           .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
           .children = rfm9xw_spi_children,
+          .children_allocated = true,
       },
       {
           .name = "pins",
           .type = ERT_MAPPER_ENTRY_TYPE_MAPPING,
           .children = rfm9xw_pins_children,
+          .children_allocated = true,
       },
       {
           .name = "receive_single_after_detection",
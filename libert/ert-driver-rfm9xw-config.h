@@ -16,5 +16,6 @@
 
 ert_mapper_entry *ert_driver_rfm9xw_create_mappings(ert_driver_rfm9xw_static_config *static_config,
     ert_driver_rfm9xw_config *config);
+ert_mapper_entry *ert_driver_rfm9xw_static_config_create_mappings(ert_driver_rfm9xw_static_config *static_config);
 
 #endif
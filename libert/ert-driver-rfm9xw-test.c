@@ -0,0 +1,261 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "ert-hal-spi.h"
+#include "ert-hal-gpio.h"
+#include "ert-hal-sx127x-mock.h"
+#include "ert-driver-rfm9xw.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define RFM9XW_TEST_TIMEOUT_MILLIS 1000
+#define RFM9XW_TEST_TIME_SCALE 0.01
+
+// Upper bound for SPI messages per packet including the interrupt handlers, one per register access would need over 20
+#define RFM9XW_TEST_TRANSMIT_SPI_MESSAGE_COUNT_MAX 12
+#define RFM9XW_TEST_RECEIVE_SPI_MESSAGE_COUNT_MAX 6
+
+typedef struct _rfm9xw_test_transmit_context {
+  uint32_t length;
+  uint8_t payload[RFM9XW_LORA_PACKET_LENGTH_MAX];
+} rfm9xw_test_transmit_context;
+
+static void rfm9xw_test_transmit_callback(void *callback_context, uint32_t length, uint8_t *payload)
+{
+  rfm9xw_test_transmit_context *context = (rfm9xw_test_transmit_context *) callback_context;
+
+  context->length = length;
+  memcpy(context->payload, payload, length);
+}
+
+static void rfm9xw_test_create_radio_config(ert_driver_rfm9xw_radio_config *radio_config)
+{
+  memset(radio_config, 0, sizeof(ert_driver_rfm9xw_radio_config));
+
+  radio_config->pa_boost = true;
+  radio_config->pa_max_power = PA_CONFIG_MAX_POWER_MAX;
+  radio_config->pa_output_power = PA_CONFIG_OUTPUT_POWER_MAX;
+  radio_config->frequency = 434.25;
+  radio_config->error_coding_rate = ERROR_CODING_4_5;
+  radio_config->bandwidth = BANDWIDTH_125K;
+  radio_config->spreading_factor = SPREADING_7;
+  radio_config->crc = true;
+  radio_config->preamble_length = 8;
+}
+
+static ert_comm_device *rfm9xw_test_open(rfm9xw_test_transmit_context *transmit_context)
+{
+  hal_sx127x_mock_config mock_config;
+  ert_driver_rfm9xw_static_config static_config = {0};
+  ert_driver_rfm9xw_config config;
+  ert_comm_device *device;
+  int result;
+
+  hal_sx127x_mock_create_default_config(&mock_config);
+  mock_config.time_scale = RFM9XW_TEST_TIME_SCALE;
+  mock_config.transmit_callback = rfm9xw_test_transmit_callback;
+  mock_config.callback_context = transmit_context;
+
+  result = hal_sx127x_mock_init(&mock_config);
+  assert(result == 0);
+
+  hal_spi_set_driver(&hal_spi_driver_sx127x_mock);
+  hal_gpio_set_driver(&hal_gpio_driver_sx127x_mock);
+
+  static_config.spi_clock_speed = 10000000;
+  static_config.pin_dio0 = (uint8_t) mock_config.pin_dio0;
+  static_config.pin_dio5 = (uint8_t) mock_config.pin_dio5;
+
+  rfm9xw_test_create_radio_config(&config.transmit_config);
+  rfm9xw_test_create_radio_config(&config.receive_config);
+
+  result = rfm9xw_open(&static_config, &config, &device);
+  assert(result == 0);
+  assert(((ert_driver_rfm9xw *) device->priv)->status.chip_version == 0x12);
+
+  return device;
+}
+
+static void rfm9xw_test_close(ert_comm_device *device)
+{
+  int result = rfm9xw_close(device);
+  assert(result == 0);
+
+  hal_sx127x_mock_uninit();
+}
+
+void rfm9xw_test_run_test_transmit(ert_comm_device *device, rfm9xw_test_transmit_context *transmit_context)
+{
+  hal_sx127x_mock_status status;
+  uint8_t payload[RFM9XW_LORA_PACKET_LENGTH_MAX];
+  uint32_t bytes_transmitted;
+  int result;
+
+  for (uint32_t packet = 0; packet < 3; packet++) {
+    for (size_t i = 0; i < sizeof(payload); i++) {
+      payload[i] = (uint8_t) (i * 7 + packet);
+    }
+
+    hal_sx127x_mock_reset_status();
+    memset(transmit_context, 0, sizeof(rfm9xw_test_transmit_context));
+
+    result = device->driver->transmit(device, sizeof(payload), payload, &bytes_transmitted);
+    assert(result == 0);
+    assert(bytes_transmitted == sizeof(payload));
+
+    result = device->driver->wait_for_transmit(device, RFM9XW_TEST_TIMEOUT_MILLIS);
+    assert(result == 0);
+
+    assert(transmit_context->length == sizeof(payload));
+    assert(memcmp(transmit_context->payload, payload, sizeof(payload)) == 0);
+    assert(device->status.device_state == ERT_COMM_DEVICE_STATE_STANDBY);
+
+    hal_sx127x_mock_get_status(&status);
+    assert(status.transmitted_packet_count == 1);
+    assert(status.dio0_interrupt_count == 1);
+
+    // The first transmission switches the radio configuration from receive to transmit
+    if (packet > 0) {
+      assert(status.spi_message_count <= RFM9XW_TEST_TRANSMIT_SPI_MESSAGE_COUNT_MAX);
+    }
+  }
+}
+
+void rfm9xw_test_run_test_receive(ert_comm_device *device)
+{
+  hal_sx127x_mock_status status;
+  uint8_t payload[100];
+  uint8_t buffer[RFM9XW_LORA_PACKET_LENGTH_MAX];
+  uint32_t bytes_received = 0;
+  int result;
+
+  for (size_t i = 0; i < sizeof(payload); i++) {
+    payload[i] = (uint8_t) (i * 3 + 5);
+  }
+
+  // Packets are lost while the radio is not receiving
+  result = device->driver->standby(device);
+  assert(result == 0);
+  result = hal_sx127x_mock_receive_packet(sizeof(payload), payload, -80.0f, 5.0f, false);
+  assert(result == -EAGAIN);
+
+  result = device->driver->start_receive(device, true);
+  assert(result == 0);
+  assert(device->status.device_state == ERT_COMM_DEVICE_STATE_RECEIVE_CONTINUOUS);
+
+  for (uint32_t packet = 0; packet < 3; packet++) {
+    payload[0] = (uint8_t) packet;
+
+    hal_sx127x_mock_reset_status();
+
+    result = hal_sx127x_mock_receive_packet(sizeof(payload), payload, -80.0f, 5.0f, false);
+    assert(result == 0);
+
+    result = device->driver->wait_for_data(device, RFM9XW_TEST_TIMEOUT_MILLIS);
+    assert(result == 0);
+
+    result = device->driver->receive(device, sizeof(buffer), buffer, &bytes_received);
+    assert(result == 0);
+    assert(bytes_received == sizeof(payload));
+    assert(memcmp(buffer, payload, sizeof(payload)) == 0);
+    assert(device->status.last_received_packet_rssi == -80.0f);
+    assert(device->status.last_received_packet_snr == 5.0f);
+    assert(hal_sx127x_mock_read_register(0x12) == 0);
+
+    hal_sx127x_mock_get_status(&status);
+    assert(status.received_packet_count == 1);
+    assert(status.dio0_interrupt_count == 1);
+    assert(status.spi_message_count <= RFM9XW_TEST_RECEIVE_SPI_MESSAGE_COUNT_MAX);
+  }
+
+  // Packets with CRC errors are reported but not read
+  result = hal_sx127x_mock_receive_packet(sizeof(payload), payload, -80.0f, 5.0f, true);
+  assert(result == 0);
+  result = device->driver->wait_for_data(device, RFM9XW_TEST_TIMEOUT_MILLIS);
+  assert(result == 0);
+  result = device->driver->receive(device, sizeof(buffer), buffer, &bytes_received);
+  assert(result == -EBADMSG);
+  assert(device->status.invalid_received_packet_count == 1);
+}
+
+void rfm9xw_test_run_test_detection(ert_comm_device *device)
+{
+  int result;
+
+  hal_sx127x_mock_set_channel_active(true);
+  result = device->driver->start_detection(device);
+  assert(result == 0);
+  result = device->driver->wait_for_detection(device, RFM9XW_TEST_TIMEOUT_MILLIS);
+  assert(result == 0);
+  assert(device->status.device_state == ERT_COMM_DEVICE_STATE_STANDBY);
+
+  hal_sx127x_mock_set_channel_active(false);
+  result = device->driver->start_detection(device);
+  assert(result == 0);
+  result = device->driver->wait_for_detection(device, RFM9XW_TEST_TIMEOUT_MILLIS);
+  assert(result == -ETIMEDOUT);
+  assert(device->status.device_state == ERT_COMM_DEVICE_STATE_STANDBY);
+}
+
+void rfm9xw_test_run_test_detect_channel_activity(ert_comm_device *device)
+{
+  bool activity_detected = true;
+  int result;
+
+  result = device->driver->detect_channel_activity(device, RFM9XW_TEST_TIMEOUT_MILLIS, &activity_detected);
+  assert(result == 0);
+  assert(!activity_detected);
+  assert(device->status.device_state == ERT_COMM_DEVICE_STATE_STANDBY);
+
+  hal_sx127x_mock_set_channel_active(true);
+  result = device->driver->detect_channel_activity(device, RFM9XW_TEST_TIMEOUT_MILLIS, &activity_detected);
+  assert(result == 0);
+  assert(activity_detected);
+
+  hal_sx127x_mock_set_channel_active(false);
+}
+
+int main(void)
+{
+  rfm9xw_test_transmit_context transmit_context;
+
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_comm_device *device = rfm9xw_test_open(&transmit_context);
+
+  rfm9xw_test_run_test_transmit(device, &transmit_context);
+
+  rfm9xw_test_run_test_receive(device);
+
+  // Every detection must be handled in detection mode without warnings about unexpected interrupts
+  uint32_t warning_count = ert_log_get_message_count(ERT_LOG_LEVEL_WARN);
+
+  rfm9xw_test_run_test_detection(device);
+
+  rfm9xw_test_run_test_detect_channel_activity(device);
+
+  assert(ert_log_get_message_count(ERT_LOG_LEVEL_WARN) == warning_count);
+
+  rfm9xw_test_close(device);
+
+  ert_log_info("Tests finished successfully");
+
+  ert_test_uninit();
+
+  return EXIT_SUCCESS;
+}
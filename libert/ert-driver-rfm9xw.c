@@ -178,6 +178,24 @@ typedef enum _rfm9xw_counter_type {
   RFM9XW_COUNTER_TYPE_RECEIVE_INVALID,
 } rfm9xw_counter_type;
 
+#define RFM9XW_SPI_MESSAGE_SEGMENT_COUNT_MAX 16
+
+/**
+ * Sequence of register and FIFO accesses transferred as a single SPI message,
+ * so that configuring the radio for a packet takes one system call instead of one per register.
+ */
+typedef struct _rfm9xw_spi_message {
+  uint32_t segment_count;
+  hal_spi_segment segments[RFM9XW_SPI_MESSAGE_SEGMENT_COUNT_MAX];
+  uint8_t commands[RFM9XW_SPI_MESSAGE_SEGMENT_COUNT_MAX][2];
+
+  uint32_t read_count;
+  struct {
+    uint8_t *command;
+    uint8_t *value;
+  } read_values[RFM9XW_SPI_MESSAGE_SEGMENT_COUNT_MAX];
+} rfm9xw_spi_message;
+
 ert_comm_driver ert_comm_driver_rfm9xw;
 
 typedef bool (*cond_func)(ert_comm_device *);
@@ -291,6 +309,112 @@ static int rfm9xw_read_reg(ert_comm_device *device, uint8_t reg, uint8_t *value)
   return result;
 }
 
+/**
+ * Appends a register write to the SPI message. Each register access is framed by its own chip select cycle.
+ */
+static void rfm9xw_message_write_reg(rfm9xw_spi_message *message, uint8_t reg, uint8_t value)
+{
+  uint32_t index = message->segment_count++;
+  uint8_t *command = message->commands[index];
+
+  command[0] = reg | REG_FLAG_WRITE;
+  command[1] = value;
+
+  message->segments[index] = (hal_spi_segment) {
+      .length = 2,
+      .tx_data = command,
+      .rx_data = NULL,
+      .cs_change = true,
+  };
+}
+
+/**
+ * Appends a register read to the SPI message. The value is stored once the message has been transferred.
+ */
+static void rfm9xw_message_read_reg(rfm9xw_spi_message *message, uint8_t reg, uint8_t *value)
+{
+  uint32_t index = message->segment_count++;
+  uint8_t *command = message->commands[index];
+
+  command[0] = reg & 0x7F;
+  command[1] = 0;
+
+  message->segments[index] = (hal_spi_segment) {
+      .length = 2,
+      .tx_data = command,
+      .rx_data = command,
+      .cs_change = true,
+  };
+  message->read_values[message->read_count].command = command;
+  message->read_values[message->read_count].value = value;
+  message->read_count++;
+}
+
+/**
+ * Appends a FIFO burst write to the SPI message. The payload is transmitted directly from the caller's buffer.
+ */
+static void rfm9xw_message_write_fifo(rfm9xw_spi_message *message, uint8_t length, uint8_t *payload)
+{
+  uint32_t index = message->segment_count++;
+  uint8_t *command = message->commands[index];
+
+  command[0] = REG_FIFO | REG_FLAG_WRITE;
+
+  message->segments[index] = (hal_spi_segment) {
+      .length = 1,
+      .tx_data = command,
+      .rx_data = NULL,
+      .cs_change = false,
+  };
+  message->segments[message->segment_count++] = (hal_spi_segment) {
+      .length = length,
+      .tx_data = payload,
+      .rx_data = NULL,
+      .cs_change = true,
+  };
+}
+
+/**
+ * Appends a FIFO burst read to the SPI message. The data is received directly to the caller's buffer.
+ */
+static void rfm9xw_message_read_fifo(rfm9xw_spi_message *message, uint8_t length, uint8_t *buffer)
+{
+  uint32_t index = message->segment_count++;
+  uint8_t *command = message->commands[index];
+
+  command[0] = REG_FIFO;
+
+  message->segments[index] = (hal_spi_segment) {
+      .length = 1,
+      .tx_data = command,
+      .rx_data = NULL,
+      .cs_change = false,
+  };
+  message->segments[message->segment_count++] = (hal_spi_segment) {
+      .length = length,
+      .tx_data = NULL,
+      .rx_data = buffer,
+      .cs_change = true,
+  };
+}
+
+static int rfm9xw_message_transfer(ert_comm_device *device, rfm9xw_spi_message *message)
+{
+  ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
+
+  int result = hal_spi_transfer_segments(driver->spi_device, message->segment_count, message->segments);
+  if (result < 0) {
+    ert_log_error("Error transferring RFM9xW SPI message with %d segments", message->segment_count);
+    return result;
+  }
+
+  for (uint32_t i = 0; i < message->read_count; i++) {
+    *message->read_values[i].value = message->read_values[i].command[1];
+  }
+
+  return result;
+}
+
 static bool rfm9xw_is_mode_change_signal_active(ert_comm_device *device)
 {
   ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
@@ -369,7 +493,7 @@ static int rfm9xw_update_driver_state(ert_comm_device *device, uint8_t mode)
       new_driver_state = RFM9XW_DRIVER_STATE_TRANSMIT;
       break;
     case MODE_LORA_CAD:
-      new_driver_state = RFM9XW_DRIVER_STATE_STANDBY;
+      new_driver_state = RFM9XW_DRIVER_STATE_DETECTION;
       break;
     case MODE_LORA_RX_SINGLE:
       new_driver_state = RFM9XW_DRIVER_STATE_RECEIVE_SINGLE;
@@ -787,6 +911,40 @@ static int rfm9xw_update_config_for_transmit(ert_comm_device *device)
   return rfm9xw_set_mode(device, MODE_LORA_STANDBY);
 }
 
+static const uint32_t rfm9xw_bandwidths_hz[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
+int rfm9xw_set_radio_config_data_rate(ert_driver_rfm9xw_radio_config *radio_config,
+    uint8_t spreading_factor, uint32_t bandwidth_hz, uint8_t coding_rate)
+{
+  uint8_t bandwidth = 0xFF;
+
+  for (uint8_t i = 0; i < sizeof(rfm9xw_bandwidths_hz) / sizeof(uint32_t); i++) {
+    if (rfm9xw_bandwidths_hz[i] == bandwidth_hz) {
+      bandwidth = i;
+      break;
+    }
+  }
+
+  if (bandwidth == 0xFF || spreading_factor < SPREADING_6 || spreading_factor > SPREADING_12
+      || coding_rate < ERROR_CODING_4_5 || coding_rate > ERROR_CODING_4_8) {
+    ert_log_error("Invalid RFM9xW data rate: spreading_factor=%d bandwidth_hz=%d coding_rate=%d",
+        spreading_factor, bandwidth_hz, coding_rate);
+    return -EINVAL;
+  }
+
+  radio_config->spreading_factor = spreading_factor;
+  radio_config->bandwidth = bandwidth;
+  radio_config->error_coding_rate = coding_rate;
+
+  // Low data rate optimization is mandated when symbol time exceeds 16 ms
+  uint32_t symbol_time_micros = (uint32_t) (((uint64_t) 1000000 << spreading_factor) / bandwidth_hz);
+  radio_config->low_data_rate_optimize = symbol_time_micros > 16000;
+
+  return 0;
+}
+
 int rfm9xw_configure(ert_comm_device *device, ert_driver_rfm9xw_config *config)
 {
   ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
@@ -834,12 +992,13 @@ static void rfm9xw_interrupt_dio0(void *arg)
   // NOTE: driver_state may be incorrect because of spurious interrupts or other mode changes -> check IRQ flags
   bool irq_tx_done = (irq_flags & IRQ_FLAG_TX_DONE) != 0;
   bool irq_rx_done = (irq_flags & IRQ_FLAG_RX_DONE) != 0;
+  bool irq_cad_done = (irq_flags & IRQ_FLAG_CAD_DONE) != 0;
   bool irq_cad_detected = (irq_flags & IRQ_FLAG_CAD_DETECTED) != 0;
 
   bool handled = false;
 
-  ert_log_debug("dio0 interrupt: before: driver_state=0x%02X irq_flags=%02X tx_done=%d rx_done=%d cad_detected=%d",
-      driver->driver_state, irq_flags, irq_tx_done, irq_rx_done, irq_cad_detected);
+  ert_log_trace("dio0 interrupt: before: driver_state=0x%02X irq_flags=%02X tx_done=%d rx_done=%d cad_done=%d "
+      "cad_detected=%d", driver->driver_state, irq_flags, irq_tx_done, irq_rx_done, irq_cad_done, irq_cad_detected);
 
   if (irq_tx_done) {
     rfm9xw_write_reg(device, REG_LORA_IRQ_FLAGS, IRQ_FLAG_TX_DONE);
@@ -881,23 +1040,29 @@ static void rfm9xw_interrupt_dio0(void *arg)
     handled = true;
   }
 
-  if (irq_cad_detected) {
+  // CadDone is mapped to DIO0 and is set with or without CadDetected
+  if (irq_cad_done || irq_cad_detected) {
     rfm9xw_write_reg(device, REG_LORA_IRQ_FLAGS, IRQ_FLAG_CAD_DONE | IRQ_FLAG_CAD_DETECTED);
 
     if (driver->driver_state != RFM9XW_DRIVER_STATE_DETECTION) {
-      ert_log_warn("Received CAD detection interrupt, but driver was not in state detection mode");
+      ert_log_warn("Received CAD done interrupt, but driver was not in state detection mode");
     }
 
     rfm9xw_read_mode_and_update_driver_state(device);
 
-    driver->detection_signal = true;
+    driver->detection_activity = irq_cad_detected;
+    driver->detection_done = true;
+
+    if (irq_cad_detected) {
+      driver->detection_signal = true;
 
-    if (driver->static_config.detection_callback != NULL) {
-      driver->static_config.detection_callback(driver->static_config.callback_context);
+      if (driver->static_config.detection_callback != NULL) {
+        driver->static_config.detection_callback(driver->static_config.callback_context);
+      }
     }
     rfm9xw_cond_signal(&driver->detection_cond, &driver->detection_mutex);
 
-    if (driver->static_config.receive_single_after_detection) {
+    if (irq_cad_detected && driver->static_config.receive_single_after_detection) {
       rfm9xw_start_receive(device, false);
     }
 
@@ -909,7 +1074,7 @@ static void rfm9xw_interrupt_dio0(void *arg)
     rfm9xw_read_mode_and_update_driver_state(device);
   }
 
-  ert_log_debug("dio0 interrupt: after: driver_state=0x%02X irq_flags=%02X ", driver->driver_state, irq_flags);
+  ert_log_trace("dio0 interrupt: after: driver_state=0x%02X irq_flags=%02X ", driver->driver_state, irq_flags);
 
   sched_yield();
 }
@@ -924,9 +1089,9 @@ static void rfm9xw_interrupt_dio5(void *arg)
   uint8_t irq_flags;
   rfm9xw_read_reg(device, REG_LORA_IRQ_FLAGS, &irq_flags);
 
-  ert_log_debug("dio5 interrupt: before: driver_state=0x%02X irq_flags=%02X ", driver->driver_state, irq_flags);
+  ert_log_trace("dio5 interrupt: before: driver_state=0x%02X irq_flags=%02X ", driver->driver_state, irq_flags);
   rfm9xw_read_mode_and_update_driver_state(device);
-  ert_log_debug("dio5 interrupt: after: driver_state=0x%02X irq_flags=%02X ", driver->driver_state, irq_flags);
+  ert_log_trace("dio5 interrupt: after: driver_state=0x%02X irq_flags=%02X ", driver->driver_state, irq_flags);
 
   rfm9xw_cond_signal(&driver->mode_change_cond, &driver->mode_change_mutex);
 
@@ -1002,40 +1167,7 @@ static int rfm9xw_initialize(ert_comm_device *device)
   return 0;
 }
 
-static int rfm9xw_write_fifo(ert_comm_device *device, uint8_t length, uint8_t *payload)
-{
-  ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
-  uint8_t data[257];
-  int i;
-
-  data[0] = REG_FIFO | REG_FLAG_WRITE;
-
-  for (i = 0; i < length; i++) {
-    data[i + 1] = payload[i];
-  }
-
-  return hal_spi_transfer(driver->spi_device, length + 1, data);
-}
-
-static int rfm9xw_read_fifo(ert_comm_device *device, uint8_t length, uint8_t *buffer)
-{
-  ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
-  uint8_t data[257];
-  int i, result;
-
-  memset(data, 0, 257);
-  data[0] = REG_FIFO;
-
-  result = hal_spi_transfer(driver->spi_device, length + 1, data);
-  
-  for (i = 0; i < length; i++) {
-    buffer[i] = data[i + 1];
-  }
-
-  return result;
-}
-
-static int rfm9xw_set_invert_iq(ert_comm_device *device, bool transmit)
+static int rfm9xw_message_set_invert_iq(ert_comm_device *device, rfm9xw_spi_message *message, bool transmit)
 {
   ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
   uint8_t value;
@@ -1062,15 +1194,9 @@ static int rfm9xw_set_invert_iq(ert_comm_device *device, bool transmit)
               : (LORA_INVERT_IQ_TX_OFF | LORA_INVERT_IQ_RX_OFF));
   }
 
-  result = rfm9xw_write_reg(device, REG_LORA_INVERT_IQ, value);
-  if (result < 0) {
-    return result;
-  }
-  result = rfm9xw_write_reg(device, REG_LORA_INVERT_IQ_2,
+  rfm9xw_message_write_reg(message, REG_LORA_INVERT_IQ, value);
+  rfm9xw_message_write_reg(message, REG_LORA_INVERT_IQ_2,
       (radio_config->iq_inverted ? LORA_INVERT_IQ_2_ON : LORA_INVERT_IQ_2_OFF));
-  if (result < 0) {
-    return result;
-  }
 
   return 0;
 }
@@ -1078,6 +1204,7 @@ static int rfm9xw_set_invert_iq(ert_comm_device *device, bool transmit)
 int rfm9xw_transmit(ert_comm_device *device, uint32_t length, uint8_t *payload, uint32_t *bytes_transmitted)
 {
   ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
+  rfm9xw_spi_message message = {0};
   int result;
 
   if (length > RFM9XW_LORA_PACKET_LENGTH_MAX) {
@@ -1092,12 +1219,9 @@ int rfm9xw_transmit(ert_comm_device *device, uint32_t length, uint8_t *payload,
   }
 
   // Map TxDone to DIO0
-  result = rfm9xw_write_reg(device, REG_DIO_MAPPING_1, 0x40);
-  if (result < 0) {
-    return result;
-  }
+  rfm9xw_message_write_reg(&message, REG_DIO_MAPPING_1, 0x40);
 
-  result = rfm9xw_write_reg(device, REG_LORA_IRQ_FLAGS_MASK,
+  rfm9xw_message_write_reg(&message, REG_LORA_IRQ_FLAGS_MASK,
                    IRQ_MASK_CAD_DETECTED |
                    IRQ_MASK_CAD_DONE |
                    IRQ_MASK_RX_DONE |
@@ -1105,32 +1229,18 @@ int rfm9xw_transmit(ert_comm_device *device, uint32_t length, uint8_t *payload,
                    IRQ_MASK_PAYLOAD_CRC_ERROR |
                    IRQ_MASK_VALID_HEADER |
                    IRQ_MASK_FHSS_CHANGE_CHANNEL);
-  if (result < 0) {
-    return result;
-  }
-
-  result = rfm9xw_set_invert_iq(device, true);
-  if (result < 0) {
-    return result;
-  }
-
-  result = rfm9xw_write_reg(device, REG_LORA_FIFO_TX_BASE_ADDR, 0x00);
-  if (result < 0) {
-    return result;
-  }
-  result = rfm9xw_write_reg(device, REG_LORA_FIFO_ADDR_PTR, 0x00);
-  if (result < 0) {
-    return result;
-  }
 
-  result = rfm9xw_write_fifo(device, length, payload);
+  result = rfm9xw_message_set_invert_iq(device, &message, true);
   if (result < 0) {
     return result;
   }
 
-  uint32_t transmitted = (uint32_t) result - 1;
+  rfm9xw_message_write_reg(&message, REG_LORA_FIFO_TX_BASE_ADDR, 0x00);
+  rfm9xw_message_write_reg(&message, REG_LORA_FIFO_ADDR_PTR, 0x00);
+  rfm9xw_message_write_fifo(&message, (uint8_t) length, payload);
+  rfm9xw_message_write_reg(&message, REG_LORA_PAYLOAD_LENGTH, (uint8_t) length);
 
-  result = rfm9xw_write_reg(device, REG_LORA_PAYLOAD_LENGTH, length);
+  result = rfm9xw_message_transfer(device, &message);
   if (result < 0) {
     return result;
   }
@@ -1140,7 +1250,7 @@ int rfm9xw_transmit(ert_comm_device *device, uint32_t length, uint8_t *payload,
     return result;
   }
 
-  *bytes_transmitted = transmitted;
+  *bytes_transmitted = length;
 
   return 0;
 }
@@ -1180,6 +1290,7 @@ int rfm9xw_wait_for_data(ert_comm_device *device, uint32_t milliseconds)
 int rfm9xw_start_receive(ert_comm_device *device, bool continuous)
 {
   ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
+  rfm9xw_spi_message message = {0};
   int result;
 
   driver->receive_signal = false;
@@ -1190,42 +1301,33 @@ int rfm9xw_start_receive(ert_comm_device *device, bool continuous)
   }
 
   // Map RxDone to DIO0
-  result = rfm9xw_write_reg(device, REG_DIO_MAPPING_1, 0x00);
-  if (result < 0) {
-    return result;
-  }
+  rfm9xw_message_write_reg(&message, REG_DIO_MAPPING_1, 0x00);
 
-  result = rfm9xw_write_reg(device, REG_LORA_IRQ_FLAGS_MASK,
+  rfm9xw_message_write_reg(&message, REG_LORA_IRQ_FLAGS_MASK,
                    IRQ_MASK_CAD_DETECTED |
                    IRQ_MASK_CAD_DONE |
                    IRQ_MASK_TX_DONE |
                    IRQ_MASK_VALID_HEADER |
                    IRQ_MASK_FHSS_CHANGE_CHANNEL);
-  if (result < 0) {
-    return result;
-  }
 
-  result = rfm9xw_set_invert_iq(device, false);
+  result = rfm9xw_message_set_invert_iq(device, &message, false);
   if (result < 0) {
     return result;
   }
 
-  result = rfm9xw_write_reg(device, REG_LORA_FIFO_RX_BASE_ADDR, 0x00);
-  if (result < 0) {
-    return result;
+  rfm9xw_message_write_reg(&message, REG_LORA_FIFO_RX_BASE_ADDR, 0x00);
+  rfm9xw_message_write_reg(&message, REG_LORA_FIFO_ADDR_PTR, 0x00);
+
+  if (driver->config.receive_config.expected_payload_length > 0) {
+    rfm9xw_message_write_reg(&message, REG_LORA_PAYLOAD_LENGTH,
+        driver->config.receive_config.expected_payload_length);
   }
-  result = rfm9xw_write_reg(device, REG_LORA_FIFO_ADDR_PTR, 0x00);
+
+  result = rfm9xw_message_transfer(device, &message);
   if (result < 0) {
     return result;
   }
 
-  if (driver->config.receive_config.expected_payload_length > 0) {
-    result = rfm9xw_write_reg(device, REG_LORA_PAYLOAD_LENGTH, driver->config.receive_config.expected_payload_length);
-    if (result < 0) {
-      return result;
-    }
-  }
-
   result = rfm9xw_set_mode(device, continuous ? MODE_LORA_RX_CONTINUOUS : MODE_LORA_RX_SINGLE);
   if (result < 0) {
     return result;
@@ -1246,16 +1348,61 @@ int rfm9xw_wait_for_detection(ert_comm_device *device, uint32_t milliseconds)
   int result;
   result = rfm9xw_cond_timedwait(device, &driver->detection_cond, &driver->detection_mutex, milliseconds,
       rfm9xw_is_detection_signal_active);
+
+  // Detection finished without detecting activity, no further interrupts will follow
+  if (result == 0 && !driver->detection_signal) {
+    result = -ETIMEDOUT;
+  }
+
   driver->detection_signal = false;
   return result;
 }
 
+static bool rfm9xw_is_detection_done(ert_comm_device *device)
+{
+  ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
+  return driver->detection_done;
+}
+
+/**
+ * Channel activity detection uses the modulation of the receive config, which must match the transmit config
+ * for listen-before-talk. The device is left in standby mode, unless activity was detected and
+ * receive_single_after_detection is set.
+ */
+int rfm9xw_detect_channel_activity(ert_comm_device *device, uint32_t milliseconds, bool *activity_detected)
+{
+  ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
+  int result;
+
+  result = rfm9xw_start_detection(device);
+  if (result < 0) {
+    return result;
+  }
+
+  result = rfm9xw_cond_timedwait(device, &driver->detection_cond, &driver->detection_mutex, milliseconds,
+      rfm9xw_is_detection_done);
+  driver->detection_signal = false;
+  if (result < 0) {
+    return result;
+  }
+  if (!driver->detection_done) {
+    return -ETIMEDOUT;
+  }
+
+  *activity_detected = driver->detection_activity;
+
+  return 0;
+}
+
 int rfm9xw_start_detection(ert_comm_device *device)
 {
   ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
+  rfm9xw_spi_message message = {0};
   int result;
 
   driver->detection_signal = false;
+  driver->detection_done = false;
+  driver->detection_activity = false;
 
   result = rfm9xw_update_config_for_receive(device);
   if (result < 0) {
@@ -1263,22 +1410,21 @@ int rfm9xw_start_detection(ert_comm_device *device)
   }
 
   // Map CadDone to DIO0
-  result = rfm9xw_write_reg(device, REG_DIO_MAPPING_1, 0x80);
-  if (result < 0) {
-    return result;
-  }
+  rfm9xw_message_write_reg(&message, REG_DIO_MAPPING_1, 0x80);
 
-  result = rfm9xw_set_invert_iq(device, false);
+  result = rfm9xw_message_set_invert_iq(device, &message, false);
   if (result < 0) {
     return result;
   }
 
-  result = rfm9xw_write_reg(device, REG_LORA_IRQ_FLAGS_MASK,
+  rfm9xw_message_write_reg(&message, REG_LORA_IRQ_FLAGS_MASK,
       IRQ_MASK_RX_DONE |
       IRQ_MASK_RX_TIMEOUT |
       IRQ_MASK_TX_DONE |
       IRQ_MASK_VALID_HEADER |
       IRQ_MASK_FHSS_CHANGE_CHANNEL);
+
+  result = rfm9xw_message_transfer(device, &message);
   if (result < 0) {
     return result;
   }
@@ -1301,21 +1447,9 @@ int rfm9xw_sleep(ert_comm_device *device)
   return rfm9xw_set_mode(device, MODE_LORA_SLEEP);
 }
 
-static int rfm9xw_read_packet_status(ert_comm_device *device)
+static void rfm9xw_update_packet_status(ert_comm_device *device, uint8_t raw_rssi, int8_t raw_snr)
 {
   ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
-  uint8_t raw_rssi;
-  int8_t raw_snr;
-  int result;
-
-  result = rfm9xw_read_reg(device, REG_LORA_PACKET_RSSI, &raw_rssi);
-  if (result < 0) {
-    return result;
-  }
-  result = rfm9xw_read_reg(device, REG_LORA_PACKET_SNR, (uint8_t *) &raw_snr);
-  if (result < 0) {
-    return result;
-  }
 
   float snr = (float) raw_snr / 4;
   float rssi = RFM9XW_RSSI_MINIMUM_HF + raw_rssi;
@@ -1327,50 +1461,38 @@ static int rfm9xw_read_packet_status(ert_comm_device *device)
   driver->status.last_packet_rssi_raw = RFM9XW_RSSI_MINIMUM_HF + raw_rssi;
   driver->status.last_packet_snr_raw = snr;
   device->status.last_received_packet_rssi = rssi;
-
-  return 0;
+  device->status.last_received_packet_snr = snr;
 }
 
 int rfm9xw_receive(ert_comm_device *device, uint32_t buffer_length, uint8_t *buffer, uint32_t *bytes_received)
 {
-  ert_driver_rfm9xw *driver = (ert_driver_rfm9xw *) device->priv;
-  uint8_t irq_flags;
+  rfm9xw_spi_message message = {0};
+  uint8_t irq_flags, fifo_addr, read_bytes, raw_rssi;
+  int8_t raw_snr;
   int result;
 
-  result = rfm9xw_read_reg(device, REG_LORA_IRQ_FLAGS, &irq_flags);
-  if (result < 0) {
-    return -EIO;
-  }
+  // The packet status registers are valid on RxDone, so they are read in the same message as the IRQ flags
+  rfm9xw_message_read_reg(&message, REG_LORA_IRQ_FLAGS, &irq_flags);
+  rfm9xw_message_write_reg(&message, REG_LORA_IRQ_FLAGS, IRQ_FLAG_RX_DONE);
+  rfm9xw_message_read_reg(&message, REG_LORA_FIFO_RX_CURRENT_ADDR, &fifo_addr);
+  rfm9xw_message_read_reg(&message, REG_LORA_RX_NB_BYTES, &read_bytes);
+  rfm9xw_message_read_reg(&message, REG_LORA_PACKET_RSSI, &raw_rssi);
+  rfm9xw_message_read_reg(&message, REG_LORA_PACKET_SNR, (uint8_t *) &raw_snr);
 
-  result = rfm9xw_write_reg(device, REG_LORA_IRQ_FLAGS, IRQ_FLAG_RX_DONE);
+  result = rfm9xw_message_transfer(device, &message);
   if (result < 0) {
     return -EIO;
   }
 
+  rfm9xw_update_packet_status(device, raw_rssi, raw_snr);
+
   if (irq_flags & IRQ_FLAG_PAYLOAD_CRC_ERROR) {
     rfm9xw_write_reg(device, REG_LORA_IRQ_FLAGS, 0xFF);
     rfm9xw_increment_counter(device, RFM9XW_COUNTER_TYPE_RECEIVE_INVALID, 0);
-    rfm9xw_read_packet_status(device);
 
     return -EBADMSG;
   }
 
-  uint8_t fifo_addr, read_bytes;
-
-  result = rfm9xw_read_reg(device, REG_LORA_FIFO_RX_CURRENT_ADDR, &fifo_addr);
-  if (result < 0) {
-    return -EIO;
-  }
-  result = rfm9xw_read_reg(device, REG_LORA_RX_NB_BYTES, &read_bytes);
-  if (result < 0) {
-    return -EIO;
-  }
-
-  result = rfm9xw_write_reg(device, REG_LORA_FIFO_ADDR_PTR, fifo_addr);
-  if (result < 0) {
-    return -EIO;
-  }
-
   uint8_t transfer_bytes;
 
   if (read_bytes > buffer_length) {
@@ -1379,20 +1501,18 @@ int rfm9xw_receive(ert_comm_device *device, uint32_t buffer_length, uint8_t *buf
     transfer_bytes = read_bytes;
   }
 
-  result = rfm9xw_read_fifo(device, transfer_bytes, buffer);
-  if (result < 0) {
-    return -EIO;
-  }
+  memset(&message, 0, sizeof(message));
+  rfm9xw_message_write_reg(&message, REG_LORA_FIFO_ADDR_PTR, fifo_addr);
+  rfm9xw_message_read_fifo(&message, transfer_bytes, buffer);
+  rfm9xw_message_write_reg(&message, REG_LORA_IRQ_FLAGS, 0xFF);
 
-  result = rfm9xw_write_reg(device, REG_LORA_IRQ_FLAGS, 0xFF);
+  result = rfm9xw_message_transfer(device, &message);
   if (result < 0) {
     return -EIO;
   }
 
   rfm9xw_increment_counter(device, RFM9XW_COUNTER_TYPE_RECEIVE, transfer_bytes);
 
-  rfm9xw_read_packet_status(device);
-
   *bytes_received = transfer_bytes;
 
   return 0;
@@ -1678,6 +1798,7 @@ ert_comm_driver ert_comm_driver_rfm9xw = {
     .wait_for_transmit = rfm9xw_wait_for_transmit,
     .start_detection = rfm9xw_start_detection,
     .wait_for_detection = rfm9xw_wait_for_detection,
+    .detect_channel_activity = rfm9xw_detect_channel_activity,
     .start_receive = rfm9xw_start_receive,
     .wait_for_data = rfm9xw_wait_for_data,
     .receive = rfm9xw_receive,
@@ -150,6 +150,9 @@ typedef struct _ert_driver_rfm9x {
   pthread_mutex_t detection_mutex;
   pthread_cond_t detection_cond;
   volatile bool detection_signal;
+  // Set when channel activity detection has finished, with or without detecting activity
+  volatile bool detection_done;
+  volatile bool detection_activity;
 
   pthread_mutex_t status_mutex;
 
@@ -172,6 +175,11 @@ int rfm9xw_set_detection_callback(ert_comm_device *device, ert_comm_driver_callb
 int rfm9xw_set_callback_context(ert_comm_device *device, void *callback_context);
 
 int rfm9xw_configure(ert_comm_device *device, ert_driver_rfm9xw_config *config);
+/**
+ * Sets LoRa modulation of the radio config. Coding rate 1-4 means error coding rate 4/5-4/8.
+ */
+int rfm9xw_set_radio_config_data_rate(ert_driver_rfm9xw_radio_config *radio_config,
+    uint8_t spreading_factor, uint32_t bandwidth_hz, uint8_t coding_rate);
 int rfm9xw_set_frequency(ert_comm_device *device, ert_comm_device_config_type type, double frequency);
 int rfm9xw_get_frequency_error(ert_comm_device *device, double *frequency_error_hz);
 
@@ -180,6 +188,7 @@ int rfm9xw_wait_for_transmit(ert_comm_device *device, uint32_t milliseconds);
 
 int rfm9xw_start_detection(ert_comm_device *device);
 int rfm9xw_wait_for_detection(ert_comm_device *device, uint32_t milliseconds);
+int rfm9xw_detect_channel_activity(ert_comm_device *device, uint32_t milliseconds, bool *activity_detected);
 
 int rfm9xw_start_receive(ert_comm_device *device, bool continuous);
 int rfm9xw_wait_for_data(ert_comm_device *device, uint32_t milliseconds);
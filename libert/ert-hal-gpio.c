@@ -13,6 +13,15 @@
 
 hal_gpio_driver *gpio_driver = &hal_gpio_driver_rpi;
 
+/**
+ * Replaces the GPIO driver, for example with a mock driver in tests. Interrupt handlers are registered with the
+ * driver active at the time of registration.
+ */
+void hal_gpio_set_driver(hal_gpio_driver *driver)
+{
+  gpio_driver = driver;
+}
+
 int hal_gpio_init()
 {
   return gpio_driver->init();
@@ -40,4 +40,6 @@ typedef struct _hal_gpio_driver {
     int (*pin_isr)(uint16_t pin, uint8_t edge, hal_gpio_isr function, void *data);
 } hal_gpio_driver;
 
+void hal_gpio_set_driver(hal_gpio_driver *driver);
+
 #endif
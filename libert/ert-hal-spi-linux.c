@@ -26,7 +26,6 @@ const static char *spi_device_file_template = "/dev/spidev%d.%d" ;
 
 // TODO: add constants for mode
 // TODO: add functions for changing mode, speed and bits per word
-// TODO: add function to set cs_change
 // TODO: add function to set high CS
 
 int hal_spi_linux_open(int bus, int device, uint32_t speed, uint32_t mode, hal_spi_device **spi_device_rcv)
@@ -129,8 +128,39 @@ int hal_spi_linux_transfer(hal_spi_device *spi_device, uint32_t length, uint8_t
   return ioctl(spi_device->fd, SPI_IOC_MESSAGE(1), &spi_transfer);
 }
 
+int hal_spi_linux_transfer_segments(hal_spi_device *spi_device, uint32_t segment_count, hal_spi_segment *segments)
+{
+  struct spi_ioc_transfer spi_transfers[HAL_SPI_SEGMENT_COUNT_MAX];
+
+  if (!spi_device->open || spi_device->fd < 1) {
+    return -1;
+  }
+  if (segment_count == 0 || segment_count > HAL_SPI_SEGMENT_COUNT_MAX) {
+    return -EINVAL;
+  }
+
+  memset(spi_transfers, 0, segment_count * sizeof(struct spi_ioc_transfer));
+
+  for (uint32_t i = 0; i < segment_count; i++) {
+    struct spi_ioc_transfer *spi_transfer = &spi_transfers[i];
+
+    spi_transfer->speed_hz = spi_device->speed;
+    spi_transfer->bits_per_word = spi_device->bits_per_word;
+    spi_transfer->delay_usecs = spi_device->delay_usecs;
+    spi_transfer->len = segments[i].length;
+    spi_transfer->tx_buf = (uintptr_t) segments[i].tx_data;
+    spi_transfer->rx_buf = (uintptr_t) segments[i].rx_data;
+
+    // For the last transfer cs_change would keep chip select asserted after the message
+    spi_transfer->cs_change = (segments[i].cs_change && i < segment_count - 1) ? 1 : 0;
+  }
+
+  return ioctl(spi_device->fd, SPI_IOC_MESSAGE(segment_count), spi_transfers);
+}
+
 hal_spi_driver hal_spi_driver_linux = {
   .open = hal_spi_linux_open,
   .close = hal_spi_linux_close,
-  .transfer = hal_spi_linux_transfer
+  .transfer = hal_spi_linux_transfer,
+  .transfer_segments = hal_spi_linux_transfer_segments
 };
@@ -13,6 +13,14 @@
 
 hal_spi_driver *spi_driver = &hal_spi_driver_linux;
 
+/**
+ * Replaces the SPI driver used by all SPI devices opened afterwards, for example with a mock driver in tests.
+ */
+void hal_spi_set_driver(hal_spi_driver *driver)
+{
+  spi_driver = driver;
+}
+
 int hal_spi_open(int bus, int device, uint32_t speed, uint32_t mode, hal_spi_device **spi_device_rcv)
 {
   return spi_driver->open(bus, device, speed, mode, spi_device_rcv);
@@ -27,3 +35,11 @@ int hal_spi_transfer(hal_spi_device *spi_device, int length, uint8_t *data)
 {
   return spi_driver->transfer(spi_device, length, data);
 }
+
+/**
+ * Transfers all segments as a single SPI message. Returns the total number of bytes transferred.
+ */
+int hal_spi_transfer_segments(hal_spi_device *spi_device, uint32_t segment_count, hal_spi_segment *segments)
+{
+  return spi_driver->transfer_segments(spi_device, segment_count, segments);
+}
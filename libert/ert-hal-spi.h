@@ -25,14 +25,33 @@ typedef struct _hal_spi_device {
   bool open;
 } hal_spi_device;
 
+#define HAL_SPI_SEGMENT_COUNT_MAX 32
+
+/**
+ * Segment of a multi-segment SPI message. All segments of a message are transferred in a single transaction.
+ * If cs_change is set, chip select is deasserted after the segment, so that consecutive device commands, such as
+ * register accesses, can be framed separately within one message. Chip select is always deasserted after the last
+ * segment. A NULL tx_data transmits zeros and a NULL rx_data discards the received data.
+ */
+typedef struct _hal_spi_segment {
+  uint32_t length;
+  const uint8_t *tx_data;
+  uint8_t *rx_data;
+  bool cs_change;
+} hal_spi_segment;
+
 typedef struct _hal_spi_driver {
   int (*open)(int bus, int device, uint32_t speed, uint32_t mode, hal_spi_device **spi_device_rcv);
   int (*close)(hal_spi_device *spi_device);
   int (*transfer)(hal_spi_device *spi_device, uint32_t length, uint8_t *data);
+  int (*transfer_segments)(hal_spi_device *spi_device, uint32_t segment_count, hal_spi_segment *segments);
 } hal_spi_driver;
 
+void hal_spi_set_driver(hal_spi_driver *driver);
+
 int hal_spi_open(int bus, int device, uint32_t speed, uint32_t mode, hal_spi_device **spi_device_rcv);
 int hal_spi_close(hal_spi_device *spi_device);
 int hal_spi_transfer(hal_spi_device *spi_device, int length, uint8_t *data);
+int hal_spi_transfer_segments(hal_spi_device *spi_device, uint32_t segment_count, hal_spi_segment *segments);
 
 #endif
@@ -0,0 +1,775 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "ert-hal-sx127x-mock.h"
+#include "ert-comm-device-simulator.h"
+#include "ert-time.h"
+#include "ert-log.h"
+
+#define SX127X_REG_FLAG_WRITE             0x80
+
+#define SX127X_REG_FIFO                   0x00
+#define SX127X_REG_OPMODE                 0x01
+#define SX127X_REG_FIFO_ADDR_PTR          0x0D
+#define SX127X_REG_FIFO_TX_BASE_ADDR      0x0E
+#define SX127X_REG_FIFO_RX_BASE_ADDR      0x0F
+#define SX127X_REG_FIFO_RX_CURRENT_ADDR   0x10
+#define SX127X_REG_IRQ_FLAGS_MASK         0x11
+#define SX127X_REG_IRQ_FLAGS              0x12
+#define SX127X_REG_RX_NB_BYTES            0x13
+#define SX127X_REG_PACKET_SNR             0x19
+#define SX127X_REG_PACKET_RSSI            0x1A
+#define SX127X_REG_MODEM_CONFIG_1         0x1D
+#define SX127X_REG_MODEM_CONFIG_2         0x1E
+#define SX127X_REG_PREAMBLE_MSB           0x20
+#define SX127X_REG_PREAMBLE_LSB           0x21
+#define SX127X_REG_PAYLOAD_LENGTH         0x22
+#define SX127X_REG_MAX_PAYLOAD_LENGTH     0x23
+#define SX127X_REG_MODEM_CONFIG_3         0x26
+#define SX127X_REG_DETECTION_OPTIMIZE     0x31
+#define SX127X_REG_INVERT_IQ              0x33
+#define SX127X_REG_DETECTION_THRESHOLD    0x37
+#define SX127X_REG_INVERT_IQ_2            0x3B
+#define SX127X_REG_DIO_MAPPING_1          0x40
+#define SX127X_REG_VERSION                0x42
+
+#define SX127X_MODE_MASK                  0x07
+#define SX127X_MODE_SLEEP                 0x00
+#define SX127X_MODE_STANDBY               0x01
+#define SX127X_MODE_TX                    0x03
+#define SX127X_MODE_RX_CONTINUOUS         0x05
+#define SX127X_MODE_RX_SINGLE             0x06
+#define SX127X_MODE_CAD                   0x07
+
+#define SX127X_IRQ_FLAG_CAD_DETECTED      0x01
+#define SX127X_IRQ_FLAG_CAD_DONE          0x04
+#define SX127X_IRQ_FLAG_TX_DONE           0x08
+#define SX127X_IRQ_FLAG_PAYLOAD_CRC_ERROR 0x20
+#define SX127X_IRQ_FLAG_RX_DONE           0x40
+
+#define SX127X_DIO0_MAPPING_MASK          0xC0
+#define SX127X_DIO0_MAPPING_RX_DONE       0x00
+#define SX127X_DIO0_MAPPING_TX_DONE       0x40
+#define SX127X_DIO0_MAPPING_CAD_DONE      0x80
+
+#define SX127X_RSSI_MINIMUM_HF            -157
+#define SX127X_CHIP_VERSION               0x12
+
+typedef enum _hal_sx127x_mock_event_type {
+  HAL_SX127X_MOCK_EVENT_NONE = 0,
+  HAL_SX127X_MOCK_EVENT_MODE_READY,
+  HAL_SX127X_MOCK_EVENT_TRANSMIT_DONE,
+  HAL_SX127X_MOCK_EVENT_CAD_DONE,
+  HAL_SX127X_MOCK_EVENT_RECEIVE_DONE,
+} hal_sx127x_mock_event_type;
+
+typedef struct _hal_sx127x_mock_event {
+  bool pending;
+  struct timespec time;
+} hal_sx127x_mock_event;
+
+/**
+ * Emulated SX127x chip shared by the SPI and GPIO mock drivers. Register accesses are served from the register file
+ * and FIFO, and mode changes schedule events that an interrupt thread raises on the DIO pins when they are due,
+ * calling the interrupt handlers the same way as wiringPi does.
+ */
+typedef struct _hal_sx127x_mock {
+  hal_sx127x_mock_config config;
+
+  uint8_t registers[0x80];
+  uint8_t fifo[0x100];
+
+  bool frame_started;
+  bool frame_write;
+  uint8_t frame_address;
+
+  hal_sx127x_mock_event events[HAL_SX127X_MOCK_EVENT_RECEIVE_DONE + 1];
+
+  uint32_t transmit_length;
+  uint8_t transmit_payload[0x100];
+
+  uint32_t receive_length;
+  uint8_t receive_payload[0x100];
+  uint8_t receive_raw_rssi;
+  int8_t receive_raw_snr;
+  bool receive_crc_error;
+
+  bool channel_active;
+
+  hal_gpio_isr isr_functions[HAL_SX127X_MOCK_PIN_COUNT];
+  void *isr_data[HAL_SX127X_MOCK_PIN_COUNT];
+
+  hal_sx127x_mock_status status;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t event_cond;
+  pthread_t interrupt_thread;
+  volatile bool running;
+} hal_sx127x_mock;
+
+static hal_sx127x_mock sx127x_mock;
+
+static const uint32_t sx127x_mock_bandwidths_hz[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
+void hal_sx127x_mock_create_default_config(hal_sx127x_mock_config *config)
+{
+  memset(config, 0, sizeof(hal_sx127x_mock_config));
+
+  config->pin_dio0 = HAL_SX127X_MOCK_PIN_DIO0_DEFAULT;
+  config->pin_dio5 = HAL_SX127X_MOCK_PIN_DIO5_DEFAULT;
+  config->mode_change_delay_micros = 100;
+  config->spi_message_delay_micros = 0;
+  config->cad_delay_micros = 2000;
+  config->time_scale = 1.0;
+}
+
+static void sx127x_mock_reset_registers()
+{
+  memset(sx127x_mock.registers, 0, sizeof(sx127x_mock.registers));
+  memset(sx127x_mock.fifo, 0, sizeof(sx127x_mock.fifo));
+
+  sx127x_mock.registers[SX127X_REG_OPMODE] = 0x09;
+  sx127x_mock.registers[SX127X_REG_FIFO_TX_BASE_ADDR] = 0x80;
+  sx127x_mock.registers[SX127X_REG_MODEM_CONFIG_1] = 0x72;
+  sx127x_mock.registers[SX127X_REG_MODEM_CONFIG_2] = 0x70;
+  sx127x_mock.registers[SX127X_REG_PREAMBLE_LSB] = 0x08;
+  sx127x_mock.registers[SX127X_REG_PAYLOAD_LENGTH] = 0x01;
+  sx127x_mock.registers[SX127X_REG_MAX_PAYLOAD_LENGTH] = 0xFF;
+  sx127x_mock.registers[SX127X_REG_DETECTION_OPTIMIZE] = 0xC3;
+  sx127x_mock.registers[SX127X_REG_INVERT_IQ] = 0x27;
+  sx127x_mock.registers[SX127X_REG_DETECTION_THRESHOLD] = 0x0A;
+  sx127x_mock.registers[SX127X_REG_INVERT_IQ_2] = 0x1D;
+  sx127x_mock.registers[SX127X_REG_VERSION] = SX127X_CHIP_VERSION;
+}
+
+static void sx127x_mock_timespec_add_micros(struct timespec *ts, uint64_t micros)
+{
+  ts->tv_nsec += (long) ((micros % 1000000LL) * 1000LL);
+  ts->tv_sec += (time_t) (micros / 1000000LL) + ((ts->tv_nsec >= 1000000000LL) ? 1 : 0);
+  ts->tv_nsec = ts->tv_nsec % 1000000000LL;
+}
+
+static bool sx127x_mock_timespec_before(struct timespec *a, struct timespec *b)
+{
+  return (a->tv_sec < b->tv_sec) || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static uint64_t sx127x_mock_get_airtime_micros(uint32_t length)
+{
+  uint8_t modem_config_1 = sx127x_mock.registers[SX127X_REG_MODEM_CONFIG_1];
+  uint8_t modem_config_2 = sx127x_mock.registers[SX127X_REG_MODEM_CONFIG_2];
+  uint8_t modem_config_3 = sx127x_mock.registers[SX127X_REG_MODEM_CONFIG_3];
+
+  uint8_t bandwidth_setting = (uint8_t) (modem_config_1 >> 4);
+  uint8_t spreading_factor = (uint8_t) (modem_config_2 >> 4);
+  if (bandwidth_setting > 9 || spreading_factor < 6 || spreading_factor > 12) {
+    return 0;
+  }
+
+  ert_comm_driver_simulator_lora_config lora_config = {
+      .spreading_factor = spreading_factor,
+      .bandwidth_hz = sx127x_mock_bandwidths_hz[bandwidth_setting],
+      .coding_rate = (uint8_t) ((modem_config_1 >> 1) & 0x07),
+      .preamble_length = (uint16_t) ((sx127x_mock.registers[SX127X_REG_PREAMBLE_MSB] << 8)
+          | sx127x_mock.registers[SX127X_REG_PREAMBLE_LSB]),
+      .implicit_header_mode = (modem_config_1 & 0x01) ? true : false,
+      .crc = (modem_config_2 & 0x04) ? true : false,
+      .low_data_rate_optimize = (modem_config_3 & 0x08) ? true : false,
+  };
+
+  double airtime_millis = ert_driver_comm_device_simulator_calculate_airtime_millis(&lora_config, length);
+
+  return (uint64_t) (airtime_millis * sx127x_mock.config.time_scale * 1000.0);
+}
+
+static void sx127x_mock_schedule_event(hal_sx127x_mock_event_type type, uint64_t delay_micros)
+{
+  hal_sx127x_mock_event *event = &sx127x_mock.events[type];
+
+  ert_get_current_timestamp(&event->time);
+  sx127x_mock_timespec_add_micros(&event->time, delay_micros);
+  event->pending = true;
+
+  pthread_cond_signal(&sx127x_mock.event_cond);
+}
+
+static inline uint8_t sx127x_mock_get_mode()
+{
+  return (uint8_t) (sx127x_mock.registers[SX127X_REG_OPMODE] & SX127X_MODE_MASK);
+}
+
+static void sx127x_mock_set_mode(uint8_t mode)
+{
+  sx127x_mock.registers[SX127X_REG_OPMODE] =
+      (uint8_t) ((sx127x_mock.registers[SX127X_REG_OPMODE] & ~SX127X_MODE_MASK) | mode);
+}
+
+static void sx127x_mock_change_mode(uint8_t value)
+{
+  sx127x_mock.registers[SX127X_REG_OPMODE] = value;
+
+  uint8_t mode = sx127x_mock_get_mode();
+
+  // Leaving transmit or CAD mode aborts the operation
+  sx127x_mock.events[HAL_SX127X_MOCK_EVENT_TRANSMIT_DONE].pending = false;
+  sx127x_mock.events[HAL_SX127X_MOCK_EVENT_CAD_DONE].pending = false;
+
+  // The driver does not wait for ModeReady when entering sleep mode
+  if (mode != SX127X_MODE_SLEEP) {
+    sx127x_mock_schedule_event(HAL_SX127X_MOCK_EVENT_MODE_READY, sx127x_mock.config.mode_change_delay_micros);
+  }
+
+  switch (mode) {
+    case SX127X_MODE_TX: {
+      uint8_t base_address = sx127x_mock.registers[SX127X_REG_FIFO_TX_BASE_ADDR];
+      sx127x_mock.transmit_length = sx127x_mock.registers[SX127X_REG_PAYLOAD_LENGTH];
+      for (uint32_t i = 0; i < sx127x_mock.transmit_length; i++) {
+        sx127x_mock.transmit_payload[i] = sx127x_mock.fifo[(uint8_t) (base_address + i)];
+      }
+
+      sx127x_mock_schedule_event(HAL_SX127X_MOCK_EVENT_TRANSMIT_DONE, sx127x_mock.config.mode_change_delay_micros
+          + sx127x_mock_get_airtime_micros(sx127x_mock.transmit_length));
+      break;
+    }
+    case SX127X_MODE_CAD:
+      sx127x_mock_schedule_event(HAL_SX127X_MOCK_EVENT_CAD_DONE,
+          sx127x_mock.config.mode_change_delay_micros + sx127x_mock.config.cad_delay_micros);
+      break;
+    default:
+      break;
+  }
+}
+
+static uint8_t sx127x_mock_read_register(uint8_t reg)
+{
+  if (reg == SX127X_REG_FIFO) {
+    return sx127x_mock.fifo[sx127x_mock.registers[SX127X_REG_FIFO_ADDR_PTR]++];
+  }
+
+  return sx127x_mock.registers[reg];
+}
+
+static void sx127x_mock_write_register(uint8_t reg, uint8_t value)
+{
+  switch (reg) {
+    case SX127X_REG_FIFO:
+      sx127x_mock.fifo[sx127x_mock.registers[SX127X_REG_FIFO_ADDR_PTR]++] = value;
+      break;
+    case SX127X_REG_OPMODE:
+      sx127x_mock_change_mode(value);
+      break;
+    case SX127X_REG_IRQ_FLAGS:
+      // IRQ flags are cleared by writing 1 to them
+      sx127x_mock.registers[reg] &= (uint8_t) ~value;
+      break;
+    case SX127X_REG_VERSION:
+      break;
+    default:
+      sx127x_mock.registers[reg] = value;
+      break;
+  }
+}
+
+/**
+ * Exchanges one byte within the current chip select frame. The first byte of a frame is the register address and
+ * the following bytes access the FIFO or consecutive registers.
+ */
+static uint8_t sx127x_mock_exchange(uint8_t tx_byte)
+{
+  if (!sx127x_mock.frame_started) {
+    sx127x_mock.frame_started = true;
+    sx127x_mock.frame_write = (tx_byte & SX127X_REG_FLAG_WRITE) ? true : false;
+    sx127x_mock.frame_address = (uint8_t) (tx_byte & 0x7F);
+    return 0;
+  }
+
+  uint8_t reg = sx127x_mock.frame_address;
+  if (reg != SX127X_REG_FIFO) {
+    sx127x_mock.frame_address = (uint8_t) ((reg + 1) & 0x7F);
+  }
+
+  if (sx127x_mock.frame_write) {
+    sx127x_mock_write_register(reg, tx_byte);
+    return 0;
+  }
+
+  return sx127x_mock_read_register(reg);
+}
+
+static void sx127x_mock_set_irq_flags(uint8_t irq_flags)
+{
+  // Masked interrupts are not set in the IRQ flags register
+  sx127x_mock.registers[SX127X_REG_IRQ_FLAGS] |= (uint8_t) (irq_flags & ~sx127x_mock.registers[SX127X_REG_IRQ_FLAGS_MASK]);
+}
+
+static bool sx127x_mock_is_dio0_active()
+{
+  uint8_t irq_flags = sx127x_mock.registers[SX127X_REG_IRQ_FLAGS];
+
+  switch (sx127x_mock.registers[SX127X_REG_DIO_MAPPING_1] & SX127X_DIO0_MAPPING_MASK) {
+    case SX127X_DIO0_MAPPING_RX_DONE:
+      return (irq_flags & SX127X_IRQ_FLAG_RX_DONE) != 0;
+    case SX127X_DIO0_MAPPING_TX_DONE:
+      return (irq_flags & SX127X_IRQ_FLAG_TX_DONE) != 0;
+    case SX127X_DIO0_MAPPING_CAD_DONE:
+      return (irq_flags & SX127X_IRQ_FLAG_CAD_DONE) != 0;
+    default:
+      return false;
+  }
+}
+
+static hal_sx127x_mock_event_type sx127x_mock_get_next_event(struct timespec **time)
+{
+  hal_sx127x_mock_event_type next_type = HAL_SX127X_MOCK_EVENT_NONE;
+
+  for (int type = HAL_SX127X_MOCK_EVENT_MODE_READY; type <= HAL_SX127X_MOCK_EVENT_RECEIVE_DONE; type++) {
+    hal_sx127x_mock_event *event = &sx127x_mock.events[type];
+    if (!event->pending) {
+      continue;
+    }
+    if (next_type == HAL_SX127X_MOCK_EVENT_NONE || sx127x_mock_timespec_before(&event->time, *time)) {
+      next_type = (hal_sx127x_mock_event_type) type;
+      *time = &event->time;
+    }
+  }
+
+  return next_type;
+}
+
+/**
+ * Applies the state change of an event to the chip and returns the pin raised by it, or -1 if no pin is raised.
+ */
+static int sx127x_mock_process_event(hal_sx127x_mock_event_type type, bool *transmitted)
+{
+  sx127x_mock.events[type].pending = false;
+
+  switch (type) {
+    case HAL_SX127X_MOCK_EVENT_MODE_READY:
+      return sx127x_mock.config.pin_dio5;
+    case HAL_SX127X_MOCK_EVENT_TRANSMIT_DONE:
+      sx127x_mock_set_mode(SX127X_MODE_STANDBY);
+      sx127x_mock_set_irq_flags(SX127X_IRQ_FLAG_TX_DONE);
+      sx127x_mock.status.transmitted_packet_count++;
+      *transmitted = true;
+      break;
+    case HAL_SX127X_MOCK_EVENT_CAD_DONE: {
+      bool detected = sx127x_mock.channel_active || sx127x_mock.events[HAL_SX127X_MOCK_EVENT_RECEIVE_DONE].pending;
+      sx127x_mock_set_mode(SX127X_MODE_STANDBY);
+      sx127x_mock_set_irq_flags(SX127X_IRQ_FLAG_CAD_DONE | (detected ? SX127X_IRQ_FLAG_CAD_DETECTED : 0));
+      break;
+    }
+    case HAL_SX127X_MOCK_EVENT_RECEIVE_DONE: {
+      uint8_t mode = sx127x_mock_get_mode();
+      if (mode != SX127X_MODE_RX_CONTINUOUS && mode != SX127X_MODE_RX_SINGLE) {
+        sx127x_mock.status.lost_packet_count++;
+        return -1;
+      }
+
+      uint8_t base_address = sx127x_mock.registers[SX127X_REG_FIFO_RX_BASE_ADDR];
+      for (uint32_t i = 0; i < sx127x_mock.receive_length; i++) {
+        sx127x_mock.fifo[(uint8_t) (base_address + i)] = sx127x_mock.receive_payload[i];
+      }
+      sx127x_mock.registers[SX127X_REG_FIFO_RX_CURRENT_ADDR] = base_address;
+      sx127x_mock.registers[SX127X_REG_RX_NB_BYTES] = (uint8_t) sx127x_mock.receive_length;
+      sx127x_mock.registers[SX127X_REG_PACKET_RSSI] = sx127x_mock.receive_raw_rssi;
+      sx127x_mock.registers[SX127X_REG_PACKET_SNR] = (uint8_t) sx127x_mock.receive_raw_snr;
+
+      if (mode == SX127X_MODE_RX_SINGLE) {
+        sx127x_mock_set_mode(SX127X_MODE_STANDBY);
+      }
+      sx127x_mock_set_irq_flags(SX127X_IRQ_FLAG_RX_DONE
+          | (sx127x_mock.receive_crc_error ? SX127X_IRQ_FLAG_PAYLOAD_CRC_ERROR : 0));
+      sx127x_mock.status.received_packet_count++;
+      break;
+    }
+    default:
+      return -1;
+  }
+
+  return sx127x_mock_is_dio0_active() ? sx127x_mock.config.pin_dio0 : -1;
+}
+
+static void *sx127x_mock_interrupt_thread(void *arg)
+{
+  pthread_mutex_lock(&sx127x_mock.mutex);
+
+  while (sx127x_mock.running) {
+    struct timespec *event_time = NULL;
+    hal_sx127x_mock_event_type type = sx127x_mock_get_next_event(&event_time);
+
+    if (type == HAL_SX127X_MOCK_EVENT_NONE) {
+      pthread_cond_wait(&sx127x_mock.event_cond, &sx127x_mock.mutex);
+      continue;
+    }
+
+    struct timespec now;
+    ert_get_current_timestamp(&now);
+    if (sx127x_mock_timespec_before(&now, event_time)) {
+      struct timespec wait_time = *event_time;
+      pthread_cond_timedwait(&sx127x_mock.event_cond, &sx127x_mock.mutex, &wait_time);
+      continue;
+    }
+
+    bool transmitted = false;
+    int pin = sx127x_mock_process_event(type, &transmitted);
+
+    uint32_t transmit_length = sx127x_mock.transmit_length;
+    uint8_t transmit_payload[0x100];
+    if (transmitted) {
+      memcpy(transmit_payload, sx127x_mock.transmit_payload, transmit_length);
+    }
+
+    hal_gpio_isr isr_function = NULL;
+    void *isr_data = NULL;
+    if (pin >= 0 && pin < HAL_SX127X_MOCK_PIN_COUNT) {
+      isr_function = sx127x_mock.isr_functions[pin];
+      isr_data = sx127x_mock.isr_data[pin];
+
+      if (pin == sx127x_mock.config.pin_dio0) {
+        sx127x_mock.status.dio0_interrupt_count++;
+        ert_get_current_timestamp(&sx127x_mock.status.last_dio0_interrupt_timestamp);
+      } else {
+        sx127x_mock.status.dio5_interrupt_count++;
+      }
+    }
+
+    // Handlers access the chip through SPI, so they are called without holding the mutex
+    pthread_mutex_unlock(&sx127x_mock.mutex);
+
+    if (transmitted && sx127x_mock.config.transmit_callback != NULL) {
+      sx127x_mock.config.transmit_callback(sx127x_mock.config.callback_context, transmit_length, transmit_payload);
+    }
+    if (isr_function != NULL) {
+      isr_function(isr_data);
+    }
+
+    pthread_mutex_lock(&sx127x_mock.mutex);
+  }
+
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+
+  return NULL;
+}
+
+int hal_sx127x_mock_init(hal_sx127x_mock_config *config)
+{
+  int result;
+
+  memset(&sx127x_mock, 0, sizeof(hal_sx127x_mock));
+  memcpy(&sx127x_mock.config, config, sizeof(hal_sx127x_mock_config));
+
+  if (config->pin_dio0 >= HAL_SX127X_MOCK_PIN_COUNT || config->pin_dio5 >= HAL_SX127X_MOCK_PIN_COUNT) {
+    ert_log_error("Invalid SX127x mock DIO pins %d and %d", config->pin_dio0, config->pin_dio5);
+    return -EINVAL;
+  }
+
+  sx127x_mock_reset_registers();
+
+  result = pthread_mutex_init(&sx127x_mock.mutex, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing SX127x mock mutex, result %d", result);
+    return -EIO;
+  }
+  result = pthread_cond_init(&sx127x_mock.event_cond, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing SX127x mock condition, result %d", result);
+    goto error_mutex;
+  }
+
+  sx127x_mock.running = true;
+
+  result = pthread_create(&sx127x_mock.interrupt_thread, NULL, sx127x_mock_interrupt_thread, NULL);
+  if (result != 0) {
+    ert_log_error("Error starting SX127x mock interrupt thread, result %d", result);
+    goto error_cond;
+  }
+
+  return 0;
+
+  error_cond:
+  pthread_cond_destroy(&sx127x_mock.event_cond);
+
+  error_mutex:
+  pthread_mutex_destroy(&sx127x_mock.mutex);
+
+  return -EIO;
+}
+
+int hal_sx127x_mock_uninit()
+{
+  pthread_mutex_lock(&sx127x_mock.mutex);
+  sx127x_mock.running = false;
+  pthread_cond_signal(&sx127x_mock.event_cond);
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+
+  pthread_join(sx127x_mock.interrupt_thread, NULL);
+
+  pthread_cond_destroy(&sx127x_mock.event_cond);
+  pthread_mutex_destroy(&sx127x_mock.mutex);
+
+  return 0;
+}
+
+/**
+ * Starts receiving a packet over the air. The packet is stored in the FIFO and RxDone is raised after its time on air
+ * if the chip is still in a receive mode. Returns -EAGAIN if the chip is not receiving and -EBUSY if another packet
+ * is already being received, in which case both packets are lost.
+ */
+int hal_sx127x_mock_receive_packet(uint32_t length, uint8_t *payload, float rssi, float snr, bool crc_error)
+{
+  int result = 0;
+
+  if (length > sizeof(sx127x_mock.receive_payload)) {
+    return -EINVAL;
+  }
+
+  pthread_mutex_lock(&sx127x_mock.mutex);
+
+  uint8_t mode = sx127x_mock_get_mode();
+  hal_sx127x_mock_event *receive_event = &sx127x_mock.events[HAL_SX127X_MOCK_EVENT_RECEIVE_DONE];
+
+  if (receive_event->pending) {
+    receive_event->pending = false;
+    sx127x_mock.status.lost_packet_count += 2;
+    result = -EBUSY;
+  } else if (mode != SX127X_MODE_RX_CONTINUOUS && mode != SX127X_MODE_RX_SINGLE) {
+    sx127x_mock.status.lost_packet_count++;
+    result = -EAGAIN;
+  } else {
+    float raw_rssi = rssi - SX127X_RSSI_MINIMUM_HF;
+    float raw_snr = snr * 4;
+
+    memcpy(sx127x_mock.receive_payload, payload, length);
+    sx127x_mock.receive_length = length;
+    sx127x_mock.receive_raw_rssi = (uint8_t) (raw_rssi < 0 ? 0 : (raw_rssi > 255 ? 255 : raw_rssi));
+    sx127x_mock.receive_raw_snr = (int8_t) (raw_snr < -128 ? -128 : (raw_snr > 127 ? 127 : raw_snr));
+    sx127x_mock.receive_crc_error = crc_error;
+
+    sx127x_mock_schedule_event(HAL_SX127X_MOCK_EVENT_RECEIVE_DONE, sx127x_mock_get_airtime_micros(length));
+  }
+
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+
+  return result;
+}
+
+/**
+ * Sets whether channel activity detection finds a LoRa preamble on the channel.
+ * Activity is always detected while a packet is being received.
+ */
+void hal_sx127x_mock_set_channel_active(bool channel_active)
+{
+  pthread_mutex_lock(&sx127x_mock.mutex);
+  sx127x_mock.channel_active = channel_active;
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+}
+
+uint8_t hal_sx127x_mock_read_register(uint8_t reg)
+{
+  pthread_mutex_lock(&sx127x_mock.mutex);
+  uint8_t value = sx127x_mock.registers[reg & 0x7F];
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+
+  return value;
+}
+
+void hal_sx127x_mock_get_status(hal_sx127x_mock_status *status)
+{
+  pthread_mutex_lock(&sx127x_mock.mutex);
+  memcpy(status, &sx127x_mock.status, sizeof(hal_sx127x_mock_status));
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+}
+
+void hal_sx127x_mock_reset_status()
+{
+  pthread_mutex_lock(&sx127x_mock.mutex);
+  memset(&sx127x_mock.status, 0, sizeof(hal_sx127x_mock_status));
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+}
+
+static void sx127x_mock_spi_delay()
+{
+  if (sx127x_mock.config.spi_message_delay_micros > 0) {
+    usleep(sx127x_mock.config.spi_message_delay_micros);
+  }
+}
+
+int hal_spi_sx127x_mock_open(int bus, int device, uint32_t speed, uint32_t mode, hal_spi_device **spi_device_rcv)
+{
+  hal_spi_device *spi_device = calloc(1, sizeof(hal_spi_device));
+  if (spi_device == NULL) {
+    ert_log_fatal("Error allocating memory for SPI device struct: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  spi_device->bus = bus;
+  spi_device->device = device;
+  spi_device->speed = speed;
+  spi_device->bits_per_word = 8;
+  spi_device->fd = -1;
+  spi_device->open = true;
+
+  *spi_device_rcv = spi_device;
+
+  return 0;
+}
+
+int hal_spi_sx127x_mock_close(hal_spi_device *spi_device)
+{
+  if (spi_device == NULL) {
+    return 0;
+  }
+
+  spi_device->open = false;
+  free(spi_device);
+
+  return 0;
+}
+
+int hal_spi_sx127x_mock_transfer(hal_spi_device *spi_device, uint32_t length, uint8_t *data)
+{
+  if (!spi_device->open) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&sx127x_mock.mutex);
+
+  for (uint32_t i = 0; i < length; i++) {
+    data[i] = sx127x_mock_exchange(data[i]);
+  }
+  sx127x_mock.frame_started = false;
+
+  sx127x_mock.status.spi_message_count++;
+  sx127x_mock.status.spi_segment_count++;
+  sx127x_mock.status.spi_byte_count += length;
+
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+
+  sx127x_mock_spi_delay();
+
+  return length;
+}
+
+int hal_spi_sx127x_mock_transfer_segments(hal_spi_device *spi_device, uint32_t segment_count,
+    hal_spi_segment *segments)
+{
+  int total_length = 0;
+
+  if (!spi_device->open) {
+    return -1;
+  }
+  if (segment_count == 0 || segment_count > HAL_SPI_SEGMENT_COUNT_MAX) {
+    return -EINVAL;
+  }
+
+  pthread_mutex_lock(&sx127x_mock.mutex);
+
+  for (uint32_t i = 0; i < segment_count; i++) {
+    hal_spi_segment *segment = &segments[i];
+
+    for (uint32_t j = 0; j < segment->length; j++) {
+      uint8_t rx_byte = sx127x_mock_exchange(segment->tx_data != NULL ? segment->tx_data[j] : 0);
+      if (segment->rx_data != NULL) {
+        segment->rx_data[j] = rx_byte;
+      }
+    }
+
+    if (segment->cs_change || i == segment_count - 1) {
+      sx127x_mock.frame_started = false;
+    }
+
+    total_length += segment->length;
+  }
+
+  sx127x_mock.status.spi_message_count++;
+  sx127x_mock.status.spi_segment_count += segment_count;
+  sx127x_mock.status.spi_byte_count += total_length;
+
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+
+  sx127x_mock_spi_delay();
+
+  return total_length;
+}
+
+int hal_gpio_sx127x_mock_init()
+{
+  return 0;
+}
+
+int hal_gpio_sx127x_mock_uninit()
+{
+  return 0;
+}
+
+int hal_gpio_sx127x_mock_pin_mode(uint16_t pin, uint8_t mode)
+{
+  return (pin < HAL_SX127X_MOCK_PIN_COUNT) ? 0 : -1;
+}
+
+int hal_gpio_sx127x_mock_pin_read(uint16_t pin, bool *value)
+{
+  pthread_mutex_lock(&sx127x_mock.mutex);
+
+  if (pin == sx127x_mock.config.pin_dio0) {
+    *value = sx127x_mock_is_dio0_active();
+  } else if (pin == sx127x_mock.config.pin_dio5) {
+    *value = !sx127x_mock.events[HAL_SX127X_MOCK_EVENT_MODE_READY].pending;
+  } else {
+    *value = false;
+  }
+
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+
+  return 0;
+}
+
+int hal_gpio_sx127x_mock_pin_write(uint16_t pin, bool value)
+{
+  return 0;
+}
+
+int hal_gpio_sx127x_mock_pin_isr(uint16_t pin, uint8_t edge, hal_gpio_isr function, void *data)
+{
+  if (pin >= HAL_SX127X_MOCK_PIN_COUNT) {
+    return -1;
+  }
+
+  pthread_mutex_lock(&sx127x_mock.mutex);
+  sx127x_mock.isr_functions[pin] = function;
+  sx127x_mock.isr_data[pin] = data;
+  pthread_mutex_unlock(&sx127x_mock.mutex);
+
+  return 0;
+}
+
+hal_spi_driver hal_spi_driver_sx127x_mock = {
+  .open = hal_spi_sx127x_mock_open,
+  .close = hal_spi_sx127x_mock_close,
+  .transfer = hal_spi_sx127x_mock_transfer,
+  .transfer_segments = hal_spi_sx127x_mock_transfer_segments
+};
+
+hal_gpio_driver hal_gpio_driver_sx127x_mock = {
+    .init = hal_gpio_sx127x_mock_init,
+    .uninit = hal_gpio_sx127x_mock_uninit,
+    .pin_mode = hal_gpio_sx127x_mock_pin_mode,
+    .pin_read = hal_gpio_sx127x_mock_pin_read,
+    .pin_write = hal_gpio_sx127x_mock_pin_write,
+    .pin_isr = hal_gpio_sx127x_mock_pin_isr
+};
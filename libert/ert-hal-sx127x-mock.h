@@ -0,0 +1,78 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ERT_HAL_SX127X_MOCK_H
+#define __ERT_HAL_SX127X_MOCK_H
+
+#include <time.h>
+
+#include "ert-hal-common.h"
+#include "ert-hal-spi.h"
+#include "ert-hal-gpio.h"
+
+#define HAL_SX127X_MOCK_PIN_COUNT 64
+#define HAL_SX127X_MOCK_PIN_DIO0_DEFAULT 7
+#define HAL_SX127X_MOCK_PIN_DIO5_DEFAULT 0
+
+typedef void (*hal_sx127x_mock_transmit_callback)(void *callback_context, uint32_t length, uint8_t *payload);
+
+/**
+ * Timing of the emulated SX127x chip. Time on air is calculated from the LoRa modem configuration registers and
+ * multiplied by time_scale, so that a time scale of 0 completes transmissions immediately.
+ */
+typedef struct _hal_sx127x_mock_config {
+  uint16_t pin_dio0;
+  uint16_t pin_dio5;
+
+  // Delay from writing the operating mode register to the ModeReady interrupt on DIO5
+  uint32_t mode_change_delay_micros;
+  // Delay added to each SPI message, modeling system call and bus transfer overhead
+  uint32_t spi_message_delay_micros;
+  // Duration of channel activity detection
+  uint32_t cad_delay_micros;
+  double time_scale;
+
+  // Called from the interrupt thread with the payload of each completed transmission
+  hal_sx127x_mock_transmit_callback transmit_callback;
+  void *callback_context;
+} hal_sx127x_mock_config;
+
+typedef struct _hal_sx127x_mock_status {
+  // Each SPI message is a single system call with the Linux spidev driver
+  uint64_t spi_message_count;
+  uint64_t spi_segment_count;
+  uint64_t spi_byte_count;
+
+  uint64_t dio0_interrupt_count;
+  uint64_t dio5_interrupt_count;
+
+  uint64_t transmitted_packet_count;
+  uint64_t received_packet_count;
+  // Packets that arrived while the chip was not receiving or that overlapped another packet
+  uint64_t lost_packet_count;
+
+  // Time when DIO0 was last raised, before the interrupt handler was called
+  struct timespec last_dio0_interrupt_timestamp;
+} hal_sx127x_mock_status;
+
+void hal_sx127x_mock_create_default_config(hal_sx127x_mock_config *config);
+int hal_sx127x_mock_init(hal_sx127x_mock_config *config);
+int hal_sx127x_mock_uninit();
+
+int hal_sx127x_mock_receive_packet(uint32_t length, uint8_t *payload, float rssi, float snr, bool crc_error);
+void hal_sx127x_mock_set_channel_active(bool channel_active);
+uint8_t hal_sx127x_mock_read_register(uint8_t reg);
+void hal_sx127x_mock_get_status(hal_sx127x_mock_status *status);
+void hal_sx127x_mock_reset_status();
+
+extern hal_spi_driver hal_spi_driver_sx127x_mock;
+extern hal_gpio_driver hal_gpio_driver_sx127x_mock;
+
+#endif
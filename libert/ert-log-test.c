@@ -0,0 +1,80 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "ert-log.h"
+#include "ert-test.h"
+
+static int evaluation_count = 0;
+
+static int ert_log_test_evaluate()
+{
+  return ++evaluation_count;
+}
+
+void ert_log_test_run_test_levels()
+{
+  ert_log_level original_level = ert_log_get_level();
+
+  ert_log_set_level(ERT_LOG_LEVEL_WARN);
+  assert(ert_log_get_level() == ERT_LOG_LEVEL_WARN);
+  assert(!ert_log_is_enabled(ERT_LOG_LEVEL_INFO));
+  assert(ert_log_is_enabled(ERT_LOG_LEVEL_WARN));
+  assert(ert_log_is_enabled(ERT_LOG_LEVEL_ERROR));
+
+  // Arguments of disabled messages are never evaluated
+  evaluation_count = 0;
+  ert_log_info("Not logged: %d", ert_log_test_evaluate());
+  ert_log_notice("Not logged: %d", ert_log_test_evaluate());
+  ert_log_debug("Not logged: %d", ert_log_test_evaluate());
+  ert_log_trace("Not logged: %d", ert_log_test_evaluate());
+  assert(evaluation_count == 0);
+
+  ert_log_warn("Logged: %d", ert_log_test_evaluate());
+  assert(evaluation_count == 1);
+
+  // Errors cannot be disabled
+  ert_log_set_level(ERT_LOG_LEVEL_FATAL);
+  assert(ert_log_get_level() == ERT_LOG_LEVEL_ERROR);
+  assert(ert_log_is_enabled(ERT_LOG_LEVEL_ERROR));
+
+  // Debug and trace messages are enabled at runtime only if they have been compiled in
+  ert_log_set_level(ERT_LOG_LEVEL_TRACE);
+#ifdef ERTLIB_ENABLE_LOG_DEBUG
+  assert(ert_log_is_enabled(ERT_LOG_LEVEL_DEBUG));
+#else
+  assert(!ert_log_is_enabled(ERT_LOG_LEVEL_DEBUG));
+#endif
+#ifdef ERTLIB_ENABLE_LOG_TRACE
+  assert(ert_log_is_enabled(ERT_LOG_LEVEL_TRACE));
+#else
+  assert(!ert_log_is_enabled(ERT_LOG_LEVEL_TRACE));
+#endif
+
+  ert_log_set_level(original_level);
+}
+
+int main(void)
+{
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_log_test_run_test_levels();
+
+  ert_log_info("Tests finished successfully");
+
+  ert_test_uninit();
+
+  return EXIT_SUCCESS;
+}
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <zlog.h>
 
@@ -20,9 +21,59 @@ struct _ert_log_logger {
   zlog_category_t *category;
 };
 
+ert_log_level ert_log_minimum_level = ERT_LOG_LEVEL_DEBUG;
+
+#define ERT_LOG_LEVEL_COUNT 7
+
+static uint32_t ert_log_message_counts[ERT_LOG_LEVEL_COUNT];
+
+static const struct {
+  const char *name;
+  ert_log_level level;
+} ert_log_level_names[] = {
+    { "trace", ERT_LOG_LEVEL_TRACE },
+    { "debug", ERT_LOG_LEVEL_DEBUG },
+    { "info", ERT_LOG_LEVEL_INFO },
+    { "notice", ERT_LOG_LEVEL_NOTICE },
+    { "warn", ERT_LOG_LEVEL_WARN },
+    { "error", ERT_LOG_LEVEL_ERROR },
+};
+
 int ert_log_init(const char *log_config_file)
 {
-  return dzlog_init(log_config_file, "ert");
+  int result = dzlog_init(log_config_file, "ert");
+
+  const char *level_name = getenv("ERT_LOG_LEVEL");
+  if (level_name != NULL) {
+    bool found = false;
+    for (size_t i = 0; i < sizeof(ert_log_level_names) / sizeof(ert_log_level_names[0]); i++) {
+      if (strcasecmp(level_name, ert_log_level_names[i].name) == 0) {
+        ert_log_set_level(ert_log_level_names[i].level);
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      ert_log_warn("Ignoring invalid log level in ERT_LOG_LEVEL: %s", level_name);
+    }
+  }
+
+  return result;
+}
+
+void ert_log_set_level(ert_log_level level)
+{
+  // Errors are always logged
+  if (level > ERT_LOG_LEVEL_ERROR) {
+    level = ERT_LOG_LEVEL_ERROR;
+  }
+
+  ert_log_minimum_level = level;
+}
+
+ert_log_level ert_log_get_level()
+{
+  return ert_log_minimum_level;
 }
 
 int ert_log_uninit()
@@ -31,8 +82,37 @@ int ert_log_uninit()
   return 0;
 }
 
+static inline size_t ert_log_get_level_index(ert_log_level level)
+{
+  switch (level) {
+    case ERT_LOG_LEVEL_TRACE:
+      return 0;
+    case ERT_LOG_LEVEL_DEBUG:
+      return 1;
+    case ERT_LOG_LEVEL_INFO:
+      return 2;
+    case ERT_LOG_LEVEL_NOTICE:
+      return 3;
+    case ERT_LOG_LEVEL_WARN:
+      return 4;
+    case ERT_LOG_LEVEL_ERROR:
+      return 5;
+    default:
+      return 6;
+  }
+}
+
+/**
+ * Returns the number of messages logged with the given level, so that tests can verify that no warnings were logged.
+ */
+uint32_t ert_log_get_message_count(ert_log_level level)
+{
+  return __atomic_load_n(&ert_log_message_counts[ert_log_get_level_index(level)], __ATOMIC_RELAXED);
+}
+
 static inline int ert_log_convert_to_zlog_level(ert_log_level level) {
   switch (level) {
+    case ERT_LOG_LEVEL_TRACE:
     case ERT_LOG_LEVEL_DEBUG:
       return ZLOG_LEVEL_DEBUG;
     case ERT_LOG_LEVEL_INFO:
@@ -55,6 +135,8 @@ void ert_log(const char *file, size_t filelen, const char *func, size_t funclen,
 {
   va_list argp;
 
+  __atomic_fetch_add(&ert_log_message_counts[ert_log_get_level_index(level)], 1, __ATOMIC_RELAXED);
+
   int zlog_level = ert_log_convert_to_zlog_level(level);
   va_start(argp, format);
   vdzlog(file, filelen, func, funclen, line, zlog_level, format, argp);
@@ -93,6 +175,8 @@ void ert_log_logger_log(ert_log_logger *logger, const char *file, size_t filelen
 {
   va_list argp;
 
+  __atomic_fetch_add(&ert_log_message_counts[ert_log_get_level_index(level)], 1, __ATOMIC_RELAXED);
+
   int zlog_level = ert_log_convert_to_zlog_level(level);
   va_start(argp, format);
   vzlog(logger->category, file, filelen, func, funclen, line, zlog_level, format, argp);
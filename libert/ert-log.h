@@ -14,6 +14,7 @@
 #include "ert-common.h"
 
 typedef enum _ert_log_level {
+  ERT_LOG_LEVEL_TRACE = 5,
   ERT_LOG_LEVEL_DEBUG = 10,
   ERT_LOG_LEVEL_INFO = 20,
   ERT_LOG_LEVEL_NOTICE = 30,
@@ -28,9 +29,19 @@ typedef struct _ert_log_logger ert_log_logger;
 extern "C" {
 #endif
 
+/**
+ * Messages of the default category below this level are discarded before their arguments are evaluated.
+ * Set by ert_log_init from the ERT_LOG_LEVEL environment variable (trace, debug, info, notice, warn or error).
+ */
+extern ert_log_level ert_log_minimum_level;
+
 int ert_log_init(const char *log_config_file);
 int ert_log_uninit();
 
+void ert_log_set_level(ert_log_level level);
+ert_log_level ert_log_get_level();
+uint32_t ert_log_get_message_count(ert_log_level level);
+
 void ert_log(const char *file, size_t filelen, const char *func, size_t funclen, long line, ert_log_level level,
     const char *format, ...);
 
@@ -43,25 +54,41 @@ void ert_log_logger_log(ert_log_logger *logger, const char *file, size_t filelen
 }
 #endif
 
+/**
+ * Returns true if messages of the given level are compiled in and enabled at runtime. With a constant level
+ * the compile-time part folds away, so a disabled level costs a single comparison.
+ */
+static inline bool ert_log_is_enabled(ert_log_level level)
+{
+#ifndef ERTLIB_ENABLE_LOG_TRACE
+  if (level == ERT_LOG_LEVEL_TRACE) {
+    return false;
+  }
+#endif
+#ifndef ERTLIB_ENABLE_LOG_DEBUG
+  if (level == ERT_LOG_LEVEL_DEBUG) {
+    return false;
+  }
+#endif
+  return level >= ert_log_minimum_level;
+}
+
 #define ert_log_with_level(level, ...) \
-	ert_log(__FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
-	level, __VA_ARGS__)
+	(ert_log_is_enabled(level) \
+	? ert_log(__FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
+	level, __VA_ARGS__) : (void) 0)
 
 #define ert_log_fatal(...) \
 	ert_log(__FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
 	ERT_LOG_LEVEL_FATAL, __VA_ARGS__)
 #define ert_log_error(...) \
-	ert_log(__FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
-	ERT_LOG_LEVEL_ERROR, __VA_ARGS__)
+	ert_log_with_level(ERT_LOG_LEVEL_ERROR, __VA_ARGS__)
 #define ert_log_warn(...) \
-	ert_log(__FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
-	ERT_LOG_LEVEL_WARN, __VA_ARGS__)
+	ert_log_with_level(ERT_LOG_LEVEL_WARN, __VA_ARGS__)
 #define ert_log_notice(...) \
-	ert_log(__FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
-	ERT_LOG_LEVEL_NOTICE, __VA_ARGS__)
+	ert_log_with_level(ERT_LOG_LEVEL_NOTICE, __VA_ARGS__)
 #define ert_log_info(...) \
-	ert_log(__FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
-	ERT_LOG_LEVEL_INFO, __VA_ARGS__)
+	ert_log_with_level(ERT_LOG_LEVEL_INFO, __VA_ARGS__)
 
 #define ert_logl_with_level(logger, level, ...) \
 	ert_log_logger_log(logger, __FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
@@ -85,14 +112,21 @@ void ert_log_logger_log(ert_log_logger *logger, const char *file, size_t filelen
 
 #ifdef ERTLIB_ENABLE_LOG_DEBUG
 #define ert_log_debug(...) \
-	ert_log(__FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
-	ERT_LOG_LEVEL_DEBUG, __VA_ARGS__)
+	ert_log_with_level(ERT_LOG_LEVEL_DEBUG, __VA_ARGS__)
 #define ert_logl_debug(logger, ...) \
-	ert_log(logger, __FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
+	ert_log_logger_log(logger, __FILE__, sizeof(__FILE__)-1, __func__, sizeof(__func__)-1, __LINE__, \
 	ERT_LOG_LEVEL_DEBUG, __VA_ARGS__)
 #else
 #define ert_log_debug(...)
 #define ert_logl_debug(...)
 #endif
 
+// Per-packet trace points, compiled out entirely unless ERTLIB_ENABLE_LOG_TRACE is defined
+#ifdef ERTLIB_ENABLE_LOG_TRACE
+#define ert_log_trace(...) \
+	ert_log_with_level(ERT_LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
+#define ert_log_trace(...)
+#endif
+
 #endif
@@ -55,6 +55,14 @@ ssize_t ert_pipe_pop_timed(ert_pipe *pipe, void *target, size_t count, uint32_t
   return pipe_pop_timed(pipe->consumer, target, count, (size_t) timeout_milliseconds);
 }
 
+/**
+ * Waits for at least one element and pops up to count elements that are available without waiting further.
+ */
+ssize_t ert_pipe_pop_available_timed(ert_pipe *pipe, void *target, size_t count, uint32_t timeout_milliseconds)
+{
+  return pipe_pop_eager_timed(pipe->consumer, target, count, (size_t) timeout_milliseconds);
+}
+
 int ert_pipe_close(ert_pipe *pipe)
 {
   pipe_producer_free(pipe->producer);
@@ -23,6 +23,7 @@ int ert_pipe_create(size_t element_size, size_t limit, ert_pipe **pipe_rcv);
 int ert_pipe_push(ert_pipe *pipe, void *elements, size_t count);
 size_t ert_pipe_pop(ert_pipe *pipe, void *target, size_t count);
 ssize_t ert_pipe_pop_timed(ert_pipe *pipe, void *target, size_t count, uint32_t timeout_milliseconds);
+ssize_t ert_pipe_pop_available_timed(ert_pipe *pipe, void *target, size_t count, uint32_t timeout_milliseconds);
 int ert_pipe_close(ert_pipe *pipe);
 int ert_pipe_destroy(ert_pipe *pipe);
 
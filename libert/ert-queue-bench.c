@@ -0,0 +1,180 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+ * Throughput benchmark for packet metadata queues: producer threads push packet-sized queue entries that a single
+ * consumer thread pops, first through ert_pipe one element at a time as the transceiver used to do, and then through
+ * ert_queue with single-element and batched operations.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "ert-pipe.h"
+#include "ert-queue.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define BENCH_QUEUE_CAPACITY 64
+#define BENCH_ELEMENT_COUNT_DEFAULT 4000000
+#define BENCH_PRODUCER_COUNT 2
+#define BENCH_BATCH_COUNT 16
+
+typedef struct _ert_queue_bench_entry {
+  uint32_t id;
+  uint32_t length;
+  uint8_t *buffer;
+  struct timespec queued_timestamp;
+} ert_queue_bench_entry;
+
+typedef enum _ert_queue_bench_type {
+  ERT_QUEUE_BENCH_TYPE_PIPE = 0,
+  ERT_QUEUE_BENCH_TYPE_QUEUE,
+  ERT_QUEUE_BENCH_TYPE_QUEUE_BATCH,
+} ert_queue_bench_type;
+
+static const char *ert_queue_bench_type_names[] = { "pipe", "queue", "queue_batch" };
+
+typedef struct _ert_queue_bench_context {
+  ert_queue_bench_type type;
+  uint64_t element_count_per_producer;
+  ert_pipe *pipe;
+  ert_queue *queue;
+} ert_queue_bench_context;
+
+static void *ert_queue_bench_producer(void *arg)
+{
+  ert_queue_bench_context *context = (ert_queue_bench_context *) arg;
+  ert_queue_bench_entry entries[BENCH_BATCH_COUNT] = {0};
+  size_t batch_count = (context->type == ERT_QUEUE_BENCH_TYPE_QUEUE_BATCH) ? BENCH_BATCH_COUNT : 1;
+
+  for (uint64_t i = 0; i < context->element_count_per_producer; i += batch_count) {
+    switch (context->type) {
+      case ERT_QUEUE_BENCH_TYPE_PIPE:
+        ert_pipe_push(context->pipe, entries, 1);
+        break;
+      default:
+        ert_queue_push(context->queue, entries, batch_count, ERT_QUEUE_WAIT_FOREVER);
+        break;
+    }
+  }
+
+  return NULL;
+}
+
+static int ert_queue_bench_run(ert_queue_bench_type type, uint64_t element_count)
+{
+  ert_queue_bench_context context = {0};
+  ert_queue_bench_entry entries[BENCH_BATCH_COUNT];
+  pthread_t threads[BENCH_PRODUCER_COUNT];
+  struct timespec start_time, end_time;
+  struct timespec start_cpu_time, end_cpu_time;
+  int result;
+
+  context.type = type;
+  context.element_count_per_producer = element_count / BENCH_PRODUCER_COUNT;
+  context.element_count_per_producer -= context.element_count_per_producer % BENCH_BATCH_COUNT;
+  uint64_t total_count = context.element_count_per_producer * BENCH_PRODUCER_COUNT;
+
+  if (type == ERT_QUEUE_BENCH_TYPE_PIPE) {
+    result = ert_pipe_create(sizeof(ert_queue_bench_entry), BENCH_QUEUE_CAPACITY, &context.pipe);
+  } else {
+    result = ert_queue_create(sizeof(ert_queue_bench_entry), BENCH_QUEUE_CAPACITY, &context.queue);
+  }
+  if (result < 0) {
+    return result;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start_cpu_time);
+
+  for (size_t i = 0; i < BENCH_PRODUCER_COUNT; i++) {
+    result = pthread_create(&threads[i], NULL, ert_queue_bench_producer, &context);
+    if (result != 0) {
+      ert_log_error("Error starting producer thread, result %d", result);
+      return -EIO;
+    }
+  }
+
+  uint64_t popped_count = 0;
+  while (popped_count < total_count) {
+    ssize_t count;
+    switch (type) {
+      case ERT_QUEUE_BENCH_TYPE_PIPE:
+        count = (ssize_t) ert_pipe_pop(context.pipe, entries, 1);
+        break;
+      case ERT_QUEUE_BENCH_TYPE_QUEUE:
+        count = ert_queue_pop(context.queue, entries, 1, ERT_QUEUE_WAIT_FOREVER);
+        break;
+      default:
+        count = ert_queue_pop(context.queue, entries, BENCH_BATCH_COUNT, ERT_QUEUE_WAIT_FOREVER);
+        break;
+    }
+    if (count <= 0) {
+      ert_log_error("Error popping elements, result %d", count);
+      return -EIO;
+    }
+    popped_count += (uint64_t) count;
+  }
+
+  for (size_t i = 0; i < BENCH_PRODUCER_COUNT; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &end_cpu_time);
+
+  double elapsed_millis = (double) (end_time.tv_sec - start_time.tv_sec) * 1000.0
+      + (double) (end_time.tv_nsec - start_time.tv_nsec) / 1000000.0;
+  double cpu_millis = (double) (end_cpu_time.tv_sec - start_cpu_time.tv_sec) * 1000.0
+      + (double) (end_cpu_time.tv_nsec - start_cpu_time.tv_nsec) / 1000000.0;
+
+  printf("queue=%s producers=%d elements=%" PRIu64 " elapsed_ms=%.3f cpu_ms=%.3f ns_per_element=%.1f "
+      "cpu_ns_per_element=%.1f\n",
+      ert_queue_bench_type_names[type], BENCH_PRODUCER_COUNT, total_count, elapsed_millis, cpu_millis,
+      elapsed_millis * 1000000.0 / (double) total_count, cpu_millis * 1000000.0 / (double) total_count);
+  fflush(stdout);
+
+  if (type == ERT_QUEUE_BENCH_TYPE_PIPE) {
+    ert_pipe_close(context.pipe);
+    ert_pipe_destroy(context.pipe);
+  } else {
+    ert_queue_destroy(context.queue);
+  }
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  uint64_t element_count = BENCH_ELEMENT_COUNT_DEFAULT;
+  int result = 0;
+
+  if (argc > 1) {
+    element_count = strtoull(argv[1], NULL, 10);
+  }
+
+  ert_test_init();
+
+  for (int type = ERT_QUEUE_BENCH_TYPE_PIPE; type <= ERT_QUEUE_BENCH_TYPE_QUEUE_BATCH; type++) {
+    result = ert_queue_bench_run((ert_queue_bench_type) type, element_count);
+    if (result < 0) {
+      break;
+    }
+  }
+
+  ert_test_uninit();
+
+  return (result < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,296 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "ert-queue.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define QUEUE_TEST_CAPACITY 12
+#define QUEUE_TEST_WAIT_MILLIS 100
+#define QUEUE_TEST_PRODUCER_COUNT 4
+#define QUEUE_TEST_CONSUMER_COUNT 3
+#define QUEUE_TEST_ELEMENTS_PER_PRODUCER 200000
+#define QUEUE_TEST_MAX_BATCH 7
+
+typedef struct _ert_queue_test_element {
+  uint32_t producer;
+  uint32_t sequence;
+} ert_queue_test_element;
+
+typedef struct _ert_queue_test_thread_context {
+  ert_queue *queue;
+  uint32_t index;
+  uint64_t sequence_sum;
+  uint32_t element_count;
+  uint32_t last_sequence[QUEUE_TEST_PRODUCER_COUNT];
+} ert_queue_test_thread_context;
+
+static uint32_t ert_queue_test_elapsed_millis(struct timespec *start_time)
+{
+  struct timespec end_time;
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+  return (uint32_t) ((end_time.tv_sec - start_time->tv_sec) * 1000
+      + (end_time.tv_nsec - start_time->tv_nsec) / 1000000);
+}
+
+void ert_queue_test_run_test_push_pop()
+{
+  ert_queue *queue;
+  uint32_t elements[40];
+  uint32_t popped[40];
+  struct timespec start_time;
+  ssize_t count;
+  int result;
+
+  for (uint32_t i = 0; i < 40; i++) {
+    elements[i] = i;
+  }
+
+  result = ert_queue_create(sizeof(uint32_t), 0, &queue);
+  assert(result == -EINVAL);
+
+  // The capacity is rounded up to a power of two
+  result = ert_queue_create(sizeof(uint32_t), QUEUE_TEST_CAPACITY, &queue);
+  assert(result == 0);
+  assert(queue->capacity == 16);
+  assert(ert_queue_get_count(queue) == 0);
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  count = ert_queue_pop(queue, popped, 1, QUEUE_TEST_WAIT_MILLIS);
+  assert(count == -ETIMEDOUT);
+  assert(ert_queue_test_elapsed_millis(&start_time) >= QUEUE_TEST_WAIT_MILLIS - 1);
+
+  count = ert_queue_pop(queue, popped, 1, 0);
+  assert(count == -ETIMEDOUT);
+
+  count = ert_queue_push(queue, elements, 10, 0);
+  assert(count == 10);
+  assert(ert_queue_get_count(queue) == 10);
+
+  // Popping returns the available elements without waiting for the requested count
+  count = ert_queue_pop(queue, popped, 40, ERT_QUEUE_WAIT_FOREVER);
+  assert(count == 10);
+  assert(memcmp(popped, elements, 10 * sizeof(uint32_t)) == 0);
+
+  // Batches wrap around the end of the ring
+  count = ert_queue_push(queue, elements, 12, 0);
+  assert(count == 12);
+  count = ert_queue_pop(queue, popped, 5, 0);
+  assert(count == 5);
+  assert(memcmp(popped, elements, 5 * sizeof(uint32_t)) == 0);
+  count = ert_queue_pop(queue, popped, 7, 0);
+  assert(count == 7);
+  assert(memcmp(popped, elements + 5, 7 * sizeof(uint32_t)) == 0);
+
+  // A full queue accepts only as many elements as there is room for before the timeout
+  count = ert_queue_push(queue, elements, 20, QUEUE_TEST_WAIT_MILLIS);
+  assert(count == 16);
+  count = ert_queue_push(queue, elements, 1, 0);
+  assert(count == -ETIMEDOUT);
+
+  // Closing lets consumers drain the queue
+  result = ert_queue_close(queue);
+  assert(result == 0);
+  count = ert_queue_push(queue, elements, 1, 0);
+  assert(count == -EPIPE);
+  count = ert_queue_pop(queue, popped, 40, ERT_QUEUE_WAIT_FOREVER);
+  assert(count == 16);
+  assert(memcmp(popped, elements, 16 * sizeof(uint32_t)) == 0);
+  count = ert_queue_pop(queue, popped, 40, ERT_QUEUE_WAIT_FOREVER);
+  assert(count == 0);
+
+  ert_queue_destroy(queue);
+}
+
+static void *ert_queue_test_closer(void *context)
+{
+  ert_queue *queue = (ert_queue *) context;
+
+  usleep(QUEUE_TEST_WAIT_MILLIS * 1000 / 2);
+  ert_queue_close(queue);
+
+  return NULL;
+}
+
+void ert_queue_test_run_test_close_wakes_waiters()
+{
+  ert_queue *queue;
+  pthread_t thread;
+  struct timespec start_time;
+  uint32_t element = 1;
+  int result;
+
+  result = ert_queue_create(sizeof(uint32_t), 1, &queue);
+  assert(result == 0);
+
+  result = pthread_create(&thread, NULL, ert_queue_test_closer, queue);
+  assert(result == 0);
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  ssize_t count = ert_queue_pop(queue, &element, 1, ERT_QUEUE_WAIT_FOREVER);
+  assert(count == 0);
+  assert(ert_queue_test_elapsed_millis(&start_time) < 5 * QUEUE_TEST_WAIT_MILLIS);
+  pthread_join(thread, NULL);
+  ert_queue_destroy(queue);
+
+  // A producer blocked on a full queue is woken up too
+  result = ert_queue_create(sizeof(uint32_t), 1, &queue);
+  assert(result == 0);
+  count = ert_queue_push(queue, &element, 1, 0);
+  assert(count == 1);
+
+  result = pthread_create(&thread, NULL, ert_queue_test_closer, queue);
+  assert(result == 0);
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  count = ert_queue_push(queue, &element, 1, ERT_QUEUE_WAIT_FOREVER);
+  assert(count == -EPIPE);
+  assert(ert_queue_test_elapsed_millis(&start_time) < 5 * QUEUE_TEST_WAIT_MILLIS);
+  pthread_join(thread, NULL);
+  ert_queue_destroy(queue);
+}
+
+static void *ert_queue_test_producer(void *context)
+{
+  ert_queue_test_thread_context *thread_context = (ert_queue_test_thread_context *) context;
+  ert_queue_test_element elements[QUEUE_TEST_MAX_BATCH];
+  uint32_t sequence = 0;
+  uint32_t random_state = thread_context->index + 1;
+
+  while (sequence < QUEUE_TEST_ELEMENTS_PER_PRODUCER) {
+    random_state = random_state * 1103515245 + 12345;
+    uint32_t batch_count = 1 + (random_state >> 16) % QUEUE_TEST_MAX_BATCH;
+    if (batch_count > QUEUE_TEST_ELEMENTS_PER_PRODUCER - sequence) {
+      batch_count = QUEUE_TEST_ELEMENTS_PER_PRODUCER - sequence;
+    }
+
+    for (uint32_t i = 0; i < batch_count; i++) {
+      elements[i].producer = thread_context->index;
+      elements[i].sequence = sequence + i;
+    }
+
+    ssize_t count = ert_queue_push(thread_context->queue, elements, batch_count, ERT_QUEUE_WAIT_FOREVER);
+    assert(count == batch_count);
+
+    sequence += batch_count;
+  }
+
+  return NULL;
+}
+
+static void *ert_queue_test_consumer(void *context)
+{
+  ert_queue_test_thread_context *thread_context = (ert_queue_test_thread_context *) context;
+  ert_queue_test_element elements[QUEUE_TEST_MAX_BATCH];
+
+  for (uint32_t i = 0; i < QUEUE_TEST_PRODUCER_COUNT; i++) {
+    thread_context->last_sequence[i] = UINT32_MAX;
+  }
+
+  while (true) {
+    ssize_t count = ert_queue_pop(thread_context->queue, elements, QUEUE_TEST_MAX_BATCH, ERT_QUEUE_WAIT_FOREVER);
+    assert(count >= 0);
+    if (count == 0) {
+      break;
+    }
+
+    for (ssize_t i = 0; i < count; i++) {
+      uint32_t producer = elements[i].producer;
+      assert(producer < QUEUE_TEST_PRODUCER_COUNT);
+
+      // Each consumer sees the elements of a producer in the order they were pushed
+      uint32_t last_sequence = thread_context->last_sequence[producer];
+      assert(last_sequence == UINT32_MAX || elements[i].sequence > last_sequence);
+      thread_context->last_sequence[producer] = elements[i].sequence;
+
+      thread_context->sequence_sum += elements[i].sequence;
+      thread_context->element_count++;
+    }
+  }
+
+  return NULL;
+}
+
+void ert_queue_test_run_test_concurrent()
+{
+  ert_queue_test_thread_context producer_contexts[QUEUE_TEST_PRODUCER_COUNT] = {0};
+  ert_queue_test_thread_context consumer_contexts[QUEUE_TEST_CONSUMER_COUNT] = {0};
+  pthread_t producer_threads[QUEUE_TEST_PRODUCER_COUNT];
+  pthread_t consumer_threads[QUEUE_TEST_CONSUMER_COUNT];
+  ert_queue *queue;
+  int result;
+
+  result = ert_queue_create(sizeof(ert_queue_test_element), QUEUE_TEST_CAPACITY, &queue);
+  assert(result == 0);
+
+  for (uint32_t i = 0; i < QUEUE_TEST_CONSUMER_COUNT; i++) {
+    consumer_contexts[i].queue = queue;
+    consumer_contexts[i].index = i;
+    result = pthread_create(&consumer_threads[i], NULL, ert_queue_test_consumer, &consumer_contexts[i]);
+    assert(result == 0);
+  }
+  for (uint32_t i = 0; i < QUEUE_TEST_PRODUCER_COUNT; i++) {
+    producer_contexts[i].queue = queue;
+    producer_contexts[i].index = i;
+    result = pthread_create(&producer_threads[i], NULL, ert_queue_test_producer, &producer_contexts[i]);
+    assert(result == 0);
+  }
+
+  for (uint32_t i = 0; i < QUEUE_TEST_PRODUCER_COUNT; i++) {
+    pthread_join(producer_threads[i], NULL);
+  }
+  ert_queue_close(queue);
+
+  uint64_t sequence_sum = 0;
+  uint64_t element_count = 0;
+  for (uint32_t i = 0; i < QUEUE_TEST_CONSUMER_COUNT; i++) {
+    pthread_join(consumer_threads[i], NULL);
+    sequence_sum += consumer_contexts[i].sequence_sum;
+    element_count += consumer_contexts[i].element_count;
+  }
+
+  // Every element was popped exactly once
+  uint64_t expected_sequence_sum = (uint64_t) QUEUE_TEST_PRODUCER_COUNT
+      * ((uint64_t) QUEUE_TEST_ELEMENTS_PER_PRODUCER * (QUEUE_TEST_ELEMENTS_PER_PRODUCER - 1) / 2);
+  assert(element_count == (uint64_t) QUEUE_TEST_PRODUCER_COUNT * QUEUE_TEST_ELEMENTS_PER_PRODUCER);
+  assert(sequence_sum == expected_sequence_sum);
+  assert(ert_queue_get_count(queue) == 0);
+
+  ert_queue_destroy(queue);
+}
+
+int main(void)
+{
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_queue_test_run_test_push_pop();
+
+  ert_queue_test_run_test_close_wakes_waiters();
+
+  ert_queue_test_run_test_concurrent();
+
+  ert_log_info("Tests finished successfully");
+
+  ert_test_uninit();
+
+  return EXIT_SUCCESS;
+}
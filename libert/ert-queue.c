@@ -0,0 +1,290 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ert-queue.h"
+#include "ert-time.h"
+#include "ert-log.h"
+
+int ert_queue_create(size_t element_size, size_t capacity, ert_queue **queue_rcv)
+{
+  if (element_size == 0 || capacity == 0) {
+    ert_log_error("Invalid queue element size %d or capacity %d", element_size, capacity);
+    return -EINVAL;
+  }
+
+  ert_queue *queue = calloc(1, sizeof(ert_queue));
+  if (queue == NULL) {
+    ert_log_fatal("Error allocating memory for queue struct: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  size_t rounded_capacity = 1;
+  while (rounded_capacity < capacity) {
+    rounded_capacity <<= 1;
+  }
+
+  queue->buffer = malloc(rounded_capacity * element_size);
+  if (queue->buffer == NULL) {
+    free(queue);
+    ert_log_fatal("Error allocating memory for queue elements: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  int result = pthread_mutex_init(&queue->mutex, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing queue mutex, result %d", result);
+    goto error_buffer;
+  }
+  result = pthread_cond_init(&queue->not_empty_cond, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing queue condition, result %d", result);
+    goto error_mutex;
+  }
+  result = pthread_cond_init(&queue->not_full_cond, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing queue condition, result %d", result);
+    goto error_not_empty_cond;
+  }
+
+  queue->element_size = element_size;
+  queue->capacity = rounded_capacity;
+  queue->mask = rounded_capacity - 1;
+
+  *queue_rcv = queue;
+
+  return 0;
+
+  error_not_empty_cond:
+  pthread_cond_destroy(&queue->not_empty_cond);
+
+  error_mutex:
+  pthread_mutex_destroy(&queue->mutex);
+
+  error_buffer:
+  free(queue->buffer);
+  free(queue);
+
+  return -EIO;
+}
+
+static void ert_queue_copy_in(ert_queue *queue, const uint8_t *elements, size_t count)
+{
+  size_t index = queue->tail & queue->mask;
+  size_t first_count = queue->capacity - index;
+  if (first_count > count) {
+    first_count = count;
+  }
+
+  memcpy(queue->buffer + index * queue->element_size, elements, first_count * queue->element_size);
+  if (count > first_count) {
+    memcpy(queue->buffer, elements + first_count * queue->element_size,
+        (count - first_count) * queue->element_size);
+  }
+
+  queue->tail += count;
+}
+
+static void ert_queue_copy_out(ert_queue *queue, uint8_t *target, size_t count)
+{
+  size_t index = queue->head & queue->mask;
+  size_t first_count = queue->capacity - index;
+  if (first_count > count) {
+    first_count = count;
+  }
+
+  memcpy(target, queue->buffer + index * queue->element_size, first_count * queue->element_size);
+  if (count > first_count) {
+    memcpy(target + first_count * queue->element_size, queue->buffer,
+        (count - first_count) * queue->element_size);
+  }
+
+  queue->head += count;
+}
+
+static void ert_queue_signal(pthread_cond_t *cond, uint32_t waiting_count, size_t count)
+{
+  if (waiting_count == 0) {
+    return;
+  }
+
+  if (waiting_count == 1 || count == 1) {
+    pthread_cond_signal(cond);
+  } else {
+    pthread_cond_broadcast(cond);
+  }
+}
+
+/**
+ * Waits on the condition with the queue mutex locked. The deadline is initialized on the first wait of an operation.
+ */
+static int ert_queue_wait(ert_queue *queue, pthread_cond_t *cond, uint32_t *waiting_count,
+    uint32_t timeout_milliseconds, bool *deadline_set, struct timespec *deadline)
+{
+  int result;
+
+  if (timeout_milliseconds == 0) {
+    return -ETIMEDOUT;
+  }
+
+  if (timeout_milliseconds != ERT_QUEUE_WAIT_FOREVER && !*deadline_set) {
+    result = ert_get_current_timestamp_offset(deadline, timeout_milliseconds);
+    if (result < 0) {
+      return -EIO;
+    }
+    *deadline_set = true;
+  }
+
+  (*waiting_count)++;
+  if (timeout_milliseconds == ERT_QUEUE_WAIT_FOREVER) {
+    result = pthread_cond_wait(cond, &queue->mutex);
+  } else {
+    result = pthread_cond_timedwait(cond, &queue->mutex, deadline);
+  }
+  (*waiting_count)--;
+
+  if (result == ETIMEDOUT) {
+    return -ETIMEDOUT;
+  } else if (result != 0) {
+    ert_log_error("Error waiting for queue condition, result %d", result);
+    return -EIO;
+  }
+
+  return 0;
+}
+
+/**
+ * Pushes count elements to the queue, waiting for room for up to timeout_milliseconds in total.
+ * A zero timeout never waits and ERT_QUEUE_WAIT_FOREVER waits until all elements have been pushed.
+ *
+ * Returns the number of elements pushed, which is less than count only if the wait timed out or the queue was closed.
+ * If no elements could be pushed, returns -ETIMEDOUT on timeout and -EPIPE if the queue has been closed.
+ */
+ssize_t ert_queue_push(ert_queue *queue, const void *elements, size_t count, uint32_t timeout_milliseconds)
+{
+  const uint8_t *source = elements;
+  struct timespec deadline;
+  bool deadline_set = false;
+  size_t pushed_count = 0;
+  int result = 0;
+
+  pthread_mutex_lock(&queue->mutex);
+
+  while (pushed_count < count) {
+    if (queue->closed) {
+      result = -EPIPE;
+      break;
+    }
+
+    size_t free_count = queue->capacity - (queue->tail - queue->head);
+    if (free_count == 0) {
+      result = ert_queue_wait(queue, &queue->not_full_cond, &queue->waiting_producer_count,
+          timeout_milliseconds, &deadline_set, &deadline);
+      if (result < 0) {
+        break;
+      }
+      continue;
+    }
+
+    size_t push_count = count - pushed_count;
+    if (push_count > free_count) {
+      push_count = free_count;
+    }
+
+    ert_queue_copy_in(queue, source + pushed_count * queue->element_size, push_count);
+    pushed_count += push_count;
+
+    ert_queue_signal(&queue->not_empty_cond, queue->waiting_consumer_count, push_count);
+  }
+
+  pthread_mutex_unlock(&queue->mutex);
+
+  if (pushed_count == 0 && count > 0) {
+    return result;
+  }
+
+  return (ssize_t) pushed_count;
+}
+
+/**
+ * Waits for at least one element for up to timeout_milliseconds and pops up to count elements that are available
+ * without waiting further. A zero timeout never waits and ERT_QUEUE_WAIT_FOREVER waits until elements are available.
+ *
+ * Returns the number of elements popped, 0 if the queue has been closed and is empty or -ETIMEDOUT on timeout.
+ */
+ssize_t ert_queue_pop(ert_queue *queue, void *target, size_t count, uint32_t timeout_milliseconds)
+{
+  struct timespec deadline;
+  bool deadline_set = false;
+  size_t available_count;
+
+  if (count == 0) {
+    return 0;
+  }
+
+  pthread_mutex_lock(&queue->mutex);
+
+  while ((available_count = queue->tail - queue->head) == 0) {
+    if (queue->closed) {
+      pthread_mutex_unlock(&queue->mutex);
+      return 0;
+    }
+
+    int result = ert_queue_wait(queue, &queue->not_empty_cond, &queue->waiting_consumer_count,
+        timeout_milliseconds, &deadline_set, &deadline);
+    if (result < 0) {
+      pthread_mutex_unlock(&queue->mutex);
+      return result;
+    }
+  }
+
+  size_t pop_count = (count < available_count) ? count : available_count;
+  ert_queue_copy_out(queue, target, pop_count);
+
+  ert_queue_signal(&queue->not_full_cond, queue->waiting_producer_count, pop_count);
+
+  pthread_mutex_unlock(&queue->mutex);
+
+  return (ssize_t) pop_count;
+}
+
+size_t ert_queue_get_count(ert_queue *queue)
+{
+  pthread_mutex_lock(&queue->mutex);
+  size_t count = queue->tail - queue->head;
+  pthread_mutex_unlock(&queue->mutex);
+
+  return count;
+}
+
+int ert_queue_close(ert_queue *queue)
+{
+  pthread_mutex_lock(&queue->mutex);
+  queue->closed = true;
+  pthread_cond_broadcast(&queue->not_empty_cond);
+  pthread_cond_broadcast(&queue->not_full_cond);
+  pthread_mutex_unlock(&queue->mutex);
+
+  return 0;
+}
+
+int ert_queue_destroy(ert_queue *queue)
+{
+  pthread_cond_destroy(&queue->not_full_cond);
+  pthread_cond_destroy(&queue->not_empty_cond);
+  pthread_mutex_destroy(&queue->mutex);
+  free(queue->buffer);
+  free(queue);
+
+  return 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ERT_QUEUE_H
+#define __ERT_QUEUE_H
+
+#include <pthread.h>
+#include "ert-common.h"
+
+#define ERT_QUEUE_WAIT_FOREVER UINT32_MAX
+
+/**
+ * Bounded blocking queue of fixed-size elements for multiple producer and consumer threads. The elements are stored
+ * in a single preallocated ring whose length is rounded up to a power of two, so the queue never allocates after
+ * creation. Batches of elements are copied in with at most two memcpy calls per push or pop, and the condition
+ * variables are signaled only when a thread is actually waiting on them.
+ *
+ * Closing the queue wakes up all waiting threads: pushing fails after that and popping drains the remaining
+ * elements before returning 0.
+ */
+typedef struct _ert_queue {
+  size_t element_size;
+  size_t capacity;
+  size_t mask;
+  uint8_t *buffer;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t not_empty_cond;
+  pthread_cond_t not_full_cond;
+
+  // Free-running element positions, the difference is the number of elements in the queue
+  size_t head;
+  size_t tail;
+
+  uint32_t waiting_consumer_count;
+  uint32_t waiting_producer_count;
+  bool closed;
+} ert_queue;
+
+int ert_queue_create(size_t element_size, size_t capacity, ert_queue **queue_rcv);
+ssize_t ert_queue_push(ert_queue *queue, const void *elements, size_t count, uint32_t timeout_milliseconds);
+ssize_t ert_queue_pop(ert_queue *queue, void *target, size_t count, uint32_t timeout_milliseconds);
+size_t ert_queue_get_count(ert_queue *queue);
+int ert_queue_close(ert_queue *queue);
+int ert_queue_destroy(ert_queue *queue);
+
+#endif
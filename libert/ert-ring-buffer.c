@@ -176,3 +176,51 @@ int ert_ring_buffer_read(ert_ring_buffer *ring_buffer, uint32_t length, uint8_t
 
   return 0;
 }
+
+/**
+ * Returns the address and length of the contiguous region of data at the head of the ring buffer,
+ * which is the whole data unless it wraps around the end of the buffer. The data stays valid until
+ * it is consumed, because writes go to the free space only.
+ */
+int ert_ring_buffer_peek(ert_ring_buffer *ring_buffer, uint8_t **data_rcv, uint32_t *length_rcv)
+{
+  // A read ending exactly at the end of the buffer leaves the head there
+  if (ring_buffer->buffer_head == ring_buffer->buffer + ring_buffer->buffer_length_bytes) {
+    ring_buffer->buffer_head = ring_buffer->buffer;
+  }
+
+  uintptr_t buffer_end;
+  if ((uintptr_t) ring_buffer->buffer_head < (uintptr_t) ring_buffer->buffer_tail) {
+    buffer_end = (uintptr_t) ring_buffer->buffer_tail;
+  } else {
+    buffer_end = (uintptr_t) ring_buffer->buffer + (uintptr_t) ring_buffer->buffer_length_bytes;
+  }
+
+  uintptr_t buffer_end_remaining_bytes = buffer_end - (uintptr_t) ring_buffer->buffer_head;
+
+  *data_rcv = ring_buffer->buffer_head;
+  *length_rcv = (ring_buffer->buffer_used_bytes < buffer_end_remaining_bytes)
+                ? ring_buffer->buffer_used_bytes : (uint32_t) buffer_end_remaining_bytes;
+
+  return 0;
+}
+
+int ert_ring_buffer_consume(ert_ring_buffer *ring_buffer, uint32_t length)
+{
+  if (length > ring_buffer->buffer_used_bytes) {
+    return -EINVAL;
+  }
+
+  uintptr_t buffer_end_remaining_bytes = (uintptr_t) ring_buffer->buffer
+      + (uintptr_t) ring_buffer->buffer_length_bytes - (uintptr_t) ring_buffer->buffer_head;
+
+  if (length < buffer_end_remaining_bytes) {
+    ring_buffer->buffer_head += length;
+  } else {
+    ring_buffer->buffer_head = ring_buffer->buffer + (length - buffer_end_remaining_bytes);
+  }
+
+  ring_buffer->buffer_used_bytes -= length;
+
+  return 0;
+}
@@ -31,5 +31,7 @@ bool ert_ring_buffer_has_space_for(ert_ring_buffer *ring_buffer, uint32_t length
 int ert_ring_buffer_write(ert_ring_buffer *ring_buffer, uint32_t length, uint8_t *data);
 int ert_ring_buffer_write_value(ert_ring_buffer *ring_buffer, uint32_t length, uint8_t value);
 int ert_ring_buffer_read(ert_ring_buffer *ring_buffer, uint32_t length, uint8_t *data, uint32_t *read_length);
+int ert_ring_buffer_peek(ert_ring_buffer *ring_buffer, uint8_t **data_rcv, uint32_t *length_rcv);
+int ert_ring_buffer_consume(ert_ring_buffer *ring_buffer, uint32_t length);
 
 #endif
@@ -0,0 +1,230 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/*
+ * Contention benchmark for stream receive buffers: a producer thread writes packet-sized chunks and a consumer
+ * thread reads them, first through ert_ring_buffer protected by a mutex and a condition variable signaled
+ * for every chunk, as receive streams used to do, and then through the lock-free ert_spsc_ring_buffer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "ert-ring-buffer.h"
+#include "ert-spsc-ring-buffer.h"
+#include "ert-log.h"
+#include "ert-time.h"
+#include "ert-test.h"
+
+#define BENCH_BUFFER_LENGTH 8192
+#define BENCH_BYTE_COUNT_DEFAULT (64 * 1024 * 1024)
+#define BENCH_READ_LENGTH 1024
+#define BENCH_WAIT_MILLIS 1000
+
+typedef struct _ert_spsc_ring_buffer_bench_context {
+  uint64_t byte_count;
+  uint32_t chunk_length;
+
+  ert_ring_buffer *ring_buffer;
+  pthread_mutex_t mutex;
+  pthread_cond_t change_cond;
+
+  ert_spsc_ring_buffer *spsc_ring_buffer;
+
+  uint64_t producer_full_count;
+} ert_spsc_ring_buffer_bench_context;
+
+static void *ert_spsc_ring_buffer_bench_mutex_producer(void *arg)
+{
+  ert_spsc_ring_buffer_bench_context *context = (ert_spsc_ring_buffer_bench_context *) arg;
+  uint8_t data[BENCH_BUFFER_LENGTH];
+  uint64_t written_bytes = 0;
+
+  memset(data, 0x55, sizeof(data));
+
+  while (written_bytes < context->byte_count) {
+    pthread_mutex_lock(&context->mutex);
+    int result = ert_ring_buffer_write(context->ring_buffer, context->chunk_length, data);
+    if (result == 0) {
+      pthread_cond_signal(&context->change_cond);
+    }
+    pthread_mutex_unlock(&context->mutex);
+
+    if (result == 0) {
+      written_bytes += context->chunk_length;
+    } else {
+      context->producer_full_count++;
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+static void *ert_spsc_ring_buffer_bench_spsc_producer(void *arg)
+{
+  ert_spsc_ring_buffer_bench_context *context = (ert_spsc_ring_buffer_bench_context *) arg;
+  uint8_t data[BENCH_BUFFER_LENGTH];
+  uint64_t written_bytes = 0;
+
+  memset(data, 0x55, sizeof(data));
+
+  while (written_bytes < context->byte_count) {
+    int result = ert_spsc_ring_buffer_write(context->spsc_ring_buffer, context->chunk_length, data);
+    if (result == 0) {
+      written_bytes += context->chunk_length;
+    } else {
+      context->producer_full_count++;
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+static void ert_spsc_ring_buffer_bench_mutex_consume(ert_spsc_ring_buffer_bench_context *context)
+{
+  uint8_t data[BENCH_READ_LENGTH];
+  uint64_t read_bytes = 0;
+
+  while (read_bytes < context->byte_count) {
+    uint32_t read_length;
+
+    pthread_mutex_lock(&context->mutex);
+    ert_ring_buffer_read(context->ring_buffer, sizeof(data), data, &read_length);
+    if (read_length == 0) {
+      struct timespec to;
+      ert_get_current_timestamp_offset(&to, BENCH_WAIT_MILLIS);
+      pthread_cond_timedwait(&context->change_cond, &context->mutex, &to);
+    }
+    pthread_mutex_unlock(&context->mutex);
+
+    read_bytes += read_length;
+  }
+}
+
+static void ert_spsc_ring_buffer_bench_spsc_consume(ert_spsc_ring_buffer_bench_context *context)
+{
+  uint8_t data[BENCH_READ_LENGTH];
+  uint64_t read_bytes = 0;
+
+  while (read_bytes < context->byte_count) {
+    uint32_t wake_count = ert_spsc_ring_buffer_get_wake_count(context->spsc_ring_buffer);
+    uint32_t read_length;
+
+    ert_spsc_ring_buffer_read(context->spsc_ring_buffer, sizeof(data), data, &read_length);
+    if (read_length == 0) {
+      ert_spsc_ring_buffer_wait(context->spsc_ring_buffer, wake_count, BENCH_WAIT_MILLIS);
+    }
+
+    read_bytes += read_length;
+  }
+}
+
+static int ert_spsc_ring_buffer_bench_run(bool spsc, uint64_t byte_count, uint32_t chunk_length)
+{
+  ert_spsc_ring_buffer_bench_context context = {0};
+  struct timespec start_time, end_time;
+  struct timespec start_cpu_time, end_cpu_time;
+  pthread_t thread;
+  int result;
+
+  context.byte_count = byte_count - byte_count % chunk_length;
+  context.chunk_length = chunk_length;
+
+  if (spsc) {
+    result = ert_spsc_ring_buffer_create(BENCH_BUFFER_LENGTH, &context.spsc_ring_buffer);
+  } else {
+    result = ert_ring_buffer_create(BENCH_BUFFER_LENGTH, &context.ring_buffer);
+    pthread_mutex_init(&context.mutex, NULL);
+    pthread_cond_init(&context.change_cond, NULL);
+  }
+  if (result < 0) {
+    return result;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start_cpu_time);
+
+  result = pthread_create(&thread, NULL,
+      spsc ? ert_spsc_ring_buffer_bench_spsc_producer : ert_spsc_ring_buffer_bench_mutex_producer, &context);
+  if (result != 0) {
+    ert_log_error("Error starting producer thread, result %d", result);
+    return -EIO;
+  }
+
+  if (spsc) {
+    ert_spsc_ring_buffer_bench_spsc_consume(&context);
+  } else {
+    ert_spsc_ring_buffer_bench_mutex_consume(&context);
+  }
+
+  pthread_join(thread, NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &end_cpu_time);
+
+  double elapsed_millis = (double) (end_time.tv_sec - start_time.tv_sec) * 1000.0
+      + (double) (end_time.tv_nsec - start_time.tv_nsec) / 1000000.0;
+  double cpu_millis = (double) (end_cpu_time.tv_sec - start_cpu_time.tv_sec) * 1000.0
+      + (double) (end_cpu_time.tv_nsec - start_cpu_time.tv_nsec) / 1000000.0;
+  uint64_t chunk_count = context.byte_count / chunk_length;
+
+  printf("buffer=%s chunk_length=%u bytes=%" PRIu64 " elapsed_ms=%.3f cpu_ms=%.3f "
+      "throughput_mbps=%.1f ns_per_chunk=%.1f producer_full_count=%" PRIu64 "\n",
+      spsc ? "spsc" : "mutex", chunk_length, context.byte_count, elapsed_millis, cpu_millis,
+      (double) context.byte_count * 8.0 / (elapsed_millis * 1000.0),
+      elapsed_millis * 1000000.0 / (double) chunk_count, context.producer_full_count);
+  fflush(stdout);
+
+  if (spsc) {
+    ert_spsc_ring_buffer_destroy(context.spsc_ring_buffer);
+  } else {
+    pthread_cond_destroy(&context.change_cond);
+    pthread_mutex_destroy(&context.mutex);
+    ert_ring_buffer_destroy(context.ring_buffer);
+  }
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t chunk_lengths[] = { 16, 64, 251 };
+  uint64_t byte_count = BENCH_BYTE_COUNT_DEFAULT;
+  int result = 0;
+
+  if (argc > 1) {
+    byte_count = strtoull(argv[1], NULL, 10);
+  }
+
+  ert_test_init();
+
+  for (size_t i = 0; i < sizeof(chunk_lengths) / sizeof(uint32_t); i++) {
+    result = ert_spsc_ring_buffer_bench_run(false, byte_count, chunk_lengths[i]);
+    if (result < 0) {
+      break;
+    }
+    result = ert_spsc_ring_buffer_bench_run(true, byte_count, chunk_lengths[i]);
+    if (result < 0) {
+      break;
+    }
+  }
+
+  ert_test_uninit();
+
+  return (result < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,291 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "ert-spsc-ring-buffer.h"
+#include "ert-log.h"
+#include "ert-test.h"
+
+#define SPSC_TEST_BUFFER_LENGTH 1000
+#define SPSC_TEST_CONCURRENT_BYTE_COUNT (8 * 1024 * 1024)
+#define SPSC_TEST_WAIT_MILLIS 100
+
+typedef struct _ert_spsc_ring_buffer_test_thread_context {
+  ert_spsc_ring_buffer *ring_buffer;
+  uint32_t byte_count;
+  volatile bool done;
+} ert_spsc_ring_buffer_test_thread_context;
+
+static uint32_t ert_spsc_ring_buffer_test_elapsed_millis(struct timespec *start_time)
+{
+  struct timespec end_time;
+  clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+  return (uint32_t) ((end_time.tv_sec - start_time->tv_sec) * 1000
+      + (end_time.tv_nsec - start_time->tv_nsec) / 1000000);
+}
+
+void ert_spsc_ring_buffer_test_run_test_read_write()
+{
+  ert_spsc_ring_buffer *ring_buffer;
+  uint8_t data[SPSC_TEST_BUFFER_LENGTH];
+  uint8_t read_data[SPSC_TEST_BUFFER_LENGTH];
+  uint32_t read_length;
+  uint8_t *peek_data;
+  uint32_t peek_length;
+  int result;
+
+  for (uint32_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t) i;
+  }
+
+  result = ert_spsc_ring_buffer_create(SPSC_TEST_BUFFER_LENGTH, &ring_buffer);
+  assert(result == 0);
+
+  assert(ert_spsc_ring_buffer_get_used_bytes(ring_buffer) == 0);
+  result = ert_spsc_ring_buffer_read(ring_buffer, sizeof(read_data), read_data, &read_length);
+  assert(result == 0);
+  assert(read_length == 0);
+
+  // Fill the buffer completely
+  result = ert_spsc_ring_buffer_write(ring_buffer, SPSC_TEST_BUFFER_LENGTH, data);
+  assert(result == 0);
+  assert(ert_spsc_ring_buffer_get_used_bytes(ring_buffer) == SPSC_TEST_BUFFER_LENGTH);
+  assert(!ert_spsc_ring_buffer_has_space_for(ring_buffer, 1));
+  result = ert_spsc_ring_buffer_write(ring_buffer, 1, data);
+  assert(result == -ENOBUFS);
+
+  result = ert_spsc_ring_buffer_read(ring_buffer, 700, read_data, &read_length);
+  assert(result == 0);
+  assert(read_length == 700);
+  assert(memcmp(read_data, data, 700) == 0);
+
+  // Write data that wraps around the end of the buffer
+  result = ert_spsc_ring_buffer_write(ring_buffer, 500, data + 100);
+  assert(result == 0);
+  assert(ert_spsc_ring_buffer_get_used_bytes(ring_buffer) == 800);
+
+  result = ert_spsc_ring_buffer_read(ring_buffer, 250, read_data, &read_length);
+  assert(result == 0);
+  assert(read_length == 250);
+  assert(memcmp(read_data, data + 700, 250) == 0);
+
+  // Peeking returns the contiguous region up to the end of the buffer
+  result = ert_spsc_ring_buffer_peek(ring_buffer, &peek_data, &peek_length);
+  assert(result == 0);
+  assert(peek_length == 50);
+  assert(memcmp(peek_data, data + 950, 50) == 0);
+
+  result = ert_spsc_ring_buffer_consume(ring_buffer, 51);
+  assert(result == 0);
+
+  result = ert_spsc_ring_buffer_peek(ring_buffer, &peek_data, &peek_length);
+  assert(result == 0);
+  assert(peek_length == 499);
+  assert(memcmp(peek_data, data + 101, 499) == 0);
+
+  result = ert_spsc_ring_buffer_consume(ring_buffer, 500);
+  assert(result == -EINVAL);
+
+  result = ert_spsc_ring_buffer_write_value(ring_buffer, 501, 0xAA);
+  assert(result == 0);
+  assert(ert_spsc_ring_buffer_get_used_bytes(ring_buffer) == SPSC_TEST_BUFFER_LENGTH);
+
+  result = ert_spsc_ring_buffer_read(ring_buffer, sizeof(read_data), read_data, &read_length);
+  assert(result == 0);
+  assert(read_length == SPSC_TEST_BUFFER_LENGTH);
+  assert(memcmp(read_data, data + 101, 499) == 0);
+  for (uint32_t i = 499; i < read_length; i++) {
+    assert(read_data[i] == 0xAA);
+  }
+
+  result = ert_spsc_ring_buffer_write(ring_buffer, 10, data);
+  assert(result == 0);
+  result = ert_spsc_ring_buffer_clear(ring_buffer);
+  assert(result == 0);
+  assert(ert_spsc_ring_buffer_get_used_bytes(ring_buffer) == 0);
+
+  ert_spsc_ring_buffer_destroy(ring_buffer);
+}
+
+static void *ert_spsc_ring_buffer_test_waker(void *context)
+{
+  ert_spsc_ring_buffer_test_thread_context *thread_context = (ert_spsc_ring_buffer_test_thread_context *) context;
+
+  usleep(SPSC_TEST_WAIT_MILLIS * 1000 / 2);
+  thread_context->done = true;
+  ert_spsc_ring_buffer_wake(thread_context->ring_buffer);
+
+  return NULL;
+}
+
+void ert_spsc_ring_buffer_test_run_test_wait()
+{
+  ert_spsc_ring_buffer_test_thread_context thread_context = {0};
+  ert_spsc_ring_buffer *ring_buffer;
+  struct timespec start_time;
+  pthread_t thread;
+  int result;
+
+  result = ert_spsc_ring_buffer_create(SPSC_TEST_BUFFER_LENGTH, &ring_buffer);
+  assert(result == 0);
+  thread_context.ring_buffer = ring_buffer;
+
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  result = ert_spsc_ring_buffer_wait(ring_buffer, ert_spsc_ring_buffer_get_wake_count(ring_buffer),
+      SPSC_TEST_WAIT_MILLIS);
+  assert(result == -ETIMEDOUT);
+  assert(ert_spsc_ring_buffer_test_elapsed_millis(&start_time) >= SPSC_TEST_WAIT_MILLIS - 1);
+
+  // A wake-up before the wait starts is not lost
+  uint32_t wake_count = ert_spsc_ring_buffer_get_wake_count(ring_buffer);
+  ert_spsc_ring_buffer_wake(ring_buffer);
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  result = ert_spsc_ring_buffer_wait(ring_buffer, wake_count, 10 * SPSC_TEST_WAIT_MILLIS);
+  assert(result == 0);
+  assert(ert_spsc_ring_buffer_test_elapsed_millis(&start_time) < SPSC_TEST_WAIT_MILLIS);
+
+  // Waking up from another thread ends the wait
+  result = pthread_create(&thread, NULL, ert_spsc_ring_buffer_test_waker, &thread_context);
+  assert(result == 0);
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  wake_count = ert_spsc_ring_buffer_get_wake_count(ring_buffer);
+  while (!thread_context.done) {
+    result = ert_spsc_ring_buffer_wait(ring_buffer, wake_count, 10 * SPSC_TEST_WAIT_MILLIS);
+    assert(result == 0);
+  }
+  assert(ert_spsc_ring_buffer_test_elapsed_millis(&start_time) < 5 * SPSC_TEST_WAIT_MILLIS);
+  pthread_join(thread, NULL);
+
+  // Data in the buffer ends the wait immediately
+  uint8_t value = 1;
+  result = ert_spsc_ring_buffer_write(ring_buffer, 1, &value);
+  assert(result == 0);
+  result = ert_spsc_ring_buffer_wait(ring_buffer, ert_spsc_ring_buffer_get_wake_count(ring_buffer),
+      10 * SPSC_TEST_WAIT_MILLIS);
+  assert(result == 0);
+
+  ert_spsc_ring_buffer_destroy(ring_buffer);
+}
+
+static void *ert_spsc_ring_buffer_test_producer(void *context)
+{
+  ert_spsc_ring_buffer_test_thread_context *thread_context = (ert_spsc_ring_buffer_test_thread_context *) context;
+  uint8_t data[256];
+  uint32_t written_bytes = 0;
+  uint32_t random_state = 1;
+
+  while (written_bytes < thread_context->byte_count) {
+    random_state = random_state * 1103515245 + 12345;
+    uint32_t length = 1 + (random_state >> 16) % sizeof(data);
+    if (length > thread_context->byte_count - written_bytes) {
+      length = thread_context->byte_count - written_bytes;
+    }
+
+    for (uint32_t i = 0; i < length; i++) {
+      data[i] = (uint8_t) ((written_bytes + i) % 251);
+    }
+
+    while (ert_spsc_ring_buffer_write(thread_context->ring_buffer, length, data) == -ENOBUFS) {
+      sched_yield();
+    }
+
+    written_bytes += length;
+  }
+
+  thread_context->done = true;
+  ert_spsc_ring_buffer_wake(thread_context->ring_buffer);
+
+  return NULL;
+}
+
+void ert_spsc_ring_buffer_test_run_test_concurrent()
+{
+  ert_spsc_ring_buffer_test_thread_context thread_context = {0};
+  ert_spsc_ring_buffer *ring_buffer;
+  pthread_t thread;
+  uint8_t data[300];
+  uint32_t read_bytes = 0;
+  int result;
+
+  result = ert_spsc_ring_buffer_create(SPSC_TEST_BUFFER_LENGTH, &ring_buffer);
+  assert(result == 0);
+
+  thread_context.ring_buffer = ring_buffer;
+  thread_context.byte_count = SPSC_TEST_CONCURRENT_BYTE_COUNT;
+
+  result = pthread_create(&thread, NULL, ert_spsc_ring_buffer_test_producer, &thread_context);
+  assert(result == 0);
+
+  while (read_bytes < SPSC_TEST_CONCURRENT_BYTE_COUNT) {
+    uint32_t wake_count = ert_spsc_ring_buffer_get_wake_count(ring_buffer);
+    uint32_t read_length;
+
+    // Alternate between copying reads and in-place reads
+    if ((read_bytes / sizeof(data)) % 2 == 0) {
+      result = ert_spsc_ring_buffer_read(ring_buffer, sizeof(data), data, &read_length);
+      assert(result == 0);
+      for (uint32_t i = 0; i < read_length; i++) {
+        assert(data[i] == (uint8_t) ((read_bytes + i) % 251));
+      }
+    } else {
+      uint8_t *peek_data;
+      result = ert_spsc_ring_buffer_peek(ring_buffer, &peek_data, &read_length);
+      assert(result == 0);
+      for (uint32_t i = 0; i < read_length; i++) {
+        assert(peek_data[i] == (uint8_t) ((read_bytes + i) % 251));
+      }
+      result = ert_spsc_ring_buffer_consume(ring_buffer, read_length);
+      assert(result == 0);
+    }
+
+    read_bytes += read_length;
+
+    if (read_length == 0) {
+      assert(!thread_context.done || ert_spsc_ring_buffer_get_used_bytes(ring_buffer) > 0);
+      result = ert_spsc_ring_buffer_wait(ring_buffer, wake_count, 10 * SPSC_TEST_WAIT_MILLIS);
+      assert(result == 0);
+    }
+  }
+
+  pthread_join(thread, NULL);
+
+  assert(read_bytes == SPSC_TEST_CONCURRENT_BYTE_COUNT);
+  assert(ert_spsc_ring_buffer_get_used_bytes(ring_buffer) == 0);
+
+  ert_spsc_ring_buffer_destroy(ring_buffer);
+}
+
+int main(void)
+{
+  int result = ert_test_init();
+  if (result < 0) {
+    return EXIT_FAILURE;
+  }
+
+  ert_spsc_ring_buffer_test_run_test_read_write();
+
+  ert_spsc_ring_buffer_test_run_test_wait();
+
+  ert_spsc_ring_buffer_test_run_test_concurrent();
+
+  ert_log_info("Tests finished successfully");
+
+  ert_test_uninit();
+
+  return EXIT_SUCCESS;
+}
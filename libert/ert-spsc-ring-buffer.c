@@ -0,0 +1,321 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ert-spsc-ring-buffer.h"
+#include "ert-time.h"
+#include "ert-log.h"
+
+static inline uint32_t ert_spsc_ring_buffer_get_offset(ert_spsc_ring_buffer *ring_buffer, uint32_t position)
+{
+  return (position < ring_buffer->buffer_length_bytes) ? position : position - ring_buffer->buffer_length_bytes;
+}
+
+static inline uint32_t ert_spsc_ring_buffer_advance(ert_spsc_ring_buffer *ring_buffer, uint32_t position,
+    uint32_t length)
+{
+  position += length;
+  return (position < 2 * ring_buffer->buffer_length_bytes) ? position : position - 2 * ring_buffer->buffer_length_bytes;
+}
+
+static inline uint32_t ert_spsc_ring_buffer_get_distance(ert_spsc_ring_buffer *ring_buffer,
+    uint32_t read_position, uint32_t write_position)
+{
+  return (write_position >= read_position)
+         ? write_position - read_position : write_position + 2 * ring_buffer->buffer_length_bytes - read_position;
+}
+
+int ert_spsc_ring_buffer_create(uint32_t buffer_length, ert_spsc_ring_buffer **ring_buffer_rcv)
+{
+  int result;
+
+  ert_spsc_ring_buffer *ring_buffer = calloc(1, sizeof(ert_spsc_ring_buffer));
+  if (ring_buffer == NULL) {
+    ert_log_fatal("Error allocating memory for SPSC ring buffer struct: %s", strerror(errno));
+    return -ENOMEM;
+  }
+
+  ring_buffer->buffer = calloc(1, buffer_length);
+  if (ring_buffer->buffer == NULL) {
+    ert_log_fatal("Error allocating memory for SPSC ring buffer data: %s", strerror(errno));
+    result = -ENOMEM;
+    goto error_ring_buffer;
+  }
+
+  ring_buffer->buffer_length_bytes = buffer_length;
+  ring_buffer->write_position = 0;
+  ring_buffer->read_position = 0;
+  ring_buffer->waiting = 0;
+  ring_buffer->wake_count = 0;
+
+  result = pthread_mutex_init(&ring_buffer->wait_mutex, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing SPSC ring buffer wait mutex, result %d", result);
+    result = -EIO;
+    goto error_buffer;
+  }
+
+  result = pthread_cond_init(&ring_buffer->wait_cond, NULL);
+  if (result != 0) {
+    ert_log_error("Error initializing SPSC ring buffer wait condition, result %d", result);
+    result = -EIO;
+    goto error_mutex;
+  }
+
+  *ring_buffer_rcv = ring_buffer;
+
+  return 0;
+
+  error_mutex:
+  pthread_mutex_destroy(&ring_buffer->wait_mutex);
+
+  error_buffer:
+  free(ring_buffer->buffer);
+
+  error_ring_buffer:
+  free(ring_buffer);
+
+  return result;
+}
+
+int ert_spsc_ring_buffer_destroy(ert_spsc_ring_buffer *ring_buffer)
+{
+  pthread_cond_destroy(&ring_buffer->wait_cond);
+  pthread_mutex_destroy(&ring_buffer->wait_mutex);
+  free(ring_buffer->buffer);
+  free(ring_buffer);
+
+  return 0;
+}
+
+/**
+ * Empties the ring buffer. Must not be called while the producer or the consumer is accessing it.
+ */
+int ert_spsc_ring_buffer_clear(ert_spsc_ring_buffer *ring_buffer)
+{
+  __atomic_store_n(&ring_buffer->write_position, 0, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&ring_buffer->read_position, 0, __ATOMIC_SEQ_CST);
+
+  return 0;
+}
+
+uint32_t ert_spsc_ring_buffer_get_used_bytes(ert_spsc_ring_buffer *ring_buffer)
+{
+  uint32_t read_position = __atomic_load_n(&ring_buffer->read_position, __ATOMIC_ACQUIRE);
+  uint32_t write_position = __atomic_load_n(&ring_buffer->write_position, __ATOMIC_ACQUIRE);
+
+  return ert_spsc_ring_buffer_get_distance(ring_buffer, read_position, write_position);
+}
+
+bool ert_spsc_ring_buffer_has_space_for(ert_spsc_ring_buffer *ring_buffer, uint32_t length)
+{
+  return ert_spsc_ring_buffer_get_used_bytes(ring_buffer) + length <= ring_buffer->buffer_length_bytes;
+}
+
+static void ert_spsc_ring_buffer_notify(ert_spsc_ring_buffer *ring_buffer)
+{
+  // Pairs with the consumer setting the waiting flag before checking for data
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  if (__atomic_load_n(&ring_buffer->waiting, __ATOMIC_RELAXED)) {
+    pthread_mutex_lock(&ring_buffer->wait_mutex);
+    pthread_cond_broadcast(&ring_buffer->wait_cond);
+    pthread_mutex_unlock(&ring_buffer->wait_mutex);
+  }
+}
+
+int ert_spsc_ring_buffer_write(ert_spsc_ring_buffer *ring_buffer, uint32_t length, uint8_t *data)
+{
+  uint32_t write_position = __atomic_load_n(&ring_buffer->write_position, __ATOMIC_RELAXED);
+  uint32_t read_position = __atomic_load_n(&ring_buffer->read_position, __ATOMIC_ACQUIRE);
+
+  if (ert_spsc_ring_buffer_get_distance(ring_buffer, read_position, write_position) + length
+      > ring_buffer->buffer_length_bytes) {
+    return -ENOBUFS;
+  }
+
+  uint32_t offset = ert_spsc_ring_buffer_get_offset(ring_buffer, write_position);
+  uint32_t buffer_end_remaining_bytes = ring_buffer->buffer_length_bytes - offset;
+
+  if (length <= buffer_end_remaining_bytes) {
+    memcpy(ring_buffer->buffer + offset, data, length);
+  } else {
+    memcpy(ring_buffer->buffer + offset, data, buffer_end_remaining_bytes);
+    memcpy(ring_buffer->buffer, data + buffer_end_remaining_bytes, length - buffer_end_remaining_bytes);
+  }
+
+  __atomic_store_n(&ring_buffer->write_position, ert_spsc_ring_buffer_advance(ring_buffer, write_position, length),
+      __ATOMIC_RELEASE);
+
+  ert_spsc_ring_buffer_notify(ring_buffer);
+
+  return 0;
+}
+
+int ert_spsc_ring_buffer_write_value(ert_spsc_ring_buffer *ring_buffer, uint32_t length, uint8_t value)
+{
+  uint32_t write_position = __atomic_load_n(&ring_buffer->write_position, __ATOMIC_RELAXED);
+  uint32_t read_position = __atomic_load_n(&ring_buffer->read_position, __ATOMIC_ACQUIRE);
+
+  if (ert_spsc_ring_buffer_get_distance(ring_buffer, read_position, write_position) + length
+      > ring_buffer->buffer_length_bytes) {
+    return -ENOBUFS;
+  }
+
+  uint32_t offset = ert_spsc_ring_buffer_get_offset(ring_buffer, write_position);
+  uint32_t buffer_end_remaining_bytes = ring_buffer->buffer_length_bytes - offset;
+
+  if (length <= buffer_end_remaining_bytes) {
+    memset(ring_buffer->buffer + offset, value, length);
+  } else {
+    memset(ring_buffer->buffer + offset, value, buffer_end_remaining_bytes);
+    memset(ring_buffer->buffer, value, length - buffer_end_remaining_bytes);
+  }
+
+  __atomic_store_n(&ring_buffer->write_position, ert_spsc_ring_buffer_advance(ring_buffer, write_position, length),
+      __ATOMIC_RELEASE);
+
+  ert_spsc_ring_buffer_notify(ring_buffer);
+
+  return 0;
+}
+
+int ert_spsc_ring_buffer_read(ert_spsc_ring_buffer *ring_buffer, uint32_t length, uint8_t *data, uint32_t *read_length)
+{
+  uint32_t read_position = __atomic_load_n(&ring_buffer->read_position, __ATOMIC_RELAXED);
+  uint32_t write_position = __atomic_load_n(&ring_buffer->write_position, __ATOMIC_ACQUIRE);
+
+  uint32_t used_bytes = ert_spsc_ring_buffer_get_distance(ring_buffer, read_position, write_position);
+  uint32_t bytes_to_read = (used_bytes < length) ? used_bytes : length;
+
+  if (bytes_to_read == 0) {
+    *read_length = 0;
+    return 0;
+  }
+
+  uint32_t offset = ert_spsc_ring_buffer_get_offset(ring_buffer, read_position);
+  uint32_t buffer_end_remaining_bytes = ring_buffer->buffer_length_bytes - offset;
+
+  if (bytes_to_read <= buffer_end_remaining_bytes) {
+    memcpy(data, ring_buffer->buffer + offset, bytes_to_read);
+  } else {
+    memcpy(data, ring_buffer->buffer + offset, buffer_end_remaining_bytes);
+    memcpy(data + buffer_end_remaining_bytes, ring_buffer->buffer, bytes_to_read - buffer_end_remaining_bytes);
+  }
+
+  __atomic_store_n(&ring_buffer->read_position, ert_spsc_ring_buffer_advance(ring_buffer, read_position, bytes_to_read),
+      __ATOMIC_RELEASE);
+
+  *read_length = bytes_to_read;
+
+  return 0;
+}
+
+/**
+ * Returns the address and length of the contiguous region of data at the read position, which is the whole
+ * data unless it wraps around the end of the buffer. The producer does not overwrite the data until it is consumed.
+ */
+int ert_spsc_ring_buffer_peek(ert_spsc_ring_buffer *ring_buffer, uint8_t **data_rcv, uint32_t *length_rcv)
+{
+  uint32_t read_position = __atomic_load_n(&ring_buffer->read_position, __ATOMIC_RELAXED);
+  uint32_t write_position = __atomic_load_n(&ring_buffer->write_position, __ATOMIC_ACQUIRE);
+
+  uint32_t used_bytes = ert_spsc_ring_buffer_get_distance(ring_buffer, read_position, write_position);
+  uint32_t offset = ert_spsc_ring_buffer_get_offset(ring_buffer, read_position);
+  uint32_t buffer_end_remaining_bytes = ring_buffer->buffer_length_bytes - offset;
+
+  *data_rcv = ring_buffer->buffer + offset;
+  *length_rcv = (used_bytes < buffer_end_remaining_bytes) ? used_bytes : buffer_end_remaining_bytes;
+
+  return 0;
+}
+
+int ert_spsc_ring_buffer_consume(ert_spsc_ring_buffer *ring_buffer, uint32_t length)
+{
+  uint32_t read_position = __atomic_load_n(&ring_buffer->read_position, __ATOMIC_RELAXED);
+  uint32_t write_position = __atomic_load_n(&ring_buffer->write_position, __ATOMIC_ACQUIRE);
+
+  if (length > ert_spsc_ring_buffer_get_distance(ring_buffer, read_position, write_position)) {
+    return -EINVAL;
+  }
+
+  __atomic_store_n(&ring_buffer->read_position, ert_spsc_ring_buffer_advance(ring_buffer, read_position, length),
+      __ATOMIC_RELEASE);
+
+  return 0;
+}
+
+/**
+ * Returns the current wake count to be passed to ert_spsc_ring_buffer_wait. Reading it before checking
+ * the state the consumer waits for guarantees that a wake-up between the check and the wait is not lost.
+ */
+uint32_t ert_spsc_ring_buffer_get_wake_count(ert_spsc_ring_buffer *ring_buffer)
+{
+  return __atomic_load_n(&ring_buffer->wake_count, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Waits until the buffer contains data, ert_spsc_ring_buffer_wake has been called after the wake count
+ * was read or the timeout expires. Returns -ETIMEDOUT on timeout. Called only by the consumer.
+ */
+int ert_spsc_ring_buffer_wait(ert_spsc_ring_buffer *ring_buffer, uint32_t wake_count, uint32_t wait_for_milliseconds)
+{
+  struct timespec to;
+  int result;
+
+  if (ert_spsc_ring_buffer_get_used_bytes(ring_buffer) > 0
+      || __atomic_load_n(&ring_buffer->wake_count, __ATOMIC_SEQ_CST) != wake_count) {
+    return 0;
+  }
+
+  result = ert_get_current_timestamp_offset(&to, wait_for_milliseconds);
+  if (result < 0) {
+    return -EIO;
+  }
+
+  pthread_mutex_lock(&ring_buffer->wait_mutex);
+  __atomic_store_n(&ring_buffer->waiting, 1, __ATOMIC_SEQ_CST);
+
+  result = 0;
+  while (__atomic_load_n(&ring_buffer->write_position, __ATOMIC_SEQ_CST)
+         == __atomic_load_n(&ring_buffer->read_position, __ATOMIC_RELAXED)
+      && __atomic_load_n(&ring_buffer->wake_count, __ATOMIC_SEQ_CST) == wake_count) {
+    int wait_result = pthread_cond_timedwait(&ring_buffer->wait_cond, &ring_buffer->wait_mutex, &to);
+    if (wait_result == ETIMEDOUT) {
+      result = -ETIMEDOUT;
+      break;
+    } else if (wait_result != 0) {
+      ert_log_error("pthread_cond_timedwait failed with result %d", wait_result);
+      result = -EIO;
+      break;
+    }
+  }
+
+  __atomic_store_n(&ring_buffer->waiting, 0, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&ring_buffer->wait_mutex);
+
+  return result;
+}
+
+/**
+ * Wakes up the consumer waiting for data, for example when the producer has no more data to write.
+ * May be called from any thread.
+ */
+void ert_spsc_ring_buffer_wake(ert_spsc_ring_buffer *ring_buffer)
+{
+  __atomic_add_fetch(&ring_buffer->wake_count, 1, __ATOMIC_SEQ_CST);
+
+  pthread_mutex_lock(&ring_buffer->wait_mutex);
+  pthread_cond_broadcast(&ring_buffer->wait_cond);
+  pthread_mutex_unlock(&ring_buffer->wait_mutex);
+}
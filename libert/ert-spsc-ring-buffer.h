@@ -0,0 +1,58 @@
+/*
+ * Embedded Radio Tracker
+ *
+ * Copyright (C) 2017 Mikael Nousiainen
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __ERT_SPSC_RING_BUFFER_H
+#define __ERT_SPSC_RING_BUFFER_H
+
+#include <pthread.h>
+
+#include "ert-common.h"
+
+/**
+ * Lock-free ring buffer for one producer and one consumer thread. The read and write positions run from 0 to
+ * twice the buffer length, so that a full buffer can be told apart from an empty one, and each of them is
+ * updated only by its own side. Multiple producer threads may share the buffer if they serialize writes
+ * with a mutex of their own.
+ *
+ * The consumer may block waiting for data. The producer takes the wait mutex only when the consumer is
+ * actually waiting, so reading and writing do not contend on a lock while data flows.
+ */
+typedef struct _ert_spsc_ring_buffer {
+  uint32_t buffer_length_bytes;
+  uint8_t *buffer;
+
+  volatile uint32_t write_position;
+  volatile uint32_t read_position;
+
+  pthread_mutex_t wait_mutex;
+  pthread_cond_t wait_cond;
+  volatile uint32_t waiting;
+  // Incremented by ert_spsc_ring_buffer_wake to end waits for events other than new data
+  volatile uint32_t wake_count;
+} ert_spsc_ring_buffer;
+
+int ert_spsc_ring_buffer_create(uint32_t buffer_length, ert_spsc_ring_buffer **ring_buffer_rcv);
+int ert_spsc_ring_buffer_destroy(ert_spsc_ring_buffer *ring_buffer);
+int ert_spsc_ring_buffer_clear(ert_spsc_ring_buffer *ring_buffer);
+uint32_t ert_spsc_ring_buffer_get_used_bytes(ert_spsc_ring_buffer *ring_buffer);
+bool ert_spsc_ring_buffer_has_space_for(ert_spsc_ring_buffer *ring_buffer, uint32_t length);
+
+int ert_spsc_ring_buffer_write(ert_spsc_ring_buffer *ring_buffer, uint32_t length, uint8_t *data);
+int ert_spsc_ring_buffer_write_value(ert_spsc_ring_buffer *ring_buffer, uint32_t length, uint8_t value);
+
+int ert_spsc_ring_buffer_read(ert_spsc_ring_buffer *ring_buffer, uint32_t length, uint8_t *data, uint32_t *read_length);
+int ert_spsc_ring_buffer_peek(ert_spsc_ring_buffer *ring_buffer, uint8_t **data_rcv, uint32_t *length_rcv);
+int ert_spsc_ring_buffer_consume(ert_spsc_ring_buffer *ring_buffer, uint32_t length);
+
+uint32_t ert_spsc_ring_buffer_get_wake_count(ert_spsc_ring_buffer *ring_buffer);
+int ert_spsc_ring_buffer_wait(ert_spsc_ring_buffer *ring_buffer, uint32_t wake_count, uint32_t wait_for_milliseconds);
+void ert_spsc_ring_buffer_wake(ert_spsc_ring_buffer *ring_buffer);
+
+#endif
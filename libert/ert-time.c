@@ -32,6 +32,12 @@ int32_t ert_timespec_diff_milliseconds(struct timespec *start, struct timespec *
                     - ((((int64_t) start->tv_sec) * 1000LL) + (((int64_t) start->tv_nsec) / 1000000LL)));
 }
 
+int64_t ert_timespec_diff_microseconds(struct timespec *start, struct timespec *stop)
+{
+  return ((((int64_t) stop->tv_sec) * 1000000LL) + (((int64_t) stop->tv_nsec) / 1000LL))
+         - ((((int64_t) start->tv_sec) * 1000000LL) + (((int64_t) start->tv_nsec) / 1000LL));
+}
+
 int32_t ert_timespec_diff_milliseconds_from_current(struct timespec *from)
 {
   struct timespec current;
@@ -16,6 +16,7 @@
 bool ert_timespec_is_zero(struct timespec *ts);
 bool ert_timespec_is_nonzero(struct timespec *ts);
 int32_t ert_timespec_diff_milliseconds(struct timespec *start, struct timespec *stop);
+int64_t ert_timespec_diff_microseconds(struct timespec *start, struct timespec *stop);
 int32_t ert_timespec_diff_milliseconds_from_current(struct timespec *from);
 int ert_get_current_timestamp(struct timespec *ts);
 int ert_get_current_timestamp_offset(struct timespec *ts, uint64_t offset_milliseconds);
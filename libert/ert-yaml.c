@@ -29,6 +29,7 @@ typedef enum _ert_yaml_parser_scalar_type {
 
 struct _ert_yaml_parser {
   yaml_parser_t parser;
+  uint32_t unknown_key_count;
 };
 
 int ert_yaml_parse_file(FILE *file, ert_mapper_entry *root_entry)
@@ -46,6 +47,29 @@ int ert_yaml_parse_file(FILE *file, ert_mapper_entry *root_entry)
   return result;
 }
 
+/**
+ * Parses the file like ert_yaml_parse_file(), but fails if the file contains keys that have no mapper entry,
+ * so that misplaced configuration sections are not silently ignored.
+ */
+int ert_yaml_parse_file_strict(FILE *file, ert_mapper_entry *root_entry)
+{
+  ert_yaml_parser *yaml_parser;
+  int result = ert_yaml_parser_open_file(file, &yaml_parser);
+  if (result < 0) {
+    return result;
+  }
+
+  result = ert_yaml_parse(yaml_parser, root_entry);
+  if (result == 0 && yaml_parser->unknown_key_count > 0) {
+    ert_log_error("Found %d unknown mapping keys", yaml_parser->unknown_key_count);
+    result = -EBADMSG;
+  }
+
+  ert_yaml_parser_close(yaml_parser);
+
+  return result;
+}
+
 int ert_yaml_parser_open_file(FILE *file, ert_yaml_parser **yaml_parser_rcv)
 {
   int result;
@@ -226,6 +250,7 @@ static int ert_yaml_parse_internal(ert_yaml_parser *yaml_parser, ert_mapper_entr
                   mapping_entry = ert_mapper_find_entry(entry->children, (char *) scalar_value);
                   if (mapping_entry == NULL) {
                     ert_log_warn("Unknown mapping key: '%s' for parent '%s'", scalar_value, entry->name);
+                    yaml_parser->unknown_key_count++;
                   }
                 }
 
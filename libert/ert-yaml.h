@@ -21,5 +21,6 @@ int ert_yaml_parser_open_file(FILE *file, ert_yaml_parser **yaml_parser_rcv);
 int ert_yaml_parse(ert_yaml_parser *yaml_parser, ert_mapper_entry *root_children_mapping);
 int ert_yaml_parser_close(ert_yaml_parser *yaml_parser);
 int ert_yaml_parse_file(FILE *file, ert_mapper_entry *entries);
+int ert_yaml_parse_file_strict(FILE *file, ert_mapper_entry *entries);
 
 #endif
@@ -21,6 +21,7 @@
 #include "ert-buffer-pool.h"
 #include "ert-ring-buffer.h"
 #include "ert-pipe.h"
+#include "ert-queue.h"
 
 #include "ert-hal.h"
 #include "ert-hal-gpio.h"
@@ -31,8 +32,11 @@
 #include "ert-comm.h"
 #include "ert-comm-transceiver.h"
 #include "ert-comm-protocol.h"
+#include "ert-comm-link-adaptation.h"
+#include "ert-comm-channel-plan.h"
 #include "ert-comm-protocol-device-adapter.h"
 #include "ert-comm-protocol-helpers.h"
+#include "ert-comm-protocol-aggregator.h"
 
 #include "ert-gps.h"
 #include "ert-gps-driver.h"
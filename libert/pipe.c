@@ -518,7 +518,7 @@ static inline void check_invariants(pipe_t* p)
         assertume(bytes_in_use(s) == capacity(s));
 
     assertume(in_bounds(DEFAULT_MINCAP*p->elem_size, p->min_cap, p->max_cap));
-    assertume(in_bounds(p->min_cap, capacity(s) + p->elem_size, p->max_cap));
+    assertume(in_bounds(p->min_cap, capacity(s), p->max_cap));
 }
 
 static inline void lock_pipe(pipe_t* p)
@@ -556,8 +556,10 @@ pipe_t* pipe_new(size_t elem_size, size_t limit)
 
     assert(DEFAULT_MINCAP >= 1);
 
+    // The buffer holds `cap' bytes of elements plus the sentinel element, the
+    // same layout resize_buffer() uses.
     size_t cap = DEFAULT_MINCAP * elem_size;
-    char*  buf = malloc(cap);
+    char*  buf = malloc(cap + elem_size);
 
     // Change the limit from being in "elements" to being in "bytes", and make
     // room for the sentinel element.
@@ -572,7 +574,7 @@ pipe_t* pipe_new(size_t elem_size, size_t limit)
         .max_cap = limit ? next_pow2(max(limit, cap)) : ~(size_t)0,
 
         .buffer = buf,
-        .bufend = buf + cap,
+        .bufend = buf + cap + elem_size,
         .begin  = buf,
         .end    = buf + elem_size,
 
@@ -750,7 +752,12 @@ static snapshot_t resize_buffer(pipe_t* p, size_t new_size)
     if(unlikely(new_size >= max_cap))
         new_size = max_cap;
 
-    if(new_size <= min_cap)
+    // Never go below the minimum capacity. Shrinking is clamped to it, and
+    // growing up to it (see pipe_reserve) must still reallocate.
+    if(unlikely(new_size < min_cap))
+        new_size = min_cap;
+
+    if(new_size == capacity(make_snapshot(p)))
         return make_snapshot(p);
 
     char* new_buf = malloc(new_size + elem_size);
@@ -1150,6 +1157,16 @@ ssize_t pipe_pop_eager(pipe_consumer_t* p, void* target, size_t count)
     return __pipe_pop(PIPIFY(p), target, count*elem_size, 0) / elem_size;
 }
 
+ssize_t pipe_pop_eager_timed(pipe_consumer_t* p, void* target, size_t count, size_t timeout_milliseconds)
+{
+    size_t elem_size = __pipe_elem_size(PIPIFY(p));
+    ssize_t ret = __pipe_pop(PIPIFY(p), target, count*elem_size, timeout_milliseconds);
+    if (ret < 0) {
+        return -1;
+    }
+    return ret / elem_size;
+}
+
 void pipe_reserve(pipe_generic_t* gen, size_t count)
 {
     pipe_t* p = PIPIFY(gen);
@@ -234,6 +234,10 @@ ssize_t NO_NULL_POINTERS WARN_UNUSED_RESULT pipe_pop_timed(pipe_consumer_t*,
 ssize_t NO_NULL_POINTERS WARN_UNUSED_RESULT pipe_pop_eager(pipe_consumer_t*,
                                                           void* target,
                                                           size_t count);
+ssize_t NO_NULL_POINTERS WARN_UNUSED_RESULT pipe_pop_eager_timed(pipe_consumer_t*,
+    void* target,
+    size_t count,
+    size_t timeout_milliseconds);
 
 /*
  * Modifies the pipe to have room for at least `count' elements. If more room
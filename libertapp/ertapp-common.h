@@ -12,7 +12,10 @@
 #define __ERTAPP_COMMON_H
 
 #define ERT_STREAM_PORT_TELEMETRY_MSGPACK 1
+#define ERT_STREAM_PORT_TELEMETRY_MSGPACK_AGGREGATED 2
 #define ERT_STREAM_PORT_IMAGE 11
+#define ERT_STREAM_PORT_IMAGE_TRANSFER 12
+#define ERT_STREAM_PORT_IMAGE_TRANSFER_STATUS 13
 
 #define ERT_DATA_LOGGER_ENTRY_TYPE_IMAGE 0x41
 